@@ -174,6 +174,8 @@ macro( marble_add_test TEST_NAME )
         set( ${TEST_NAME}_SRCS ${TEST_NAME}.cpp ${ARGN} )
         if( QTONLY )
             qt_generate_moc( ${TEST_NAME}.cpp ${CMAKE_CURRENT_BINARY_DIR}/${TEST_NAME}.moc )
+            # helper sources shared by tests include their own moc files
+            marble_qt4_automoc( ${ARGN} )
             include_directories( ${CMAKE_CURRENT_BINARY_DIR} )
             set( ${TEST_NAME}_SRCS ${CMAKE_CURRENT_BINARY_DIR}/${TEST_NAME}.moc ${${TEST_NAME}_SRCS} )
           
@@ -25,6 +25,7 @@
 #include "MarbleDebug.h"
 
 #include "MarbleTest.h"
+#include "TraceRecorder.h"
 
 #ifdef STATIC_BUILD
  #include <QtPlugin>
@@ -297,6 +298,7 @@ int main ( int argc, char *argv[] )
     options.add( "fps", ki18n( "Show frame rate" ) );
     options.add( "tile-id", ki18n( "Show tile IDs" ) );
     options.add( "runtimeTrace", ki18n( "Show time spent in each layer" ) );
+    options.add( "trace <file>", ki18n( "Record the time spent in the render pipeline and write it to a Chrome trace file on exit" ) );
     options.add( "marbledatapath <data path>", ki18n( "Use a different directory which contains map data" ) );
     if( profiles & MarbleGlobal::SmallScreen ) {
         options.add( "nosmallscreen", ki18n( "Do not use the interface optimized for small screens" ) );
@@ -325,6 +327,9 @@ int main ( int argc, char *argv[] )
 
     MarbleDebug::setEnabled( args->isSet( "debug-info" ) );
 
+    const QString traceFile = args->getOption( "trace" );
+    TraceRecorder::setEnabled( !traceFile.isEmpty() );
+
     if ( args->isSet( "smallscreen" ) ) {
         profiles |= MarbleGlobal::SmallScreen;
     }
@@ -396,5 +401,14 @@ int main ( int argc, char *argv[] )
             window->marbleControl()->addGeoDataFile( args->arg( i ) );
     }
 
-    return app.exec();
+    const int result = app.exec();
+
+    if ( !traceFile.isEmpty() ) {
+        if ( !TraceRecorder::saveChromeTrace( traceFile ) ) {
+            qWarning() << "Cannot write trace to" << traceFile;
+        }
+        qWarning() << qPrintable( TraceRecorder::summaryText() );
+    }
+
+    return result;
 }
@@ -13,6 +13,11 @@
 
 // Qt
 #include <QUrl>
+#include <QCache>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
 #include <QTimer>
 #include <QPointF>
 #include <QtAlgorithms>
@@ -43,15 +48,35 @@ const int timeBetweenTriedDownloads = 500;
 // Time between two real description file downloads in ms
 const int timeBetweenDownloads = 1500;
 
-// The factor describing how much the box has to be changed to download a new description file.
-// A higher factor means more downloads.
-const qreal boxComparisonFactor = 16.0;
+// Time in seconds until downloaded description files and queried tiles expire
+const int descriptionExpiry = 15 * 60;
+
+// Maximum size of the description files kept in memory in bytes
+const int descriptionCacheSize = 4 * 1024 * 1024;
+
+// The finest level of the grid of tiles the view is queried in
+const int maximumQueryLevel = 20;
+
+// Tiles are queried for at most this many times the number of items in the view
+const int maximumTileFactor = 16;
 
 // Separator to separate the id of the item from the file type
 const char fileIdSeparator = '_';
 
 class FavoritesModel;
 
+struct CachedDescription
+{
+    QDateTime downloaded;
+    QByteArray data;
+};
+
+struct QueriedTile
+{
+    QDateTime queried;
+    qint32 number;
+};
+
 class AbstractDataPluginModelPrivate
 {
 public:
@@ -62,20 +87,36 @@ public:
     ~AbstractDataPluginModelPrivate();
 
     void updateFavoriteItems();
+
+    /**
+     * Looks for an unexpired description file @p name in memory and on disk
+     */
+    bool findDescription( const QString &name, QByteArray &data );
+
+    void cacheDescription( const QString &name, const QDateTime &downloaded, const QByteArray &data );
+
+    /**
+     * Removes expired description files from the disk cache
+     */
+    void removeExpiredDescriptions();
+
+    /**
+     * Forgets tiles not queried within the expiry time
+     */
+    void removeExpiredTiles( const QDateTime &now );
     
     AbstractDataPluginModel *m_parent;
     const QString m_name;
     const MarbleModel *const m_marbleModel;
     GeoDataLatLonAltBox m_lastBox;
-    GeoDataLatLonAltBox m_downloadedBox;
     qint32 m_lastNumber;
-    qint32 m_downloadedNumber;
-    QString m_downloadedTarget;
     QList<AbstractDataPluginItem*> m_itemSet;
     QHash<QString, AbstractDataPluginItem*> m_downloadingItems;
     QList<AbstractDataPluginItem*> m_displayedItems;
     QTimer m_downloadTimer;
-    quint32 m_descriptionFileNumber;
+    // The time and number of items tiles of the view were queried with, by planet, level and position
+    QHash<QString, QueriedTile> m_queriedTiles;
+    QCache<QString, CachedDescription> m_descriptionCache;
     QHash<QString, QVariant> m_itemSettings;
     QStringList m_favoriteItems;
     bool m_favoriteItemsOnly;
@@ -116,11 +157,9 @@ AbstractDataPluginModelPrivate::AbstractDataPluginModelPrivate( const QString& n
       m_name( name ),
       m_marbleModel( marbleModel ),
       m_lastBox(),
-      m_downloadedBox(),
       m_lastNumber( 0 ),
-      m_downloadedNumber( 0 ),
       m_downloadTimer( m_parent ),
-      m_descriptionFileNumber( 0 ),
+      m_descriptionCache( descriptionCacheSize ),
       m_itemSettings(),
       m_favoriteItemsOnly( false ),
       m_storagePolicy( MarbleDirs::localPath() + "/cache/" + m_name + '/' ),
@@ -129,6 +168,7 @@ AbstractDataPluginModelPrivate::AbstractDataPluginModelPrivate( const QString& n
       m_hasMetaObject( false ),
       m_needsSorting( false )
 {
+    removeExpiredDescriptions();
 }
 
 AbstractDataPluginModelPrivate::~AbstractDataPluginModelPrivate() {
@@ -143,8 +183,6 @@ AbstractDataPluginModelPrivate::~AbstractDataPluginModelPrivate() {
     for (; hIt != hItEnd; ++hIt ) {
         (*hIt)->deleteLater();
     }
-
-    m_storagePolicy.clearCache();
 }
 
 void AbstractDataPluginModelPrivate::updateFavoriteItems()
@@ -158,6 +196,61 @@ void AbstractDataPluginModelPrivate::updateFavoriteItems()
     }
 }
 
+bool AbstractDataPluginModelPrivate::findDescription( const QString &name, QByteArray &data )
+{
+    QDateTime const now = QDateTime::currentDateTime();
+
+    CachedDescription *cached = m_descriptionCache.object( name );
+    if ( cached && cached->downloaded.secsTo( now ) < descriptionExpiry ) {
+        data = cached->data;
+        return true;
+    }
+
+    if ( m_storagePolicy.fileExists( name ) ) {
+        QFileInfo const file( MarbleDirs::localPath() + "/cache/" + m_name + '/' + name );
+        if ( file.lastModified().secsTo( now ) < descriptionExpiry ) {
+            data = m_storagePolicy.data( name );
+            if ( !data.isEmpty() ) {
+                cacheDescription( name, file.lastModified(), data );
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void AbstractDataPluginModelPrivate::cacheDescription( const QString &name, const QDateTime &downloaded, const QByteArray &data )
+{
+    CachedDescription *cached = new CachedDescription;
+    cached->downloaded = downloaded;
+    cached->data = data;
+    m_descriptionCache.insert( name, cached, data.size() );
+}
+
+void AbstractDataPluginModelPrivate::removeExpiredDescriptions()
+{
+    QDateTime const now = QDateTime::currentDateTime();
+    QDir const cache( MarbleDirs::localPath() + "/cache/" + m_name + '/' );
+    foreach( const QFileInfo &file, cache.entryInfoList( QStringList() << descriptionPrefix + '*', QDir::Files ) ) {
+        if ( file.lastModified().secsTo( now ) >= descriptionExpiry ) {
+            QFile::remove( file.absoluteFilePath() );
+        }
+    }
+}
+
+void AbstractDataPluginModelPrivate::removeExpiredTiles( const QDateTime &now )
+{
+    QHash<QString, QueriedTile>::iterator tile = m_queriedTiles.begin();
+    while ( tile != m_queriedTiles.end() ) {
+        if ( tile.value().queried.secsTo( now ) >= descriptionExpiry ) {
+            tile = m_queriedTiles.erase( tile );
+        } else {
+            ++tile;
+        }
+    }
+}
+
 static bool lessThanByPointer( const AbstractDataPluginItem *item1,
                                const AbstractDataPluginItem *item2 )
 {
@@ -392,11 +485,19 @@ void AbstractDataPluginModel::downloadItem( const QUrl& url,
 void AbstractDataPluginModel::downloadDescriptionFile( const QUrl& url )
 {
     if( !url.isEmpty() ) {
+        // The same url always results in the same file name. This way results are
+        // found in the cache and the download manager rejects concurrent downloads
+        // of the same url, so each result is parsed only once.
         QString name( descriptionPrefix );
-        name += QString::number( d->m_descriptionFileNumber );
+        name += QCryptographicHash::hash( url.toEncoded(), QCryptographicHash::Md5 ).toHex();
+
+        QByteArray data;
+        if ( d->findDescription( name, data ) ) {
+            parseFile( data );
+            return;
+        }
         
         d->m_downloadManager.addJob( url, name, name, DownloadBrowse );
-        d->m_descriptionFileNumber++;
     }
 }
 
@@ -575,39 +676,71 @@ void AbstractDataPluginModel::handleChangedViewport()
     if( d->m_favoriteItemsOnly ) {
         return;
     }
-    
-    // All this is to prevent to often downloads
-    if( d->m_lastNumber != 0
-            // We don't need to download if nothing changed
-            && ( !( d->m_downloadedBox == d->m_lastBox )
-                 || d->m_downloadedNumber != d->m_lastNumber
-                 || d->m_downloadedTarget != d->m_marbleModel->planetId() )
-            // We try to filter little changes of the bounding box
-            && ( fabs( d->m_downloadedBox.east() - d->m_lastBox.east() ) * boxComparisonFactor
-                 > d->m_lastBox.width()
-                 || fabs( d->m_downloadedBox.south() - d->m_lastBox.south() ) * boxComparisonFactor
-                 > d->m_lastBox.height()
-                 || fabs( d->m_downloadedBox.north() - d->m_lastBox.north() ) * boxComparisonFactor
-                 > d->m_lastBox.height()
-                 || fabs( d->m_downloadedBox.west() - d->m_lastBox.west() ) * boxComparisonFactor
-                 > d->m_lastBox.width() ) )
-    {
-        // We will wait a little bit longer to start the
-        // next download as we will really download something now.
-        d->m_downloadTimer.setInterval( timeBetweenDownloads );
-        
-        // Save the download parameter
-        d->m_downloadedBox = d->m_lastBox;
-        d->m_downloadedNumber = d->m_lastNumber;
-        d->m_downloadedTarget = d->m_marbleModel->planetId();
-        
-        // Get items
-        getAdditionalItems( d->m_lastBox, d->m_lastNumber );
+
+    // Don't wait to long to start the next download if we decide not to download anything.
+    // This will enhance response.
+    d->m_downloadTimer.setInterval( timeBetweenTriedDownloads );
+
+    if( d->m_lastNumber == 0 ) {
+        return;
     }
-    else {
-        // Don't wait to long to start the next download as we decided not to download anything.
-        // This will enhance response.
-        d->m_downloadTimer.setInterval( timeBetweenTriedDownloads );
+
+    // The box is queried in tiles of a fixed grid at least as large as the box. Tiles
+    // queried before are not downloaded and parsed again when panning the map.
+    qreal const boxSize = qMax( d->m_lastBox.width(), d->m_lastBox.height() );
+    int level = 0;
+    while ( level < maximumQueryLevel && 2 * M_PI / ( 1 << ( level + 1 ) ) >= boxSize ) {
+        ++level;
+    }
+    int const columns = 1 << level;
+    int const rows = qMax( 1, columns / 2 );
+    qreal const tileSize = 2 * M_PI / columns;
+
+    // A tile is larger than the view, so it is queried for as many items as
+    // keep the density of the view. The factor is rounded up to a power of two
+    // so zooming within a level rarely queries tiles again.
+    qreal const boxArea = qMax( d->m_lastBox.width() * d->m_lastBox.height(), qreal( 1e-12 ) );
+    qreal const tileArea = tileSize * qMin( tileSize, qreal( M_PI ) );
+    int factor = 1;
+    while ( factor < maximumTileFactor && factor * boxArea < tileArea ) {
+        factor *= 2;
+    }
+    qint32 const number = d->m_lastNumber * factor;
+
+    int const west = qBound( 0, int( ( d->m_lastBox.west() + M_PI ) / tileSize ), columns - 1 );
+    int east = qBound( 0, int( ( d->m_lastBox.east() + M_PI ) / tileSize ), columns - 1 );
+    if ( d->m_lastBox.crossesDateLine() ) {
+        east += columns;
+    }
+    int const south = qBound( 0, int( ( d->m_lastBox.south() + M_PI / 2 ) / tileSize ), rows - 1 );
+    int const north = qBound( 0, int( ( d->m_lastBox.north() + M_PI / 2 ) / tileSize ), rows - 1 );
+
+    QString const target = d->m_marbleModel->planetId();
+    QDateTime const now = QDateTime::currentDateTime();
+    d->removeExpiredTiles( now );
+    for ( int x = west; x <= east; ++x ) {
+        int const column = x % columns;
+        for ( int y = south; y <= north; ++y ) {
+            QString const key = QString( "%1/%2/%3/%4" ).arg( target ).arg( level ).arg( column ).arg( y );
+            QHash<QString, QueriedTile>::const_iterator const tile = d->m_queriedTiles.constFind( key );
+            if ( tile != d->m_queriedTiles.constEnd() && tile.value().number >= number ) {
+                continue;
+            }
+
+            // We will wait a little bit longer to start the
+            // next download as we will really download something now.
+            d->m_downloadTimer.setInterval( timeBetweenDownloads );
+            QueriedTile const queried = { now, number };
+            d->m_queriedTiles.insert( key, queried );
+
+            qreal const tileWest = -M_PI + column * tileSize;
+            qreal const tileSouth = -M_PI / 2 + y * tileSize;
+            GeoDataLatLonBox const tileBox( qMin( tileSouth + tileSize, qreal( M_PI / 2 ) ), tileSouth,
+                                            tileWest + tileSize, tileWest );
+
+            // Get items
+            getAdditionalItems( GeoDataLatLonAltBox( tileBox, 0, 0 ), number );
+        }
     }
 }
 
@@ -617,7 +750,9 @@ void AbstractDataPluginModel::processFinishedJob( const QString& relativeUrlStri
     Q_UNUSED( relativeUrlString );
     
     if( id.startsWith( descriptionPrefix ) ) {
-        parseFile( d->m_storagePolicy.data( id ) );
+        QByteArray const data = d->m_storagePolicy.data( id );
+        d->cacheDescription( id, QDateTime::currentDateTime(), data );
+        parseFile( data );
     }
     else {
         // The downloaded file contains item data.
@@ -668,6 +803,8 @@ void AbstractDataPluginModel::clear()
         (*iter)->deleteLater();
     }
     d->m_itemSet.clear();
+    // Items of tiles queried before have to be added again
+    d->m_queriedTiles.clear();
     emit itemsUpdated();
 }
 
@@ -118,6 +118,9 @@ public Q_SLOTS:
     /**
      * Managing to get @p number additional items in @p box. This includes generating a url and
      * downloading the corresponding file.
+     * The view is queried in tiles of a fixed grid, so this is called for each tile of the view
+     * that was not queried recently, with @p box being the tile. @p number is scaled to the
+     * size of the tile, so the view contains about as many items as requested.
      * This method has to be implemented in a subclass.
      **/
     virtual void getAdditionalItems( const GeoDataLatLonAltBox& box,
@@ -155,6 +158,8 @@ public Q_SLOTS:
     
     /**
      * Download the description file from the @p url.
+     * Files downloaded from the same url within the last minutes are parsed from the cache
+     * instead, and concurrent downloads of the same url are only done once.
      */
     void downloadDescriptionFile( const QUrl& url );
 
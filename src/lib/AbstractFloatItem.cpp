@@ -20,6 +20,13 @@
 #include "DialogConfigurationInterface.h"
 #include "GeoPainter.h"
 #include "MarbleDebug.h"
+#include "MarbleGraphicsItem_p.h"
+#include "MarbleMath.h"
+#include "MarbleModel.h"
+#include "PositionTracking.h"
+#include "RoutingManager.h"
+#include "RoutingModel.h"
+#include "ViewportParams.h"
 
 namespace Marble
 {
@@ -27,7 +34,16 @@ namespace Marble
 class AbstractFloatItemPrivate
 {
   public:
-    AbstractFloatItemPrivate() : m_contextMenu( 0 )
+    AbstractFloatItemPrivate() :
+        m_contextMenu( 0 ),
+        m_renderInputs( AbstractFloatItem::NoRenderInput ),
+        m_routeConnected( false ),
+        m_routeChanged( false ),
+        m_radius( 0 ),
+        m_projection( Spherical ),
+        m_heading( 0.0 ),
+        m_cacheHits( 0 ),
+        m_cacheMisses( 0 )
     {
     }
 
@@ -36,13 +52,97 @@ class AbstractFloatItemPrivate
         delete m_contextMenu;
     }
 
+    /**
+     * Returns true if one of the declared inputs changed by more than its threshold
+     * since the last call that returned true. The current inputs are remembered then.
+     */
+    bool renderInputsChanged( const ViewportParams *viewport, const MarbleModel *model );
+
+    void updateRoute();
 
     static QPen         s_pen;
     static QFont        s_font;
 
     QMenu* m_contextMenu;
+
+    AbstractFloatItem::RenderInputs m_renderInputs;
+    QHash<int, qreal> m_thresholds;
+    bool m_routeConnected;
+    bool m_routeChanged;
+
+    // The inputs of the cached content
+    QSize m_viewportSize;
+    GeoDataCoordinates m_center;
+    int m_radius;
+    Projection m_projection;
+    qreal m_heading;
+    GeoDataCoordinates m_position;
+
+    int m_cacheHits;
+    int m_cacheMisses;
 };
 
+bool AbstractFloatItemPrivate::renderInputsChanged( const ViewportParams *viewport, const MarbleModel *model )
+{
+    if ( m_renderInputs == AbstractFloatItem::NoRenderInput ) {
+        return false;
+    }
+
+    const QSize viewportSize = viewport->size();
+    const GeoDataCoordinates center( viewport->centerLongitude(), viewport->centerLatitude() );
+    const int radius = viewport->radius();
+    const Projection projection = viewport->projection();
+    const PositionTracking *tracking = model ? model->positionTracking() : 0;
+    const qreal heading = tracking ? tracking->direction() : 0.0;
+    const GeoDataCoordinates position = tracking ? tracking->currentLocation() : GeoDataCoordinates();
+
+    bool changed = false;
+    if ( m_renderInputs & AbstractFloatItem::ViewportSizeInput ) {
+        changed |= viewportSize != m_viewportSize;
+    }
+    if ( m_renderInputs & AbstractFloatItem::CenterInput ) {
+        changed |= distanceSphere( center, m_center ) > m_thresholds.value( AbstractFloatItem::CenterInput );
+    }
+    if ( m_renderInputs & AbstractFloatItem::RadiusInput ) {
+        changed |= qAbs( radius - m_radius ) > m_thresholds.value( AbstractFloatItem::RadiusInput ) * m_radius;
+    }
+    if ( m_renderInputs & AbstractFloatItem::HeadingInput ) {
+        const qreal difference = fmod( qAbs( heading - m_heading ), 360.0 );
+        changed |= qMin<qreal>( difference, 360.0 - difference ) > m_thresholds.value( AbstractFloatItem::HeadingInput );
+    }
+    if ( m_renderInputs & AbstractFloatItem::PositionInput ) {
+        if ( position.isValid() != m_position.isValid() ) {
+            changed = true;
+        } else if ( position.isValid() ) {
+            changed |= distanceSphere( position, m_position ) > m_thresholds.value( AbstractFloatItem::PositionInput );
+        }
+    }
+    if ( m_renderInputs & AbstractFloatItem::RouteInput ) {
+        changed |= m_routeChanged;
+    }
+    if ( m_renderInputs & AbstractFloatItem::ProjectionInput ) {
+        changed |= projection != m_projection;
+    }
+
+    if ( changed ) {
+        // All inputs are remembered since the renewed content reflects all of them
+        m_viewportSize = viewportSize;
+        m_center = center;
+        m_radius = radius;
+        m_projection = projection;
+        m_heading = heading;
+        m_position = position;
+        m_routeChanged = false;
+    }
+
+    return changed;
+}
+
+void AbstractFloatItemPrivate::updateRoute()
+{
+    m_routeChanged = true;
+}
+
 QPen         AbstractFloatItemPrivate::s_pen = QPen( Qt::black );
 #ifdef Q_OS_MACX
     QFont AbstractFloatItemPrivate::s_font = QFont( "Sans Serif", 10 );
@@ -212,11 +312,70 @@ bool AbstractFloatItem::render( GeoPainter *painter, ViewportParams *viewport,
 
     changeViewport( viewport ); // may invalidate graphics item's cache
 
+    if ( d->renderInputsChanged( viewport, marbleModel() ) ) {
+        update();
+    }
+
+    // A new pixmap is created whenever the content is painted anew
+    const qint64 cacheKey = MarbleGraphicsItem::d->m_pixmap.cacheKey();
+
     paintEvent( painter, viewport );
 
+    if ( visible() ) {
+        if ( cacheMode() != NoCache && MarbleGraphicsItem::d->m_pixmap.cacheKey() == cacheKey ) {
+            ++d->m_cacheHits;
+        } else {
+            ++d->m_cacheMisses;
+        }
+    }
+
     return true;
 }
 
+AbstractFloatItem::RenderInputs AbstractFloatItem::renderInputs() const
+{
+    return d->m_renderInputs;
+}
+
+void AbstractFloatItem::setRenderInputs( RenderInputs inputs )
+{
+    d->m_renderInputs = inputs;
+
+    if ( inputs & RouteInput && !d->m_routeConnected && marbleModel() ) {
+        connect( marbleModel()->routingManager()->routingModel(), SIGNAL(currentRouteChanged()),
+                 this, SLOT(updateRoute()) );
+        d->m_routeConnected = true;
+    }
+
+    update();
+}
+
+qreal AbstractFloatItem::renderInputThreshold( RenderInput input ) const
+{
+    return d->m_thresholds.value( input );
+}
+
+void AbstractFloatItem::setRenderInputThreshold( RenderInput input, qreal threshold )
+{
+    d->m_thresholds[input] = threshold;
+}
+
+int AbstractFloatItem::cacheHits() const
+{
+    return d->m_cacheHits;
+}
+
+int AbstractFloatItem::cacheMisses() const
+{
+    return d->m_cacheMisses;
+}
+
+void AbstractFloatItem::resetCacheStatistics()
+{
+    d->m_cacheHits = 0;
+    d->m_cacheMisses = 0;
+}
+
 void AbstractFloatItem::show()
 {
     setVisible( true );
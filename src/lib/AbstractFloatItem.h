@@ -43,6 +43,12 @@ class AbstractFloatItemPrivate;
  *
  * Good examples are Overview Map, License
  *
+ * The content of float items is cached in a pixmap by default, which is renewed
+ * when update() is called. Items whose content depends on the viewport or on the
+ * position of the gps device can declare these inputs with setRenderInputs()
+ * instead of calling update() themselves on each change: The cached pixmap is
+ * then renewed once an input changed by more than the threshold given with
+ * setRenderInputThreshold().
  */
 
 class MARBLE_EXPORT AbstractFloatItem : public RenderPlugin, public FrameGraphicsItem
@@ -50,6 +56,22 @@ class MARBLE_EXPORT AbstractFloatItem : public RenderPlugin, public FrameGraphic
     Q_OBJECT
 
  public:
+    /**
+     * @brief Inputs the content of a float item can depend on
+     */
+    enum RenderInput {
+        NoRenderInput = 0x0,
+        ViewportSizeInput = 0x1, ///< Size of the viewport, any change renews the cache
+        CenterInput = 0x2,       ///< Center of the viewport, threshold is a distance in radians
+        RadiusInput = 0x4,       ///< Radius of the viewport, threshold is a relative change
+        HeadingInput = 0x8,      ///< Direction of the gps device, threshold is an angle in degrees
+        PositionInput = 0x10,    ///< Position of the gps device, threshold is a distance in radians
+        RouteInput = 0x20,       ///< Current route, any change renews the cache
+        ProjectionInput = 0x40   ///< Projection of the viewport, any change renews the cache
+    };
+
+    Q_DECLARE_FLAGS( RenderInputs, RenderInput )
+
     explicit AbstractFloatItem( const MarbleModel *marbleModel,
                                 const QPointF &point = QPointF( 10.0, 10.0 ),
                                 const QSizeF &size = QSizeF( 150.0, 50.0 ) );
@@ -122,6 +144,34 @@ class MARBLE_EXPORT AbstractFloatItem : public RenderPlugin, public FrameGraphic
      */
     bool positionLocked() const;
 
+    /**
+     * @brief The inputs the content of the item depends on
+     * @see setRenderInputs
+     */
+    RenderInputs renderInputs() const;
+
+    /**
+     * @brief The change of @p input that renews the cached content
+     * @see setRenderInputThreshold
+     */
+    qreal renderInputThreshold( RenderInput input ) const;
+
+    /**
+     * @brief Number of renderings that painted the cached content of the item
+     */
+    int cacheHits() const;
+
+    /**
+     * @brief Number of renderings that painted the content of the item anew
+     * Renderings with cache mode NoCache are always counted as misses.
+     */
+    int cacheMisses() const;
+
+    /**
+     * @brief Sets the number of cache hits and misses to zero
+     */
+    void resetCacheStatistics();
+
  public Q_SLOTS:
     /**
      * @brief Set is position locked
@@ -158,11 +208,32 @@ class MARBLE_EXPORT AbstractFloatItem : public RenderPlugin, public FrameGraphic
     virtual void changeViewport( ViewportParams *viewport );
     QMenu* contextMenu();
 
+    /**
+     * @brief Declares the inputs the content of the item depends on
+     *
+     * Changes of these inputs renew the cached content of the item in addition
+     * to calls of update(). No input is declared by default.
+     */
+    void setRenderInputs( RenderInputs inputs );
+
+    /**
+     * @brief Sets the change of @p input that renews the cached content
+     *
+     * Smaller changes are accumulated until they exceed the threshold. The unit
+     * depends on the input, see RenderInput. The default threshold is 0, such
+     * that any change renews the cached content.
+     */
+    void setRenderInputThreshold( RenderInput input, qreal threshold );
+
  private:
+    Q_PRIVATE_SLOT( d, void updateRoute() )
+
     Q_DISABLE_COPY( AbstractFloatItem )
     AbstractFloatItemPrivate * const d;
 };
 
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS( Marble::AbstractFloatItem::RenderInputs )
+
 #endif
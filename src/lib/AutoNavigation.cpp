@@ -13,17 +13,22 @@
 #include "AutoNavigation.h"
 
 #include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
 #include "PositionTracking.h"
 #include "MarbleDebug.h"
 #include "MarbleModel.h"
 #include "MarbleMath.h"
 #include "ViewportParams.h"
 #include "MarbleGlobal.h"
+#include "RoutingManager.h"
+#include "RoutingModel.h"
+#include "Route.h"
 
 #include <QPixmap>
 #include <QWidget>
 #include <QRect>
 #include <QPointF>
+#include <QTime>
 #include <QTimer>
 #include <math.h>
 
@@ -41,6 +46,7 @@ public:
     bool                 m_adjustZoom;
     QTimer               m_lastWidgetInteraction;
     bool                 m_selfInteraction;
+    QTime                m_lastPrefetch;
 
     /** Constructor */
     Private( MarbleModel *model, const ViewportParams *viewport, AutoNavigation *parent );
@@ -69,6 +75,12 @@ public:
        * Center the widget on the given position unless recentering is currently inhibited
        */
      void centerOn( const GeoDataCoordinates &position );
+
+     /**
+       * Request the tiles along the route ahead of the current position
+       * @param speed of the gps device, determines how far to look ahead
+       */
+     void prefetchRouteAhead( qreal speed );
 };
 
 AutoNavigation::Private::Private( MarbleModel *model, const ViewportParams *viewport, AutoNavigation *parent ) :
@@ -315,6 +327,46 @@ void AutoNavigation::Private::centerOn( const GeoDataCoordinates &position )
     m_selfInteraction = false;
 }
 
+void AutoNavigation::Private::prefetchRouteAhead( qreal speed )
+{
+    // the route ahead changes slowly, so do not replace the prefetched tiles too often
+    if ( !m_lastPrefetch.isNull() && m_lastPrefetch.elapsed() < 10 * 1000 ) {
+        return;
+    }
+
+    const Route &route = m_model->routingManager()->routingModel()->route();
+    if ( route.size() == 0 || !route.currentSegment().isValid() ) {
+        return;
+    }
+    m_lastPrefetch.start();
+
+    // the distance covered in the next five minutes, but at least 5 km
+    const qreal lookAhead = qMax<qreal>( 5000.0, speed * 300.0 );
+    const qreal planetRadius = m_model->planetRadius();
+
+    GeoDataLineString path;
+    path << route.positionOnRoute();
+    qreal distance = 0.0;
+
+    const GeoDataCoordinates waypoint = route.currentWaypoint();
+    bool ahead = false;
+    for ( const RouteSegment *segment = &route.currentSegment(); segment->isValid() && distance < lookAhead;
+          segment = &segment->nextRouteSegment() ) {
+        const GeoDataLineString &segmentPath = segment->path();
+        for ( int i = 0; i < segmentPath.size() && distance < lookAhead; ++i ) {
+            // points of the current segment up to the next waypoint are behind already
+            ahead = ahead || segmentPath.at( i ) == waypoint;
+            if ( ahead ) {
+                distance += planetRadius * distanceSphere( path.last(), segmentPath.at( i ) );
+                path << segmentPath.at( i );
+            }
+        }
+        ahead = true;
+    }
+
+    emit m_parent->prefetchTiles( path, m_viewport->radius() );
+}
+
 AutoNavigation::AutoNavigation( MarbleModel *model, const ViewportParams *viewport, QObject *parent ) :
     QObject( parent ),
     d( new AutoNavigation::Private( model, viewport, this ) )
@@ -340,9 +392,11 @@ void AutoNavigation::adjust( const GeoDataCoordinates &position, qreal speed )
         break;
     case AlwaysRecenter:
         d->centerOn( position );
+        d->prefetchRouteAhead( speed );
         break;
     case RecenterOnBorder:
         d->moveOnBorderToCenter( position, speed );
+        d->prefetchRouteAhead( speed );
         break;
     }
 
@@ -20,6 +20,7 @@ namespace Marble
 {
 
 class GeoDataCoordinates;
+class GeoDataLineString;
 class MarbleModel;
 class PositionTracking;
 class ViewportParams;
@@ -99,6 +100,14 @@ Q_SIGNALS:
 
     void centerOn( const GeoDataCoordinates &position, bool animated );
 
+    /**
+     * signal emitted periodically while following a route with the part of
+     * the route that will be shown next
+     * @param path the route ahead of the current position
+     * @param radius the radius of the map
+     */
+    void prefetchTiles( const GeoDataLineString &path, int radius );
+
 private:
     class Private;
     Private * const d;
@@ -172,6 +172,8 @@ void CurrentLocationWidget::setMarbleWidget( MarbleWidget *widget )
              d->m_widget, SLOT(zoomOut(FlyToMode)) );
     connect( d->m_adjustNavigation, SIGNAL(centerOn(GeoDataCoordinates,bool)),
              d->m_widget, SLOT(centerOn(GeoDataCoordinates,bool)) );
+    connect( d->m_adjustNavigation, SIGNAL(prefetchTiles(GeoDataLineString,int)),
+             d->m_widget, SLOT(prefetchTiles(GeoDataLineString,int)) );
 
     connect( d->m_widget, SIGNAL(visibleLatLonAltBoxChanged(GeoDataLatLonAltBox)),
              d->m_adjustNavigation, SLOT(inhibitAutoAdjustments()) );
@@ -0,0 +1,139 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+// krazy:excludeall=inline
+
+#ifndef MARBLE_FASTMATH_H
+#define MARBLE_FASTMATH_H
+
+#include <QtGlobal>
+
+#include <cmath>
+
+namespace Marble
+{
+
+/**
+ * @brief Accuracy of the trigonometric functions used for batches of points
+ *
+ * The approximations are evaluated without any calls into the C library and
+ * without tables, so that loops over arrays of points can be vectorized by the
+ * compiler.
+ */
+enum MathPrecision {
+    ExactPrecision,  ///< the functions of the C library
+    HighPrecision,   ///< absolute error below 1e-8, i.e. less than 10 cm on earth
+    LowPrecision     ///< absolute error below 1e-4, still far below a pixel on the globe
+};
+
+/**
+ * @brief Calculates the sine and the cosine of @p angle (in radians) at once.
+ *
+ * The angle is reduced to [-pi/4, pi/4] and the Taylor series of both functions
+ * is evaluated there. The error grows slowly with the magnitude of the angle,
+ * the given bounds hold for angles in [-4pi, 4pi].
+ */
+inline void fastSinCos( qreal angle, qreal &sine, qreal &cosine, MathPrecision precision )
+{
+    if ( precision == ExactPrecision ) {
+        sine = std::sin( angle );
+        cosine = std::cos( angle );
+        return;
+    }
+
+    // pi/2 split into a part exactly representable in a few bits and the rest
+    const qreal halfPi1 = 1.5707963109016418;
+    const qreal halfPi2 = 1.5893254712295857e-08;
+
+    const qreal quadrant = std::floor( angle * M_2_PI + 0.5 );
+    const qreal r = ( angle - quadrant * halfPi1 ) - quadrant * halfPi2;
+    const qreal r2 = r * r;
+
+    qreal s;
+    qreal c;
+    if ( precision == HighPrecision ) {
+        s = r + r * r2 * ( -1.0 / 6.0 + r2 * ( 1.0 / 120.0 + r2 * ( -1.0 / 5040.0 + r2 * ( 1.0 / 362880.0 ) ) ) );
+        c = 1.0 + r2 * ( -0.5 + r2 * ( 1.0 / 24.0 + r2 * ( -1.0 / 720.0 + r2 * ( 1.0 / 40320.0 + r2 * ( -1.0 / 3628800.0 ) ) ) ) );
+    } else {
+        s = r + r * r2 * ( -1.0 / 6.0 + r2 * ( 1.0 / 120.0 ) );
+        c = 1.0 + r2 * ( -0.5 + r2 * ( 1.0 / 24.0 + r2 * ( -1.0 / 720.0 ) ) );
+    }
+
+    switch ( static_cast<int>( quadrant ) & 3 ) {
+    case 0:
+        sine = s;
+        cosine = c;
+        break;
+    case 1:
+        sine = c;
+        cosine = -s;
+        break;
+    case 2:
+        sine = -s;
+        cosine = -c;
+        break;
+    default:
+        sine = -c;
+        cosine = s;
+        break;
+    }
+}
+
+/**
+ * @brief Calculates the arc tangent of @p y / @p x (in radians) in the range [-pi, pi].
+ *
+ * The argument is reduced to [-tan(pi/8), tan(pi/8)] and the Taylor series is
+ * evaluated there. Returns 0 if both @p x and @p y are 0.
+ */
+inline qreal fastAtan2( qreal y, qreal x, MathPrecision precision )
+{
+    if ( precision == ExactPrecision ) {
+        return std::atan2( y, x );
+    }
+
+    const qreal tanPi8 = 0.41421356237309503;
+
+    const qreal ax = qAbs( x );
+    const qreal ay = qAbs( y );
+    const qreal max = qMax( ax, ay );
+    if ( max == 0.0 ) {
+        return 0.0;
+    }
+
+    // a is in [0, 1], atan( a ) = pi/4 + atan( ( a - 1 ) / ( a + 1 ) )
+    const qreal a = qMin( ax, ay ) / max;
+    const bool shifted = a > tanPi8;
+    const qreal t = shifted ? ( a - 1.0 ) / ( a + 1.0 ) : a;
+    const qreal t2 = t * t;
+
+    qreal result;
+    if ( precision == HighPrecision ) {
+        result = t + t * t2 * ( -1.0 / 3.0 + t2 * ( 1.0 / 5.0 + t2 * ( -1.0 / 7.0 + t2 * ( 1.0 / 9.0
+                   + t2 * ( -1.0 / 11.0 + t2 * ( 1.0 / 13.0 + t2 * ( -1.0 / 15.0 + t2 * ( 1.0 / 17.0 ) ) ) ) ) ) ) );
+    } else {
+        result = t + t * t2 * ( -1.0 / 3.0 + t2 * ( 1.0 / 5.0 + t2 * ( -1.0 / 7.0 ) ) );
+    }
+
+    if ( shifted ) {
+        result += M_PI_4;
+    }
+    if ( ay > ax ) {
+        result = M_PI_2 - result;
+    }
+    if ( x < 0.0 ) {
+        result = M_PI - result;
+    }
+
+    return y < 0.0 ? -result : result;
+}
+
+}
+
+#endif
@@ -52,6 +52,9 @@ public:
           m_document( 0 ),
           m_clock( model->clock() )
     {
+        // large KML and GPX files are split into chunks parsed on all cores
+        m_runner.setThreadCount( QThread::idealThreadCount() );
+
         if( m_style ) {
             m_styleMap->setStyleId("default-map");
             m_styleMap->insert("normal", QString("#").append(m_style->styleId()));
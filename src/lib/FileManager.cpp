@@ -194,12 +194,17 @@ void FileManagerPrivate::cleanupLoader( FileLoader* loader )
             }
         }
         if ( !loader->error().isEmpty() ) {
-            QMessageBox errorBox;
-            errorBox.setWindowTitle( QObject::tr("File Parsing Error"));
-            errorBox.setText( loader->error() );
-            errorBox.setIcon( QMessageBox::Warning );
-            errorBox.exec();
+            emit q->fileError( loader->path(), loader->error() );
+            if ( q->receivers( SIGNAL(fileError(QString,QString)) ) == 0 ) {
+                QMessageBox errorBox;
+                errorBox.setWindowTitle( QObject::tr("File Parsing Error"));
+                errorBox.setText( loader->error() );
+                errorBox.setIcon( QMessageBox::Warning );
+                errorBox.exec();
+            }
             qWarning() << "File Parsing error " << loader->error();
+        } else if ( !doc ) {
+            emit q->fileError( loader->path(), QObject::tr( "Cannot load %1" ).arg( loader->path() ) );
         }
         delete loader;
     }
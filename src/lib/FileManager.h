@@ -84,6 +84,12 @@ class FileManager : public QObject
     void fileRemoved( const QString &key );
     void centeredDocument( const GeoDataLatLonBox& );
 
+    /**
+     * A file could not be loaded. The error is shown in a message box
+     * unless something is connected to this signal.
+     */
+    void fileError( const QString &key, const QString &error );
+
  private:
 
     Q_PRIVATE_SLOT( d, void cleanupLoader( FileLoader *loader ) )
@@ -60,6 +60,9 @@ bool FileStoragePolicy::updateFile( const QString &fileName, const QByteArray &d
     if ( !QDir( localFileDirPath ).exists() )
         QDir::root().mkpath( localFileDirPath );
 
+    // Opening the file truncates it, so remember the size before
+    const qint64 oldSize = info.exists() ? info.size() : 0;
+
     // ... and save the file content
     QFile file( fullName );
     if ( !file.open( QIODevice::WriteOnly ) ) {
@@ -68,8 +71,6 @@ bool FileStoragePolicy::updateFile( const QString &fileName, const QByteArray &d
         return false;
     }
 
-    quint64 oldSize = file.size();
-
     if ( !file.write( data ) ) {
         m_errorMsg = QString( "%1: %2" ).arg( fullName ).arg( file.errorString() );
         qCritical() << "file.write" << m_errorMsg;
@@ -78,6 +79,7 @@ bool FileStoragePolicy::updateFile( const QString &fileName, const QByteArray &d
     }
 
     emit sizeChanged( file.size() - oldSize );
+    emit fileUpdated( fileName, file.size() );
     file.close();
 
     return true;
@@ -12,9 +12,11 @@
 #include "FileStorageWatcher.h"
 
 // Qt
+#include <QDataStream>
 #include <QDateTime>
 #include <QDir>
 #include <QDirIterator>
+#include <QFile>
 #include <QFileInfo>
 #include <QTimer>
 
@@ -32,13 +34,31 @@ static const int maxFilesDelete = 20;
 static const int deleteOnlyFilesOlderThan = 120;
 static const int softLimitPercent = 5;
 
+// The index file starts with a header consisting of magic number, version,
+// a flag whether it was closed properly and the cache size. It is followed
+// by records of path, size and last access of tiles. Later records replace
+// earlier ones of the same path.
+static const quint32 indexMagic = 0x4d544349;
+static const quint32 indexVersion = 1;
+static const qint64 indexHeaderSize = 17;
+// Special sizes of records
+static const qint64 removedFile = -1;
+static const qint64 accessedFile = -2;
+// Write changes to the index once a minute
+static const int flushInterval = 60 * 1000;
+
 
 // Methods of FileStorageWatcherThread
 FileStorageWatcherThread::FileStorageWatcherThread( const QString &dataDirectory, QObject *parent )
     : QObject( parent ),
       m_dataDirectory( dataDirectory ),
+      m_currentCacheSize( 0 ),
       m_deleting( false ),
-      m_willQuit( false )
+      m_willQuit( false ),
+      m_indexLoaded( false ),
+      m_indexValid( false ),
+      m_serial( 0 ),
+      m_indexRecords( 0 )
 {
     // For now setting cache limit to 0. This won't delete anything
     setCacheLimit( 0 );
@@ -51,6 +71,14 @@ FileStorageWatcherThread::FileStorageWatcherThread( const QString &dataDirectory
 
 FileStorageWatcherThread::~FileStorageWatcherThread()
 {
+    flushIndex();
+    
+    // Only an index that was checked at startup may be trusted next time
+    QFile file( indexFileName( m_dataDirectory ) );
+    if ( m_indexValid && file.size() >= indexHeaderSize
+	 && file.open( QIODevice::ReadWrite ) ) {
+	writeIndexHeader( &file, true );
+    }
 }
 
 quint64 FileStorageWatcherThread::cacheLimit()
@@ -58,6 +86,16 @@ quint64 FileStorageWatcherThread::cacheLimit()
     return m_cacheLimit;
 }
 
+quint64 FileStorageWatcherThread::currentCacheSize() const
+{
+    return m_currentCacheSize;
+}
+
+QString FileStorageWatcherThread::indexFileName( const QString &dataDirectory )
+{
+    return dataDirectory + "/tilecache.index";
+}
+
 void FileStorageWatcherThread::setCacheLimit( quint64 bytes )
 {
     m_limitMutex.lock();
@@ -80,10 +118,38 @@ void FileStorageWatcherThread::addToCurrentSize( qint64 bytes )
 
 void FileStorageWatcherThread::resetCurrentSize()
 {
-    m_currentCacheSize = 0;
+    rebuildIndex();
     emit variableChanged();
 }
 
+void FileStorageWatcherThread::updateFile( const QString &fileName, qint64 size )
+{
+    const QByteArray path = relativePath( fileName );
+    if ( !isDeletable( path ) ) {
+	return;
+    }
+    
+    IndexRecord record = { size, QDateTime::currentDateTime().toTime_t() };
+    if ( m_indexLoaded ) {
+	applyRecord( path, record );
+    }
+    addRecord( path, record );
+}
+
+void FileStorageWatcherThread::accessFile( const QString &fileName )
+{
+    const QByteArray path = relativePath( fileName );
+    if ( !isDeletable( path ) ) {
+	return;
+    }
+    
+    IndexRecord record = { accessedFile, QDateTime::currentDateTime().toTime_t() };
+    if ( m_indexLoaded ) {
+	applyRecord( path, record );
+    }
+    addRecord( path, record );
+}
+
 void FileStorageWatcherThread::updateTheme( const QString &mapTheme )
 {
     mDebug() << "Theme changed to " << mapTheme;
@@ -100,17 +166,32 @@ void FileStorageWatcherThread::prepareQuit()
 
 void FileStorageWatcherThread::getCurrentCacheSize()
 {
-    mDebug() << "FileStorageWatcher: Creating cache size";
-    quint64 dataSize = 0;
-    QDirIterator it( m_dataDirectory, QDir::Files, QDirIterator::Subdirectories );
-    
-    while( it.hasNext() && !m_willQuit )
-    {
-	it.next();
-	QFileInfo file = it.fileInfo();
-	dataSize += file.size();
+    mDebug() << "FileStorageWatcher: Reading cache size";
+    QFile file( indexFileName( m_dataDirectory ) );
+    if ( file.size() >= indexHeaderSize && file.open( QIODevice::ReadWrite ) ) {
+	QDataStream stream( &file );
+	stream.setVersion( QDataStream::Qt_4_6 );
+	quint32 magic = 0;
+	quint32 version = 0;
+	quint8 consistent = 0;
+	quint64 cacheSize = 0;
+	stream >> magic >> version >> consistent >> cacheSize;
+	
+	if (    stream.status() == QDataStream::Ok
+	     && magic == indexMagic
+	     && version == indexVersion
+	     && consistent )
+	{
+	    m_currentCacheSize = cacheSize;
+	    m_indexValid = true;
+	    // If we crash, the index has to be rebuilt on the next start
+	    writeIndexHeader( &file, false );
+	    return;
+	}
+	file.close();
     }
-    m_currentCacheSize = dataSize;
+    
+    rebuildIndex();
 }
 
 void FileStorageWatcherThread::ensureCacheSize()
@@ -142,41 +223,12 @@ void FileStorageWatcherThread::ensureCacheSize()
 	    return;
 	}
 	
-	// Which planet do we show now.
-	// We have to delete files for this planet at last
-	QStringList currentList = m_mapThemeId.split( '/' );
-	QString shownPlanet( currentList.first() );
-	currentList.removeFirst();
-	// The QString to save the path of the directory to the current planet
-	QString lastPlanet;
-	
-	QString cachedMapsDirectory = m_dataDirectory + "/maps";
-
-	// Iterator over planet directories
-	QDirIterator it( cachedMapsDirectory,
-			 QDir::NoDotAndDotDot | QDir::Dirs );
-
-	while ( it.hasNext() &&
-	        keepDeleting() ) {
-	    it.next();
-	    
-	    // Our current planet directory
-	    QString planetDirectory = it.filePath();
-	    QFileInfo fileInfo = it.fileInfo();
-	    
-	    // We have found the currently shown planet.
-	    // Please delete here at last.
-	    if( fileInfo.fileName() == shownPlanet ) {
-		lastPlanet = planetDirectory;
-		continue;
-	    }
-	    
-	    ensureSizePerPlanet( planetDirectory );
+	// Only the header was read at startup
+	if ( !m_indexLoaded ) {
+	    loadIndex();
 	}
 	
-	if( keepDeleting() ) {
-	    ensureSizePerPlanet( lastPlanet, currentList.first() );
-	}
+	deleteLeastRecentlyUsed();
 	
 	// We have deleted enough files. 
 	// Perhaps there are changes.
@@ -199,100 +251,269 @@ void FileStorageWatcherThread::ensureCacheSize()
     }
 }
 
-void FileStorageWatcherThread::ensureSizePerPlanet( const QString &planetDirectory,
-                                                    const QString &currentTheme )
+void FileStorageWatcherThread::flushIndex()
 {
-    mDebug() << "Deleting from folder: " << planetDirectory;
+    if ( m_pendingRecords.isEmpty() ) {
+	return;
+    }
     
-    // lastTheme will store the path to our currentTheme
-    QString lastTheme;
+    // Compact the index if most records are outdated
+    if ( m_indexLoaded && m_indexRecords > 2 * m_index.size() + 1000 ) {
+	writeIndex();
+	return;
+    }
     
-    QDirIterator itPlanet( planetDirectory,
-	                   QDir::NoDotAndDotDot | QDir::Dirs );
-    while( itPlanet.hasNext() &&
-	   keepDeleting() ) {
-	itPlanet.next();
-	QString themeDirectory = itPlanet.filePath();
-	QFileInfo fileInfo = itPlanet.fileInfo();
-	
-	// We have found the currently shown theme.
-	// Please delete here at last.
-	if( !currentTheme.isEmpty() && fileInfo.fileName() == currentTheme ) {
-	    mDebug() << "FileStorageWatcher: Skipping " << themeDirectory
-	             << " for now";
-	    lastTheme = themeDirectory;
+    QFile file( indexFileName( m_dataDirectory ) );
+    if ( file.size() < indexHeaderSize || !file.open( QIODevice::ReadWrite ) ) {
+	// Without an index the changes are not needed, it is
+	// rebuilt on the next start anyway
+	if ( !m_indexLoaded || !writeIndex() ) {
+	    m_pendingRecords.clear();
+	}
+	return;
+    }
+    
+    writeIndexHeader( &file, false );
+    file.seek( file.size() );
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_6 );
+    QHash<QByteArray, IndexRecord>::const_iterator it = m_pendingRecords.constBegin();
+    QHash<QByteArray, IndexRecord>::const_iterator const end = m_pendingRecords.constEnd();
+    for ( ; it != end; ++it ) {
+	stream << it.key() << it.value().size << quint32( it.value().access );
+    }
+    
+    m_indexRecords += m_pendingRecords.size();
+    m_pendingRecords.clear();
+}
+
+void FileStorageWatcherThread::rebuildIndex()
+{
+    mDebug() << "FileStorageWatcher: Creating cache index";
+    const QString indexPath = QFileInfo( indexFileName( m_dataDirectory ) ).absoluteFilePath();
+    QFile::remove( indexPath );
+    m_index.clear();
+    m_accessOrder.clear();
+    m_pendingRecords.clear();
+    m_indexLoaded = false;
+    m_indexValid = false;
+    
+    quint64 dataSize = 0;
+    QDirIterator it( m_dataDirectory, QDir::Files, QDirIterator::Subdirectories );
+    
+    while( it.hasNext() && !m_willQuit )
+    {
+	it.next();
+	QFileInfo file = it.fileInfo();
+	if ( file.absoluteFilePath() == indexPath ) {
 	    continue;
 	}
 	
-	ensureSizePerTheme( themeDirectory );
+	dataSize += file.size();
+	const QByteArray path = relativePath( file.absoluteFilePath() );
+	if ( isDeletable( path ) ) {
+	    // The best guess for the last access
+	    IndexRecord record = { file.size(), file.lastModified().toTime_t() };
+	    applyRecord( path, record );
+	}
     }
+    m_currentCacheSize = dataSize;
     
-    if( keepDeleting() ) {
-	mDebug() << "Removing files of: "
-	         << lastTheme;
-	ensureSizePerTheme( lastTheme );
+    if ( !m_willQuit ) {
+	m_indexLoaded = true;
+	m_indexValid = writeIndex();
     }
 }
 
-static bool greaterThanByNumber( const QString &s1, const QString &s2)
+void FileStorageWatcherThread::loadIndex()
 {
-    return s1.toInt() > s2.toInt();
+    mDebug() << "FileStorageWatcher: Loading cache index";
+    m_index.clear();
+    m_accessOrder.clear();
+    
+    QFile file( indexFileName( m_dataDirectory ) );
+    bool valid = file.open( QIODevice::ReadOnly );
+    int records = 0;
+    if ( valid ) {
+	QDataStream stream( &file );
+	stream.setVersion( QDataStream::Qt_4_6 );
+	quint32 magic = 0;
+	quint32 version = 0;
+	quint8 consistent = 0;
+	quint64 cacheSize = 0;
+	stream >> magic >> version >> consistent >> cacheSize;
+	valid =    stream.status() == QDataStream::Ok
+		&& magic == indexMagic
+		&& version == indexVersion;
+	
+	while ( valid && !stream.atEnd() ) {
+	    QByteArray path;
+	    IndexRecord record;
+	    quint32 access = 0;
+	    stream >> path >> record.size >> access;
+	    valid = stream.status() == QDataStream::Ok;
+	    if ( valid ) {
+		record.access = access;
+		applyRecord( path, record );
+		++records;
+	    }
+	}
+    }
+    
+    if ( !valid ) {
+	mDebug() << "FileStorageWatcher: Cache index is corrupt";
+	rebuildIndex();
+	return;
+    }
+    
+    // Changes since startup are newer than everything in the file
+    QHash<QByteArray, IndexRecord>::const_iterator it = m_pendingRecords.constBegin();
+    QHash<QByteArray, IndexRecord>::const_iterator const end = m_pendingRecords.constEnd();
+    for ( ; it != end; ++it ) {
+	applyRecord( it.key(), it.value() );
+    }
+    
+    m_indexRecords = records;
+    m_indexLoaded = true;
 }
 
-void FileStorageWatcherThread::ensureSizePerTheme( const QString &themeDirectory )
+bool FileStorageWatcherThread::writeIndex()
 {
-    mDebug() << "Deleting from folder: " << themeDirectory;
-
-    // Delete from folders with high numbers first
-    QStringList folders =
-	QDir( themeDirectory ).entryList(   QDir::Dirs
-					  | QDir::NoDotAndDotDot );
-    qSort( folders.begin(), folders.end(), greaterThanByNumber );
+    const QString indexPath = indexFileName( m_dataDirectory );
+    QFile file( indexPath + ".new" );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+	mDebug() << "FileStorageWatcher: Cannot write" << file.fileName();
+	return false;
+    }
+    
+    writeIndexHeader( &file, false );
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_6 );
+    QMap<quint64, QByteArray>::const_iterator it = m_accessOrder.constBegin();
+    QMap<quint64, QByteArray>::const_iterator const end = m_accessOrder.constEnd();
+    for ( ; it != end; ++it ) {
+	stream << it.value() << m_index.value( it.value() ).size << quint32( it.key() >> 32 );
+    }
+    file.close();
+    
+    QFile::remove( indexPath );
+    if ( !file.rename( indexPath ) ) {
+	mDebug() << "FileStorageWatcher: Cannot write" << indexPath;
+	return false;
+    }
     
-    QStringListIterator itTheme( folders );
-    while ( itTheme.hasNext() &&
-	    keepDeleting() ) {
-	QString subDirectory = itTheme.next();
+    m_indexRecords = m_index.size();
+    m_pendingRecords.clear();
+    return true;
+}
 
-	// Do not delete base tiles
-	if ( subDirectory.toInt() <= maxBaseTileLevel ) {
-	    continue;
+void FileStorageWatcherThread::writeIndexHeader( QIODevice *device, bool consistent ) const
+{
+    device->seek( 0 );
+    QDataStream stream( device );
+    stream.setVersion( QDataStream::Qt_4_6 );
+    stream << indexMagic << indexVersion << quint8( consistent ? 1 : 0 ) << quint64( m_currentCacheSize );
+}
+
+void FileStorageWatcherThread::applyRecord( const QByteArray &path, const IndexRecord &record )
+{
+    QHash<QByteArray, IndexEntry>::iterator entry = m_index.find( path );
+    if ( entry != m_index.end() ) {
+	m_accessOrder.remove( entry.value().key );
+	if ( record.size == removedFile ) {
+	    m_index.erase( entry );
+	    return;
 	}
+    }
+    else if ( record.size == removedFile || record.size == accessedFile ) {
+	// Not a cached tile we know of
+	return;
+    }
+    else {
+	entry = m_index.insert( path, IndexEntry() );
+    }
+    
+    if ( record.size != accessedFile ) {
+	entry.value().size = record.size;
+    }
+    entry.value().key = ( quint64( record.access ) << 32 ) | m_serial++;
+    m_accessOrder.insert( entry.value().key, entry.key() );
+}
+
+void FileStorageWatcherThread::addRecord( const QByteArray &path, const IndexRecord &record )
+{
+    if ( m_pendingRecords.isEmpty() ) {
+	QTimer::singleShot( flushInterval, this, SLOT(flushIndex()) );
+    }
+    
+    QHash<QByteArray, IndexRecord>::iterator pending = m_pendingRecords.find( path );
+    if ( pending == m_pendingRecords.end() || record.size != accessedFile ) {
+	m_pendingRecords.insert( path, record );
+    }
+    else if ( pending.value().size != removedFile ) {
+	// Keep the size of a previous update
+	pending.value().access = record.access;
+    }
+}
+
+void FileStorageWatcherThread::deleteLeastRecentlyUsed()
+{
+    const uint now = QDateTime::currentDateTime().toTime_t();
+    
+    while ( keepDeleting() && !m_accessOrder.isEmpty() ) {
+	QMap<quint64, QByteArray>::iterator oldest = m_accessOrder.begin();
 	
-	QString tileDirectory = themeDirectory + '/' + subDirectory;
-	
-	QDirIterator itTile( tileDirectory,
-			     QDir::Files | QDir::NoSymLinks,
-			     QDirIterator::Subdirectories );
-	while ( itTile.hasNext() &&
-	        keepDeleting() ) {
-	    itTile.next();
-	    QString filePath = itTile.filePath();
-	    QString lowerCase = filePath.toLower();
+	// Do not delete files used within the last two minutes.
+	// All remaining files have been used even later.
+	if ( qint64( now ) - qint64( oldest.key() >> 32 ) <= deleteOnlyFilesOlderThan ) {
+	    break;
+	}
 	
-	    QFileInfo info( filePath );
+	const QByteArray path = oldest.value();
+	const quint64 size = m_index.value( path ).size;
+	IndexRecord record = { removedFile, now };
+	applyRecord( path, record );
+	addRecord( path, record );
 	
-	    // We try to be very careful and just delete images
-	    // Do not delete files younger than two minutes.
-        // FIXME, when vectortiling I suppose also vector tiles will have
-        // to be deleted
-	    if (   (    lowerCase.endsWith( QLatin1String( ".jpg" ) ) 
-	             || lowerCase.endsWith( QLatin1String( ".png" ) )
-	             || lowerCase.endsWith( QLatin1String( ".gif" ) )
-	             || lowerCase.endsWith( QLatin1String( ".svg" ) ) )
-		&& ( info.lastModified().secsTo( QDateTime::currentDateTime() )
-		     > deleteOnlyFilesOlderThan ) )
-	    {
-		mDebug() << "FileStorageWatcher: Delete "
-		         << filePath;
-		m_filesDeleted++;
-		m_currentCacheSize -= info.size();
-		QFile::remove( filePath );
-	    }
+	// The file may have been deleted behind our back
+	const QString filePath = m_dataDirectory + '/' + QString::fromUtf8( path );
+	if ( QFile::remove( filePath ) ) {
+	    mDebug() << "FileStorageWatcher: Delete "
+		     << filePath;
+	    m_filesDeleted++;
+	    m_currentCacheSize -= qMin( size, m_currentCacheSize );
 	}
     }
 }
 
+QByteArray FileStorageWatcherThread::relativePath( const QString &fileName ) const
+{
+    const QString path = QFileInfo( fileName ).isAbsolute()
+			 ? QDir( m_dataDirectory ).relativeFilePath( fileName )
+			 : fileName;
+    return QDir::cleanPath( path ).toUtf8();
+}
+
+bool FileStorageWatcherThread::isDeletable( const QByteArray &path )
+{
+    // Only tiles of maps/<planet>/<theme>/<level>, but no base tiles
+    const QList<QByteArray> parts = path.split( '/' );
+    if (    parts.size() < 5
+	 || parts.first() != "maps"
+	 || parts.at( 3 ).toInt() <= maxBaseTileLevel ) {
+	return false;
+    }
+    
+    // We try to be very careful and just delete images
+    // FIXME, when vectortiling I suppose also vector tiles will have
+    // to be deleted
+    const QByteArray lowerCase = path.toLower();
+    return lowerCase.endsWith( ".jpg" )
+	|| lowerCase.endsWith( ".png" )
+	|| lowerCase.endsWith( ".gif" )
+	|| lowerCase.endsWith( ".svg" );
+}
+
 bool FileStorageWatcherThread::keepDeleting() const
 {
     return ( ( m_currentCacheSize > m_cacheSoftLimit ) &&
@@ -318,6 +539,7 @@ FileStorageWatcher::FileStorageWatcher( const QString &dataDirectory, QObject *
     
     m_thread = 0;
     m_quitting = false;
+    m_indexRemoved = false;
 }
 
 FileStorageWatcher::~FileStorageWatcher()
@@ -369,6 +591,24 @@ void FileStorageWatcher::resetCurrentSize()
     emit cleared();
 }
 
+void FileStorageWatcher::updateFile( const QString &fileName, qint64 size )
+{
+    if( m_started ) {
+	emit fileUpdated( fileName, size );
+    }
+    else if( !m_indexRemoved ) {
+	// The index would miss this file
+	QFile::remove( FileStorageWatcherThread::indexFileName( m_dataDirectory ) );
+	m_indexRemoved = true;
+    }
+}
+
+void FileStorageWatcher::accessFile( const QString &fileName )
+{
+    if( m_started )
+	emit fileAccessed( fileName );
+}
+
 void FileStorageWatcher::updateTheme( const QString &mapTheme )
 {
     QMutexLocker locker( m_themeLimitMutex );
@@ -383,19 +623,25 @@ void FileStorageWatcher::run()
 {
     m_thread = new FileStorageWatcherThread( m_dataDirectory );
     if( !m_quitting ) {
+	connect( this, SIGNAL(sizeChanged(qint64)),
+		 m_thread, SLOT(addToCurrentSize(qint64)) );
+	connect( this, SIGNAL(cleared()),
+		 m_thread, SLOT(resetCurrentSize()) );
+	connect( this, SIGNAL(fileUpdated(QString,qint64)),
+		 m_thread, SLOT(updateFile(QString,qint64)) );
+	connect( this, SIGNAL(fileAccessed(QString)),
+		 m_thread, SLOT(accessFile(QString)) );
+	
+	m_thread->getCurrentCacheSize();
+	
+	// Updates are only forwarded once the index is loaded and
+	// connected, earlier ones invalidate the index instead
 	m_themeLimitMutex->lock();
 	m_thread->setCacheLimit( m_limit );
 	m_thread->updateTheme( m_theme );
 	m_started = true;
 	mDebug() << m_started;
 	m_themeLimitMutex->unlock();
-	
-	m_thread->getCurrentCacheSize();
-	
-	connect( this, SIGNAL(sizeChanged(qint64)),
-		 m_thread, SLOT(addToCurrentSize(qint64)) );
-	connect( this, SIGNAL(cleared()),
-		 m_thread, SLOT(resetCurrentSize()) );
     
 	// Make sure that we don't want to stop process.
 	// The thread wouldn't exit from event loop.
@@ -12,24 +12,47 @@
 #define MARBLE_FILESTORAGEWATCHER_H
 
 #include <QThread>
+#include <QHash>
+#include <QMap>
 #include <QMutex>
 #include <QSet>
 
+#include "marble_export.h"
+
+class QIODevice;
+
 namespace Marble
 {
     
 // Lives inside the new Thread
-class FileStorageWatcherThread : public QObject
+/**
+ * Keeps the tile cache below its limit. An index of the cached tiles in the
+ * file returned by indexFileName() records their size and last access, so
+ * that the least recently used tiles are deleted first and the cache size is
+ * known at startup without scanning the data directory. Missing or corrupt
+ * indices, e.g. after a crash, are rebuilt from the files on disk.
+ */
+class MARBLE_EXPORT FileStorageWatcherThread : public QObject
 {
     Q_OBJECT
     
     public:
 	explicit FileStorageWatcherThread( const QString &dataDirectory, QObject * parent = 0 );
 	
+	/**
+	 * Writes pending changes to the index and marks it consistent.
+	 */
 	~FileStorageWatcherThread();
     
 	quint64 cacheLimit();
 	
+	quint64 currentCacheSize() const;
+	
+	/**
+	 * Returns the path of the cache index for @p dataDirectory.
+	 */
+	static QString indexFileName( const QString &dataDirectory );
+	
     Q_SIGNALS:
 	/**
 	 * Is emitted when a variable has changed.
@@ -49,10 +72,23 @@ class FileStorageWatcherThread : public QObject
 	void addToCurrentSize( qint64 bytes );
 	
 	/**
-	 * Setting current cache size to 0.
+	 * Rescans the data directory after files were removed
+	 * from the cache behind our back.
 	 */
 	void resetCurrentSize();
 	
+	/**
+	 * Records that @p fileName was written with @p size bytes.
+	 * Relative file names are relative to the data directory.
+	 */
+	void updateFile( const QString &fileName, qint64 size );
+	
+	/**
+	 * Records that @p fileName was read, so that it is deleted later.
+	 * Relative file names are relative to the data directory.
+	 */
+	void accessFile( const QString &fileName );
+	
 	/**
 	 * Updates the name of the theme.
 	 * Important for deleting behavior.
@@ -67,7 +103,8 @@ class FileStorageWatcherThread : public QObject
 	void prepareQuit();
 	
 	/**
-	 * Getting the current size of the data stored on the disc
+	 * Getting the current size of the data stored on the disc.
+	 * Only the header of the index is read, unless the index has to be rebuilt.
 	 */
 	void getCurrentCacheSize();
 
@@ -76,19 +113,76 @@ class FileStorageWatcherThread : public QObject
 	 * Ensures that the cache doesn't exceed limits.
 	 */
 	void ensureCacheSize();
+	
+	/**
+	 * Appends the changes since the last call to the index.
+	 */
+	void flushIndex();
     
     private:
 	Q_DISABLE_COPY( FileStorageWatcherThread )
 	
+	struct IndexEntry
+	{
+	    qint64 size;
+	    // last access in seconds since the epoch in the upper,
+	    // a serial number in the lower 32 bits
+	    quint64 key;
+	};
+	
+	struct IndexRecord
+	{
+	    // size of the file, or one of the special values
+	    // removedFile and accessedFile
+	    qint64 size;
+	    uint access;
+	};
+	
+	/**
+	 * Scans the data directory and writes a new index.
+	 */
+	void rebuildIndex();
+	
 	/**
-	 * Deletes files of a planet if needed
+	 * Reads all entries of the index, rebuilding it if it is corrupt.
 	 */
-	void ensureSizePerPlanet( const QString &planetDirectory, const QString &currentTheme = QString() );
+	void loadIndex();
 	
 	/**
-	 * Deletes files of a theme if needed
+	 * Replaces the index file by the entries in memory.
 	 */
-	void ensureSizePerTheme( const QString &themeDirectory );
+	bool writeIndex();
+	
+	/**
+	 * Writes the header of the index file, which has to be open.
+	 */
+	void writeIndexHeader( QIODevice *device, bool consistent ) const;
+	
+	/**
+	 * Updates the entry of @p path as described by @p record.
+	 */
+	void applyRecord( const QByteArray &path, const IndexRecord &record );
+	
+	/**
+	 * Adds @p record for @p path to the changes to be written to the index.
+	 */
+	void addRecord( const QByteArray &path, const IndexRecord &record );
+	
+	/**
+	 * Deletes the least recently used files as long as keepDeleting().
+	 */
+	void deleteLeastRecentlyUsed();
+	
+	/**
+	 * Returns the path of @p fileName relative to the data directory
+	 */
+	QByteArray relativePath( const QString &fileName ) const;
+	
+	/**
+	 * Returns true if the file at @p path relative to the data directory
+	 * is a tile image which may be deleted.
+	 */
+	static bool isDeletable( const QByteArray &path );
 	
 	/**
 	 * Returns true if it is necessary to delete files.
@@ -106,6 +200,17 @@ class FileStorageWatcherThread : public QObject
 	QMutex	m_limitMutex;
 	QMutex	m_themeMutex;
 	bool	m_willQuit;
+	
+	// Tiles which may be deleted, by path and in the order of their last access
+	QHash<QByteArray, IndexEntry> m_index;
+	QMap<quint64, QByteArray> m_accessOrder;
+	bool	m_indexLoaded;
+	// Whether the index file matches the data directory when closed properly
+	bool	m_indexValid;
+	quint32	m_serial;
+	// Changes not written to the index file yet
+	QHash<QByteArray, IndexRecord> m_pendingRecords;
+	int	m_indexRecords;
 };
 
 
@@ -144,10 +249,23 @@ class FileStorageWatcher : public QThread
 	void addToCurrentSize( qint64 bytes );
 	
 	/**
-	 * Setting current cache size to 0.
+	 * Rescans the data directory after files were removed
+	 * from the cache behind our back.
 	 */
 	void resetCurrentSize();
 	
+	/**
+	 * Records that @p fileName was written with @p size bytes.
+	 * If the thread is not running, the index is removed to have it
+	 * rebuilt on the next start.
+	 */
+	void updateFile( const QString &fileName, qint64 size );
+	
+	/**
+	 * Records that @p fileName was read.
+	 */
+	void accessFile( const QString &fileName );
+	
 	/**
 	 * Updates the name of the theme.
 	 * Important for deleting behavior.
@@ -159,6 +277,8 @@ class FileStorageWatcher : public QThread
     Q_SIGNALS:
 	void sizeChanged( qint64 bytes );
 	void cleared();
+	void fileUpdated( const QString &fileName, qint64 size );
+	void fileAccessed( const QString &fileName );
 	
     protected:
 	/**
@@ -177,6 +297,7 @@ class FileStorageWatcher : public QThread
 	quint64 m_limit;
 	bool m_started;
 	bool m_quitting;
+	bool m_indexRemoved;
 };
 
 }
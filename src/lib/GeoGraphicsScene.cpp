@@ -20,7 +20,11 @@
 #include "TileId.h"
 #include "TileCoordsPyramid.h"
 #include "MarbleDebug.h"
-#include <QMap>
+
+#include <QHash>
+#include <QVector>
+
+#include <algorithm>
 
 namespace Marble
 {
@@ -30,16 +34,48 @@ bool zValueLessThan( GeoGraphicsItem* i1, GeoGraphicsItem* i2 )
     return i1->zValue() < i2->zValue();
 }
 
+/**
+ * Items of one tile, sorted by their z value.
+ */
+typedef QVector<GeoGraphicsItem*> GeoGraphicsBucket;
+
 class GeoGraphicsScenePrivate
 {
 public:
+    /**
+     * Packs a tile into a single 64 bit key: the zoom level in the upper six
+     * bits, followed by the interleaved (Morton ordered) bits of x and y.
+     * Tiles which are close to each other on the same level share the
+     * upper bits of their keys.
+     */
+    static quint64 tileKey( int level, int x, int y );
+    static quint64 tileKey( const TileId &tileId );
+
+    void collectBuckets( const GeoDataLatLonBox &box, int maxZoomLevel, QVector<quint64> &keys ) const;
+
+    void insertItem( const TileId &tileId, GeoGraphicsItem *item );
 
-    void addItems(const TileId &tileId, QList<GeoGraphicsItem*> &result, int maxZoomLevel ) const;
+    static QList<GeoGraphicsItem*> mergeBuckets( QVector<GeoGraphicsBucket> &runs );
 
-    QMap<TileId, QList<GeoGraphicsItem*> > m_items;
-    QMultiHash<const GeoDataFeature*, TileId> m_features;
+    QHash<quint64, GeoGraphicsBucket> m_items;
+    QMultiHash<const GeoDataFeature*, quint64> m_features;
 };
 
+quint64 GeoGraphicsScenePrivate::tileKey( int level, int x, int y )
+{
+    quint64 interleaved = 0;
+    for ( int bit = 0; bit < 29; ++bit ) {
+        interleaved |= ( quint64( ( x >> bit ) & 1 ) << ( 2 * bit + 1 ) )
+                     | ( quint64( ( y >> bit ) & 1 ) << ( 2 * bit ) );
+    }
+    return ( quint64( level ) << 58 ) | interleaved;
+}
+
+quint64 GeoGraphicsScenePrivate::tileKey( const TileId &tileId )
+{
+    return tileKey( tileId.zoomLevel(), tileId.x(), tileId.y() );
+}
+
 GeoGraphicsScene::GeoGraphicsScene( QObject* parent ): QObject( parent ), d( new GeoGraphicsScenePrivate() )
 {
 
@@ -52,7 +88,7 @@ GeoGraphicsScene::~GeoGraphicsScene()
 
 void GeoGraphicsScene::eraseAll()
 {
-    for( QMap< TileId, QList< GeoGraphicsItem* > >::const_iterator i = d->m_items.constBegin();
+    for( QHash<quint64, GeoGraphicsBucket>::const_iterator i = d->m_items.constBegin();
          i != d->m_items.constEnd(); ++i )
     {
         qDeleteAll(*i);
@@ -63,6 +99,7 @@ void GeoGraphicsScene::eraseAll()
 
 QList< GeoGraphicsItem* > GeoGraphicsScene::items( const GeoDataLatLonBox &box, int zoomLevel ) const
 {
+    QVector<quint64> keys;
     if ( box.west() > box.east() ) {
         // Handle boxes crossing the IDL by splitting it into two separate boxes
         GeoDataLatLonBox left;
@@ -77,66 +114,77 @@ QList< GeoGraphicsItem* > GeoGraphicsScene::items( const GeoDataLatLonBox &box,
         right.setNorth( box.north() );
         right.setSouth( box.south() );
 
-        QList< GeoGraphicsItem* > allItems = items( left, zoomLevel );
-        foreach( GeoGraphicsItem* item, items( right, zoomLevel ) ) {
-            if ( !allItems.contains( item ) ) {
-                allItems << item;
-            }
-        }
-        return allItems;
-    }
-
-    QList< GeoGraphicsItem* > result;
-    QRect rect;
-    qreal north, south, east, west;
-    box.boundaries( north, south, east, west );
-    TileId key;
-
-    key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel );
-    rect.setLeft( key.x() );
-    rect.setTop( key.y() );
+        d->collectBuckets( left, zoomLevel, keys );
+        d->collectBuckets( right, zoomLevel, keys );
 
-    key = TileId::fromCoordinates( GeoDataCoordinates(east, south, 0), zoomLevel );
-    rect.setRight( key.x() );
-    rect.setBottom( key.y() );
-    
-    TileCoordsPyramid pyramid( 0, zoomLevel );
-    pyramid.setBottomLevelCoords( rect );
+        // Both halves share the tiles of the lower levels
+        qSort( keys );
+        keys.erase( std::unique( keys.begin(), keys.end() ), keys.end() );
+    } else {
+        d->collectBuckets( box, zoomLevel, keys );
+    }
 
-    for ( int level = pyramid.topLevel(); level <= pyramid.bottomLevel(); ++level ) {
-        QRect const coords = pyramid.coords( level );
-        int x1, y1, x2, y2;
-        coords.getCoords( &x1, &y1, &x2, &y2 );
-        for ( int x = x1; x <= x2; ++x ) {
-            for ( int y = y1; y <= y2; ++y ) {
-                d->addItems( TileId ( 0, level, x, y ), result, zoomLevel );
+    QVector<GeoGraphicsBucket> runs;
+    runs.reserve( keys.size() );
+    foreach( quint64 key, keys ) {
+        const GeoGraphicsBucket bucket = d->m_items.value( key );
+        GeoGraphicsBucket run;
+        run.reserve( bucket.size() );
+        foreach( GeoGraphicsItem *item, bucket ) {
+            if( item->minZoomLevel() <= zoomLevel && item->visible() ) {
+                run.append( item );
             }
         }
+        if ( !run.isEmpty() ) {
+            runs.append( run );
+        }
     }
-    return result;
+
+    return GeoGraphicsScenePrivate::mergeBuckets( runs );
 }
 
 void GeoGraphicsScene::removeItem( const GeoDataFeature* feature )
 {
-    QList<TileId> keys = d->m_features.values( feature );
-    foreach( TileId key, keys ) {
-        QList< GeoGraphicsItem* >& tileList = d->m_items[key];
-        foreach( GeoGraphicsItem* item, tileList ) {
-            if( item->feature() == feature ) {
-                d->m_features.remove( feature );
-                tileList.removeAll( item );
+    QList<quint64> keys = d->m_features.values( feature );
+    d->m_features.remove( feature );
+    foreach( quint64 key, keys ) {
+        QHash<quint64, GeoGraphicsBucket>::iterator tile = d->m_items.find( key );
+        if ( tile == d->m_items.end() ) {
+            continue;
+        }
+        GeoGraphicsBucket &bucket = tile.value();
+        for ( int i = 0; i < bucket.size(); ++i ) {
+            if( bucket.at( i )->feature() == feature ) {
+                bucket.remove( i );
                 break;
             }
         }
+        if ( bucket.isEmpty() ) {
+            d->m_items.erase( tile );
+        }
     }
 }
 
 void GeoGraphicsScene::clear()
 {
     d->m_items.clear();
+    d->m_features.clear();
 }
 
 void GeoGraphicsScene::addItem( GeoGraphicsItem* item )
+{
+    d->insertItem( itemTile( item ), item );
+}
+
+void GeoGraphicsScene::addItems( const QList< QPair<TileId, GeoGraphicsItem*> > &items )
+{
+    typedef QPair<TileId, GeoGraphicsItem*> TiledItem;
+    foreach( const TiledItem &tiledItem, items ) {
+        d->insertItem( tiledItem.first, tiledItem.second );
+    }
+}
+
+TileId GeoGraphicsScene::itemTile( const GeoGraphicsItem *item )
 {
     // Select zoom level so that the object fit in single tile
     int zoomLevel;
@@ -149,31 +197,83 @@ void GeoGraphicsScene::addItem( GeoGraphicsItem* item )
             break;
     }
 
-    const TileId key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel ); // same as GeoDataCoordinates(east, south, 0), see above
+    return TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel ); // same as GeoDataCoordinates(east, south, 0), see above
+}
 
-    QList< GeoGraphicsItem* >& tileList = d->m_items[key];
-    QList< GeoGraphicsItem* >::iterator position = qLowerBound( tileList.begin(), tileList.end(), item, zValueLessThan );
-    tileList.insert( position, item );
-    d->m_features.insert( item->feature(), key );
+void GeoGraphicsScenePrivate::insertItem( const TileId &tileId, GeoGraphicsItem *item )
+{
+    const quint64 key = tileKey( tileId );
+    GeoGraphicsBucket &bucket = m_items[key];
+    GeoGraphicsBucket::iterator position = qLowerBound( bucket.begin(), bucket.end(), item, zValueLessThan );
+    bucket.insert( position, item );
+    m_features.insert( item->feature(), key );
 }
 
-void GeoGraphicsScenePrivate::addItems( const TileId &tileId, QList<GeoGraphicsItem *> &result, int maxZoomLevel ) const
+void GeoGraphicsScenePrivate::collectBuckets( const GeoDataLatLonBox &box, int maxZoomLevel, QVector<quint64> &keys ) const
 {
-    const QList< GeoGraphicsItem* > &objects = m_items.value(tileId);
-    QList< GeoGraphicsItem* >::iterator before = result.begin();
-    QList< GeoGraphicsItem* >::const_iterator currentItem = objects.constBegin();
-    while( currentItem != objects.end() ) {
-        while( ( currentItem != objects.end() )
-          && ( ( before == result.end() ) || ( (*currentItem)->zValue() < (*before)->zValue() ) ) ) {
-            if( (*currentItem)->minZoomLevel() <= maxZoomLevel && (*currentItem)->visible() ) {
-                before = result.insert( before, *currentItem );
+    QRect rect;
+    qreal north, south, east, west;
+    box.boundaries( north, south, east, west );
+    TileId key;
+
+    key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), maxZoomLevel );
+    rect.setLeft( key.x() );
+    rect.setTop( key.y() );
+
+    key = TileId::fromCoordinates( GeoDataCoordinates(east, south, 0), maxZoomLevel );
+    rect.setRight( key.x() );
+    rect.setBottom( key.y() );
+
+    TileCoordsPyramid pyramid( 0, maxZoomLevel );
+    pyramid.setBottomLevelCoords( rect );
+
+    for ( int level = pyramid.topLevel(); level <= pyramid.bottomLevel(); ++level ) {
+        QRect const coords = pyramid.coords( level );
+        int x1, y1, x2, y2;
+        coords.getCoords( &x1, &y1, &x2, &y2 );
+        for ( int x = x1; x <= x2; ++x ) {
+            for ( int y = y1; y <= y2; ++y ) {
+                const quint64 key = tileKey( level, x, y );
+                if ( m_items.contains( key ) ) {
+                    keys.append( key );
+                }
             }
-            ++currentItem;
         }
-        if ( before != result.end() ) {
-            ++before;
+    }
+}
+
+QList<GeoGraphicsItem*> GeoGraphicsScenePrivate::mergeBuckets( QVector<GeoGraphicsBucket> &runs )
+{
+    // Each run is sorted by z value already. Merge neighboring runs pairwise
+    // until only one is left; std::merge is stable, so items of equal z value
+    // keep the order of their tiles (lower zoom levels first).
+    while ( runs.size() > 1 ) {
+        QVector<GeoGraphicsBucket> merged;
+        merged.reserve( ( runs.size() + 1 ) / 2 );
+        for ( int i = 0; i + 1 < runs.size(); i += 2 ) {
+            const GeoGraphicsBucket &first = runs.at( i );
+            const GeoGraphicsBucket &second = runs.at( i + 1 );
+            GeoGraphicsBucket run( first.size() + second.size() );
+            std::merge( first.constBegin(), first.constEnd(),
+                        second.constBegin(), second.constEnd(),
+                        run.begin(), zValueLessThan );
+            merged.append( run );
+        }
+        if ( runs.size() % 2 == 1 ) {
+            merged.append( runs.last() );
         }
+        runs = merged;
     }
+
+    QList<GeoGraphicsItem*> result;
+    if ( !runs.isEmpty() ) {
+        const GeoGraphicsBucket &run = runs.first();
+        result.reserve( run.size() );
+        foreach( GeoGraphicsItem *item, run ) {
+            result.append( item );
+        }
+    }
+    return result;
 }
 
 }
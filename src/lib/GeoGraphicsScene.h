@@ -17,6 +17,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QPair>
 
 namespace Marble
 {
@@ -25,6 +26,7 @@ class GeoGraphicsItem;
 class GeoDataFeature;
 class GeoDataLatLonBox;
 class GeoGraphicsScenePrivate;
+class TileId;
 
 /**
  * @short This is the home of all GeoGraphicsItems to be shown on the map.
@@ -47,6 +49,22 @@ public:
      */
     void addItem( GeoGraphicsItem *item );
 
+    /**
+     * @brief Add a batch of items to the GeoGraphicsScene
+     * Adds all items to the GeoGraphicsScene at once. Each item is paired with
+     * its tile as returned by itemTile(), which is usually determined in advance
+     * on a worker thread.
+     */
+    void addItems( const QList< QPair<TileId, GeoGraphicsItem*> > &items );
+
+    /**
+     * @brief Returns the tile the item @p item is stored in
+     * This is the tile of the highest zoom level (up to the minimum zoom level of
+     * the item) that covers the whole item. The function only reads the item and
+     * may be called from any thread.
+     */
+    static TileId itemTile( const GeoGraphicsItem *item );
+
     /**
      * @brief Remove all concerned items from the GeoGraphicsScene
      * Removes all items which are associated with @p object from the GeoGraphicsScene
@@ -73,7 +91,7 @@ public:
      *
      * @param box The box around the items.
      * @param maxZoomLevel The max zoom level of tiling
-     * @return The list of items in the specified box in no specific order.
+     * @return The list of items in the specified box, sorted by their z value.
      */
     QList<GeoGraphicsItem *> items( const GeoDataLatLonBox &box, int maxZoomLevel ) const;
 
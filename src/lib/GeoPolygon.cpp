@@ -12,20 +12,11 @@
 
 #include "GeoPolygon.h"
 
-#include <cstdlib>
-#include <fcntl.h>
 #include <cmath>
 using std::fabs;
 
-#include <QFile>
-#include <QDataStream> 
+#include <QThread>
 #include <QTime>
-#ifdef Q_OS_UNIX
-# include <unistd.h>
-# include <sys/types.h>
-# include <sys/stat.h>
-# include <sys/mman.h> /* mmap() is defined in this header */
-#endif
 
 #include "MarbleDebug.h"
 #include "Quaternion.h"
@@ -35,10 +26,40 @@ using namespace Marble;
 const qreal ARCMINUTE = 10800; // distance of 180deg in arcminutes
 const qreal INT2RAD = M_PI / 10800.0;
 
+// Each node of a PNT file is a record of three little endian shorts:
+// header, latitude and longitude. A header > 5 starts a new polygon,
+// otherwise it is the detail level of the node.
+const int PNT_RECORD_SIZE = 6;
+
+// States of GeoPolygon::m_decoded
+enum DecodeState {
+    Encoded = 0,
+    Decoded = 1,
+    Decoding = 2
+};
+
+static inline short pntRecordValue( const uchar *record, int field )
+{
+    return record[2 * field] | ( record[2 * field + 1] << 8 );
+}
+
 GeoPolygon::GeoPolygon()
     : m_dateLineCrossing( false ),
       m_closed( false ),
-      m_index( 0 )
+      m_index( 0 ),
+      m_encodedNodes( 0 ),
+      m_encodedNodeCount( 0 ),
+      m_decoded( Decoded )
+{
+}
+
+GeoPolygon::GeoPolygon( const uchar *encodedNodes )
+    : m_dateLineCrossing( false ),
+      m_closed( false ),
+      m_index( 0 ),
+      m_encodedNodes( encodedNodes ),
+      m_encodedNodeCount( 0 ),
+      m_decoded( Encoded )
 {
 }
 
@@ -94,6 +115,38 @@ void GeoPolygon::displayBoundary()
 //              << " dateline " << getDateLine() << " Index: " << getIndex();
 }
 
+void GeoPolygon::decode() const
+{
+    if ( m_decoded.fetchAndAddAcquire( 0 ) == Decoded ) {
+        return;
+    }
+
+    // Only the polygon is locked, so threads projecting different polygons decode them concurrently
+    if ( !m_decoded.testAndSetAcquire( Encoded, Decoding ) ) {
+        // another thread is decoding the polygon, which only takes a moment
+        while ( m_decoded.fetchAndAddAcquire( 0 ) != Decoded ) {
+            QThread::yieldCurrentThread();
+        }
+        return;
+    }
+
+    GeoPolygon *polygon = const_cast<GeoPolygon*>( this );
+    polygon->reserve( m_encodedNodeCount );
+
+    for ( int i = 0; i < m_encodedNodeCount; ++i ) {
+        const uchar *record = m_encodedNodes + i * PNT_RECORD_SIZE;
+        const short header = pntRecordValue( record, 0 );
+        const short iLat = pntRecordValue( record, 1 );
+        const short iLon = pntRecordValue( record, 2 );
+
+        // The first node carries the index of the polygon instead of a detail level
+        polygon->append( GeoDataCoordinates( (qreal)(iLon) * INT2RAD, (qreal)(iLat) * INT2RAD, 0.0,
+                                             GeoDataCoordinates::Radian, i == 0 ? 5 : (int)(header) ) );
+    }
+
+    m_decoded.fetchAndStoreRelease( Decoded );
+}
+
 // ================================================================
 //                               class PntMap
 
@@ -148,112 +201,34 @@ void PntMapLoader::run()
     QTime timer;
     timer.restart();
 
-#ifdef Q_OS_UNIX
-    // MMAP Start
-    int          fd;
-    unsigned char* src; 
-    struct stat  statbuf;
-
-    if ( (fd = open (m_filename.toLatin1(), O_RDONLY) ) < 0)  // krazy:exclude=syscalls
-        mDebug() << "cannot open" << m_filename << " for reading";
-
-    int filelength;
-    if ( fstat (fd,&statbuf) < 0 ) { // krazy:exclude=syscalls
-        filelength = 0;
-        mDebug() << "fstat error";
-    } else {
-        filelength = statbuf.st_size;
+    // The file stays mapped as long as the PntMap exists, the nodes
+    // of a polygon are only decoded once they are needed.
+    QFile &file = m_parent->m_file;
+    file.setFileName( m_filename );
+    const uchar *data = 0;
+    if ( file.open( QIODevice::ReadOnly ) ) {
+        data = file.map( 0, file.size() );
     }
-	
-    if ((src = (unsigned char*) mmap (0, filelength, PROT_READ, MAP_SHARED, fd, 0))
-        == (unsigned char*) (caddr_t) -1)
-        mDebug() << "mmap error for input";
-		
-    short  header;
-    short  iLat;
-    short  iLon;
-    int    count = 0;
-
-    //const int halfFileLength = filelength / 2;
-
-    for (int i=0; i < filelength; i+=6){
-        header = src[i] | (src[i+1] << 8);
-        iLat = src[i+2] | (src[i+3] << 8);
-        iLon = src[i+4] | (src[i+5] << 8);   
-
-        // Transforming Range of Coordinates to iLat [0,ARCMINUTE] ,
-        // iLon [0,2 * ARCMINUTE]
-						
-        //
-        // 90 00N =   -ARCMINUTE / 2
-        // 90 00S =   ARCMINUTE / 2
-        // 180 00W =  -ARCMINUTE
-        // 180 00E =   ARCMINUTE
-        //
-        if ( header > 5 ) {
-			
-            // qDebug(QString("header: %1 iLat: %2 iLon: %3").arg(header).arg(iLat).arg(iLon).toLatin1());
 
-            GeoPolygon  *polyline = new GeoPolygon();
-            m_parent->append( polyline );
+    if ( !data ) {
+        mDebug() << "cannot map" << m_filename << "for reading";
+        emit pntMapLoaded( false );
+        return;
+    }
 
-//            polyline->m_sourceFileName=filename;
-            polyline->setIndex( header );
+    const int recordCount = file.size() / PNT_RECORD_SIZE;
 
-            // Find out whether the Polyline is a river or a closed polygon
-            if ( ( header >= 7000 && header < 8000 )
-                 || ( header >= 9000 && header < 20000 ) )
-                polyline->setClosed( false );
-            else 
-                polyline->setClosed( true );
+    // Build the index of the polygons
+    GeoPolygon *polyline = 0;
+    for ( int i = 0; i < recordCount; ++i ) {
+        const uchar *record = data + i * PNT_RECORD_SIZE;
+        const short header = pntRecordValue( record, 0 );
 
-            polyline->append( GeoDataCoordinates( (qreal)(iLon) * INT2RAD, (qreal)(iLat) * INT2RAD,
-                                                  0.0, GeoDataCoordinates::Radian, 5 ) );
-        }
-        else {
-            // qDebug(QString("header: %1 iLat: %2 iLon: %3").arg(header).arg(iLat).arg(iLon).toLatin1());
-            m_parent->last()->append( GeoDataCoordinates( (qreal)(iLon) * INT2RAD,
-                                                          (qreal)(iLat) * INT2RAD, 0.0,
-                                                          GeoDataCoordinates::Radian,
-                                                          (int)(header) ) ); 
-        }
-        ++count;
-    }
-    munmap(src,filelength);
-    close(fd);
-
-    // qDebug(QString("Opened %1 with %2 Polylines and %3 Points").arg(filename).arg(this->count()).arg(count).toLatin1());
-    // MMAP End
-#else
-#  ifdef Q_OS_WIN
-
-    // qDebug("Loading PntMap ...");
-    int    count = 0;
-    QFile  file( m_filename );
-
-    file.open( QIODevice::ReadOnly );
-    QDataStream stream( &file );  // read the data serialized from the file
-    stream.setByteOrder( QDataStream::LittleEndian );
-
-    short  header;
-    short  iLat;
-    short  iLon;
-
-    // Iterator that points to current PolyLine in PntMap
-    //	QList<GeoPolygon*>::iterator it = begin();
-    //	int count = 0;
-
-    while( !stream.atEnd() ){	
-        stream >> header >> iLat >> iLon;		
-        // Transforming Range of Coordinates to iLat [0,ARCMINUTE] , iLon [0,2 * ARCMINUTE] 
-						
         if ( header > 5 ) {
-			
-            // qDebug(QString("header: %1 iLat: %2 iLon: %3").arg(header).arg(iLat).arg(iLon).toLatin1());
-            GeoPolygon  *polyline = new GeoPolygon();
+            polyline = new GeoPolygon( record );
             m_parent->append( polyline );
 
-            polyline->setIndex(header);
+            polyline->setIndex( header );
 
             // Find out whether the Polyline is a river or a closed polygon
             if ( ( header >= 7000 && header < 8000 )
@@ -261,28 +236,12 @@ void PntMapLoader::run()
                 polyline->setClosed( false );
             else 
                 polyline->setClosed( true );
-
-            polyline->append( GeoDataCoordinates( (qreal)(iLon) * INT2RAD, (qreal)(iLat) * INT2RAD,
-                                                  0.0, GeoDataCoordinates::Radian, 5 ) );
         }
-        else {
-            // qDebug(QString("header: %1 iLat: %2 iLon: %3").arg(header).arg(iLat).arg(iLon).toLatin1());
-            m_parent->last()->append( GeoDataCoordinates( (qreal)(iLon) * INT2RAD,
-                                                          (qreal)(iLat) * INT2RAD, 0.0,
-                                                          GeoDataCoordinates::Radian,
-                                                          (int)(header) ) );
+
+        if ( polyline ) {
+            ++polyline->m_encodedNodeCount;
         }
-        ++count;
     }
-	
-    file.close();
-    // qDebug(QString("Opened %1 with %2 Polylines and %3 Points").arg(filename).arg(this->count()).arg(count).toLatin1());
-
-#  else
-#  warning Your OS is not supported!
-#  endif
-#endif
-
 
     // To optimize performance we compute the boundaries of the
     // polygons.  To detect inside/outside we need to detect the
@@ -297,7 +256,6 @@ void PntMapLoader::run()
 
     GeoPolygon::PtrVector::ConstIterator       itPolyLine;
     GeoPolygon::PtrVector::ConstIterator  itEndPolyLine = m_parent->constEnd();
-    GeoDataCoordinates::Vector::ConstIterator   itPoint;
 
     // Now we calculate the boundaries
 	
@@ -314,17 +272,17 @@ void PntMapLoader::run()
         bool isOriginalSide = true;
         int  lastSign     = 0;
 
-        GeoDataCoordinates::Vector::ConstIterator  itEndPoint = (*itPolyLine)->constEnd();
-					
-        for ( itPoint = (*itPolyLine)->constBegin();
-                itPoint != itEndPoint;
-                ++itPoint )
-        {
-            itPoint->geoCoordinates( lon, lat );
+        const uchar *encodedNodes = (*itPolyLine)->m_encodedNodes;
+        const int encodedNodeCount = (*itPolyLine)->m_encodedNodeCount;
+
+        for ( int i = 0; i < encodedNodeCount; ++i ) {
+            const uchar *record = encodedNodes + i * PNT_RECORD_SIZE;
+            lat = (qreal)( pntRecordValue( record, 1 ) ) * INT2RAD;
+            lon = (qreal)( pntRecordValue( record, 2 ) ) * INT2RAD;
 
             int currentSign = ( lon > 0.0 ) ? 1 : -1 ;
 
-            if( itPoint == (*itPolyLine)->constBegin() ) {
+            if( i == 0 ) {
                 lastSign = currentSign;
                 lastLon  = lon;
             }
@@ -384,7 +342,7 @@ void PntMapLoader::run()
         }
     }
 
-    mDebug() << Q_FUNC_INFO << "Loaded" << m_filename << "in" << timer.elapsed() << "ms";
+    mDebug() << Q_FUNC_INFO << "Indexed" << m_parent->size() << "polygons of" << m_filename << "in" << timer.elapsed() << "ms";
 
     emit pntMapLoaded( true );
 }
@@ -12,6 +12,8 @@
 #ifndef MARBLE_GEOPOLYGON_H
 #define MARBLE_GEOPOLYGON_H
 
+#include <QAtomicInt>
+#include <QFile>
 #include <QObject>
 #include <QString>
 #include <QThread>
@@ -69,23 +71,47 @@ class MARBLE_EXPORT GeoPolygon : public GeoDataCoordinates::Vector
 
     void displayBoundary();
 
+    /**
+     * @brief Decodes the nodes of the polygon, unless done before
+     *
+     * PntMap only indexes the polygons of a file when loading it. The nodes
+     * of a polygon are decoded from the memory mapped file when they are
+     * needed for the first time and kept afterwards. Call this method before
+     * accessing the nodes. It may be called from several threads at once.
+     */
+    void decode() const;
+
     // Type definitions
     typedef QVector<GeoPolygon *> PtrVector;
 
 //    QString m_sourceFileName;
 
  private:
+    friend class PntMapLoader;
+
+    /**
+     * Creates a polygon whose nodes are decoded from @p encodedNodes later on
+     */
+    explicit GeoPolygon( const uchar *encodedNodes );
+
     int   m_dateLineCrossing;
     bool  m_closed;
 
     GeoDataCoordinates::PtrVector  m_boundary;
 
     int     m_index;
+
+    const uchar       *m_encodedNodes;
+    int                m_encodedNodeCount;
+    // Whether the nodes are encoded, decoded or being decoded by a thread right now
+    mutable QAtomicInt m_decoded;
 };
 
 
 /*
  * A PntMap is a collection of GeoPolygons, i.e. a complete map of vectors.
+ * The file is mapped into memory for the lifetime of the PntMap, see
+ * GeoPolygon::decode().
  *
  * FIXME: Rename it (into GeoPolygonMap?)
  */
@@ -111,8 +137,11 @@ class MARBLE_EXPORT PntMap : public QObject,
     void setInitialized( bool );
 
  private:
+    friend class PntMapLoader;
+
     bool m_isInitialized;
     PntMapLoader* m_loader;
+    QFile m_file;
 
     Q_DISABLE_COPY( PntMap )
 };
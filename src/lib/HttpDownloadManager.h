@@ -101,6 +101,12 @@ class MARBLE_EXPORT HttpDownloadManager : public QObject
       */
     void progressChanged( int active, int queued );
 
+    /**
+     * This signal is emitted when a previously downloaded file is read,
+     * which keeps it from being removed from the cache.
+     */
+    void fileAccessed( const QString &fileName );
+
  private Q_SLOTS:
     void finishJob( const QByteArray& data, const QString& destinationFileName,
 		    const QString& id );
@@ -15,6 +15,7 @@
 
 #include "MarbleDebug.h"
 #include "TinyWebBrowser.h"
+#include "TraceRecorder.h"
 
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
@@ -35,6 +36,8 @@ class Marble::HttpJobPrivate
     QString m_pluginId;
     QNetworkAccessManager *const m_networkAccessManager;
     QNetworkReply *m_networkReply;
+    // trace time of the request, -1 if tracing was disabled
+    qint64 m_start;
 };
 
 HttpJobPrivate::HttpJobPrivate( const QUrl & sourceUrl, const QString & destFileName,
@@ -48,7 +51,8 @@ HttpJobPrivate::HttpJobPrivate( const QUrl & sourceUrl, const QString & destFile
       // results in valid user agent string
       m_pluginId( "unknown" ),
       m_networkAccessManager( networkAccessManager ),
-      m_networkReply( 0 )
+      m_networkReply( 0 ),
+      m_start( -1 )
 {
 }
 
@@ -139,6 +143,7 @@ void HttpJob::execute()
     QNetworkRequest request( d->m_sourceUrl );
     request.setAttribute( QNetworkRequest::HttpPipeliningAllowedAttribute, true );
     request.setRawHeader( "User-Agent", userAgent() );
+    d->m_start = TraceRecorder::isEnabled() ? TraceRecorder::now() : -1;
     d->m_networkReply = d->m_networkAccessManager->get( request );
 
     connect( d->m_networkReply, SIGNAL(downloadProgress(qint64,qint64)),
@@ -167,6 +172,12 @@ void HttpJob::finished()
 //     mDebug() << "finished" << destinationFileName()
 //              << "error" << error;
 
+    if ( d->m_start >= 0 ) {
+        // concurrent downloads overlap, so they do not nest into the main thread zones
+        TraceRecorder::addEvent( "HttpJob::download", d->m_start, TraceRecorder::now(), "Downloads" );
+        d->m_start = -1;
+    }
+
     const QVariant httpPipeliningWasUsed =
         d->m_networkReply->attribute( QNetworkRequest::HttpPipeliningWasUsedAttribute );
     if ( !httpPipeliningWasUsed.isNull() )
@@ -0,0 +1,588 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "JsonStreamReader.h"
+
+#include <QObject>
+#include <QVarLengthArray>
+
+#include <cstring>
+
+namespace Marble
+{
+
+// Documents nested deeper than this are rejected instead of exhausting the stack in readValue()
+static const int maximumDepth = 512;
+
+class JsonStreamReaderPrivate
+{
+ public:
+    JsonStreamReaderPrivate();
+
+    void reset( const QByteArray &data );
+
+    JsonStreamReader::TokenType readNext();
+
+    JsonStreamReader::TokenType readValue();
+    JsonStreamReader::TokenType readString( const char **begin, int *length, bool *escaped );
+    JsonStreamReader::TokenType readNumber();
+    JsonStreamReader::TokenType readLiteral( const char *literal, JsonStreamReader::TokenType type );
+    JsonStreamReader::TokenType setError( const QString &error );
+
+    void skipWhitespace();
+
+    static QString decode( const char *begin, int length, bool escaped );
+    static int hexValue( char c );
+
+    QByteArray m_data;
+    const char *m_begin;
+    const char *m_position;
+    const char *m_end;
+
+    JsonStreamReader::TokenType m_tokenType;
+    QString m_errorString;
+
+    // '{' or '[' for each enclosing object or array
+    QVarLengthArray<char, 32> m_stack;
+    // true if a value has been read in the innermost object or array
+    bool m_hasValue;
+
+    const char *m_name;
+    int m_nameLength;
+    bool m_nameEscaped;
+
+    const char *m_value;
+    int m_valueLength;
+    bool m_valueEscaped;
+    qreal m_number;
+};
+
+JsonStreamReaderPrivate::JsonStreamReaderPrivate()
+{
+    reset( QByteArray() );
+}
+
+void JsonStreamReaderPrivate::reset( const QByteArray &data )
+{
+    m_data = data;
+    m_begin = m_data.constData();
+    m_position = m_begin;
+    m_end = m_begin + m_data.size();
+    m_tokenType = JsonStreamReader::NoToken;
+    m_errorString.clear();
+    m_stack.clear();
+    m_hasValue = false;
+    m_name = 0;
+    m_nameLength = 0;
+    m_nameEscaped = false;
+    m_value = 0;
+    m_valueLength = 0;
+    m_valueEscaped = false;
+    m_number = 0.0;
+}
+
+void JsonStreamReaderPrivate::skipWhitespace()
+{
+    while ( m_position < m_end &&
+            ( *m_position == ' ' || *m_position == '\n' || *m_position == '\r' || *m_position == '\t' ) ) {
+        ++m_position;
+    }
+}
+
+JsonStreamReader::TokenType JsonStreamReaderPrivate::setError( const QString &error )
+{
+    m_errorString = QObject::tr( "%1 at offset %2" ).arg( error ).arg( m_position - m_begin );
+    m_tokenType = JsonStreamReader::Invalid;
+    return m_tokenType;
+}
+
+JsonStreamReader::TokenType JsonStreamReaderPrivate::readNext()
+{
+    if ( m_tokenType == JsonStreamReader::Invalid || m_tokenType == JsonStreamReader::EndDocument ) {
+        return m_tokenType;
+    }
+
+    m_nameLength = 0;
+    m_nameEscaped = false;
+    skipWhitespace();
+
+    if ( m_stack.isEmpty() ) {
+        if ( m_tokenType != JsonStreamReader::NoToken ) {
+            if ( m_position != m_end ) {
+                return setError( QObject::tr( "Unexpected data after the document" ) );
+            }
+            m_tokenType = JsonStreamReader::EndDocument;
+            return m_tokenType;
+        }
+        if ( m_position == m_end ) {
+            return setError( QObject::tr( "The document is empty" ) );
+        }
+        return readValue();
+    }
+
+    if ( m_position == m_end ) {
+        return setError( QObject::tr( "Unexpected end of the document" ) );
+    }
+
+    const char container = m_stack[m_stack.size() - 1];
+    const char close = container == '{' ? '}' : ']';
+    if ( *m_position == close ) {
+        ++m_position;
+        m_stack.resize( m_stack.size() - 1 );
+        m_hasValue = true;
+        m_tokenType = container == '{' ? JsonStreamReader::EndObject : JsonStreamReader::EndArray;
+        return m_tokenType;
+    }
+
+    if ( m_hasValue ) {
+        if ( *m_position != ',' ) {
+            return setError( QObject::tr( "Expected ',' or '%1'" ).arg( close ) );
+        }
+        ++m_position;
+        skipWhitespace();
+        // "[1,]" is not allowed
+        if ( m_position < m_end && *m_position == close ) {
+            return setError( QObject::tr( "Expected a value" ) );
+        }
+    }
+
+    if ( container == '{' ) {
+        if ( m_position == m_end || *m_position != '"' ) {
+            return setError( QObject::tr( "Expected a member name" ) );
+        }
+        if ( readString( &m_name, &m_nameLength, &m_nameEscaped ) == JsonStreamReader::Invalid ) {
+            return m_tokenType;
+        }
+        skipWhitespace();
+        if ( m_position == m_end || *m_position != ':' ) {
+            return setError( QObject::tr( "Expected ':'" ) );
+        }
+        ++m_position;
+        skipWhitespace();
+    }
+
+    return readValue();
+}
+
+JsonStreamReader::TokenType JsonStreamReaderPrivate::readValue()
+{
+    if ( m_position == m_end ) {
+        return setError( QObject::tr( "Unexpected end of the document" ) );
+    }
+
+    m_hasValue = true;
+    switch ( *m_position ) {
+    case '{':
+    case '[':
+        if ( m_stack.size() >= maximumDepth ) {
+            return setError( QObject::tr( "Objects and arrays are nested too deeply" ) );
+        }
+        m_stack.append( *m_position );
+        m_hasValue = false;
+        m_tokenType = *m_position == '{' ? JsonStreamReader::StartObject : JsonStreamReader::StartArray;
+        ++m_position;
+        return m_tokenType;
+    case '"':
+        m_tokenType = readString( &m_value, &m_valueLength, &m_valueEscaped );
+        return m_tokenType;
+    case 't':
+        m_number = 1.0;
+        return readLiteral( "true", JsonStreamReader::Bool );
+    case 'f':
+        m_number = 0.0;
+        return readLiteral( "false", JsonStreamReader::Bool );
+    case 'n':
+        m_number = 0.0;
+        return readLiteral( "null", JsonStreamReader::Null );
+    default:
+        return readNumber();
+    }
+}
+
+JsonStreamReader::TokenType JsonStreamReaderPrivate::readString( const char **begin, int *length, bool *escaped )
+{
+    Q_ASSERT( *m_position == '"' );
+    const char *start = ++m_position;
+    bool hasEscapes = false;
+
+    while ( m_position < m_end ) {
+        const uchar c = *m_position;
+        if ( c == '"' ) {
+            *begin = start;
+            *length = m_position - start;
+            *escaped = hasEscapes;
+            ++m_position;
+            return JsonStreamReader::String;
+        } else if ( c == '\\' ) {
+            hasEscapes = true;
+            ++m_position;
+            if ( m_position < m_end && *m_position == 'u' ) {
+                for ( int i = 1; i <= 4; ++i ) {
+                    if ( m_position + i >= m_end || hexValue( m_position[i] ) < 0 ) {
+                        return setError( QObject::tr( "Invalid escape sequence in string" ) );
+                    }
+                }
+                m_position += 5;
+            } else if ( m_position < m_end && *m_position != '\0' && strchr( "\"\\/bfnrt", *m_position ) ) {
+                ++m_position;
+            } else {
+                return setError( QObject::tr( "Invalid escape sequence in string" ) );
+            }
+        } else if ( c < 0x20 ) {
+            return setError( QObject::tr( "Control character in string" ) );
+        } else {
+            ++m_position;
+        }
+    }
+
+    m_position = m_end;
+    return setError( QObject::tr( "Unterminated string" ) );
+}
+
+JsonStreamReader::TokenType JsonStreamReaderPrivate::readNumber()
+{
+    static const qreal powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    const char *start = m_position;
+    const char *p = m_position;
+    const bool negative = *p == '-';
+    if ( negative ) {
+        ++p;
+    }
+
+    // Collect up to 19 significant digits as an integer and count the decimal exponent
+    quint64 mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    if ( p < m_end && *p == '0' ) {
+        ++p;
+    } else if ( p < m_end && *p >= '1' && *p <= '9' ) {
+        for ( ; p < m_end && *p >= '0' && *p <= '9'; ++p ) {
+            if ( digits < 19 ) {
+                mantissa = 10 * mantissa + ( *p - '0' );
+                ++digits;
+            } else {
+                ++exponent;
+            }
+        }
+    } else {
+        return setError( QObject::tr( "Unexpected character '%1'" ).arg( QChar::fromLatin1( *m_position ) ) );
+    }
+
+    if ( p < m_end && *p == '.' ) {
+        ++p;
+        if ( p == m_end || *p < '0' || *p > '9' ) {
+            m_position = p;
+            return setError( QObject::tr( "Expected a digit" ) );
+        }
+        for ( ; p < m_end && *p >= '0' && *p <= '9'; ++p ) {
+            if ( digits < 19 ) {
+                if ( mantissa != 0 || *p != '0' ) {
+                    ++digits;
+                }
+                mantissa = 10 * mantissa + ( *p - '0' );
+                --exponent;
+            }
+        }
+    }
+
+    if ( p < m_end && ( *p == 'e' || *p == 'E' ) ) {
+        ++p;
+        bool negativeExponent = false;
+        if ( p < m_end && ( *p == '+' || *p == '-' ) ) {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+        if ( p == m_end || *p < '0' || *p > '9' ) {
+            m_position = p;
+            return setError( QObject::tr( "Expected a digit" ) );
+        }
+        int value = 0;
+        for ( ; p < m_end && *p >= '0' && *p <= '9'; ++p ) {
+            if ( value < 100000 ) {
+                value = 10 * value + ( *p - '0' );
+            }
+        }
+        exponent += negativeExponent ? -value : value;
+    }
+
+    m_value = start;
+    m_valueLength = p - start;
+    m_valueEscaped = false;
+    m_position = p;
+
+    // Exact as long as both the mantissa and the power of ten are exactly representable
+    if ( mantissa < ( Q_UINT64_C( 1 ) << 53 ) && exponent >= -22 && exponent <= 22 ) {
+        const qreal value = exponent < 0 ? qreal( mantissa ) / powersOfTen[-exponent]
+                                         : qreal( mantissa ) * powersOfTen[exponent];
+        m_number = negative ? -value : value;
+    } else {
+        m_number = QByteArray( start, m_valueLength ).toDouble();
+    }
+
+    m_tokenType = JsonStreamReader::Number;
+    return m_tokenType;
+}
+
+JsonStreamReader::TokenType JsonStreamReaderPrivate::readLiteral( const char *literal, JsonStreamReader::TokenType type )
+{
+    const int length = strlen( literal );
+    if ( m_end - m_position < length || strncmp( m_position, literal, length ) != 0 ) {
+        return setError( QObject::tr( "Unexpected character '%1'" ).arg( QChar::fromLatin1( *m_position ) ) );
+    }
+
+    m_value = m_position;
+    m_valueLength = length;
+    m_valueEscaped = false;
+    m_position += length;
+    m_tokenType = type;
+    return m_tokenType;
+}
+
+int JsonStreamReaderPrivate::hexValue( char c )
+{
+    if ( c >= '0' && c <= '9' ) {
+        return c - '0';
+    } else if ( c >= 'a' && c <= 'f' ) {
+        return c - 'a' + 10;
+    } else if ( c >= 'A' && c <= 'F' ) {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+QString JsonStreamReaderPrivate::decode( const char *begin, int length, bool escaped )
+{
+    if ( !escaped ) {
+        return QString::fromUtf8( begin, length );
+    }
+
+    QString result;
+    result.reserve( length );
+    const char *end = begin + length;
+    const char *run = begin;
+    for ( const char *p = begin; p < end; ) {
+        if ( *p != '\\' ) {
+            ++p;
+            continue;
+        }
+
+        result += QString::fromUtf8( run, p - run );
+        const char escape = p + 1 < end ? p[1] : '\\';
+        p += 2;
+        switch ( escape ) {
+        case 'b': result += QChar( '\b' ); break;
+        case 'f': result += QChar( '\f' ); break;
+        case 'n': result += QChar( '\n' ); break;
+        case 'r': result += QChar( '\r' ); break;
+        case 't': result += QChar( '\t' ); break;
+        case 'u': {
+            // Surrogate pairs are encoded as two escapes and end up as two QChars
+            ushort unicode = 0;
+            int i = 0;
+            for ( ; i < 4 && p < end && hexValue( *p ) >= 0; ++i, ++p ) {
+                unicode = ( unicode << 4 ) | hexValue( *p );
+            }
+            result += i == 4 ? QChar( unicode ) : QChar( QChar::ReplacementCharacter );
+            break;
+        }
+        default:
+            // \" \\ and \/
+            result += QChar::fromLatin1( escape );
+            break;
+        }
+        run = p;
+    }
+    result += QString::fromUtf8( run, end - run );
+
+    return result;
+}
+
+JsonStreamReader::JsonStreamReader() :
+    d( new JsonStreamReaderPrivate )
+{
+}
+
+JsonStreamReader::JsonStreamReader( const QByteArray &data ) :
+    d( new JsonStreamReaderPrivate )
+{
+    d->reset( data );
+}
+
+JsonStreamReader::~JsonStreamReader()
+{
+    delete d;
+}
+
+void JsonStreamReader::setData( const QByteArray &data )
+{
+    d->reset( data );
+}
+
+JsonStreamReader::TokenType JsonStreamReader::readNext()
+{
+    return d->readNext();
+}
+
+bool JsonStreamReader::readNextChild()
+{
+    switch ( d->readNext() ) {
+    case EndObject:
+    case EndArray:
+    case EndDocument:
+    case Invalid:
+        return false;
+    default:
+        return true;
+    }
+}
+
+void JsonStreamReader::skipValue()
+{
+    if ( d->m_tokenType != StartObject && d->m_tokenType != StartArray ) {
+        return;
+    }
+
+    const int depth = d->m_stack.size();
+    while ( d->m_stack.size() >= depth ) {
+        if ( d->readNext() == Invalid ) {
+            return;
+        }
+    }
+}
+
+QVariant JsonStreamReader::readValue()
+{
+    switch ( d->m_tokenType ) {
+    case StartObject: {
+        QVariantMap map;
+        while ( readNextChild() ) {
+            const QString key = name();
+            map.insert( key, readValue() );
+        }
+        return map;
+    }
+    case StartArray: {
+        QVariantList list;
+        while ( readNextChild() ) {
+            list << readValue();
+        }
+        return list;
+    }
+    case String:
+        return stringValue();
+    case Number:
+        return d->m_number;
+    case Bool:
+        return boolValue();
+    default:
+        return QVariant();
+    }
+}
+
+JsonStreamReader::TokenType JsonStreamReader::tokenType() const
+{
+    return d->m_tokenType;
+}
+
+bool JsonStreamReader::atEnd() const
+{
+    return d->m_tokenType == EndDocument || d->m_tokenType == Invalid;
+}
+
+bool JsonStreamReader::hasError() const
+{
+    return d->m_tokenType == Invalid;
+}
+
+QString JsonStreamReader::errorString() const
+{
+    return d->m_errorString;
+}
+
+int JsonStreamReader::offset() const
+{
+    return d->m_position - d->m_begin;
+}
+
+int JsonStreamReader::depth() const
+{
+    switch ( d->m_tokenType ) {
+    case StartObject:
+    case StartArray:
+        return d->m_stack.size() - 1;
+    default:
+        return d->m_stack.size();
+    }
+}
+
+QString JsonStreamReader::name() const
+{
+    return JsonStreamReaderPrivate::decode( d->m_name, d->m_nameLength, d->m_nameEscaped );
+}
+
+bool JsonStreamReader::isName( const char *name ) const
+{
+    if ( d->m_nameEscaped ) {
+        return this->name() == QString::fromUtf8( name );
+    }
+
+    return d->m_nameLength == int( strlen( name ) ) && strncmp( d->m_name, name, d->m_nameLength ) == 0;
+}
+
+QString JsonStreamReader::stringValue() const
+{
+    switch ( d->m_tokenType ) {
+    case String:
+    case Number:
+    case Bool:
+        return JsonStreamReaderPrivate::decode( d->m_value, d->m_valueLength, d->m_valueEscaped );
+    default:
+        return QString();
+    }
+}
+
+qreal JsonStreamReader::numberValue() const
+{
+    switch ( d->m_tokenType ) {
+    case Number:
+    case Bool:
+        return d->m_number;
+    case String:
+        return stringValue().toDouble();
+    default:
+        return 0.0;
+    }
+}
+
+bool JsonStreamReader::boolValue() const
+{
+    return ( d->m_tokenType == Bool || d->m_tokenType == Number ) && d->m_number != 0.0;
+}
+
+QVariant JsonStreamReader::parse( const QByteArray &data, QString *errorString )
+{
+    JsonStreamReader reader( data );
+    reader.readNext();
+    QVariant result = reader.readValue();
+    reader.readNext();
+
+    if ( reader.hasError() ) {
+        if ( errorString ) {
+            *errorString = reader.errorString();
+        }
+        return QVariant();
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,176 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef MARBLE_JSONSTREAMREADER_H
+#define MARBLE_JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+class JsonStreamReaderPrivate;
+
+/**
+ * @brief A fast pull parser for JSON documents
+ *
+ * The reader walks through UTF-8 encoded JSON data token by token, similar to
+ * QXmlStreamReader. Strings and member names are only decoded on request and
+ * numbers are converted without temporary strings, so that large documents
+ * like GeoJSON files can be processed without building a tree of values first.
+ * Unlike evaluating the data as script code, nothing in the input is executed.
+ *
+ * A typical loop over the members of an object looks like this:
+ * @code
+ * JsonStreamReader reader( data );
+ * if ( reader.readNext() == JsonStreamReader::StartObject ) {
+ *     while ( reader.readNextChild() ) {
+ *         if ( reader.isName( "name" ) ) {
+ *             name = reader.stringValue();
+ *         } else {
+ *             reader.skipValue();
+ *         }
+ *     }
+ * }
+ * @endcode
+ *
+ * For small documents, parse() returns the whole document as a QVariant.
+ */
+class MARBLE_EXPORT JsonStreamReader
+{
+ public:
+    enum TokenType {
+        NoToken,
+        Invalid,
+        StartObject,
+        EndObject,
+        StartArray,
+        EndArray,
+        String,
+        Number,
+        Bool,
+        Null,
+        EndDocument
+    };
+
+    JsonStreamReader();
+
+    /**
+     * @brief Creates a reader for the UTF-8 encoded JSON document @p data
+     * The data is shared, not copied. It may also be created by QByteArray::fromRawData,
+     * e.g. for a memory mapped file, as long as it stays valid while reading.
+     */
+    explicit JsonStreamReader( const QByteArray &data );
+
+    ~JsonStreamReader();
+
+    /**
+     * @brief Restarts reading with the document @p data
+     */
+    void setData( const QByteArray &data );
+
+    /**
+     * @brief Reads the next token and returns its type
+     * Once the end of the document or an error is reached, the token type
+     * does not change anymore.
+     */
+    TokenType readNext();
+
+    /**
+     * @brief Reads the next member of the current object or the next element of the current array
+     *
+     * Returns false if the end of the object or array, the end of the document
+     * or an error is reached instead. Nested objects and arrays must be read
+     * completely or skipped with skipValue() before calling this again.
+     */
+    bool readNextChild();
+
+    /**
+     * @brief Skips the current value including all nested values, if any
+     * After this the current token is the last one of the value.
+     */
+    void skipValue();
+
+    /**
+     * @brief Reads the current value including all nested values into a QVariant
+     *
+     * Objects become a QVariantMap, arrays a QVariantList, strings a QString, numbers
+     * a double and booleans a bool. Null results in an invalid QVariant. After this
+     * the current token is the last one of the value.
+     */
+    QVariant readValue();
+
+    TokenType tokenType() const;
+
+    bool atEnd() const;
+
+    bool hasError() const;
+
+    /**
+     * @brief Returns a description of the first error including its position
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Returns the number of bytes read so far
+     */
+    int offset() const;
+
+    /**
+     * @brief Returns the number of objects and arrays enclosing the current token
+     */
+    int depth() const;
+
+    /**
+     * @brief Returns the name of the current object member, or an empty string in arrays
+     */
+    QString name() const;
+
+    /**
+     * @brief Returns true if the current member name is @p name
+     * Compares the raw data for names without escape sequences, which
+     * does not need to decode the name.
+     */
+    bool isName( const char *name ) const;
+
+    /**
+     * @brief Returns the value of the current String token
+     * For Number and Bool tokens the value is converted to a string.
+     */
+    QString stringValue() const;
+
+    /**
+     * @brief Returns the value of the current Number token
+     * For String tokens containing a number the converted value is returned, 0 otherwise.
+     */
+    qreal numberValue() const;
+
+    bool boolValue() const;
+
+    /**
+     * @brief Convenience function to parse the complete document @p data
+     * Returns an invalid QVariant if @p data is not valid JSON. The reason is
+     * stored in @p errorString if given.
+     */
+    static QVariant parse( const QByteArray &data, QString *errorString = 0 );
+
+ private:
+    Q_DISABLE_COPY( JsonStreamReader )
+
+    JsonStreamReaderPrivate * const d;
+};
+
+}
+
+#endif
@@ -24,6 +24,16 @@ qreal LayerInterface::zValue() const
     return 0.0;
 }
 
+bool LayerInterface::isThreadSafe() const
+{
+    return false;
+}
+
+qint64 LayerInterface::renderRevision() const
+{
+    return -1;
+}
+
 QString LayerInterface::runtimeTrace() const
 {
     return QString();
@@ -67,6 +67,22 @@ public:
       */
     virtual qreal zValue() const;
 
+    /**
+      * @brief Returns whether render() may be called from a worker thread (default: false).
+      * When parallel layer rendering is enabled in the LayerManager, thread-safe layers are
+      * rendered concurrently into an offscreen surface that is composited in z-order.
+      * A thread-safe layer must not touch any state that is modified by the GUI thread
+      * while it is rendering, and must only use the painter and viewport passed to render().
+      */
+    virtual bool isThreadSafe() const;
+
+    /**
+      * @brief Returns a revision number of the data the layer renders (default: -1).
+      * The offscreen surface of a thread-safe layer is reused as long as the viewport and
+      * the revision number stay unchanged. Layers that cannot tell whether their content
+      * changed return a negative value, which disables surface reuse.
+      */
+    virtual qint64 renderRevision() const;
 
     /**
       * @brief Returns a debug line for perfo/tracing issues
@@ -24,6 +24,16 @@
 #include "PluginManager.h"
 #include "RenderPlugin.h"
 #include "LayerInterface.h"
+#include "TraceRecorder.h"
+#include "ViewportParams.h"
+
+// Qt
+#include <QFuture>
+#include <QHash>
+#include <QImage>
+#include <QPair>
+#include <QSet>
+#include <QtConcurrentRun>
 
 namespace Marble
 {
@@ -38,6 +48,57 @@ bool zValueLessThan( const LayerInterface * const one, const LayerInterface * co
     return one->zValue() < two->zValue();
 }
 
+/**
+  * Offscreen surface of a thread-safe layer for one render position. The image is
+  * reused as long as the viewport and the render revision of the layer do not change.
+  */
+struct LayerSurface
+{
+    LayerSurface() : revision( -1 ), renderTime( 0 ), pending( false ) {}
+
+    QImage image;
+    QString viewportKey;
+    qint64 revision;
+    int renderTime;
+    bool pending;
+    QFuture<void> future;
+};
+
+typedef QPair<LayerInterface *, QString> LayerSurfaceKey;
+
+/**
+  * Returns the name of the trace zone covering the rendering of @p layer. Only
+  * call it while tracing is enabled.
+  */
+const char *traceZoneName( LayerInterface *layer )
+{
+    const RenderPlugin *renderPlugin = dynamic_cast<const RenderPlugin *>( layer );
+    if ( renderPlugin ) {
+        return TraceRecorder::internName( renderPlugin->nameId() + "::render" );
+    }
+
+    // internal layers trace their own zones
+    return "LayerManager::renderLayer";
+}
+
+/**
+  * Renders @p layer into the image of @p surface. Called from a worker thread.
+  */
+void renderLayerSurface( LayerInterface *layer, ViewportParams *viewport,
+                         const QString &renderPosition, MapQuality mapQuality,
+                         LayerSurface *surface )
+{
+    QTime timer;
+    timer.start();
+
+    TraceZone zone( TraceRecorder::isEnabled() ? traceZoneName( layer ) : 0 );
+    surface->image.fill( Qt::transparent );
+    GeoPainter painter( &surface->image, viewport, mapQuality );
+    layer->render( &painter, viewport, renderPosition, 0 );
+
+    surface->renderTime = timer.elapsed();
+}
+
 class LayerManager::Private
 {
  public:
@@ -48,6 +109,10 @@ class LayerManager::Private
 
     void addPlugins();
 
+    void clearSurfaces();
+
+    static QString viewportKey( const ViewportParams *viewport, MapQuality mapQuality );
+
     LayerManager *const q;
 
     QList<RenderPlugin *> m_renderPlugins;
@@ -59,6 +124,9 @@ class LayerManager::Private
     bool m_showBackground;
 
     bool m_showRuntimeTrace;
+
+    bool m_parallelRendering;
+    QHash<LayerSurfaceKey, LayerSurface *> m_surfaces;
 };
 
 LayerManager::Private::Private( const MarbleModel* model, LayerManager *parent )
@@ -66,15 +134,39 @@ LayerManager::Private::Private( const MarbleModel* model, LayerManager *parent )
       m_renderPlugins(),
       m_model( model ),
       m_showBackground( true ),
-      m_showRuntimeTrace( false )
+      m_showRuntimeTrace( false ),
+      m_parallelRendering( false )
 {
 }
 
 LayerManager::Private::~Private()
 {
+    clearSurfaces();
     qDeleteAll( m_renderPlugins );
 }
 
+void LayerManager::Private::clearSurfaces()
+{
+    foreach( LayerSurface *surface, m_surfaces ) {
+        surface->future.waitForFinished();
+    }
+
+    qDeleteAll( m_surfaces );
+    m_surfaces.clear();
+}
+
+QString LayerManager::Private::viewportKey( const ViewportParams *viewport, MapQuality mapQuality )
+{
+    return QString( "%1 %2 %3 %4 %5x%6 %7" )
+            .arg( viewport->projection() )
+            .arg( viewport->radius() )
+            .arg( viewport->centerLongitude(), 0, 'g', 17 )
+            .arg( viewport->centerLatitude(), 0, 'g', 17 )
+            .arg( viewport->width() )
+            .arg( viewport->height() )
+            .arg( mapQuality );
+}
+
 void LayerManager::Private::updateVisibility( bool visible, const QString &nameId )
 {
     emit q->visibilityChanged( nameId, visible );
@@ -126,6 +218,7 @@ QList<AbstractDataPluginItem *> LayerManager::whichItemAt( const QPoint& curpos
 
 void LayerManager::renderLayers( GeoPainter *painter, ViewportParams *viewport )
 {
+    TraceZone zone( "LayerManager::renderLayers" );
     const QTime totalTime = QTime::currentTime();
 
     QStringList renderPositions;
@@ -137,7 +230,7 @@ void LayerManager::renderLayers( GeoPainter *painter, ViewportParams *viewport )
     renderPositions << "SURFACE" << "HOVERS_ABOVE_SURFACE" << "ATMOSPHERE"
                     << "ORBIT" << "ALWAYS_ON_TOP" << "FLOAT_ITEM" << "USER_TOOLS";
 
-    QStringList traceList;
+    QList< QList<LayerInterface*> > layersByPosition;
     foreach( const QString& renderPosition, renderPositions ) {
         QList<LayerInterface*> layers;
 
@@ -164,15 +257,85 @@ void LayerManager::renderLayers( GeoPainter *painter, ViewportParams *viewport )
         // sort them according to their zValue()s
         qSort( layers.begin(), layers.end(), zValueLessThan );
 
-        // render the layers of the current renderPosition
-        QTime timer;
-        foreach( LayerInterface *layer, layers ) {
-            timer.start();
-            layer->render( painter, viewport, renderPosition, 0 );
-            traceList.append( QString("%2 ms %3").arg( timer.elapsed(),3 ).arg( layer->runtimeTrace() ) );
+        layersByPosition.append( layers );
+    }
+
+    // start rendering of all thread-safe layers whose surfaces are outdated
+    QSet<LayerSurfaceKey> usedSurfaces;
+    if ( d->m_parallelRendering ) {
+        const MapQuality mapQuality = painter->mapQuality();
+        const QString viewportKey = Private::viewportKey( viewport, mapQuality );
+
+        for ( int i = 0; i < renderPositions.size(); ++i ) {
+            foreach( LayerInterface *layer, layersByPosition.at( i ) ) {
+                if ( !layer->isThreadSafe() ) {
+                    continue;
+                }
+
+                const LayerSurfaceKey key( layer, renderPositions.at( i ) );
+                usedSurfaces.insert( key );
+
+                LayerSurface *surface = d->m_surfaces.value( key, 0 );
+                if ( !surface ) {
+                    surface = new LayerSurface;
+                    d->m_surfaces.insert( key, surface );
+                }
+
+                const qint64 revision = layer->renderRevision();
+                if ( revision >= 0 && surface->revision == revision
+                     && surface->viewportKey == viewportKey ) {
+                    continue;
+                }
+
+                if ( surface->image.size() != viewport->size() ) {
+                    surface->image = QImage( viewport->size(), QImage::Format_ARGB32_Premultiplied );
+                }
+                surface->viewportKey = viewportKey;
+                surface->revision = revision;
+                surface->pending = true;
+                surface->future = QtConcurrent::run( renderLayerSurface, layer, viewport,
+                                                     renderPositions.at( i ), mapQuality, surface );
+            }
+        }
+
+        // drop the surfaces of layers which are not rendered anymore
+        foreach( const LayerSurfaceKey &key, d->m_surfaces.keys() ) {
+            if ( !usedSurfaces.contains( key ) ) {
+                delete d->m_surfaces.take( key );
+            }
         }
     }
 
+    // render the layers of each renderPosition, compositing the surfaces in z-order
+    QStringList traceList;
+    QTime timer;
+    for ( int i = 0; i < renderPositions.size(); ++i ) {
+        const QString &renderPosition = renderPositions.at( i );
+        foreach( LayerInterface *layer, layersByPosition.at( i ) ) {
+            timer.start();
+            LayerSurface *surface = d->m_surfaces.value( LayerSurfaceKey( layer, renderPosition ), 0 );
+            if ( !surface ) {
+                TraceZone layerZone( TraceRecorder::isEnabled() ? traceZoneName( layer ) : 0 );
+                layer->render( painter, viewport, renderPosition, 0 );
+                traceList.append( QString("%2 ms %3").arg( timer.elapsed(),3 ).arg( layer->runtimeTrace() ) );
+                continue;
+            }
+
+            const bool cached = !surface->pending;
+            surface->future.waitForFinished();
+            surface->pending = false;
+            const int waited = timer.elapsed();
+            painter->drawImage( 0, 0, surface->image );
+
+            if ( cached ) {
+                traceList.append( QString( "%1 ms %2 (cached)" ).arg( 0, 3 ).arg( layer->runtimeTrace() ) );
+            }
+            else {
+                traceList.append( QString( "%1 ms %2 (parallel, waited %3 ms)" )
+                                  .arg( surface->renderTime, 3 ).arg( layer->runtimeTrace() ).arg( waited ) );
+            }
+        }
+    }
 
     if ( d->m_showRuntimeTrace ) {
         const int totalElapsed = totalTime.elapsed();
@@ -246,6 +409,20 @@ void LayerManager::setShowRuntimeTrace( bool show )
     d->m_showRuntimeTrace = show;
 }
 
+void LayerManager::setParallelRendering( bool enabled )
+{
+    d->m_parallelRendering = enabled;
+
+    if ( !enabled ) {
+        d->clearSurfaces();
+    }
+}
+
+bool LayerManager::isParallelRendering() const
+{
+    return d->m_parallelRendering;
+}
+
 void LayerManager::setVisible( const QString &nameId, bool visible )
 {
     foreach( RenderPlugin * renderPlugin, d->m_renderPlugins ) {
@@ -268,6 +445,14 @@ void LayerManager::addLayer(LayerInterface *layer)
 void LayerManager::removeLayer(LayerInterface *layer)
 {
     d->m_internalLayers.removeAll(layer);
+
+    foreach( const LayerSurfaceKey &key, d->m_surfaces.keys() ) {
+        if ( key.first == layer ) {
+            LayerSurface *surface = d->m_surfaces.take( key );
+            surface->future.waitForFinished();
+            delete surface;
+        }
+    }
 }
 
 QList<LayerInterface *> LayerManager::internalLayers() const
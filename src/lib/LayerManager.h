@@ -83,6 +83,12 @@ class LayerManager : public QObject
 
     QList<LayerInterface *> internalLayers() const;
 
+    /**
+     * @brief Returns whether thread-safe layers are rendered concurrently
+     * @see setParallelRendering
+     */
+    bool isParallelRendering() const;
+
  Q_SIGNALS:
     /**
      * @brief Signal that a render item has been initialized
@@ -108,6 +114,15 @@ class LayerManager : public QObject
 
     void setShowRuntimeTrace( bool show );
 
+    /**
+     * @brief Enable or disable parallel rendering of layers
+     * If enabled, layers that declare themselves thread-safe (LayerInterface::isThreadSafe())
+     * are rendered concurrently into cached offscreen surfaces, which are composited in
+     * z-order. A surface is reused while the viewport and the layer's render revision
+     * stay the same. Disabled by default.
+     */
+    void setParallelRendering( bool enabled );
+
     void setVisible( const QString &nameId, bool visible );
 
  private:
@@ -14,15 +14,23 @@
 #include "MapThemeManager.h"
 
 // Qt
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
 #include <QScopedPointer>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QTimer>
 #include <QStandardItemModel>
+#include <QtConcurrentMap>
 
 // Local dir
 #include "GeoSceneDocument.h"
@@ -31,6 +39,7 @@
 #include "GeoSceneParser.h"
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
+#include "MarbleGlobal.h"
 #include "Planet.h"
 
 namespace
@@ -42,6 +51,41 @@ namespace
 namespace Marble
 {
 
+/**
+ * Properties of a map theme shown in the map theme model, cached in the map
+ * theme catalogue so that the .dgml file only needs to be parsed and its
+ * preview only needs to be scaled if the file changed.
+ */
+struct MapThemeCatalogueEntry
+{
+    MapThemeCatalogueEntry() :
+        lastModified( 0 ),
+        visible( false )
+    {
+    }
+
+    uint lastModified;
+    QString name;
+    QString description;
+    QString target;
+    bool visible;
+    QImage icon;
+};
+
+QDataStream &operator<<( QDataStream &stream, const MapThemeCatalogueEntry &entry )
+{
+    stream << entry.lastModified << entry.name << entry.description
+           << entry.target << entry.visible << entry.icon;
+    return stream;
+}
+
+QDataStream &operator>>( QDataStream &stream, MapThemeCatalogueEntry &entry )
+{
+    stream >> entry.lastModified >> entry.name >> entry.description
+           >> entry.target >> entry.visible >> entry.icon;
+    return stream;
+}
+
 class MapThemeManager::Private
 {
 public:
@@ -51,14 +95,48 @@ public:
     void directoryChanged( const QString& path );
     void fileChanged( const QString & path );
 
+    /**
+     * @brief Adds the map themes parsed in the background to the catalogue and the model.
+     */
+    void parsingFinished();
+
     /**
      * @brief Updates the map theme model on request.
      *
      * This method should usually get invoked on startup or
-     * by a QFileSystemWatcher instance.
+     * by a QFileSystemWatcher instance. Map themes that are not in the
+     * catalogue or changed since are parsed in the background.
      */
     void updateMapThemeModel();
 
+    /**
+     * @brief Waits until all map themes queued for parsing are in the model.
+     */
+    void finishParsing();
+
+    /**
+     * @brief Parses the given map themes in the background, or queues
+     *        them if another parse is running.
+     */
+    void parseMapThemes( const QStringList &mapThemeIds );
+
+    /**
+     * @brief Stops parsing in the background. Themes parsed completely so far
+     *        are kept in the catalogue.
+     */
+    void cancelParsing();
+
+    /**
+     * @brief Moves the finished results of the background parse into the catalogue.
+     * @return the ids of the map themes stored
+     */
+    QStringList storeParsedMapThemes();
+
+    /**
+     * @brief Inserts a row for the given map theme, keeping the model sorted by id.
+     */
+    void insertMapThemeRow( const QString &mapThemeId, const MapThemeCatalogueEntry &entry );
+
     void watchPaths();
 
     /**
@@ -79,10 +157,24 @@ public:
 
     static GeoSceneDocument* loadMapThemeFile( const QString& mapThemeId );
 
+    /**
+     * @brief Returns the absolute path of the .dgml file of the given map theme.
+     */
+    static QString mapThemeFilePath( const QString &mapThemeId );
+
+    /**
+     * @brief Parses the given map theme and scales its preview. Thread-safe.
+     */
+    static MapThemeCatalogueEntry parseMapTheme( const QString &mapThemeId );
+
     /**
      * @brief Helper method for updateMapThemeModel().
      */
-    static QList<QStandardItem *> createMapThemeRow( const QString& mapThemeID );
+    static QList<QStandardItem *> createMapThemeRow( const QString& mapThemeID, const MapThemeCatalogueEntry &entry );
+
+    static QString catalogueFileName();
+    void readCatalogue();
+    void writeCatalogue();
 
     /**
      * @brief Deletes any directory with its contents.
@@ -97,6 +189,14 @@ public:
     QFileSystemWatcher m_fileSystemWatcher;
     bool m_isInitialized;
 
+    /** Map theme properties by absolute .dgml file path */
+    QHash<QString, MapThemeCatalogueEntry> m_catalogue;
+    bool m_catalogueChanged;
+
+    QFutureWatcher<MapThemeCatalogueEntry> m_parseWatcher;
+    QStringList m_parsedIds;
+    QStringList m_queuedIds;
+
 private:
     /**
      * @brief Returns all directory paths and .dgml file paths below local and
@@ -110,12 +210,18 @@ MapThemeManager::Private::Private( MapThemeManager *parent )
       m_mapThemeModel( 0, 3 ),
       m_celestialList(),
       m_fileSystemWatcher(),
-      m_isInitialized( false )
+      m_isInitialized( false ),
+      m_catalogueChanged( false )
 {
+    readCatalogue();
 }
 
 MapThemeManager::Private::~Private()
 {
+    cancelParsing();
+    if ( m_catalogueChanged ) {
+        writeCatalogue();
+    }
 }
 
 
@@ -128,6 +234,8 @@ MapThemeManager::MapThemeManager( QObject *parent )
              this, SLOT(directoryChanged(QString)));
     connect( &d->m_fileSystemWatcher, SIGNAL(fileChanged(QString)),
              this, SLOT(fileChanged(QString)));
+    connect( &d->m_parseWatcher, SIGNAL(finished()),
+             this, SLOT(parsingFinished()) );
 }
 
 MapThemeManager::~MapThemeManager()
@@ -144,6 +252,9 @@ QStringList MapThemeManager::mapThemeIds() const
         d->m_isInitialized = true;
     }
 
+    // callers expect a complete list
+    d->finishParsing();
+
     for( int i = 0; i < d->m_mapThemeModel.rowCount(); ++i ) {
         const QString id = d->m_mapThemeModel.data( d->m_mapThemeModel.index( i, 0 ), Qt::UserRole + 1 ).toString();
         result << id;
@@ -335,44 +446,67 @@ QStandardItemModel *MapThemeManager::celestialBodiesModel()
     return &d->m_celestialList;
 }
 
-QList<QStandardItem *> MapThemeManager::Private::createMapThemeRow( QString const& mapThemeID )
+QString MapThemeManager::Private::mapThemeFilePath( const QString &mapThemeId )
 {
-    QList<QStandardItem *> itemList;
+    return MarbleDirs::path( mapDirName + '/' + mapThemeId );
+}
 
-    QScopedPointer<GeoSceneDocument> mapTheme( loadMapThemeFile( mapThemeID ) );
-    if ( !mapTheme || !mapTheme->head()->visible() ) {
-        return itemList;
+MapThemeCatalogueEntry MapThemeManager::Private::parseMapTheme( const QString &mapThemeId )
+{
+    MapThemeCatalogueEntry entry;
+    entry.lastModified = QFileInfo( mapThemeFilePath( mapThemeId ) ).lastModified().toTime_t();
+
+    QScopedPointer<GeoSceneDocument> mapTheme( loadMapThemeFile( mapThemeId ) );
+    if ( !mapTheme ) {
+        return entry;
     }
 
-    QPixmap themeIconPixmap;
-    QString relativePath;
+    entry.name = mapTheme->head()->name();
+    entry.description = mapTheme->head()->description();
+    entry.target = mapTheme->head()->target();
+    entry.visible = mapTheme->head()->visible();
+    if ( !entry.visible ) {
+        return entry;
+    }
 
-    relativePath = mapDirName + '/'
+    const QString relativePath = mapDirName + '/'
         + mapTheme->head()->target() + '/' + mapTheme->head()->theme() + '/'
         + mapTheme->head()->icon()->pixmap();
-    themeIconPixmap.load( MarbleDirs::path( relativePath ) );
+    entry.icon.load( MarbleDirs::path( relativePath ) );
 
-    if ( themeIconPixmap.isNull() ) {
-        relativePath = "svg/application-x-marble-gray.png"; 
-        themeIconPixmap.load( MarbleDirs::path( relativePath ) );
-    }
-    else {
+    if ( !entry.icon.isNull() ) {
         // Make sure we don't keep excessively large previews in memory
         // TODO: Scale the icon down to the default icon size in MarbleSelectView.
         //       For now maxIconSize already equals what's expected by the listview.
         QSize maxIconSize( 136, 136 );
-        if ( themeIconPixmap.size() != maxIconSize ) {
+        if ( entry.icon.size() != maxIconSize ) {
             mDebug() << "Smooth scaling theme icon";
-            themeIconPixmap = themeIconPixmap.scaled( maxIconSize,
-                                                      Qt::KeepAspectRatio,
-                                                      Qt::SmoothTransformation );
+            entry.icon = entry.icon.scaled( maxIconSize,
+                                            Qt::KeepAspectRatio,
+                                            Qt::SmoothTransformation );
         }
     }
 
+    return entry;
+}
+
+QList<QStandardItem *> MapThemeManager::Private::createMapThemeRow( QString const& mapThemeID, const MapThemeCatalogueEntry &entry )
+{
+    QList<QStandardItem *> itemList;
+
+    if ( !entry.visible ) {
+        return itemList;
+    }
+
+    QPixmap themeIconPixmap = QPixmap::fromImage( entry.icon );
+    if ( themeIconPixmap.isNull() ) {
+        themeIconPixmap.load( MarbleDirs::path( "svg/application-x-marble-gray.png" ) );
+    }
+
     QIcon mapThemeIcon =  QIcon( themeIconPixmap );
 
-    QString name = mapTheme->head()->name();
-    QString description = mapTheme->head()->description();
+    QString name = entry.name;
+    QString description = entry.description;
 
     QStandardItem *item = new QStandardItem( name );
     item->setData( QObject::tr( name.toUtf8() ), Qt::DisplayRole );
@@ -387,6 +521,21 @@ QList<QStandardItem *> MapThemeManager::Private::createMapThemeRow( QString cons
     return itemList;
 }
 
+void MapThemeManager::Private::insertMapThemeRow( const QString &mapThemeId, const MapThemeCatalogueEntry &entry )
+{
+    QList<QStandardItem *> itemList = createMapThemeRow( mapThemeId, entry );
+    if ( itemList.empty() ) {
+        return;
+    }
+
+    int row = 0;
+    while ( row < m_mapThemeModel.rowCount()
+            && m_mapThemeModel.data( m_mapThemeModel.index( row, 0 ), Qt::UserRole + 1 ).toString() < mapThemeId ) {
+        ++row;
+    }
+    m_mapThemeModel.insertRow( row, itemList );
+}
+
 void MapThemeManager::Private::updateMapThemeModel()
 {
     mDebug() << "updateMapThemeModel";
@@ -394,18 +543,51 @@ void MapThemeManager::Private::updateMapThemeModel()
 
     m_mapThemeModel.setHeaderData(0, Qt::Horizontal, QObject::tr("Name"));
 
+    // the model is rebuilt from scratch, so results of a running parse are not needed anymore
+    cancelParsing();
+    m_queuedIds.clear();
+
     QStringList stringlist = findMapThemes();
     QStringListIterator it( stringlist );
 
+    QStringList staleIds;
+    QSet<QString> paths;
     while ( it.hasNext() ) {
         QString mapThemeID = it.next();
+        const QString path = mapThemeFilePath( mapThemeID );
+        paths << path;
+
+        QHash<QString, MapThemeCatalogueEntry>::const_iterator entry = m_catalogue.constFind( path );
+        const uint lastModified = QFileInfo( path ).lastModified().toTime_t();
+        if ( entry == m_catalogue.constEnd() || entry->lastModified != lastModified ) {
+            staleIds << mapThemeID;
+            continue;
+        }
 
-    	QList<QStandardItem *> itemList = createMapThemeRow( mapThemeID );
+        QList<QStandardItem *> itemList = createMapThemeRow( mapThemeID, *entry );
         if ( !itemList.empty() ) {
             m_mapThemeModel.appendRow( itemList );
         }
     }
 
+    // forget about themes that were removed
+    QHash<QString, MapThemeCatalogueEntry>::iterator entry = m_catalogue.begin();
+    while ( entry != m_catalogue.end() ) {
+        if ( !paths.contains( entry.key() ) ) {
+            entry = m_catalogue.erase( entry );
+            m_catalogueChanged = true;
+        } else {
+            ++entry;
+        }
+    }
+
+    if ( !staleIds.isEmpty() ) {
+        mDebug() << "Parsing" << staleIds.size() << "of" << stringlist.size() << "map themes in the background";
+        parseMapThemes( staleIds );
+    } else if ( m_catalogueChanged ) {
+        writeCatalogue();
+    }
+
     foreach ( const QString &mapThemeId, stringlist ) {
         QString celestialBodyId = mapThemeId.section( '/', 0, 0 );
         QString celestialBodyName = Planet::name( celestialBodyId );
@@ -419,6 +601,147 @@ void MapThemeManager::Private::updateMapThemeModel()
     }
 }
 
+void MapThemeManager::Private::parseMapThemes( const QStringList &mapThemeIds )
+{
+    if ( !m_parsedIds.isEmpty() ) {
+        foreach( const QString &mapThemeId, mapThemeIds ) {
+            if ( !m_queuedIds.contains( mapThemeId ) ) {
+                m_queuedIds << mapThemeId;
+            }
+        }
+        return;
+    }
+
+    m_parsedIds = mapThemeIds;
+    m_parseWatcher.setFuture( QtConcurrent::mapped( m_parsedIds, &Private::parseMapTheme ) );
+}
+
+QStringList MapThemeManager::Private::storeParsedMapThemes()
+{
+    QStringList result;
+    const QFuture<MapThemeCatalogueEntry> future = m_parseWatcher.future();
+    for ( int i = 0; i < m_parsedIds.size(); ++i ) {
+        if ( future.isResultReadyAt( i ) ) {
+            const QString &mapThemeId = m_parsedIds.at( i );
+            m_catalogue[mapThemeFilePath( mapThemeId )] = future.resultAt( i );
+            result << mapThemeId;
+        }
+    }
+
+    if ( !result.isEmpty() ) {
+        m_catalogueChanged = true;
+    }
+    m_parsedIds.clear();
+
+    return result;
+}
+
+void MapThemeManager::Private::cancelParsing()
+{
+    if ( m_parsedIds.isEmpty() ) {
+        return;
+    }
+
+    m_parseWatcher.cancel();
+    m_parseWatcher.waitForFinished();
+    storeParsedMapThemes();
+}
+
+void MapThemeManager::Private::finishParsing()
+{
+    while ( !m_parsedIds.isEmpty() ) {
+        m_parseWatcher.waitForFinished();
+        parsingFinished();
+    }
+}
+
+void MapThemeManager::Private::parsingFinished()
+{
+    // already handled by finishParsing() or cancelParsing()
+    if ( m_parsedIds.isEmpty() ) {
+        return;
+    }
+
+    foreach( const QString &mapThemeId, storeParsedMapThemes() ) {
+        const QString path = mapThemeFilePath( mapThemeId );
+        insertMapThemeRow( mapThemeId, m_catalogue.value( path ) );
+    }
+
+    if ( !m_queuedIds.isEmpty() ) {
+        const QStringList queuedIds = m_queuedIds;
+        m_queuedIds.clear();
+        parseMapThemes( queuedIds );
+    } else {
+        writeCatalogue();
+    }
+
+    emit q->themesChanged();
+}
+
+QString MapThemeManager::Private::catalogueFileName()
+{
+    return MarbleDirs::localPath() + "/mapthemes.index";
+}
+
+void MapThemeManager::Private::readCatalogue()
+{
+    QFile file( catalogueFileName() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_6 );
+
+    QString version;
+    stream >> version;
+    if ( version != MARBLE_VERSION_STRING ) {
+        // the dgml format may have changed, parse all themes again
+        return;
+    }
+
+    stream >> m_catalogue;
+    if ( stream.status() != QDataStream::Ok ) {
+        m_catalogue.clear();
+    }
+}
+
+void MapThemeManager::Private::writeCatalogue()
+{
+    QDir().mkpath( MarbleDirs::localPath() );
+
+    // Write a temporary file first so that a crash or a second Marble instance
+    // writing at the same time never leaves a truncated catalogue behind
+    const QString fileName = catalogueFileName();
+    const QString temporaryFileName = fileName + '.' + QString::number( QCoreApplication::applicationPid() );
+    QFile file( temporaryFileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        mDebug() << "Unable to write map theme catalogue" << temporaryFileName;
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_6 );
+    stream << MARBLE_VERSION_STRING << m_catalogue;
+    file.close();
+
+    if ( stream.status() != QDataStream::Ok || file.error() != QFile::NoError ) {
+        mDebug() << "Unable to write map theme catalogue" << temporaryFileName;
+        QFile::remove( temporaryFileName );
+        return;
+    }
+
+    // QFile::rename() does not overwrite existing files
+    QFile::remove( fileName );
+    if ( !QFile::rename( temporaryFileName, fileName ) ) {
+        mDebug() << "Unable to replace map theme catalogue" << fileName;
+        QFile::remove( temporaryFileName );
+        return;
+    }
+
+    m_catalogueChanged = false;
+}
+
 void MapThemeManager::Private::watchPaths()
 {
     QStringList const paths = pathsToWatch();
@@ -460,25 +783,24 @@ void MapThemeManager::Private::fileChanged( const QString& path )
                                                                           columnRelativePath );
     mDebug() << "matchingItems:" << matchingItems.size();
     Q_ASSERT( matchingItems.size() <= 1 );
-    int insertAtRow = 0;
 
     if ( matchingItems.size() == 1 ) {
-        const int row = matchingItems.front()->row();
-	insertAtRow = row;
-        QList<QStandardItem *> toBeDeleted = m_mapThemeModel.takeRow( row );
-	while ( !toBeDeleted.isEmpty() ) {
+        QList<QStandardItem *> toBeDeleted = m_mapThemeModel.takeRow( matchingItems.front()->row() );
+        while ( !toBeDeleted.isEmpty() ) {
             delete toBeDeleted.takeFirst();
         }
     }
 
     QFileInfo fileInfo( path );
     if ( fileInfo.exists() ) {
-        QList<QStandardItem *> newMapThemeRow = createMapThemeRow( mapThemeId );
-        if ( !newMapThemeRow.empty() ) {
-            m_mapThemeModel.insertRow( insertAtRow, newMapThemeRow );
-        }
+        // the row is added again once the changed file is parsed
+        parseMapThemes( QStringList() << mapThemeId );
+        return;
     }
-    
+
+    m_catalogue.remove( path );
+    m_catalogueChanged = true;
+
     emit q->themesChanged();
 }
 
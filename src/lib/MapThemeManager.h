@@ -98,6 +98,7 @@ class MARBLE_EXPORT MapThemeManager : public QObject
  private:
     Q_PRIVATE_SLOT( d, void directoryChanged( const QString& path ) )
     Q_PRIVATE_SLOT( d, void fileChanged( const QString & path ) )
+    Q_PRIVATE_SLOT( d, void parsingFinished() )
 
     Q_DISABLE_COPY( MapThemeManager )
 
@@ -70,6 +70,7 @@
 #include "TileCreator.h"
 #include "TileCreatorDialog.h"
 #include "TileLoader.h"
+#include "TraceRecorder.h"
 #include "VectorComposer.h"
 #include "ViewParams.h"
 #include "ViewportParams.h"
@@ -198,6 +199,11 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
     QObject::connect( &m_geometryLayer, SIGNAL(repaintNeeded()),
                       parent, SIGNAL(repaintNeeded()));
 
+    QObject::connect( &m_geometryLayer, SIGNAL(indexingProgress(int,int)),
+                      parent, SIGNAL(indexingProgress(int,int)) );
+    QObject::connect( &m_placemarkLayer, SIGNAL(indexingProgress(int,int)),
+                      parent, SIGNAL(indexingProgress(int,int)) );
+
     QObject::connect( &m_textureLayer, SIGNAL(tileLevelChanged(int)),
                       parent, SIGNAL(tileLevelChanged(int)) );
     QObject::connect( &m_textureLayer, SIGNAL(repaintNeeded()),
@@ -507,6 +513,11 @@ void MarbleMap::downloadRegion( QVector<TileCoordsPyramid> const & pyramid )
     mDebug() << "MarbleMap::downloadRegion:" << tilesCount << "tiles, " << elapsedMs << "ms";
 }
 
+void MarbleMap::prefetchTiles( const GeoDataLineString &path, int radius )
+{
+    d->m_textureLayer.prefetchTiles( path, radius, size() );
+}
+
 bool MarbleMap::propertyValue( const QString& name ) const
 {
     bool value;
@@ -636,6 +647,11 @@ bool MarbleMap::showFrameRate() const
     return d->m_showFrameRate;
 }
 
+bool MarbleMap::isParallelRendering() const
+{
+    return d->m_layerManager.isParallelRendering();
+}
+
 bool MarbleMap::showBackground() const
 {
     return d->m_layerManager.showBackground();
@@ -752,6 +768,7 @@ void MarbleMapPrivate::setDocument( QString key )
 void MarbleMap::paint( GeoPainter &painter, const QRect &dirtyRect )
 {
     Q_UNUSED( dirtyRect );
+    TraceZone zone( "MarbleMap::paint" );
 
     if ( !d->m_model->mapTheme() ) {
         mDebug() << "No theme yet!";
@@ -1193,6 +1210,11 @@ void MarbleMap::setShowRuntimeTrace( bool visible )
     d->m_layerManager.setShowRuntimeTrace( visible );
 }
 
+void MarbleMap::setParallelRendering( bool enabled )
+{
+    d->m_layerManager.setParallelRendering( enabled );
+}
+
 void MarbleMap::setShowBackground( bool visible )
 {
     d->m_layerManager.setShowBackground( visible );
@@ -43,6 +43,7 @@ class MarbleMapPrivate;
 
 // Marble
 class GeoDataLatLonAltBox;
+class GeoDataLineString;
 class GeoDataPlacemark;
 class MarbleModel;
 class ViewportParams;
@@ -355,6 +356,12 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     bool showBackground() const;
 
+    /**
+     * @brief  Return whether thread-safe layers are rendered concurrently
+     * @see setParallelRendering
+     */
+    bool isParallelRendering() const;
+
     /**
      * @brief  Returns the limit in kilobytes of the volatile (in RAM) tile cache.
      * @return the limit of volatile tile cache in kilobytes.
@@ -612,6 +619,13 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     void setShowRuntimeTrace( bool visible );
 
+    /**
+     * @brief Set whether thread-safe layers are rendered concurrently
+     * @param enabled  whether parallel layer rendering is used
+     * @see LayerManager::setParallelRendering
+     */
+    void setParallelRendering( bool enabled );
+
     void setShowBackground( bool visible );
 
      /**
@@ -639,6 +653,16 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     void downloadRegion( QVector<TileCoordsPyramid> const & );
 
+    /**
+     * @brief Load the texture tiles needed along a camera path ahead of time
+     *
+     * The map is expected to be centered on each point of @p path in turn,
+     * shown with the given @p radius. Tiles are decoded and downloaded in that
+     * order within a memory and bandwidth budget. A new path replaces the
+     * previous one.
+     */
+    void prefetchTiles( const GeoDataLineString &path, int radius );
+
  Q_SIGNALS:
     void tileLevelChanged( int level );
 
@@ -658,6 +682,13 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     void framesPerSecond( qreal fps );
 
+    /**
+     * This signal is emitted while large documents are indexed for display in the
+     * background. It is emitted separately for geometries and placemarks; each of
+     * them has been indexed completely once @p processed equals @p total.
+     */
+    void indexingProgress( int processed, int total );
+
     /**
      * This signal is emitted when the repaint of the view was requested.
      * If available with the @p dirtyRegion which is the region the view will change in.
@@ -65,6 +65,7 @@
 #include "TileCreator.h"
 #include "TileCreatorDialog.h"
 #include "TileLoader.h"
+#include "TraceRecorder.h"
 #include "routing/RoutingManager.h"
 #include "BookmarkManager.h"
 #include "ElevationModel.h"
@@ -182,6 +183,10 @@ MarbleModel::MarbleModel( QObject *parent )
              &d->m_storageWatcher, SLOT(resetCurrentSize()) );
     connect( &d->m_storagePolicy, SIGNAL(sizeChanged(qint64)),
              &d->m_storageWatcher, SLOT(addToCurrentSize(qint64)) );
+    connect( &d->m_storagePolicy, SIGNAL(fileUpdated(QString,qint64)),
+             &d->m_storageWatcher, SLOT(updateFile(QString,qint64)) );
+    connect( &d->m_downloadManager, SIGNAL(fileAccessed(QString)),
+             &d->m_storageWatcher, SLOT(accessFile(QString)) );
 
     d->m_fileManager = new FileManager( this );
 
@@ -696,6 +701,21 @@ void MarbleModel::setWorkOffline( bool workOffline )
     }
 }
 
+bool MarbleModel::tracingEnabled() const
+{
+    return TraceRecorder::isEnabled();
+}
+
+void MarbleModel::setTracingEnabled( bool enabled )
+{
+    TraceRecorder::setEnabled( enabled );
+}
+
+bool MarbleModel::saveTrace( const QString &fileName ) const
+{
+    return TraceRecorder::saveChromeTrace( fileName );
+}
+
 ElevationModel* MarbleModel::elevationModel()
 {
     return d->m_elevationModel;
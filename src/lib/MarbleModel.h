@@ -270,6 +270,19 @@ class MARBLE_EXPORT MarbleModel : public QObject
 
     void setWorkOffline( bool workOffline );
 
+    /**
+     * @brief Returns whether the time spent in the render pipeline, tile loading,
+     * downloads and parsing is recorded
+     * @see TraceRecorder
+     */
+    bool tracingEnabled() const;
+
+    /**
+     * @brief Writes the recorded trace to @p fileName in the Chrome trace event format
+     * @return false if the file cannot be written
+     */
+    bool saveTrace( const QString &fileName ) const;
+
     ElevationModel* elevationModel();
     const ElevationModel* elevationModel() const;
 
@@ -297,6 +310,12 @@ class MARBLE_EXPORT MarbleModel : public QObject
 
     void updateProperty( const QString &property, bool value );
 
+    /**
+     * @brief Enable or disable recording a trace of the time spent in each zone
+     * @see tracingEnabled(), saveTrace()
+     */
+    void setTracingEnabled( bool enabled );
+
  Q_SIGNALS:
 
     /**
@@ -169,6 +169,17 @@ void MarblePhysics::flyTo( const GeoDataLookAt &target, FlyToMode mode )
         break;
     }
 
+    // Load the tiles of the target view while the animation is running.
+    // A jump passes the intermediate views at a much lower zoom level,
+    // so only the target is worth prefetching then.
+    GeoDataLineString path;
+    if ( effectiveMode == Linear ) {
+        path << d->m_source.coordinates();
+    }
+    path << target.coordinates();
+    const int targetRadius = qRound( d->m_widget->radiusFromDistance( target.range() * METER2KM ) );
+    d->m_widget->prefetchTiles( path, targetRadius );
+
     d->m_timeline.start();
 }
 
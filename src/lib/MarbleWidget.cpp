@@ -519,6 +519,11 @@ bool MarbleWidget::showFrameRate() const
     return d->m_showFrameRate;
 }
 
+bool MarbleWidget::isParallelRendering() const
+{
+    return d->m_map.isParallelRendering();
+}
+
 bool MarbleWidget::showBackground() const
 {
     return d->m_map.showBackground();
@@ -1067,6 +1072,13 @@ void MarbleWidget::setShowRuntimeTrace( bool visible )
     d->m_map.setShowRuntimeTrace( visible );
 }
 
+void MarbleWidget::setParallelRendering( bool enabled )
+{
+    d->m_map.setParallelRendering( enabled );
+
+    update();
+}
+
 void MarbleWidget::setShowTileId( bool visible )
 {
     d->m_map.setShowTileId( visible );
@@ -1341,6 +1353,11 @@ void MarbleWidget::downloadRegion( QVector<TileCoordsPyramid> const & pyramid )
     d->m_map.downloadRegion( pyramid );
 }
 
+void MarbleWidget::prefetchTiles( const GeoDataLineString &path, int radius )
+{
+    d->m_map.prefetchTiles( path, radius );
+}
+
 GeoDataLookAt MarbleWidget::lookAt() const
 {
     GeoDataLookAt result;
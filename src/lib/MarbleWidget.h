@@ -40,6 +40,7 @@ class AbstractDataPluginItem;
 class AbstractFloatItem;
 class GeoDataLatLonAltBox;
 class GeoDataLatLonBox;
+class GeoDataLineString;
 class GeoPainter;
 class GeoSceneDocument;
 class LayerInterface;
@@ -539,6 +540,12 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
 
     bool showBackground() const;
 
+    /**
+     * @brief  Return whether thread-safe layers are rendered concurrently
+     * @see setParallelRendering
+     */
+    bool isParallelRendering() const;
+
     /**
      * @brief Retrieve the map quality depending on the view context
      */
@@ -910,6 +917,12 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
      */
     void setShowRuntimeTrace( bool visible );
 
+    /**
+     * @brief Set whether thread-safe layers are rendered concurrently
+     * @param enabled  whether parallel layer rendering is used
+     */
+    void setParallelRendering( bool enabled );
+
     /**
      * @brief Set the map quality for the specified view context.
      *
@@ -967,6 +980,12 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
 
     void downloadRegion( QVector<TileCoordsPyramid> const & );
 
+    /**
+     * @brief Load the texture tiles needed along a camera path ahead of time
+     * @see MarbleMap::prefetchTiles
+     */
+    void prefetchTiles( const GeoDataLineString &path, int radius );
+
     //@}
 
     /// @name Miscellaneous slots
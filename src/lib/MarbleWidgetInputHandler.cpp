@@ -34,6 +34,7 @@
 #include "MarbleGlobal.h"
 #include "MarbleDebug.h"
 #include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
 #include "MarbleDirs.h"
 #include "MarbleWidget.h"
 #include "MarbleModel.h"
@@ -168,6 +169,12 @@ class MarbleWidgetDefaultInputHandler::Private
       */
     void MoveTo(MarbleWidget* marbleWidget, const QPoint &pos, qreal zoomFactor);
 
+    /**
+      * @brief Start the kinetic spinning and prefetch the tiles on its way
+      * @param widget The marble widget to work on
+      */
+    void startKineticSpinning( MarbleWidget *widget );
+
     QPixmap m_curpmtl;
     QPixmap m_curpmtc;
     QPixmap m_curpmtr;
@@ -241,6 +248,19 @@ MarbleWidgetDefaultInputHandler::Private::~Private()
 {
 }
 
+void MarbleWidgetDefaultInputHandler::Private::startKineticSpinning( MarbleWidget *widget )
+{
+    m_kineticSpinning.start();
+
+    const QPointF target = m_kineticSpinning.finalPosition();
+    if ( target != m_kineticSpinning.position() ) {
+        GeoDataLineString path;
+        path << GeoDataCoordinates( widget->centerLongitude(), widget->centerLatitude(), 0.0, GeoDataCoordinates::Degree );
+        path << GeoDataCoordinates( target.x(), qBound<qreal>( -90.0, target.y(), 90.0 ), 0.0, GeoDataCoordinates::Degree );
+        widget->prefetchTiles( path, widget->radius() );
+    }
+}
+
 void MarbleWidgetDefaultInputHandler::Private::ZoomAt(MarbleWidget* marbleWidget, const QPoint &pos, qreal newDistance)
 {
     Q_ASSERT(newDistance > 0.0);
@@ -439,7 +459,7 @@ bool MarbleWidgetDefaultInputHandler::eventFilter( QObject* o, QEvent* e )
                 d->m_leftPressed = false;
 
                 if ( MarbleWidgetInputHandler::d->m_inertialEarthRotation ) {
-                    d->m_kineticSpinning.start();
+                    d->startKineticSpinning( MarbleWidgetInputHandler::d->m_widget );
                 } else {
                     MarbleWidgetInputHandler::d->m_widget->setViewContext( Still );
                 }
@@ -546,7 +566,7 @@ bool MarbleWidgetDefaultInputHandler::eventFilter( QObject* o, QEvent* e )
                 d->m_midPressedY = event->y();
 
                 if ( MarbleWidgetInputHandler::d->m_inertialEarthRotation ) {
-                    d->m_kineticSpinning.start();
+                    d->startKineticSpinning( MarbleWidgetInputHandler::d->m_widget );
                 }
 
                 d->m_selectionRubber.hide();
@@ -580,7 +600,7 @@ bool MarbleWidgetDefaultInputHandler::eventFilter( QObject* o, QEvent* e )
 
                 d->m_leftPressed = false;
                 if ( MarbleWidgetInputHandler::d->m_inertialEarthRotation ) {
-                    d->m_kineticSpinning.start();
+                    d->startKineticSpinning( MarbleWidgetInputHandler::d->m_widget );
                 } else {
                     MarbleWidgetInputHandler::d->m_widget->setViewContext( Still );
                 }
@@ -644,7 +664,7 @@ bool MarbleWidgetDefaultInputHandler::eventFilter( QObject* o, QEvent* e )
             d->m_leftPressed = false;
 
             if ( MarbleWidgetInputHandler::d->m_inertialEarthRotation ) {
-                d->m_kineticSpinning.start();
+                d->startKineticSpinning( MarbleWidgetInputHandler::d->m_widget );
             }
 
             QRect boundingRect = MarbleWidgetInputHandler::d->m_widget->mapRegion().boundingRect();
@@ -39,6 +39,7 @@
 #include "TileCreator.h"
 #include "TileCreatorDialog.h"
 #include "TileLoader.h"
+#include "TraceRecorder.h"
 
 #include "GeoDataCoordinates.h"
 
@@ -171,6 +172,7 @@ QSize MergedLayerDecorator::tileSize() const
 
 StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPointer<TextureTile> > &tiles ) const
 {
+    TraceZone zone( "MergedLayerDecorator::createTile" );
     Q_ASSERT( !tiles.isEmpty() );
 
     const TileId firstId = tiles.first()->id();
@@ -296,6 +298,7 @@ void MergedLayerDecorator::Private::renderGroundOverlays( QImage *tileImage, con
 
 StackedTile *MergedLayerDecorator::loadTile( const TileId &stackedTileId )
 {
+    TraceZone zone( "MergedLayerDecorator::loadTile" );
     const QVector<const GeoSceneTextureTile *> textureLayers = d->findRelevantTextureLayers( stackedTileId );
     QVector<QSharedPointer<TextureTile> > tiles;
 
@@ -353,6 +356,19 @@ void MergedLayerDecorator::downloadStackedTile( const TileId &id, DownloadUsage
     }
 }
 
+bool MergedLayerDecorator::isTileAvailable( const TileId &id ) const
+{
+    const QVector<const GeoSceneTextureTile *> textureLayers = d->findRelevantTextureLayers( id );
+
+    foreach ( const GeoSceneTextureTile *textureLayer, textureLayers ) {
+        if ( TileLoader::tileStatus( textureLayer, id ) == TileLoader::Missing ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void MergedLayerDecorator::setShowSunShading( bool show )
 {
     d->m_showSunShading = show;
@@ -68,6 +68,12 @@ class MergedLayerDecorator
 
     void downloadStackedTile( const TileId &id, DownloadUsage usage );
 
+    /**
+     * Returns true if the tiles of all texture layers needed for the stacked tile
+     * are stored locally, such that loadTile() does not need to scale a replacement.
+     */
+    bool isTileAvailable( const TileId &id ) const;
+
     void setShowSunShading( bool show );
     bool showSunShading() const;
 
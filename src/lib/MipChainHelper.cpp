@@ -0,0 +1,70 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "MipChainHelper.h"
+
+#include <QtGlobal>
+
+namespace Marble
+{
+
+// Scaled tiles are reused as long as their size differs by at most this fraction from the size needed
+static const qreal sizeTolerance = 0.05;
+// The last level of a mip chain is at most this wide or high
+static const int minimumMipSize = 8;
+
+QVector<QImage> MipChainHelper::createMipChain( const QImage &source, const QRect &part )
+{
+    QImage image = part == source.rect() ? source : source.copy( part ).scaled( source.size() );
+
+    QVector<QImage> chain;
+    chain << image;
+    while ( image.width() > minimumMipSize && image.height() > minimumMipSize ) {
+        image = image.scaled( image.width() / 2, image.height() / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+        chain << image;
+    }
+
+    return chain;
+}
+
+const QImage &MipChainHelper::mipLevel( const QVector<QImage> &chain, const QSize &size )
+{
+    int level = 0;
+    while ( level + 1 < chain.size()
+            && chain.at( level + 1 ).width() >= size.width()
+            && chain.at( level + 1 ).height() >= size.height() ) {
+        ++level;
+    }
+
+    return chain.at( level );
+}
+
+QImage MipChainHelper::scaledTile( const QVector<QImage> &chain, const QSize &size )
+{
+    return mipLevel( chain, size ).scaled( size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+}
+
+int MipChainHelper::mipChainCost( const QVector<QImage> &chain )
+{
+    int cost = 0;
+    foreach ( const QImage &image, chain ) {
+        cost += image.byteCount() / 1024;
+    }
+
+    return cost;
+}
+
+bool MipChainHelper::withinTolerance( const QSize &size, const QSize &needed )
+{
+    return qAbs( size.width() - needed.width() ) <= sizeTolerance * needed.width()
+        && qAbs( size.height() - needed.height() ) <= sizeTolerance * needed.height();
+}
+
+}
@@ -0,0 +1,59 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef MARBLE_MIPCHAINHELPER_H
+#define MARBLE_MIPCHAINHELPER_H
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+
+namespace Marble
+{
+
+/**
+ * Mip chains of tiles as used by the TileScalingTextureMapper
+ */
+namespace MipChainHelper
+{
+    /**
+     * @brief Creates the mip chain of the @p part of @p source.
+     * The first level is the part scaled to the size of @p source, each
+     * further level is half as large, down to a few pixels.
+     */
+    QVector<QImage> createMipChain( const QImage &source, const QRect &part );
+
+    /**
+     * @brief Returns the smallest level of @p chain which is at least as large as @p size.
+     * The first level is returned for sizes larger than the chain.
+     */
+    const QImage &mipLevel( const QVector<QImage> &chain, const QSize &size );
+
+    /**
+     * @brief Returns @p chain scaled to @p size from the level returned by mipLevel()
+     */
+    QImage scaledTile( const QVector<QImage> &chain, const QSize &size );
+
+    /**
+     * @brief Returns the memory used by the images of @p chain in kilobytes
+     */
+    int mipChainCost( const QVector<QImage> &chain );
+
+    /**
+     * @brief Returns whether a tile scaled to @p size may be drawn at @p needed.
+     * The sizes may differ by five percent in each direction.
+     */
+    bool withinTolerance( const QSize &size, const QSize &needed );
+}
+
+}
+
+#endif
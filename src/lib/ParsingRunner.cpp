@@ -13,11 +13,22 @@ namespace Marble
 {
 
 ParsingRunner::ParsingRunner( QObject *parent )
-    : QObject( parent )
+    : QObject( parent ),
+      m_threadCount( 1 )
 {
     // nothing to do
 }
 
+void ParsingRunner::setThreadCount( int threads )
+{
+    m_threadCount = qMax( 1, threads );
+}
+
+int ParsingRunner::threadCount() const
+{
+    return m_threadCount;
+}
+
 }
 
 #include "ParsingRunner.moc"
@@ -35,6 +35,13 @@ public:
       */
     virtual void parseFile( const QString &fileName, DocumentRole role ) = 0;
 
+    /**
+      * The number of threads the runner may use to parse a single large file.
+      * Runners are free to ignore it. Defaults to one.
+      */
+    void setThreadCount( int threads );
+    int threadCount() const;
+
 Q_SIGNALS:
     /**
      * File parsing is finished, result in the given document object.
@@ -42,6 +49,9 @@ Q_SIGNALS:
      * To be emitted by runners after a @see parseFile call.
      */
     void parsingFinished( GeoDataDocument* document, const QString& error = QString() );
+
+private:
+    int m_threadCount;
 };
 
 }
@@ -17,9 +17,9 @@
 #include "GeoDataPlacemark.h"
 #include "PluginManager.h"
 #include "ParseRunnerPlugin.h"
+#include "ParsingRunner.h"
 #include "RunnerTask.h"
 
-#include <QFileInfo>
 #include <QList>
 #include <QThreadPool>
 #include <QTimer>
@@ -43,12 +43,14 @@ public:
     const PluginManager *const m_pluginManager;
     QList<ParsingTask *> m_parsingTasks;
     GeoDataDocument *m_fileResult;
+    int m_threadCount;
 };
 
 ParsingRunnerManager::Private::Private( ParsingRunnerManager *parent, const PluginManager *pluginManager ) :
     q( parent ),
     m_pluginManager( pluginManager ),
-    m_fileResult( 0 )
+    m_fileResult( 0 ),
+    m_threadCount( 1 )
 {
     qRegisterMetaType<GeoDataDocument*>( "GeoDataDocument*" );
 }
@@ -94,19 +96,15 @@ ParsingRunnerManager::~ParsingRunnerManager()
 
 void ParsingRunnerManager::parseFile( const QString &fileName, DocumentRole role )
 {
-    QList<const ParseRunnerPlugin*> plugins = d->m_pluginManager->parsingRunnerPlugins();
-    const QFileInfo fileInfo( fileName );
-    const QString suffix = fileInfo.suffix().toLower();
-    const QString completeSuffix = fileInfo.completeSuffix().toLower();
+    QList<const ParseRunnerPlugin*> plugins = d->m_pluginManager->parsingRunnerPlugins( fileName );
 
     foreach( const ParseRunnerPlugin *plugin, plugins ) {
-        QStringList const extensions = plugin->fileExtensions();
-        if ( extensions.isEmpty() || extensions.contains( suffix ) || extensions.contains( completeSuffix ) ) {
-            ParsingTask *task = new ParsingTask( plugin->newRunner(), this, fileName, role );
-            connect( task, SIGNAL(finished(ParsingTask*)), this, SLOT(cleanupParsingTask(ParsingTask*)) );
-            mDebug() << "parse task " << plugin->nameId() << " " << (quintptr)task;
-            d->m_parsingTasks << task;
-        }
+        ParsingRunner *runner = plugin->newRunner();
+        runner->setThreadCount( d->m_threadCount );
+        ParsingTask *task = new ParsingTask( runner, this, fileName, role );
+        connect( task, SIGNAL(finished(ParsingTask*)), this, SLOT(cleanupParsingTask(ParsingTask*)) );
+        mDebug() << "parse task " << plugin->nameId() << " " << (quintptr)task;
+        d->m_parsingTasks << task;
     }
 
     foreach ( ParsingTask *task, d->m_parsingTasks ) {
@@ -118,6 +116,16 @@ void ParsingRunnerManager::parseFile( const QString &fileName, DocumentRole role
     }
 }
 
+void ParsingRunnerManager::setThreadCount( int threads )
+{
+    d->m_threadCount = qMax( 1, threads );
+}
+
+int ParsingRunnerManager::threadCount() const
+{
+    return d->m_threadCount;
+}
+
 GeoDataDocument *ParsingRunnerManager::openFile( const QString &fileName, DocumentRole role, int timeout ) {
     QEventLoop localEventLoop;
     QTimer watchdog;
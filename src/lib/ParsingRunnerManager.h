@@ -52,6 +52,14 @@ public:
     void parseFile( const QString &fileName, DocumentRole role = UserDocument );
     GeoDataDocument *openFile( const QString &fileName, DocumentRole role = UserDocument, int timeout = 30000 );
 
+    /**
+     * Sets the number of threads a runner may use to parse a single file.
+     * Runners which support it (KML and GPX) split large files into chunks
+     * which are parsed concurrently. Defaults to one, i.e. no splitting.
+     */
+    void setThreadCount( int threads );
+    int threadCount() const;
+
 Q_SIGNALS:
     /**
      * The file was parsed and potential error message
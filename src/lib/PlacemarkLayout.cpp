@@ -13,6 +13,7 @@
 #include "PlacemarkLayout.h"
 
 #include <QAbstractItemModel>
+#include <QFutureWatcher>
 #include <QList>
 #include <QPoint>
 #include <QVector>
@@ -20,6 +21,7 @@
 #include <QFont>
 #include <QFontMetrics>
 #include <QItemSelectionModel>
+#include <QtConcurrentMap>
 #include <qmath.h>
 
 #include "GeoDataPlacemark.h"
@@ -35,12 +37,81 @@
 #include "ViewportParams.h"
 #include "TileId.h"
 #include "TileCoordsPyramid.h"
+#include "TraceRecorder.h"
 #include "VisiblePlacemark.h"
 #include "MathHelper.h"
 
 namespace Marble
 {
 
+const int PlacemarkLayout::s_asyncThreshold = 10000;
+const int PlacemarkLayout::s_chunkSize = 1000;
+
+typedef QVector< QPair<const GeoDataPlacemark*, GeoDataCoordinates> > PlacemarkChunk;
+typedef QList< QPair<TileId, const GeoDataPlacemark*> > TiledPlacemarkList;
+
+/**
+ * Multi geometries recompute their bounding box on each access, so the
+ * coordinates of their placemarks are determined on the GUI thread.
+ */
+static bool hasMultiGeometry( const GeoDataPlacemark *placemark )
+{
+    const GeoDataGeometry *geometry = placemark->geometry();
+    return geometry && ( geometry->nodeType() == GeoDataTypes::GeoDataMultiGeometryType
+                         || geometry->nodeType() == GeoDataTypes::GeoDataMultiTrackType );
+}
+
+/**
+ * Determines the tiles of a chunk of placemarks on a worker thread.
+ */
+class PlacemarkTileBuilder
+{
+public:
+    typedef TiledPlacemarkList result_type;
+
+    PlacemarkTileBuilder( const QDateTime &dateTime,
+                          const QVector<GeoDataFeature::GeoDataVisualCategory> &acceptedVisualCategories )
+        : m_dateTime( dateTime ),
+          m_acceptedVisualCategories( acceptedVisualCategories )
+    {
+    }
+
+    TiledPlacemarkList operator()( const PlacemarkChunk &chunk ) const
+    {
+        typedef QPair<const GeoDataPlacemark*, GeoDataCoordinates> PlacemarkEntry;
+        TiledPlacemarkList result;
+        foreach( const PlacemarkEntry &entry, chunk ) {
+            const GeoDataPlacemark *placemark = entry.first;
+            const GeoDataCoordinates coordinates = hasMultiGeometry( placemark ) ? entry.second :
+                    PlacemarkLayout::placemarkIconCoordinates( placemark, m_dateTime, m_acceptedVisualCategories );
+            if ( coordinates.isValid() ) {
+                result << qMakePair( TileId::fromCoordinates( coordinates, placemark->zoomLevel() ), placemark );
+            }
+        }
+        return result;
+    }
+
+private:
+    QDateTime m_dateTime;
+    QVector<GeoDataFeature::GeoDataVisualCategory> m_acceptedVisualCategories;
+};
+
+/**
+ * A batch of placemarks indexed in chunks on worker threads. The placemarks of
+ * each chunk are added to the placemark cache as soon as the chunk and all
+ * chunks before it are done, so they keep their order in the model.
+ */
+class PlacemarkBatch
+{
+public:
+    PlacemarkBatch() : placemarkCount( 0 ), chunkCount( 0 ), merged( 0 ) {}
+
+    QFutureWatcher<TiledPlacemarkList> watcher;
+    int placemarkCount;
+    int chunkCount;
+    int merged;
+};
+
 QVector<GeoDataFeature::GeoDataVisualCategory> sortedVisualCategories()
 {
     QVector<GeoDataFeature::GeoDataVisualCategory> visualCategories;
@@ -140,6 +211,8 @@ PlacemarkLayout::PlacemarkLayout( QAbstractItemModel  *placemarkModel,
     : QObject( parent ),
       m_selectionModel( selectionModel ),
       m_clock( clock ),
+      m_indexedPlacemarks( 0 ),
+      m_totalPlacemarks( 0 ),
       m_acceptedVisualCategories( sortedVisualCategories() ),
       m_showPlaces( false ),
       m_showCities( false ),
@@ -172,6 +245,7 @@ PlacemarkLayout::PlacemarkLayout( QAbstractItemModel  *placemarkModel,
 
 PlacemarkLayout::~PlacemarkLayout()
 {
+    finishIndexing();
     styleReset();
 }
 
@@ -247,12 +321,17 @@ QVector<const GeoDataPlacemark*> PlacemarkLayout::whichPlacemarkAt( const QPoint
 int PlacemarkLayout::maxLabelHeight() const
 {
     int maxLabelHeight = 0;
+    QSet<const GeoDataStyle*> styles;
 
     for ( int i = 0; i < m_placemarkModel.rowCount(); ++i ) {
         QModelIndex index = m_placemarkModel.index( i, 0 );
         const GeoDataPlacemark *placemark = dynamic_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
         if ( placemark ) {
             const GeoDataStyle* style = placemark->style();
+            if ( styles.contains( style ) ) {
+                continue;
+            }
+            styles.insert( style );
             QFont labelFont = style->labelStyle().font();
             int textHeight = QFontMetrics( labelFont ).height();
             if ( textHeight > maxLabelHeight )
@@ -269,6 +348,47 @@ void PlacemarkLayout::addPlacemarks( QModelIndex parent, int first, int last )
 {
     Q_ASSERT( first < m_placemarkModel.rowCount() );
     Q_ASSERT( last < m_placemarkModel.rowCount() );
+
+    if ( last - first + 1 >= s_asyncThreshold ) {
+        // Determine the tiles of large batches in chunks on worker threads. The
+        // placemarks must not be modified meanwhile, see finishIndexing()
+        QList<PlacemarkChunk> chunks;
+        PlacemarkChunk chunk;
+        chunk.reserve( s_chunkSize );
+        for( int i=first; i<=last; ++i ) {
+            QModelIndex index = m_placemarkModel.index( i, 0, parent );
+            Q_ASSERT( index.isValid() );
+            const GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
+            // the bounding boxes of line geometries are computed on first use,
+            // which must not happen on the worker threads
+            GeoDataCoordinates coordinates;
+            const GeoDataGeometry *geometry = placemark->geometry();
+            if ( hasMultiGeometry( placemark ) ) {
+                coordinates = placemarkIconCoordinates( placemark );
+            } else if ( geometry && geometry->nodeType() != GeoDataTypes::GeoDataTrackType ) {
+                geometry->latLonAltBox();
+            }
+            chunk << qMakePair( placemark, coordinates );
+            if ( chunk.size() == s_chunkSize || i == last ) {
+                chunks << chunk;
+                chunk.clear();
+                chunk.reserve( s_chunkSize );
+            }
+        }
+
+        PlacemarkBatch *batch = new PlacemarkBatch;
+        batch->placemarkCount = last - first + 1;
+        batch->chunkCount = chunks.size();
+        m_totalPlacemarks += batch->placemarkCount;
+        connect( &batch->watcher, SIGNAL(resultReadyAt(int)), this, SLOT(addIndexedPlacemarks()) );
+        connect( &batch->watcher, SIGNAL(finished()), this, SLOT(addIndexedPlacemarks()) );
+        m_indexing << batch;
+        const PlacemarkTileBuilder builder( m_clock->dateTime(), m_acceptedVisualCategories );
+        batch->watcher.setFuture( QtConcurrent::mapped( chunks, builder ) );
+        updateIndexingProgress();
+        return;
+    }
+
     for( int i=first; i<=last; ++i ) {
         QModelIndex index = m_placemarkModel.index( i, 0, parent );
         Q_ASSERT( index.isValid() );
@@ -286,10 +406,70 @@ void PlacemarkLayout::addPlacemarks( QModelIndex parent, int first, int last )
     emit repaintNeeded();
 }
 
+void PlacemarkLayout::addIndexedPlacemarks()
+{
+    if ( mergeIndexedPlacemarks() ) {
+        requestStyleReset();
+        emit repaintNeeded();
+    }
+
+    updateIndexingProgress();
+}
+
+void PlacemarkLayout::updateIndexingProgress()
+{
+    emit indexingProgress( m_indexedPlacemarks, m_totalPlacemarks );
+
+    if ( m_indexing.isEmpty() ) {
+        m_indexedPlacemarks = 0;
+        m_totalPlacemarks = 0;
+    }
+}
+
+bool PlacemarkLayout::mergeIndexedPlacemarks()
+{
+    typedef QPair<TileId, const GeoDataPlacemark*> TiledPlacemark;
+    bool merged = false;
+    while ( !m_indexing.isEmpty() ) {
+        PlacemarkBatch *batch = m_indexing.first();
+        const QFuture<TiledPlacemarkList> future = batch->watcher.future();
+        while ( batch->merged < batch->chunkCount && future.isResultReadyAt( batch->merged ) ) {
+            foreach( const TiledPlacemark &tiledPlacemark, future.resultAt( batch->merged ) ) {
+                m_placemarkCache[tiledPlacemark.first].append( tiledPlacemark.second );
+            }
+            m_indexedPlacemarks += qMin( s_chunkSize, batch->placemarkCount - batch->merged * s_chunkSize );
+            ++batch->merged;
+            merged = true;
+        }
+
+        if ( batch->merged < batch->chunkCount || !batch->watcher.isFinished() ) {
+            break;
+        }
+
+        m_indexing.removeFirst();
+        delete batch;
+    }
+
+    return merged;
+}
+
+void PlacemarkLayout::finishIndexing()
+{
+    foreach( PlacemarkBatch *batch, m_indexing ) {
+        batch->watcher.waitForFinished();
+    }
+    mergeIndexedPlacemarks();
+    Q_ASSERT( m_indexing.isEmpty() );
+}
+
 void PlacemarkLayout::removePlacemarks( QModelIndex parent, int first, int last )
 {
     Q_ASSERT( first < m_placemarkModel.rowCount() );
     Q_ASSERT( last < m_placemarkModel.rowCount() );
+    if ( m_totalPlacemarks > 0 ) {
+        finishIndexing();
+        updateIndexingProgress();
+    }
     for( int i=first; i<=last; ++i ) {
         QModelIndex index = m_placemarkModel.index( i, 0, parent );
         Q_ASSERT( index.isValid() );
@@ -310,9 +490,15 @@ void PlacemarkLayout::resetCacheData()
 {
     const int rowCount = m_placemarkModel.rowCount();
 
+    if ( m_totalPlacemarks > 0 ) {
+        finishIndexing();
+        updateIndexingProgress();
+    }
     m_placemarkCache.clear();
     requestStyleReset();
-    addPlacemarks( m_placemarkModel.index( 0, 0 ), 0, rowCount );
+    if ( rowCount > 0 ) {
+        addPlacemarks( QModelIndex(), 0, rowCount - 1 );
+    }
     emit repaintNeeded();
 }
 
@@ -370,6 +556,7 @@ QSet<TileId> PlacemarkLayout::visibleTiles( const ViewportParams *viewport ) con
 
 QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParams *viewport )
 {
+    TraceZone zone( "PlacemarkLayout::generateLayout" );
     m_runtimeTrace.clear();
     if ( m_placemarkModel.rowCount() <= 0 )
         return QVector<VisiblePlacemark *>();
@@ -586,11 +773,18 @@ bool PlacemarkLayout::layoutPlacemark( const GeoDataPlacemark *placemark, qreal
 }
 
 GeoDataCoordinates PlacemarkLayout::placemarkIconCoordinates( const GeoDataPlacemark *placemark ) const
+{
+    return placemarkIconCoordinates( placemark, m_clock->dateTime(), m_acceptedVisualCategories );
+}
+
+GeoDataCoordinates PlacemarkLayout::placemarkIconCoordinates( const GeoDataPlacemark *placemark,
+                                                              const QDateTime &dateTime,
+                                                              const QVector<GeoDataFeature::GeoDataVisualCategory> &acceptedVisualCategories )
 {
     bool ok;
-    GeoDataCoordinates coordinates = placemark->coordinate( m_clock->dateTime(), &ok );
-    if ( !ok && qBinaryFind( m_acceptedVisualCategories, placemark->visualCategory() )
-                != m_acceptedVisualCategories.constEnd() ) {
+    GeoDataCoordinates coordinates = placemark->coordinate( dateTime, &ok );
+    if ( !ok && qBinaryFind( acceptedVisualCategories, placemark->visualCategory() )
+                != acceptedVisualCategories.constEnd() ) {
         ok = true;
     }
 
@@ -18,7 +18,9 @@
 #define MARBLE_PLACEMARKLAYOUT_H
 
 
+#include <QDateTime>
 #include <QHash>
+#include <QList>
 #include <QModelIndex>
 #include <QRect>
 #include <QSet>
@@ -40,6 +42,7 @@ class GeoDataPlacemark;
 class GeoDataStyle;
 class GeoPainter;
 class MarbleClock;
+class PlacemarkBatch;
 class PlacemarkPainter;
 class TileId;
 class VisiblePlacemark;
@@ -101,7 +104,29 @@ class PlacemarkLayout : public QObject
  Q_SIGNALS:
     void repaintNeeded();
 
+    /**
+     * Emitted while large numbers of placemarks are added to the tile index in the
+     * background. Indexing is complete when @p processed equals @p total.
+     */
+    void indexingProgress( int processed, int total );
+
+ private Q_SLOTS:
+    void addIndexedPlacemarks();
+    void updateIndexingProgress();
+
  private:
+    /**
+     * Adds the placemarks indexed in the background to the placemark cache, in
+     * the order they were added to the model. Returns whether any were added.
+     */
+    bool mergeIndexedPlacemarks();
+
+    /**
+     * Waits for all placemarks that are indexed in the background and adds them
+     * to the placemark cache.
+     */
+    void finishIndexing();
+
     /**
      * Returns a the maximum height of all possible labels.
      * WARNING: This is a really slow method as it traverses all placemarks
@@ -123,6 +148,10 @@ class PlacemarkLayout : public QObject
      */
     GeoDataCoordinates placemarkIconCoordinates( const GeoDataPlacemark *placemark ) const;
 
+    static GeoDataCoordinates placemarkIconCoordinates( const GeoDataPlacemark *placemark,
+                                                        const QDateTime &dateTime,
+                                                        const QVector<GeoDataFeature::GeoDataVisualCategory> &acceptedVisualCategories );
+
     QRectF  roomForLabel( const GeoDataStyle * style,
                          const qreal x, const qreal y,
                          const QString &labelText ) const;
@@ -143,6 +172,9 @@ class PlacemarkLayout : public QObject
 
     /// map providing the list of placemark belonging in TileId as key
     QMap<TileId, QList<const GeoDataPlacemark*> > m_placemarkCache;
+    QList<PlacemarkBatch *> m_indexing;
+    int m_indexedPlacemarks;
+    int m_totalPlacemarks;
 
     const QVector< GeoDataFeature::GeoDataVisualCategory > m_acceptedVisualCategories;
 
@@ -159,6 +191,12 @@ class PlacemarkLayout : public QObject
 
     int     m_maxLabelHeight;
     bool    m_styleResetRequested;
+
+    /// Batches of at least that many placemarks are indexed on worker threads
+    static const int s_asyncThreshold;
+    static const int s_chunkSize;
+
+    friend class PlacemarkTileBuilder;
 };
 
 }
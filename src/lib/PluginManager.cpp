@@ -14,13 +14,22 @@
 #include "PluginManager.h"
 
 // Qt
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
 #include <QList>
 #include <QPluginLoader>
+#include <QSet>
 #include <QTime>
 
 // Local dir
 #include "MarbleDirs.h"
 #include "MarbleDebug.h"
+#include "MarbleGlobal.h"
 #include "RenderPlugin.h"
 #include "PositionProviderPlugin.h"
 #include "AbstractFloatItem.h"
@@ -32,19 +41,99 @@
 namespace Marble
 {
 
+/**
+ * Kind of plugin a shared object provides. Stored in the plugin index,
+ * so do not change the values of existing entries.
+ */
+enum PluginCategory {
+    UnknownPluginCategory = 0,
+    InvalidPluginCategory = 1,
+    RenderPluginCategory = 2,
+    PositionProviderPluginCategory = 3,
+    SearchRunnerPluginCategory = 4,
+    ReverseGeocodingRunnerPluginCategory = 5,
+    RoutingRunnerPluginCategory = 6,
+    ParseRunnerPluginCategory = 7
+};
+
+/**
+ * Metadata of a plugin shared object, cached in the plugin index file so that
+ * the shared object only needs to be loaded once its plugin is actually used.
+ */
+struct PluginIndexEntry
+{
+    PluginIndexEntry() :
+        lastModified( 0 ),
+        size( 0 ),
+        category( UnknownPluginCategory )
+    {
+    }
+
+    uint lastModified;
+    qint64 size;
+    int category;
+    QString nameId;
+    QStringList capabilities;
+    QStringList fileExtensions;
+};
+
+QDataStream &operator<<( QDataStream &stream, const PluginIndexEntry &entry )
+{
+    stream << entry.lastModified << entry.size << entry.category
+           << entry.nameId << entry.capabilities << entry.fileExtensions;
+    return stream;
+}
+
+QDataStream &operator>>( QDataStream &stream, PluginIndexEntry &entry )
+{
+    stream >> entry.lastModified >> entry.size >> entry.category
+           >> entry.nameId >> entry.capabilities >> entry.fileExtensions;
+    return stream;
+}
+
 class PluginManagerPrivate
 {
  public:
     PluginManagerPrivate()
-            : m_pluginsLoaded(false)
+            : m_pluginsScanned( false ),
+              m_indexChanged( false )
     {
+        m_startTime.start();
     }
 
     ~PluginManagerPrivate();
 
-    void loadPlugins();
+    /**
+     * Loads all plugins of the given category which have not been loaded yet.
+     * If @p fileName is given, only parse runner plugins which can handle
+     * that file are loaded.
+     */
+    void loadPlugins( PluginCategory category, const QString &fileName = QString() );
+
+    /**
+     * Checks the plugin files against the index. Files which are new or
+     * changed since the index was written are loaded to learn about them.
+     */
+    void scanPlugins();
+
+    bool loadPlugin( const QString &path );
+
+    /** Returns whether render plugins of the given backend types may be used */
+    bool acceptsRenderPlugin( const QStringList &backendTypes ) const;
+
+    static QString indexFileName();
+    void readIndex();
+    void writeIndex();
+
+    bool m_pluginsScanned;
+    bool m_indexChanged;
+    QTime m_startTime;
+    QStringList m_pluginFiles;
+    QHash<QString, PluginIndexEntry> m_index;
+    QSet<QString> m_loadedFiles;
+    QSet<int> m_loadedCategories;
+    QStringList m_renderBackendTypes;
 
-    bool m_pluginsLoaded;
     QList<const RenderPlugin *> m_renderPluginTemplates;
     QList<const PositionProviderPlugin *> m_positionProviderPluginTemplates;
     QList<const SearchRunnerPlugin *> m_searchRunnerPlugins;
@@ -70,78 +159,117 @@ PluginManager::~PluginManager()
 
 QList<const RenderPlugin *> PluginManager::renderPlugins() const
 {
-    d->loadPlugins();
-    return d->m_renderPluginTemplates;
+    d->loadPlugins( RenderPluginCategory );
+    if ( d->m_renderBackendTypes.isEmpty() ) {
+        return d->m_renderPluginTemplates;
+    }
+
+    // plugins which were loaded to update the index may not be allowed
+    QList<const RenderPlugin *> result;
+    foreach( const RenderPlugin *plugin, d->m_renderPluginTemplates ) {
+        if ( d->acceptsRenderPlugin( plugin->backendTypes() ) ) {
+            result << plugin;
+        }
+    }
+    return result;
 }
 
 void PluginManager::addRenderPlugin( const RenderPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( RenderPluginCategory );
     d->m_renderPluginTemplates << plugin;
     emit renderPluginsChanged();
 }
 
+void PluginManager::setRenderPluginBackendTypes( const QStringList &backendTypes )
+{
+    d->m_renderBackendTypes = backendTypes;
+}
+
+QStringList PluginManager::renderPluginBackendTypes() const
+{
+    return d->m_renderBackendTypes;
+}
+
 QList<const PositionProviderPlugin *> PluginManager::positionProviderPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( PositionProviderPluginCategory );
     return d->m_positionProviderPluginTemplates;
 }
 
 void PluginManager::addPositionProviderPlugin( const PositionProviderPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( PositionProviderPluginCategory );
     d->m_positionProviderPluginTemplates << plugin;
     emit positionProviderPluginsChanged();
 }
 
 QList<const SearchRunnerPlugin *> PluginManager::searchRunnerPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( SearchRunnerPluginCategory );
     return d->m_searchRunnerPlugins;
 }
 
 void PluginManager::addSearchRunnerPlugin( const SearchRunnerPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( SearchRunnerPluginCategory );
     d->m_searchRunnerPlugins << plugin;
     emit searchRunnerPluginsChanged();
 }
 
 QList<const ReverseGeocodingRunnerPlugin *> PluginManager::reverseGeocodingRunnerPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( ReverseGeocodingRunnerPluginCategory );
     return d->m_reverseGeocodingRunnerPlugins;
 }
 
 void PluginManager::addReverseGeocodingRunnerPlugin( const ReverseGeocodingRunnerPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( ReverseGeocodingRunnerPluginCategory );
     d->m_reverseGeocodingRunnerPlugins << plugin;
     emit reverseGeocodingRunnerPluginsChanged();
 }
 
 QList<RoutingRunnerPlugin *> PluginManager::routingRunnerPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( RoutingRunnerPluginCategory );
     return d->m_routingRunnerPlugins;
 }
 
 void PluginManager::addRoutingRunnerPlugin( RoutingRunnerPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( RoutingRunnerPluginCategory );
     d->m_routingRunnerPlugins << plugin;
     emit routingRunnerPluginsChanged();
 }
 
 QList<const ParseRunnerPlugin *> PluginManager::parsingRunnerPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( ParseRunnerPluginCategory );
     return d->m_parsingRunnerPlugins;
 }
 
+QList<const ParseRunnerPlugin *> PluginManager::parsingRunnerPlugins( const QString &fileName ) const
+{
+    d->loadPlugins( ParseRunnerPluginCategory, fileName );
+
+    const QFileInfo fileInfo( fileName );
+    const QString suffix = fileInfo.suffix().toLower();
+    const QString completeSuffix = fileInfo.completeSuffix().toLower();
+
+    QList<const ParseRunnerPlugin *> result;
+    foreach( const ParseRunnerPlugin *plugin, d->m_parsingRunnerPlugins ) {
+        QStringList const extensions = plugin->fileExtensions();
+        if ( extensions.isEmpty() || extensions.contains( suffix ) || extensions.contains( completeSuffix ) ) {
+            result << plugin;
+        }
+    }
+    return result;
+}
+
 void PluginManager::addParseRunnerPlugin( const ParseRunnerPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( ParseRunnerPluginCategory );
     d->m_parsingRunnerPlugins << plugin;
     emit parseRunnerPluginsChanged();
 }
@@ -180,20 +308,74 @@ bool appendPlugin( QObject * obj, QPluginLoader* &loader, QList<const T*> &plugi
     return false;
 }
 
-void PluginManagerPrivate::loadPlugins()
+/** Capabilities of runner plugins worth knowing without loading them */
+template<class T>
+QStringList runnerCapabilities( const T *plugin )
 {
-    if (m_pluginsLoaded)
-    {
+    QStringList result;
+    if ( plugin->canWorkOffline() ) {
+        result << "offline";
+    }
+    return result;
+}
+
+void PluginManagerPrivate::loadPlugins( PluginCategory category, const QString &fileName )
+{
+    if ( m_loadedCategories.contains( category ) ) {
         return;
     }
 
+    scanPlugins();
+
     QTime t;
     t.start();
-    mDebug() << "Starting to load Plugins.";
 
-    QStringList pluginFileNameList = MarbleDirs::pluginEntryList( "", QDir::Files );
+    const QFileInfo fileInfo( fileName );
+    const QString suffix = fileInfo.suffix().toLower();
+    const QString completeSuffix = fileInfo.completeSuffix().toLower();
 
-    MarbleDirs::debug();
+    int loaded = 0;
+    foreach( const QString &path, m_pluginFiles ) {
+        const PluginIndexEntry entry = m_index.value( path );
+        if ( entry.category != category || m_loadedFiles.contains( path ) ) {
+            continue;
+        }
+
+        if ( category == RenderPluginCategory && !acceptsRenderPlugin( entry.capabilities ) ) {
+            continue;
+        }
+
+        if ( !fileName.isEmpty() && !entry.fileExtensions.isEmpty()
+             && !entry.fileExtensions.contains( suffix )
+             && !entry.fileExtensions.contains( completeSuffix ) ) {
+            continue;
+        }
+
+        loadPlugin( path );
+        ++loaded;
+    }
+
+    if ( fileName.isEmpty() ) {
+        m_loadedCategories << category;
+    }
+
+    if ( m_indexChanged ) {
+        writeIndex();
+    }
+
+    mDebug() << Q_FUNC_INFO << "Loaded" << loaded << "plugins of category" << category
+             << "in" << t.elapsed() << "ms";
+}
+
+void PluginManagerPrivate::scanPlugins()
+{
+    if ( m_pluginsScanned ) {
+        return;
+    }
+
+    QTime t;
+    t.start();
+    mDebug() << "Starting to scan Plugins.";
 
     Q_ASSERT( m_renderPluginTemplates.isEmpty() );
     Q_ASSERT( m_positionProviderPluginTemplates.isEmpty() );
@@ -202,42 +384,196 @@ void PluginManagerPrivate::loadPlugins()
     Q_ASSERT( m_routingRunnerPlugins.isEmpty() );
     Q_ASSERT( m_parsingRunnerPlugins.isEmpty() );
 
+    readIndex();
+
+    QStringList pluginFileNameList = MarbleDirs::pluginEntryList( "", QDir::Files );
+
+    MarbleDirs::debug();
+
+    QSet<QString> knownFiles;
     foreach( const QString &fileName, pluginFileNameList ) {
-        // mDebug() << fileName << " - " << MarbleDirs::pluginPath( fileName );
         QString const path = MarbleDirs::pluginPath( fileName );
-        QPluginLoader* loader = new QPluginLoader( path );
-
-        QObject * obj = loader->instance();
-
-        if ( obj ) {
-            bool isPlugin = appendPlugin<RenderPlugin, RenderPluginInterface>
-                       ( obj, loader, m_renderPluginTemplates );
-            isPlugin = isPlugin || appendPlugin<PositionProviderPlugin, PositionProviderPluginInterface>
-                       ( obj, loader, m_positionProviderPluginTemplates );
-            isPlugin = isPlugin || appendPlugin<SearchRunnerPlugin, SearchRunnerPlugin>
-                       ( obj, loader, m_searchRunnerPlugins ); // intentionally T==U
-            isPlugin = isPlugin || appendPlugin<ReverseGeocodingRunnerPlugin, ReverseGeocodingRunnerPlugin>
-                       ( obj, loader, m_reverseGeocodingRunnerPlugins ); // intentionally T==U
-            isPlugin = isPlugin || appendPlugin<RoutingRunnerPlugin, RoutingRunnerPlugin>
-                       ( obj, loader, m_routingRunnerPlugins ); // intentionally T==U
-            isPlugin = isPlugin || appendPlugin<ParseRunnerPlugin, ParseRunnerPlugin>
-                       ( obj, loader, m_parsingRunnerPlugins ); // intentionally T==U
-            if ( !isPlugin ) {
-                qWarning() << "Ignoring the following plugin since it couldn't be loaded:" << path;
-                mDebug() << "Plugin failure:" << path << "is a plugin, but it does not implement the "
-                        << "right interfaces or it was compiled against an old version of Marble. Ignoring it.";
-                delete loader;
-            }
+        if ( knownFiles.contains( path ) ) {
+            continue;
+        }
+        knownFiles << path;
+        m_pluginFiles << path;
+
+        const QFileInfo fileInfo( path );
+        const PluginIndexEntry entry = m_index.value( path );
+        if ( entry.category == UnknownPluginCategory
+             || entry.lastModified != fileInfo.lastModified().toTime_t()
+             || entry.size != fileInfo.size() ) {
+            // not indexed yet or changed since, load it to learn what it is
+            loadPlugin( path );
+        }
+    }
+
+    foreach( const QString &path, m_index.keys() ) {
+        if ( !knownFiles.contains( path ) ) {
+            m_index.remove( path );
+            m_indexChanged = true;
+        }
+    }
+
+    m_pluginsScanned = true;
+
+    mDebug() << Q_FUNC_INFO << "Time elapsed:" << t.elapsed() << "ms";
+}
+
+bool PluginManagerPrivate::loadPlugin( const QString &path )
+{
+    if ( m_loadedFiles.contains( path ) ) {
+        return true;
+    }
+    m_loadedFiles << path;
+
+    QTime t;
+    t.start();
+
+    const QFileInfo fileInfo( path );
+    PluginIndexEntry entry;
+    entry.lastModified = fileInfo.lastModified().toTime_t();
+    entry.size = fileInfo.size();
+    entry.category = InvalidPluginCategory;
+
+    QPluginLoader* loader = new QPluginLoader( path );
+
+    QObject * obj = loader->instance();
+
+    if ( obj ) {
+        if ( appendPlugin<RenderPlugin, RenderPluginInterface>
+             ( obj, loader, m_renderPluginTemplates ) ) {
+            const RenderPlugin *plugin = qobject_cast<RenderPlugin*>( obj );
+            entry.category = RenderPluginCategory;
+            entry.nameId = plugin->nameId();
+            entry.capabilities = plugin->backendTypes();
+        } else if ( appendPlugin<PositionProviderPlugin, PositionProviderPluginInterface>
+                    ( obj, loader, m_positionProviderPluginTemplates ) ) {
+            entry.category = PositionProviderPluginCategory;
+            entry.nameId = qobject_cast<PositionProviderPlugin*>( obj )->nameId();
+        } else if ( appendPlugin<SearchRunnerPlugin, SearchRunnerPlugin>
+                    ( obj, loader, m_searchRunnerPlugins ) ) { // intentionally T==U
+            const SearchRunnerPlugin *plugin = qobject_cast<SearchRunnerPlugin*>( obj );
+            entry.category = SearchRunnerPluginCategory;
+            entry.nameId = plugin->nameId();
+            entry.capabilities = runnerCapabilities( plugin );
+        } else if ( appendPlugin<ReverseGeocodingRunnerPlugin, ReverseGeocodingRunnerPlugin>
+                    ( obj, loader, m_reverseGeocodingRunnerPlugins ) ) { // intentionally T==U
+            const ReverseGeocodingRunnerPlugin *plugin = qobject_cast<ReverseGeocodingRunnerPlugin*>( obj );
+            entry.category = ReverseGeocodingRunnerPluginCategory;
+            entry.nameId = plugin->nameId();
+            entry.capabilities = runnerCapabilities( plugin );
+        } else if ( appendPlugin<RoutingRunnerPlugin, RoutingRunnerPlugin>
+                    ( obj, loader, m_routingRunnerPlugins ) ) { // intentionally T==U
+            const RoutingRunnerPlugin *plugin = qobject_cast<RoutingRunnerPlugin*>( obj );
+            entry.category = RoutingRunnerPluginCategory;
+            entry.nameId = plugin->nameId();
+            entry.capabilities = runnerCapabilities( plugin );
+        } else if ( appendPlugin<ParseRunnerPlugin, ParseRunnerPlugin>
+                    ( obj, loader, m_parsingRunnerPlugins ) ) { // intentionally T==U
+            const ParseRunnerPlugin *plugin = qobject_cast<ParseRunnerPlugin*>( obj );
+            entry.category = ParseRunnerPluginCategory;
+            entry.nameId = plugin->nameId();
+            entry.fileExtensions = plugin->fileExtensions();
         } else {
-            qWarning() << "Ignoring to load the following file since it doesn't look like a valid Marble plugin:" << path << endl
-                       << "Reason:" << loader->errorString();
+            qWarning() << "Ignoring the following plugin since it couldn't be loaded:" << path;
+            mDebug() << "Plugin failure:" << path << "is a plugin, but it does not implement the "
+                    << "right interfaces or it was compiled against an old version of Marble. Ignoring it.";
             delete loader;
         }
+    } else {
+        qWarning() << "Ignoring to load the following file since it doesn't look like a valid Marble plugin:" << path << endl
+                   << "Reason:" << loader->errorString();
+        delete loader;
     }
 
-    m_pluginsLoaded = true;
+    m_index[path] = entry;
+    m_indexChanged = true;
 
-    mDebug() << Q_FUNC_INFO << "Time elapsed:" << t.elapsed() << "ms";
+    mDebug() << "Plugin" << fileInfo.fileName() << "loaded in" << t.elapsed() << "ms,"
+             << m_startTime.elapsed() << "ms after startup";
+
+    return entry.category != InvalidPluginCategory;
+}
+
+bool PluginManagerPrivate::acceptsRenderPlugin( const QStringList &backendTypes ) const
+{
+    if ( m_renderBackendTypes.isEmpty() ) {
+        return true;
+    }
+
+    foreach( const QString &backendType, backendTypes ) {
+        if ( m_renderBackendTypes.contains( backendType ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QString PluginManagerPrivate::indexFileName()
+{
+    return MarbleDirs::localPath() + "/plugins.index";
+}
+
+void PluginManagerPrivate::readIndex()
+{
+    QFile file( indexFileName() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_6 );
+
+    QString version;
+    stream >> version;
+    if ( version != MARBLE_VERSION_STRING ) {
+        // plugins of a different Marble version may not be compatible with the index
+        return;
+    }
+
+    stream >> m_index;
+    if ( stream.status() != QDataStream::Ok ) {
+        m_index.clear();
+    }
+}
+
+void PluginManagerPrivate::writeIndex()
+{
+    QDir().mkpath( MarbleDirs::localPath() );
+
+    // Write a temporary file first so that a crash or a second Marble instance
+    // writing at the same time never leaves a truncated index behind
+    const QString fileName = indexFileName();
+    const QString temporaryFileName = fileName + '.' + QString::number( QCoreApplication::applicationPid() );
+    QFile file( temporaryFileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        mDebug() << "Unable to write plugin index" << temporaryFileName;
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_6 );
+    stream << MARBLE_VERSION_STRING << m_index;
+    file.close();
+
+    if ( stream.status() != QDataStream::Ok || file.error() != QFile::NoError ) {
+        mDebug() << "Unable to write plugin index" << temporaryFileName;
+        QFile::remove( temporaryFileName );
+        return;
+    }
+
+    // QFile::rename() does not overwrite existing files
+    QFile::remove( fileName );
+    if ( !QFile::rename( temporaryFileName, fileName ) ) {
+        mDebug() << "Unable to replace plugin index" << fileName;
+        QFile::remove( temporaryFileName );
+        return;
+    }
+
+    m_indexChanged = false;
 }
 
 }
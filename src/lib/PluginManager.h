@@ -14,6 +14,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QStringList>
 #include "marble_export.h"
 
 
@@ -40,6 +41,11 @@ class ParseRunnerPlugin;
  * the objects, the PluginManager internally has a list of the plugins
  * which are owned by the PluginManager and destroyed by it.
  *
+ * Plugins are loaded on demand: The shared objects of a plugin category are
+ * only loaded once plugins of that category are requested. The name, category
+ * and capabilities of each plugin are cached in an index file in the local
+ * Marble directory, so that files which did not change since the last run
+ * don't need to be loaded just to find out what kind of plugin they contain.
  */
 
 class MARBLE_EXPORT PluginManager : public QObject
@@ -67,6 +73,18 @@ class MARBLE_EXPORT PluginManager : public QObject
      */
     void addRenderPlugin( const RenderPlugin *plugin );
 
+    /**
+     * Restricts the render plugins to those providing at least one of the given
+     * @p backendTypes. The backend types of plugins that did not change since the
+     * last run are taken from the plugin index, so the shared objects of all other
+     * render plugins are not loaded at all. An empty list, the default, allows all
+     * render plugins. Call it before the render plugins are requested.
+     * @see RenderPluginInterface::backendTypes()
+     */
+    void setRenderPluginBackendTypes( const QStringList &backendTypes );
+
+    QStringList renderPluginBackendTypes() const;
+
     /**
      * @brief Returns all available PositionProviderPlugins.
      *
@@ -128,6 +146,13 @@ class MARBLE_EXPORT PluginManager : public QObject
      */
     QList<const ParseRunnerPlugin *> parsingRunnerPlugins() const;
 
+    /**
+     * Returns the parse runner plugins which are able to handle the file @p fileName,
+     * judging by its file extension. Only the plugins for that file format are loaded.
+     * @note: The runner plugins are owned by the PluginManager, do not delete them.
+     */
+    QList<const ParseRunnerPlugin *> parsingRunnerPlugins( const QString &fileName ) const;
+
     /**
      * @brief Add a ParseRunnerPlugin manually to the list of known plugins. Normally you
      * don't need to call this method since all plugins are loaded automatically.
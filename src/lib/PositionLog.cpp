@@ -0,0 +1,286 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "PositionLog.h"
+
+#include "MarbleDebug.h"
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QVector>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Marble
+{
+
+// magic, version, capacity, count, next
+static const quint32 logMagic = 0x4d504c47; // "MPLG"
+static const quint32 logVersion = 1;
+static const qint64 headerSize = 5 * sizeof( quint32 );
+// timestamp in milliseconds (-1 if invalid), lon, lat, altitude, two accuracies, speed, direction
+static const qint64 recordSize = sizeof( qint64 ) + 7 * sizeof( double );
+// Number of fixes collected before they are written
+static const int batchSize = 100;
+
+class PositionLogPrivate
+{
+public:
+    PositionLogPrivate( const QString &fileName, int capacity );
+
+    void open();
+
+    void writeHeader();
+
+    /**
+     * Writes all data to the disk, returns false on errors
+     */
+    bool sync();
+
+    static void writeFix( QDataStream &stream, const PositionLog::Fix &fix );
+
+    static PositionLog::Fix readFix( QDataStream &stream );
+
+    QString m_fileName;
+    int m_capacity;
+    QFile m_file;
+    int m_count;
+    int m_next;
+    QVector<PositionLog::Fix> m_pending;
+};
+
+PositionLogPrivate::PositionLogPrivate( const QString &fileName, int capacity ) :
+    m_fileName( fileName ),
+    m_capacity( qMax( 1, capacity ) ),
+    m_file( fileName ),
+    m_count( 0 ),
+    m_next( 0 )
+{
+    // nothing to do
+}
+
+void PositionLogPrivate::open()
+{
+    if ( !m_file.open( QIODevice::ReadWrite ) ) {
+        mDebug() << "Cannot open position log" << m_fileName << ":" << m_file.errorString();
+        return;
+    }
+
+    QDataStream stream( &m_file );
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 capacity = 0;
+    quint32 count = 0;
+    quint32 next = 0;
+    stream >> magic >> version >> capacity >> count >> next;
+
+    if ( stream.status() == QDataStream::Ok && magic == logMagic && version == logVersion
+         && int( capacity ) == m_capacity && count <= capacity && next < capacity
+         && m_file.size() >= headerSize + qint64( count ) * recordSize ) {
+        m_count = count;
+        m_next = next;
+        return;
+    }
+
+    if ( m_file.size() > 0 ) {
+        mDebug() << "Discarding incompatible position log" << m_fileName;
+    }
+    m_file.resize( 0 );
+    m_count = 0;
+    m_next = 0;
+    writeHeader();
+}
+
+void PositionLogPrivate::writeHeader()
+{
+    m_file.seek( 0 );
+    QDataStream stream( &m_file );
+    stream << logMagic << logVersion << quint32( m_capacity ) << quint32( m_count ) << quint32( m_next );
+}
+
+bool PositionLogPrivate::sync()
+{
+    if ( !m_file.flush() ) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit( m_file.handle() ) == 0;
+#else
+    return fsync( m_file.handle() ) == 0;
+#endif
+}
+
+void PositionLogPrivate::writeFix( QDataStream &stream, const PositionLog::Fix &fix )
+{
+    const QDateTime timestamp = fix.timestamp.toUTC();
+    const qint64 milliseconds = timestamp.isValid() ? qint64( timestamp.toTime_t() ) * 1000 + timestamp.time().msec() : -1;
+    stream << milliseconds
+           << double( fix.position.longitude() ) << double( fix.position.latitude() )
+           << double( fix.position.altitude() )
+           << double( fix.accuracy.horizontal ) << double( fix.accuracy.vertical )
+           << double( fix.speed ) << double( fix.direction );
+}
+
+PositionLog::Fix PositionLogPrivate::readFix( QDataStream &stream )
+{
+    qint64 milliseconds = 0;
+    double lon = 0.0;
+    double lat = 0.0;
+    double altitude = 0.0;
+    double horizontal = 0.0;
+    double vertical = 0.0;
+    double speed = 0.0;
+    double direction = 0.0;
+    stream >> milliseconds >> lon >> lat >> altitude >> horizontal >> vertical >> speed >> direction;
+
+    PositionLog::Fix fix;
+    if ( milliseconds >= 0 ) {
+        fix.timestamp = QDateTime::fromTime_t( milliseconds / 1000 ).toUTC().addMSecs( milliseconds % 1000 );
+    }
+    fix.position = GeoDataCoordinates( lon, lat, altitude );
+    fix.accuracy = GeoDataAccuracy( GeoDataAccuracy::Detailed, horizontal, vertical );
+    fix.speed = speed;
+    fix.direction = direction;
+    return fix;
+}
+
+PositionLog::PositionLog( const QString &fileName, int capacity ) :
+    d( new PositionLogPrivate( fileName, capacity ) )
+{
+    d->open();
+}
+
+PositionLog::~PositionLog()
+{
+    flush();
+    delete d;
+}
+
+QString PositionLog::fileName() const
+{
+    return d->m_fileName;
+}
+
+int PositionLog::capacity() const
+{
+    return d->m_capacity;
+}
+
+int PositionLog::size() const
+{
+    return qMin( d->m_capacity, d->m_count + d->m_pending.size() );
+}
+
+void PositionLog::append( const Fix &fix )
+{
+    d->m_pending.append( fix );
+    if ( d->m_pending.size() >= qMin( batchSize, d->m_capacity ) ) {
+        flush();
+    }
+}
+
+bool PositionLog::flush()
+{
+    if ( d->m_pending.isEmpty() ) {
+        return true;
+    }
+
+    if ( !d->m_file.isOpen() ) {
+        d->m_pending.clear();
+        return false;
+    }
+
+    // The pending fixes fill at most two contiguous runs of records: up to
+    // the end of the file and, after wrapping around, from its start
+    int index = 0;
+    while ( index < d->m_pending.size() ) {
+        const int run = qMin( d->m_pending.size() - index, d->m_capacity - d->m_next );
+
+        QByteArray buffer;
+        buffer.reserve( run * recordSize );
+        QDataStream stream( &buffer, QIODevice::WriteOnly );
+        stream.setFloatingPointPrecision( QDataStream::DoublePrecision );
+        for ( int i = index; i < index + run; ++i ) {
+            PositionLogPrivate::writeFix( stream, d->m_pending.at( i ) );
+        }
+
+        if ( !d->m_file.seek( headerSize + qint64( d->m_next ) * recordSize )
+             || d->m_file.write( buffer ) != buffer.size() ) {
+            mDebug() << "Cannot write position log" << d->m_fileName << ":" << d->m_file.errorString();
+            d->m_pending.clear();
+            return false;
+        }
+
+        index += run;
+        d->m_next = ( d->m_next + run ) % d->m_capacity;
+        d->m_count = qMin( d->m_capacity, d->m_count + run );
+    }
+    d->m_pending.clear();
+
+    // the header is updated once the records it refers to are on the disk,
+    // so a crash leaves a consistent log behind
+    if ( !d->sync() ) {
+        mDebug() << "Cannot write position log" << d->m_fileName << ":" << d->m_file.errorString();
+        return false;
+    }
+    d->writeHeader();
+    return d->sync();
+}
+
+QList<PositionLog::Fix> PositionLog::fixes() const
+{
+    QList<Fix> result;
+
+    if ( d->m_file.isOpen() && d->m_count > 0 ) {
+        // the oldest record follows the one written last once the log is full
+        const int first = d->m_count < d->m_capacity ? 0 : d->m_next;
+
+        d->m_file.seek( headerSize + qint64( first ) * recordSize );
+        QByteArray data = d->m_file.read( qint64( d->m_capacity - first ) * recordSize );
+        if ( first > 0 ) {
+            d->m_file.seek( headerSize );
+            data += d->m_file.read( qint64( first ) * recordSize );
+        }
+
+        QDataStream stream( data );
+        stream.setFloatingPointPrecision( QDataStream::DoublePrecision );
+        for ( int i = 0; i < d->m_count; ++i ) {
+            result << PositionLogPrivate::readFix( stream );
+        }
+    }
+
+    foreach ( const Fix &fix, d->m_pending ) {
+        result << fix;
+    }
+    while ( result.size() > d->m_capacity ) {
+        result.removeFirst();
+    }
+
+    return result;
+}
+
+void PositionLog::clear()
+{
+    d->m_pending.clear();
+    d->m_count = 0;
+    d->m_next = 0;
+    if ( d->m_file.isOpen() ) {
+        d->m_file.resize( 0 );
+        d->writeHeader();
+        d->m_file.flush();
+    }
+}
+
+}
@@ -0,0 +1,94 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef MARBLE_POSITIONLOG_H
+#define MARBLE_POSITIONLOG_H
+
+#include "marble_export.h"
+#include "GeoDataAccuracy.h"
+#include "GeoDataCoordinates.h"
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+namespace Marble
+{
+
+class PositionLogPrivate;
+
+/**
+ * @brief A file of fixed size keeping the most recent position fixes
+ *
+ * Every fix is stored in full resolution in a record of fixed size. Once the
+ * capacity is reached, the oldest records are overwritten, so a long tracking
+ * session needs constant disk space. Fixes are buffered and written in batches.
+ */
+class MARBLE_EXPORT PositionLog
+{
+ public:
+    struct Fix
+    {
+        QDateTime timestamp;
+        GeoDataCoordinates position;
+        GeoDataAccuracy accuracy;
+        qreal speed;
+        qreal direction;
+    };
+
+    /**
+     * @brief Opens the log stored in @p fileName
+     * @param capacity the maximum number of fixes kept. An existing log with
+     * a different capacity is discarded.
+     */
+    explicit PositionLog( const QString &fileName, int capacity = 432000 );
+
+    /** Writes pending fixes and closes the log */
+    ~PositionLog();
+
+    QString fileName() const;
+
+    int capacity() const;
+
+    /**
+     * @brief Returns the number of fixes in the log, including the pending ones
+     */
+    int size() const;
+
+    /**
+     * @brief Appends @p fix, replacing the oldest one if the log is full
+     */
+    void append( const Fix &fix );
+
+    /**
+     * @brief Writes the pending fixes to disk
+     * @return false if writing failed
+     */
+    bool flush();
+
+    /**
+     * @brief Returns all fixes in the log, the oldest first
+     */
+    QList<Fix> fixes() const;
+
+    /**
+     * @brief Removes all fixes
+     */
+    void clear();
+
+ private:
+    Q_DISABLE_COPY( PositionLog )
+
+    PositionLogPrivate * const d;
+};
+
+}
+
+#endif
@@ -21,19 +21,25 @@
 #include "GeoDataTrack.h"
 #include "GeoDataTreeModel.h"
 #include "GeoDataTypes.h"
-#include "GeoWriter.h"
-#include "KmlElementDictionary.h"
+#include "KmlStreamWriter.h"
 #include "FileManager.h"
 #include "MarbleMath.h"
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
+#include "PositionLog.h"
 #include "PositionProviderPlugin.h"
 
 #include <QFile>
+#include <QVector>
 
 namespace Marble
 {
 
+// Fixes closer than this to the line between two track points are not shown, in meters
+static const qreal trackTolerance = 2.0;
+// Maximum number of fixes replaced by a single line
+static const int maximumSkippedFixes = 300;
+
 class PositionTrackingPrivate
 {
  public:
@@ -45,14 +51,36 @@ class PositionTrackingPrivate
         m_trackSegments( new GeoDataMultiTrack ),
         m_document(),
         m_positionProvider( 0 ),
+        m_log( 0 ),
         m_length( 0.0 )
     {
     }
 
+    ~PositionTrackingPrivate()
+    {
+        delete m_log;
+    }
+
     void updatePosition();
 
     void updateStatus();
 
+    /**
+     * Adds @p position to the current track. Fixes which do not deviate from a
+     * straight line are replaced by the next one, so the track only grows
+     * where the direction changes.
+     */
+    void addTrackPoint( const QDateTime &timestamp, const GeoDataCoordinates &position );
+
+    /**
+     * Returns the distance of @p point to the line from @p start to @p end
+     * in radians. Fine for the short distances between fixes.
+     */
+    static qreal distanceToLine( const GeoDataCoordinates &point,
+                                 const GeoDataCoordinates &start, const GeoDataCoordinates &end );
+
+    QString trackingFile( const QString &name );
+
     QString statusFile();
 
     PositionTracking *const q;
@@ -69,6 +97,15 @@ class PositionTrackingPrivate
 
     PositionProviderPlugin* m_positionProvider;
 
+    // Every fix in full resolution
+    PositionLog *m_log;
+
+    // The last point of the current track which will not be replaced
+    GeoDataCoordinates m_anchor;
+    // The fixes following m_anchor, the last one is the provisional end of the track
+    QVector<GeoDataCoordinates> m_skippedFixes;
+    GeoDataCoordinates m_lastFix;
+
     qreal m_length;
 };
 
@@ -82,10 +119,22 @@ void PositionTrackingPrivate::updatePosition()
 
     if ( m_positionProvider->status() == PositionProviderStatusAvailable ) {
         if ( accuracy.horizontal < 250 ) {
-            if ( m_currentTrack->size() ) {
-                m_length += distanceSphere( m_currentTrack->coordinatesAt( m_currentTrack->size() - 1 ), position );
+            if ( m_lastFix.isValid() ) {
+                m_length += distanceSphere( m_lastFix, position );
             }
-            m_currentTrack->addPoint( timestamp, position );
+            m_lastFix = position;
+            addTrackPoint( timestamp, position );
+
+            if ( !m_log ) {
+                m_log = new PositionLog( trackingFile( "positions.log" ) );
+            }
+            PositionLog::Fix fix;
+            fix.timestamp = timestamp;
+            fix.position = position;
+            fix.accuracy = accuracy;
+            fix.speed = m_positionProvider->speed();
+            fix.direction = m_positionProvider->direction();
+            m_log->append( fix );
         }
 
         //if the position has moved then update the current position
@@ -106,6 +155,9 @@ void PositionTrackingPrivate::updateStatus()
     const PositionProviderStatus status = m_positionProvider->status();
 
     if (status == PositionProviderStatusAvailable) {
+        // a new segment starts, the gap to the previous one is not travelled
+        m_skippedFixes.clear();
+        m_lastFix = GeoDataCoordinates();
         m_currentTrack = new GeoDataTrack;
         m_treeModel->removeFeature( m_currentTrackPlacemark );
         m_trackSegments->append( m_currentTrack );
@@ -115,7 +167,58 @@ void PositionTrackingPrivate::updateStatus()
     emit q->statusChanged( status );
 }
 
-QString PositionTrackingPrivate::statusFile()
+void PositionTrackingPrivate::addTrackPoint( const QDateTime &timestamp, const GeoDataCoordinates &position )
+{
+    if ( m_skippedFixes.isEmpty() ) {
+        if ( m_currentTrack->size() == 0 ) {
+            m_currentTrack->addPoint( timestamp, position );
+            m_anchor = position;
+            return;
+        }
+        m_anchor = m_currentTrack->coordinatesAt( m_currentTrack->size() - 1 );
+    } else {
+        bool straight = m_skippedFixes.size() < maximumSkippedFixes;
+        const qreal tolerance = trackTolerance / EARTH_RADIUS;
+        for ( int i = 0; straight && i < m_skippedFixes.size(); ++i ) {
+            straight = distanceToLine( m_skippedFixes.at( i ), m_anchor, position ) <= tolerance;
+        }
+
+        if ( straight ) {
+            // the provisional end of the track moves on
+            m_currentTrack->removeLast();
+        } else {
+            // the direction changed, keep the last fix
+            m_anchor = m_skippedFixes.last();
+            m_skippedFixes.clear();
+        }
+    }
+
+    m_currentTrack->addPoint( timestamp, position );
+    m_skippedFixes.append( position );
+}
+
+qreal PositionTrackingPrivate::distanceToLine( const GeoDataCoordinates &point,
+                                               const GeoDataCoordinates &start, const GeoDataCoordinates &end )
+{
+    // equirectangular projection around the start of the line
+    const qreal cosLat = cos( start.latitude() );
+    const qreal endX = GeoDataCoordinates::normalizeLon( end.longitude() - start.longitude() ) * cosLat;
+    const qreal endY = end.latitude() - start.latitude();
+    const qreal pointX = GeoDataCoordinates::normalizeLon( point.longitude() - start.longitude() ) * cosLat;
+    const qreal pointY = point.latitude() - start.latitude();
+
+    const qreal lengthSquared = endX * endX + endY * endY;
+    qreal t = 0.0;
+    if ( lengthSquared > 0.0 ) {
+        t = qBound<qreal>( 0.0, ( pointX * endX + pointY * endY ) / lengthSquared, 1.0 );
+    }
+
+    const qreal dx = pointX - t * endX;
+    const qreal dy = pointY - t * endY;
+    return sqrt( dx * dx + dy * dy );
+}
+
+QString PositionTrackingPrivate::trackingFile( const QString &name )
 {
     QString const subdir = "tracking";
     QDir dir( MarbleDirs::localPath() );
@@ -130,7 +233,12 @@ QString PositionTrackingPrivate::statusFile()
         mDebug() << "Cannot change into " << dir.absoluteFilePath( subdir );
     }
 
-    return dir.absoluteFilePath( "track.kml" );
+    return dir.absoluteFilePath( name );
+}
+
+QString PositionTrackingPrivate::statusFile()
+{
+    return trackingFile( "track.kml" );
 }
 
 PositionTracking::PositionTracking( GeoDataTreeModel *model )
@@ -258,29 +366,42 @@ bool PositionTracking::saveTrack( const QString& fileName )
         return false;
     }
 
-    GeoWriter writer;
-    //FIXME: a better way to do this?
-    writer.setDocumentType( kml::kmlTag_nameSpace22 );
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        mDebug() << "Cannot save the track to" << fileName << ":" << file.errorString();
+        return false;
+    }
 
-    GeoDataDocument *document = new GeoDataDocument;
+    // Stream the track instead of copying it into a temporary document,
+    // it may consist of hundreds of thousands of points
     QFileInfo fileInfo( fileName );
     QString name = fileInfo.baseName();
-    document->setName( name );
+    KmlStreamWriter writer;
+    if ( fileInfo.suffix().toLower() == "kmz" ) {
+        writer.setCompression( KmlStreamWriter::Kmz );
+    }
+    if ( !writer.open( &file, name ) ) {
+        mDebug() << "Cannot save the track to" << fileName << ":" << writer.errorString();
+        return false;
+    }
+
     foreach( const GeoDataStyle &style, d->m_document.styles() ) {
-        document->addStyle( style );
+        writer.write( &style );
     }
     foreach( const GeoDataStyleMap &map, d->m_document.styleMaps() ) {
-        document->addStyleMap( map );
+        writer.write( &map );
     }
-    GeoDataPlacemark *track = new GeoDataPlacemark( *d->m_currentTrackPlacemark );
-    track->setName( "Track " + name );
-    document->append( track );
 
-    QFile file( fileName );
-    file.open( QIODevice::WriteOnly );
-    bool const result = writer.write( &file, document );
+    // The copy shares the track points with the live placemark
+    GeoDataPlacemark track( *d->m_currentTrackPlacemark );
+    track.setName( "Track " + name );
+    writer.write( &track );
+
+    bool const result = writer.close();
+    if ( !result ) {
+        mDebug() << "Cannot save the track to" << fileName << ":" << writer.errorString();
+    }
     file.close();
-    delete document;
     return result;
 }
 
@@ -291,6 +412,8 @@ void PositionTracking::clearTrack()
     d->m_trackSegments->clear();
     d->m_trackSegments->append( d->m_currentTrack );
     d->m_treeModel->addFeature( &d->m_document, d->m_currentTrackPlacemark );
+    d->m_skippedFixes.clear();
+    d->m_lastFix = GeoDataCoordinates();
     d->m_length = 0.0;
 }
 
@@ -354,12 +477,17 @@ void PositionTracking::readSettings()
     d->m_currentTrackPlacemark->setStyleUrl( d->m_currentTrackPlacemark->styleUrl() );
 
     d->m_treeModel->addDocument( &d->m_document );
+    d->m_skippedFixes.clear();
+    d->m_lastFix = GeoDataCoordinates();
     d->m_length = 0.0;
 }
 
 void PositionTracking::writeSettings()
 {
     saveTrack( d->statusFile() );
+    if ( d->m_log ) {
+        d->m_log->flush();
+    }
 }
 
 bool PositionTracking::isTrackEmpty() const
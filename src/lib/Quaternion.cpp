@@ -184,7 +184,8 @@ Quaternion Quaternion::slerp(const Quaternion &q1, const Quaternion &q2, qreal t
                          + q1.v[Q_Y] * q2.v[Q_Y]
                          + q1.v[Q_Z] * q2.v[Q_Z]
                          + q1.v[Q_W] * q2.v[Q_W] );
-    qreal  alpha    = acos( cosAlpha );
+    // Rounding may push the cosine of (almost) equal quaternions beyond 1
+    qreal  alpha    = acos( qBound( qreal( -1.0 ), cosAlpha, qreal( 1.0 ) ) );
     qreal  sinAlpha = sin( alpha );
 
     if ( sinAlpha > 0.0 ) {
@@ -257,3 +258,53 @@ void Quaternion::rotateAroundAxis(const matrix &m)
     v[Q_Y] = y;
     v[Q_Z] = z;
 }
+
+void Quaternion::fromSpherical(const qreal *lon, const qreal *lat,
+                               qreal *x, qreal *y, qreal *z, int count,
+                               MathPrecision precision)
+{
+    for ( int i = 0; i < count; ++i ) {
+        qreal sinLon, cosLon, sinLat, cosLat;
+        fastSinCos( lon[i], sinLon, cosLon, precision );
+        fastSinCos( lat[i], sinLat, cosLat, precision );
+
+        x[i] = cosLat * sinLon;
+        y[i] = sinLat;
+        z[i] = cosLat * cosLon;
+    }
+}
+
+void Quaternion::rotateAroundAxis(const matrix &m,
+                                  const qreal *x, const qreal *y, const qreal *z,
+                                  qreal *rx, qreal *ry, qreal *rz, int count)
+{
+    const qreal m00 = m[0][0], m01 = m[0][1], m02 = m[0][2];
+    const qreal m10 = m[1][0], m11 = m[1][1], m12 = m[1][2];
+    const qreal m20 = m[2][0], m21 = m[2][1], m22 = m[2][2];
+
+    for ( int i = 0; i < count; ++i ) {
+        const qreal vx = x[i];
+        const qreal vy = y[i];
+        const qreal vz = z[i];
+
+        rx[i] = m00 * vx + m10 * vy + m20 * vz;
+        ry[i] = m01 * vx + m11 * vy + m21 * vz;
+        rz[i] = m02 * vx + m12 * vy + m22 * vz;
+    }
+}
+
+void Quaternion::getSpherical(const qreal *x, const qreal *y, const qreal *z,
+                              qreal *lon, qreal *lat, int count,
+                              MathPrecision precision)
+{
+    for ( int i = 0; i < count; ++i ) {
+        const qreal xz2 = x[i] * x[i] + z[i] * z[i];
+
+        // same threshold as getSpherical(), relative to the length of the vector
+        lat[i] = fastAtan2( y[i], sqrt( xz2 ), precision );
+        if ( xz2 > 0.00005 * ( xz2 + y[i] * y[i] ) )
+            lon[i] = fastAtan2( x[i], z[i], precision );
+        else
+            lon[i] = 0.0;
+    }
+}
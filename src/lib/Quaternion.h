@@ -19,6 +19,7 @@
 #define MARBLE_QUATERNION_H
 
 #include "marble_export.h"
+#include "FastMath.h"
 #include <cmath>
 
 namespace Marble
@@ -82,6 +83,35 @@ class MARBLE_EXPORT Quaternion
     void        toMatrix(matrix &m) const;
     void        rotateAroundAxis(const matrix &m);
 
+    /**
+     * @brief Batched fromSpherical() for @p count points
+     *
+     * Writes the unit vectors of the points given by the arrays @p lon and @p lat
+     * (in radians) into the arrays @p x, @p y and @p z.
+     */
+    static void fromSpherical(const qreal *lon, const qreal *lat,
+                              qreal *x, qreal *y, qreal *z, int count,
+                              MathPrecision precision = ExactPrecision);
+
+    /**
+     * @brief Batched rotateAroundAxis(const matrix &) for @p count vectors
+     *
+     * Rotates the vectors given by the arrays @p x, @p y and @p z and writes the
+     * result into @p rx, @p ry and @p rz. The input may be rotated in place.
+     */
+    static void rotateAroundAxis(const matrix &m,
+                                 const qreal *x, const qreal *y, const qreal *z,
+                                 qreal *rx, qreal *ry, qreal *rz, int count);
+
+    /**
+     * @brief Batched getSpherical() for @p count vectors
+     *
+     * Unlike getSpherical() the vectors don't need to be normalized.
+     */
+    static void getSpherical(const qreal *x, const qreal *y, const qreal *z,
+                             qreal *lon, qreal *lat, int count,
+                             MathPrecision precision = ExactPrecision);
+
     // TODO: Better add accessors...
     xmmfloat    v;
 };
@@ -20,6 +20,7 @@
 #include "ReverseGeocodingRunnerManager.h"
 #include "RoutingRunner.h"
 #include "RoutingRunnerManager.h"
+#include "TraceRecorder.h"
 #include "routing/RouteRequest.h"
 
 #include <QTimer>
@@ -94,6 +95,7 @@ ParsingTask::ParsingTask( ParsingRunner *runner, ParsingRunnerManager *manager,
 
 void ParsingTask::run()
 {
+    TraceZone zone( "ParsingTask::run" );
     m_runner->parseFile( m_fileName, m_role );
     m_runner->deleteLater();
 
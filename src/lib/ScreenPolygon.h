@@ -13,6 +13,7 @@
 #define MARBLE_SCREENPOLYGON_H
 
 
+#include <QtAlgorithms>
 #include <QVector>
 #include <QPolygonF>
 
@@ -37,6 +38,58 @@ class ScreenPolygon : public QPolygonF
     bool  m_closed;
 };
 
+/**
+ * A list of screen polygons which keeps its polygons and their memory when
+ * it is cleared, so that creating the polygons of each frame does not
+ * allocate memory again. Not thread-safe, use one pool per thread.
+ */
+class ScreenPolygonPool
+{
+ public:
+    ScreenPolygonPool() { }
+    ~ScreenPolygonPool()
+    {
+        qDeleteAll( m_polygons );
+        qDeleteAll( m_unused );
+    }
+
+    /**
+     * Returns an empty polygon which is owned by the pool. Pass it to either
+     * append() or release() when done with it.
+     */
+    ScreenPolygon *create( bool closed )
+    {
+        ScreenPolygon *polygon = m_unused.isEmpty() ? new ScreenPolygon : m_unused.last();
+        if ( !m_unused.isEmpty() ) {
+            m_unused.resize( m_unused.size() - 1 );
+        }
+        polygon->resize( 0 );
+        polygon->setClosed( closed );
+        return polygon;
+    }
+
+    /** Appends a polygon returned by create() to polygons() */
+    void append( ScreenPolygon *polygon ) { m_polygons.append( polygon ); }
+
+    /** Keeps a polygon returned by create() for reuse */
+    void release( ScreenPolygon *polygon ) { m_unused.append( polygon ); }
+
+    const QVector<ScreenPolygon*> &polygons() const { return m_polygons; }
+
+    /** Empties polygons(), keeping the polygons for reuse */
+    void clear()
+    {
+        m_unused += m_polygons;
+        m_polygons.resize( 0 );
+    }
+
+ private:
+    Q_DISABLE_COPY( ScreenPolygonPool )
+
+    QVector<ScreenPolygon*> m_polygons;
+    QVector<ScreenPolygon*> m_unused;
+};
+
 }
 
 #endif
@@ -30,12 +30,14 @@
 #include "StackedTile.h"
 #include "TileLoader.h"
 #include "TileLoaderHelper.h"
+#include "TraceRecorder.h"
 #include "MarbleGlobal.h"
 
 #include <QCache>
 #include <QHash>
 #include <QReadWriteLock>
 #include <QImage>
+#include <QSet>
 
 
 namespace Marble
@@ -45,7 +47,11 @@ class StackedTileLoaderPrivate
 {
 public:
     StackedTileLoaderPrivate( MergedLayerDecorator *mergedLayerDecorator )
-        : m_layerDecorator( mergedLayerDecorator )
+        : m_layerDecorator( mergedLayerDecorator ),
+          m_prefetchedBytes( 0 ),
+          m_prefetchedTileCount( 0 ),
+          m_prefetchHits( 0 ),
+          m_prefetchMisses( 0 )
     {
         m_tileCache.setMaxCost( 20000 * 1024 ); // Cache size measured in bytes
     }
@@ -54,8 +60,32 @@ public:
     QHash <TileId, StackedTile*>  m_tilesOnDisplay;
     QCache <TileId, StackedTile>  m_tileCache;
     QReadWriteLock m_cacheLock;
+
+    void removeEvictedPrefetches();
+
+    // prefetched tiles which were not used yet and the bytes they use
+    QHash<TileId, int> m_prefetchedTiles;
+    qint64 m_prefetchedBytes;
+    // tiles queued for prefetching which were not loaded yet
+    QSet<TileId> m_requestedTiles;
+    int m_prefetchedTileCount;
+    int m_prefetchHits;
+    int m_prefetchMisses;
 };
 
+void StackedTileLoaderPrivate::removeEvictedPrefetches()
+{
+    QHash<TileId, int>::iterator it = m_prefetchedTiles.begin();
+    while ( it != m_prefetchedTiles.end() ) {
+        if ( m_tileCache.contains( it.key() ) ) {
+            ++it;
+        } else {
+            m_prefetchedBytes -= it.value();
+            it = m_prefetchedTiles.erase( it );
+        }
+    }
+}
+
 StackedTileLoader::StackedTileLoader( MergedLayerDecorator *mergedLayerDecorator, QObject *parent )
     : QObject( parent ),
       d( new StackedTileLoaderPrivate( mergedLayerDecorator ) )
@@ -114,6 +144,8 @@ void StackedTileLoader::cleanupTilehash()
             d->m_tilesOnDisplay.remove( it.key() );
         }
     }
+
+    d->removeEvictedPrefetches();
 }
 
 const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
@@ -142,6 +174,11 @@ const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
     stackedTile = d->m_tileCache.take( stackedTileId );
     if ( stackedTile ) {
         Q_ASSERT( !stackedTile->used() && "tiles in m_tileCache are invisible and should thus be marked as unused" );
+        if ( d->m_prefetchedTiles.contains( stackedTileId ) ) {
+            d->m_prefetchedBytes -= d->m_prefetchedTiles.take( stackedTileId );
+            ++d->m_prefetchHits;
+        }
+        d->m_requestedTiles.remove( stackedTileId );
         stackedTile->setUsed( true );
         d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
         d->m_cacheLock.unlock();
@@ -153,10 +190,20 @@ const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
 
     mDebug() << "load tile from disk:" << stackedTileId;
 
+    TraceZone zone( "StackedTileLoader::loadTile" );
     stackedTile = d->m_layerDecorator->loadTile( stackedTileId );
     Q_ASSERT( stackedTile );
     stackedTile->setUsed( true );
 
+    // a miss is a tile queued for prefetching which was not loaded in time
+    // or which was evicted from the cache before it was used
+    if ( d->m_requestedTiles.remove( stackedTileId ) ) {
+        ++d->m_prefetchMisses;
+    } else if ( d->m_prefetchedTiles.contains( stackedTileId ) ) {
+        d->m_prefetchedBytes -= d->m_prefetchedTiles.take( stackedTileId );
+        ++d->m_prefetchMisses;
+    }
+
     d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
     d->m_cacheLock.unlock();
 
@@ -183,11 +230,14 @@ int StackedTileLoader::tileCount() const
 void StackedTileLoader::setVolatileCacheLimit( quint64 kiloBytes )
 {
     mDebug() << QString("Setting tile cache to %1 kilobytes.").arg( kiloBytes );
+    QWriteLocker locker( &d->m_cacheLock );
     d->m_tileCache.setMaxCost( kiloBytes * 1024 );
+    d->removeEvictedPrefetches();
 }
 
 void StackedTileLoader::updateTile( TileId const &tileId, QImage const &tileImage )
 {
+    TraceZone zone( "StackedTileLoader::updateTile" );
     const TileId stackedTileId( 0, tileId.zoomLevel(), tileId.x(), tileId.y() );
 
     StackedTile * displayedTile = d->m_tilesOnDisplay.take( stackedTileId );
@@ -204,7 +254,81 @@ void StackedTileLoader::updateTile( TileId const &tileId, QImage const &tileImag
         emit tileLoaded( stackedTileId );
     } else {
         d->m_tileCache.remove( stackedTileId );
+        d->removeEvictedPrefetches();
+    }
+}
+
+bool StackedTileLoader::hasTile( TileId const &stackedTileId ) const
+{
+    QReadLocker locker( &d->m_cacheLock );
+    return d->m_tilesOnDisplay.contains( stackedTileId ) || d->m_tileCache.contains( stackedTileId );
+}
+
+int StackedTileLoader::prefetchTile( TileId const &stackedTileId )
+{
+    QWriteLocker locker( &d->m_cacheLock );
+
+    d->m_requestedTiles.remove( stackedTileId );
+    if ( d->m_tilesOnDisplay.contains( stackedTileId ) || d->m_tileCache.contains( stackedTileId ) ) {
+        return 0;
+    }
+
+    StackedTile *const stackedTile = d->m_layerDecorator->loadTile( stackedTileId );
+    Q_ASSERT( stackedTile );
+    const int byteCount = stackedTile->byteCount();
+
+    // As in cleanupTilehash(), the tile is deleted if it does not fit into the cache
+    if ( d->m_tileCache.insert( stackedTileId, stackedTile, byteCount ) ) {
+        d->m_prefetchedTiles.insert( stackedTileId, byteCount );
+        d->m_prefetchedBytes += byteCount;
+        ++d->m_prefetchedTileCount;
     }
+    d->removeEvictedPrefetches();
+
+    return byteCount;
+}
+
+void StackedTileLoader::requestPrefetch( TileId const &stackedTileId )
+{
+    QWriteLocker locker( &d->m_cacheLock );
+
+    if ( !d->m_tilesOnDisplay.contains( stackedTileId ) && !d->m_tileCache.contains( stackedTileId ) ) {
+        d->m_requestedTiles.insert( stackedTileId );
+    }
+}
+
+void StackedTileLoader::cancelPrefetchRequests()
+{
+    QWriteLocker locker( &d->m_cacheLock );
+    d->m_requestedTiles.clear();
+}
+
+quint64 StackedTileLoader::prefetchedByteCount() const
+{
+    QReadLocker locker( &d->m_cacheLock );
+    return d->m_prefetchedBytes;
+}
+
+int StackedTileLoader::prefetchedTileCount() const
+{
+    return d->m_prefetchedTileCount;
+}
+
+int StackedTileLoader::prefetchHits() const
+{
+    return d->m_prefetchHits;
+}
+
+int StackedTileLoader::prefetchMisses() const
+{
+    return d->m_prefetchMisses;
+}
+
+void StackedTileLoader::resetPrefetchStatistics()
+{
+    d->m_prefetchedTileCount = 0;
+    d->m_prefetchHits = 0;
+    d->m_prefetchMisses = 0;
 }
 
 void StackedTileLoader::clear()
@@ -214,6 +338,9 @@ void StackedTileLoader::clear()
     qDeleteAll( d->m_tilesOnDisplay );
     d->m_tilesOnDisplay.clear();
     d->m_tileCache.clear(); // clear the tile cache in physical memory
+    d->m_prefetchedTiles.clear();
+    d->m_prefetchedBytes = 0;
+    d->m_requestedTiles.clear();
 
     emit cleared();
 }
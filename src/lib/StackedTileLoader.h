@@ -131,6 +131,58 @@ class StackedTileLoader : public QObject
          */
         void updateTile(TileId const & tileId, QImage const &tileImage );
 
+        /**
+         * Returns true if the tile is in use or in the tile cache.
+         */
+        bool hasTile( TileId const &stackedTileId ) const;
+
+        /**
+         * Loads a tile ahead of time into the tile cache without using it.
+         * Returns the number of bytes used by the tile, or 0 if the tile
+         * was in memory already.
+         */
+        int prefetchTile( TileId const &stackedTileId );
+
+        /**
+         * Marks a tile as queued for prefetching. If it has to be loaded
+         * before prefetchTile() loaded it, it counts as a prefetch miss.
+         */
+        void requestPrefetch( TileId const &stackedTileId );
+
+        /**
+         * Forgets the tiles marked by requestPrefetch() which were not loaded yet.
+         */
+        void cancelPrefetchRequests();
+
+        /**
+         * Returns the number of bytes used by prefetched tiles which are
+         * still in the tile cache and were not used yet.
+         */
+        quint64 prefetchedByteCount() const;
+
+        /**
+         * @brief Number of tiles that were loaded by prefetchTile()
+         */
+        int prefetchedTileCount() const;
+
+        /**
+         * @brief Number of tiles used after being loaded by prefetchTile()
+         */
+        int prefetchHits() const;
+
+        /**
+         * @brief Number of tiles queued for prefetching that had to be loaded
+         * when they were used
+         *
+         * This includes prefetched tiles which were evicted from the tile
+         * cache before they were used.
+         * Together with prefetchHits() this gives the share of used tiles
+         * which were loaded ahead of time.
+         */
+        int prefetchMisses() const;
+
+        void resetPrefetchStatistics();
+
     Q_SIGNALS:
         void tileLoaded( TileId const &tileId );
         void cleared();
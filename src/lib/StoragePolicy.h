@@ -46,6 +46,11 @@ class StoragePolicy : public QObject
 	void cleared();
 	void sizeChanged( qint64 );
 	
+	/**
+	 * Is emitted after the file @p fileName was written with @p size bytes.
+	 */
+	void fileUpdated( const QString &fileName, qint64 size );
+	
     private:
 	Q_DISABLE_COPY( StoragePolicy )
 };
@@ -13,6 +13,8 @@
 
 #include "TextureColorizer.h"
 
+#include <cstring>
+
 #include <qmath.h>
 #include <QFile>
 #include <QSharedPointer>
@@ -22,6 +24,8 @@
 #include <QColor>
 #include <QImage>
 #include <QPainter>
+#include <QRegion>
+#include <QVarLengthArray>
 
 #include "MarbleGlobal.h"
 #include "GeoPainter.h"
@@ -48,8 +52,25 @@ public:
         , x4( 0 )
     {}
 
+    explicit EmbossFifo( const uchar *values )
+        : x1( values[0] )
+        , x2( values[1] )
+        , x3( values[2] )
+        , x4( values[3] )
+    {}
+
     inline uchar head() const { return x1; }
 
+    inline uchar at( int index ) const
+    {
+        switch ( index ) {
+        case 0: return x1;
+        case 1: return x2;
+        case 2: return x3;
+        default: return x4;
+        }
+    }
+
     inline EmbossFifo &operator<<( uchar value )
     {
         x1 = x2;
@@ -72,6 +93,14 @@ TextureColorizer::TextureColorizer( const QString &seafile,
                                     const QString &landfile,
                                     VectorComposer *veccomposer )
     : m_veccomposer( veccomposer ),
+      m_coastImageValid( false ),
+      m_coastProjection( Spherical ),
+      m_coastRadius( 0 ),
+      m_coastCenterLon( 0.0 ),
+      m_coastCenterLat( 0.0 ),
+      m_coastAntialiased( false ),
+      m_coastRevision( 0 ),
+      m_showRelief( false ),
       m_landColor(qRgb( 255, 0, 0 ) ),
       m_seaColor( qRgb( 0, 255, 0 ) )
 {
@@ -152,11 +181,13 @@ TextureColorizer::TextureColorizer( const QString &seafile,
 void TextureColorizer::addSeaDocument( const GeoDataDocument *seaDocument )
 {
     m_seaDocuments.append( seaDocument );
+    m_coastImageValid = false;
 }
 
 void TextureColorizer::addLandDocument( const GeoDataDocument *landDocument )
 {
     m_landDocuments.append( landDocument );
+    m_coastImageValid = false;
 }
 
 void TextureColorizer::setShowRelief( bool show )
@@ -227,18 +258,127 @@ void TextureColorizer::drawTextureMap( GeoPainter *painter )
     }
 }
 
-void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport, MapQuality mapQuality )
+QList<bool> TextureColorizer::seaDocumentVisibility() const
 {
-    if ( m_coastImage.size() != viewport->size() )
-        m_coastImage = QImage( viewport->size(), QImage::Format_RGB32 );
+    QList<bool> result;
+    foreach( const GeoDataDocument *doc, m_seaDocuments ) {
+        result << doc->isVisible();
+    }
 
-    // update coast image
-    m_coastImage.fill( QColor( 0, 0, 255, 0).rgb() );
+    return result;
+}
 
+void TextureColorizer::updateCoastImage( const ViewportParams *viewport, MapQuality mapQuality )
+{
     const bool antialiased =    mapQuality == HighQuality
                              || mapQuality == PrintQuality;
+    const qint64 revision = m_landDocuments.isEmpty() ? m_veccomposer->textureMapRevision() : 0;
+    const QList<bool> visibility = seaDocumentVisibility();
+
+    const int width = viewport->width();
+    const int height = viewport->height();
+    QRegion dirtyRegion( 0, 0, width, height );
+
+    const bool sameContent =    m_coastImageValid
+                             && m_coastImage.size() == viewport->size()
+                             && m_coastProjection == viewport->projection()
+                             && m_coastRadius == viewport->radius()
+                             && m_coastAntialiased == antialiased
+                             && m_coastRevision == revision
+                             && m_coastVisibility == visibility;
+
+    if ( sameContent ) {
+        // Determine by how many pixels the map moved since the coast image was drawn
+        qreal dx = 0.0;
+        qreal dy = 0.0;
+        bool reusable = false;
+
+        if ( viewport->projection() == Equirectangular || viewport->projection() == Mercator ) {
+            const qreal rad2Pixel = (qreal)( 2 * viewport->radius() ) / M_PI;
+
+            qreal deltaLon = viewport->centerLongitude() - m_coastCenterLon;
+            if ( deltaLon > M_PI ) {
+                deltaLon -= 2 * M_PI;
+            } else if ( deltaLon < -M_PI ) {
+                deltaLon += 2 * M_PI;
+            }
+            dx = deltaLon * rad2Pixel;
+
+            if ( viewport->projection() == Equirectangular ) {
+                dy = ( viewport->centerLatitude() - m_coastCenterLat ) * rad2Pixel;
+            } else {
+                dy = ( asinh( tan( viewport->centerLatitude() ) ) - asinh( tan( m_coastCenterLat ) ) ) * rad2Pixel;
+            }
+
+            reusable = true;
+        }
+        else if (    viewport->centerLongitude() == m_coastCenterLon
+                  && viewport->centerLatitude() == m_coastCenterLat ) {
+            reusable = true;
+        }
+
+        const int shiftX = qRound( dx );
+        const int shiftY = qRound( dy );
+
+        // Only whole pixel shifts keep the mask identical to a redrawn one
+        if (    reusable
+             && qAbs( dx - shiftX ) < 0.01 && qAbs( dy - shiftY ) < 0.01
+             && qAbs( shiftX ) < width && qAbs( shiftY ) < height )
+        {
+            if ( shiftX == 0 && shiftY == 0 ) {
+                return;
+            }
+
+            // new( x, y ) = old( x + shiftX, y - shiftY )
+            const int xFrom = qMax( 0, shiftX );
+            const int xTo = qMax( 0, -shiftX );
+            const int length = ( width - qAbs( shiftX ) ) * sizeof( QRgb );
+            if ( shiftY > 0 ) {
+                for ( int y = height - 1; y >= shiftY; --y ) {
+                    memmove( m_coastImage.scanLine( y ) + xTo * sizeof( QRgb ),
+                             m_coastImage.scanLine( y - shiftY ) + xFrom * sizeof( QRgb ), length );
+                }
+            } else {
+                for ( int y = 0; y < height + shiftY; ++y ) {
+                    memmove( m_coastImage.scanLine( y ) + xTo * sizeof( QRgb ),
+                             m_coastImage.scanLine( y - shiftY ) + xFrom * sizeof( QRgb ), length );
+                }
+            }
+
+            dirtyRegion = QRegion();
+            if ( shiftX > 0 ) {
+                dirtyRegion += QRect( width - shiftX, 0, shiftX, height );
+            } else if ( shiftX < 0 ) {
+                dirtyRegion += QRect( 0, 0, -shiftX, height );
+            }
+            if ( shiftY > 0 ) {
+                dirtyRegion += QRect( 0, 0, width, shiftY );
+            } else if ( shiftY < 0 ) {
+                dirtyRegion += QRect( 0, height + shiftY, width, -shiftY );
+            }
+        }
+    }
+
+    if ( m_coastImage.size() != viewport->size() )
+        m_coastImage = QImage( viewport->size(), QImage::Format_RGB32 );
+
+    m_coastImageValid = true;
+    m_coastProjection = viewport->projection();
+    m_coastRadius = viewport->radius();
+    m_coastCenterLon = viewport->centerLongitude();
+    m_coastCenterLat = viewport->centerLatitude();
+    m_coastAntialiased = antialiased;
+    m_coastRevision = revision;
+    m_coastVisibility = visibility;
 
     GeoPainter painter( &m_coastImage, viewport, mapQuality );
+
+    // update the uncovered part of the coast image
+    foreach( const QRect &rect, dirtyRegion.rects() ) {
+        painter.fillRect( rect, QColor( 0, 0, 255 ) );
+    }
+
+    painter.setClipRegion( dirtyRegion );
     painter.setRenderHint( QPainter::Antialiasing, antialiased );
 
     if ( m_landDocuments.isEmpty() ) {
@@ -246,6 +386,11 @@ void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport
     } else {
         drawTextureMap( &painter );
     }
+}
+
+void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport, MapQuality mapQuality )
+{
+    updateCoastImage( viewport, mapQuality );
 
     const qint64   radius   = viewport->radius();
 
@@ -256,8 +401,6 @@ void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport
     // This variable is not used anywhere..
     const int  imgradius = imgrx * imgrx + imgry * imgry;
 
-    int     bump = 8;
-
     if ( radius * radius > imgradius
          || viewport->projection() == Equirectangular
          || viewport->projection() == Mercator )
@@ -287,31 +430,9 @@ void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport
         const int itEnd = yBottom;
 
         for (int y = yTop; y < itEnd; ++y) {
-
-            QRgb  *writeData         = (QRgb*)( origimg->scanLine( y ) );
-            const QRgb  *coastData   = (QRgb*)( m_coastImage.scanLine( y ) );
-
-            uchar *readDataStart     = origimg->scanLine( y );
-            const uchar *readDataEnd = readDataStart + imgwidth*4;
-
             EmbossFifo  emboss;
-
-            for ( uchar* readData = readDataStart; 
-                  readData < readDataEnd;
-                  readData += 4, ++writeData, ++coastData )
-            {
-
-                // Cheap Emboss / Bumpmapping
-                uchar&  grey = *readData; // qBlue(*data);
-
-                if ( m_showRelief ) {
-                    emboss << grey;
-                    bump = ( emboss.head() + 8 - grey );
-                    if ( bump  < 0 )  bump = 0;
-                    if ( bump  > 15 ) bump = 15;
-                }
-                setPixel( coastData, writeData, bump, grey );
-            }
+            colorizeLine( (QRgb*)( origimg->scanLine( y ) ), (const QRgb*)( m_coastImage.constScanLine( y ) ),
+                          0, imgwidth, emboss, 8, 0 );
         }
     }
     else {
@@ -331,54 +452,70 @@ void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport
                 xRight = imgrx + rx;
             }
 
-            QRgb  *writeData         = (QRgb*)( origimg->scanLine( y ) )  + xLeft;
-            const QRgb *coastData    = (QRgb*)( m_coastImage.scanLine( y ) ) + xLeft;
-
-            uchar *readDataStart     = origimg->scanLine( y ) + xLeft * 4;
-            const uchar *readDataEnd = origimg->scanLine( y ) + xRight * 4;
+            colorizeLine( (QRgb*)( origimg->scanLine( y ) ), (const QRgb*)( m_coastImage.constScanLine( y ) ),
+                          xLeft, xRight, emboss, 16, 1 );
+        }
+    }
+}
 
- 
-            for ( uchar* readData = readDataStart;
-                  readData < readDataEnd;
-                  readData += 4, ++writeData, ++coastData )
-            {
-                // Cheap Emboss / Bumpmapping
+void TextureColorizer::colorizeLine( QRgb *line, const QRgb *coastLine, int xLeft, int xRight,
+                                     EmbossFifo &emboss, int bumpOffset, int bumpShift ) const
+{
+    const int length = xRight - xLeft;
+    if ( length <= 0 ) {
+        return;
+    }
 
-                uchar& grey = *readData; // qBlue(*data);
+    // The grey values are read before any pixel is written, and the bump values
+    // of all pixels are calculated at once. Both loops have no dependencies
+    // between iterations, which allows the compiler to vectorize them.
+    QVarLengthArray<uchar, 4096> grey( length + 4 );
+    grey[0] = emboss.at( 0 );
+    grey[1] = emboss.at( 1 );
+    grey[2] = emboss.at( 2 );
+    grey[3] = emboss.at( 3 );
+
+    const QRgb *readData = line + xLeft;
+    uchar *greyData = grey.data() + 4;
+    for ( int i = 0; i < length; ++i ) {
+        greyData[i] = qBlue( readData[i] );
+    }
 
-                if ( m_showRelief ) {
-                    emboss << grey;
-                    bump = ( emboss.head() + 16 - grey ) >> 1;
-                    if ( bump > 15 ) bump = 15;
-                    if ( bump < 0 )  bump = 0;
-                }
-                setPixel( coastData, writeData, bump, grey );
-            }
+    QVarLengthArray<uchar, 4096> bump( length );
+    if ( m_showRelief ) {
+        uchar *bumpData = bump.data();
+        for ( int i = 0; i < length; ++i ) {
+            const int value = ( greyData[i - 3] + bumpOffset - greyData[i] ) >> bumpShift;
+            bumpData[i] = qBound( 0, value, 15 );
         }
+        emboss = EmbossFifo( greyData + length - 4 );
+    } else {
+        memset( bump.data(), 8, length );
+    }
+
+    QRgb *writeData = line + xLeft;
+    const QRgb *coastData = coastLine + xLeft;
+    for ( int i = 0; i < length; ++i ) {
+        setPixel( coastData + i, writeData + i, bump[i], greyData[i] );
     }
 }
 
-void TextureColorizer::setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey )
+void TextureColorizer::setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey ) const
 {
-    int alpha = qRed( *coastData );
+    const int alpha = qRed( *coastData );
     if ( alpha == 255 )
         *writeData = texturepalette[bump][grey + 0x100];
     else if( alpha == 0 ){
         *writeData = texturepalette[bump][grey];
     }
     else {
-        qreal c = 1.0 / 255.0;
-
-        QRgb landcolor  = (QRgb)(texturepalette[bump][grey + 0x100]);
-        QRgb watercolor = (QRgb)(texturepalette[bump][grey]);
+        const QRgb landcolor  = (QRgb)(texturepalette[bump][grey + 0x100]);
+        const QRgb watercolor = (QRgb)(texturepalette[bump][grey]);
 
         *writeData = qRgb(
-                    (int) ( c * ( alpha * qRed( landcolor )
-                                  + ( 255 - alpha ) * qRed( watercolor ) ) ),
-                    (int) ( c * ( alpha * qGreen( landcolor )
-                                  + ( 255 - alpha ) * qGreen( watercolor ) ) ),
-                    (int) ( c * ( alpha * qBlue( landcolor )
-                                  + ( 255 - alpha ) * qBlue( watercolor ) ) )
+                    ( alpha * qRed( landcolor ) + ( 255 - alpha ) * qRed( watercolor ) ) / 255,
+                    ( alpha * qGreen( landcolor ) + ( 255 - alpha ) * qGreen( watercolor ) ) / 255,
+                    ( alpha * qBlue( landcolor ) + ( 255 - alpha ) * qBlue( watercolor ) ) / 255
                     );
     }
 }
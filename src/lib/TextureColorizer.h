@@ -28,6 +28,7 @@
 namespace Marble
 {
 
+class EmbossFifo;
 class VectorComposer;
 class ViewportParams;
 
@@ -52,13 +53,42 @@ class TextureColorizer
 
     void colorize( QImage *origimg, const ViewportParams *viewport, MapQuality mapQuality );
 
-    void setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey );
+    void setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey ) const;
 
  private:
+    /**
+     * Brings the land/water mask in m_coastImage up to date with the viewport.
+     * The mask is kept as long as the viewport and the drawn data do not change.
+     * In the cylindrical projections panning just shifts the mask, so only the
+     * uncovered part of it needs to be drawn.
+     */
+    void updateCoastImage( const ViewportParams *viewport, MapQuality mapQuality );
+
+    /**
+     * Colorizes the pixels of one image line from @p xLeft to @p xRight.
+     * @p emboss holds the grey values left of @p xLeft and is advanced to the end of the line.
+     * The bump value of a pixel is ( head + @p bumpOffset - grey ) >> @p bumpShift.
+     */
+    void colorizeLine( QRgb *line, const QRgb *coastLine, int xLeft, int xRight,
+                       EmbossFifo &emboss, int bumpOffset, int bumpShift ) const;
+
+    QList<bool> seaDocumentVisibility() const;
+
     VectorComposer *const m_veccomposer;
     QList<const GeoDataDocument*> m_seaDocuments;
     QList<const GeoDataDocument*> m_landDocuments;
     QImage m_coastImage;
+
+    // the state the coast image was drawn for
+    bool       m_coastImageValid;
+    Projection m_coastProjection;
+    int        m_coastRadius;
+    qreal      m_coastCenterLon;
+    qreal      m_coastCenterLat;
+    bool       m_coastAntialiased;
+    qint64     m_coastRevision;
+    QList<bool> m_coastVisibility;
+
     uint texturepalette[16][512];
     bool m_showRelief;
     QRgb      m_landColor;
@@ -34,6 +34,7 @@
 #include "MarbleDirs.h"
 #include "ParsingRunnerManager.h"
 #include "TileLoaderHelper.h"
+#include "TraceRecorder.h"
 
 Q_DECLARE_METATYPE( Marble::DownloadUsage )
 
@@ -48,6 +49,8 @@ TileLoader::TileLoader(HttpDownloadManager * const downloadManager, const Plugin
              downloadManager, SLOT(addJob(QUrl,QString,QString,DownloadUsage)));
     connect( downloadManager, SIGNAL(downloadComplete(QByteArray,QString)),
              SLOT(updateTile(QByteArray,QString)));
+    connect( this, SIGNAL(tileAccessed(QString)),
+             downloadManager, SIGNAL(fileAccessed(QString)) );
 }
 
 // If the tile image file is locally available:
@@ -55,6 +58,7 @@ TileLoader::TileLoader(HttpDownloadManager * const downloadManager, const Plugin
 //     - if expired: create TextureTile, state is set to Expired by default, trigger dl,
 QImage TileLoader::loadTileImage( GeoSceneTextureTile const *textureLayer, TileId const & tileId, DownloadUsage const usage )
 {
+    TraceZone zone( "TileLoader::loadTileImage" );
     QString const fileName = tileFileName( textureLayer, tileId );
 
     TileStatus status = tileStatus( textureLayer, tileId );
@@ -71,6 +75,7 @@ QImage TileLoader::loadTileImage( GeoSceneTextureTile const *textureLayer, TileI
 
         QImage const image( fileName );
         if ( !image.isNull() ) {
+            emit tileAccessed( textureLayer->relativeTileFileName( tileId ) );
             // file is there, so create and return a tile object in any case
             return image;
         }
@@ -113,6 +118,7 @@ GeoDataDocument *TileLoader::loadTileVectorData( GeoSceneVectorTile const *textu
             GeoDataDocument* document = man.openFile( fileName );
 
             if (document){
+                emit tileAccessed( textureLayer->relativeTileFileName( tileId ) );
                 return document;
             }
         }
@@ -204,6 +210,7 @@ TileLoader::TileStatus TileLoader::tileStatus( GeoSceneTiled const *textureLayer
 
 void TileLoader::updateTile( QByteArray const & data, QString const & idStr )
 {
+    TraceZone zone( "TileLoader::updateTile" );
     QStringList const components = idStr.split( ':', QString::SkipEmptyParts );
     Q_ASSERT( components.size() == 4 );
 
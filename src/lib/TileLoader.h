@@ -85,6 +85,11 @@ class TileLoader: public QObject
 
     void tileCompleted( TileId const & tileId, GeoDataDocument * document, QString const & format );
 
+    /**
+     * Is emitted when the tile at @p relativeFileName was read from disk
+     */
+    void tileAccessed( QString const & relativeFileName );
+
  private:
     static QString tileFileName( GeoSceneTiled const * textureLayer, TileId const & );
     void triggerDownload( GeoSceneTiled const *textureLayer, TileId const &, DownloadUsage const );
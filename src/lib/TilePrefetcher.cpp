@@ -0,0 +1,259 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "TilePrefetcher.h"
+
+#include <qmath.h>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QTime>
+#include <QTimer>
+
+#include "GeoDataLatLonBox.h"
+#include "MarbleDebug.h"
+#include "MarbleMath.h"
+#include "MergedLayerDecorator.h"
+#include "StackedTileLoader.h"
+#include "TileId.h"
+
+namespace Marble
+{
+
+// Time spent decoding prefetched tiles before returning to the event loop
+static const int decodingBudget = 5;
+// Interval in milliseconds in which the queue is processed
+static const int processingInterval = 20;
+// Queued tiles beyond this number are dropped, they will hardly be needed in time
+static const int maximumQueueSize = 1024;
+// Downloads not completed within this time in seconds are considered failed.
+// Failures are not reported per tile, e.g. blacklisted or undecodable ones.
+static const uint downloadTimeout = 120;
+
+class TilePrefetcherPrivate
+{
+public:
+    TilePrefetcherPrivate( StackedTileLoader *tileLoader, MergedLayerDecorator *layerDecorator );
+
+    void processQueue();
+
+    int tileColumn( int level, qreal lon ) const;
+
+    int tileRow( int level, qreal lat ) const;
+
+    void enqueue( const TileId &id );
+
+    void removeFailedDownloads();
+
+    StackedTileLoader *const m_tileLoader;
+    MergedLayerDecorator *const m_layerDecorator;
+    QList<TileId> m_queue;
+    QSet<TileId> m_queuedTiles;
+    // The time each pending download was started at
+    QHash<TileId, uint> m_downloads;
+    QTimer m_timer;
+    QTime m_lastProcessing;
+    quint64 m_memoryLimit;
+    int m_downloadLimit;
+    qreal m_downloadAllowance;
+};
+
+TilePrefetcherPrivate::TilePrefetcherPrivate( StackedTileLoader *tileLoader, MergedLayerDecorator *layerDecorator ) :
+    m_tileLoader( tileLoader ),
+    m_layerDecorator( layerDecorator ),
+    m_memoryLimit( 5000 ),
+    m_downloadLimit( 5 ),
+    m_downloadAllowance( 0.0 )
+{
+    m_timer.setInterval( processingInterval );
+    m_lastProcessing.start();
+}
+
+int TilePrefetcherPrivate::tileColumn( int level, qreal lon ) const
+{
+    const int columns = m_layerDecorator->tileColumnCount( level );
+    const int x = ( lon + M_PI ) / ( 2 * M_PI ) * columns;
+    return qBound( 0, x, columns - 1 );
+}
+
+int TilePrefetcherPrivate::tileRow( int level, qreal lat ) const
+{
+    const int rows = m_layerDecorator->tileRowCount( level );
+    qreal y = 0.0;
+    switch ( m_layerDecorator->tileProjection() ) {
+    case GeoSceneTiled::Equirectangular:
+        y = ( M_PI / 2 - lat ) / M_PI;
+        break;
+    case GeoSceneTiled::Mercator:
+        // The mercator projection does not reach the poles
+        y = 0.5 - gdInv( qBound<qreal>( -1.4835, lat, 1.4835 ) ) / ( 2 * M_PI );
+        break;
+    }
+
+    return qBound( 0, int( y * rows ), rows - 1 );
+}
+
+void TilePrefetcherPrivate::enqueue( const TileId &id )
+{
+    if ( m_queue.size() >= maximumQueueSize || m_queuedTiles.contains( id ) ) {
+        return;
+    }
+
+    m_queue.append( id );
+    m_queuedTiles.insert( id );
+    m_tileLoader->requestPrefetch( id );
+}
+
+void TilePrefetcherPrivate::removeFailedDownloads()
+{
+    const uint now = QDateTime::currentDateTime().toTime_t();
+    QHash<TileId, uint>::iterator it = m_downloads.begin();
+    while ( it != m_downloads.end() ) {
+        if ( now - it.value() >= downloadTimeout ) {
+            it = m_downloads.erase( it );
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TilePrefetcherPrivate::processQueue()
+{
+    // failed tiles may be downloaded again when queued again
+    removeFailedDownloads();
+
+    // refill the download allowance with the time passed since the last run
+    m_downloadAllowance = qMin<qreal>( m_downloadLimit,
+                                       m_downloadAllowance + m_downloadLimit * m_lastProcessing.restart() / 1000.0 );
+
+    QTime time;
+    time.start();
+    while ( !m_queue.isEmpty() && time.elapsed() < decodingBudget ) {
+        const TileId id = m_queue.first();
+
+        if ( m_tileLoader->hasTile( id ) ) {
+            // shown or prefetched before
+        } else if ( m_layerDecorator->isTileAvailable( id ) ) {
+            if ( m_tileLoader->prefetchedByteCount() / 1024 >= m_memoryLimit ) {
+                // wait for prefetched tiles to be used or evicted, keeping the order of the queue
+                break;
+            }
+            m_tileLoader->prefetchTile( id );
+        } else if ( !m_downloads.contains( id ) ) {
+            if ( m_downloadAllowance < 1.0 ) {
+                // wait for the allowance to refill, keeping the order of the queue
+                break;
+            }
+            m_downloadAllowance -= 1.0;
+            m_downloads.insert( id, QDateTime::currentDateTime().toTime_t() );
+            m_layerDecorator->downloadStackedTile( id, DownloadBulk );
+        }
+
+        m_queue.removeFirst();
+        m_queuedTiles.remove( id );
+    }
+
+    if ( m_queue.isEmpty() ) {
+        m_timer.stop();
+    }
+}
+
+TilePrefetcher::TilePrefetcher( StackedTileLoader *tileLoader, MergedLayerDecorator *layerDecorator, QObject *parent ) :
+    QObject( parent ),
+    d( new TilePrefetcherPrivate( tileLoader, layerDecorator ) )
+{
+    connect( &d->m_timer, SIGNAL(timeout()), this, SLOT(processQueue()) );
+    connect( tileLoader, SIGNAL(cleared()), this, SLOT(clear()) );
+}
+
+TilePrefetcher::~TilePrefetcher()
+{
+    delete d;
+}
+
+void TilePrefetcher::addArea( int tileLevel, const GeoDataLatLonBox &area )
+{
+    const int columns = d->m_layerDecorator->tileColumnCount( tileLevel );
+    if ( columns <= 0 ) {
+        return;
+    }
+
+    const int west = d->tileColumn( tileLevel, area.west() );
+    const int east = d->tileColumn( tileLevel, area.east() );
+    const int north = d->tileRow( tileLevel, area.north() );
+    const int south = d->tileRow( tileLevel, area.south() );
+
+    // areas crossing the date line wrap around
+    for ( int x = west; ; x = ( x + 1 ) % columns ) {
+        for ( int y = north; y <= south; ++y ) {
+            d->enqueue( TileId( 0, tileLevel, x, y ) );
+        }
+        if ( x == east ) {
+            break;
+        }
+    }
+
+    if ( !d->m_queue.isEmpty() && !d->m_timer.isActive() ) {
+        d->m_lastProcessing.restart();
+        d->m_timer.start();
+    }
+}
+
+void TilePrefetcher::clear()
+{
+    d->m_timer.stop();
+    d->m_queue.clear();
+    d->m_queuedTiles.clear();
+    d->m_downloads.clear();
+    d->m_tileLoader->cancelPrefetchRequests();
+}
+
+int TilePrefetcher::queuedTiles() const
+{
+    return d->m_queue.size();
+}
+
+void TilePrefetcher::setMemoryLimit( quint64 kiloBytes )
+{
+    d->m_memoryLimit = kiloBytes;
+}
+
+quint64 TilePrefetcher::memoryLimit() const
+{
+    return d->m_memoryLimit;
+}
+
+void TilePrefetcher::setDownloadLimit( int tilesPerSecond )
+{
+    d->m_downloadLimit = tilesPerSecond;
+}
+
+int TilePrefetcher::downloadLimit() const
+{
+    return d->m_downloadLimit;
+}
+
+void TilePrefetcher::updateTile( const TileId &stackedTileId )
+{
+    if ( d->m_downloads.remove( stackedTileId ) ) {
+        // decode it with priority, it was requested in order of use
+        d->m_queue.prepend( stackedTileId );
+        d->m_queuedTiles.insert( stackedTileId );
+        if ( !d->m_timer.isActive() ) {
+            d->m_lastProcessing.restart();
+            d->m_timer.start();
+        }
+    }
+}
+
+}
+
+#include "TilePrefetcher.moc"
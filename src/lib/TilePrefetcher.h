@@ -0,0 +1,94 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef MARBLE_TILEPREFETCHER_H
+#define MARBLE_TILEPREFETCHER_H
+
+#include <QObject>
+
+namespace Marble
+{
+
+class GeoDataLatLonBox;
+class MergedLayerDecorator;
+class StackedTileLoader;
+class TileId;
+class TilePrefetcherPrivate;
+
+/**
+ * @brief Loads the tiles along a planned camera path ahead of time
+ *
+ * The areas shown along the path are added in the order they will be shown.
+ * Their tiles are queued and processed in small steps in the event loop: Tiles
+ * stored locally are decoded into the tile cache of the StackedTileLoader,
+ * missing ones are downloaded with DownloadBulk usage and decoded once they
+ * arrive. Decoding is limited by a memory budget and downloads by a bandwidth
+ * budget, so that prefetching neither evicts the tiles on display nor delays
+ * their downloads.
+ */
+class TilePrefetcher : public QObject
+{
+    Q_OBJECT
+
+ public:
+    TilePrefetcher( StackedTileLoader *tileLoader, MergedLayerDecorator *layerDecorator, QObject *parent = 0 );
+
+    ~TilePrefetcher();
+
+    /**
+     * @brief Queues the tiles of @p tileLevel covering @p area
+     */
+    void addArea( int tileLevel, const GeoDataLatLonBox &area );
+
+    /**
+     * @brief Returns the number of tiles waiting to be prefetched
+     */
+    int queuedTiles() const;
+
+    /**
+     * @brief Sets the memory prefetched tiles may use until they are shown
+     *
+     * Prefetching pauses while the limit is reached and resumes once
+     * prefetched tiles are shown or evicted from the tile cache.
+     * @param kiloBytes the memory limit in kilobytes
+     */
+    void setMemoryLimit( quint64 kiloBytes );
+
+    quint64 memoryLimit() const;
+
+    /**
+     * @brief Sets the maximum number of tile downloads per second
+     */
+    void setDownloadLimit( int tilesPerSecond );
+
+    int downloadLimit() const;
+
+    /**
+     * @brief Decodes the downloaded tile if it was requested by the prefetcher
+     */
+    void updateTile( const TileId &stackedTileId );
+
+ public Q_SLOTS:
+    /**
+     * @brief Discards all queued tiles, e.g. when the camera path changed
+     */
+    void clear();
+
+ private:
+    Q_PRIVATE_SLOT( d, void processQueue() )
+
+    Q_DISABLE_COPY( TilePrefetcher )
+
+    TilePrefetcherPrivate * const d;
+};
+
+}
+
+#endif
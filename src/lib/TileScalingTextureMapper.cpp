@@ -17,33 +17,136 @@
 
 // Qt
 #include <qmath.h>
+#include <QElapsedTimer>
 #include <QImage>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QRunnable>
+#include <QThread>
 
 // Marble
 #include "GeoPainter.h"
+#include "MipChainHelper.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "TextureColorizer.h"
 #include "TileLoaderHelper.h"
 #include "StackedTile.h"
 #include "MathHelper.h"
+#include "TraceRecorder.h"
 #include "ViewportParams.h"
 
 using namespace Marble;
 
+// Time in milliseconds a frame may spend on scaling tiles. Remaining tiles are scaled in the background.
+static const int scalingBudget = 4;
+// Part of a tile level in which the coarser tile level is blended out while zooming
+static const qreal blendingRange = 0.5;
+// Cache sizes in kilobytes
+static const int mipChainCacheSize = 32 * 1024;
+static const int pixmapCacheSize = 32 * 1024;
+
+namespace
+{
+
+/**
+ * Returns the part of the image of @p tile which covers @p stackedId. The tile
+ * may be of a lower level if the requested tile is not available.
+ */
+QRect tilePart( const TileId &stackedId, const StackedTile *tile )
+{
+    const QImage *const image = tile->resultImage();
+    const int deltaLevel = stackedId.zoomLevel() - tile->id().zoomLevel();
+    const int restTileX = stackedId.x() % ( 1 << deltaLevel );
+    const int restTileY = stackedId.y() % ( 1 << deltaLevel );
+    const int partWidth = image->width() >> deltaLevel;
+    const int partHeight = image->height() >> deltaLevel;
+    return QRect( restTileX * partWidth, restTileY * partHeight, partWidth, partHeight );
+}
+
+int pixmapCost( const QSize &size )
+{
+    return size.width() * size.height() * 4 / 1024;
+}
+
+}
+
+/**
+ * Creates the mip chain of a tile and, if a size is given, the tile scaled to
+ * it. Reports itself to the mapper when done.
+ */
+class TileScalingTextureMapper::ScalingJob : public QRunnable
+{
+public:
+    ScalingJob( TileScalingTextureMapper *mapper, const TileId &stackedId, const QImage &source, const QRect &part,
+                const QVector<QImage> &mipChain, const QSize &size );
+
+    virtual void run();
+
+    TileScalingTextureMapper *const m_mapper;
+    const TileId m_stackedId;
+    const QImage m_source;
+    const QRect m_part;
+    const QSize m_size;
+    QVector<QImage> m_mipChain;
+    QImage m_scaledTile;
+};
+
+TileScalingTextureMapper::ScalingJob::ScalingJob( TileScalingTextureMapper *mapper, const TileId &stackedId, const QImage &source, const QRect &part,
+                                                  const QVector<QImage> &mipChain, const QSize &size ) :
+    m_mapper( mapper ),
+    m_stackedId( stackedId ),
+    m_source( source ),
+    m_part( part ),
+    m_size( size ),
+    m_mipChain( mipChain )
+{
+    setAutoDelete( false );
+}
+
+void TileScalingTextureMapper::ScalingJob::run()
+{
+    TraceZone zone( "TileScalingTextureMapper::ScalingJob" );
+
+    if ( m_mipChain.isEmpty() ) {
+        m_mipChain = MipChainHelper::createMipChain( m_source, m_part );
+    }
+
+    if ( m_size.isValid() ) {
+        m_scaledTile = MipChainHelper::scaledTile( m_mipChain, m_size );
+    }
+
+    QMutexLocker locker( &m_mapper->m_finishedJobsMutex );
+    m_mapper->m_finishedJobs << this;
+    if ( m_mapper->m_finishedJobs.size() == 1 ) {
+        // a single call collects all jobs finished until then
+        QMetaObject::invokeMethod( m_mapper, "collectFinishedJobs", Qt::QueuedConnection );
+    }
+}
+
 TileScalingTextureMapper::TileScalingTextureMapper( StackedTileLoader *tileLoader, QObject *parent )
     : QObject( parent ),
       TextureMapperInterface(),
       m_tileLoader( tileLoader ),
-      m_cache( 100 ),
+      m_mipChains( mipChainCacheSize ),
+      m_cache( pixmapCacheSize ),
       m_radius( 0 )
 {
+    // leave a core to the GUI thread
+    m_threadPool.setMaxThreadCount( qMax( 1, QThread::idealThreadCount() - 1 ) );
+
     connect( tileLoader, SIGNAL(tileLoaded(TileId)),
              this,       SLOT(removePixmap(TileId)) );
     connect( tileLoader, SIGNAL(cleared()),
              this,       SLOT(clearPixmaps()) );
 }
 
+TileScalingTextureMapper::~TileScalingTextureMapper()
+{
+    m_threadPool.waitForDone();
+    qDeleteAll( m_finishedJobs );
+}
+
 void TileScalingTextureMapper::mapTexture( GeoPainter *painter,
                                            const ViewportParams *viewport,
                                            int tileZoomLevel,
@@ -114,103 +217,209 @@ void TileScalingTextureMapper::mapTexture( GeoPainter *painter, const ViewportPa
     const int maxTileY = qMin( qreal( numTilesY * ( yNormalizedCenter + imageHeight/( 8.0 * radius ) ) ),
                                qreal( numTilesY - 1.0 ) );
 
-    if ( m_radius != radius ) {
-        m_cache.clear();
+    // While zooming, the tiles are drawn by the painter from their mip chains.
+    // Shortly after switching to a new tile level, the tiles of the coarser level
+    // are drawn below them and faded out over blendingRange.
+    const bool zooming = m_radius != radius;
+    const qreal levelProgress = qLn( 4.0 * radius / numTilesX / m_tileLoader->tileSize().width() ) / qLn( 2.0 );
+    const qreal opacity = zooming && tileZoomLevel > 0 ? qBound<qreal>( 0.0, levelProgress / blendingRange, 1.0 ) : 1.0;
+
+    const bool useCanvas = texColorizer || zooming;
+    QPainter imagePainter;
+    if ( useCanvas ) {
+        imagePainter.begin( &m_canvasImage );
+    } else {
+        painter->save();
+    }
+    QPainter *const tilePainter = useCanvas ? &imagePainter : painter;
+    tilePainter->setRenderHint( QPainter::SmoothPixmapTransform, highQuality );
+
+    QElapsedTimer budget;
+    budget.start();
+
+    for ( int tileY = minTileY; tileY <= maxTileY; ++tileY ) {
+        for ( int tileX = minTileX; tileX <= maxTileX; ++tileX ) {
+            const qreal xLeft   = ( 4.0 * radius ) * ( ( tileX     ) / (qreal)numTilesX - xNormalizedCenter ) + ( imageWidth / 2.0 );
+            const qreal xRight  = ( 4.0 * radius ) * ( ( tileX + 1 ) / (qreal)numTilesX - xNormalizedCenter ) + ( imageWidth / 2.0 );
+            const qreal yTop    = ( 4.0 * radius ) * ( ( tileY     ) / (qreal)numTilesY - yNormalizedCenter ) + ( imageHeight / 2.0 );
+            const qreal yBottom = ( 4.0 * radius ) * ( ( tileY + 1 ) / (qreal)numTilesY - yNormalizedCenter ) + ( imageHeight / 2.0 );
+
+            const QRectF rect = QRectF( QPointF( xLeft, yTop ), QPointF( xRight, yBottom ) );
+            const TileId stackedId = TileId( 0, tileZoomLevel, ( ( tileX % numTilesX ) + numTilesX ) % numTilesX, tileY );
+            const StackedTile *const tile = m_tileLoader->loadTile( stackedId ); // load tile here for every frame, otherwise cleanupTilehash() clears all visible tiles
+
+            // blending is pointless if the tile was cut out of a coarser one anyway
+            if ( opacity < 1.0 && tile->id().zoomLevel() == tileZoomLevel
+                 && drawCoarseTile( tilePainter, rect, stackedId, &budget ) ) {
+                if ( opacity > 0.0 ) {
+                    tilePainter->setOpacity( opacity );
+                    drawTile( tilePainter, rect, stackedId, tile, !useCanvas, &budget );
+                    tilePainter->setOpacity( 1.0 );
+                }
+            } else {
+                drawTile( tilePainter, rect, stackedId, tile, !useCanvas, &budget );
+            }
+        }
     }
 
-    if ( texColorizer || m_radius != radius ) {
-        QPainter imagePainter( &m_canvasImage );
-        imagePainter.setRenderHint( QPainter::SmoothPixmapTransform, highQuality );
-
-        for ( int tileY = minTileY; tileY <= maxTileY; ++tileY ) {
-            for ( int tileX = minTileX; tileX <= maxTileX; ++tileX ) {
-                const qreal xLeft   = ( 4.0 * radius ) * ( ( tileX     ) / (qreal)numTilesX - xNormalizedCenter ) + ( imageWidth / 2.0 );
-                const qreal xRight  = ( 4.0 * radius ) * ( ( tileX + 1 ) / (qreal)numTilesX - xNormalizedCenter ) + ( imageWidth / 2.0 );
-                const qreal yTop    = ( 4.0 * radius ) * ( ( tileY     ) / (qreal)numTilesY - yNormalizedCenter ) + ( imageHeight / 2.0 );
-                const qreal yBottom = ( 4.0 * radius ) * ( ( tileY + 1 ) / (qreal)numTilesY - yNormalizedCenter ) + ( imageHeight / 2.0 );
+    if ( useCanvas ) {
+        imagePainter.end();
 
-                const QRectF rect = QRectF( QPointF( xLeft, yTop ), QPointF( xRight, yBottom ) );
-                const TileId stackedId = TileId( 0, tileZoomLevel, ( ( tileX % numTilesX ) + numTilesX ) % numTilesX, tileY );
+        if ( texColorizer ) {
+            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality() );
+        }
+    } else {
+        painter->restore();
+    }
 
-                const StackedTile *const tile = m_tileLoader->loadTile( stackedId );
+    m_tileLoader->cleanupTilehash();
+}
 
-                const QImage *const toScale = tile->resultImage();
-                const int deltaLevel = stackedId.zoomLevel() - tile->id().zoomLevel();
-                const int restTileX = stackedId.x() % ( 1 << deltaLevel );
-                const int restTileY = stackedId.y() % ( 1 << deltaLevel );
-                const int partWidth = toScale->width() >> deltaLevel;
-                const int partHeight = toScale->height() >> deltaLevel;
-                const int startX = restTileX * partWidth;
-                const int startY = restTileY * partHeight;
-                const QImage part = toScale->copy( startX, startY, partWidth, partHeight ).scaled( toScale->size() );
+void TileScalingTextureMapper::drawTile( QPainter *painter, const QRectF &rect, const TileId &stackedId, const StackedTile *tile,
+                                         bool useScaledTiles, QElapsedTimer *budget )
+{
+    const QSize size = QSize( qRound( rect.right() - rect.left() ), qRound( rect.bottom() - rect.top() ) );
 
-                imagePainter.drawImage( rect, part );
-            }
+    if ( useScaledTiles ) {
+        const QPixmap *const cached = m_cache.object( stackedId );
+        if ( cached && cached->size() == size ) {
+            painter->drawPixmap( rect.topLeft(), *cached );
+            return;
         }
+        if ( cached && MipChainHelper::withinTolerance( cached->size(), size ) ) {
+            // scaled for a slightly different radius
+            painter->drawPixmap( rect, *cached, QRectF( cached->rect() ) );
+            return;
+        }
+    }
 
-        if ( texColorizer ) {
-            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality() );
+    const QVector<QImage> *const chain = mipChain( stackedId, tile, budget );
+
+    if ( useScaledTiles ) {
+        if ( chain && budget->elapsed() < scalingBudget ) {
+            const QPixmap *const pixmap = new QPixmap( QPixmap::fromImage( MipChainHelper::scaledTile( *chain, size ) ) );
+            painter->drawPixmap( rect.topLeft(), *pixmap );
+            m_cache.insert( stackedId, pixmap, pixmapCost( size ) );
+            return;
         }
+
+        startJob( stackedId, tile, size );
+    } else if ( !chain ) {
+        startJob( stackedId, tile, QSize() );
+    }
+
+    // let the painter scale the tile until it is scaled in the background
+    if ( chain ) {
+        painter->drawImage( rect, MipChainHelper::mipLevel( *chain, size ) );
     } else {
-        painter->save();
-        painter->setRenderHint( QPainter::SmoothPixmapTransform, highQuality );
-
-        for ( int tileY = minTileY; tileY <= maxTileY; ++tileY ) {
-            for ( int tileX = minTileX; tileX <= maxTileX; ++tileX ) {
-                const qreal xLeft   = ( 4.0 * radius ) * ( ( tileX     ) / (qreal)numTilesX - xNormalizedCenter ) + ( imageWidth / 2.0 );
-                const qreal xRight  = ( 4.0 * radius ) * ( ( tileX + 1 ) / (qreal)numTilesX - xNormalizedCenter ) + ( imageWidth / 2.0 );
-                const qreal yTop    = ( 4.0 * radius ) * ( ( tileY     ) / (qreal)numTilesY - yNormalizedCenter ) + ( imageHeight / 2.0 );
-                const qreal yBottom = ( 4.0 * radius ) * ( ( tileY + 1 ) / (qreal)numTilesY - yNormalizedCenter ) + ( imageHeight / 2.0 );
-
-                const QRectF rect = QRectF( QPointF( xLeft, yTop ), QPointF( xRight, yBottom ) );
-                const TileId stackedId = TileId( 0, tileZoomLevel, ( ( tileX % numTilesX ) + numTilesX ) % numTilesX, tileY );
-                const StackedTile *const tile = m_tileLoader->loadTile( stackedId ); // load tile here for every frame, otherwise cleanupTilehash() clears all visible tiles
-
-                const QSize size = QSize( qRound( rect.right() - rect.left() ), qRound( rect.bottom() - rect.top() ) );
-                const int cacheHash = 2 * ( size.width() % 2 ) + ( size.height() % 2 );
-                const TileId cacheId = TileId( cacheHash, stackedId.zoomLevel(), stackedId.x(), stackedId.y() );
-
-                const QPixmap *const im_cached = m_cache[cacheId];
-                const QPixmap *im = im_cached;
-                if ( im == 0 ) {
-                    const QImage *const toScale = tile->resultImage();
-                    const int deltaLevel = stackedId.zoomLevel() - tile->id().zoomLevel();
-                    const int restTileX = stackedId.x() % ( 1 << deltaLevel );
-                    const int restTileY = stackedId.y() % ( 1 << deltaLevel );
-                    const int partWidth = toScale->width() >> deltaLevel;
-                    const int partHeight = toScale->height() >> deltaLevel;
-                    const int startX = restTileX * partWidth;
-                    const int startY = restTileY * partHeight;
-                    const QImage part = toScale->copy( startX, startY, partWidth, partHeight ).scaled( toScale->size() );
-
-                    im = new QPixmap( QPixmap::fromImage( part.scaled( size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation ) ) );
-                }
-                painter->drawPixmap( rect.topLeft(), *im );
+        painter->drawImage( rect, *tile->resultImage(), tilePart( stackedId, tile ) );
+    }
+}
 
-                if (im != im_cached)
-                    m_cache.insert( cacheId, im );
-            }
+bool TileScalingTextureMapper::drawCoarseTile( QPainter *painter, const QRectF &rect, const TileId &stackedId, QElapsedTimer *budget )
+{
+    const TileId coarseId( 0, stackedId.zoomLevel() - 1, stackedId.x() / 2, stackedId.y() / 2 );
+
+    // only use tiles at hand, loading them would cause the stutter blending avoids
+    if ( !m_tileLoader->hasTile( coarseId ) ) {
+        return false;
+    }
+
+    const StackedTile *const coarseTile = m_tileLoader->loadTile( coarseId );
+    const QVector<QImage> *const chain = mipChain( coarseId, coarseTile, budget );
+    const QSize coarseSize = QSize( qRound( 2 * rect.width() ), qRound( 2 * rect.height() ) );
+
+    const QImage &image = chain ? MipChainHelper::mipLevel( *chain, coarseSize ) : *coarseTile->resultImage();
+    const QRectF part = chain ? QRectF( image.rect() ) : QRectF( tilePart( coarseId, coarseTile ) );
+
+    // the quarter of the coarse tile covered by the tile
+    const QRectF quarter( part.left() + ( stackedId.x() % 2 ) * part.width() / 2,
+                          part.top() + ( stackedId.y() % 2 ) * part.height() / 2,
+                          part.width() / 2, part.height() / 2 );
+    painter->drawImage( rect, image, quarter );
+
+    return true;
+}
+
+const QVector<QImage> *TileScalingTextureMapper::mipChain( const TileId &stackedId, const StackedTile *tile, QElapsedTimer *budget )
+{
+    const QVector<QImage> *chain = m_mipChains.object( stackedId );
+    if ( !chain && budget->elapsed() < scalingBudget ) {
+        const QVector<QImage> *const created = new QVector<QImage>( MipChainHelper::createMipChain( *tile->resultImage(), tilePart( stackedId, tile ) ) );
+        m_mipChains.insert( stackedId, created, MipChainHelper::mipChainCost( *created ) );
+        chain = created;
+    }
+
+    return chain;
+}
+
+void TileScalingTextureMapper::startJob( const TileId &stackedId, const StackedTile *tile, const QSize &size )
+{
+    if ( m_pendingJobs.contains( stackedId ) ) {
+        return;
+    }
+
+    const QVector<QImage> *const chain = m_mipChains.object( stackedId );
+    ScalingJob *const job = new ScalingJob( this, stackedId, *tile->resultImage(), tilePart( stackedId, tile ),
+                                            chain ? *chain : QVector<QImage>(), size );
+    m_pendingJobs.insert( stackedId );
+    m_threadPool.start( job );
+}
+
+void TileScalingTextureMapper::collectFinishedJobs()
+{
+    QList<ScalingJob *> jobs;
+    {
+        QMutexLocker locker( &m_finishedJobsMutex );
+        jobs = m_finishedJobs;
+        m_finishedJobs.clear();
+    }
+
+    bool updated = false;
+    foreach ( ScalingJob *job, jobs ) {
+        const TileId stackedId = job->m_stackedId;
+        m_pendingJobs.remove( stackedId );
+
+        // the tile changed while it was scaled
+        if ( m_outdatedJobs.remove( stackedId ) ) {
+            delete job;
+            continue;
         }
 
-        painter->restore();
+        if ( !m_mipChains.contains( stackedId ) ) {
+            m_mipChains.insert( stackedId, new QVector<QImage>( job->m_mipChain ), MipChainHelper::mipChainCost( job->m_mipChain ) );
+        }
+
+        if ( !job->m_scaledTile.isNull() ) {
+            m_cache.insert( stackedId, new QPixmap( QPixmap::fromImage( job->m_scaledTile ) ), pixmapCost( job->m_scaledTile.size() ) );
+        }
+
+        updated = true;
+        delete job;
     }
 
-    m_tileLoader->cleanupTilehash();
+    if ( updated ) {
+        m_repaintNeeded = true;
+        emit repaintNeeded();
+    }
 }
 
 void TileScalingTextureMapper::removePixmap( const TileId &tileId )
 {
     const TileId stackedTileId( 0, tileId.zoomLevel(), tileId.x(), tileId.y() );
-    for ( int i = 0; i < 4; ++i ) {
-        const TileId id = TileId( i, stackedTileId.zoomLevel(), stackedTileId.x(), stackedTileId.y() );
+    m_mipChains.remove( stackedTileId );
+    m_cache.remove( stackedTileId );
 
-        m_cache.remove( id );
+    if ( m_pendingJobs.contains( stackedTileId ) ) {
+        m_outdatedJobs.insert( stackedTileId );
     }
 }
 
 void TileScalingTextureMapper::clearPixmaps()
 {
+    m_mipChains.clear();
     m_cache.clear();
+    m_outdatedJobs = m_pendingJobs;
 }
 
 #include "TileScalingTextureMapper.moc"
@@ -19,11 +19,31 @@
 
 #include <QCache>
 #include <QImage>
+#include <QList>
+#include <QMutex>
 #include <QPixmap>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+
+class QElapsedTimer;
+class QPainter;
+class QRectF;
 
 namespace Marble
 {
 
+/**
+ * Draws each tile scaled to its size on screen. For each tile a mip chain of
+ * successively halved images is kept. Tiles are scaled from the smallest level
+ * of the chain that is not smaller than needed, and scaled tiles are reused
+ * for radii which differ only slightly. Mip chains and scaled tiles are
+ * created in a thread pool; only as much scaling as fits into a fixed budget
+ * is done during a frame. Missing tiles are drawn by the painter meanwhile.
+ *
+ * While zooming, the tiles of the coarser tile level are blended in shortly
+ * after switching to a new tile level, so tiles do not pop.
+ */
 class TileScalingTextureMapper : public QObject, public TextureMapperInterface
 {
     Q_OBJECT
@@ -31,27 +51,53 @@ class TileScalingTextureMapper : public QObject, public TextureMapperInterface
  public:
     explicit TileScalingTextureMapper( StackedTileLoader *tileLoader, QObject *parent = 0 );
 
+    ~TileScalingTextureMapper();
+
     virtual void mapTexture( GeoPainter *painter,
                              const ViewportParams *viewport,
                              int tileZoomLevel,
                              const QRect &dirtyRect,
                              TextureColorizer *texColorizer );
 
+ Q_SIGNALS:
+    /**
+     * Tiles scaled in the background are ready to be shown.
+     */
+    void repaintNeeded();
+
  private Q_SLOTS:
     void removePixmap( const TileId &tileId );
     void clearPixmaps();
+    void collectFinishedJobs();
 
  private:
+    class ScalingJob;
+
     void mapTexture( GeoPainter *painter,
                      const ViewportParams *viewport,
                      int tileZoomLevel,
                      TextureColorizer *texColorizer );
 
+    void drawTile( QPainter *painter, const QRectF &rect, const TileId &stackedId, const StackedTile *tile,
+                   bool useScaledTiles, QElapsedTimer *budget );
+
+    bool drawCoarseTile( QPainter *painter, const QRectF &rect, const TileId &stackedId, QElapsedTimer *budget );
+
+    const QVector<QImage> *mipChain( const TileId &stackedId, const StackedTile *tile, QElapsedTimer *budget );
+
+    void startJob( const TileId &stackedId, const StackedTile *tile, const QSize &size );
+
  private:
     StackedTileLoader *const m_tileLoader;
+    QCache<TileId, const QVector<QImage> > m_mipChains;
     QCache<TileId, const QPixmap> m_cache;
     QImage m_canvasImage;
     int    m_radius;
+    QThreadPool m_threadPool;
+    QSet<TileId> m_pendingJobs;
+    QSet<TileId> m_outdatedJobs;
+    QMutex m_finishedJobsMutex;
+    QList<ScalingJob *> m_finishedJobs;
 };
 
 }
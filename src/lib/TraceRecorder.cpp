@@ -0,0 +1,471 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "TraceRecorder.h"
+
+#include "MarbleDebug.h"
+
+#include <qmath.h>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadStorage>
+#include <QVector>
+
+namespace Marble
+{
+
+bool TraceRecorder::s_enabled = false;
+
+namespace
+{
+
+// Number of finished threads whose events are kept once their buffer is reused
+const int maximumArchives = 16;
+
+struct TraceEvent
+{
+    const char *name;
+    qint64 start;
+    qint64 end;
+};
+
+/**
+ * The events of one thread or track. Only its owner thread writes to it, so
+ * its mutex is contended while exporting only. The id and the name are
+ * guarded by the mutex of the registry.
+ */
+class TraceBuffer
+{
+public:
+    TraceBuffer( int id, const QString &name, int size );
+
+    void append( const TraceEvent &event );
+
+    void reset( int size );
+
+    /** Replaces the events by @p events, the buffer is full then */
+    void assign( const QVector<TraceEvent> &events );
+
+    QVector<TraceEvent> events() const;
+
+    int m_id;
+    QString m_name;
+    bool m_retired;
+    mutable QMutex m_mutex;
+    QVector<TraceEvent> m_events;
+    int m_next;
+    int m_count;
+};
+
+TraceBuffer::TraceBuffer( int id, const QString &name, int size ) :
+    m_id( id ),
+    m_name( name ),
+    m_retired( false ),
+    m_events( size ),
+    m_next( 0 ),
+    m_count( 0 )
+{
+    // nothing to do
+}
+
+void TraceBuffer::append( const TraceEvent &event )
+{
+    QMutexLocker locker( &m_mutex );
+    m_events[m_next] = event;
+    m_next = ( m_next + 1 ) % m_events.size();
+    m_count = qMin( m_count + 1, m_events.size() );
+}
+
+void TraceBuffer::reset( int size )
+{
+    QMutexLocker locker( &m_mutex );
+    m_events = QVector<TraceEvent>( size );
+    m_next = 0;
+    m_count = 0;
+}
+
+void TraceBuffer::assign( const QVector<TraceEvent> &events )
+{
+    QMutexLocker locker( &m_mutex );
+    m_events = events;
+    m_next = 0;
+    m_count = events.size();
+}
+
+QVector<TraceEvent> TraceBuffer::events() const
+{
+    QMutexLocker locker( &m_mutex );
+    QVector<TraceEvent> result;
+    result.reserve( m_count );
+    // the oldest event follows the one written last once the buffer is full
+    const int first = m_count < m_events.size() ? 0 : m_next;
+    for ( int i = 0; i < m_count; ++i ) {
+        result << m_events.at( ( first + i ) % m_events.size() );
+    }
+    return result;
+}
+
+/** Marks the buffer of a thread as reusable when the thread finishes */
+class TraceBufferHolder
+{
+public:
+    explicit TraceBufferHolder( TraceBuffer *buffer );
+
+    ~TraceBufferHolder();
+
+    TraceBuffer *const m_buffer;
+};
+
+class TraceRegistry
+{
+public:
+    TraceRegistry();
+
+    ~TraceRegistry();
+
+    TraceBuffer *threadBuffer();
+
+    /** Keeps the events of the finished thread of @p buffer, the mutex must be locked */
+    void archive( const TraceBuffer *buffer );
+
+    TraceBuffer *trackBuffer( const char *track );
+
+    QList<TraceBuffer*> buffers() const;
+
+    QMutex m_mutex;
+    QElapsedTimer m_timer;
+    QThreadStorage<TraceBufferHolder*> m_holders;
+    QList<TraceBuffer*> m_buffers;
+    // the oldest archive is overwritten first
+    QList<TraceBuffer*> m_archives;
+    QHash<QByteArray, TraceBuffer*> m_tracks;
+    QHash<QString, QByteArray> m_names;
+    int m_bufferSize;
+    int m_nextId;
+};
+
+Q_GLOBAL_STATIC( TraceRegistry, traceRegistry )
+
+TraceBufferHolder::TraceBufferHolder( TraceBuffer *buffer ) :
+    m_buffer( buffer )
+{
+    // nothing to do
+}
+
+TraceBufferHolder::~TraceBufferHolder()
+{
+    // threads may finish after the registry was destroyed at exit
+    TraceRegistry *const registry = traceRegistry();
+    if ( registry ) {
+        QMutexLocker locker( &registry->m_mutex );
+        m_buffer->m_retired = true;
+    }
+}
+
+TraceRegistry::TraceRegistry() :
+    m_bufferSize( 65536 ),
+    m_nextId( 1 )
+{
+    m_timer.start();
+}
+
+TraceRegistry::~TraceRegistry()
+{
+    qDeleteAll( m_buffers );
+}
+
+TraceBuffer *TraceRegistry::threadBuffer()
+{
+    if ( m_holders.hasLocalData() ) {
+        return m_holders.localData()->m_buffer;
+    }
+
+    QString name = QThread::currentThread()->objectName();
+    if ( name.isEmpty() ) {
+        if ( QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread() ) {
+            name = "Main Thread";
+        }
+    }
+
+    TraceBuffer *buffer = 0;
+    {
+        QMutexLocker locker( &m_mutex );
+        // Worker threads come and go, reuse the buffers of finished ones.
+        // Their events are kept under the name of the finished thread.
+        foreach ( TraceBuffer *candidate, m_buffers ) {
+            if ( candidate->m_retired ) {
+                archive( candidate );
+                candidate->m_retired = false;
+                candidate->m_id = m_nextId++;
+                candidate->reset( m_bufferSize );
+                buffer = candidate;
+                break;
+            }
+        }
+
+        if ( !buffer ) {
+            const int id = m_nextId++;
+            buffer = new TraceBuffer( id, QString(), m_bufferSize );
+            m_buffers << buffer;
+        }
+
+        buffer->m_name = name.isEmpty() ? QString( "Thread %1" ).arg( buffer->m_id ) : name;
+    }
+
+    m_holders.setLocalData( new TraceBufferHolder( buffer ) );
+    return buffer;
+}
+
+void TraceRegistry::archive( const TraceBuffer *buffer )
+{
+    const QVector<TraceEvent> events = buffer->events();
+    if ( events.isEmpty() ) {
+        return;
+    }
+
+    TraceBuffer *archived = 0;
+    if ( m_archives.size() < maximumArchives ) {
+        archived = new TraceBuffer( buffer->m_id, buffer->m_name, 0 );
+        m_buffers << archived;
+    } else {
+        archived = m_archives.takeFirst();
+        archived->m_id = buffer->m_id;
+        archived->m_name = buffer->m_name;
+    }
+    archived->assign( events );
+    m_archives << archived;
+}
+
+TraceBuffer *TraceRegistry::trackBuffer( const char *track )
+{
+    QMutexLocker locker( &m_mutex );
+    const QByteArray name( track );
+    TraceBuffer *buffer = m_tracks.value( name );
+    if ( !buffer ) {
+        buffer = new TraceBuffer( m_nextId++, QString::fromUtf8( track ), m_bufferSize );
+        m_tracks[name] = buffer;
+        m_buffers << buffer;
+    }
+
+    return buffer;
+}
+
+QList<TraceBuffer*> TraceRegistry::buffers() const
+{
+    QMutexLocker locker( const_cast<QMutex*>( &m_mutex ) );
+    return m_buffers;
+}
+
+QByteArray escaped( const QByteArray &text )
+{
+    QByteArray result;
+    result.reserve( text.size() );
+    foreach ( char c, text ) {
+        if ( c == '"' || c == '\\' ) {
+            result += '\\';
+            result += c;
+        } else if ( uchar( c ) < 0x20 ) {
+            result += "\\u00";
+            result += QByteArray::number( uchar( c ), 16 ).rightJustified( 2, '0' );
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+// Nearest rank percentile of the sorted durations, in milliseconds
+qreal percentile( const QVector<qint64> &durations, qreal fraction )
+{
+    const int rank = qCeil( fraction * durations.size() );
+    return durations.at( qBound( 0, rank - 1, durations.size() - 1 ) ) / 1000000.0;
+}
+
+bool moreExpensive( const TraceRecorder::ZoneSummary &one, const TraceRecorder::ZoneSummary &other )
+{
+    return one.total > other.total;
+}
+
+}
+
+void TraceRecorder::setEnabled( bool enabled )
+{
+    if ( enabled ) {
+        // starts the clock
+        traceRegistry();
+    }
+    s_enabled = enabled;
+}
+
+void TraceRecorder::setBufferSize( int events )
+{
+    TraceRegistry *const registry = traceRegistry();
+    QMutexLocker locker( &registry->m_mutex );
+    registry->m_bufferSize = qMax( 1, events );
+}
+
+int TraceRecorder::bufferSize()
+{
+    TraceRegistry *const registry = traceRegistry();
+    QMutexLocker locker( &registry->m_mutex );
+    return registry->m_bufferSize;
+}
+
+void TraceRecorder::clear()
+{
+    TraceRegistry *const registry = traceRegistry();
+    QMutexLocker locker( &registry->m_mutex );
+    // buffers of finished threads are kept for reuse
+    foreach ( TraceBuffer *buffer, registry->m_buffers ) {
+        buffer->reset( registry->m_archives.contains( buffer ) ? 0 : registry->m_bufferSize );
+    }
+}
+
+qint64 TraceRecorder::now()
+{
+    return traceRegistry()->m_timer.nsecsElapsed();
+}
+
+void TraceRecorder::addEvent( const char *name, qint64 start, qint64 end, const char *track )
+{
+    if ( !s_enabled ) {
+        return;
+    }
+
+    TraceRegistry *const registry = traceRegistry();
+    TraceBuffer *const buffer = track ? registry->trackBuffer( track ) : registry->threadBuffer();
+    TraceEvent event;
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    buffer->append( event );
+}
+
+const char *TraceRecorder::internName( const QString &name )
+{
+    TraceRegistry *const registry = traceRegistry();
+    QMutexLocker locker( &registry->m_mutex );
+    QHash<QString, QByteArray>::const_iterator iter = registry->m_names.constFind( name );
+    if ( iter == registry->m_names.constEnd() ) {
+        iter = registry->m_names.insert( name, name.toUtf8() );
+    }
+    return iter.value().constData();
+}
+
+bool TraceRecorder::writeChromeTrace( QIODevice *device )
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    const QByteArray process = ",\"pid\":" + QByteArray::number( pid ) + ",\"tid\":";
+
+    QByteArray json = "{\"traceEvents\":[";
+    bool first = true;
+    foreach ( const TraceBuffer *buffer, traceRegistry()->buffers() ) {
+        // buffers are reused, the id, name and events have to match
+        int id = 0;
+        QByteArray threadName;
+        QVector<TraceEvent> events;
+        {
+            QMutexLocker locker( &traceRegistry()->m_mutex );
+            id = buffer->m_id;
+            threadName = buffer->m_name.toUtf8();
+            events = buffer->events();
+        }
+        const QByteArray thread = process + QByteArray::number( id ) + '}';
+
+        json += first ? "\n" : ",\n";
+        first = false;
+        json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"args\":{\"name\":\"" + escaped( threadName ) + "\"}" + thread;
+
+        foreach ( const TraceEvent &event, events ) {
+            json += ",\n{\"name\":\"" + escaped( event.name ) + "\",\"cat\":\"marble\",\"ph\":\"X\"";
+            json += ",\"ts\":" + QByteArray::number( event.start / 1000.0, 'f', 3 );
+            json += ",\"dur\":" + QByteArray::number( ( event.end - event.start ) / 1000.0, 'f', 3 );
+            json += thread;
+        }
+
+        if ( json.size() > 1024 * 1024 ) {
+            if ( device->write( json ) != json.size() ) {
+                return false;
+            }
+            json.clear();
+        }
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return device->write( json ) == json.size();
+}
+
+bool TraceRecorder::saveChromeTrace( const QString &fileName )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        mDebug() << "Cannot write trace" << fileName << ":" << file.errorString();
+        return false;
+    }
+
+    return writeChromeTrace( &file );
+}
+
+QList<TraceRecorder::ZoneSummary> TraceRecorder::summaries()
+{
+    // zones of the same name are merged even if their name pointers differ
+    QHash<QByteArray, QVector<qint64> > durations;
+    foreach ( const TraceBuffer *buffer, traceRegistry()->buffers() ) {
+        foreach ( const TraceEvent &event, buffer->events() ) {
+            durations[QByteArray( event.name )] << event.end - event.start;
+        }
+    }
+
+    QList<ZoneSummary> result;
+    QHash<QByteArray, QVector<qint64> >::iterator iter = durations.begin();
+    for ( ; iter != durations.end(); ++iter ) {
+        QVector<qint64> &zone = iter.value();
+        qSort( zone );
+
+        qint64 total = 0;
+        foreach ( qint64 duration, zone ) {
+            total += duration;
+        }
+
+        ZoneSummary summary;
+        summary.name = QString::fromUtf8( iter.key() );
+        summary.count = zone.size();
+        summary.total = total / 1000000.0;
+        summary.median = percentile( zone, 0.5 );
+        summary.percentile90 = percentile( zone, 0.9 );
+        summary.percentile99 = percentile( zone, 0.99 );
+        summary.maximum = zone.last() / 1000000.0;
+        result << summary;
+    }
+
+    qSort( result.begin(), result.end(), moreExpensive );
+    return result;
+}
+
+QString TraceRecorder::summaryText()
+{
+    const QString row = "%1 %2 %3 %4 %5 %6 %7\n";
+    QString result = row.arg( "Zone", -40 ).arg( "Count", 8 ).arg( "Total ms", 12 )
+            .arg( "Median", 10 ).arg( "90%", 10 ).arg( "99%", 10 ).arg( "Max", 10 );
+    foreach ( const ZoneSummary &summary, summaries() ) {
+        result += row.arg( summary.name, -40 ).arg( summary.count, 8 ).arg( summary.total, 12, 'f', 2 )
+                .arg( summary.median, 10, 'f', 3 ).arg( summary.percentile90, 10, 'f', 3 )
+                .arg( summary.percentile99, 10, 'f', 3 ).arg( summary.maximum, 10, 'f', 3 );
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,161 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef MARBLE_TRACERECORDER_H
+#define MARBLE_TRACERECORDER_H
+
+#include "marble_export.h"
+
+#include <QList>
+#include <QString>
+
+class QIODevice;
+
+namespace Marble
+{
+
+/**
+ * @brief Records the time spent in named zones of the code
+ *
+ * Zones are marked with TraceZone objects. Each thread records into its own
+ * ring buffer of fixed size, so only the most recent events are kept and
+ * recording needs no shared lock. Nested zones of a thread form a hierarchy.
+ *
+ * The recorded events can be exported in the JSON format of the Chrome
+ * trace viewer (chrome://tracing) or summarized per zone. Recording is
+ * disabled by default and costs a single branch per zone then.
+ *
+ * @see MarbleModel::setTracingEnabled()
+ */
+class MARBLE_EXPORT TraceRecorder
+{
+ public:
+    struct ZoneSummary
+    {
+        QString name;
+        int count;
+        // durations in milliseconds
+        qreal total;
+        qreal median;
+        qreal percentile90;
+        qreal percentile99;
+        qreal maximum;
+    };
+
+    static void setEnabled( bool enabled );
+
+    static inline bool isEnabled() { return s_enabled; }
+
+    /**
+     * @brief Sets the number of events kept per thread
+     *
+     * Takes effect for threads which did not record yet and after clear().
+     */
+    static void setBufferSize( int events );
+
+    static int bufferSize();
+
+    /**
+     * @brief Discards all recorded events
+     */
+    static void clear();
+
+    /**
+     * @brief Returns the time in nanoseconds since the recorder was first used
+     */
+    static qint64 now();
+
+    /**
+     * @brief Records the zone @p name running from @p start to @p end
+     *
+     * Usually called by TraceZone. Use it directly for spans which do not
+     * match a scope, like network requests.
+     * @param name the zone name, must stay valid until the events are cleared
+     * @param start the begin of the zone as returned by now()
+     * @param end the end of the zone as returned by now()
+     * @param track the name of a track to record into instead of the current
+     * thread. Spans on a track may overlap.
+     */
+    static void addEvent( const char *name, qint64 start, qint64 end, const char *track = 0 );
+
+    /**
+     * @brief Returns a zone name for @p name which stays valid
+     *
+     * Zone names are not copied when recording. Use this for names which are
+     * built at runtime.
+     */
+    static const char *internName( const QString &name );
+
+    /**
+     * @brief Writes all recorded events in the Chrome trace event format
+     */
+    static bool writeChromeTrace( QIODevice *device );
+
+    /**
+     * @brief Writes all recorded events to @p fileName
+     * @see writeChromeTrace
+     */
+    static bool saveChromeTrace( const QString &fileName );
+
+    /**
+     * @brief Returns the duration statistics of each zone, the most expensive first
+     */
+    static QList<ZoneSummary> summaries();
+
+    /**
+     * @brief Returns summaries() as a table for the console
+     */
+    static QString summaryText();
+
+ private:
+    static bool s_enabled;
+};
+
+/**
+ * @brief Records the lifetime of the object as a zone of the TraceRecorder
+ *
+ * @code
+ * void TextureLayer::render( ... )
+ * {
+ *     TraceZone zone( "TextureLayer::render" );
+ *     ...
+ * }
+ * @endcode
+ */
+class TraceZone
+{
+ public:
+    /**
+     * @param name the zone name, usually a string literal. Nothing is recorded
+     * if it is 0.
+     */
+    explicit TraceZone( const char *name ) :
+        m_name( TraceRecorder::isEnabled() ? name : 0 ),
+        m_start( m_name ? TraceRecorder::now() : 0 )
+    {
+    }
+
+    ~TraceZone()
+    {
+        if ( m_name ) {
+            TraceRecorder::addEvent( m_name, m_start, TraceRecorder::now() );
+        }
+    }
+
+ private:
+    Q_DISABLE_COPY( TraceZone )
+
+    const char *const m_name;
+    const qint64 m_start;
+};
+
+}
+
+#endif
@@ -20,6 +20,7 @@
 #include "GeoPolygon.h"
 #include "GeoPainter.h"
 #include "MarbleGlobal.h"
+#include "TraceRecorder.h"
 #include "VectorMap.h"
 #include "ViewportParams.h"
 #include "MarbleDirs.h"
@@ -42,6 +43,7 @@ bool VectorComposer::s_overlaysLoaded( false );
 VectorComposer::VectorComposer( QObject * parent )
     : QObject( parent ),
       m_vectorMap( new VectorMap() ),
+      m_textureMapRevision( 0 ),
       m_oceanPen( QPen( Qt::NoPen ) ),
       m_oceanBrush( QBrush( QColor( 153, 179, 204 ) ) ),
       m_landPen( QPen( Qt::NoPen ) ),
@@ -77,6 +79,12 @@ VectorComposer::VectorComposer( QObject * parent )
     m_dateLinePen.setStyle( Qt::DashLine );
     m_dateLinePen.setColor( QColor( 0, 0, 0 ) );
 
+    connect( s_coastLines, SIGNAL(initialized()), SLOT(increaseTextureMapRevision()) );
+    connect( s_islands, SIGNAL(initialized()), SLOT(increaseTextureMapRevision()) );
+    connect( s_lakeislands, SIGNAL(initialized()), SLOT(increaseTextureMapRevision()) );
+    connect( s_lakes, SIGNAL(initialized()), SLOT(increaseTextureMapRevision()) );
+    connect( s_glaciers, SIGNAL(initialized()), SLOT(increaseTextureMapRevision()) );
+
     connect( s_coastLines, SIGNAL(initialized()), SIGNAL(datasetLoaded()) );
     connect( s_islands, SIGNAL(initialized()), SIGNAL(datasetLoaded()) );
     connect( s_lakeislands, SIGNAL(initialized()), SIGNAL(datasetLoaded()) );
@@ -156,17 +164,36 @@ void VectorComposer::loadOverlays()
 
 void VectorComposer::setShowWaterBodies( bool show )
 {
-    m_showWaterBodies = show;
+    if ( m_showWaterBodies != show ) {
+        m_showWaterBodies = show;
+        increaseTextureMapRevision();
+    }
 }
 
 void VectorComposer::setShowLakes( bool show )
 {
-    m_showLakes = show;
+    if ( m_showLakes != show ) {
+        m_showLakes = show;
+        increaseTextureMapRevision();
+    }
 }
 
 void VectorComposer::setShowIce( bool show )
 {
-    m_showIce = show;
+    if ( m_showIce != show ) {
+        m_showIce = show;
+        increaseTextureMapRevision();
+    }
+}
+
+qint64 VectorComposer::textureMapRevision() const
+{
+    return m_textureMapRevision;
+}
+
+void VectorComposer::increaseTextureMapRevision()
+{
+    ++m_textureMapRevision;
 }
 
 void VectorComposer::setShowCoastLines( bool show )
@@ -240,6 +267,7 @@ void VectorComposer::drawTextureMap( GeoPainter *painter, const ViewportParams *
 void VectorComposer::paintBaseVectorMap( GeoPainter *painter, 
                                          const ViewportParams *viewport )
 {
+    TraceZone zone( "VectorComposer::paintBaseVectorMap" );
     loadCoastlines();
 
     const bool antialiased =    painter->mapQuality() == HighQuality
@@ -306,6 +334,7 @@ void VectorComposer::paintBaseVectorMap( GeoPainter *painter,
 void VectorComposer::paintVectorMap( GeoPainter *painter,
                                      const ViewportParams *viewport )
 {
+    TraceZone zone( "VectorComposer::paintVectorMap" );
     // m_vectorMap->clearNodeCount();
 
     const bool antialiased =    painter->mapQuality() == HighQuality
@@ -55,6 +55,12 @@ class VectorComposer : public QObject
     void setShowRivers( bool show );
     void setShowBorders( bool show );
 
+    /**
+     * @brief Returns a number that changes whenever drawTextureMap() would draw
+     * something different for the same viewport.
+     */
+    qint64 textureMapRevision() const;
+
     /**
      * @brief  Set color of the oceans
      * @param  color  ocean color
@@ -120,6 +126,9 @@ class VectorComposer : public QObject
  Q_SIGNALS:
     void datasetLoaded();
 
+ private Q_SLOTS:
+    void increaseTextureMapRevision();
+
  private:
     // This method contains all the polygons that define the coast lines.
     static inline void loadCoastlines();
@@ -138,6 +147,8 @@ class VectorComposer : public QObject
     bool m_showRivers;
     bool m_showBorders;
 
+    qint64 m_textureMapRevision;
+
     static QAtomicInt refCounter;
 
     static PntMap *s_coastLines;
@@ -17,6 +17,8 @@
 
 #include <QVector>
 #include <QColor>
+#include <QThread>
+#include <QtConcurrentMap>
 
 #include "MarbleDebug.h"
 #include "MarbleGlobal.h"
@@ -30,39 +32,84 @@
 
 using namespace Marble;
 
+// The minimum number of polygons projected by one thread
+const int VectorMap::s_minimumPartitionSize = 64;
+
 VectorMap::VectorMap()
     : m_zBoundingBoxLimit( 0.0 ),
-      m_zPointLimit( 0.0 )
+      m_zPointLimit( 0.0 ),
+      m_partitionCount( 0 )
       // m_debugNodeCount( 0 )
 {
 }
 
 VectorMap::~VectorMap()
 {
+    qDeleteAll( m_pools );
 }
 
 
 void VectorMap::createFromPntMap( const PntMap* pntmap, 
                                   const ViewportParams* viewport )
 {
-    switch( viewport->projection() ) {
-        case Spherical:
-            sphericalCreateFromPntMap( pntmap, viewport );
-            break;
-        case Equirectangular:
-            rectangularCreateFromPntMap( pntmap, viewport );
-            break;
-        case Mercator:
-            mercatorCreateFromPntMap( pntmap, viewport );
-            break;
+    if ( viewport->projection() == Spherical ) {
+        updateZLimits( viewport );
+    }
+
+    // The polygons are projected in contiguous ranges on worker threads,
+    // each range into its own pool. Painting the pools one after another
+    // keeps the order of the polygons.
+    const int size = pntmap->size();
+    const int partitionCount = qBound( 1, size / s_minimumPartitionSize, QThread::idealThreadCount() );
+    const int detail = getDetailLevel( viewport->radius() );
+
+    while ( m_pools.size() < partitionCount ) {
+        m_pools << new ScreenPolygonPool;
+    }
+    m_partitionCount = partitionCount;
+
+    QVector<Partition> partitions;
+    partitions.reserve( partitionCount );
+    for ( int i = 0; i < partitionCount; ++i ) {
+        Partition partition;
+        partition.vectorMap = this;
+        partition.pntMap = pntmap;
+        partition.viewport = viewport;
+        partition.detail = detail;
+        partition.begin = size * i / partitionCount;
+        partition.end = size * ( i + 1 ) / partitionCount;
+        partition.pool = m_pools.at( i );
+        partition.pool->clear();
+        partitions << partition;
+    }
+
+    if ( partitionCount == 1 ) {
+        partitions.first().createPolyLines();
+    } else {
+        QtConcurrent::blockingMap( partitions, &Partition::createPolyLines );
     }
 }
 
-void VectorMap::sphericalCreateFromPntMap( const PntMap* pntmap, 
-                                           const ViewportParams* viewport )
+void VectorMap::Partition::createPolyLines()
 {
-    m_polygons.clear();
+    for ( int i = begin; i < end; ++i ) {
+        const GeoPolygon *geoPolygon = pntMap->at( i );
+        switch( viewport->projection() ) {
+            case Spherical:
+                vectorMap->sphericalCreatePolyLines( geoPolygon, detail, viewport, *pool );
+                break;
+            case Equirectangular:
+                vectorMap->rectangularCreatePolyLines( geoPolygon, detail, viewport, *pool );
+                break;
+            case Mercator:
+                vectorMap->mercatorCreatePolyLines( geoPolygon, detail, viewport, *pool );
+                break;
+        }
+    }
+}
 
+void VectorMap::updateZLimits( const ViewportParams* viewport )
+{
     // We must use qreal or int64 for the calculations because we
     // square radius sometimes below, and it may cause an overflow. We
     // choose qreal because of some sqrt() calculations.
@@ -84,41 +131,35 @@ void VectorMap::sphericalCreateFromPntMap( const PntMap* pntmap,
     m_zPointLimit = ( ( m_zPointLimit >= 0.0 && zlimit < m_zPointLimit )
                       || m_zPointLimit < 0.0 )
                      ? zlimit : m_zPointLimit;
+}
 
-    GeoPolygon::PtrVector::ConstIterator  itPolyLine = pntmap->constBegin();
-    GeoPolygon::PtrVector::ConstIterator  itEndPolyLine = pntmap->constEnd();
-
-    //	const int detail = 0;
-    const int  detail = getDetailLevel( viewport->radius() );
-
-    for (; itPolyLine != itEndPolyLine; ++itPolyLine )
-    {
-        // This sorts out polygons by bounding box which aren't visible at all.
-        GeoDataCoordinates::PtrVector boundary = (*itPolyLine)->getBoundary();
-        // rather paint an invalid line then crashing here if the boundaries are not loaded yet
-        if(boundary.size() < 5) continue;
-
-        for ( int i = 0; i < 5; ++i ) {
-            Quaternion qbound = boundary[i]->quaternion();
-
-            qbound.rotateAroundAxis( viewport->planetAxisMatrix() );
-            if ( qbound.v[Q_Z] > m_zBoundingBoxLimit ) {
-                // if (qbound.v[Q_Z] > 0){
-                // mDebug() << i << " Visible: YES";
-                sphericalCreatePolyLine( *itPolyLine, detail, viewport );
-
-                break; // abort foreach test of current boundary
-            } 
-            // else
-            //     mDebug() << i << " Visible: NOT";
-        }
+void VectorMap::sphericalCreatePolyLines( const GeoPolygon *geoPolygon, const int detail,
+                                          const ViewportParams *viewport, ScreenPolygonPool &pool ) const
+{
+    // This sorts out polygons by bounding box which aren't visible at all.
+    GeoDataCoordinates::PtrVector boundary = geoPolygon->getBoundary();
+    // rather paint an invalid line then crashing here if the boundaries are not loaded yet
+    if(boundary.size() < 5) return;
+
+    for ( int i = 0; i < 5; ++i ) {
+        Quaternion qbound = boundary[i]->quaternion();
+
+        qbound.rotateAroundAxis( viewport->planetAxisMatrix() );
+        if ( qbound.v[Q_Z] > m_zBoundingBoxLimit ) {
+            // if (qbound.v[Q_Z] > 0){
+            // mDebug() << i << " Visible: YES";
+            sphericalCreatePolyLine( geoPolygon, detail, viewport, pool );
+
+            break; // abort foreach test of current boundary
+        } 
+        // else
+        //     mDebug() << i << " Visible: NOT";
     }
 }
 
-void VectorMap::rectangularCreateFromPntMap( const PntMap* pntmap, 
-                                             const ViewportParams* viewport )
+void VectorMap::rectangularCreatePolyLines( const GeoPolygon *geoPolygon, const int detail,
+                                            const ViewportParams *viewport, ScreenPolygonPool &pool ) const
 {
-    m_polygons.clear();
     int  radius = viewport->radius();
 
     // Calculate translation of center point
@@ -127,94 +168,86 @@ void VectorMap::rectangularCreateFromPntMap( const PntMap* pntmap,
 
     const qreal rad2Pixel = (float)( 2 * radius ) / M_PI;
 
-    GeoPolygon::PtrVector::ConstIterator  itPolyLine = pntmap->constBegin();
-    GeoPolygon::PtrVector::ConstIterator  itEndPolyLine = pntmap->constEnd();
-
     const QRectF visibleArea ( 0, 0, viewport->width(), viewport->height() );
-    const int      detail = getDetailLevel( radius );
 
-    for (; itPolyLine != itEndPolyLine; ++itPolyLine )
-    {
-        const GeoDataCoordinates::PtrVector  boundary = (*itPolyLine)->getBoundary();
+    const GeoDataCoordinates::PtrVector  boundary = geoPolygon->getBoundary();
 
-        // Let's just use the top left and the bottom right bounding
-        // box point for this projection.
+    // Let's just use the top left and the bottom right bounding
+    // box point for this projection.
 
-        // rather paint an invalid line then crashing here if the boundaries are not loaded yet
-        if ( boundary.size() < 3 )
-            continue;
+    // rather paint an invalid line then crashing here if the boundaries are not loaded yet
+    if ( boundary.size() < 3 )
+        return;
 
-        ScreenPolygon  boundingPolygon;
+    ScreenPolygon  boundingPolygon;
 
-        for ( int i = 1; i < 3; ++i ) {
-            qreal lon, lat;
-            boundary[i]->geoCoordinates(lon, lat);
-            const qreal x = (qreal)(viewport->width())  / 2.0 - rad2Pixel * (centerLon - lon);
-            const qreal y = (qreal)(viewport->height()) / 2.0 + rad2Pixel * (centerLat - lat);
-            boundingPolygon << QPointF( x, y );
-        }
+    for ( int i = 1; i < 3; ++i ) {
+        qreal lon, lat;
+        boundary[i]->geoCoordinates(lon, lat);
+        const qreal x = (qreal)(viewport->width())  / 2.0 - rad2Pixel * (centerLon - lon);
+        const qreal y = (qreal)(viewport->height()) / 2.0 + rad2Pixel * (centerLat - lat);
+        boundingPolygon << QPointF( x, y );
+    }
 
-        // This sorts out polygons by bounding box which aren't visible at all.
-        int offset = 0;
+    // This sorts out polygons by bounding box which aren't visible at all.
+    int offset = 0;
 
-        if ( boundingPolygon.at(0).x() < 0 || boundingPolygon.at(1).x() < 0 ) {
-            boundingPolygon.translate( 4 * radius, 0 );
-            offset += 4 * radius;
-        }
+    if ( boundingPolygon.at(0).x() < 0 || boundingPolygon.at(1).x() < 0 ) {
+        boundingPolygon.translate( 4 * radius, 0 );
+        offset += 4 * radius;
+    }
 
-        do {
-            offset -= 4 * radius;
-            boundingPolygon.translate( -4 * radius, 0 );
+    do {
+        offset -= 4 * radius;
+        boundingPolygon.translate( -4 * radius, 0 );
 	    // FIXME: Get rid of this really fugly code once we have a
 	    //        proper LatLonBox check implemented and in place.
-        } while( ( (*itPolyLine)->getDateLine() != GeoPolygon::Even 
+    } while( ( geoPolygon->getDateLine() != GeoPolygon::Even 
 		   && visibleArea.intersects( (QRectF)( boundingPolygon.boundingRect() ) ) )
-		 || ( (*itPolyLine)->getDateLine() == GeoPolygon::Even
+		 || ( geoPolygon->getDateLine() == GeoPolygon::Even
 		      && ( visibleArea.intersects( QRectF( boundingPolygon.at(1),
-                                                           QPointF( (qreal)(viewport->width()) / 2.0
-                                                                    - rad2Pixel * ( centerLon - M_PI )
-                                                                    + offset,
-                                                                    boundingPolygon.at(0).y() ) ) )
-                           || visibleArea.intersects( QRectF( QPointF( (qreal)(viewport->width()) / 2.0
-                                                                       - rad2Pixel * ( centerLon
-                                                                                       + M_PI )
-                                                                       + offset,
-                                                                       boundingPolygon.at(1).y() ),
-                                                              boundingPolygon.at(0) ) ) ) ) );
-        offset += 4 * radius;
-        boundingPolygon.translate( 4 * radius, 0 );
+                                                       QPointF( (qreal)(viewport->width()) / 2.0
+                                                                - rad2Pixel * ( centerLon - M_PI )
+                                                                + offset,
+                                                                boundingPolygon.at(0).y() ) ) )
+                       || visibleArea.intersects( QRectF( QPointF( (qreal)(viewport->width()) / 2.0
+                                                                   - rad2Pixel * ( centerLon
+                                                                                   + M_PI )
+                                                                   + offset,
+                                                                   boundingPolygon.at(1).y() ),
+                                                          boundingPolygon.at(0) ) ) ) ) );
+    offset += 4 * radius;
+    boundingPolygon.translate( 4 * radius, 0 );
 
 	// FIXME: Get rid of this really fugly code once we will have
 	//        a proper LatLonBox check implemented and in place.
-        while ( ( (*itPolyLine)->getDateLine() != GeoPolygon::Even 
+    while ( ( geoPolygon->getDateLine() != GeoPolygon::Even 
 		  && visibleArea.intersects( (QRectF)( boundingPolygon.boundingRect() ) ) )
-		|| ( (*itPolyLine)->getDateLine() == GeoPolygon::Even 
+		|| ( geoPolygon->getDateLine() == GeoPolygon::Even 
 		     && ( visibleArea.intersects(
 			    QRectF( boundingPolygon.at(1),
 				    QPointF( (qreal)(viewport->width()) / 2.0
 					     - rad2Pixel * ( centerLon - M_PI )
-                                             + offset,
+                                         + offset,
 					     boundingPolygon.at(0).y() ) ) ) 
 			  || visibleArea.intersects(
 			         QRectF( QPointF( (qreal)(viewport->width()) / 2.0
 						  - rad2Pixel * ( centerLon + M_PI )
-                                                  + offset,
+                                              + offset,
 						  boundingPolygon.at(1).y() ),
 					 boundingPolygon.at(0) ) ) ) )
 		) 
-        {
-            rectangularCreatePolyLine( *itPolyLine, detail, viewport, offset );
+    {
+        rectangularCreatePolyLine( geoPolygon, detail, viewport, offset, pool );
 
-            offset += 4 * radius;
-            boundingPolygon.translate( 4 * radius, 0 );
-        }
+        offset += 4 * radius;
+        boundingPolygon.translate( 4 * radius, 0 );
     }
 }
 
-void VectorMap::mercatorCreateFromPntMap( const PntMap* pntmap,
-                                          const ViewportParams* viewport )
+void VectorMap::mercatorCreatePolyLines( const GeoPolygon *geoPolygon, const int detail,
+                                         const ViewportParams *viewport, ScreenPolygonPool &pool ) const
 {
-    m_polygons.clear();
     int  radius = viewport->radius();
 
     // Calculate translation of center point
@@ -223,104 +256,100 @@ void VectorMap::mercatorCreateFromPntMap( const PntMap* pntmap,
 
     const qreal rad2Pixel = (float)( 2 * radius ) / M_PI;
 
-    GeoPolygon::PtrVector::ConstIterator  itPolyLine = pntmap->constBegin();
-    GeoPolygon::PtrVector::ConstIterator  itEndPolyLine = pntmap->constEnd();
-
     const QRectF visibleArea ( 0, 0, viewport->width(), viewport->height() );
-    const int      detail = getDetailLevel( radius );
 
-    for (; itPolyLine != itEndPolyLine; ++itPolyLine )
-    {
-        const GeoDataCoordinates::PtrVector boundary = (*itPolyLine)->getBoundary();
+    const GeoDataCoordinates::PtrVector boundary = geoPolygon->getBoundary();
 
-        // Let's just use the top left and the bottom right bounding box point for 
-        // this projection
+    // Let's just use the top left and the bottom right bounding box point for 
+    // this projection
 
-        // rather paint an invalid line then crashing here if the boundaries are not loaded yet
-        if ( boundary.size() < 3 )
-            continue;
+    // rather paint an invalid line then crashing here if the boundaries are not loaded yet
+    if ( boundary.size() < 3 )
+        return;
 
-        ScreenPolygon  boundingPolygon;
+    ScreenPolygon  boundingPolygon;
 
-        for ( int i = 1; i < 3; ++i ) {
-            qreal lon, lat;
-            boundary[i]->geoCoordinates(lon, lat);
-            const qreal x = (qreal)(viewport->width())  / 2.0 + rad2Pixel * (lon - centerLon);
-            const qreal y = (qreal)(viewport->height()) / 2.0 - rad2Pixel * ( atanh( sin( lat ) )
-                                                                            - atanh( sin( centerLat ) ) );
+    for ( int i = 1; i < 3; ++i ) {
+        qreal lon, lat;
+        boundary[i]->geoCoordinates(lon, lat);
+        const qreal x = (qreal)(viewport->width())  / 2.0 + rad2Pixel * (lon - centerLon);
+        const qreal y = (qreal)(viewport->height()) / 2.0 - rad2Pixel * ( atanh( sin( lat ) )
+                                                                        - atanh( sin( centerLat ) ) );
 
-            boundingPolygon << QPointF( x, y );
-        }
+        boundingPolygon << QPointF( x, y );
+    }
 
-        // This sorts out polygons by bounding box which aren't visible at all.
-        int offset = 0;
+    // This sorts out polygons by bounding box which aren't visible at all.
+    int offset = 0;
 
-        if ( boundingPolygon.at(0).x() < 0 || boundingPolygon.at(1).x() < 0 ) {
-            boundingPolygon.translate( 4 * radius, 0 );
-            offset += 4 * radius;
-        }
+    if ( boundingPolygon.at(0).x() < 0 || boundingPolygon.at(1).x() < 0 ) {
+        boundingPolygon.translate( 4 * radius, 0 );
+        offset += 4 * radius;
+    }
 
-        do {
-            offset -= 4 * radius;
-            boundingPolygon.translate( -4 * radius, 0 );
+    do {
+        offset -= 4 * radius;
+        boundingPolygon.translate( -4 * radius, 0 );
 	    // FIXME: Get rid of this really fugly code once we have a
 	    //        proper LatLonBox check implemented and in place.
-        } while( ( (*itPolyLine)->getDateLine() != GeoPolygon::Even 
+    } while( ( geoPolygon->getDateLine() != GeoPolygon::Even 
 		   && visibleArea.intersects( (QRectF)( boundingPolygon.boundingRect() ) ) )
-		 || ( (*itPolyLine)->getDateLine() == GeoPolygon::Even
+		 || ( geoPolygon->getDateLine() == GeoPolygon::Even
 		      && ( visibleArea.intersects( QRectF( boundingPolygon.at(1),
-                                                           QPointF( (qreal)(viewport->width()) / 2.0
-                                                                    - rad2Pixel * ( centerLon
-                                                                                    - M_PI )
-                                                                    + offset,
-                                                                    boundingPolygon.at(0).y() ) ) )
-                           || visibleArea.intersects( QRectF( QPointF( (qreal)(viewport->width()) / 2.0
-                                                                       - rad2Pixel * ( centerLon
-                                                                                       + M_PI )
-                                                                       + offset,
-                                                                       boundingPolygon.at(1).y() ),
-                                                              boundingPolygon.at(0) ) ) ) ) );
-        offset += 4 * radius;
-        boundingPolygon.translate( 4 * radius, 0 );
+                                                       QPointF( (qreal)(viewport->width()) / 2.0
+                                                                - rad2Pixel * ( centerLon
+                                                                                - M_PI )
+                                                                + offset,
+                                                                boundingPolygon.at(0).y() ) ) )
+                       || visibleArea.intersects( QRectF( QPointF( (qreal)(viewport->width()) / 2.0
+                                                                   - rad2Pixel * ( centerLon
+                                                                                   + M_PI )
+                                                                   + offset,
+                                                                   boundingPolygon.at(1).y() ),
+                                                          boundingPolygon.at(0) ) ) ) ) );
+    offset += 4 * radius;
+    boundingPolygon.translate( 4 * radius, 0 );
 
 	// FIXME: Get rid of this really fugly code once we will have
 	//        a proper LatLonBox check implemented and in place.
-        while ( ( (*itPolyLine)->getDateLine() != GeoPolygon::Even 
+    while ( ( geoPolygon->getDateLine() != GeoPolygon::Even 
 		  && visibleArea.intersects( (QRectF)( boundingPolygon.boundingRect() ) ) )
-		|| ( (*itPolyLine)->getDateLine() == GeoPolygon::Even 
+		|| ( geoPolygon->getDateLine() == GeoPolygon::Even 
 		     && ( visibleArea.intersects(
 			    QRectF( boundingPolygon.at(1),
 				    QPointF( (qreal)(viewport->width()) / 2.0
 					     - rad2Pixel * ( centerLon - M_PI )
-                                             + offset,
+                                         + offset,
 					     boundingPolygon.at(0).y() ) ) ) 
 			  || visibleArea.intersects(
 			         QRectF( QPointF( (qreal)(viewport->width()) / 2.0
 						  - rad2Pixel * ( centerLon + M_PI )
-                                                  + offset,
+                                              + offset,
 						  boundingPolygon.at(1).y() ),
 					 boundingPolygon.at(0) ) ) ) )
 		)
-        {
-            mercatorCreatePolyLine( *itPolyLine, detail, viewport, offset );
+    {
+        mercatorCreatePolyLine( geoPolygon, detail, viewport, offset, pool );
 
-            offset += 4 * radius;
-            boundingPolygon.translate( 4 * radius, 0 );
-        }
+        offset += 4 * radius;
+        boundingPolygon.translate( 4 * radius, 0 );
     }
 }
 
 void VectorMap::sphericalCreatePolyLine( const GeoPolygon *geoPolygon,
-                                         const int detail, const ViewportParams *viewport )
+                                         const int detail, const ViewportParams *viewport,
+                                         ScreenPolygonPool &pool ) const
 {
     const int radius = viewport->radius();
 
     const int rLimit = (int)( ( radius * radius )
                       * (1.0 - m_zPointLimit * m_zPointLimit ) );
 
-    ScreenPolygon polygon;
+    // Only polygons passing the bounding box test get decoded
+    geoPolygon->decode();
+
+    ScreenPolygon &polygon = *pool.create( geoPolygon->getClosed() );
     polygon.reserve( geoPolygon->size() );
-    polygon.setClosed( geoPolygon->getClosed() );
 
     GeoDataCoordinates::Vector::ConstIterator const &itStartPoint = geoPolygon->constBegin();
     GeoDataCoordinates::Vector::ConstIterator const &itEndPoint = geoPolygon->constEnd();
@@ -417,13 +446,16 @@ void VectorMap::sphericalCreatePolyLine( const GeoPolygon *geoPolygon,
 
     // Avoid polygons degenerated to Points.
     if ( polygon.size() >= 2 ) {
-        m_polygons.append(polygon);
+        pool.append( &polygon );
+    } else {
+        pool.release( &polygon );
     }
 }
 
 void VectorMap::rectangularCreatePolyLine(
     const GeoPolygon *geoPolygon,
-    const int detail, const ViewportParams *viewport, int offset )
+    const int detail, const ViewportParams *viewport, int offset,
+    ScreenPolygonPool &pool ) const
 {
     // Calculate translation of center point
     const qreal centerLon = viewport->centerLongitude();
@@ -432,12 +464,12 @@ void VectorMap::rectangularCreatePolyLine(
     // Other convenience variables
     const qreal  rad2Pixel = (float)( 2 * viewport->radius() ) / M_PI;
 
-    ScreenPolygon polygon;
+    geoPolygon->decode();
+
+    ScreenPolygon &polygon = *pool.create( geoPolygon->getClosed() );
     polygon.reserve( geoPolygon->size() );
-    polygon.setClosed( geoPolygon->getClosed() );
 
-    ScreenPolygon otherPolygon;
-    otherPolygon.setClosed ( geoPolygon->getClosed() );
+    ScreenPolygon &otherPolygon = *pool.create( geoPolygon->getClosed() );
 
     GeoDataCoordinates::Vector::ConstIterator const &itStartPoint = geoPolygon->constBegin();
     GeoDataCoordinates::Vector::ConstIterator const &itEndPoint = geoPolygon->constEnd();
@@ -530,16 +562,21 @@ void VectorMap::rectangularCreatePolyLine(
 
     // Avoid polygons degenerated to Points.
     if ( polygon.size() >= 2 ) {
-        m_polygons.append(polygon);
+        pool.append( &polygon );
+    } else {
+        pool.release( &polygon );
     }
 
     if ( otherPolygon.size() >= 2 ) {
-        m_polygons.append( otherPolygon );
+        pool.append( &otherPolygon );
+    } else {
+        pool.release( &otherPolygon );
     }
 }
 
 void VectorMap::mercatorCreatePolyLine( const GeoPolygon *geoPolygon,
-                                        const int detail, const ViewportParams *viewport, int offset )
+                                        const int detail, const ViewportParams *viewport, int offset,
+                                        ScreenPolygonPool &pool ) const
 {
     // Calculate translation of center point
     const qreal centerLon = viewport->centerLongitude();
@@ -548,12 +585,12 @@ void VectorMap::mercatorCreatePolyLine( const GeoPolygon *geoPolygon,
     // Other convenience variables
     const qreal  rad2Pixel = (qreal)( 2 * viewport->radius() ) / M_PI;
 
-    ScreenPolygon polygon;
+    geoPolygon->decode();
+
+    ScreenPolygon &polygon = *pool.create( geoPolygon->getClosed() );
     polygon.reserve( geoPolygon->size() );
-    polygon.setClosed( geoPolygon->getClosed() );
 
-    ScreenPolygon  otherPolygon;
-    otherPolygon.setClosed ( geoPolygon->getClosed() );
+    ScreenPolygon &otherPolygon = *pool.create( geoPolygon->getClosed() );
 
     GeoDataCoordinates::Vector::ConstIterator const &itStartPoint = geoPolygon->constBegin();
     GeoDataCoordinates::Vector::ConstIterator const &itEndPoint = geoPolygon->constEnd();
@@ -659,11 +696,15 @@ void VectorMap::mercatorCreatePolyLine( const GeoPolygon *geoPolygon,
 
     // Avoid polygons degenerated to Points.
     if ( polygon.size() >= 2 ) {
-        m_polygons.append(polygon);
+        pool.append( &polygon );
+    } else {
+        pool.release( &polygon );
     }
 
     if ( otherPolygon.size() >= 2 ) {
-        m_polygons.append( otherPolygon );
+        pool.append( &otherPolygon );
+    } else {
+        pool.release( &otherPolygon );
     }
 }
 
@@ -672,16 +713,13 @@ void VectorMap::mercatorCreatePolyLine( const GeoPolygon *geoPolygon,
 
 void VectorMap::paintMap(GeoPainter * painter)
 {
-    ScreenPolygon::Vector::const_iterator  itEndPolygon = m_polygons.constEnd();
-
-    for ( ScreenPolygon::Vector::const_iterator itPolygon = m_polygons.constBegin();
-          itPolygon != itEndPolygon;
-          ++itPolygon )
-    {
-        if ( itPolygon->closed() )
-            painter->drawPolygon( *itPolygon );
-        else
-            painter->drawPolyline( *itPolygon );
+    for ( int i = 0; i < m_partitionCount; ++i ) {
+        foreach ( const ScreenPolygon *polygon, m_pools.at( i )->polygons() ) {
+            if ( polygon->closed() )
+                painter->drawPolygon( *polygon );
+            else
+                painter->drawPolyline( *polygon );
+        }
     }
 }
 
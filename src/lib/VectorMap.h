@@ -13,6 +13,7 @@
 #define MARBLE_VECTORMAP_H
 
 #include <QPointF>
+#include <QVector>
 #include <QPen>
 #include <QBrush>
 
@@ -36,6 +37,10 @@ class VectorMap
  public:
     VectorMap();
     ~VectorMap();
+    /**
+     * @brief Projects the polygons of @p pntmap to screen coordinates.
+     * Large maps are projected on several threads.
+     */
     void createFromPntMap( const PntMap*, const ViewportParams *viewport );
 
     /**
@@ -52,16 +57,40 @@ class VectorMap
     //	int nodeCount(){ return m_debugNodeCount; }
 
  private:
-    void sphericalCreateFromPntMap( const PntMap*, const ViewportParams *viewport );
-    void rectangularCreateFromPntMap( const PntMap*, const ViewportParams *viewport );
-    void mercatorCreateFromPntMap( const PntMap*, const ViewportParams *viewport );
+    /**
+     * A range of the polygons of a PntMap, projected into its own pool
+     */
+    struct Partition
+    {
+        const VectorMap *vectorMap;
+        const PntMap *pntMap;
+        const ViewportParams *viewport;
+        int detail;
+        int begin;
+        int end;
+        ScreenPolygonPool *pool;
+
+        void createPolyLines();
+    };
+
+    void updateZLimits( const ViewportParams *viewport );
+
+    void sphericalCreatePolyLines( const GeoPolygon *geoPolygon, const int detail,
+                                   const ViewportParams *viewport, ScreenPolygonPool &pool ) const;
+    void rectangularCreatePolyLines( const GeoPolygon *geoPolygon, const int detail,
+                                     const ViewportParams *viewport, ScreenPolygonPool &pool ) const;
+    void mercatorCreatePolyLines( const GeoPolygon *geoPolygon, const int detail,
+                                  const ViewportParams *viewport, ScreenPolygonPool &pool ) const;
 
     void sphericalCreatePolyLine( const GeoPolygon *geoPolygon,
-                                  const int detail, const ViewportParams *viewport );
+                                  const int detail, const ViewportParams *viewport,
+                                  ScreenPolygonPool &pool ) const;
     void rectangularCreatePolyLine( const GeoPolygon *geoPolygon,
-                                    const int detail, const ViewportParams *viewport, int offset );
+                                    const int detail, const ViewportParams *viewport, int offset,
+                                    ScreenPolygonPool &pool ) const;
     void mercatorCreatePolyLine( const GeoPolygon *geoPolygon,
-                                 const int detail, const ViewportParams *viewport, int offset );
+                                 const int detail, const ViewportParams *viewport, int offset,
+                                 ScreenPolygonPool &pool ) const;
 
     QPointF  horizonPoint( const ViewportParams *viewport, const QPointF &currentPoint, int rLimit ) const;
     static void createArc( const ViewportParams *viewport, const QPointF &horizona, const QPointF &horizonb, int rLimit, ScreenPolygon &polygon );
@@ -72,7 +101,11 @@ class VectorMap
     qreal            m_zBoundingBoxLimit;
     qreal            m_zPointLimit;
 
-    ScreenPolygon::Vector m_polygons;
+    // one pool per partition, reused for each frame
+    QVector<ScreenPolygonPool*> m_pools;
+    int m_partitionCount;
+
+    static const int s_minimumPartitionSize;
 
     //	int m_debugNodeCount;
 };
@@ -20,17 +20,23 @@
 #include "CloudSyncManager.h"
 #include "GeoDataCoordinates.h"
 #include "OwncloudSyncBackend.h"
+#include "JsonStreamReader.h"
 #include "MarbleModel.h"
 #include "BookmarkManager.h"
 
 #include <QFile>
 #include <QBuffer>
-#include <QScriptValue>
-#include <QScriptEngine>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QVector>
+#include <QtAlgorithms>
 #include <QTemporaryFile>
 #include <QNetworkAccessManager>
 #include <QTimer>
 
+#include <cmath>
+
 namespace Marble {
 
 class DiffItem
@@ -55,10 +61,145 @@ public:
     GeoDataPlacemark m_placemarkB;
 };
 
+struct BookmarkCell
+{
+    int x;
+    int y;
+    int z;
+};
+
+inline bool operator==( const BookmarkCell &a, const BookmarkCell &b )
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+inline uint qHash( const BookmarkCell &cell )
+{
+    return ( uint( cell.x ) * 73856093u ) ^ ( uint( cell.y ) * 19349663u ) ^ ( uint( cell.z ) * 83492791u );
+}
+
+/**
+ * Finds positions closer than one meter to each other, which is how bookmarks
+ * are identified across documents. The positions are sorted into cubes by their
+ * cartesian coordinates. As the cubes are a little larger than a meter, a lookup
+ * only needs to check the cube of the position and its neighbors.
+ */
+class BookmarkIndex
+{
+public:
+    /**
+     * Adds @p coordinates and returns their index, counting up from 0
+     */
+    int insert( const GeoDataCoordinates &coordinates );
+
+    /**
+     * Returns the indices of all positions within one meter of @p coordinates in ascending order
+     */
+    QVector<int> find( const GeoDataCoordinates &coordinates ) const;
+
+private:
+    static BookmarkCell cell( const GeoDataCoordinates &coordinates );
+
+    QVector<GeoDataCoordinates> m_coordinates;
+    QMultiHash<BookmarkCell, int> m_cells;
+};
+
+int BookmarkIndex::insert( const GeoDataCoordinates &coordinates )
+{
+    const int index = m_coordinates.size();
+    m_coordinates.append( coordinates );
+    m_cells.insert( cell( coordinates ), index );
+    return index;
+}
+
+QVector<int> BookmarkIndex::find( const GeoDataCoordinates &coordinates ) const
+{
+    QVector<int> result;
+    const BookmarkCell center = cell( coordinates );
+    for ( int x = center.x - 1; x <= center.x + 1; ++x ) {
+        for ( int y = center.y - 1; y <= center.y + 1; ++y ) {
+            for ( int z = center.z - 1; z <= center.z + 1; ++z ) {
+                const BookmarkCell neighbor = { x, y, z };
+                QMultiHash<BookmarkCell, int>::const_iterator it = m_cells.constFind( neighbor );
+                for ( ; it != m_cells.constEnd() && it.key() == neighbor; ++it ) {
+                    if ( EARTH_RADIUS * distanceSphere( m_coordinates.at( it.value() ), coordinates ) <= 1 ) {
+                        result.append( it.value() );
+                    }
+                }
+            }
+        }
+    }
+
+    qSort( result );
+    return result;
+}
+
+BookmarkCell BookmarkIndex::cell( const GeoDataCoordinates &coordinates )
+{
+    // The distance on the surface is never shorter than the straight line,
+    // the extra centimeters guard against rounding errors
+    const qreal size = 1.01;
+
+    qreal lon, lat;
+    coordinates.geoCoordinates( lon, lat );
+    const qreal radius = EARTH_RADIUS / size;
+    const BookmarkCell result = {
+        int( floor( radius * cos( lat ) * cos( lon ) ) ),
+        int( floor( radius * cos( lat ) * sin( lon ) ) ),
+        int( floor( radius * sin( lat ) ) )
+    };
+    return result;
+}
+
+/**
+ * The placemarks of a document, looked up by their position
+ */
+class PlacemarkIndex
+{
+public:
+    explicit PlacemarkIndex( GeoDataContainer *container );
+
+    /**
+     * Returns the first placemark which has the same coordinates as @p bookmark, if any.
+     * Placemarks of a container come before the ones in its folders.
+     */
+    GeoDataPlacemark* find( const GeoDataPlacemark &bookmark ) const;
+
+private:
+    void add( GeoDataContainer *container );
+
+    QVector<GeoDataPlacemark*> m_placemarks;
+    BookmarkIndex m_index;
+};
+
+PlacemarkIndex::PlacemarkIndex( GeoDataContainer *container )
+{
+    add( container );
+}
+
+void PlacemarkIndex::add( GeoDataContainer *container )
+{
+    foreach( GeoDataPlacemark* placemark, container->placemarkList() ) {
+        m_index.insert( placemark->coordinate() );
+        m_placemarks.append( placemark );
+    }
+
+    foreach( GeoDataFolder* folder, container->folderList() ) {
+        add( folder );
+    }
+}
+
+GeoDataPlacemark* PlacemarkIndex::find( const GeoDataPlacemark &bookmark ) const
+{
+    const QVector<int> matches = m_index.find( bookmark.coordinate() );
+    return matches.isEmpty() ? 0 : m_placemarks.at( matches.first() );
+}
+
 class BookmarkSyncManager::Private
 {
 public:
     Private( BookmarkSyncManager* parent, CloudSyncManager *cloudSyncManager );
+    ~Private();
 
     BookmarkSyncManager* m_q;
     CloudSyncManager *m_cloudSyncManager;
@@ -83,6 +224,14 @@ public:
     QList<DiffItem> m_merged;
     DiffItem m_conflictItem;
 
+    // m_diffB by position of m_placemarkA and m_placemarkB
+    BookmarkIndex m_diffBIndexA;
+    BookmarkIndex m_diffBIndexB;
+
+    GeoDataDocument *m_lastSyncedDocument;
+    QString m_lastSyncedDocumentPath;
+    QDateTime m_lastSyncedDocumentModified;
+
     BookmarkManager* m_bookmarkManager;
     QTimer m_syncTimer;
     bool m_bookmarkSyncEnabled;
@@ -127,51 +276,57 @@ public:
      */
     QString lastSyncedKmlPath();
 
+    /**
+     * Parses a bookmark file. The caller takes ownership of the document, which is empty on errors.
+     */
+    GeoDataDocument* parseDocument( QIODevice *device );
+    GeoDataDocument* parseDocument( const QString &path );
+
+    /**
+     * Returns the document of the last synced bookmarks.kml file at @p path.
+     * It is kept in memory and only parsed again if the file changed.
+     */
+    GeoDataDocument* lastSyncedDocument( const QString &path );
+
     /**
      * Gets all placemarks in a document as DiffItems, compares them to another document and puts the result in a list.
      * @param document The document whose placemarks will be compared to another document's placemarks.
-     * @param other The document whose placemarks will be compared to the first document's placemarks.
+     * @param other The placemarks of the document which will be compared to the first document's placemarks.
      * @param diffDirection Direction of comparison, e.g. must be DiffItem::Destination if direction is source to destination.
      * @return A list of DiffItems
      */
-    QList<DiffItem> getPlacemarks(GeoDataDocument *document, GeoDataDocument *other, DiffItem::Status diffDirection );
+    QList<DiffItem> getPlacemarks(GeoDataDocument *document, const PlacemarkIndex &other, DiffItem::Status diffDirection );
 
     /**
      * Gets all placemarks in a document as DiffItems, compares them to another document and puts the result in a list.
      * @param folder The folder whose placemarks will be compared to another document's placemarks.
      * @param path Path of the folder.
-     * @param other The document whose placemarks will be compared to the first document's placemarks.
+     * @param other The placemarks of the document which will be compared to the first document's placemarks.
      * @param diffDirection Direction of comparison, e.g. must be DiffItem::Destination if direction is source to destination.
-     * @return A list of DiffItems
-     */
-    QList<DiffItem> getPlacemarks( GeoDataFolder *folder, QString &path, GeoDataDocument *other, DiffItem::Status diffDirection );
-
-    /**
-     * Finds the placemark which has the same coordinates with given bookmark
-     * @param container Container of placemarks which will be compared. Can be document or folder.
-     * @param bookmark The bookmark whose counterpart will be searched in the container.
-     * @return Counterpart of the given placemark.
+     * @param diffItems The list the DiffItems are appended to.
      */
-    GeoDataPlacemark* findPlacemark( GeoDataContainer* container, const GeoDataPlacemark &bookmark ) const;
+    void getPlacemarks( GeoDataFolder *folder, const QString &path, const PlacemarkIndex &other, DiffItem::Status diffDirection, QList<DiffItem> &diffItems );
 
     /**
      * Determines the status (created, deleted, changed or unchanged) of given DiffItem
      * by comparing the item's placemark with placemarks of given GeoDataDocument.
      * @param item The item whose status will be determined.
-     * @param document The document whose placemarks will be used to determine DiffItem's status.
+     * @param other The placemarks of the document which will be used to determine DiffItem's status.
      */
-    void determineDiffStatus( DiffItem &item, GeoDataDocument* document );
+    void determineDiffStatus( DiffItem &item, const PlacemarkIndex &other );
 
     /**
-     * Finds differences between two bookmark files.
-     * @param sourcePath Source bookmark
-     * @param destinationPath Destination bookmark
+     * Finds differences between two bookmark documents.
+     * @param source Source bookmarks
+     * @param destination Destination bookmarks
      * @return A list of differences
      */
-    QList<DiffItem> diff( QString &sourcePath, QString &destinationPath );
-    QList<DiffItem> diff( QString &sourcePath, QIODevice* destination );
-    QList<DiffItem> diff( QIODevice* source, QString &destinationPath );
-    QList<DiffItem> diff( QIODevice *source, QIODevice* destination );
+    QList<DiffItem> diff( GeoDataDocument *source, GeoDataDocument *destination );
+
+    /**
+     * Returns true if any of the items is created, changed or deleted.
+     */
+    static bool hasChanges( const QList<DiffItem> &diffList );
 
     /**
      * Merges two diff lists.
@@ -210,6 +365,7 @@ public:
 BookmarkSyncManager::Private::Private(BookmarkSyncManager *parent, CloudSyncManager *cloudSyncManager ) :
   m_q( parent ),
   m_cloudSyncManager( cloudSyncManager ),
+  m_lastSyncedDocument( 0 ),
   m_bookmarkManager( 0 ),
   m_bookmarkSyncEnabled( false )
 {
@@ -220,6 +376,11 @@ BookmarkSyncManager::Private::Private(BookmarkSyncManager *parent, CloudSyncMana
     m_timestampEndpoint = "bookmarks/timestamp";
 }
 
+BookmarkSyncManager::Private::~Private()
+{
+    delete m_lastSyncedDocument;
+}
+
 BookmarkSyncManager::BookmarkSyncManager( CloudSyncManager *cloudSyncManager ) :
   QObject(),
   d( new Private( this, cloudSyncManager ) )
@@ -371,23 +532,58 @@ QString BookmarkSyncManager::Private::lastSyncedKmlPath()
     }
 }
 
-QList<DiffItem> BookmarkSyncManager::Private::getPlacemarks( GeoDataDocument *document, GeoDataDocument *other, DiffItem::Status diffDirection )
+GeoDataDocument* BookmarkSyncManager::Private::parseDocument( QIODevice *device )
+{
+    GeoDataParser parser( GeoData_KML );
+    parser.read( device );
+    GeoDataDocument *document = dynamic_cast<GeoDataDocument*>( parser.releaseDocument() );
+    if ( !document ) {
+        mDebug() << "Could not parse bookmarks";
+        document = new GeoDataDocument;
+    }
+
+    return document;
+}
+
+GeoDataDocument* BookmarkSyncManager::Private::parseDocument( const QString &path )
+{
+    QFile file( path );
+    if( !file.open( QFile::ReadOnly ) ) {
+        mDebug() << "Could not open file " << file.fileName();
+    }
+
+    return parseDocument( &file );
+}
+
+GeoDataDocument* BookmarkSyncManager::Private::lastSyncedDocument( const QString &path )
+{
+    const QDateTime modified = QFileInfo( path ).lastModified();
+    if ( !m_lastSyncedDocument || path != m_lastSyncedDocumentPath || modified != m_lastSyncedDocumentModified ) {
+        delete m_lastSyncedDocument;
+        m_lastSyncedDocument = parseDocument( path );
+        m_lastSyncedDocumentPath = path;
+        m_lastSyncedDocumentModified = modified;
+    }
+
+    return m_lastSyncedDocument;
+}
+
+QList<DiffItem> BookmarkSyncManager::Private::getPlacemarks( GeoDataDocument *document, const PlacemarkIndex &other, DiffItem::Status diffDirection )
 {
     QList<DiffItem> diffItems;
     foreach ( GeoDataFolder *folder, document->folderList() ) {
         QString path = QString( "/%0" ).arg( folder->name() );
-        diffItems.append( getPlacemarks( folder, path, other, diffDirection ) );
+        getPlacemarks( folder, path, other, diffDirection, diffItems );
     }
 
     return diffItems;
 }
 
-QList<DiffItem> BookmarkSyncManager::Private::getPlacemarks( GeoDataFolder *folder, QString &path, GeoDataDocument *other, DiffItem::Status diffDirection )
+void BookmarkSyncManager::Private::getPlacemarks( GeoDataFolder *folder, const QString &path, const PlacemarkIndex &other, DiffItem::Status diffDirection, QList<DiffItem> &diffItems )
 {
-    QList<DiffItem> diffItems;
     foreach ( GeoDataFolder *folder, folder->folderList() ) {
         QString newPath = QString( "%0/%1" ).arg( path, folder->name() );
-        diffItems.append( getPlacemarks( folder, newPath, other, diffDirection ) );
+        getPlacemarks( folder, newPath, other, diffDirection, diffItems );
     }
 
     foreach( GeoDataPlacemark *placemark, folder->placemarkList() ) {
@@ -412,31 +608,11 @@ QList<DiffItem> BookmarkSyncManager::Private::getPlacemarks( GeoDataFolder *fold
             diffItems.append( diffItem );
         }
     }
-
-    return diffItems;
 }
 
-GeoDataPlacemark* BookmarkSyncManager::Private::findPlacemark( GeoDataContainer* container, const GeoDataPlacemark &bookmark ) const
+void BookmarkSyncManager::Private::determineDiffStatus( DiffItem &item, const PlacemarkIndex &other )
 {
-    foreach( GeoDataPlacemark* placemark, container->placemarkList() ) {
-        if ( EARTH_RADIUS * distanceSphere( placemark->coordinate(), bookmark.coordinate() ) <= 1 ) {
-            return placemark;
-        }
-    }
-
-    foreach( GeoDataFolder* folder, container->folderList() ) {
-        GeoDataPlacemark* placemark = findPlacemark( folder, bookmark );
-        if ( placemark ) {
-            return placemark;
-        }
-    }
-
-    return 0;
-}
-
-void BookmarkSyncManager::Private::determineDiffStatus( DiffItem &item, GeoDataDocument *document )
-{
-    GeoDataPlacemark *match = findPlacemark( document, item.m_placemarkA );
+    GeoDataPlacemark *match = other.find( item.m_placemarkA );
 
     if( match != 0 ) {
         item.m_placemarkB = *match;
@@ -465,80 +641,59 @@ void BookmarkSyncManager::Private::determineDiffStatus( DiffItem &item, GeoDataD
     }
 }
 
-QList<DiffItem> BookmarkSyncManager::Private::diff( QString &sourcePath, QString &destinationPath )
+QList<DiffItem> BookmarkSyncManager::Private::diff( GeoDataDocument *documentA, GeoDataDocument *documentB )
 {
-    QFile fileB( destinationPath );
-    if( !fileB.open( QFile::ReadOnly ) ) {
-        mDebug() << "Could not open file " << fileB.fileName();
-    }
-    return diff( sourcePath, &fileB );
-}
+    QList<DiffItem> diffItems = getPlacemarks( documentA, PlacemarkIndex( documentB ), DiffItem::Destination ); // Compare old to new
+    diffItems.append( getPlacemarks( documentB, PlacemarkIndex( documentA ), DiffItem::Source ) ); // Compare new to old
 
-QList<DiffItem> BookmarkSyncManager::Private::diff( QString &sourcePath, QIODevice *fileB )
-{
-    QFile fileA( sourcePath );
-    if( !fileA.open( QFile::ReadOnly ) ) {
-        mDebug() << "Could not open file " << fileA.fileName();
+    // Compare paths
+    BookmarkIndex index;
+    foreach( const DiffItem &item, diffItems ) {
+        index.insert( item.m_placemarkB.coordinate() );
     }
 
-    return diff( &fileA, fileB );
-}
-
-QList<DiffItem> BookmarkSyncManager::Private::diff( QIODevice *source, QString &destinationPath )
-{
-    QFile fileB( destinationPath );
-    if( !fileB.open( QFile::ReadOnly ) ) {
-        mDebug() << "Could not open file " << fileB.fileName();
+    for( int i = 0; i < diffItems.count(); i++ ) {
+        if( ( diffItems[i].m_origin == DiffItem::Source )
+                && ( diffItems[i].m_action == DiffItem::NoAction ) ) {
+            foreach( int p, index.find( diffItems[i].m_placemarkA.coordinate() ) ) {
+                if( p > i
+                        && ( EARTH_RADIUS * distanceSphere( diffItems[i].m_placemarkB.coordinate(), diffItems[p].m_placemarkA.coordinate() ) <= 1 )
+                        && ( diffItems[i].m_path != diffItems[p].m_path ) ) {
+                    diffItems[p].m_action = DiffItem::Changed;
+                }
+            }
+        }
     }
 
-    return diff( source, &fileB );
+    return diffItems;
 }
 
-QList<DiffItem> BookmarkSyncManager::Private::diff( QIODevice *fileA, QIODevice *fileB )
+bool BookmarkSyncManager::Private::hasChanges( const QList<DiffItem> &diffList )
 {
-    GeoDataParser parserA( GeoData_KML );
-    parserA.read( fileA );
-    GeoDataDocument *documentA = dynamic_cast<GeoDataDocument*>( parserA.releaseDocument() );
-
-    GeoDataParser parserB( GeoData_KML );
-    parserB.read( fileB );
-    GeoDataDocument *documentB = dynamic_cast<GeoDataDocument*>( parserB.releaseDocument() );
-
-    QList<DiffItem> diffItems = getPlacemarks( documentA, documentB, DiffItem::Destination ); // Compare old to new
-    diffItems.append( getPlacemarks( documentB, documentA, DiffItem::Source ) ); // Compare new to old
-
-    // Compare paths
-    for( int i = 0; i < diffItems.count(); i++ ) {
-        for( int p = i + 1; p < diffItems.count(); p++ ) {
-            if( ( diffItems[i].m_origin == DiffItem::Source )
-                    && ( diffItems[i].m_action == DiffItem::NoAction )
-                    && ( EARTH_RADIUS * distanceSphere( diffItems[i].m_placemarkA.coordinate(), diffItems[p].m_placemarkB.coordinate() ) <= 1 )
-                    && ( EARTH_RADIUS * distanceSphere( diffItems[i].m_placemarkB.coordinate(), diffItems[p].m_placemarkA.coordinate() ) <= 1 )
-                    && ( diffItems[i].m_path != diffItems[p].m_path ) ) {
-                diffItems[p].m_action = DiffItem::Changed;
-            }
+    foreach( const DiffItem &item, diffList ) {
+        if( item.m_action != DiffItem::NoAction ) {
+            return true;
         }
     }
 
-    return diffItems;
+    return false;
 }
 
 void BookmarkSyncManager::Private::merge()
 {
-    foreach( DiffItem itemA, m_diffA ) {
+    foreach( const DiffItem &itemA, m_diffA ) {
         if( itemA.m_action == DiffItem::NoAction ) {
             bool deleted = false;
             bool changed = false;
             DiffItem other;
 
-            foreach( DiffItem itemB, m_diffB ) {
-                if( EARTH_RADIUS * distanceSphere( itemA.m_placemarkA.coordinate(), itemB.m_placemarkA.coordinate() ) <= 1 ) {
-                    if( itemB.m_action == DiffItem::Deleted ) {
-                        deleted = true;
-                    } else if( itemB.m_action == DiffItem::Changed ) {
-                        changed = true;
-                        other = itemB;
-                    }
+            foreach( int index, m_diffBIndexA.find( itemA.m_placemarkA.coordinate() ) ) {
+                const DiffItem &itemB = m_diffB.at( index );
+                if( itemB.m_action == DiffItem::Deleted ) {
+                    deleted = true;
+                } else if( itemB.m_action == DiffItem::Changed ) {
+                    changed = true;
+                    other = itemB;
                 }
             }
             if( changed ) {
@@ -552,13 +707,12 @@ void BookmarkSyncManager::Private::merge()
             bool conflict = false;
             DiffItem other;
 
-            foreach( DiffItem itemB, m_diffB ) {
-                if( EARTH_RADIUS * distanceSphere( itemA.m_placemarkB.coordinate(), itemB.m_placemarkB.coordinate() ) <= 1 ) {
-                    if( ( itemA.m_action == DiffItem::Changed && ( itemB.m_action == DiffItem::Changed || itemB.m_action == DiffItem::Deleted ) )
-                            || ( itemA.m_action == DiffItem::Deleted && itemB.m_action == DiffItem::Changed ) ) {
-                        conflict = true;
-                        other = itemB;
-                    }
+            foreach( int index, m_diffBIndexB.find( itemA.m_placemarkB.coordinate() ) ) {
+                const DiffItem &itemB = m_diffB.at( index );
+                if( ( itemA.m_action == DiffItem::Changed && ( itemB.m_action == DiffItem::Changed || itemB.m_action == DiffItem::Deleted ) )
+                        || ( itemA.m_action == DiffItem::Deleted && itemB.m_action == DiffItem::Changed ) ) {
+                    conflict = true;
+                    other = itemB;
                 }
             }
 
@@ -604,7 +758,7 @@ void BookmarkSyncManager::Private::merge()
         }
     }
 
-    foreach( DiffItem itemB, m_diffB ) {
+    foreach( const DiffItem &itemB, m_diffB ) {
         if( itemB.m_action == DiffItem::Created ) {
             m_merged.append( itemB );
         }
@@ -642,11 +796,16 @@ GeoDataFolder* BookmarkSyncManager::Private::createFolders( GeoDataContainer *co
 GeoDataDocument* BookmarkSyncManager::Private::constructDocument( const QList<DiffItem> &mergedList )
 {
     GeoDataDocument *document = new GeoDataDocument();
+    QHash<QString, GeoDataFolder*> folders;
 
-    foreach( DiffItem item, mergedList ) {
+    foreach( const DiffItem &item, mergedList ) {
         GeoDataPlacemark *placemark = new GeoDataPlacemark( item.m_placemarkA );
-        QStringList splitted = item.m_path.split( "/", QString::SkipEmptyParts );
-        GeoDataFolder *folder = createFolders( document, splitted );
+        GeoDataFolder *folder = folders.value( item.m_path );
+        if( folder == 0 ) {
+            QStringList splitted = item.m_path.split( "/", QString::SkipEmptyParts );
+            folder = createFolders( document, splitted );
+            folders.insert( item.m_path, folder );
+        }
         folder->append( placemark );
     }
 
@@ -686,9 +845,9 @@ void BookmarkSyncManager::Private::saveDownloadedToCache( const QByteArray &kml
     QString localBookmarksDir = m_localBookmarksPath;
     QDir().mkdir( localBookmarksDir.remove( "bookmarks.kml" ) );
     QFile bookmarksFile( m_localBookmarksPath );
-    if( !bookmarksFile.open( QFile::ReadWrite ) ) {
+    if( !bookmarksFile.open( QFile::WriteOnly | QFile::Truncate ) ) {
         mDebug() << "Failed to open file" << bookmarksFile.fileName()
-                 <<  ". It is either missing or not readable.";
+                 <<  ". It is not writable.";
         return;
     }
 
@@ -699,10 +858,8 @@ void BookmarkSyncManager::Private::saveDownloadedToCache( const QByteArray &kml
 
 void BookmarkSyncManager::Private::parseTimestamp()
 {
-    QString response = m_timestampReply->readAll();
-    QScriptEngine engine;
-    QScriptValue parsedResponse = engine.evaluate( QString( "(%0)" ).arg( response ) );
-    QString timestamp = parsedResponse.property( "data" ).toString();
+    QVariantMap parsedResponse = JsonStreamReader::parse( m_timestampReply->readAll() ).toMap();
+    QString timestamp = parsedResponse.value( "data" ).toString();
     m_cloudTimestamp = timestamp;
     mDebug() << "Remote bookmark timestamp is " << m_cloudTimestamp;
     continueSynchronization();
@@ -733,15 +890,11 @@ void BookmarkSyncManager::Private::continueSynchronization()
             mDebug() << "Never synced. Uploading bookmarks.";
             uploadBookmarks();
         } else {
-            QList<DiffItem> diffList = diff( lastSyncedPath, m_localBookmarksPath );
-            bool localModified = false;
-            foreach( DiffItem item, diffList ) {
-                if( item.m_action != DiffItem::NoAction ) {
-                    localModified = true;
-                }
-            }
+            GeoDataDocument *localDocument = parseDocument( m_localBookmarksPath );
+            QList<DiffItem> diffList = diff( lastSyncedDocument( lastSyncedPath ), localDocument );
+            delete localDocument;
 
-            if( localModified ) {
+            if( hasChanges( diffList ) ) {
                 mDebug() << "Local modifications, uploading.";
                 uploadBookmarks();
             }
@@ -761,8 +914,12 @@ void BookmarkSyncManager::Private::completeSynchronization()
     if( lastSyncedPath == QString() ) {
         if( localBookmarksFile.exists() ) {
             mDebug() << "Conflict between remote bookmarks and local ones";
-            m_diffA = diff( &buffer, m_localBookmarksPath );
-            m_diffB = diff( m_localBookmarksPath, &buffer );
+            GeoDataDocument *remoteDocument = parseDocument( &buffer );
+            GeoDataDocument *localDocument = parseDocument( m_localBookmarksPath );
+            m_diffA = diff( remoteDocument, localDocument );
+            m_diffB = diff( localDocument, remoteDocument );
+            delete remoteDocument;
+            delete localDocument;
         } else {
             saveDownloadedToCache( result );
             return;
@@ -770,8 +927,26 @@ void BookmarkSyncManager::Private::completeSynchronization()
     }
     else
     {
-        m_diffA = diff( lastSyncedPath, m_localBookmarksPath );
-        m_diffB = diff( lastSyncedPath, &buffer );
+        GeoDataDocument *remoteDocument = parseDocument( &buffer );
+        GeoDataDocument *localDocument = parseDocument( m_localBookmarksPath );
+        m_diffA = diff( lastSyncedDocument( lastSyncedPath ), localDocument );
+        m_diffB = diff( lastSyncedDocument( lastSyncedPath ), remoteDocument );
+        delete remoteDocument;
+        delete localDocument;
+    }
+
+    if( !hasChanges( m_diffA ) ) {
+        // Nothing to merge and upload, the remote bookmarks are the result
+        mDebug() << "No local modifications, taking over remote bookmarks.";
+        saveDownloadedToCache( result );
+        return;
+    }
+
+    m_diffBIndexA = BookmarkIndex();
+    m_diffBIndexB = BookmarkIndex();
+    foreach( const DiffItem &item, m_diffB ) {
+        m_diffBIndexA.insert( item.m_placemarkA.coordinate() );
+        m_diffBIndexB.insert( item.m_placemarkB.coordinate() );
     }
 
     m_merged.clear();
@@ -783,19 +958,22 @@ void BookmarkSyncManager::Private::completeMerge()
     QFile localBookmarksFile( m_localBookmarksPath );
     GeoDataDocument *doc = constructDocument( m_merged );
     GeoWriter writer;
-    localBookmarksFile.remove();
-    localBookmarksFile.open( QFile::ReadWrite );
+    if( !localBookmarksFile.open( QFile::WriteOnly | QFile::Truncate ) ) {
+        mDebug() << "Failed to open file" << localBookmarksFile.fileName()
+                 <<  ". It is not writable.";
+        delete doc;
+        return;
+    }
     writer.write( &localBookmarksFile, doc );
     localBookmarksFile.close();
+    delete doc;
     uploadBookmarks();
 }
 
 void BookmarkSyncManager::Private::completeUpload()
 {
-    QString response = m_uploadReply->readAll();
-    QScriptEngine engine;
-    QScriptValue parsedResponse = engine.evaluate( QString( "(%0)" ).arg( response ) );
-    QString timestamp = parsedResponse.property( "data" ).toString();
+    QVariantMap parsedResponse = JsonStreamReader::parse( m_uploadReply->readAll() ).toMap();
+    QString timestamp = parsedResponse.value( "data" ).toString();
     m_cloudTimestamp = timestamp;
     mDebug() << "Uploaded bookmarks to remote server. Timestamp is " << m_cloudTimestamp;
     copyLocalToCache();
@@ -15,9 +15,6 @@
 
 #include <QSet>
 #include <QVector>
-#include <QScriptValue>
-#include <QScriptEngine>
-#include <QScriptValueIterator>
 #include <QNetworkAccessManager>
 
 namespace Marble {
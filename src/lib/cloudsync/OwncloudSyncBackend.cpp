@@ -24,11 +24,10 @@
 #include "CloudRouteModel.h"
 #include "GeoDataPlacemark.h"
 #include "CloudSyncManager.h"
+#include "JsonStreamReader.h"
 
 #include <QNetworkAccessManager>
-#include <QScriptValueIterator>
 #include <QNetworkRequest>
-#include <QScriptEngine>
 #include <QFileInfo>
 #include <QBuffer>
 #include <QTimer>
@@ -248,36 +247,26 @@ void OwncloudSyncBackend::cancelUpload()
 
 void OwncloudSyncBackend::prepareRouteList()
 {
-    QString result = d->m_routeListReply->readAll();
-
-    QScriptEngine engine;
-    QScriptValue response = engine.evaluate( QString( "(%0)" ).arg( result ) );
-    QScriptValue routes = response.property( "data" );
+    QVariantMap response = JsonStreamReader::parse( d->m_routeListReply->readAll() ).toMap();
+    QVariant routes = response.value( "data" );
 
     d->m_routeList.clear();
     
-    if( routes.isArray() ) {
-        QScriptValueIterator iterator( routes );
-        
-        while( iterator.hasNext() ) {
-            iterator.next();
-            
+    if( routes.type() == QVariant::List ) {
+        foreach( const QVariant &value, routes.toList() ) {
+            QVariantMap properties = value.toMap();
+
             RouteItem route;
-            route.setIdentifier( iterator.value().property( "timestamp" ).toString() );
-            route.setName ( iterator.value().property( "name" ).toString() );
-            route.setDistance( iterator.value().property( "distance" ).toString() );
-            route.setDuration( iterator.value().property( "duration" ).toString() );
+            route.setIdentifier( properties.value( "timestamp" ).toString() );
+            route.setName ( properties.value( "name" ).toString() );
+            route.setDistance( properties.value( "distance" ).toString() );
+            route.setDuration( properties.value( "duration" ).toString() );
             route.setPreviewUrl( endpointUrl( d->m_routePreviewEndpoint, route.identifier() ) );
             route.setOnCloud( true );
             
             d->m_routeList.append( route );
         }
     }
-    
-    // FIXME Find why an empty item added to the end.
-    if( !d->m_routeList.isEmpty() ) {
-        d->m_routeList.remove( d->m_routeList.count() - 1 );
-    }
 
     emit routeListDownloaded( d->m_routeList );
 }
@@ -25,8 +25,6 @@
 #include <QFile>
 #include <QTimer>
 #include <QPointer>
-#include <QScriptValue>
-#include <QScriptEngine>
 #include <QNetworkReply>
 #include <QTemporaryFile>
 #include <QNetworkRequest>
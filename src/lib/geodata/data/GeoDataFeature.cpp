@@ -35,7 +35,8 @@ namespace Marble
 QFont GeoDataFeaturePrivate::s_defaultFont = QFont("Sans Serif");
 QColor GeoDataFeaturePrivate::s_defaultLabelColor = QColor( Qt::black );
 
-bool GeoDataFeaturePrivate::s_defaultStyleInitialized = false;
+QAtomicInt GeoDataFeaturePrivate::s_defaultStyleInitialized( 0 );
+QMutex GeoDataFeaturePrivate::s_defaultStyleMutex;
 GeoDataStyle* GeoDataFeaturePrivate::s_defaultStyle[GeoDataFeature::LastIndex];
 QMap<QString, GeoDataFeature::GeoDataVisualCategory> GeoDataFeaturePrivate::s_visualCategories;
 
@@ -416,7 +417,6 @@ void GeoDataFeaturePrivate::initializeDefaultStyles()
         = new GeoDataStyle( QImage( MarbleDirs::path( "bitmaps/satellite.png" ) ),
               QFont( defaultFamily, defaultSize, 50, false ), s_defaultLabelColor );
 
-    s_defaultStyleInitialized = true;
     s_defaultFont = QFont("Sans Serif");
 
     QFont tmp;
@@ -453,6 +453,20 @@ void GeoDataFeaturePrivate::initializeDefaultStyles()
     tmp = s_defaultStyle[GeoDataFeature::LargeNationCapital]->labelStyle().font();
     tmp.setUnderline( true );
     s_defaultStyle[GeoDataFeature::LargeNationCapital]->labelStyle().setFont( tmp );
+
+    s_defaultStyleInitialized.fetchAndStoreRelease( 1 );
+}
+
+void GeoDataFeaturePrivate::ensureDefaultStyles()
+{
+    if ( s_defaultStyleInitialized.fetchAndAddAcquire( 0 ) == 1 ) {
+        return;
+    }
+
+    QMutexLocker locker( &s_defaultStyleMutex );
+    if ( s_defaultStyleInitialized.fetchAndAddAcquire( 0 ) == 0 ) {
+        initializeDefaultStyles();
+    }
 }
 
 QFont GeoDataFeature::defaultFont()
@@ -463,7 +477,7 @@ QFont GeoDataFeature::defaultFont()
 void GeoDataFeature::setDefaultFont( const QFont& font )
 {
     GeoDataFeaturePrivate::s_defaultFont = font;
-    GeoDataFeaturePrivate::s_defaultStyleInitialized = false;
+    GeoDataFeaturePrivate::s_defaultStyleInitialized.fetchAndStoreOrdered( 0 );
 }
 
 QColor GeoDataFeature::defaultLabelColor()
@@ -474,7 +488,7 @@ QColor GeoDataFeature::defaultLabelColor()
 void GeoDataFeature::setDefaultLabelColor( const QColor& color )
 {
     GeoDataFeaturePrivate::s_defaultLabelColor = color;
-    GeoDataFeaturePrivate::s_defaultStyleInitialized = false;
+    GeoDataFeaturePrivate::s_defaultStyleInitialized.fetchAndStoreOrdered( 0 );
 }
 
 QString GeoDataFeature::name() const
@@ -627,8 +641,7 @@ const GeoDataStyle* GeoDataFeature::style() const
         return d->m_style;
     } else
     {
-        if ( GeoDataFeaturePrivate::s_defaultStyleInitialized == false )
-            GeoDataFeaturePrivate::initializeDefaultStyles();
+        GeoDataFeaturePrivate::ensureDefaultStyles();
 
         if ( d->m_visualCategory != None
              && GeoDataFeaturePrivate::s_defaultStyle[ d->m_visualCategory] )
@@ -728,7 +741,7 @@ void GeoDataFeature::setPopularity( qint64 popularity )
 
 void GeoDataFeature::resetDefaultStyles()
 {
-    GeoDataFeaturePrivate::s_defaultStyleInitialized = false;
+    GeoDataFeaturePrivate::s_defaultStyleInitialized.fetchAndStoreOrdered( 0 );
 }
 
 void GeoDataFeature::detach()
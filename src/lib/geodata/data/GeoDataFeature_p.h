@@ -13,6 +13,7 @@
 
 #include <QString>
 #include <QAtomicInt>
+#include <QMutex>
 
 #include "GeoDataExtendedData.h"
 #include "GeoDataAbstractView.h"
@@ -120,6 +121,12 @@ class GeoDataFeaturePrivate
     }
 
     static void initializeDefaultStyles();
+
+    /**
+     * Initializes the default styles unless done already. Thread-safe, as
+     * features may be styled on worker threads, e.g. while parsing in parallel.
+     */
+    static void ensureDefaultStyles();
     static void initializeOsmVisualCategories();
 
     static GeoDataStyle* createOsmPOIStyle( const QFont &font, const QString &bitmap, 
@@ -209,7 +216,8 @@ class GeoDataFeaturePrivate
     static QColor        s_defaultLabelColor;
 
     static GeoDataStyle* s_defaultStyle[GeoDataFeature::LastIndex];
-    static bool          s_defaultStyleInitialized;
+    static QAtomicInt    s_defaultStyleInitialized;
+    static QMutex        s_defaultStyleMutex;
 
     static QMap<QString, GeoDataFeature::GeoDataVisualCategory> s_visualCategories;
 };
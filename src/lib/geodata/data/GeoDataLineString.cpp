@@ -229,6 +229,12 @@ void GeoDataLineString::append ( const GeoDataCoordinates& value )
     d->m_vector.append( value );
 }
 
+void GeoDataLineString::reserve( int size )
+{
+    GeoDataGeometry::detach();
+    p()->m_vector.reserve( size );
+}
+
 GeoDataLineString& GeoDataLineString::operator << ( const GeoDataCoordinates& value )
 {
     GeoDataGeometry::detach();
@@ -548,10 +554,12 @@ const GeoDataLatLonAltBox& GeoDataLineString::latLonAltBox() const
     // that's why we recreate it only if the m_dirtyBox
     // is TRUE.
     // DO NOT REMOVE THIS CONSTRUCT OR MARBLE WILL BE SLOW.
+    // Once computed, the box is only read, so it may be accessed from several
+    // threads then.
     if ( p()->m_dirtyBox ) {
         p()->m_latLonAltBox = GeoDataLatLonAltBox::fromLineString( *this );
+        p()->m_dirtyBox = false;
     }
-    p()->m_dirtyBox = false;
 
     return p()->m_latLonAltBox;
 }
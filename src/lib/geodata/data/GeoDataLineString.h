@@ -279,6 +279,13 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
     void append ( const GeoDataCoordinates& position );
 
 
+/*!
+    \brief Attempts to allocate memory for at least @p size nodes.
+    Useful to avoid reallocations when the number of nodes to be appended is known in advance.
+*/
+    void reserve( int size );
+
+
 /*!
     \brief Appends a given geodesic position as a new node to the LineString.
 */
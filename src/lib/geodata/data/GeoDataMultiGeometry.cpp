@@ -186,6 +186,11 @@ void GeoDataMultiGeometry::append( GeoDataGeometry *other )
     p()->m_vector.append( other );
 }
 
+void GeoDataMultiGeometry::remove( int index )
+{
+    detach();
+    p()->m_vector.remove( index );
+}
 
 GeoDataMultiGeometry& GeoDataMultiGeometry::operator << ( const GeoDataGeometry& value )
 {
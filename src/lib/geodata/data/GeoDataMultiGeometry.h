@@ -71,6 +71,11 @@ class GEODATA_EXPORT GeoDataMultiGeometry : public GeoDataGeometry
     */
     void append( GeoDataGeometry *other );
 
+    /**
+     * @brief Removes the geometry at @p index without deleting it
+     */
+    void remove( int index );
+
     GeoDataMultiGeometry& operator << ( const GeoDataGeometry& value );
     
     QVector<GeoDataGeometry*>::Iterator begin();
@@ -157,8 +157,7 @@ GeoDataCoordinates GeoDataTrack::coordinatesAt( const QDateTime &when ) const
 #endif	
     qreal t = (qreal)position / (qreal)interval;
 
-    Quaternion interpolated;
-    interpolated.slerp( previousCoord.quaternion(), nextCoord.quaternion(), t );
+    const Quaternion interpolated = Quaternion::slerp( previousCoord.quaternion(), nextCoord.quaternion(), t );
     qreal lon, lat;
     interpolated.getSpherical( lon, lat );
 
@@ -175,14 +174,19 @@ GeoDataCoordinates GeoDataTrack::coordinatesAt( int index ) const
 void GeoDataTrack::addPoint( const QDateTime &when, const GeoDataCoordinates &coord )
 {
     d->equalizeWhenSize();
-    d->m_lineStringNeedsUpdate = true;
-    int i=0;
-    while ( i < d->m_when.size() ) {
-        if ( d->m_when.at( i ) > when ) {
-            break;
-        }
-        ++i;
+
+    // Points are usually added in chronological order, search from the end
+    int i = d->m_when.size();
+    while ( i > 0 && d->m_when.at( i - 1 ) > when ) {
+        --i;
     }
+
+    if ( i == d->m_when.size() && !d->m_lineStringNeedsUpdate ) {
+        d->m_lineString->append( coord );
+    } else {
+        d->m_lineStringNeedsUpdate = true;
+    }
+
     d->m_when.insert(i, when );
     d->m_coordinates.insert(i, coord );
 }
@@ -227,6 +231,7 @@ void GeoDataTrack::removeBefore( const QDateTime &when )
     while ( !d->m_when.isEmpty() && d->m_when.first() < when ) {
         d->m_when.takeFirst();
         d->m_coordinates.takeFirst();
+        d->m_lineStringNeedsUpdate = true;
     }
 }
 
@@ -238,9 +243,21 @@ void GeoDataTrack::removeAfter( const QDateTime &when )
     }
     d->equalizeWhenSize();
     while ( !d->m_when.isEmpty() && d->m_when.last() > when ) {
-        d->m_when.takeLast();
-        d->m_coordinates.takeLast();
+        removeLast();
+    }
+}
+
+void GeoDataTrack::removeLast()
+{
+    if ( d->m_coordinates.isEmpty() ) {
+        return;
+    }
+    d->equalizeWhenSize();
 
+    d->m_when.removeLast();
+    d->m_coordinates.removeLast();
+    if ( !d->m_lineStringNeedsUpdate ) {
+        d->m_lineString->remove( d->m_lineString->size() - 1 );
     }
 }
 
@@ -119,7 +119,8 @@ public:
 
     /**
      * Add a new point with coordinates @p coord associated with the
-     * time value @p when
+     * time value @p when. Points appended in chronological order take
+     * constant time and extend the line string instead of rebuilding it.
      */
     void addPoint( const QDateTime &when, const GeoDataCoordinates &coord );
 
@@ -157,6 +158,11 @@ public:
      */
     void removeAfter( const QDateTime &when );
 
+    /**
+     * Remove the last point of the track.
+     */
+    void removeLast();
+
     /**
      * Return the GeoDataLineString representing the current track
      */
@@ -22,7 +22,8 @@ ScreenOverlayGraphicsItem::ScreenOverlayGraphicsItem( const GeoDataScreenOverlay
     setSize( QSizeF( m_screenOverlay->size().x(), m_screenOverlay->size().y() ) );
 
     if ( !m_screenOverlay->icon().isNull() ) {
-        m_pixmap = QPixmap::fromImage( m_screenOverlay->icon().scaled( size().toSize() ) );
+        // an image, so the geometry layer may paint it from a worker thread
+        m_image = m_screenOverlay->icon().scaled( size().toSize() );
     }
 }
 
@@ -65,11 +66,11 @@ qreal ScreenOverlayGraphicsItem::pixelValue( GeoDataVec2::Unit unit, qreal scree
 
 void ScreenOverlayGraphicsItem::paint( QPainter *painter )
 {
-    if ( m_pixmap.isNull() ) {
+    if ( m_image.isNull() ) {
         painter->setBrush( m_screenOverlay->color() );
         painter->drawRect( QRectF( QPointF( 0.0, 0.0 ), size() ) );
     } else {
-        painter->drawPixmap( QPointF( 0.0, 0.0 ), m_pixmap );
+        painter->drawImage( QPointF( 0.0, 0.0 ), m_image );
     }
 }
 
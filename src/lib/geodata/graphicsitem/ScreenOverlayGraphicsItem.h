@@ -18,7 +18,7 @@
 #include "ScreenGraphicsItem.h"
 #include "marble_export.h"
 
-#include <QPixmap>
+#include <QImage>
 
 namespace Marble {
 
@@ -39,7 +39,7 @@ private:
 
     const GeoDataScreenOverlay *m_screenOverlay;
 
-    QPixmap m_pixmap;
+    QImage m_image;
 };
 
 }
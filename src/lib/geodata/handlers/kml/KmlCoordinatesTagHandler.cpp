@@ -21,9 +21,6 @@
 
 #include "KmlCoordinatesTagHandler.h"
 
-#include <QStringList>
-#include <QRegExp>
-
 #include "MarbleDebug.h"
 #include "KmlElementDictionary.h"
 #include "GeoDataTrack.h"
@@ -51,6 +48,216 @@ static const bool kmlStrictSpecs = false;
 static GeoTagHandlerRegistrar s_handlercoordkmlTag_nameSpaceGx22(GeoParser::QualifiedName(kmlTag_coord, kmlTag_nameSpaceGx22 ),
                                                                  new KmlcoordinatesTagHandler());
 
+static inline bool isSpace( const QChar *c )
+{
+    const ushort unicode = c->unicode();
+    return unicode == ' ' || ( unicode >= '\t' && unicode <= '\r' ) || ( unicode >= 0x80 && c->isSpace() );
+}
+
+static inline bool isDigit( const QChar *c )
+{
+    return c->unicode() >= '0' && c->unicode() <= '9';
+}
+
+/**
+ * Converts the text between @p begin and @p end to a double like QString::toDouble() does.
+ *
+ * Decimal numbers with at most 15 significant digits and a decimal exponent of at
+ * most 22 are computed directly: both the mantissa and the power of ten are exact
+ * doubles then, so one correctly rounded multiplication or division gives the same
+ * result as a full conversion. Anything else is left to QString::toDouble().
+ */
+static qreal parseDouble( const QChar *begin, const QChar *end )
+{
+    static const double powersOfTen[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const QChar *c = begin;
+    bool negative = false;
+    if ( c != end && ( c->unicode() == '-' || c->unicode() == '+' ) ) {
+        negative = c->unicode() == '-';
+        ++c;
+    }
+
+    quint64 mantissa = 0;
+    int significantDigits = 0;
+    int digits = 0;
+    int exponent = 0;
+
+    for ( ; c != end && isDigit( c ); ++c, ++digits ) {
+        if ( mantissa != 0 || c->unicode() != '0' ) {
+            mantissa = mantissa * 10 + ( c->unicode() - '0' );
+            ++significantDigits;
+        }
+    }
+
+    if ( c != end && c->unicode() == '.' ) {
+        for ( ++c; c != end && isDigit( c ); ++c, ++digits ) {
+            if ( mantissa != 0 || c->unicode() != '0' ) {
+                mantissa = mantissa * 10 + ( c->unicode() - '0' );
+                ++significantDigits;
+            }
+            --exponent;
+        }
+    }
+
+    if ( c != end && ( c->unicode() == 'e' || c->unicode() == 'E' ) ) {
+        ++c;
+        bool negativeExponent = false;
+        if ( c != end && ( c->unicode() == '-' || c->unicode() == '+' ) ) {
+            negativeExponent = c->unicode() == '-';
+            ++c;
+        }
+        int value = 0;
+        const QChar *exponentBegin = c;
+        for ( ; c != end && isDigit( c ) && value < 1000; ++c ) {
+            value = value * 10 + ( c->unicode() - '0' );
+        }
+        if ( c == exponentBegin ) {
+            digits = 0; // malformed exponent, let Qt decide
+        }
+        exponent += negativeExponent ? -value : value;
+    }
+
+    if ( c != end || digits == 0 || significantDigits > 15 || exponent < -22 || exponent > 22 ) {
+        if ( digits > 0 && mantissa == 0 && c == end ) {
+            return negative ? -0.0 : 0.0;
+        }
+        return QString::fromRawData( begin, end - begin ).toDouble();
+    }
+
+    double result = mantissa;
+    if ( exponent < 0 ) {
+        result /= powersOfTen[-exponent];
+    } else {
+        result *= powersOfTen[exponent];
+    }
+
+    return negative ? -result : result;
+}
+
+/**
+ * Splits the text of a coordinates element into tuples of comma separated values
+ * in place, without copying any part of it.
+ *
+ * Tuples are separated by whitespace. Unless @p strict is set, whitespace around
+ * the commas is tolerated as well.
+ */
+class CoordinatesTokenizer
+{
+public:
+    CoordinatesTokenizer( const QString &text, bool strict ) :
+        m_position( text.constData() ),
+        m_end( text.constData() + text.size() ),
+        m_strict( strict ),
+        m_fieldCount( 0 )
+    {
+    }
+
+    /**
+     * Advances to the next tuple. Returns false if there is none.
+     */
+    bool next();
+
+    /**
+     * Returns the number of values of the current tuple.
+     */
+    int fieldCount() const
+    {
+        return m_fieldCount;
+    }
+
+    /**
+     * Returns the value at @p index of the current tuple, @p index must be less than 3.
+     */
+    qreal field( int index ) const
+    {
+        return parseDouble( m_fields[index][0], m_fields[index][1] );
+    }
+
+    /**
+     * Returns the coordinates given by the current tuple of longitude, latitude and
+     * an optional altitude. Tuples with fewer or more values result in default coordinates.
+     */
+    GeoDataCoordinates coordinates() const;
+
+    /**
+     * Estimates the number of tuples of the text from its length, assuming
+     * tuples of two values with six decimals, which is what most files use.
+     */
+    static int estimatedTupleCount( const QString &text );
+
+private:
+    const QChar *m_position;
+    const QChar *const m_end;
+    const bool m_strict;
+    int m_fieldCount;
+    const QChar *m_fields[3][2];
+};
+
+bool CoordinatesTokenizer::next()
+{
+    while ( m_position != m_end && isSpace( m_position ) ) {
+        ++m_position;
+    }
+
+    if ( m_position == m_end ) {
+        return false;
+    }
+
+    m_fieldCount = 0;
+    forever {
+        const QChar *begin = m_position;
+        while ( m_position != m_end && m_position->unicode() != ',' && !isSpace( m_position ) ) {
+            ++m_position;
+        }
+
+        if ( m_fieldCount < 3 ) {
+            m_fields[m_fieldCount][0] = begin;
+            m_fields[m_fieldCount][1] = m_position;
+        }
+        ++m_fieldCount;
+
+        const QChar *separator = m_position;
+        if ( !m_strict ) {
+            while ( separator != m_end && isSpace( separator ) ) {
+                ++separator;
+            }
+        }
+
+        if ( separator == m_end || separator->unicode() != ',' ) {
+            m_position = separator;
+            return true;
+        }
+
+        m_position = separator + 1;
+        if ( !m_strict ) {
+            while ( m_position != m_end && isSpace( m_position ) ) {
+                ++m_position;
+            }
+        }
+    }
+}
+
+GeoDataCoordinates CoordinatesTokenizer::coordinates() const
+{
+    GeoDataCoordinates coordinates;
+    if ( m_fieldCount == 2 ) {
+        coordinates.set( DEG2RAD * field( 0 ), DEG2RAD * field( 1 ) );
+    } else if ( m_fieldCount == 3 ) {
+        coordinates.set( DEG2RAD * field( 0 ), DEG2RAD * field( 1 ), field( 2 ) );
+    }
+    return coordinates;
+}
+
+int CoordinatesTokenizer::estimatedTupleCount( const QString &text )
+{
+    // e.g. "-123.456789,12.345678 "; a wrong guess only costs a reallocation
+    return text.size() / 22 + 1;
+}
+
 GeoNode* KmlcoordinatesTagHandler::parse( GeoParser& parser ) const
 {
     Q_ASSERT( parser.isStartElement()
@@ -64,108 +271,58 @@ GeoNode* KmlcoordinatesTagHandler::parse( GeoParser& parser ) const
      || parentItem.represents( kmlTag_MultiGeometry )
      || parentItem.represents( kmlTag_LinearRing )
      || parentItem.represents( kmlTag_LatLonQuad ) ) {
-        QStringList  coordinatesLines;// = parser.readElementText().trimmed().split( QRegExp("\\s"), QString::SkipEmptyParts );
-        // Splitting using the "\\s" regexp is slow, split manually instead.
-        QString text = parser.readElementText().trimmed();
-
-        if ( !kmlStrictSpecs ) {
-            // Removing spaces before and after commas
-            for ( int i = 1; i < text.size() - 1; ++i ) {
-                if ( text[i] == ',' ) {
-                    // Before
-                    int l = i - 1;
-                    while ( l > 0 && text[l].isSpace() ) {
-                        --l;
-                    }
-
-                    // After
-                    int r = i + 1;
-                    while ( r < text.size() && text[r].isSpace() ) {
-                        ++r;
-                    }
-
-                    text.remove( l + 1, r - l - 1 ).insert( l + 1, ',' );
-                }
-            }
-        }
+        const QString text = parser.readElementText();
 
-        int index = 0;
-        bool inside = true;
-        int const size = text.size();
-        for ( int i=0; i<size; ++i ) {
-            if ( text[i].isSpace() ) {
-                if ( inside ) {
-                    coordinatesLines.append( text.mid( index, i-index ) );
-                    inside = false;
-                }
-                index = i+1;
-            } else {
-                inside = true;
+        if ( parentItem.represents( kmlTag_LineString ) || parentItem.represents( kmlTag_LinearRing ) ) {
+            // GeoDataLinearRing is a GeoDataLineString
+            GeoDataLineString *lineString = parentItem.nodeAs<GeoDataLineString>();
+            lineString->reserve( lineString->size() + CoordinatesTokenizer::estimatedTupleCount( text ) );
+
+            CoordinatesTokenizer tokenizer( text, kmlStrictSpecs );
+            while ( tokenizer.next() ) {
+                lineString->append( tokenizer.coordinates() );
             }
+
+            return 0;
         }
-        coordinatesLines.append( text.mid( index ) );
+
+        CoordinatesTokenizer tokenizer( text, kmlStrictSpecs );
         int coordinatesIndex = 0;
-        Q_FOREACH( const QString& line, coordinatesLines ) {
-            QStringList coordinates = line.trimmed().split( ',' );
+        while ( tokenizer.next() ) {
+            const GeoDataCoordinates coord = tokenizer.coordinates();
             if ( parentItem.represents( kmlTag_Point ) && parentItem.is<GeoDataFeature>() ) {
-                GeoDataCoordinates coord;
-                if ( coordinates.size() == 2 ) {
-                    coord.set( coordinates.at( 0 ).toDouble(),
-                              coordinates.at( 1 ).toDouble(), 0.0, GeoDataCoordinates::Degree );
-                } else if( coordinates.size() == 3 ) {
-                    coord.set( coordinates.at( 0 ).toDouble(),
-                               coordinates.at( 1 ).toDouble(),
-                               coordinates.at( 2 ).toDouble(),
-                               GeoDataCoordinates::Degree );
-                }
                 parentItem.nodeAs<GeoDataPlacemark>()->setCoordinate( coord );
-            } else {
-                GeoDataCoordinates coord;
-                if ( coordinates.size() == 2 ) {
-                    coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                              DEG2RAD * coordinates.at( 1 ).toDouble() );
-                } else if( coordinates.size() == 3 ) {
-                    coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                              DEG2RAD * coordinates.at( 1 ).toDouble(),
-                              coordinates.at( 2 ).toDouble() );
-                }
-
-                if ( parentItem.represents( kmlTag_LineString ) ) {
-                    parentItem.nodeAs<GeoDataLineString>()->append( coord );
-                } else if ( parentItem.represents( kmlTag_LinearRing ) ) {
-                    parentItem.nodeAs<GeoDataLinearRing>()->append( coord );
-                } else if ( parentItem.represents( kmlTag_MultiGeometry ) ) {
-                    GeoDataPoint *point = new GeoDataPoint( coord );
-                    parentItem.nodeAs<GeoDataMultiGeometry>()->append( point );
-                } else if ( parentItem.represents( kmlTag_Model) ) {
-                    parentItem.nodeAs<GeoDataModel>()->setCoordinates( coord);
-                } else if ( parentItem.represents( kmlTag_Point ) ) {
-                    // photo overlay
-                    parentItem.nodeAs<GeoDataPoint>()->setCoordinates( coord );
-                } else if ( parentItem.represents( kmlTag_LatLonQuad ) ) {
-                    switch ( coordinatesIndex ) {
-                    case 0:
-                        parentItem.nodeAs<GeoDataLatLonQuad>()->setBottomLeft( coord );
-                        break;
-                    case 1:
-                        parentItem.nodeAs<GeoDataLatLonQuad>()->setBottomRight( coord );
-                        break;
-                    case 2:
-                        parentItem.nodeAs<GeoDataLatLonQuad>()->setTopRight( coord );
-                        break;
-                    case 3:
-                        parentItem.nodeAs<GeoDataLatLonQuad>()->setTopLeft( coord );
-                        break;
-                    case 4:
-                        mDebug() << "Ignoring excessive coordinates in LatLonQuad (must not have more than 4 pairs)";
-                        break;
-                    default:
-                        // Silently ignore any more coordinates
-                        break;
-                    }
-                } else {
-                    // raise warning as coordinates out of valid parents found
+            } else if ( parentItem.represents( kmlTag_MultiGeometry ) ) {
+                GeoDataPoint *point = new GeoDataPoint( coord );
+                parentItem.nodeAs<GeoDataMultiGeometry>()->append( point );
+            } else if ( parentItem.represents( kmlTag_Model) ) {
+                parentItem.nodeAs<GeoDataModel>()->setCoordinates( coord);
+            } else if ( parentItem.represents( kmlTag_Point ) ) {
+                // photo overlay
+                parentItem.nodeAs<GeoDataPoint>()->setCoordinates( coord );
+            } else if ( parentItem.represents( kmlTag_LatLonQuad ) ) {
+                switch ( coordinatesIndex ) {
+                case 0:
+                    parentItem.nodeAs<GeoDataLatLonQuad>()->setBottomLeft( coord );
+                    break;
+                case 1:
+                    parentItem.nodeAs<GeoDataLatLonQuad>()->setBottomRight( coord );
+                    break;
+                case 2:
+                    parentItem.nodeAs<GeoDataLatLonQuad>()->setTopRight( coord );
+                    break;
+                case 3:
+                    parentItem.nodeAs<GeoDataLatLonQuad>()->setTopLeft( coord );
+                    break;
+                case 4:
+                    mDebug() << "Ignoring excessive coordinates in LatLonQuad (must not have more than 4 pairs)";
+                    break;
+                default:
+                    // Silently ignore any more coordinates
+                    break;
                 }
+            } else {
+                // raise warning as coordinates out of valid parents found
             }
 
             ++coordinatesIndex;
@@ -173,20 +330,25 @@ GeoNode* KmlcoordinatesTagHandler::parse( GeoParser& parser ) const
     }
 
     if( parentItem.represents( kmlTag_Track ) ) {
-        QString input = parser.readElementText().trimmed();
-        if ( !kmlStrictSpecs ) {
-            input = input.replace( QRegExp( "\\s*,\\s*" ), "," );
+        // gx:coord separates the values of its single tuple by whitespace instead of commas
+        const QString text = parser.readElementText();
+        CoordinatesTokenizer tokenizer( text, kmlStrictSpecs );
+        qreal values[3];
+        int count = 0;
+        while ( tokenizer.next() ) {
+            for ( int i = 0; i < tokenizer.fieldCount(); ++i ) {
+                if ( count < 3 && i < 3 ) {
+                    values[count] = tokenizer.field( i );
+                }
+                ++count;
+            }
         }
-        QStringList coordinates = input.split( ' ' );
 
         GeoDataCoordinates coord;
-        if ( coordinates.size() == 2 ) {
-            coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                       DEG2RAD * coordinates.at( 1 ).toDouble() );
-        } else if( coordinates.size() == 3 ) {
-            coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                       DEG2RAD * coordinates.at( 1 ).toDouble(),
-                       coordinates.at( 2 ).toDouble() );
+        if ( count == 2 ) {
+            coord.set( DEG2RAD * values[0], DEG2RAD * values[1] );
+        } else if( count == 3 ) {
+            coord.set( DEG2RAD * values[0], DEG2RAD * values[1], values[2] );
         }
         parentItem.nodeAs<GeoDataTrack>()->appendCoordinates( coord );
     }
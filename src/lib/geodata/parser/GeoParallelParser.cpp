@@ -0,0 +1,539 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "GeoParallelParser.h"
+
+#include "GeoDataContainer.h"
+#include "GeoDataDocument.h"
+#include "GeoDataStyle.h"
+#include "GeoDataStyleMap.h"
+#include "GeoDataTypes.h"
+#include "GeoParser.h"
+#include "MarbleDebug.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QObject>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QTime>
+#include <QVector>
+
+#include <cctype>
+#include <climits>
+#include <cstring>
+
+namespace Marble
+{
+
+/**
+ * A start tag in the raw input which was not closed yet at some position
+ */
+struct GeoParallelParserElement
+{
+    GeoParallelParserElement() :
+        begin( 0 ),
+        length( 0 ),
+        nameLength( 0 ),
+        isBoundary( false )
+    {
+    }
+
+    qint64 begin;
+    int length;
+    int nameLength;
+    bool isBoundary;
+};
+
+typedef QVector<GeoParallelParserElement> GeoParallelParserContext;
+
+struct GeoParallelParserChunk
+{
+    GeoParallelParserChunk() :
+        document( 0 )
+    {
+    }
+
+    GeoDataDocument *document;
+    QString error;
+};
+
+class GeoParallelParserPrivate
+{
+ public:
+    GeoParallelParserPrivate( GeoParallelParser *parent, const QByteArray &boundaryElement );
+
+    bool split();
+
+    qint64 findTagEnd( qint64 position ) const;
+    qint64 find( const char *pattern, qint64 position ) const;
+    bool startsWith( qint64 position, const char *pattern ) const;
+
+    QByteArray chunkData( int index ) const;
+
+    static void resolveStyles( GeoDataContainer *container );
+
+    GeoParallelParser *const q;
+    const QByteArray m_boundaryElement;
+    int m_threadCount;
+    int m_chunkSize;
+
+    const char *m_data;
+    qint64 m_size;
+    qint64 m_rootStart;
+    QVector<qint64> m_cuts;
+    QVector<GeoParallelParserContext> m_contexts;
+
+    GeoDataDocument *m_document;
+    QString m_errorString;
+};
+
+/**
+ * Parses a single chunk of the input
+ */
+class GeoParallelParserTask : public QRunnable
+{
+ public:
+    GeoParallelParserTask( const GeoParallelParserPrivate *parser, int index, GeoParallelParserChunk *chunk ) :
+        m_parser( parser ),
+        m_index( index ),
+        m_chunk( chunk )
+    {
+    }
+
+    virtual void run()
+    {
+        QByteArray data = m_parser->chunkData( m_index );
+        QBuffer buffer( &data );
+        buffer.open( QIODevice::ReadOnly );
+
+        GeoParser *parser = m_parser->q->createParser();
+        const bool success = parser->read( &buffer );
+        GeoDataDocument *document = static_cast<GeoDataDocument*>( parser->releaseDocument() );
+        if ( success ) {
+            m_chunk->document = document;
+        } else {
+            m_chunk->error = parser->errorString();
+            delete document;
+        }
+        delete parser;
+    }
+
+ private:
+    const GeoParallelParserPrivate *const m_parser;
+    const int m_index;
+    GeoParallelParserChunk *const m_chunk;
+};
+
+GeoParallelParserPrivate::GeoParallelParserPrivate( GeoParallelParser *parent, const QByteArray &boundaryElement ) :
+    q( parent ),
+    m_boundaryElement( boundaryElement ),
+    m_threadCount( QThread::idealThreadCount() ),
+    m_chunkSize( 4 * 1024 * 1024 ),
+    m_data( 0 ),
+    m_size( 0 ),
+    m_rootStart( 0 ),
+    m_document( 0 )
+{
+}
+
+bool GeoParallelParserPrivate::startsWith( qint64 position, const char *pattern ) const
+{
+    const int length = qstrlen( pattern );
+    return position + length <= m_size && memcmp( m_data + position, pattern, length ) == 0;
+}
+
+qint64 GeoParallelParserPrivate::find( const char *pattern, qint64 position ) const
+{
+    const int length = qstrlen( pattern );
+    while ( position + length <= m_size ) {
+        const char *candidate = static_cast<const char*>( memchr( m_data + position, pattern[0], m_size - position ) );
+        if ( !candidate ) {
+            return -1;
+        }
+        position = candidate - m_data;
+        if ( startsWith( position, pattern ) ) {
+            return position;
+        }
+        ++position;
+    }
+    return -1;
+}
+
+qint64 GeoParallelParserPrivate::findTagEnd( qint64 position ) const
+{
+    char quote = 0;
+    for ( ; position < m_size; ++position ) {
+        const char c = m_data[position];
+        if ( quote ) {
+            if ( c == quote ) {
+                quote = 0;
+            }
+        } else if ( c == '"' || c == '\'' ) {
+            quote = c;
+        } else if ( c == '>' ) {
+            return position;
+        }
+    }
+    return -1;
+}
+
+bool GeoParallelParserPrivate::split()
+{
+    m_cuts.clear();
+    m_contexts.clear();
+    m_rootStart = -1;
+
+    m_cuts << 0;
+    m_contexts << GeoParallelParserContext();
+
+    // Only ASCII compatible encodings can be split on the byte level
+    if ( m_size < 4 || m_data[0] == '\0' || m_data[1] == '\0'
+         || ( uchar( m_data[0] ) == 0xFF && uchar( m_data[1] ) == 0xFE )
+         || ( uchar( m_data[0] ) == 0xFE && uchar( m_data[1] ) == 0xFF ) ) {
+        m_cuts << m_size;
+        m_contexts << GeoParallelParserContext();
+        return false;
+    }
+
+    GeoParallelParserContext stack;
+    int boundaryDepth = 0;
+    qint64 chunkStart = 0;
+    qint64 position = 0;
+
+    while ( position < m_size ) {
+        const char *next = static_cast<const char*>( memchr( m_data + position, '<', m_size - position ) );
+        if ( !next ) {
+            position = m_size;
+            break;
+        }
+
+        const qint64 tagStart = next - m_data;
+        qint64 tagEnd = -1;
+
+        if ( startsWith( tagStart, "<!--" ) ) {
+            tagEnd = find( "-->", tagStart + 4 );
+            position = tagEnd + 3;
+        } else if ( startsWith( tagStart, "<![CDATA[" ) ) {
+            tagEnd = find( "]]>", tagStart + 9 );
+            position = tagEnd + 3;
+        } else if ( startsWith( tagStart, "<?" ) ) {
+            tagEnd = find( "?>", tagStart + 2 );
+            position = tagEnd + 2;
+        } else if ( startsWith( tagStart, "<!" ) ) {
+            tagEnd = findTagEnd( tagStart + 2 );
+            position = tagEnd + 1;
+        } else if ( startsWith( tagStart, "</" ) ) {
+            tagEnd = findTagEnd( tagStart + 2 );
+            position = tagEnd + 1;
+            if ( stack.isEmpty() ) {
+                break;
+            }
+            if ( stack.last().isBoundary ) {
+                --boundaryDepth;
+            }
+            stack.pop_back();
+        } else {
+            tagEnd = findTagEnd( tagStart + 1 );
+            position = tagEnd + 1;
+            if ( tagEnd < 0 ) {
+                break;
+            }
+
+            qint64 nameEnd = tagStart + 1;
+            while ( nameEnd < tagEnd && !isspace( uchar( m_data[nameEnd] ) ) && m_data[nameEnd] != '/' ) {
+                ++nameEnd;
+            }
+
+            // compare the local name, ignoring any namespace prefix
+            qint64 localNameStart = nameEnd;
+            while ( localNameStart > tagStart + 1 && m_data[localNameStart - 1] != ':' ) {
+                --localNameStart;
+            }
+            const bool isBoundary = nameEnd - localNameStart == m_boundaryElement.size()
+                                    && memcmp( m_data + localNameStart, m_boundaryElement.constData(), m_boundaryElement.size() ) == 0;
+
+            if ( m_rootStart < 0 ) {
+                m_rootStart = tagStart;
+            }
+
+            if ( isBoundary && boundaryDepth == 0 && !stack.isEmpty() && tagStart - chunkStart >= m_chunkSize ) {
+                m_cuts << tagStart;
+                m_contexts << stack;
+                chunkStart = tagStart;
+            }
+
+            if ( m_data[tagEnd - 1] != '/' ) {
+                GeoParallelParserElement element;
+                element.begin = tagStart;
+                element.length = tagEnd + 1 - tagStart;
+                element.nameLength = nameEnd - tagStart - 1;
+                element.isBoundary = isBoundary;
+                stack.append( element );
+                if ( isBoundary ) {
+                    ++boundaryDepth;
+                }
+            }
+        }
+
+        if ( tagEnd < 0 ) {
+            break;
+        }
+    }
+
+    const bool success = position >= m_size && stack.isEmpty() && m_rootStart >= 0;
+    if ( !success ) {
+        // Malformed input. Parse it in one piece to get a proper error message.
+        m_cuts.resize( 1 );
+        m_contexts.resize( 1 );
+    }
+
+    m_cuts << m_size;
+    m_contexts << GeoParallelParserContext();
+
+    return success;
+}
+
+QByteArray GeoParallelParserPrivate::chunkData( int index ) const
+{
+    const qint64 begin = m_cuts.at( index );
+    const qint64 end = m_cuts.at( index + 1 );
+
+    if ( m_cuts.size() == 2 ) {
+        return QByteArray::fromRawData( m_data, int( m_size ) );
+    }
+
+    const GeoParallelParserContext &context = m_contexts.at( index );
+    const GeoParallelParserContext &open = m_contexts.at( index + 1 );
+
+    int size = int( end - begin );
+    if ( index > 0 ) {
+        size += int( m_rootStart );
+    }
+    foreach( const GeoParallelParserElement &element, context ) {
+        size += element.length;
+    }
+    foreach( const GeoParallelParserElement &element, open ) {
+        size += element.nameLength + 3;
+    }
+
+    QByteArray result;
+    result.reserve( size );
+
+    if ( index > 0 ) {
+        // XML declaration and anything else before the root element
+        result.append( m_data, int( m_rootStart ) );
+    }
+    foreach( const GeoParallelParserElement &element, context ) {
+        result.append( m_data + element.begin, element.length );
+    }
+
+    result.append( m_data + begin, int( end - begin ) );
+
+    for ( int i = open.size() - 1; i >= 0; --i ) {
+        result.append( "</" );
+        result.append( m_data + open.at( i ).begin + 1, open.at( i ).nameLength );
+        result.append( '>' );
+    }
+
+    return result;
+}
+
+void GeoParallelParserPrivate::resolveStyles( GeoDataContainer *container )
+{
+    foreach( GeoDataFeature *feature, container->featureList() ) {
+        if ( !feature->styleUrl().isEmpty() ) {
+            feature->setStyleUrl( feature->styleUrl() );
+        }
+
+        if ( feature->nodeType() == GeoDataTypes::GeoDataDocumentType
+             || feature->nodeType() == GeoDataTypes::GeoDataFolderType ) {
+            resolveStyles( static_cast<GeoDataContainer*>( feature ) );
+        }
+    }
+}
+
+GeoParallelParser::GeoParallelParser( const QByteArray &boundaryElement ) :
+    d( new GeoParallelParserPrivate( this, boundaryElement ) )
+{
+}
+
+GeoParallelParser::~GeoParallelParser()
+{
+    delete d->m_document;
+    delete d;
+}
+
+void GeoParallelParser::setThreadCount( int threads )
+{
+    d->m_threadCount = qMax( 1, threads );
+}
+
+int GeoParallelParser::threadCount() const
+{
+    return d->m_threadCount;
+}
+
+void GeoParallelParser::setChunkSize( int bytes )
+{
+    d->m_chunkSize = qMax( 1, bytes );
+}
+
+int GeoParallelParser::chunkSize() const
+{
+    return d->m_chunkSize;
+}
+
+int GeoParallelParser::chunkCount() const
+{
+    return qMax( 0, d->m_cuts.size() - 1 );
+}
+
+bool GeoParallelParser::read( QIODevice *device )
+{
+    Q_ASSERT( !d->m_document );
+    d->m_errorString.clear();
+
+    QTime timer;
+    timer.start();
+
+    QByteArray buffer;
+    uchar *mapped = 0;
+    QFile *file = qobject_cast<QFile*>( device );
+    if ( file && file->size() > 0 ) {
+        mapped = file->map( 0, file->size() );
+    }
+
+    if ( mapped ) {
+        d->m_data = reinterpret_cast<const char*>( mapped );
+        d->m_size = file->size();
+    } else {
+        buffer = device->readAll();
+        d->m_data = buffer.constData();
+        d->m_size = buffer.size();
+    }
+
+    d->split();
+    const int splitTime = timer.elapsed();
+
+    const int count = chunkCount();
+    if ( count == 1 && d->m_size > INT_MAX ) {
+        if ( mapped ) {
+            file->unmap( mapped );
+        }
+        d->m_errorString = QObject::tr( "The file is too large to be parsed in one piece." );
+        return false;
+    }
+    QVector<GeoParallelParserChunk> chunks( count );
+
+    QThreadPool pool;
+    pool.setMaxThreadCount( d->m_threadCount );
+    for ( int i = 0; i < count; ++i ) {
+        pool.start( new GeoParallelParserTask( d, i, &chunks[i] ) );
+    }
+    pool.waitForDone();
+    const int parseTime = timer.elapsed();
+
+    if ( mapped ) {
+        file->unmap( mapped );
+    }
+    d->m_data = 0;
+    d->m_size = 0;
+
+    for ( int i = 0; i < count; ++i ) {
+        if ( !chunks[i].document ) {
+            d->m_errorString = chunks[i].error;
+            for ( int j = 0; j < count; ++j ) {
+                delete chunks[j].document;
+            }
+            return false;
+        }
+    }
+
+    GeoDataDocument *document = chunks[0].document;
+    for ( int i = 1; i < count; ++i ) {
+        mergeDocument( document, chunks[i].document );
+        delete chunks[i].document;
+    }
+    GeoParallelParserPrivate::resolveStyles( document );
+
+    d->m_document = document;
+
+    mDebug() << "Parsed" << count << "chunks on" << d->m_threadCount << "threads:"
+             << "split" << splitTime << "ms, parse" << parseTime - splitTime
+             << "ms, merge" << timer.elapsed() - parseTime << "ms";
+
+    return true;
+}
+
+GeoDataDocument *GeoParallelParser::releaseDocument()
+{
+    GeoDataDocument *document = d->m_document;
+    d->m_document = 0;
+    return document;
+}
+
+QString GeoParallelParser::errorString() const
+{
+    return d->m_errorString;
+}
+
+void GeoParallelParser::mergeDocument( GeoDataDocument *document, GeoDataDocument *chunk ) const
+{
+    mergeContainer( document, chunk );
+}
+
+void GeoParallelParser::mergeContainer( GeoDataContainer *target, GeoDataContainer *source )
+{
+    if ( target->nodeType() == GeoDataTypes::GeoDataDocumentType
+         && source->nodeType() == GeoDataTypes::GeoDataDocumentType ) {
+        GeoDataDocument *targetDocument = static_cast<GeoDataDocument*>( target );
+        const GeoDataDocument *sourceDocument = static_cast<const GeoDataDocument*>( source );
+        foreach( const GeoDataStyle &style, sourceDocument->styles() ) {
+            // skip placeholders created by lookups of styles defined in other chunks
+            if ( !style.styleId().isEmpty() ) {
+                targetDocument->addStyle( style );
+            }
+        }
+        foreach( const GeoDataStyleMap &styleMap, sourceDocument->styleMaps() ) {
+            if ( !styleMap.styleId().isEmpty() ) {
+                targetDocument->addStyleMap( styleMap );
+            }
+        }
+    }
+
+    if ( source->size() == 0 ) {
+        return;
+    }
+
+    // The chunk starts with a boundary element, so a leading container can only
+    // stem from the start tags the chunk was wrapped into. It continues the
+    // trailing container of the target.
+    GeoDataFeature *first = source->child( 0 );
+    GeoDataFeature *last = target->size() > 0 ? target->child( target->size() - 1 ) : 0;
+    int index = 0;
+    if ( last && first->nodeType() == last->nodeType()
+         && ( first->nodeType() == GeoDataTypes::GeoDataDocumentType
+              || first->nodeType() == GeoDataTypes::GeoDataFolderType ) ) {
+        mergeContainer( static_cast<GeoDataContainer*>( last ), static_cast<GeoDataContainer*>( first ) );
+        index = 1;
+    }
+
+    const QVector<GeoDataFeature*> features = source->featureList();
+    for ( int i = features.size() - 1; i >= index; --i ) {
+        source->remove( i );
+    }
+    for ( int i = index; i < features.size(); ++i ) {
+        target->append( features.at( i ) );
+    }
+}
+
+}
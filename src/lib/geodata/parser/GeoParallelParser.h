@@ -0,0 +1,115 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef MARBLE_GEOPARALLELPARSER_H
+#define MARBLE_GEOPARALLELPARSER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "geodata_export.h"
+
+class QIODevice;
+
+namespace Marble
+{
+
+class GeoDataContainer;
+class GeoDataDocument;
+class GeoParser;
+class GeoParallelParserPrivate;
+
+/**
+ * @brief Parses large XML documents in chunks on several threads
+ *
+ * The input is split right before top level occurrences of a boundary element,
+ * e.g. \<Placemark\> for KML. Each chunk is wrapped into the start tags of the
+ * elements enclosing it and the matching end tags, so that it forms a
+ * well-formed document on its own. Chunks are parsed concurrently, each by its
+ * own GeoParser created by createParser(), and the resulting documents are
+ * merged in document order by mergeDocument(). Styles of all chunks end up in
+ * the resulting document, and style urls are resolved against it once all
+ * chunks are merged.
+ *
+ * Splitting works on the raw bytes and therefore requires an ASCII compatible
+ * encoding like UTF-8. Input in other encodings is parsed as a single chunk.
+ */
+class GEODATA_EXPORT GeoParallelParser
+{
+ public:
+    /**
+     * @param boundaryElement the local name of the element to split the input at
+     */
+    explicit GeoParallelParser( const QByteArray &boundaryElement );
+    virtual ~GeoParallelParser();
+
+    /**
+     * @brief Sets the number of threads used for parsing. Defaults to the number of cores.
+     */
+    void setThreadCount( int threads );
+    int threadCount() const;
+
+    /**
+     * @brief Sets the size in bytes each chunk should have at least. Defaults to 4 MB.
+     */
+    void setChunkSize( int bytes );
+    int chunkSize() const;
+
+    /**
+     * @brief Reads and parses all data of @p device
+     * Files are mapped into memory instead of being read, if possible.
+     * @return true if all chunks were parsed successfully
+     */
+    bool read( QIODevice *device );
+
+    /**
+     * @brief Returns the number of chunks the input of the last read() was split into
+     */
+    int chunkCount() const;
+
+    /**
+     * @brief Returns the parsed document and passes its ownership to the caller
+     */
+    GeoDataDocument *releaseDocument();
+
+    QString errorString() const;
+
+ protected:
+    /**
+     * @brief Creates a new parser for one chunk. Called from worker threads.
+     */
+    virtual GeoParser *createParser() const = 0;
+
+    /**
+     * @brief Moves the features of @p chunk to the end of @p document
+     *
+     * All chunks but the first start inside of the elements that were still open
+     * at the end of the previous chunk. The default implementation therefore merges
+     * the leading containers of @p chunk into the trailing containers of
+     * @p document, level by level, and appends all other features.
+     */
+    virtual void mergeDocument( GeoDataDocument *document, GeoDataDocument *chunk ) const;
+
+    /**
+     * @brief Moves the features of @p source to the end of @p target, continuing
+     * the trailing container of @p target with the leading container of @p source.
+     */
+    static void mergeContainer( GeoDataContainer *target, GeoDataContainer *source );
+
+ private:
+    Q_DISABLE_COPY( GeoParallelParser )
+
+    friend class GeoParallelParserPrivate;
+    GeoParallelParserPrivate * const d;
+};
+
+}
+
+#endif
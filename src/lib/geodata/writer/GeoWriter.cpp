@@ -16,6 +16,8 @@
 
 #include "MarbleDebug.h"
 
+#include <cmath>
+
 namespace Marble
 {
 
@@ -31,9 +33,24 @@ bool GeoWriter::write(QIODevice* device, const GeoNode *feature)
     setAutoFormatting( true );
     writeStartDocument();
 
+    if( ! writeRootElement() ) {
+        return false;
+    }
+    
+    if( ! writeElement( feature ) ) {
+        return false;
+    }
+    
+    //close the document
+    writeEndElement();
+    return true;
+}
+
+bool GeoWriter::writeRootElement()
+{
     //FIXME: write the starting tags. Possibly register a tag handler to do this
     // with a null string as the object name?
-    
+
     GeoTagWriter::QualifiedName name( "", m_documentType );
     const GeoTagWriter* writer = GeoTagWriter::recognizes(name);
     if( writer ) {
@@ -45,13 +62,7 @@ bool GeoWriter::write(QIODevice* device, const GeoNode *feature)
         mDebug() << "There is no GeoWriter registered for: " << name;
         return false;
     }
-    
-    if( ! writeElement( feature ) ) {
-        return false;
-    }
-    
-    //close the document
-    writeEndElement();
+
     return true;
 }
 
@@ -102,4 +113,42 @@ void GeoWriter::writeOptionalElement( const QString &key, const QString &value,
     }
 }
 
+void GeoWriter::appendNumber( QByteArray &buffer, qreal value, int precision )
+{
+    static const qreal powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+                                         1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+    Q_ASSERT( precision >= 0 && precision <= 15 );
+
+    // Scaling introduces a rounding error of about one ulp, which only matters
+    // if the scaled value is close to the middle of two integers. Leave these
+    // and values exceeding the mantissa to the exact conversion.
+    const qreal scaled = qAbs( value ) * powersOfTen[precision];
+    const qreal whole = std::floor( scaled );
+    if ( !( scaled < 9007199254740992.0 ) || qAbs( scaled - whole - 0.5 ) < scaled * 4e-16 ) {
+        buffer += QByteArray::number( value, 'f', precision );
+        return;
+    }
+
+    quint64 digits = quint64( whole ) + ( scaled - whole > 0.5 ? 1 : 0 );
+
+    char text[32];
+    int position = sizeof( text );
+    for ( int i = 0; i < precision; ++i ) {
+        text[--position] = '0' + digits % 10;
+        digits /= 10;
+    }
+    if ( precision > 0 ) {
+        text[--position] = '.';
+    }
+    do {
+        text[--position] = '0' + digits % 10;
+        digits /= 10;
+    } while ( digits > 0 );
+    if ( value < 0.0 ) {
+        text[--position] = '-';
+    }
+
+    buffer.append( text + position, sizeof( text ) - position );
+}
+
 }
@@ -66,8 +66,20 @@ public:
      **/
     void writeOptionalElement(const QString &key, const QString &value , const QString &defaultValue = QString() );
 
+    /**
+     * @brief Appends @p value with @p precision digits after the decimal point to @p buffer
+     *
+     * Produces the same text as QString::number( value, 'f', precision ) without
+     * creating a string per number. This matters when writing millions of
+     * coordinates.
+     * @p precision must not exceed 15.
+     */
+    static void appendNumber( QByteArray &buffer, qreal value, int precision );
+
 private:
     friend class GeoTagWriter;
+    friend class KmlStreamWriter;
+    bool writeRootElement();
     bool writeElement( const GeoNode* object );
 
 private:
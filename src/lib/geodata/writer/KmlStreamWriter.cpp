@@ -0,0 +1,515 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "KmlStreamWriter.h"
+
+#include "GeoWriter.h"
+#include "KmlElementDictionary.h"
+#include "MarbleDebug.h"
+
+#include <QDateTime>
+#include <QIODevice>
+
+#include <cstring>
+
+#ifdef MARBLE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace Marble
+{
+
+/**
+ * Collects the output of the XML writer, which arrives in tiny pieces, and
+ * passes it on to the target device in large blocks. For KMZ output the
+ * blocks are wrapped into a ZIP archive on the fly. The sizes and the
+ * checksum of the single archive entry are only known in the end, hence
+ * they are stored in a data descriptor behind the entry.
+ */
+class KmlOutputDevice : public QIODevice
+{
+ public:
+    KmlOutputDevice();
+    ~KmlOutputDevice();
+
+    bool start( QIODevice *target, KmlStreamWriter::Compression compression, int bufferSize );
+    bool finish();
+
+    qint64 targetSize() const;
+    bool hasFailed() const;
+    bool isSequential() const;
+
+ protected:
+    qint64 readData( char *data, qint64 maxSize );
+    qint64 writeData( const char *data, qint64 length );
+
+ private:
+    bool flushBuffer( bool last );
+    bool writeToTarget( const char *data, qint64 length );
+    quint32 updateCrc( quint32 crc, const QByteArray &data ) const;
+    void appendEntryInfo( QByteArray &header, quint32 crc, quint32 compressedSize, quint32 uncompressedSize ) const;
+
+    static void appendLittleEndian( QByteArray &data, quint32 value, int bytes );
+
+    QIODevice *m_target;
+    KmlStreamWriter::Compression m_compression;
+    int m_bufferSize;
+    QByteArray m_buffer;
+    qint64 m_bytesWritten;
+    bool m_failed;
+
+    quint16 m_method;
+    quint16 m_dosTime;
+    quint16 m_dosDate;
+    quint32 m_crc;
+    quint64 m_compressedSize;
+    quint64 m_uncompressedSize;
+
+#ifdef MARBLE_HAVE_ZLIB
+    z_stream m_stream;
+    bool m_deflating;
+    QByteArray m_compressed;
+#endif
+};
+
+static const char kmzEntryName[] = "doc.kml";
+
+KmlOutputDevice::KmlOutputDevice() :
+    m_target( 0 ),
+    m_compression( KmlStreamWriter::Uncompressed ),
+    m_bufferSize( 0 ),
+    m_bytesWritten( 0 ),
+    m_failed( false ),
+    m_method( 0 ),
+    m_dosTime( 0 ),
+    m_dosDate( 0 ),
+    m_crc( 0 ),
+    m_compressedSize( 0 ),
+    m_uncompressedSize( 0 )
+#ifdef MARBLE_HAVE_ZLIB
+    , m_deflating( false )
+#endif
+{
+}
+
+KmlOutputDevice::~KmlOutputDevice()
+{
+#ifdef MARBLE_HAVE_ZLIB
+    if ( m_deflating ) {
+        deflateEnd( &m_stream );
+    }
+#endif
+}
+
+bool KmlOutputDevice::start( QIODevice *target, KmlStreamWriter::Compression compression, int bufferSize )
+{
+    m_target = target;
+    m_compression = compression;
+    m_bufferSize = bufferSize;
+    m_buffer.clear();
+    m_buffer.reserve( bufferSize );
+    m_bytesWritten = 0;
+    m_failed = false;
+    setErrorString( QString() );
+
+    if ( m_compression == KmlStreamWriter::Kmz ) {
+        m_crc = 0;
+        m_compressedSize = 0;
+        m_uncompressedSize = 0;
+        m_method = 0; // stored
+
+#ifdef MARBLE_HAVE_ZLIB
+        // a raw deflate stream as used by ZIP archives, i.e. without zlib header
+        memset( &m_stream, 0, sizeof( m_stream ) );
+        if ( deflateInit2( &m_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY ) == Z_OK ) {
+            m_deflating = true;
+            m_method = 8; // deflated
+            m_compressed.resize( bufferSize );
+        } else {
+            mDebug() << "Failed to initialize zlib, writing an uncompressed KMZ archive";
+        }
+#endif
+
+        const QDateTime now = QDateTime::currentDateTime();
+        m_dosTime = ( now.time().hour() << 11 ) | ( now.time().minute() << 5 ) | ( now.time().second() / 2 );
+        m_dosDate = ( qMax( 0, now.date().year() - 1980 ) << 9 ) | ( now.date().month() << 5 ) | now.date().day();
+
+        QByteArray header;
+        appendLittleEndian( header, 0x04034b50, 4 );    // local file header signature
+        appendLittleEndian( header, 20, 2 );            // version needed to extract
+        appendEntryInfo( header, 0, 0, 0 );
+        appendLittleEndian( header, 0, 2 );             // extra field length
+        header += kmzEntryName;
+        if ( !writeToTarget( header.constData(), header.size() ) ) {
+            return false;
+        }
+    }
+
+    return open( QIODevice::WriteOnly );
+}
+
+bool KmlOutputDevice::finish()
+{
+    bool success = flushBuffer( true );
+
+    if ( success && m_compression == KmlStreamWriter::Kmz ) {
+        if ( m_compressedSize > 0xffffffffu || m_uncompressedSize > 0xffffffffu ) {
+            setErrorString( QObject::tr( "KMZ archives larger than 4 GB are not supported" ) );
+            success = false;
+        } else {
+            const quint64 entrySize = m_bytesWritten;
+
+            QByteArray trailer;
+            appendLittleEndian( trailer, 0x08074b50, 4 );   // data descriptor signature
+            appendLittleEndian( trailer, m_crc, 4 );
+            appendLittleEndian( trailer, m_compressedSize, 4 );
+            appendLittleEndian( trailer, m_uncompressedSize, 4 );
+
+            const int directoryOffset = trailer.size();
+            appendLittleEndian( trailer, 0x02014b50, 4 );   // central file header signature
+            appendLittleEndian( trailer, 20, 2 );           // version made by
+            appendLittleEndian( trailer, 20, 2 );           // version needed to extract
+            appendEntryInfo( trailer, m_crc, m_compressedSize, m_uncompressedSize );
+            appendLittleEndian( trailer, 0, 2 );            // extra field length
+            appendLittleEndian( trailer, 0, 2 );            // file comment length
+            appendLittleEndian( trailer, 0, 2 );            // disk number start
+            appendLittleEndian( trailer, 0, 2 );            // internal file attributes
+            appendLittleEndian( trailer, 0, 4 );            // external file attributes
+            appendLittleEndian( trailer, 0, 4 );            // offset of local header
+            trailer += kmzEntryName;
+            const int directorySize = trailer.size() - directoryOffset;
+
+            appendLittleEndian( trailer, 0x06054b50, 4 );   // end of central directory signature
+            appendLittleEndian( trailer, 0, 2 );            // number of this disk
+            appendLittleEndian( trailer, 0, 2 );            // disk with the central directory
+            appendLittleEndian( trailer, 1, 2 );            // entries on this disk
+            appendLittleEndian( trailer, 1, 2 );            // entries in total
+            appendLittleEndian( trailer, directorySize, 4 );
+            appendLittleEndian( trailer, entrySize + directoryOffset, 4 );
+            appendLittleEndian( trailer, 0, 2 );            // comment length
+
+            success = writeToTarget( trailer.constData(), trailer.size() );
+        }
+    }
+
+#ifdef MARBLE_HAVE_ZLIB
+    if ( m_deflating ) {
+        deflateEnd( &m_stream );
+        m_deflating = false;
+    }
+#endif
+
+    close();
+    m_buffer.clear();
+    m_target = 0;
+
+    return success;
+}
+
+qint64 KmlOutputDevice::targetSize() const
+{
+    return m_bytesWritten;
+}
+
+bool KmlOutputDevice::hasFailed() const
+{
+    return m_failed;
+}
+
+bool KmlOutputDevice::isSequential() const
+{
+    return true;
+}
+
+qint64 KmlOutputDevice::readData( char *data, qint64 maxSize )
+{
+    Q_UNUSED( data );
+    Q_UNUSED( maxSize );
+    return -1;
+}
+
+qint64 KmlOutputDevice::writeData( const char *data, qint64 length )
+{
+    if ( m_failed ) {
+        return -1;
+    }
+
+    m_buffer.append( data, length );
+    if ( m_buffer.size() >= m_bufferSize && !flushBuffer( false ) ) {
+        return -1;
+    }
+
+    return length;
+}
+
+bool KmlOutputDevice::flushBuffer( bool last )
+{
+    if ( m_failed ) {
+        return false;
+    }
+
+    if ( m_compression == KmlStreamWriter::Uncompressed ) {
+        const bool success = writeToTarget( m_buffer.constData(), m_buffer.size() );
+        m_buffer.clear();
+        return success;
+    }
+
+    m_crc = updateCrc( m_crc, m_buffer );
+    m_uncompressedSize += m_buffer.size();
+
+#ifdef MARBLE_HAVE_ZLIB
+    if ( m_deflating ) {
+        m_stream.next_in = reinterpret_cast<Bytef*>( m_buffer.data() );
+        m_stream.avail_in = m_buffer.size();
+        do {
+            m_stream.next_out = reinterpret_cast<Bytef*>( m_compressed.data() );
+            m_stream.avail_out = m_compressed.size();
+            if ( deflate( &m_stream, last ? Z_FINISH : Z_NO_FLUSH ) == Z_STREAM_ERROR ) {
+                setErrorString( QObject::tr( "Failed to compress the KMZ archive" ) );
+                m_failed = true;
+                return false;
+            }
+            const int produced = m_compressed.size() - m_stream.avail_out;
+            m_compressedSize += produced;
+            if ( !writeToTarget( m_compressed.constData(), produced ) ) {
+                return false;
+            }
+        } while ( m_stream.avail_out == 0 );
+
+        m_buffer.clear();
+        return true;
+    }
+#else
+    Q_UNUSED( last );
+#endif
+
+    m_compressedSize += m_buffer.size();
+    const bool success = writeToTarget( m_buffer.constData(), m_buffer.size() );
+    m_buffer.clear();
+    return success;
+}
+
+bool KmlOutputDevice::writeToTarget( const char *data, qint64 length )
+{
+    if ( length == 0 ) {
+        return true;
+    }
+
+    if ( m_target->write( data, length ) != length ) {
+        setErrorString( m_target->errorString() );
+        m_failed = true;
+        return false;
+    }
+
+    m_bytesWritten += length;
+    return true;
+}
+
+quint32 KmlOutputDevice::updateCrc( quint32 crc, const QByteArray &data ) const
+{
+#ifdef MARBLE_HAVE_ZLIB
+    return crc32( crc, reinterpret_cast<const Bytef*>( data.constData() ), data.size() );
+#else
+    static quint32 table[256];
+    static bool tableInitialized = false;
+    if ( !tableInitialized ) {
+        for ( quint32 i = 0; i < 256; ++i ) {
+            quint32 value = i;
+            for ( int bit = 0; bit < 8; ++bit ) {
+                value = ( value & 1 ) ? 0xedb88320u ^ ( value >> 1 ) : value >> 1;
+            }
+            table[i] = value;
+        }
+        tableInitialized = true;
+    }
+
+    crc = ~crc;
+    const uchar *bytes = reinterpret_cast<const uchar*>( data.constData() );
+    for ( int i = 0; i < data.size(); ++i ) {
+        crc = table[( crc ^ bytes[i] ) & 0xff] ^ ( crc >> 8 );
+    }
+    return ~crc;
+#endif
+}
+
+void KmlOutputDevice::appendEntryInfo( QByteArray &header, quint32 crc, quint32 compressedSize, quint32 uncompressedSize ) const
+{
+    appendLittleEndian( header, 0x0008, 2 );        // flags: sizes and checksum in data descriptor
+    appendLittleEndian( header, m_method, 2 );
+    appendLittleEndian( header, m_dosTime, 2 );
+    appendLittleEndian( header, m_dosDate, 2 );
+    appendLittleEndian( header, crc, 4 );
+    appendLittleEndian( header, compressedSize, 4 );
+    appendLittleEndian( header, uncompressedSize, 4 );
+    appendLittleEndian( header, sizeof( kmzEntryName ) - 1, 2 );
+}
+
+void KmlOutputDevice::appendLittleEndian( QByteArray &data, quint32 value, int bytes )
+{
+    for ( int i = 0; i < bytes; ++i ) {
+        data += char( ( value >> ( 8 * i ) ) & 0xff );
+    }
+}
+
+class KmlStreamWriterPrivate
+{
+ public:
+    KmlStreamWriterPrivate();
+
+    void setError( const QString &error );
+
+    KmlStreamWriter::Compression m_compression;
+    int m_bufferSize;
+    bool m_isOpen;
+    QString m_errorString;
+
+    KmlOutputDevice m_device;
+    GeoWriter m_writer;
+};
+
+KmlStreamWriterPrivate::KmlStreamWriterPrivate() :
+    m_compression( KmlStreamWriter::Uncompressed ),
+    m_bufferSize( 64 * 1024 ),
+    m_isOpen( false )
+{
+}
+
+void KmlStreamWriterPrivate::setError( const QString &error )
+{
+    m_errorString = error;
+    mDebug() << "KmlStreamWriter:" << error;
+}
+
+KmlStreamWriter::KmlStreamWriter() :
+    d( new KmlStreamWriterPrivate )
+{
+}
+
+KmlStreamWriter::~KmlStreamWriter()
+{
+    if ( d->m_isOpen ) {
+        close();
+    }
+    delete d;
+}
+
+void KmlStreamWriter::setCompression( Compression compression )
+{
+    d->m_compression = compression;
+}
+
+KmlStreamWriter::Compression KmlStreamWriter::compression() const
+{
+    return d->m_compression;
+}
+
+void KmlStreamWriter::setBufferSize( int bytes )
+{
+    d->m_bufferSize = qMax( 1, bytes );
+}
+
+int KmlStreamWriter::bufferSize() const
+{
+    return d->m_bufferSize;
+}
+
+bool KmlStreamWriter::open( QIODevice *device, const QString &name )
+{
+    if ( d->m_isOpen ) {
+        d->setError( QObject::tr( "The document is already open" ) );
+        return false;
+    }
+
+    if ( !device || !device->isWritable() ) {
+        d->setError( QObject::tr( "The device is not open for writing" ) );
+        return false;
+    }
+
+    d->m_errorString.clear();
+    if ( !d->m_device.start( device, d->m_compression, d->m_bufferSize ) ) {
+        d->setError( d->m_device.errorString() );
+        return false;
+    }
+
+    d->m_isOpen = true;
+    d->m_writer.setDocumentType( kml::kmlTag_nameSpace22 );
+    d->m_writer.setDevice( &d->m_device );
+    d->m_writer.setAutoFormatting( true );
+    d->m_writer.writeStartDocument();
+    if ( !d->m_writer.writeRootElement() ) {
+        d->setError( QObject::tr( "Failed to write the root element" ) );
+        return false;
+    }
+
+    d->m_writer.writeStartElement( kml::kmlTag_Document );
+    d->m_writer.writeOptionalElement( kml::kmlTag_name, name );
+
+    if ( d->m_device.hasFailed() ) {
+        d->setError( d->m_device.errorString() );
+        return false;
+    }
+
+    return true;
+}
+
+bool KmlStreamWriter::write( const GeoNode *node )
+{
+    if ( !d->m_isOpen ) {
+        d->setError( QObject::tr( "The document is not open" ) );
+        return false;
+    }
+
+    if ( !node ) {
+        return false;
+    }
+
+    if ( !d->m_writer.writeElement( node ) ) {
+        d->setError( QObject::tr( "Failed to write a node of type %1" ).arg( node->nodeType() ) );
+        return false;
+    }
+
+    if ( d->m_device.hasFailed() ) {
+        d->setError( d->m_device.errorString() );
+        return false;
+    }
+
+    return true;
+}
+
+bool KmlStreamWriter::close()
+{
+    if ( !d->m_isOpen ) {
+        return false;
+    }
+
+    // closes <Document> and <kml>
+    d->m_writer.writeEndDocument();
+    d->m_writer.setDevice( 0 );
+    d->m_isOpen = false;
+
+    if ( !d->m_device.finish() ) {
+        d->setError( d->m_device.errorString() );
+        return false;
+    }
+
+    return d->m_errorString.isEmpty();
+}
+
+qint64 KmlStreamWriter::bytesWritten() const
+{
+    return d->m_device.targetSize();
+}
+
+QString KmlStreamWriter::errorString() const
+{
+    return d->m_errorString;
+}
+
+}
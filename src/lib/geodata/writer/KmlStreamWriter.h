@@ -0,0 +1,140 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef MARBLE_KMLSTREAMWRITER_H
+#define MARBLE_KMLSTREAMWRITER_H
+
+#include <QString>
+
+#include "marble_export.h"
+
+class QIODevice;
+
+namespace Marble
+{
+
+class GeoNode;
+class KmlStreamWriterPrivate;
+
+/**
+ * @brief Writes KML documents whose features are passed one at a time
+ *
+ * GeoWriter::write() needs the complete document tree in memory. This writer
+ * serializes each feature as soon as it is passed to write() instead, so that
+ * it needs a constant amount of memory no matter how large the output gets.
+ * All features are written into a top level \<Document\>. Styles can be
+ * passed to write() as well and should precede the features using them.
+ *
+ * The output is buffered and written to the device in large blocks. It is
+ * optionally packed into a KMZ archive, which is compressed if Marble was
+ * built with zlib.
+ *
+ * @code
+ * QFile file( "track.kmz" );
+ * file.open( QIODevice::WriteOnly );
+ * KmlStreamWriter writer;
+ * writer.setCompression( KmlStreamWriter::Kmz );
+ * writer.open( &file, "Track" );
+ * writer.write( &style );
+ * writer.write( placemarks.constBegin(), placemarks.constEnd() );
+ * writer.close();
+ * @endcode
+ */
+class MARBLE_EXPORT KmlStreamWriter
+{
+ public:
+    enum Compression {
+        Uncompressed, ///< plain KML
+        Kmz           ///< a KMZ archive containing a single doc.kml
+    };
+
+    KmlStreamWriter();
+
+    /**
+     * @brief Destroys the writer, closing the document if still open
+     */
+    ~KmlStreamWriter();
+
+    /**
+     * @brief Sets the output format. Must be called before open().
+     */
+    void setCompression( Compression compression );
+    Compression compression() const;
+
+    /**
+     * @brief Sets the number of bytes buffered before writing to the device. Defaults to 64 kB.
+     */
+    void setBufferSize( int bytes );
+    int bufferSize() const;
+
+    /**
+     * @brief Starts writing a document named @p name to @p device
+     * The device must be open for writing and stays owned by the caller.
+     */
+    bool open( QIODevice *device, const QString &name = QString() );
+
+    /**
+     * @brief Writes @p node, usually a feature or a style, into the document
+     */
+    bool write( const GeoNode *node );
+
+    /**
+     * @brief Writes all nodes from @p begin to @p end, which iterate over pointers to nodes
+     */
+    template<typename Iterator>
+    bool write( Iterator begin, Iterator end )
+    {
+        for ( ; begin != end; ++begin ) {
+            if ( !write( *begin ) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Writes the nodes returned by calling @p next until it returns 0
+     *
+     * @p next is a function or a function object returning a pointer to a node.
+     * It may create the nodes on the fly, each of them can be deleted as soon as
+     * the next one is requested.
+     */
+    template<typename Generator>
+    bool writeFrom( Generator next )
+    {
+        while ( const GeoNode *node = next() ) {
+            if ( !write( node ) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Finishes the document and writes all buffered data to the device
+     */
+    bool close();
+
+    /**
+     * @brief Returns the number of bytes written to the device so far
+     */
+    qint64 bytesWritten() const;
+
+    QString errorString() const;
+
+ private:
+    Q_DISABLE_COPY( KmlStreamWriter )
+
+    KmlStreamWriterPrivate * const d;
+};
+
+}
+
+#endif
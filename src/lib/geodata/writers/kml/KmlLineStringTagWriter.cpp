@@ -23,6 +23,8 @@ static GeoTagWriterRegistrar s_writerLookAt(
                                  kml::kmlTag_nameSpace22 ),
     new KmlLineStringTagWriter );
 
+static const int chunkSize = 16 * 1024;
+
 bool KmlLineStringTagWriter::write( const GeoNode *node, GeoWriter& writer ) const
 {
     const GeoDataLineString *lineString = static_cast<const GeoDataLineString*>( node );
@@ -42,25 +44,31 @@ bool KmlLineStringTagWriter::write( const GeoNode *node, GeoWriter& writer ) con
             }
         }
 
+        // Collect the text in chunks instead of writing each number on its own
+        QByteArray text;
+        text.reserve( chunkSize + 64 );
         for ( int i = 0; i < lineString->size(); ++i ) {
-            GeoDataCoordinates coordinates = lineString->at( i );
+            const GeoDataCoordinates &coordinates = lineString->at( i );
             if ( i > 0 )
             {
-                writer.writeCharacters( " " );
+                text += ' ';
             }
 
-            qreal lon = coordinates.longitude( GeoDataCoordinates::Degree );
-            writer.writeCharacters( QString::number( lon, 'f', 10 ) );
-            writer.writeCharacters( "," );
-            qreal lat = coordinates.latitude( GeoDataCoordinates::Degree );
-            writer.writeCharacters( QString::number( lat, 'f', 10 ) );
+            GeoWriter::appendNumber( text, coordinates.longitude( GeoDataCoordinates::Degree ), 10 );
+            text += ',';
+            GeoWriter::appendNumber( text, coordinates.latitude( GeoDataCoordinates::Degree ), 10 );
 
             if ( hasAltitude ) {
-                qreal alt = coordinates.altitude();
-                writer.writeCharacters( "," );
-                writer.writeCharacters( QString::number( alt, 'f', 2 ) );
+                text += ',';
+                GeoWriter::appendNumber( text, coordinates.altitude(), 2 );
+            }
+
+            if ( text.size() >= chunkSize ) {
+                writer.writeCharacters( QString::fromLatin1( text.constData(), text.size() ) );
+                text.clear();
             }
         }
+        writer.writeCharacters( QString::fromLatin1( text.constData(), text.size() ) );
 
         writer.writeEndElement();
         writer.writeEndElement();
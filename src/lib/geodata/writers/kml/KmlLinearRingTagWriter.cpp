@@ -23,6 +23,8 @@ static GeoTagWriterRegistrar s_writerLookAt(
                                  kml::kmlTag_nameSpace22 ),
     new KmlLinearRingTagWriter );
 
+static const int chunkSize = 16 * 1024;
+
 bool KmlLinearRingTagWriter::write( const GeoNode *node, GeoWriter& writer ) const
 {
     const GeoDataLinearRing *ring = static_cast<const GeoDataLinearRing*>( node );
@@ -32,20 +34,26 @@ bool KmlLinearRingTagWriter::write( const GeoNode *node, GeoWriter& writer ) con
         writer.writeStartElement( kml::kmlTag_LinearRing );
         writer.writeStartElement( "coordinates" );
 
+        QByteArray text;
+        text.reserve( chunkSize + 64 );
         for ( int i = 0; i < ring->size(); ++i )
         {
-            GeoDataCoordinates coordinates = ring->at( i );
+            const GeoDataCoordinates &coordinates = ring->at( i );
             if ( i > 0 )
             {
-                writer.writeCharacters( " " );
+                text += ' ';
             }
 
-            qreal lon = coordinates.longitude( GeoDataCoordinates::Degree );
-            writer.writeCharacters( QString::number( lon, 'f', 10 ) );
-            writer.writeCharacters( "," );
-            qreal lat = coordinates.latitude( GeoDataCoordinates::Degree );
-            writer.writeCharacters( QString::number( lat, 'f', 10 ) );
+            GeoWriter::appendNumber( text, coordinates.longitude( GeoDataCoordinates::Degree ), 10 );
+            text += ',';
+            GeoWriter::appendNumber( text, coordinates.latitude( GeoDataCoordinates::Degree ), 10 );
+
+            if ( text.size() >= chunkSize ) {
+                writer.writeCharacters( QString::fromLatin1( text.constData(), text.size() ) );
+                text.clear();
+            }
         }
+        writer.writeCharacters( QString::fromLatin1( text.constData(), text.size() ) );
 
         writer.writeEndElement();
         writer.writeEndElement();
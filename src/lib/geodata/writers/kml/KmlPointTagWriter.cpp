@@ -32,21 +32,22 @@ bool KmlPointTagWriter::write( const GeoNode *node,
 
     writer.writeStartElement("coordinates");
 
-    QString coordinateString;
+    QByteArray coordinateString;
 
     //FIXME: this should be using the GeoDataCoordinates::toString but currently
     // it is not including the altitude and is adding an extra space after commas
 
-    coordinateString += QString::number( point->coordinates().longitude( GeoDataCoordinates::Degree ), 'f', 10 );
+    const GeoDataCoordinates coordinates = point->coordinates();
+    GeoWriter::appendNumber( coordinateString, coordinates.longitude( GeoDataCoordinates::Degree ), 10 );
     coordinateString += ',' ;
-    coordinateString += QString::number( point->coordinates().latitude( GeoDataCoordinates::Degree ) , 'f', 10 );
+    GeoWriter::appendNumber( coordinateString, coordinates.latitude( GeoDataCoordinates::Degree ), 10 );
 
-    if( point->coordinates().altitude() ) {
+    if( coordinates.altitude() ) {
         coordinateString += ',';
-        coordinateString += QString::number( point->coordinates().altitude() , 'f' , 10);
+        GeoWriter::appendNumber( coordinateString, coordinates.altitude(), 10 );
     }
 
-    writer.writeCharacters( coordinateString );
+    writer.writeCharacters( QString::fromLatin1( coordinateString.constData(), coordinateString.size() ) );
 
     writer.writeEndElement();
     writer.writeEndElement();
@@ -27,16 +27,24 @@ bool KmlTrackWriter::write( const GeoNode *node, GeoWriter &writer ) const
 
     writer.writeStartElement( "gx:Track" );
 
+    const QList<QDateTime> whenList = track->whenList();
+    const QList<GeoDataCoordinates> coordinatesList = track->coordinatesList();
+
+    QByteArray coord;
     int points = track->size();
     for ( int i = 0; i < points; i++ ) {
-        writer.writeElement( "when", track->whenList().at( i ).toString( Qt::ISODate ) );
+        writer.writeElement( "when", whenList.at( i ).toString( Qt::ISODate ) );
 
         qreal lon, lat, alt;
-        track->coordinatesList().at( i ).geoCoordinates( lon, lat, alt, GeoDataCoordinates::Degree );
-        QString coord = QString::number( lon, 'f', 10 ) + ' '
-                        + QString::number( lat, 'f', 10 ) + ' ' + QString::number( alt, 'f', 10 );
-
-        writer.writeElement( "gx:coord", coord );
+        coordinatesList.at( i ).geoCoordinates( lon, lat, alt, GeoDataCoordinates::Degree );
+        coord.clear();
+        GeoWriter::appendNumber( coord, lon, 10 );
+        coord += ' ';
+        GeoWriter::appendNumber( coord, lat, 10 );
+        coord += ' ';
+        GeoWriter::appendNumber( coord, alt, 10 );
+
+        writer.writeElement( "gx:coord", QString::fromLatin1( coord.constData(), coord.size() ) );
     }
     writer.writeEndElement();
 
@@ -88,6 +88,23 @@ QPointF KineticModel::position() const
     return d_ptr->position;
 }
 
+QPointF KineticModel::finalPosition() const
+{
+    Q_D(const KineticModel);
+
+    QPointF result = d->position;
+    if (!d->ticker.isActive())
+        return result;
+
+    // the velocity decreases linearly, so the remaining distance is v*v / 2a
+    if (d->deacceleration.x() > 0)
+        result.rx() += d->velocity.x() * qAbs(d->velocity.x()) / (2 * d->deacceleration.x());
+    if (d->deacceleration.y() > 0)
+        result.ry() += d->velocity.y() * qAbs(d->velocity.y()) / (2 * d->deacceleration.y());
+
+    return result;
+}
+
 void KineticModel::setPosition(QPointF position)
 {
     setPosition( position.x(), position.y() );
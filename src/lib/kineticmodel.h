@@ -51,6 +51,12 @@ public:
     QPointF position() const;
     int updateInterval() const;
 
+    /**
+     * Returns the position where the motion started by start() comes to rest,
+     * or the current position if there is no motion.
+     */
+    QPointF finalPosition() const;
+
 public slots:
     void setDuration(int ms);
     void setPosition(QPointF position);
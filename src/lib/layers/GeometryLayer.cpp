@@ -16,6 +16,7 @@
 #include "GeoDataDocument.h"
 #include "GeoDataFolder.h"
 #include "GeoDataLineStyle.h"
+#include "GeoDataMultiGeometry.h"
 #include "GeoDataMultiTrack.h"
 #include "GeoDataObject.h"
 #include "GeoDataPlacemark.h"
@@ -39,32 +40,84 @@
 #include "GeoPhotoGraphicsItem.h"
 #include "ScreenOverlayGraphicsItem.h"
 #include "TileId.h"
+#include "TraceRecorder.h"
 #include "MarbleGraphicsItem.h"
 #include "MarblePlacemarkModel.h"
 
 // Qt
 #include <qmath.h>
 #include <QAbstractItemModel>
+#include <QFutureWatcher>
 #include <QModelIndex>
+#include <QtConcurrentMap>
 
 namespace Marble
 {
+
+typedef QVector<const GeoDataFeature*> FeatureList;
+/// Features along with their styles, which are resolved on the GUI thread
+typedef QVector< QPair<const GeoDataFeature*, const GeoDataStyle*> > FeatureChunk;
+typedef QList< QPair<TileId, GeoGraphicsItem*> > TiledItemList;
+
+/**
+ * Creates the graphics items of a chunk of features and determines their tiles
+ * in the scene. Runs on a worker thread while large documents are indexed.
+ */
+class GraphicsItemBuilder
+{
+public:
+    typedef TiledItemList result_type;
+
+    TiledItemList operator()( const FeatureChunk &chunk ) const;
+};
+
+/**
+ * A batch of features indexed in chunks on worker threads. The items of each
+ * chunk are added to the scene as soon as the chunk and all chunks before it
+ * are done, so they keep the order of the features.
+ */
+struct GraphicsItemBatch
+{
+    GraphicsItemBatch() : featureCount( 0 ), chunkCount( 0 ), merged( 0 ) {}
+
+    QFutureWatcher<TiledItemList> watcher;
+    int featureCount;
+    int chunkCount;
+    int merged;
+};
+
 class GeometryLayerPrivate
 {
 public:
-    GeometryLayerPrivate( const QAbstractItemModel *model );
+    GeometryLayerPrivate( GeometryLayer *parent, const QAbstractItemModel *model );
 
     void createGraphicsItems( const GeoDataObject *object );
-    void createGraphicsItemFromGeometry( const GeoDataGeometry *object, const GeoDataPlacemark *placemark );
-    void createGraphicsItemFromOverlay( const GeoDataOverlay *overlay );
+    static void createGraphicsItems( const GeoDataFeature *feature, const GeoDataStyle *style, QList<GeoGraphicsItem*> &items );
+    static void createGraphicsItemFromGeometry( const GeoDataGeometry *object, const GeoDataPlacemark *placemark,
+                                                const GeoDataStyle *style, QList<GeoGraphicsItem*> &items );
+    static void prepareGeometry( const GeoDataGeometry *object );
     void removeGraphicsItems( const GeoDataFeature *feature );
 
+    void collectFeatures( const GeoDataObject *object, FeatureList &features );
+    void addFeatures( const FeatureList &features );
+    bool mergeIndexedItems();
+    void finishIndexing();
+    void cancelIndexing();
+
     static int maximumZoomLevel();
 
+    GeometryLayer *const q;
     const QAbstractItemModel *const m_model;
     GeoGraphicsScene m_scene;
     QString m_runtimeTrace;
     QList<ScreenOverlayGraphicsItem*> m_items;
+    QList<GraphicsItemBatch *> m_indexing;
+    int m_indexedFeatures;
+    int m_totalFeatures;
+
+    /// Documents with at least that many features are indexed on worker threads
+    static const int s_asyncThreshold;
+    static const int s_chunkSize;
 
 private:
     static void initializeDefaultValues();
@@ -81,9 +134,29 @@ int GeometryLayerPrivate::s_defaultMinZoomLevels[GeoDataFeature::LastIndex];
 bool GeometryLayerPrivate::s_defaultValuesInitialized = false;
 int GeometryLayerPrivate::s_maximumZoomLevel = 0;
 const int GeometryLayerPrivate::s_defaultZValue = 50;
+const int GeometryLayerPrivate::s_asyncThreshold = 10000;
+const int GeometryLayerPrivate::s_chunkSize = 1000;
+
+TiledItemList GraphicsItemBuilder::operator()( const FeatureChunk &chunk ) const
+{
+    typedef QPair<const GeoDataFeature*, const GeoDataStyle*> StyledFeature;
+    QList<GeoGraphicsItem*> items;
+    foreach( const StyledFeature &feature, chunk ) {
+        GeometryLayerPrivate::createGraphicsItems( feature.first, feature.second, items );
+    }
+
+    TiledItemList result;
+    foreach( GeoGraphicsItem *item, items ) {
+        result << qMakePair( GeoGraphicsScene::itemTile( item ), item );
+    }
+    return result;
+}
 
-GeometryLayerPrivate::GeometryLayerPrivate( const QAbstractItemModel *model )
-    : m_model( model )
+GeometryLayerPrivate::GeometryLayerPrivate( GeometryLayer *parent, const QAbstractItemModel *model )
+    : q( parent ),
+      m_model( model ),
+      m_indexedFeatures( 0 ),
+      m_totalFeatures( 0 )
 {
     initializeDefaultValues();
 }
@@ -94,11 +167,14 @@ int GeometryLayerPrivate::maximumZoomLevel()
 }
 
 GeometryLayer::GeometryLayer( const QAbstractItemModel *model )
-        : d( new GeometryLayerPrivate( model ) )
+        : d( new GeometryLayerPrivate( this, model ) )
 {
     const GeoDataObject *object = static_cast<GeoDataObject*>( d->m_model->index( 0, 0, QModelIndex() ).internalPointer() );
-    if ( object && object->parent() )
-        d->createGraphicsItems( object->parent() );
+    if ( object && object->parent() ) {
+        FeatureList features;
+        d->collectFeatures( object->parent(), features );
+        d->addFeatures( features );
+    }
 
     connect( model, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
              this, SLOT(resetCacheData()) );
@@ -112,6 +188,7 @@ GeometryLayer::GeometryLayer( const QAbstractItemModel *model )
 
 GeometryLayer::~GeometryLayer()
 {
+    d->cancelIndexing();
     delete d;
 }
 
@@ -239,6 +316,7 @@ bool GeometryLayer::render( GeoPainter *painter, ViewportParams *viewport,
 {
     Q_UNUSED( renderPos )
     Q_UNUSED( layer )
+    TraceZone zone( "GeometryLayer::render" );
 
     painter->save();
 
@@ -266,18 +344,44 @@ bool GeometryLayer::render( GeoPainter *painter, ViewportParams *viewport,
     return true;
 }
 
+bool GeometryLayer::isThreadSafe() const
+{
+    // The scene and the features are only changed by the GUI thread, which waits
+    // for the layers while the map is painted. Items only paint images, no pixmaps.
+    return true;
+}
+
 QString GeometryLayer::runtimeTrace() const
 {
     return d->m_runtimeTrace;
 }
 
 void GeometryLayerPrivate::createGraphicsItems( const GeoDataObject *object )
+{
+    FeatureList features;
+    collectFeatures( object, features );
+
+    QList<GeoGraphicsItem*> items;
+    foreach( const GeoDataFeature *feature, features ) {
+        createGraphicsItems( feature, feature->style(), items );
+    }
+
+    foreach( GeoGraphicsItem *item, items ) {
+        m_scene.addItem( item );
+    }
+}
+
+void GeometryLayerPrivate::collectFeatures( const GeoDataObject *object, FeatureList &features )
 {
     if ( const GeoDataPlacemark *placemark = dynamic_cast<const GeoDataPlacemark*>( object ) )
     {
-        createGraphicsItemFromGeometry( placemark->geometry(), placemark );
-    } else if ( const GeoDataOverlay* overlay = dynamic_cast<const GeoDataOverlay*>( object ) ) {
-        createGraphicsItemFromOverlay( overlay );
+        features << placemark;
+    } else if ( object->nodeType() == GeoDataTypes::GeoDataPhotoOverlayType ) {
+        features << static_cast<const GeoDataFeature*>( object );
+    } else if ( object->nodeType() == GeoDataTypes::GeoDataScreenOverlayType ) {
+        GeoDataScreenOverlay const * screenOverlay = static_cast<GeoDataScreenOverlay const *>( object );
+        ScreenOverlayGraphicsItem *screenItem = new ScreenOverlayGraphicsItem ( screenOverlay );
+        m_items.push_back( screenItem );
     }
 
     // parse all child objects of the container
@@ -286,12 +390,29 @@ void GeometryLayerPrivate::createGraphicsItems( const GeoDataObject *object )
         int rowCount = container->size();
         for ( int row = 0; row < rowCount; ++row )
         {
-            createGraphicsItems( container->child( row ) );
+            collectFeatures( container->child( row ), features );
         }
     }
 }
 
-void GeometryLayerPrivate::createGraphicsItemFromGeometry( const GeoDataGeometry* object, const GeoDataPlacemark *placemark )
+void GeometryLayerPrivate::createGraphicsItems( const GeoDataFeature *feature, const GeoDataStyle *style, QList<GeoGraphicsItem*> &items )
+{
+    if ( feature->nodeType() == GeoDataTypes::GeoDataPlacemarkType ) {
+        const GeoDataPlacemark *placemark = static_cast<const GeoDataPlacemark*>( feature );
+        createGraphicsItemFromGeometry( placemark->geometry(), placemark, style, items );
+    } else if ( feature->nodeType() == GeoDataTypes::GeoDataPhotoOverlayType ) {
+        GeoDataPhotoOverlay const * photoOverlay = static_cast<GeoDataPhotoOverlay const *>( feature );
+        GeoPhotoGraphicsItem *photoItem = new GeoPhotoGraphicsItem( photoOverlay );
+        photoItem->setPhotoFile( photoOverlay->absoluteIconFile() );
+        photoItem->setPoint( photoOverlay->point() );
+        photoItem->setStyle( style );
+        photoItem->setVisible( photoOverlay->isGloballyVisible() );
+        items << photoItem;
+    }
+}
+
+void GeometryLayerPrivate::createGraphicsItemFromGeometry( const GeoDataGeometry* object, const GeoDataPlacemark *placemark,
+                                                           const GeoDataStyle *style, QList<GeoGraphicsItem*> &items )
 {
     GeoGraphicsItem *item = 0;
     if ( object->nodeType() == GeoDataTypes::GeoDataLineStringType )
@@ -315,7 +436,7 @@ void GeometryLayerPrivate::createGraphicsItemFromGeometry( const GeoDataGeometry
         int rowCount = multigeo->size();
         for ( int row = 0; row < rowCount; ++row )
         {
-            createGraphicsItemFromGeometry( multigeo->child( row ), placemark );
+            createGraphicsItemFromGeometry( multigeo->child( row ), placemark, style, items );
         }
     }
     else if ( object->nodeType() == GeoDataTypes::GeoDataMultiTrackType  )
@@ -324,7 +445,7 @@ void GeometryLayerPrivate::createGraphicsItemFromGeometry( const GeoDataGeometry
         int rowCount = multitrack->size();
         for ( int row = 0; row < rowCount; ++row )
         {
-            createGraphicsItemFromGeometry( multitrack->child( row ), placemark );
+            createGraphicsItemFromGeometry( multitrack->child( row ), placemark, style, items );
         }
     }
     else if ( object->nodeType() == GeoDataTypes::GeoDataTrackType )
@@ -334,33 +455,138 @@ void GeometryLayerPrivate::createGraphicsItemFromGeometry( const GeoDataGeometry
     }
     if ( !item )
         return;
-    item->setStyle( placemark->style() );
+    item->setStyle( style );
     item->setVisible( placemark->isGloballyVisible() );
     item->setZValue( s_defaultZValues[placemark->visualCategory()] );
     item->setMinZoomLevel( s_defaultMinZoomLevels[placemark->visualCategory()] );
-    m_scene.addItem( item );
+    items << item;
 }
 
-void GeometryLayerPrivate::createGraphicsItemFromOverlay( const GeoDataOverlay *overlay )
+void GeometryLayerPrivate::prepareGeometry( const GeoDataGeometry *object )
 {
-    GeoGraphicsItem* item = 0;
-    if ( overlay->nodeType() == GeoDataTypes::GeoDataPhotoOverlayType ) {
-        GeoDataPhotoOverlay const * photoOverlay = static_cast<GeoDataPhotoOverlay const *>( overlay );
-        GeoPhotoGraphicsItem *photoItem = new GeoPhotoGraphicsItem( overlay );
-        photoItem->setPhotoFile( photoOverlay->absoluteIconFile() );
-        photoItem->setPoint( photoOverlay->point() );
-        item = photoItem;
-    } else if ( overlay->nodeType() == GeoDataTypes::GeoDataScreenOverlayType ) {
-        GeoDataScreenOverlay const * screenOverlay = static_cast<GeoDataScreenOverlay const *>( overlay );
-        ScreenOverlayGraphicsItem *screenItem = new ScreenOverlayGraphicsItem ( screenOverlay );
-        m_items.push_back( screenItem );
+    if ( object->nodeType() == GeoDataTypes::GeoDataLineStringType
+         || object->nodeType() == GeoDataTypes::GeoDataLinearRingType
+         || object->nodeType() == GeoDataTypes::GeoDataPolygonType ) {
+        object->latLonAltBox();
+    }
+    else if ( object->nodeType() == GeoDataTypes::GeoDataMultiGeometryType ) {
+        // the box of the multi geometry itself is not used by the items
+        const GeoDataMultiGeometry *multigeo = static_cast<const GeoDataMultiGeometry*>( object );
+        for ( int row = 0; row < multigeo->size(); ++row ) {
+            prepareGeometry( multigeo->child( row ) );
+        }
     }
+    else if ( object->nodeType() == GeoDataTypes::GeoDataMultiTrackType ) {
+        const GeoDataMultiTrack *multitrack = static_cast<const GeoDataMultiTrack*>( object );
+        for ( int row = 0; row < multitrack->size(); ++row ) {
+            prepareGeometry( multitrack->child( row ) );
+        }
+    }
+    else if ( object->nodeType() == GeoDataTypes::GeoDataTrackType ) {
+        static_cast<const GeoDataTrack*>( object )->lineString()->latLonAltBox();
+    }
+}
 
-    if ( item ) {
-        item->setStyle( overlay->style() );
-        item->setVisible( overlay->isGloballyVisible() );
-        m_scene.addItem( item );
+void GeometryLayerPrivate::addFeatures( const FeatureList &features )
+{
+    if ( features.size() < s_asyncThreshold ) {
+        QList<GeoGraphicsItem*> items;
+        foreach( const GeoDataFeature *feature, features ) {
+            createGraphicsItems( feature, feature->style(), items );
+        }
+
+        foreach( GeoGraphicsItem *item, items ) {
+            m_scene.addItem( item );
+        }
+        return;
+    }
+
+    // Large documents are indexed in chunks on worker threads. The features
+    // must not be modified meanwhile, see finishIndexing(). Styles and bounding
+    // boxes are computed lazily, so do that here to keep the workers read-only.
+    QList<FeatureChunk> chunks;
+    FeatureChunk chunk;
+    chunk.reserve( s_chunkSize );
+    foreach( const GeoDataFeature *feature, features ) {
+        if ( feature->nodeType() == GeoDataTypes::GeoDataPlacemarkType ) {
+            prepareGeometry( static_cast<const GeoDataPlacemark*>( feature )->geometry() );
+        }
+        chunk << qMakePair( feature, feature->style() );
+        if ( chunk.size() == s_chunkSize ) {
+            chunks << chunk;
+            chunk.clear();
+            chunk.reserve( s_chunkSize );
+        }
+    }
+    if ( !chunk.isEmpty() ) {
+        chunks << chunk;
     }
+
+    GraphicsItemBatch *batch = new GraphicsItemBatch;
+    batch->featureCount = features.size();
+    batch->chunkCount = chunks.size();
+    m_totalFeatures += batch->featureCount;
+    QObject::connect( &batch->watcher, SIGNAL(resultReadyAt(int)), q, SLOT(addIndexedItems()) );
+    QObject::connect( &batch->watcher, SIGNAL(finished()), q, SLOT(addIndexedItems()) );
+    m_indexing << batch;
+    batch->watcher.setFuture( QtConcurrent::mapped( chunks, GraphicsItemBuilder() ) );
+    q->updateIndexingProgress();
+}
+
+bool GeometryLayerPrivate::mergeIndexedItems()
+{
+    bool merged = false;
+    while ( !m_indexing.isEmpty() ) {
+        GraphicsItemBatch *batch = m_indexing.first();
+        const QFuture<TiledItemList> future = batch->watcher.future();
+        while ( batch->merged < batch->chunkCount && future.isResultReadyAt( batch->merged ) ) {
+            m_scene.addItems( future.resultAt( batch->merged ) );
+            m_indexedFeatures += qMin( s_chunkSize, batch->featureCount - batch->merged * s_chunkSize );
+            ++batch->merged;
+            merged = true;
+        }
+
+        // later batches wait for this one to keep the order of the documents
+        if ( batch->merged < batch->chunkCount || !batch->watcher.isFinished() ) {
+            break;
+        }
+
+        m_indexing.removeFirst();
+        delete batch;
+    }
+
+    return merged;
+}
+
+void GeometryLayerPrivate::finishIndexing()
+{
+    foreach( GraphicsItemBatch *batch, m_indexing ) {
+        batch->watcher.waitForFinished();
+    }
+    mergeIndexedItems();
+    Q_ASSERT( m_indexing.isEmpty() );
+}
+
+void GeometryLayerPrivate::cancelIndexing()
+{
+    foreach( GraphicsItemBatch *batch, m_indexing ) {
+        batch->watcher.cancel();
+        batch->watcher.waitForFinished();
+
+        // delete the items of the chunks which are done but not in the scene yet
+        const QFuture<TiledItemList> future = batch->watcher.future();
+        for ( int i = batch->merged; i < batch->chunkCount; ++i ) {
+            if ( future.isResultReadyAt( i ) ) {
+                foreach( const TiledItemList::value_type &tiledItem, future.resultAt( i ) ) {
+                    delete tiledItem.second;
+                }
+            }
+        }
+        delete batch;
+    }
+    m_indexing.clear();
+    m_indexedFeatures = 0;
+    m_totalFeatures = 0;
 }
 
 void GeometryLayerPrivate::removeGraphicsItems( const GeoDataFeature *feature )
@@ -389,13 +615,15 @@ void GeometryLayer::addPlacemarks( QModelIndex parent, int first, int last )
 {
     Q_ASSERT( first < d->m_model->rowCount( parent ) );
     Q_ASSERT( last < d->m_model->rowCount( parent ) );
+    FeatureList features;
     for( int i=first; i<=last; ++i ) {
         QModelIndex index = d->m_model->index( i, 0, parent );
         Q_ASSERT( index.isValid() );
         const GeoDataObject *object = qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) );
         Q_ASSERT( object );
-        d->createGraphicsItems( object );
+        d->collectFeatures( object, features );
     }
+    d->addFeatures( features );
     emit repaintNeeded();
 
 }
@@ -403,6 +631,10 @@ void GeometryLayer::addPlacemarks( QModelIndex parent, int first, int last )
 void GeometryLayer::removePlacemarks( QModelIndex parent, int first, int last )
 {
     Q_ASSERT( last < d->m_model->rowCount( parent ) );
+    if ( d->m_totalFeatures > 0 ) {
+        d->finishIndexing();
+        updateIndexingProgress();
+    }
     for( int i=first; i<=last; ++i ) {
         QModelIndex index = d->m_model->index( i, 0, parent );
         Q_ASSERT( index.isValid() );
@@ -417,15 +649,38 @@ void GeometryLayer::removePlacemarks( QModelIndex parent, int first, int last )
 
 void GeometryLayer::resetCacheData()
 {
+    d->cancelIndexing();
     d->m_scene.eraseAll();
     qDeleteAll( d->m_items );
     d->m_items.clear();
     const GeoDataObject *object = static_cast<GeoDataObject*>( d->m_model->index( 0, 0, QModelIndex() ).internalPointer() );
-    if ( object && object->parent() )
-        d->createGraphicsItems( object->parent() );
+    if ( object && object->parent() ) {
+        FeatureList features;
+        d->collectFeatures( object->parent(), features );
+        d->addFeatures( features );
+    }
     emit repaintNeeded();
 }
 
+void GeometryLayer::addIndexedItems()
+{
+    if ( d->mergeIndexedItems() ) {
+        emit repaintNeeded();
+    }
+
+    updateIndexingProgress();
+}
+
+void GeometryLayer::updateIndexingProgress()
+{
+    emit indexingProgress( d->m_indexedFeatures, d->m_totalFeatures );
+
+    if ( d->m_indexing.isEmpty() ) {
+        d->m_indexedFeatures = 0;
+        d->m_totalFeatures = 0;
+    }
+}
+
 }
 
 #include "GeometryLayer.moc"
@@ -37,6 +37,8 @@ public:
     virtual bool render( GeoPainter *painter, ViewportParams *viewport,
                          const QString& renderPos = "NONE", GeoSceneLayer * layer = 0 );
     
+    virtual bool isThreadSafe() const;
+
     virtual QString runtimeTrace() const;
 
 public Q_SLOTS:
@@ -47,7 +49,18 @@ public Q_SLOTS:
 Q_SIGNALS:
     void repaintNeeded();
 
+    /**
+     * Emitted while large documents are indexed in the background. Progress is
+     * measured in features; indexing is complete when @p processed equals @p total.
+     */
+    void indexingProgress( int processed, int total );
+
+private Q_SLOTS:
+    void addIndexedItems();
+    void updateIndexingProgress();
+
 private:
+    friend class GeometryLayerPrivate;
     GeometryLayerPrivate *d;
 };
 
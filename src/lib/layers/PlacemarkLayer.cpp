@@ -20,6 +20,7 @@
 #include "AbstractProjection.h"
 #include "GeoDataStyle.h"
 #include "GeoPainter.h"
+#include "TraceRecorder.h"
 #include "ViewportParams.h"
 #include "VisiblePlacemark.h"
 
@@ -38,6 +39,7 @@ PlacemarkLayer::PlacemarkLayer( QAbstractItemModel *placemarkModel,
     mDebug() << "Use workaround: " << ( m_useXWorkaround ? "1" : "0" );
 
     connect( &m_layout, SIGNAL(repaintNeeded()), SIGNAL(repaintNeeded()) );
+    connect( &m_layout, SIGNAL(indexingProgress(int,int)), SIGNAL(indexingProgress(int,int)) );
 }
 
 PlacemarkLayer::~PlacemarkLayer()
@@ -59,6 +61,7 @@ bool PlacemarkLayer::render( GeoPainter *geoPainter, ViewportParams *viewport,
 {
     Q_UNUSED( renderPos )
     Q_UNUSED( layer )
+    TraceZone zone( "PlacemarkLayer::render" );
 
     QVector<VisiblePlacemark*> visiblePlacemarks = m_layout.generateLayout( viewport );
     // draw placemarks less important first
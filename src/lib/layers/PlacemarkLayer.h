@@ -91,6 +91,8 @@ class PlacemarkLayer : public QObject, public LayerInterface
  Q_SIGNALS:
    void repaintNeeded();
 
+   void indexingProgress( int processed, int total );
+
  private:
     bool testXBug();
 
@@ -34,8 +34,14 @@
 #include "SunLocator.h"
 #include "TextureColorizer.h"
 #include "TileLoader.h"
+#include "TilePrefetcher.h"
+#include "TraceRecorder.h"
 #include "VectorComposer.h"
 #include "ViewportParams.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoDataLineString.h"
+#include "MarbleMath.h"
+#include "Quaternion.h"
 
 namespace Marble
 {
@@ -62,6 +68,14 @@ public:
 
     void updateGroundOverlays();
 
+    int tileLevel( int radius ) const;
+
+    /**
+     * Returns the approximate area shown with @p center and @p radius
+     * in a viewport of @p size
+     */
+    GeoDataLatLonBox viewArea( const GeoDataCoordinates &center, int radius, const QSize &size ) const;
+
     static bool drawOrderLessThan( const GeoDataGroundOverlay* o1, const GeoDataGroundOverlay* o2 );
 
 public:
@@ -71,6 +85,8 @@ public:
     TileLoader m_loader;
     MergedLayerDecorator m_layerDecorator;
     StackedTileLoader    m_tileLoader;
+    TilePrefetcher       m_prefetcher;
+    Projection m_projection;
     GeoDataCoordinates m_centerCoordinates;
     int m_tileZoomLevel;
     TextureMapperInterface *m_texmapper;
@@ -96,6 +112,8 @@ TextureLayer::Private::Private( HttpDownloadManager *downloadManager,
     , m_loader( downloadManager, pluginManager )
     , m_layerDecorator( &m_loader, sunLocator )
     , m_tileLoader( &m_layerDecorator )
+    , m_prefetcher( &m_tileLoader, &m_layerDecorator )
+    , m_projection( Spherical )
     , m_centerCoordinates()
     , m_tileZoomLevel( -1 )
     , m_texmapper( 0 )
@@ -166,10 +184,54 @@ void TextureLayer::Private::updateTile( const TileId &tileId, const QImage &tile
         return; // keep tiles in cache to improve performance
 
     m_tileLoader.updateTile( tileId, tileImage );
+    m_prefetcher.updateTile( TileId( 0, tileId.zoomLevel(), tileId.x(), tileId.y() ) );
 
     requestDelayedRepaint();
 }
 
+int TextureLayer::Private::tileLevel( int radius ) const
+{
+    // choose the smaller dimension for selecting the tile level, leading to higher-resolution results
+    const int levelZeroWidth = m_layerDecorator.tileSize().width() * m_layerDecorator.tileColumnCount( 0 );
+    const int levelZeroHight = m_layerDecorator.tileSize().height() * m_layerDecorator.tileRowCount( 0 );
+    const int levelZeroMinDimension = qMin( levelZeroWidth, levelZeroHight );
+
+    // limit to 1 as dirty fix for invalid entry linearLevel
+    const qreal linearLevel = qMax( 1.0, radius * 4.0 / levelZeroMinDimension );
+
+    // As our tile resolution doubles with each level we calculate
+    // the tile level from tilesize and the globe radius via log(2)
+    const qreal tileLevelF = qLn( linearLevel ) / qLn( 2.0 ) * 1.00001;  // snap to the sharper tile level a tiny bit earlier
+                                                                         // to work around rounding errors when the radius
+                                                                         // roughly equals the global texture width
+
+    return qMin<int>( m_layerDecorator.maximumTileLevel(), tileLevelF );
+}
+
+GeoDataLatLonBox TextureLayer::Private::viewArea( const GeoDataCoordinates &center, int radius, const QSize &size ) const
+{
+    // The globe has radius pixels per radian in its center, flat maps are 4 * radius pixels wide
+    const qreal pixelsPerRadian = m_projection == Spherical ? radius : 2.0 * radius / M_PI;
+
+    const qreal lat = center.latitude();
+    const qreal halfHeight = 0.5 * size.height() / pixelsPerRadian;
+    qreal halfWidth = 0.5 * size.width() / pixelsPerRadian;
+    if ( m_projection == Spherical ) {
+        // meridians converge towards the poles
+        halfWidth /= qMax<qreal>( 0.1, cos( lat ) );
+    }
+
+    const qreal north = qMin<qreal>( M_PI / 2, lat + halfHeight );
+    const qreal south = qMax<qreal>( -M_PI / 2, lat - halfHeight );
+    if ( halfWidth >= M_PI ) {
+        return GeoDataLatLonBox( north, south, M_PI, -M_PI );
+    }
+
+    const qreal east = GeoDataCoordinates::normalizeLon( center.longitude() + halfWidth );
+    const qreal west = GeoDataCoordinates::normalizeLon( center.longitude() - halfWidth );
+    return GeoDataLatLonBox( north, south, east, west );
+}
+
 bool TextureLayer::Private::drawOrderLessThan( const GeoDataGroundOverlay* o1, const GeoDataGroundOverlay* o2 )
 {
     return o1->drawOrder() < o2->drawOrder();
@@ -295,6 +357,7 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
 {
     Q_UNUSED( renderPos );
     Q_UNUSED( layer );
+    TraceZone zone( "TextureLayer::render" );
 
     // Stop repaint timer if it is already running
     d->m_repaintTimer.stop();
@@ -315,21 +378,7 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
         d->m_texmapper->setRepaintNeeded();
     }
 
-    // choose the smaller dimension for selecting the tile level, leading to higher-resolution results
-    const int levelZeroWidth = d->m_layerDecorator.tileSize().width() * d->m_layerDecorator.tileColumnCount( 0 );
-    const int levelZeroHight = d->m_layerDecorator.tileSize().height() * d->m_layerDecorator.tileRowCount( 0 );
-    const int levelZeroMinDimension = qMin( levelZeroWidth, levelZeroHight );
-
-    // limit to 1 as dirty fix for invalid entry linearLevel
-    const qreal linearLevel = qMax( 1.0, viewport->radius() * 4.0 / levelZeroMinDimension );
-
-    // As our tile resolution doubles with each level we calculate
-    // the tile level from tilesize and the globe radius via log(2)
-    const qreal tileLevelF = qLn( linearLevel ) / qLn( 2.0 ) * 1.00001;  // snap to the sharper tile level a tiny bit earlier
-                                                                         // to work around rounding errors when the radius
-                                                                         // roughly equals the global texture width
-
-    const int tileLevel = qMin<int>( d->m_layerDecorator.maximumTileLevel(), tileLevelF );
+    const int tileLevel = d->tileLevel( viewport->radius() );
 
     if ( tileLevel != d->m_tileZoomLevel ) {
         d->m_tileZoomLevel = tileLevel;
@@ -337,8 +386,14 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
     }
 
     const QRect dirtyRect = QRect( QPoint( 0, 0), viewport->size() );
-    d->m_texmapper->mapTexture( painter, viewport, d->m_tileZoomLevel, dirtyRect, d->m_texcolorizer );
-    d->m_runtimeTrace = QString("Texture Cache: %1 ").arg(d->m_tileLoader.tileCount());
+    {
+        TraceZone mappingZone( "TextureMapper::mapTexture" );
+        d->m_texmapper->mapTexture( painter, viewport, d->m_tileZoomLevel, dirtyRect, d->m_texcolorizer );
+    }
+    d->m_runtimeTrace = QString("Texture Cache: %1 Prefetch Hits: %2/%3 ")
+                        .arg( d->m_tileLoader.tileCount() )
+                        .arg( d->m_tileLoader.prefetchHits() )
+                        .arg( d->m_tileLoader.prefetchHits() + d->m_tileLoader.prefetchMisses() );
     return true;
 }
 
@@ -385,6 +440,8 @@ void TextureLayer::setShowTileId( bool show )
 
 void TextureLayer::setProjection( Projection projection )
 {
+    d->m_projection = projection;
+
     if ( d->m_textures.isEmpty() ) {
         return;
     }
@@ -401,7 +458,10 @@ void TextureLayer::setProjection( Projection projection )
             break;
         case Mercator:
             if ( d->m_tileLoader.tileProjection() == GeoSceneTiled::Mercator ) {
-                d->m_texmapper = new TileScalingTextureMapper( &d->m_tileLoader );
+                TileScalingTextureMapper *const mapper = new TileScalingTextureMapper( &d->m_tileLoader );
+                connect( mapper, SIGNAL(repaintNeeded()),
+                         this, SLOT(requestDelayedRepaint()) );
+                d->m_texmapper = mapper;
             } else {
                 d->m_texmapper = new MercatorScanlineTextureMapper( &d->m_tileLoader );
             }
@@ -424,6 +484,8 @@ void TextureLayer::setNeedsUpdate()
 void TextureLayer::setVolatileCacheLimit( quint64 kilobytes )
 {
     d->m_tileLoader.setVolatileCacheLimit( kilobytes );
+    // leave most of the cache to the tiles shown recently
+    d->m_prefetcher.setMemoryLimit( kilobytes / 4 );
 }
 
 void TextureLayer::reset()
@@ -449,6 +511,36 @@ void TextureLayer::downloadStackedTile( const TileId &stackedTileId )
     d->m_layerDecorator.downloadStackedTile( stackedTileId, DownloadBulk );
 }
 
+void TextureLayer::prefetchTiles( const GeoDataLineString &path, int radius, const QSize &size )
+{
+    d->m_prefetcher.clear();
+
+    if ( path.isEmpty() || d->m_layerDecorator.textureLayersSize() == 0 ) {
+        return;
+    }
+
+    const int tileLevel = d->tileLevel( radius );
+
+    // Path points can be far apart, so the areas in between are added as well.
+    // Each one overlaps the previous by half.
+    const qreal pixelsPerRadian = d->m_projection == Spherical ? radius : 2.0 * radius / M_PI;
+    const qreal step = 0.5 * qMin( size.width(), size.height() ) / pixelsPerRadian;
+
+    GeoDataCoordinates previous = path.first();
+    d->m_prefetcher.addArea( tileLevel, d->viewArea( previous, radius, size ) );
+    for ( int i = 1; i < path.size(); ++i ) {
+        const GeoDataCoordinates current = path.at( i );
+        const int steps = qMax( 1, qCeil( distanceSphere( previous, current ) / step ) );
+        for ( int j = 1; j <= steps; ++j ) {
+            qreal lon = 0.0;
+            qreal lat = 0.0;
+            Quaternion::slerp( previous.quaternion(), current.quaternion(), qreal( j ) / steps ).getSpherical( lon, lat );
+            d->m_prefetcher.addArea( tileLevel, d->viewArea( GeoDataCoordinates( lon, lat ), radius, size ) );
+        }
+        previous = current;
+    }
+}
+
 void TextureLayer::setMapTheme( const QVector<const GeoSceneTextureTile *> &textures, const GeoSceneGroup *textureLayerSettings, const QString &seaFile, const QString &landFile )
 {
     delete d->m_texcolorizer;
@@ -499,6 +591,21 @@ qint64 TextureLayer::volatileCacheLimit() const
     return d->m_tileLoader.volatileCacheLimit();
 }
 
+int TextureLayer::prefetchedTileCount() const
+{
+    return d->m_tileLoader.prefetchedTileCount();
+}
+
+int TextureLayer::prefetchHits() const
+{
+    return d->m_tileLoader.prefetchHits();
+}
+
+int TextureLayer::prefetchMisses() const
+{
+    return d->m_tileLoader.prefetchMisses();
+}
+
 int TextureLayer::preferredRadiusCeil( int radius ) const
 {
     const int tileWidth = d->m_layerDecorator.tileSize().width();
@@ -28,6 +28,7 @@ class QRect;
 namespace Marble
 {
 
+class GeoDataLineString;
 class GeoPainter;
 class GeoSceneGroup;
 class HttpDownloadManager;
@@ -76,6 +77,21 @@ class TextureLayer : public QObject, public LayerInterface
     int preferredRadiusCeil( int radius ) const;
     int preferredRadiusFloor( int radius ) const;
 
+    /**
+     * @brief Number of tiles loaded ahead of time by prefetchTiles()
+     */
+    int prefetchedTileCount() const;
+
+    /**
+     * @brief Number of tiles shown after being loaded by prefetchTiles()
+     */
+    int prefetchHits() const;
+
+    /**
+     * @brief Number of tiles queued by prefetchTiles() which were not in memory yet when they were shown
+     */
+    int prefetchMisses() const;
+
     virtual QString runtimeTrace() const;
 
     virtual bool render( GeoPainter *painter, ViewportParams *viewport,
@@ -108,6 +124,14 @@ public Q_SLOTS:
 
     void downloadStackedTile( const TileId &stackedTileId );
 
+    /**
+     * @brief Load the tiles needed to show the map along @p path ahead of time
+     * @param path the centers of the map in the order they will be shown
+     * @param radius the radius the map will be shown with
+     * @param size the size of the viewport
+     */
+    void prefetchTiles( const GeoDataLineString &path, int radius, const QSize &size );
+
  Q_SIGNALS:
     void tileLevelChanged( int );
     void repaintNeeded();
@@ -380,6 +380,27 @@ void SphericalProjectionPrivate::processTessellation( const GeoDataCoordinates &
 
     const qreal altDiff = currentCoords.altitude() - previousCoords.altitude();
 
+    // To tessellate along great circles use the normalized linear
+    // interpolation ("NLERP") for latitude and longitude. The batched
+    // conversion doesn't need normalized vectors, so interpolating suffices.
+    Q_ASSERT( tessellatedNodes <= maxTessellationNodes );
+    qreal nodesX[maxTessellationNodes];
+    qreal nodesY[maxTessellationNodes];
+    qreal nodesZ[maxTessellationNodes];
+    qreal nodesLon[maxTessellationNodes];
+    qreal nodesLat[maxTessellationNodes];
+    if ( !followLatitudeCircle ) {
+        const Quaternion &previousPos = previousCoords.quaternion();
+        const Quaternion &currentPos = currentCoords.quaternion();
+        for ( int i = 0; i < tessellatedNodes; ++i ) {
+            const qreal t = (qreal)( i + 1 ) / (qreal)( tessellatedNodes + 1 );
+            nodesX[i] = ( 1.0 - t ) * previousPos.v[Q_X] + t * currentPos.v[Q_X];
+            nodesY[i] = ( 1.0 - t ) * previousPos.v[Q_Y] + t * currentPos.v[Q_Y];
+            nodesZ[i] = ( 1.0 - t ) * previousPos.v[Q_Z] + t * currentPos.v[Q_Z];
+        }
+        Quaternion::getSpherical( nodesX, nodesY, nodesZ, nodesLon, nodesLat, tessellatedNodes, HighPrecision );
+    }
+
     // Create the tessellation nodes.
     GeoDataCoordinates previousTessellatedCoords = previousCoords;
     for ( int i = 1; i <= tessellatedNodes; ++i ) {
@@ -397,10 +418,8 @@ void SphericalProjectionPrivate::processTessellation( const GeoDataCoordinates &
             lat = previousTessellatedCoords.latitude();
         }
         else {
-            // To tessellate along great circles use the
-            // normalized linear interpolation ("NLERP") for latitude and longitude.
-            const Quaternion itpos = Quaternion::nlerp( previousCoords.quaternion(), currentCoords.quaternion(), t );
-            itpos. getSpherical( lon, lat );
+            lon = nodesLon[i - 1];
+            lat = nodesLat[i - 1];
         }
 
         const GeoDataCoordinates currentTessellatedCoords( lon, lat, altitude );
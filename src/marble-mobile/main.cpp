@@ -26,6 +26,7 @@
 #include "MarbleLocale.h"
 #include "MarbleWidget.h"
 #include "MarbleTest.h"
+#include "TraceRecorder.h"
 
 #ifdef STATIC_BUILD
  #include <QtPlugin>
@@ -112,6 +113,7 @@ int main(int argc, char *argv[])
     QString mapThemeId;
     QString coordinatesString;
     QString distanceString;
+    QString traceFile;
     const MarbleGlobal::Profiles profiles = MarbleGlobal::SmallScreen | MarbleGlobal::HighResolution;
 
     QStringList args = QApplication::arguments();
@@ -132,6 +134,8 @@ int main(int argc, char *argv[])
         qWarning() << "  --fps ...................... Show the paint performance (paint rate) in the top left corner";
         qWarning() << "  --runtimeTrace.............. Show the time spent and other debug info of each layer";
         qWarning() << "  --tile-id................... Write the identifier of texture tiles on top of them";
+        qWarning() << "  --trace=<file> ............. Record the time spent in each part of the render pipeline,";
+        qWarning() << "                               write it to <file> in Chrome trace format and print a summary on exit";
         qWarning() << "  --timedemo ................. Measure the paint performance while moving the map and quit";
 
         return 0;
@@ -183,6 +187,12 @@ int main(int argc, char *argv[])
             // and error reporting to user (problem also exists with marbledatapath)
             mapThemeId = args.value( i );
         }
+        else if ( arg.startsWith( QLatin1String( "--trace=" ), Qt::CaseInsensitive ) )
+        {
+            traceFile = arg.mid(8);
+            // enabled early to cover the startup as well
+            TraceRecorder::setEnabled( true );
+        }
     }
     MarbleGlobal::getInstance()->setProfiles( profiles );
 
@@ -242,5 +252,14 @@ int main(int argc, char *argv[])
         }
     }
 
-    return app.exec();
+    const int result = app.exec();
+
+    if ( !traceFile.isEmpty() ) {
+        if ( !TraceRecorder::saveChromeTrace( traceFile ) ) {
+            qWarning() << "Cannot write trace to" << traceFile;
+        }
+        qWarning() << qPrintable( TraceRecorder::summaryText() );
+    }
+
+    return result;
 }
@@ -14,6 +14,7 @@
 #include "ZoomButtonInterceptor.h"
 
 #include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
 #include "MarbleWidget.h"
 #include "MarbleModel.h"
 #include "MarbleWidgetInputHandler.h"
@@ -220,6 +221,11 @@ void MarbleWidget::zoomOut()
     m_marbleWidget->zoomOut();
 }
 
+void MarbleWidget::prefetchTiles( const GeoDataLineString &path, int radius )
+{
+    m_marbleWidget->prefetchTiles( path, radius );
+}
+
 QPoint MarbleWidget::pixel( qreal lon, qreal lat ) const
 {
     Marble::GeoDataCoordinates position( lon, lat, 0, Marble::GeoDataCoordinates::Degree );
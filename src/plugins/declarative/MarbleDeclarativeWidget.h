@@ -32,12 +32,15 @@ namespace Marble
 {
 // Forward declarations
 class AbstractFloatItem;
+class GeoDataLineString;
 class MarbleModel;
 class MarbleWidget;
 class RenderPlugin;
 class ViewportParams;
 }
 
+using Marble::GeoDataLineString;
+
 class DeclarativeDataPlugin;
 class ZoomButtonInterceptor;
 /**
@@ -187,6 +190,9 @@ public Q_SLOTS:
     /** Zoom out by a fixed amount */
     void zoomOut();
 
+    /** Load the tiles along the given path ahead of time */
+    void prefetchTiles( const GeoDataLineString &path, int radius );
+
     /**
       * Returns the screen position of the given coordinate
       * (can be out of the screen borders)
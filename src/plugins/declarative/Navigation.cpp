@@ -124,6 +124,8 @@ void Navigation::setMap( MarbleWidget* widget )
                  d->m_marbleWidget, SLOT(zoomOut()) );
         connect( d->m_autoNavigation, SIGNAL(centerOn(GeoDataCoordinates,bool)),
                  d->m_marbleWidget, SLOT(centerOn(GeoDataCoordinates)) );
+        connect( d->m_autoNavigation, SIGNAL(prefetchTiles(GeoDataLineString,int)),
+                 d->m_marbleWidget, SLOT(prefetchTiles(GeoDataLineString,int)) );
 
         connect( d->m_marbleWidget, SIGNAL(visibleLatLonAltBoxChanged()),
                  d->m_autoNavigation, SLOT(inhibitAutoAdjustments()) );
@@ -215,6 +215,8 @@ void Tracking::setAutoCenter( bool enabled )
                      m_marbleWidget, SLOT(zoomOut()) );
             connect( m_autoNavigation, SIGNAL(centerOn(GeoDataCoordinates,bool)),
                      m_marbleWidget, SLOT(centerOn(GeoDataCoordinates)) );
+            connect( m_autoNavigation, SIGNAL(prefetchTiles(GeoDataLineString,int)),
+                     m_marbleWidget, SLOT(prefetchTiles(GeoDataLineString,int)) );
 
             connect( m_marbleWidget, SIGNAL(visibleLatLonAltBoxChanged()),
                      m_autoNavigation, SLOT(inhibitAutoAdjustments()) );
@@ -248,6 +250,8 @@ void Tracking::setAutoZoom( bool enabled )
                      m_marbleWidget, SLOT(zoomOut()) );
             connect( m_autoNavigation, SIGNAL(centerOn(GeoDataCoordinates,bool)),
                      m_marbleWidget, SLOT(centerOn(GeoDataCoordinates)) );
+            connect( m_autoNavigation, SIGNAL(prefetchTiles(GeoDataLineString,int)),
+                     m_marbleWidget, SLOT(prefetchTiles(GeoDataLineString,int)) );
 
             connect( m_marbleWidget, SIGNAL(visibleLatLonAltBoxChanged()),
                      m_autoNavigation, SLOT(inhibitAutoAdjustments()) );
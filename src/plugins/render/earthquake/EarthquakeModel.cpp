@@ -15,15 +15,14 @@
 #include "MarbleModel.h"
 #include "GeoDataCoordinates.h"
 #include "GeoDataLatLonAltBox.h"
+#include "JsonStreamReader.h"
 #include "MarbleDebug.h"
 
 #include <QDebug>
 #include <QString>
 #include <QUrl>
 #include <QMessageBox>
-#include <QScriptEngine>
-#include <QScriptValue>
-#include <QScriptValueIterator>
+#include <QVariant>
 
 namespace Marble {
 
@@ -74,27 +73,22 @@ void EarthquakeModel::getAdditionalItems( const GeoDataLatLonAltBox& box, qint32
 
 void EarthquakeModel::parseFile( const QByteArray& file )
 {
-    QScriptValue data;
-    QScriptEngine engine;
-
-    // Qt requires parentheses around json code
-    data = engine.evaluate( '(' + QString( file ) + ')' );
+    const QVariantMap data = JsonStreamReader::parse( file ).toMap();
 
     // Parse if any result exists
-    if ( data.property( "earthquakes" ).isArray() ) {
-        QScriptValueIterator iterator( data.property( "earthquakes" ) );
+    if ( data.value( "earthquakes" ).type() == QVariant::List ) {
         // Add items to the list
         QList<AbstractDataPluginItem*> items;
-        while ( iterator.hasNext() ) {
-            iterator.next();
-            // Converting earthquake's properties from QScriptValue to appropriate types
-            QString eqid = iterator.value().property( "eqid" ).toString(); // Earthquake's ID
-            double longitude = iterator.value().property( "lng" ).toNumber();
-            double latitude = iterator.value().property( "lat" ).toNumber();
-            double magnitude = iterator.value().property( "magnitude" ).toNumber();
-            QString data = iterator.value().property( "datetime" ).toString();
+        foreach ( const QVariant &value, data.value( "earthquakes" ).toList() ) {
+            const QVariantMap earthquake = value.toMap();
+            // Converting earthquake's properties from QVariant to appropriate types
+            QString eqid = earthquake.value( "eqid" ).toString(); // Earthquake's ID
+            double longitude = earthquake.value( "lng" ).toDouble();
+            double latitude = earthquake.value( "lat" ).toDouble();
+            double magnitude = earthquake.value( "magnitude" ).toDouble();
+            QString data = earthquake.value( "datetime" ).toString();
             QDateTime date = QDateTime::fromString( data, "yyyy-MM-dd hh:mm:ss" );
-            double depth = iterator.value().property( "depth" ).toNumber();
+            double depth = earthquake.value( "depth" ).toDouble();
 
             if( date <= m_endDate && date >= m_startDate && magnitude >= m_minMagnitude ) {
                 if( !itemExists( eqid ) ) {
@@ -174,9 +174,8 @@ void ElevationProfileFloatItem::changeViewport( ViewportParams *viewport )
         if ( !m_isInitialized && !smallScreen ) {
             setPosition( QPointF( (viewport->width() - contentSize().width()) / 2 , 10.5 ) );
         }
+        update();
     }
-
-    update();
 }
 
 void ElevationProfileFloatItem::paintContent( QPainter *painter )
@@ -494,6 +493,7 @@ bool ElevationProfileFloatItem::eventFilter( QObject *object, QEvent *e )
                     if ( m_documentIndex < 0 ) {
                         m_documentIndex = treeModel->addDocument( &m_markerDocument );
                     }
+                    update();
                     emit repaintNeeded();
                 }
 
@@ -505,6 +505,7 @@ bool ElevationProfileFloatItem::eventFilter( QObject *object, QEvent *e )
                 m_markerPlacemark->setCoordinate( GeoDataCoordinates() ); // set to invalid
                 treeModel->removeDocument( &m_markerDocument );
                 m_documentIndex = -1;
+                update();
                 emit repaintNeeded();
             }
         }
@@ -539,6 +540,9 @@ void ElevationProfileFloatItem::updateVisiblePoints()
         return;
     }
 
+    const int firstVisiblePoint = m_firstVisiblePoint;
+    const int lastVisiblePoint = m_lastVisiblePoint;
+
     // find the longest visible route section on screen
     QList<QList<int> > routeSegments;
     QList<int> currentRouteSegment;
@@ -583,7 +587,10 @@ void ElevationProfileFloatItem::updateVisiblePoints()
         m_axisY.setRange( m_minElevation, m_maxElevation );
     }
 
-    return;
+    // the cached graph is only renewed if the visible section of the route changed
+    if ( m_firstVisiblePoint != firstVisiblePoint || m_lastVisiblePoint != lastVisiblePoint ) {
+        update();
+    }
 }
 
 QList<QPointF> ElevationProfileFloatItem::calculateElevationData( const GeoDataLineString &lineString ) const
@@ -685,6 +692,7 @@ void ElevationProfileFloatItem::writeSettings()
         m_zoomToViewport = false;
     }
 
+    update();
     emit settingsChanged( nameId() );
 }
 
@@ -697,6 +705,7 @@ void ElevationProfileFloatItem::toggleZoomToViewport()
         m_axisY.setRange( qMin( m_minElevation, qreal( 0.0 ) ), m_maxElevation );
     }
     readSettings();
+    update();
     emit settingsChanged( nameId() );
 }
 
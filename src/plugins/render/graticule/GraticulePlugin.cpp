@@ -52,6 +52,7 @@ GraticulePlugin::GraticulePlugin( const MarbleModel *marbleModel )
       m_gridCirclePen( Qt::white ),
       m_showPrimaryLabels( true ),
       m_showSecondaryLabels( true ),
+      m_revision( 0 ),
       m_isInitialized( false ),
       ui_configWidget( 0 ),
       m_configDialog( 0 )
@@ -187,6 +188,7 @@ void GraticulePlugin::setSettings( const QHash<QString,QVariant> &settings )
 
     m_showPrimaryLabels = primaryLabels;
     m_showSecondaryLabels = secondaryLabels;
+    ++m_revision;
 
     readSettings();
 }
@@ -253,6 +255,7 @@ void GraticulePlugin::writeSettings()
     m_gridCirclePen.setColor( ui_configWidget->gridPushButton->palette().color( QPalette::Button) );
     m_showPrimaryLabels = ui_configWidget->primaryCheckBox->isChecked();
     m_showSecondaryLabels = ui_configWidget->secondaryCheckBox->isChecked();
+    ++m_revision;
 
     emit settingsChanged( nameId() );
 }
@@ -295,6 +298,22 @@ qreal GraticulePlugin::zValue() const
     return 1.0;
 }
 
+bool GraticulePlugin::isThreadSafe() const
+{
+    // the settings are only changed by the GUI thread, which waits for the layers while the map is painted
+    return true;
+}
+
+qint64 GraticulePlugin::renderRevision() const
+{
+    // the line maps are rebuilt in render() if the notation changed
+    if ( m_currentNotation != GeoDataCoordinates::defaultNotation() ) {
+        return -1;
+    }
+
+    return m_revision;
+}
+
 void GraticulePlugin::renderGrid( GeoPainter *painter, ViewportParams *viewport,
                                   const QPen& equatorCirclePen,
                                   const QPen& tropicsCirclePen,
@@ -96,6 +96,10 @@ class GraticulePlugin : public RenderPlugin, public DialogConfigurationInterface
 
     virtual qreal zValue() const;
 
+    virtual bool isThreadSafe() const;
+
+    virtual qint64 renderRevision() const;
+
     virtual QHash<QString,QVariant> settings() const;
 
     virtual void setSettings( const QHash<QString,QVariant> &settings );
@@ -222,6 +226,7 @@ class GraticulePlugin : public RenderPlugin, public DialogConfigurationInterface
     QPen m_gridCirclePen;
     bool m_showPrimaryLabels;
     bool m_showSecondaryLabels;
+    qint64 m_revision;
 
     bool m_isInitialized;
 
@@ -50,10 +50,11 @@ OverviewMap::OverviewMap( const MarbleModel *marbleModel )
       m_configDialog( 0 ),
       m_mapChanged( false )
 {
-    // cache is no needed because:
-    // (1) the SVG overview map is already rendered and stored in m_worldmap pixmap
-    // (2) bounding box and location dot keep changing during navigation
-    setCacheMode( NoCache );
+    // bounding box and location dot keep changing during navigation, but the
+    // cache only needs to be renewed once they moved noticeably. The bounding
+    // box also changes with the projection at the same center and radius.
+    setRenderInputs( ViewportSizeInput | CenterInput | RadiusInput | ProjectionInput );
+    setRenderInputThreshold( RadiusInput, 0.01 );
     connect( this, SIGNAL(settingsChanged(QString)),
              this, SLOT(updateSettings()) );
 
@@ -175,15 +176,13 @@ void OverviewMap::changeViewport( ViewportParams *viewport )
         update();
     }
 
-    if ( !( m_latLonAltBox == latLonAltBox
-            && m_centerLon == centerLon
-            && m_centerLat == centerLat ) )
-    {
-        m_latLonAltBox = latLonAltBox;
-        m_centerLon = centerLon;
-        m_centerLat = centerLat;
-        update();
-    }
+    // Repainted by AbstractFloatItem once the location dot moved by half a pixel
+    const QSizeF mapSize = contentSize();
+    setRenderInputThreshold( CenterInput, 0.5 * qMin( 2 * M_PI / mapSize.width(), M_PI / mapSize.height() ) );
+
+    m_latLonAltBox = latLonAltBox;
+    m_centerLon = centerLon;
+    m_centerLat = centerLat;
 }
 
 void OverviewMap::paintContent( QPainter *painter )
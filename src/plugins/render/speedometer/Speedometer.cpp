@@ -136,6 +136,14 @@ void Speedometer::updateLocation( GeoDataCoordinates coordinates, qreal speed )
         break;
     }
 
+    // Position updates arrive frequently, but the cached item only needs
+    // to be repainted if the displayed digits change
+    const QString speedString = QString::number( speed, 'g', m_widget.speed->digitCount() );
+    if ( speedString == m_speedString && speedUnit == m_widget.speedUnit->text() ) {
+        return;
+    }
+    m_speedString = speedString;
+
     m_widget.speed->display( speed );
     m_widget.speedUnit->setText( speedUnit );
 
@@ -75,6 +75,7 @@ class Speedometer : public AbstractFloatItem
     MarbleLocale* m_locale;
     Ui::Speedometer m_widget;
     WidgetGraphicsItem* m_widgetItem;
+    QString m_speedString;
 };
 
 }
@@ -754,6 +754,9 @@ void StarsPlugin::loadStars()
     //mDebug() << Q_FUNC_INFO;
     // Load star data
     m_stars.clear();
+    m_starsX.clear();
+    m_starsY.clear();
+    m_starsZ.clear();
 
     QFile starFile( MarbleDirs::path( "stars/stars.dat" ) );
     starFile.open( QIODevice::ReadOnly );
@@ -807,6 +810,9 @@ void StarsPlugin::loadStars()
         StarPoint star( id, ( qreal )( ra ), ( qreal )( de ), ( qreal )( mag ), colorId );
         // Create entry in stars database
         m_stars << star;
+        m_starsX << star.quaternion().v[Q_X];
+        m_starsY << star.quaternion().v[Q_Y];
+        m_starsZ << star.quaternion().v[Q_Z];
         // Create key,value pair in idHash table to map from star id to
         // index in star database vector
         m_idHash[id] = starIndex;
@@ -1062,6 +1068,15 @@ bool StarsPlugin::render( GeoPainter *painter, ViewportParams *viewport,
         matrix skyAxisMatrix;
         skyAxis.inverse().toMatrix( skyAxisMatrix );
 
+        // Rotate all stars at once, they are used by the constellations, too
+        const int starCount = m_stars.size();
+        m_viewX.resize( starCount );
+        m_viewY.resize( starCount );
+        m_viewZ.resize( starCount );
+        Quaternion::rotateAroundAxis( skyAxisMatrix,
+                                      m_starsX.constData(), m_starsY.constData(), m_starsZ.constData(),
+                                      m_viewX.data(), m_viewY.data(), m_viewZ.data(), starCount );
+
         if ( m_renderCelestialPole ) {
 
             polesPen.setWidth( 2 );
@@ -1217,24 +1232,17 @@ bool StarsPlugin::render( GeoPainter *painter, ViewportParams *viewport,
                                  << m_constellations.at( c ).name();
                         continue;
                     }
-                    // Fetch quaternion from star s in constellation c
-                    Quaternion q1 = m_stars.at( idx1 ).quaternion();
-                    // Fetch quaternion from star s+1 in constellation c
-                    Quaternion q2 = m_stars.at( idx2 ).quaternion();
-
-                    q1.rotateAroundAxis( skyAxisMatrix );
-                    q2.rotateAroundAxis( skyAxisMatrix );
-
-                    if ( q1.v[Q_Z] > 0 || q2.v[Q_Z] > 0 ) {
+                    // Skip segments whose stars s or s+1 in constellation c are behind the earth
+                    if ( m_viewZ[idx1] > 0 || m_viewZ[idx2] > 0 ) {
                         continue;
                     }
 
 
                     // Let (x, y) be the position on the screen of the placemark..
-                    int x1 = ( int )( viewport->width()  / 2 + skyRadius * q1.v[Q_X] );
-                    int y1 = ( int )( viewport->height() / 2 - skyRadius * q1.v[Q_Y] );
-                    int x2 = ( int )( viewport->width()  / 2 + skyRadius * q2.v[Q_X] );
-                    int y2 = ( int )( viewport->height() / 2 - skyRadius * q2.v[Q_Y] );
+                    int x1 = ( int )( viewport->width()  / 2 + skyRadius * m_viewX[idx1] );
+                    int y1 = ( int )( viewport->height() / 2 - skyRadius * m_viewY[idx1] );
+                    int x2 = ( int )( viewport->width()  / 2 + skyRadius * m_viewX[idx2] );
+                    int y2 = ( int )( viewport->height() / 2 - skyRadius * m_viewY[idx2] );
 
 
                     xMean = xMean + x1 + x2;
@@ -1267,20 +1275,16 @@ bool StarsPlugin::render( GeoPainter *painter, ViewportParams *viewport,
 
         // Render Stars
 
-        for ( int s = 0; s < m_stars.size(); ++s  ) {
-            Quaternion  qpos = m_stars.at(s).quaternion();
-
-            qpos.rotateAroundAxis( skyAxisMatrix );
-
-            if ( qpos.v[Q_Z] > 0 ) {
+        for ( int s = 0; s < starCount; ++s  ) {
+            if ( m_viewZ[s] > 0 ) {
                 continue;
             }
 
-            qreal  earthCenteredX = qpos.v[Q_X] * skyRadius;
-            qreal  earthCenteredY = qpos.v[Q_Y] * skyRadius;
+            qreal  earthCenteredX = m_viewX[s] * skyRadius;
+            qreal  earthCenteredY = m_viewY[s] * skyRadius;
 
             // Don't draw high placemarks (e.g. satellites) that aren't visible.
-            if ( qpos.v[Q_Z] < 0
+            if ( m_viewZ[s] < 0
                     && ( ( earthCenteredX * earthCenteredX
                            + earthCenteredY * earthCenteredY )
                          < earthRadius * earthRadius ) ) {
@@ -1288,8 +1292,8 @@ bool StarsPlugin::render( GeoPainter *painter, ViewportParams *viewport,
             }
 
             // Let (x, y) be the position on the screen of the placemark..
-            const int x = ( int )( viewport->width()  / 2 + skyRadius * qpos.v[Q_X] );
-            const int y = ( int )( viewport->height() / 2 - skyRadius * qpos.v[Q_Y] );
+            const int x = ( int )( viewport->width()  / 2 + skyRadius * m_viewX[s] );
+            const int y = ( int )( viewport->height() / 2 - skyRadius * m_viewY[s] );
 
             // Skip placemarks that are outside the screen area
             if ( x < 0 || x >= viewport->width()
@@ -223,6 +223,14 @@ private:
     bool m_constellationsLoaded;
     bool m_dsosLoaded;
     QVector<StarPoint> m_stars;
+    // unit vectors of m_stars, kept in separate arrays to rotate them at once
+    QVector<qreal> m_starsX;
+    QVector<qreal> m_starsY;
+    QVector<qreal> m_starsZ;
+    // m_starsX, m_starsY and m_starsZ rotated into the current view
+    QVector<qreal> m_viewX;
+    QVector<qreal> m_viewY;
+    QVector<qreal> m_viewZ;
     QPixmap m_pixmapSun;
     QVector<Constellation> m_constellations;
     QVector<DsoPoint> m_dsos;
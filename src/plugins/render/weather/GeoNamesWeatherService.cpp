@@ -13,14 +13,12 @@
 #include "WeatherData.h"
 #include "GeoNamesWeatherItem.h"
 #include "GeoDataLatLonAltBox.h"
+#include "JsonStreamReader.h"
 #include "MarbleModel.h"
 #include "MarbleDebug.h"
 
 #include <QUrl>
 #include <QDateTime>
-#include <QScriptEngine>
-#include <QScriptValue>
-#include <QScriptValueIterator>
 
 #if QT_VERSION >= 0x050000
   #include <QUrlQuery>
@@ -91,26 +89,20 @@ void GeoNamesWeatherService::getItem( const QString &id )
 
 void GeoNamesWeatherService::parseFile( const QByteArray& file )
 {
-    QScriptValue data;
-    QScriptEngine engine;
-
-    // Qt requires parentheses around json code
-    data = engine.evaluate( '(' + QString( file ) + ')' );
+    const QVariantMap data = JsonStreamReader::parse( file ).toMap();
 
     // Parse if any result exists
     QList<AbstractDataPluginItem*> items;
-    if ( data.property( "weatherObservations" ).isArray() ) {
-        QScriptValueIterator iterator( data.property( "weatherObservations" ) );
+    if ( data.value( "weatherObservations" ).type() == QVariant::List ) {
         // Add items to the list
-        while ( iterator.hasNext() ) {
-            iterator.next();
-            AbstractDataPluginItem* item = parse( iterator.value() );
+        foreach ( const QVariant &value, data.value( "weatherObservations" ).toList() ) {
+            AbstractDataPluginItem* item = parse( value.toMap() );
             if ( item ) {
                 items << item;
             }
         }
     } else {
-        AbstractDataPluginItem* item = parse( data.property( "weatherObservation" ) );
+        AbstractDataPluginItem* item = parse( data.value( "weatherObservation" ).toMap() );
         if ( item ) {
             items << item;
         }
@@ -119,21 +111,22 @@ void GeoNamesWeatherService::parseFile( const QByteArray& file )
     emit createdItems( items );
 }
 
-AbstractDataPluginItem *GeoNamesWeatherService::parse( const QScriptValue &value )
+AbstractDataPluginItem *GeoNamesWeatherService::parse( const QVariantMap &value )
 {
-    QString condition = value.property( "weatherCondition" ).toString();
-    QString clouds = value.property( "clouds" ).toString();
-    int windDirection = value.property( "windDirection" ).toInteger();
-    QString id = value.property( "ICAO" ).toString();
-    int temperature = value.property( "temperature" ).toInteger();
-    int windSpeed = value.property( "windSpeed" ).toInteger();
-    int humidity = value.property( "humidity" ).toInteger();
-    double pressure = value.property( "seaLevelPressure" ).toNumber();
-    QString name = value.property( "stationName" ).toString();
+    // Numbers are sometimes given as strings, converting to double handles both
+    QString condition = value.value( "weatherCondition" ).toString();
+    QString clouds = value.value( "clouds" ).toString();
+    int windDirection = int( value.value( "windDirection" ).toDouble() );
+    QString id = value.value( "ICAO" ).toString();
+    int temperature = int( value.value( "temperature" ).toDouble() );
+    int windSpeed = int( value.value( "windSpeed" ).toDouble() );
+    int humidity = int( value.value( "humidity" ).toDouble() );
+    double pressure = value.value( "seaLevelPressure" ).toDouble();
+    QString name = value.value( "stationName" ).toString();
     QDateTime date = QDateTime::fromString(
-                value.property( "datetime" ).toString(), "yyyy-MM-dd hh:mm:ss" );
-    double longitude = value.property( "lng" ).toNumber();
-    double latitude = value.property( "lat" ).toNumber();
+                value.value( "datetime" ).toString(), "yyyy-MM-dd hh:mm:ss" );
+    double longitude = value.value( "lng" ).toDouble();
+    double latitude = value.value( "lat" ).toDouble();
 
     if ( !id.isEmpty() ) {
         WeatherData data;
@@ -10,13 +10,73 @@
 #include "GpxRunner.h"
 
 #include "GeoDataDocument.h"
+#include "GeoDataMultiGeometry.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTypes.h"
+#include "GeoParallelParser.h"
 #include "GpxParser.h"
+#include "MarbleDebug.h"
 
 #include <QFile>
 
 namespace Marble
 {
 
+/**
+ * Parses large GPX files in chunks, split before track segments
+ */
+class GpxParallelParser : public GeoParallelParser
+{
+public:
+    GpxParallelParser() : GeoParallelParser( "trkseg" ) {}
+
+protected:
+    virtual GeoParser *createParser() const
+    {
+        return new GpxParser;
+    }
+
+    virtual void mergeDocument( GeoDataDocument *document, GeoDataDocument *chunk ) const
+    {
+        // A chunk starting with a track segment continues the last track of the
+        // previous chunk. Its placemark only stems from the wrapping <trk> tag.
+        GeoDataMultiGeometry *tracks = multiGeometry( document, document->size() - 1 );
+        GeoDataMultiGeometry *continued = multiGeometry( chunk, 0 );
+        if ( tracks && continued ) {
+            while ( continued->size() > 0 ) {
+                GeoDataGeometry *track = continued->child( 0 );
+                continued->remove( 0 );
+                tracks->append( track );
+            }
+            GeoDataFeature *placemark = chunk->child( 0 );
+            chunk->remove( 0 );
+            delete placemark;
+        }
+
+        mergeContainer( document, chunk );
+    }
+
+private:
+    static GeoDataMultiGeometry *multiGeometry( GeoDataDocument *document, int index )
+    {
+        if ( index < 0 || index >= document->size() ) {
+            return 0;
+        }
+
+        GeoDataFeature *feature = document->child( index );
+        if ( feature->nodeType() != GeoDataTypes::GeoDataPlacemarkType ) {
+            return 0;
+        }
+
+        GeoDataGeometry *geometry = static_cast<GeoDataPlacemark*>( feature )->geometry();
+        if ( !geometry || geometry->nodeType() != GeoDataTypes::GeoDataMultiGeometryType ) {
+            return 0;
+        }
+
+        return static_cast<GeoDataMultiGeometry*>( geometry );
+    }
+};
+
 GpxRunner::GpxRunner(QObject *parent) :
     ParsingRunner(parent)
 {
@@ -38,13 +98,28 @@ void GpxRunner::parseFile( const QString &fileName, DocumentRole role = UnknownD
     // Open file in right mode
     file.open( QIODevice::ReadOnly );
 
-    GpxParser parser;
+    GeoDocument* document = 0;
+    GpxParallelParser parallelParser;
+    if ( threadCount() > 1 && file.size() > 4 * qint64( parallelParser.chunkSize() ) ) {
+        parallelParser.setThreadCount( threadCount() );
+        if ( parallelParser.read( &file ) ) {
+            document = parallelParser.releaseDocument();
+        } else {
+            // Parse it the usual way to get a meaningful error message
+            mDebug() << "Parallel parsing of" << fileName << "failed:" << parallelParser.errorString();
+            file.seek( 0 );
+        }
+    }
 
-    if ( !parser.read( &file ) ) {
-        emit parsingFinished( 0, parser.errorString() );
-        return;
+    if ( !document ) {
+        GpxParser parser;
+
+        if ( !parser.read( &file ) ) {
+            emit parsingFinished( 0, parser.errorString() );
+            return;
+        }
+        document = parser.releaseDocument();
     }
-    GeoDocument* document = parser.releaseDocument();
     Q_ASSERT( document );
     GeoDataDocument* doc = static_cast<GeoDataDocument*>( document );
     doc->setDocumentRole( role );
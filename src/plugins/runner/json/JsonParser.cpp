@@ -10,11 +10,15 @@
 
 #include "JsonParser.h"
 #include "GeoDataDocument.h"
+#include "GeoDataLinearRing.h"
 #include "GeoDataPlacemark.h"
+#include "GeoDataPoint.h"
 #include "GeoDataPolygon.h"
+#include "JsonStreamReader.h"
 
 #include "MarbleDebug.h"
 
+#include <QFile>
 #include <QIODevice>
 
 
@@ -43,266 +47,209 @@ bool JsonParser::read( QIODevice* device )
     m_document = new GeoDataDocument;
     Q_ASSERT( m_document );
 
-    // Read file data
-    QString fileData = QString::fromUtf8( device->readAll() );
-
-    // Create JSON parsing engine
-    // This engine evaluates and returns data from JSON
-    QScriptEngine m_engine;
+    // Read file data. Files are mapped into memory instead of copying them,
+    // GeoJSON files can be huge
+    QFile *file = qobject_cast<QFile*>( device );
+    uchar *mappedData = file ? file->map( 0, file->size() ) : 0;
+    const QByteArray fileData = mappedData ? QByteArray::fromRawData( reinterpret_cast<const char*>( mappedData ), file->size() )
+                                           : device->readAll();
+
+    // Parse the data as a stream of tokens, without building a tree of JSON values first
+    JsonStreamReader reader( fileData );
+    if ( reader.readNext() == JsonStreamReader::StartObject ) {
+        // Usually a FeatureCollection, but a single Feature is fine as well
+        readFeature( reader );
+    }
+    reader.readNext();
 
-    // Store the data into JSON for better managing
-    m_engine.evaluate( "var fileData = " + fileData );
+    if ( mappedData ) {
+        file->unmap( mappedData );
+    }
 
-    if (m_engine.hasUncaughtException()) {
-        mDebug() << "Error parsing GeoJSON : " << m_engine.uncaughtException().toString();
+    if ( reader.hasError() ) {
+        mDebug() << "Error parsing GeoJSON : " << reader.errorString();
         return false;
     }
 
-    // Start parsing
-
-    // In GeoJSON format, geometries are stored in features, so we iterate on features
-    if ( m_engine.evaluate( "fileData.features" ).isArray() ) {
-
-        // Parse each feature
-        for ( int featureCounter = 0 ; featureCounter < m_engine.evaluate( "fileData.features.length" ).toNumber() ; featureCounter ++) {
-
-            QString count = QString::number(featureCounter);
-
-            // Check if the feature contains a geometry
-            if ( !m_engine.evaluate( "fileData.features[" + count + "].geometry" ).isUndefined() ) {
-
-                // Variables for creating the geometry
-                QList<GeoDataGeometry*> geometryList;
-                QList<GeoDataPlacemark*> placemarkList;
-
-                // Create the different geometry types
-
-                if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.type" ).toString().toUpper() == "POLYGON" ) {
-
-                    // Check first that there are coordinates
-                    if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates" ).isArray() ) {
-
-                        GeoDataPolygon * geom = new GeoDataPolygon( RespectLatitudeCircle | Tessellate );
-
-                        // Coordinates first array will be the outer boundary, if there are more
-                        // positions those will be inner holes
-                        int ringsCount = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates.length" ).toNumber();
-                        for ( int rings = 0 ; rings < ringsCount ; rings ++ ) {
-
-                            QString ringCount = QString::number(rings);
-                            GeoDataLinearRing linearRing;
-
-                            int coordinatePairsCount = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[ " + ringCount + " ].length" ).toNumber();
-                            for( int coordinatePairs = 0 ; coordinatePairs < coordinatePairsCount ; coordinatePairs++ ) {
-
-                                QString coors = QString::number(coordinatePairs);
-                                qreal longitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + ringCount + "][" + coors + "][0]" ).toNumber();
-                                qreal latitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + ringCount + "][" + coors + "][1]" ).toNumber();
-
-                                linearRing.append( GeoDataCoordinates( longitude , latitude , 0 , GeoDataCoordinates::Degree ) );
-                            }
-
-                            // Outer ring
-                            if (rings == 0) {
-                                geom->setOuterBoundary( linearRing );
-                            }
-                            // Inner holes
-                            else {
-                                geom->appendInnerBoundary( linearRing );
-                            }
-                        }
-                        geometryList.append( geom );
-                    }
-
-                } else if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.type" ).toString().toUpper() == "MULTIPOLYGON" ) {
-
-                    // Check first that there are coordinates
-                    if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates" ).isArray() ) {
-
-                        int polygonsCount = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates.length" ).toNumber();
-                        for ( int polygons = 0 ; polygons < polygonsCount ; polygons++ ) {
-
-                            QString polygon = QString::number( polygons );
-                            GeoDataPolygon * geom = new GeoDataPolygon( RespectLatitudeCircle | Tessellate );
-
-                            // Coordinates first array will be the outer boundary, if there are more
-                            // positions those will be inner holes
-                            int ringsCount = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + polygon + "].length" ).toNumber();
-                            for ( int rings = 0 ; rings < ringsCount ; rings ++ ) {
-
-                                QString ringCount = QString::number(rings);
-                                GeoDataLinearRing linearRing;
-
-                                int coordinatePairsCount = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + polygon + "][ " + ringCount + " ].length" ).toNumber();
-                                for( int coordinatePairs = 0 ; coordinatePairs < coordinatePairsCount ; coordinatePairs++ ) {
-
-                                    QString coors = QString::number(coordinatePairs);
-                                    qreal longitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + polygon + "][" + ringCount + "][" + coors + "][0]" ).toNumber();
-                                    qreal latitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + polygon + "][" + ringCount + "][" + coors + "][1]" ).toNumber();
-
-                                    linearRing.append( GeoDataCoordinates( longitude , latitude , 0 , GeoDataCoordinates::Degree ) );
-                                }
-
-                                // Outer ring
-                                if (rings == 0) {
-                                    geom->setOuterBoundary( linearRing );
-                                }
-                                // Inner holes
-                                else {
-                                    geom->appendInnerBoundary( linearRing );
-                                }
-                            }
-                            geometryList.append( geom );
-                        }
-                    }
-
-                } else if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.type" ).toString().toUpper() == "LINESTRING" ) {
-
-                    // Check first that there are coordinates
-                    if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates" ).isArray() ) {
-
-                        GeoDataLineString * geom = new GeoDataLineString( RespectLatitudeCircle | Tessellate );
-
-                        int coordinatePairsCount = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates.length" ).toNumber();
-                        for( int coordinatePairs = 0 ; coordinatePairs < coordinatePairsCount ; coordinatePairs++ ) {
-
-                            QString coors = QString::number(coordinatePairs);
-
-                            qreal longitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + coors + "][0]" ).toNumber();
-                            qreal latitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + coors + "][1]" ).toNumber();
-
-                            geom->append( GeoDataCoordinates( longitude , latitude , 0 , GeoDataCoordinates::Degree ) );
-                        }
-                        geometryList.append( geom );
-                    }
-
-                } else if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.type" ).toString().toUpper() == "MULTILINESTRING" ) {
-
-                    // Check first that there are coordinates
-                    if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates" ).isArray() ) {
-
-                        int linestringsCount = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates.length" ).toNumber();
-                        for( int linestrings = 0 ; linestrings < linestringsCount ; linestrings++ ) {
-
-                            QString linestring = QString::number( linestrings );
-                            GeoDataLineString * geom = new GeoDataLineString( RespectLatitudeCircle | Tessellate );
-
-                            int coordinatePairsCount = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + linestring + "].length" ).toNumber();
-                            for( int coordinatePairs = 0 ; coordinatePairs < coordinatePairsCount ; coordinatePairs++ ) {
-
-                                QString coors = QString::number(coordinatePairs);
-
-                                qreal longitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + linestring + "][" + coors + "][0]" ).toNumber();
-                                qreal latitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + linestring + "][" + coors + "][1]" ).toNumber();
-
-                                geom->append( GeoDataCoordinates( longitude , latitude , 0 , GeoDataCoordinates::Degree ) );
-                            }
-                            geometryList.append( geom );
-                        }
-                    }
-
-                } else if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.type" ).toString().toUpper() == "POINT" ) {
-
-                    // Check first that there are coordinates
-                    if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates" ).isArray() ) {
-
-                        GeoDataPoint * geom = new GeoDataPoint();
-
-                        qreal longitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[0]" ).toNumber();
-                        qreal latitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[1]" ).toNumber();
-
-                        geom->setCoordinates( GeoDataCoordinates( longitude , latitude , 0 , GeoDataCoordinates::Degree ) );
-
-                        geometryList.append( geom );
-                    }
-                } else if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.type" ).toString().toUpper() == "MULTIPOINT" ) {
-
-                    // Check first that there are coordinates
-                    if ( m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates" ).isArray() ) {
-
-                        int pointsCount = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates.length" ).toNumber();
-                        for( int points = 0 ; points < pointsCount ; points++ ) {
-
-                            QString point = QString::number(points);
+    return true;
+}
 
-                            GeoDataPoint * geom = new GeoDataPoint();
+void JsonParser::readFeature( JsonStreamReader &reader )
+{
+    // Variables for creating the geometry
+    QList<GeoDataGeometry*> geometryList;
+    QString name;
+    GeoDataFeature::GeoDataVisualCategory category = GeoDataFeature::None;
+
+    // Members can come in any order, e.g. properties before the geometry
+    while ( reader.readNextChild() ) {
+        if ( reader.isName( "features" ) && reader.tokenType() == JsonStreamReader::StartArray ) {
+            // In GeoJSON format, geometries are stored in features, so we iterate on features
+            while ( reader.readNextChild() ) {
+                if ( reader.tokenType() == JsonStreamReader::StartObject ) {
+                    readFeature( reader );
+                } else {
+                    reader.skipValue();
+                }
+            }
+        } else if ( reader.isName( "geometry" ) && reader.tokenType() == JsonStreamReader::StartObject ) {
+            readGeometry( reader, geometryList );
+        } else if ( reader.isName( "properties" ) && reader.tokenType() == JsonStreamReader::StartObject ) {
+            readProperties( reader, name, category );
+        } else {
+            reader.skipValue();
+        }
+    }
 
-                            qreal longitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + point + "][0]" ).toNumber();
-                            qreal latitude = m_engine.evaluate( "fileData.features[" + count + "].geometry.coordinates[" + point + "][1]" ).toNumber();
+    if ( reader.hasError() ) {
+        qDeleteAll( geometryList );
+        return;
+    }
 
-                            geom->setCoordinates( GeoDataCoordinates( longitude , latitude , 0 , GeoDataCoordinates::Degree ) );
+    // Create a placemark for each geometry, there could be multi geometries
+    // that are translated into more than one geometry/placemark
+    foreach ( GeoDataGeometry *geometry, geometryList ) {
+        GeoDataPlacemark * placemark = new GeoDataPlacemark();
+        placemark->setName( name );
+        if ( category != GeoDataFeature::None ) {
+            placemark->setVisualCategory( category );
+        }
+        placemark->setGeometry( geometry );
+        placemark->setVisible( true );
+        m_document->append( placemark );
+    }
+}
 
-                            geometryList.append( geom );
-                        }
-                    }
+void JsonParser::readGeometry( JsonStreamReader &reader, QList<GeoDataGeometry*> &geometries )
+{
+    QString type;
+    Coordinates coordinates;
+
+    while ( reader.readNextChild() ) {
+        if ( reader.isName( "type" ) && reader.tokenType() == JsonStreamReader::String ) {
+            type = reader.stringValue().toUpper();
+        } else if ( reader.isName( "coordinates" ) && reader.tokenType() == JsonStreamReader::StartArray ) {
+            readCoordinates( reader, coordinates );
+        } else if ( reader.isName( "geometries" ) && reader.tokenType() == JsonStreamReader::StartArray ) {
+            // GeometryCollection
+            while ( reader.readNextChild() ) {
+                if ( reader.tokenType() == JsonStreamReader::StartObject ) {
+                    readGeometry( reader, geometries );
+                } else {
+                    reader.skipValue();
                 }
+            }
+        } else {
+            reader.skipValue();
+        }
+    }
 
+    if ( !reader.hasError() ) {
+        createGeometries( type, coordinates, geometries );
+    }
+}
 
-                // Parse the features properties
-                if ( !geometryList.isEmpty() != 0 && !m_engine.evaluate( "fileData.features[" + count + "].properties" ).isUndefined() ) {
-
-                    QScriptValue properties = m_engine.evaluate( "fileData.features[" + count + "].properties" );
-                    QScriptValueIterator propertyIterator ( properties );
-                    GeoDataFeature::GeoDataVisualCategory category = GeoDataFeature::None;
-
-                    // First create a placemark for each geometry, there could be multi geometries
-                    // that are translated into more than one geometry/placemark
-                    for ( int numberGeometries = 0 ; numberGeometries < geometryList.length() ; numberGeometries++ ) {
-                        GeoDataPlacemark * placemark = new GeoDataPlacemark();
-                        placemarkList.append( placemark );
-                    }
-
-                    while ( propertyIterator.hasNext() ) {
-                        propertyIterator.next();
-
-                        // If the property read, is the features name
-                        if ( propertyIterator.name() == "name" ) {
-                            for ( int pl = 0 ; pl < placemarkList.length() ; pl++) {
-                                placemarkList.at( pl )->setName( propertyIterator.value().toString() );
-                            }
-                        }
-                        // Else if the geometry still doesnt have a category, try if this
-                        // key-value properties match any OSM visual category
-                        else if ( category == GeoDataFeature::None ) {
-                            category = GeoDataFeature::OsmVisualCategory( propertyIterator.name().toLower() + '=' + propertyIterator.value().toString().toLower() );
-
-                            if ( category != GeoDataFeature::None ) {
-                                // Add the visual category to all the placemarks
-                                for ( int pl = 0 ; pl < placemarkList.length() ; pl++) {
-                                    placemarkList.at( pl )->setVisualCategory( category );
-                                }
-                            }
-                        }
-                    }
-                }
-
-                // Add the geometry to the document
-                if ( geometryList.length() == placemarkList.length() ) {
+int JsonParser::readCoordinates( JsonStreamReader &reader, Coordinates &coordinates )
+{
+    qreal values[2] = { 0.0, 0.0 };
+    int valueCount = 0;
+    int depth = 1;
+
+    while ( reader.readNextChild() ) {
+        if ( reader.tokenType() == JsonStreamReader::Number ) {
+            // A position, the altitude is ignored
+            if ( valueCount < 2 ) {
+                values[valueCount] = reader.numberValue();
+            }
+            ++valueCount;
+        } else if ( reader.tokenType() == JsonStreamReader::StartArray ) {
+            depth = readCoordinates( reader, coordinates ) + 1;
+        } else {
+            reader.skipValue();
+        }
+    }
 
-                    while( placemarkList.length() > 0 ) {
+    if ( depth == 1 ) {
+        if ( valueCount >= 2 ) {
+            coordinates.positions.append( GeoDataCoordinates( values[0], values[1], 0, GeoDataCoordinates::Degree ) );
+        }
+    } else if ( depth == 2 ) {
+        coordinates.lineEnds.append( coordinates.positions.size() );
+    } else if ( depth == 3 ) {
+        coordinates.polygonEnds.append( coordinates.lineEnds.size() );
+    }
 
-                        GeoDataPlacemark * placemark = placemarkList.last();
-                        placemarkList.pop_back();
+    return depth;
+}
 
-                        GeoDataGeometry * geom = geometryList.last();
-                        geometryList.pop_back();
+void JsonParser::readProperties( JsonStreamReader &reader, QString &name, GeoDataFeature::GeoDataVisualCategory &category )
+{
+    while ( reader.readNextChild() ) {
+        const JsonStreamReader::TokenType tokenType = reader.tokenType();
+        if ( tokenType != JsonStreamReader::String && tokenType != JsonStreamReader::Number
+             && tokenType != JsonStreamReader::Bool ) {
+            reader.skipValue();
+        }
+        // If the property read, is the features name
+        else if ( reader.isName( "name" ) ) {
+            name = reader.stringValue();
+        }
+        // Else if the geometry still doesnt have a category, try if this
+        // key-value properties match any OSM visual category
+        else if ( category == GeoDataFeature::None ) {
+            category = GeoDataFeature::OsmVisualCategory( reader.name().toLower() + '=' + reader.stringValue().toLower() );
+        }
+    }
+}
 
-                        placemark->setGeometry( geom );
-                        placemark->setVisible( true );
-                        m_document->append( placemark );
-                    }
+void JsonParser::createGeometries( const QString &type, const Coordinates &coordinates, QList<GeoDataGeometry*> &geometries )
+{
+    const QVector<GeoDataCoordinates> &positions = coordinates.positions;
+    const QVector<int> &lineEnds = coordinates.lineEnds;
+
+    if ( type == "POINT" || type == "MULTIPOINT" ) {
+        foreach ( const GeoDataCoordinates &position, positions ) {
+            GeoDataPoint * geom = new GeoDataPoint();
+            geom->setCoordinates( position );
+            geometries.append( geom );
+            if ( type == "POINT" ) {
+                break;
+            }
+        }
+    } else if ( type == "LINESTRING" || type == "MULTILINESTRING" ) {
+        int lineBegin = 0;
+        foreach ( int lineEnd, lineEnds ) {
+            GeoDataLineString * geom = new GeoDataLineString( RespectLatitudeCircle | Tessellate );
+            for ( int i = lineBegin; i < lineEnd; ++i ) {
+                geom->append( positions.at( i ) );
+            }
+            geometries.append( geom );
+            lineBegin = lineEnd;
+        }
+    } else if ( type == "POLYGON" || type == "MULTIPOLYGON" ) {
+        int lineIndex = 0;
+        int lineBegin = 0;
+        foreach ( int polygonEnd, coordinates.polygonEnds ) {
+            GeoDataPolygon * geom = new GeoDataPolygon( RespectLatitudeCircle | Tessellate );
+
+            // The first ring is the outer boundary, if there are more
+            // those will be inner holes
+            for ( int rings = 0; lineIndex < polygonEnd; ++lineIndex, ++rings ) {
+                GeoDataLinearRing linearRing;
+                for ( int i = lineBegin; i < lineEnds.at( lineIndex ); ++i ) {
+                    linearRing.append( positions.at( i ) );
                 }
+                lineBegin = lineEnds.at( lineIndex );
 
-                // If geometries or placemarks missing inside the lists, delete them
-                qDeleteAll( geometryList.begin(), geometryList.end() );
-                geometryList.clear();
-                qDeleteAll( placemarkList.begin(), placemarkList.end() );
-                placemarkList.clear();
+                if ( rings == 0 ) {
+                    geom->setOuterBoundary( linearRing );
+                } else {
+                    geom->appendInnerBoundary( linearRing );
+                }
             }
+            geometries.append( geom );
         }
     }
-    return true;
 }
 
 }
-
@@ -11,14 +11,17 @@
 #ifndef MARBLE_JSONPARSER_H
 #define MARBLE_JSONPARSER_H
 
+#include "GeoDataCoordinates.h"
 #include "GeoDataDocument.h"
 
-#include <QScriptEngine>
-#include <QScriptValue>
-#include <QScriptValueIterator>
+#include <QList>
+#include <QVector>
 
 namespace Marble {
 
+class GeoDataGeometry;
+class JsonStreamReader;
+
 class JsonParser
 {
 public:
@@ -39,6 +42,33 @@ public:
     GeoDataDocument* releaseDocument();
 
 private:
+    /**
+     * All positions of a geometry, no matter how deeply nested. The nesting
+     * is kept by remembering where the rings or lines and the polygons end.
+     */
+    struct Coordinates
+    {
+        QVector<GeoDataCoordinates> positions;
+        QVector<int> lineEnds;
+        QVector<int> polygonEnds;
+    };
+
+    /**
+     * @brief Reads a feature or a feature collection, adding placemarks to the document
+     */
+    void readFeature( JsonStreamReader &reader );
+
+    void readGeometry( JsonStreamReader &reader, QList<GeoDataGeometry*> &geometries );
+
+    /**
+     * @brief Reads the coordinates array the reader is positioned at
+     * @return the nesting depth, i.e. 1 for a position, 2 for a list of positions and so on
+     */
+    int readCoordinates( JsonStreamReader &reader, Coordinates &coordinates );
+
+    void readProperties( JsonStreamReader &reader, QString &name, GeoDataFeature::GeoDataVisualCategory &category );
+
+    static void createGeometries( const QString &type, const Coordinates &coordinates, QList<GeoDataGeometry*> &geometries );
 
     GeoDataDocument* m_document;
 };
@@ -10,6 +10,7 @@
 #include "KmlRunner.h"
 
 #include "GeoDataDocument.h"
+#include "GeoParallelParser.h"
 #include "KmlParser.h"
 #include "KmlDocument.h"
 #include "MarbleDebug.h"
@@ -24,6 +25,21 @@
 namespace Marble
 {
 
+/**
+ * Parses large KML files in chunks, split before top level placemarks
+ */
+class KmlParallelParser : public GeoParallelParser
+{
+public:
+    KmlParallelParser() : GeoParallelParser( "Placemark" ) {}
+
+protected:
+    virtual GeoParser *createParser() const
+    {
+        return new KmlParser;
+    }
+};
+
 KmlRunner::KmlRunner(QObject *parent) :
     ParsingRunner(parent)
 {
@@ -65,13 +81,28 @@ void KmlRunner::parseFile( const QString &fileName, DocumentRole role = UnknownD
     // Open file in right mode
     file.open( QIODevice::ReadOnly );
 
-    KmlParser parser;
+    GeoDocument* document = 0;
+    KmlParallelParser parallelParser;
+    if ( threadCount() > 1 && file.size() > 4 * qint64( parallelParser.chunkSize() ) ) {
+        parallelParser.setThreadCount( threadCount() );
+        if ( parallelParser.read( &file ) ) {
+            document = parallelParser.releaseDocument();
+        } else {
+            // Parse it the usual way to get a meaningful error message
+            mDebug() << "Parallel parsing of" << kmlFileName << "failed:" << parallelParser.errorString();
+            file.seek( 0 );
+        }
+    }
 
-    if ( !parser.read( &file ) ) {
-        emit parsingFinished( 0, parser.errorString() );
-        return;
+    if ( !document ) {
+        KmlParser parser;
+
+        if ( !parser.read( &file ) ) {
+            emit parsingFinished( 0, parser.errorString() );
+            return;
+        }
+        document = parser.releaseDocument();
     }
-    GeoDocument* document = parser.releaseDocument();
     Q_ASSERT( document );
     KmlDocument* doc = static_cast<KmlDocument*>( document );
     doc->setDocumentRole( role );
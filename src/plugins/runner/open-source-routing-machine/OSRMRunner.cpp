@@ -15,6 +15,7 @@
 #include "GeoDataDocument.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataExtendedData.h"
+#include "JsonStreamReader.h"
 #include "routing/Maneuver.h"
 #include "routing/RouteRequest.h"
 #include "TinyWebBrowser.h"
@@ -26,9 +27,6 @@
 #include <QTimer>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
-#include <QScriptValue>
-#include <QScriptEngine>
-#include <QScriptValueIterator>
 
 namespace Marble
 {
@@ -199,18 +197,16 @@ RoutingInstruction::TurnType OSRMRunner::parseTurnType( const QString &instructi
 
 GeoDataDocument *OSRMRunner::parse( const QByteArray &input )
 {
-    QScriptEngine engine;
-    // Qt requires parentheses around json code
-    QScriptValue const data = engine.evaluate( '(' + QString::fromUtf8( input ) + ')' );
+    QVariantMap const data = JsonStreamReader::parse( input ).toMap();
 
     GeoDataDocument* result = 0;
     GeoDataLineString* routeWaypoints = 0;
-    if ( data.property( "route_geometry" ).isString() ) {
+    if ( data.value( "route_geometry" ).type() == QVariant::String ) {
         result = new GeoDataDocument();
         result->setName( "Open Source Routing Machine" );
         GeoDataPlacemark* routePlacemark = new GeoDataPlacemark;
         routePlacemark->setName( "Route" );
-        routeWaypoints = decodePolyline( data.property( "route_geometry" ).toString() );
+        routeWaypoints = decodePolyline( data.value( "route_geometry" ).toString() );
         routePlacemark->setGeometry( routeWaypoints );
 
         QString name = "%1 %2 (OSRM)";
@@ -224,29 +220,25 @@ GeoDataDocument *OSRMRunner::parse( const QByteArray &input )
         result->append( routePlacemark );
     }
 
-    if ( result && routeWaypoints && data.property( "route_instructions" ).isArray() ) {
+    if ( result && routeWaypoints && data.value( "route_instructions" ).type() == QVariant::List ) {
         bool first = true;
-        QScriptValueIterator iterator( data.property( "route_instructions" ) );
         GeoDataPlacemark* instruction = new GeoDataPlacemark;
         int lastWaypointIndex = 0;
-        while ( iterator.hasNext() ) {
-            iterator.next();
-            QVariantList details = iterator.value().toVariant().toList();
+        foreach ( const QVariant &value, data.value( "route_instructions" ).toList() ) {
+            QVariantList details = value.toList();
             if ( details.size() > 7 ) {
                 QString const text = details.at( 0 ).toString();
                 QString const road = details.at( 1 ).toString();
                 int const waypointIndex = details.at( 3 ).toInt();
 
                 if ( waypointIndex < routeWaypoints->size() ) {
-                    if ( iterator.hasNext() ) {
-                        GeoDataLineString *lineString = new GeoDataLineString;
-                        for ( int i=lastWaypointIndex; i<=waypointIndex; ++i ) {
-                            lineString->append(routeWaypoints->at( i ) );
-                        }
-                        instruction->setGeometry( lineString );
-                        result->append( instruction );
-                        instruction = new GeoDataPlacemark;
+                    GeoDataLineString *lineString = new GeoDataLineString;
+                    for ( int i=lastWaypointIndex; i<=waypointIndex; ++i ) {
+                        lineString->append(routeWaypoints->at( i ) );
                     }
+                    instruction->setGeometry( lineString );
+                    result->append( instruction );
+                    instruction = new GeoDataPlacemark;
                     lastWaypointIndex = waypointIndex;
                     GeoDataExtendedData extendedData;
                     GeoDataData turnTypeData;
@@ -272,29 +264,23 @@ GeoDataDocument *OSRMRunner::parse( const QByteArray &input )
                         instruction->setName( RoutingInstruction::generateRoadInstruction( turnType, road ) );
                     }
                     instruction->setExtendedData( extendedData );
-
-                    if ( !iterator.hasNext() && lastWaypointIndex > 0 ) {
-                        GeoDataLineString *lineString = new GeoDataLineString;
-                        for ( int i=lastWaypointIndex; i<waypointIndex; ++i ) {
-                            lineString->append(routeWaypoints->at( i ) );
-                        }
-                        instruction->setGeometry( lineString );
-                        result->append( instruction );
-                    }
                 }
             }
         }
+        // the instruction for the destination has no segment to follow
+        delete instruction;
     }
 
-    if ( data.property( "hint_data" ).isValid() ) {
-        QVariantList hints = data.property( "hint_data" ).property( "locations" ).toVariant().toList();
+    if ( data.contains( "hint_data" ) ) {
+        QVariantMap const hintData = data.value( "hint_data" ).toMap();
+        QVariantList hints = hintData.value( "locations" ).toList();
         if ( hints.size() == m_cachedHints.size() ) {
             for ( int i=0; i<m_cachedHints.size(); ++i ) {
                 m_cachedHints[i].second = hints[i].toString();
             }
         }
 
-        m_hintChecksum = data.property( "hint_data" ).property( "checksum" ).toString();
+        m_hintChecksum = hintData.value( "checksum" ).toString();
     }
 
     return result;
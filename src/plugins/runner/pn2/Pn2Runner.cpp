@@ -38,6 +38,7 @@
 #include "GeoDataPlacemark.h"
 #include "MarbleDebug.h"
 
+#include <QBuffer>
 #include <QFile>
 #include <QFileInfo>
 
@@ -88,8 +89,7 @@ bool Pn2Runner::importPolygon( QDataStream &stream, GeoDataLineString* linestrin
         qreal degLat = ( 1.0 * lat / 120.0 );
         qreal degLon = ( 1.0 * lon / 120.0 );
 
-        GeoDataCoordinates *coord = new GeoDataCoordinates( degLon / 180 * M_PI, degLat / 180 * M_PI );
-        linestring->append( *coord );
+        linestring->append( GeoDataCoordinates( degLon / 180 * M_PI, degLat / 180 * M_PI ) );
 
         for ( qint16 relativeNode = 1; relativeNode <= nrRelativeNodes; ++relativeNode ) {
             stream >> relativeLat >> relativeLon;
@@ -104,8 +104,7 @@ bool Pn2Runner::importPolygon( QDataStream &stream, GeoDataLineString* linestrin
             qreal currDegLon = ( 1.0 * currLon / 120.0 );
 
 
-            GeoDataCoordinates *currCoord = new GeoDataCoordinates( currDegLon / 180 * M_PI, currDegLat / 180 * M_PI );
-            linestring->append( *currCoord );
+            linestring->append( GeoDataCoordinates( currDegLon / 180 * M_PI, currDegLat / 180 * M_PI ) );
         }
     }
 
@@ -128,7 +127,15 @@ void Pn2Runner::parseFile( const QString &fileName, DocumentRole role = UnknownD
     }
 
     file.open( QIODevice::ReadOnly );
-    QDataStream stream( &file );  // read the data serialized from the file
+
+    // Read the data serialized from the file through a memory mapping if possible
+    QBuffer buffer;
+    uchar *mapped = file.map( 0, file.size() );
+    if ( mapped ) {
+        buffer.setData( QByteArray::fromRawData( reinterpret_cast<const char*>( mapped ), file.size() ) );
+        buffer.open( QIODevice::ReadOnly );
+    }
+    QDataStream stream( mapped ? static_cast<QIODevice*>( &buffer ) : &file );
 
     GeoDataDocument *document = new GeoDataDocument();
     document->setDocumentRole( role );
@@ -178,10 +185,12 @@ void Pn2Runner::parseFile( const QString &fileName, DocumentRole role = UnknownD
             if ( flag == OUTERBOUNDARY ) {
                 polygon = new GeoDataPolygon;
                 polygon->setOuterBoundary( *linearring );
+                delete linearring;
             }
 
             if ( flag == INNERBOUNDARY ) {
                 polygon->appendInnerBoundary( *linearring );
+                delete linearring;
             }
         }
 
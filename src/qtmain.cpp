@@ -23,6 +23,7 @@
 #include "MarbleDebug.h"
 #include "MarbleTest.h"
 #include "MarbleLocale.h"
+#include "TraceRecorder.h"
 
 #ifdef STATIC_BUILD
  #include <QtPlugin>
@@ -94,6 +95,7 @@ int main(int argc, char *argv[])
     QString mapThemeId;
     QString coordinatesString;
     QString distanceString;
+    QString traceFile;
     MarbleGlobal::Profiles profiles = MarbleGlobal::detectProfiles();
 
     QStringList args = QApplication::arguments();
@@ -114,6 +116,9 @@ int main(int argc, char *argv[])
         qWarning() << "  --fps ...................... Show the paint performance (paint rate) in the top left corner";
         qWarning() << "  --runtimeTrace.............. Show the time spent and other debug info of each layer";
         qWarning() << "  --tile-id................... Write the identifier of texture tiles on top of them";
+        qWarning() << "  --parallelLayers............ Render thread-safe layers concurrently";
+        qWarning() << "  --trace=<file> ............. Record the time spent in each part of the render pipeline,";
+        qWarning() << "                               write it to <file> in Chrome trace format and print a summary on exit";
         qWarning() << "  --timedemo ................. Measure the paint performance while moving the map and quit";
         qWarning();
         qWarning() << "profile options (note that marble should automatically detect which profile to use. Override that with the options below):";
@@ -175,6 +180,12 @@ int main(int argc, char *argv[])
             // and error reporting to user (problem also exists with marbledatapath)
             mapThemeId = args.value( i );
         }
+        else if ( arg.startsWith( QLatin1String( "--trace=" ), Qt::CaseInsensitive ) )
+        {
+            traceFile = arg.mid(8);
+            // enabled early to cover the startup as well
+            TraceRecorder::setEnabled( true );
+        }
     }
     MarbleGlobal::getInstance()->setProfiles( profiles );
 
@@ -229,9 +240,21 @@ int main(int argc, char *argv[])
         else if( arg == "--runtimeTrace" ) {
             window->marbleControl()->marbleWidget()->setShowRuntimeTrace( true );
         }
+        else if( arg == "--parallelLayers" ) {
+            window->marbleControl()->marbleWidget()->setParallelRendering( true );
+        }
         else if ( i != dataPathIndex && QFile::exists( arg ) )
             window->addGeoDataFile( arg );
     }
 
-    return app.exec();
+    const int result = app.exec();
+
+    if ( !traceFile.isEmpty() ) {
+        if ( !TraceRecorder::saveChromeTrace( traceFile ) ) {
+            qWarning() << "Cannot write trace to" << traceFile;
+        }
+        qWarning() << qPrintable( TraceRecorder::summaryText() );
+    }
+
+    return result;
 }
@@ -9,11 +9,20 @@
 //
 
 #include <QtTest>
+#include "HttpStandIn.h"
 #include "TestUtils.h"
 
+#ifdef Q_OS_WIN
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
 #include "AbstractDataPluginModel.h"
 
 #include "AbstractDataPluginItem.h"
+#include "GeoDataLatLonAltBox.h"
+#include "MarbleDirs.h"
 #include "MarbleModel.h"
 #include "ViewportParams.h"
 
@@ -56,11 +65,64 @@ protected:
     }
 };
 
+/**
+ * Answers each request with its path
+ */
+class DataStandIn : public HttpStandIn
+{
+protected:
+    QByteArray respond( const QByteArray &path, const QByteArray &content, QByteArray &status )
+    {
+        Q_UNUSED( content )
+        Q_UNUSED( status )
+        return path;
+    }
+};
+
+/**
+ * Queries the stand-in server for the box and remembers the parsed files
+ */
+class DownloadingDataPluginModel : public AbstractDataPluginModel
+{
+    Q_OBJECT
+
+public:
+    DownloadingDataPluginModel( const QString &name, quint16 port, const MarbleModel *marbleModel ) :
+        AbstractDataPluginModel( name, marbleModel ),
+        m_port( port )
+    {}
+
+    QStringList queriedUrls() const { return m_queriedUrls; }
+    QList<QByteArray> parsedFiles() const { return m_parsedFiles; }
+
+protected:
+    void getAdditionalItems( const GeoDataLatLonAltBox &box, qint32 number )
+    {
+        const QString url = QString( "http://127.0.0.1:%1/%2/%3/%4/%5/%6" ).arg( m_port )
+                            .arg( box.west() ).arg( box.south() ).arg( box.east() ).arg( box.north() ).arg( number );
+        m_queriedUrls << url;
+        downloadDescriptionFile( QUrl( url ) );
+    }
+
+    void parseFile( const QByteArray &file )
+    {
+        m_parsedFiles << file;
+    }
+
+private:
+    quint16 m_port;
+    QStringList m_queriedUrls;
+    QList<QByteArray> m_parsedFiles;
+};
+
 class AbstractDataPluginModelTest : public QObject
 {
     Q_OBJECT
 
  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
     void init_testcase();
 
     void defaultConstructor();
@@ -76,13 +138,60 @@ class AbstractDataPluginModelTest : public QObject
     void setFavoriteItemsOnly_data();
     void setFavoriteItemsOnly();
 
+    void queryTiles();
+    void coalesceDownloads();
+    void coalesceOverlappingViews();
+    void cachedDownloads();
+    void removeExpiredDescriptions();
+
  private:
+    /**
+     * Sets the box of the model to the one of @p viewport and lets it query its items
+     */
+    static void queryItems( DownloadingDataPluginModel &model, const ViewportParams &viewport );
+
+    /**
+     * Returns true if @p model parsed @p count files in time
+     */
+    static bool waitForParsedFiles( const DownloadingDataPluginModel &model, int count );
+
     const MarbleModel m_marbleModel;
     static const ViewportParams fullViewport;
+    QString m_dataPath;
+    DataStandIn m_server;
 };
 
 const ViewportParams AbstractDataPluginModelTest::fullViewport( Equirectangular, 0, 0, 100, QSize( 230, 230 ) );
 
+void AbstractDataPluginModelTest::initTestCase()
+{
+    m_dataPath = setTemporaryDataPath( "datapluginmodel" );
+    QVERIFY( MarbleDirs::localPath().startsWith( m_dataPath ) );
+
+    QVERIFY( m_server.listen( QHostAddress::LocalHost ) );
+}
+
+void AbstractDataPluginModelTest::cleanupTestCase()
+{
+    removeDirectory( m_dataPath );
+}
+
+void AbstractDataPluginModelTest::queryItems( DownloadingDataPluginModel &model, const ViewportParams &viewport )
+{
+    model.items( &viewport, 10 );
+    QMetaObject::invokeMethod( &model, "handleChangedViewport" );
+}
+
+bool AbstractDataPluginModelTest::waitForParsedFiles( const DownloadingDataPluginModel &model, int count )
+{
+    for ( int i = 0; i < 100 && model.parsedFiles().size() < count; ++i ) {
+        QTest::qWait( 50 );
+    }
+    // no files parsed twice
+    QTest::qWait( 100 );
+    return model.parsedFiles().size() == count;
+}
+
 void AbstractDataPluginModelTest::init_testcase()
 {
     QCOMPARE( GeoDataLatLonBox( fullViewport.viewLatLonAltBox() ), GeoDataLatLonBox( 90, -90, 180, -180, GeoDataCoordinates::Degree ) );
@@ -235,6 +344,139 @@ void AbstractDataPluginModelTest::setFavoriteItemsOnly()
     QCOMPARE( static_cast<bool>( model.items( &fullViewport, 1 ).contains( item ) ), visible );
 }
 
+void AbstractDataPluginModelTest::queryTiles()
+{
+    DownloadingDataPluginModel model( "querytiles", m_server.serverPort(), &m_marbleModel );
+    const int requestCount = m_server.requestCount();
+
+    const ViewportParams viewport( Equirectangular, 0.3, 0.2, 1000, QSize( 230, 230 ) );
+    queryItems( model, viewport );
+    const int tileCount = model.queriedUrls().size();
+    QVERIFY( tileCount > 0 );
+    QVERIFY( tileCount <= 4 );
+    QVERIFY( waitForParsedFiles( model, tileCount ) );
+    QCOMPARE( m_server.requestCount() - requestCount, tileCount );
+
+    // Each tile is at least as large as the view, so it's only queried once.
+    // It is queried for enough items to keep the density of the view.
+    const qreal viewArea = viewport.viewLatLonAltBox().width() * viewport.viewLatLonAltBox().height();
+    foreach( const QByteArray &file, model.parsedFiles() ) {
+        const QList<QByteArray> box = file.split( '/' );
+        const qreal width = box.at( 3 ).toDouble() - box.at( 1 ).toDouble();
+        const qreal height = box.at( 4 ).toDouble() - box.at( 2 ).toDouble();
+        QVERIFY( width >= viewport.viewLatLonAltBox().width() );
+        QVERIFY( box.at( 5 ).toInt() * viewArea >= 10 * width * height );
+    }
+
+    // Small changes of the view don't query anything
+    const ViewportParams moved( Equirectangular, 0.301, 0.2, 1000, QSize( 230, 230 ) );
+    queryItems( model, moved );
+    QCOMPARE( model.queriedUrls().size(), tileCount );
+
+    // Tiles already queried are not queried again after panning
+    const ViewportParams panned( Equirectangular, 0.3 + viewport.viewLatLonAltBox().width(), 0.2, 1000, QSize( 230, 230 ) );
+    queryItems( model, panned );
+    const int pannedCount = model.queriedUrls().size();
+    QVERIFY( pannedCount > tileCount );
+    QVERIFY( pannedCount < 2 * tileCount + 1 );
+    QVERIFY( waitForParsedFiles( model, pannedCount ) );
+    QCOMPARE( model.queriedUrls().toSet().size(), pannedCount );
+    QCOMPARE( m_server.requestCount() - requestCount, pannedCount );
+}
+
+void AbstractDataPluginModelTest::coalesceDownloads()
+{
+    DownloadingDataPluginModel model( "coalesce", m_server.serverPort(), &m_marbleModel );
+    const int requestCount = m_server.requestCount();
+
+    const ViewportParams viewport( Equirectangular, -2.0, -0.5, 1000, QSize( 230, 230 ) );
+    queryItems( model, viewport );
+    const int tileCount = model.queriedUrls().size();
+
+    // Querying the same tiles again while they are downloaded
+    model.clear();
+    queryItems( model, viewport );
+    QCOMPARE( model.queriedUrls().size(), 2 * tileCount );
+
+    QVERIFY( waitForParsedFiles( model, tileCount ) );
+    QCOMPARE( m_server.requestCount() - requestCount, tileCount );
+}
+
+void AbstractDataPluginModelTest::coalesceOverlappingViews()
+{
+    DownloadingDataPluginModel model( "overlapping", m_server.serverPort(), &m_marbleModel );
+    const int requestCount = m_server.requestCount();
+
+    // Both views lie within the tile from 0 to 45 degree east and north
+    const ViewportParams viewport( Equirectangular, M_PI / 8, M_PI / 8, 1000, QSize( 230, 230 ) );
+    queryItems( model, viewport );
+    QCOMPARE( model.queriedUrls().size(), 1 );
+
+    // The second view queries the tile again before the first reply arrived,
+    // only the download manager keeps it from being requested twice
+    model.clear();
+    const ViewportParams overlapping( Equirectangular, M_PI / 8 + 0.1, M_PI / 8 - 0.1, 1000, QSize( 230, 230 ) );
+    queryItems( model, overlapping );
+    QCOMPARE( model.queriedUrls().size(), 2 );
+    QCOMPARE( model.queriedUrls().at( 1 ), model.queriedUrls().at( 0 ) );
+
+    QVERIFY( waitForParsedFiles( model, 1 ) );
+    QCOMPARE( m_server.requestCount() - requestCount, 1 );
+}
+
+void AbstractDataPluginModelTest::cachedDownloads()
+{
+    const ViewportParams viewport( Equirectangular, 1.0, 0.8, 1000, QSize( 230, 230 ) );
+    const int requestCount = m_server.requestCount();
+    QList<QByteArray> downloaded;
+
+    {
+        DownloadingDataPluginModel model( "cached", m_server.serverPort(), &m_marbleModel );
+        queryItems( model, viewport );
+        QVERIFY( waitForParsedFiles( model, model.queriedUrls().size() ) );
+        downloaded = model.parsedFiles();
+
+        // Cleared items are parsed again from memory
+        model.clear();
+        queryItems( model, viewport );
+        QCOMPARE( model.parsedFiles().size(), 2 * downloaded.size() );
+    }
+    QCOMPARE( m_server.requestCount() - requestCount, downloaded.size() );
+
+    // Another model finds them on disk
+    DownloadingDataPluginModel model( "cached", m_server.serverPort(), &m_marbleModel );
+    queryItems( model, viewport );
+    QVERIFY( model.parsedFiles().toSet() == downloaded.toSet() );
+    QCOMPARE( m_server.requestCount() - requestCount, downloaded.size() );
+}
+
+void AbstractDataPluginModelTest::removeExpiredDescriptions()
+{
+    const QString cachePath = MarbleDirs::localPath() + "/cache/expired/";
+    QVERIFY( QDir().mkpath( cachePath ) );
+
+    QStringList files;
+    files << "description_recent" << "description_expired" << "item_expired";
+    foreach( const QString &name, files ) {
+        QFile file( cachePath + name );
+        QVERIFY( file.open( QIODevice::WriteOnly ) );
+        file.write( "data" );
+    }
+
+    const uint time = QDateTime::currentDateTime().toTime_t() - 3600;
+    struct utimbuf times;
+    times.actime = time;
+    times.modtime = time;
+    utime( QFile::encodeName( cachePath + "description_expired" ).constData(), &times );
+    utime( QFile::encodeName( cachePath + "item_expired" ).constData(), &times );
+
+    // Only expired description files are removed when loading the model
+    const DownloadingDataPluginModel model( "expired", m_server.serverPort(), &m_marbleModel );
+    QVERIFY( QFile::exists( cachePath + "description_recent" ) );
+    QVERIFY( !QFile::exists( cachePath + "description_expired" ) );
+    QVERIFY( QFile::exists( cachePath + "item_expired" ) );
+}
+
 QTEST_MAIN( AbstractDataPluginModelTest )
 
 #include "AbstractDataPluginModelTest.moc"
@@ -14,6 +14,8 @@
 #include "MarbleModel.h"
 #include "PluginManager.h"
 #include "AbstractFloatItem.h"
+#include "GeoPainter.h"
+#include "ViewportParams.h"
 
 Q_DECLARE_METATYPE( const Marble::AbstractFloatItem * )
 
@@ -44,6 +46,28 @@ class NullFloatItem : public AbstractFloatItem
     RenderPlugin *newInstance( const MarbleModel * ) const { return 0; }
 };
 
+class CenterDependentFloatItem : public NullFloatItem
+{
+ public:
+    CenterDependentFloatItem( const MarbleModel *model ) :
+        NullFloatItem( model )
+    {
+        setRenderInputs( CenterInput | RadiusInput );
+        setRenderInputThreshold( CenterInput, 0.1 );
+        setRenderInputThreshold( RadiusInput, 0.1 );
+    }
+};
+
+class ProjectionDependentFloatItem : public NullFloatItem
+{
+ public:
+    ProjectionDependentFloatItem( const MarbleModel *model ) :
+        NullFloatItem( model )
+    {
+        setRenderInputs( CenterInput | ProjectionInput );
+    }
+};
+
 class AbstractFloatItemTest : public QObject
 {
     Q_OBJECT
@@ -63,6 +87,10 @@ class AbstractFloatItemTest : public QObject
     void setPosition_data();
     void setPosition();
 
+    void renderInputs();
+    void projectionInput();
+    void noCache();
+
  private:
     MarbleModel m_model;
     QList<const AbstractFloatItem *> m_factories;
@@ -185,6 +213,93 @@ void AbstractFloatItemTest::setPosition()
     delete instance;
 }
 
+void AbstractFloatItemTest::renderInputs()
+{
+    CenterDependentFloatItem item( &m_model );
+
+    QCOMPARE( item.renderInputs(), AbstractFloatItem::CenterInput | AbstractFloatItem::RadiusInput );
+    QCOMPARE( item.renderInputThreshold( AbstractFloatItem::CenterInput ), 0.1 );
+    QCOMPARE( item.renderInputThreshold( AbstractFloatItem::HeadingInput ), 0.0 );
+
+    ViewportParams viewport( Spherical, 0, 0, 1000, QSize( 640, 480 ) );
+    QImage image( viewport.size(), QImage::Format_ARGB32_Premultiplied );
+    GeoPainter painter( &image, &viewport );
+
+    item.render( &painter, &viewport );
+    QCOMPARE( item.cacheHits(), 0 );
+    QCOMPARE( item.cacheMisses(), 1 );
+
+    item.render( &painter, &viewport );
+    QCOMPARE( item.cacheHits(), 1 );
+    QCOMPARE( item.cacheMisses(), 1 );
+
+    // below the thresholds
+    viewport.centerOn( 0.05, 0.0 );
+    item.render( &painter, &viewport );
+    viewport.setRadius( 1050 );
+    item.render( &painter, &viewport );
+    QCOMPARE( item.cacheHits(), 3 );
+    QCOMPARE( item.cacheMisses(), 1 );
+
+    // small changes add up
+    viewport.centerOn( 0.15, 0.0 );
+    item.render( &painter, &viewport );
+    QCOMPARE( item.cacheHits(), 3 );
+    QCOMPARE( item.cacheMisses(), 2 );
+
+    viewport.setRadius( 1200 );
+    item.render( &painter, &viewport );
+    item.render( &painter, &viewport );
+    QCOMPARE( item.cacheHits(), 4 );
+    QCOMPARE( item.cacheMisses(), 3 );
+
+    // the size of the viewport was not declared as an input
+    viewport.setSize( QSize( 320, 240 ) );
+    item.render( &painter, &viewport );
+    QCOMPARE( item.cacheHits(), 5 );
+    QCOMPARE( item.cacheMisses(), 3 );
+
+    item.resetCacheStatistics();
+    QCOMPARE( item.cacheHits(), 0 );
+    QCOMPARE( item.cacheMisses(), 0 );
+}
+
+void AbstractFloatItemTest::projectionInput()
+{
+    ProjectionDependentFloatItem item( &m_model );
+
+    ViewportParams viewport( Spherical, 0, 0, 1000, QSize( 640, 480 ) );
+    QImage image( viewport.size(), QImage::Format_ARGB32_Premultiplied );
+    GeoPainter painter( &image, &viewport );
+
+    viewport.centerOn( 0.5, 0.5 );
+    item.render( &painter, &viewport );
+    item.render( &painter, &viewport );
+    QCOMPARE( item.cacheHits(), 1 );
+    QCOMPARE( item.cacheMisses(), 1 );
+
+    // same center and radius, but a different visible area
+    viewport.setProjection( Mercator );
+    item.render( &painter, &viewport );
+    QCOMPARE( item.cacheHits(), 1 );
+    QCOMPARE( item.cacheMisses(), 2 );
+}
+
+void AbstractFloatItemTest::noCache()
+{
+    CenterDependentFloatItem item( &m_model );
+    item.setCacheMode( AbstractFloatItem::NoCache );
+
+    ViewportParams viewport( Spherical, 0, 0, 1000, QSize( 640, 480 ) );
+    QImage image( viewport.size(), QImage::Format_ARGB32_Premultiplied );
+    GeoPainter painter( &image, &viewport );
+
+    item.render( &painter, &viewport );
+    item.render( &painter, &viewport );
+    QCOMPARE( item.cacheHits(), 0 );
+    QCOMPARE( item.cacheMisses(), 2 );
+}
+
 QTEST_MAIN( AbstractFloatItemTest )
 
 #include "AbstractFloatItemTest.moc"
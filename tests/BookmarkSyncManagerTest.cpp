@@ -0,0 +1,416 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <QBuffer>
+#include <QEventLoop>
+#include <QSignalSpy>
+#include <QTimer>
+#include <QtTest>
+
+#include "BookmarkManager.h"
+#include "GeoDataFolder.h"
+#include "GeoDataLookAt.h"
+#include "GeoDataTreeModel.h"
+#include "GeoWriter.h"
+#include "HttpStandIn.h"
+#include "MarbleDirs.h"
+#include "TestUtils.h"
+#include "cloudsync/BookmarkSyncManager.h"
+#include "cloudsync/CloudSyncManager.h"
+
+namespace Marble
+{
+
+/**
+ * Answers the bookmark requests of the ownCloud Marble app
+ */
+class CloudStandIn : public HttpStandIn
+{
+ public:
+    void setTimestamp( const QString &timestamp );
+    void setKml( const QByteArray &kml );
+
+    /**
+     * Returns the kml files uploaded so far
+     */
+    QList<QByteArray> uploads() const;
+
+ protected:
+    QByteArray respond( const QByteArray &path, const QByteArray &content, QByteArray &status );
+
+ private:
+    QString m_timestamp;
+    QByteArray m_kml;
+    QList<QByteArray> m_uploads;
+};
+
+void CloudStandIn::setTimestamp( const QString &timestamp )
+{
+    m_timestamp = timestamp;
+}
+
+void CloudStandIn::setKml( const QByteArray &kml )
+{
+    m_kml = kml;
+}
+
+QList<QByteArray> CloudStandIn::uploads() const
+{
+    return m_uploads;
+}
+
+QByteArray CloudStandIn::respond( const QByteArray &path, const QByteArray &content, QByteArray &status )
+{
+    if ( path.endsWith( "/bookmarks/timestamp" ) ) {
+        return "{\"data\":\"" + m_timestamp.toLatin1() + "\"}";
+    } else if ( path.endsWith( "/bookmarks/kml" ) ) {
+        return m_kml;
+    } else if ( path.endsWith( "/bookmarks/update" ) ) {
+        // the kml file is the only part of the multipart form data
+        const int start = content.indexOf( "<?xml" );
+        const int end = content.lastIndexOf( "</kml>" ) + 6;
+        m_kml = content.mid( start, end - start );
+        m_uploads << m_kml;
+        m_timestamp = QString::number( m_timestamp.toLongLong() + 1 );
+        return "{\"data\":\"" + m_timestamp.toLatin1() + "\"}";
+    }
+
+    status = "404 Not Found";
+    return QByteArray();
+}
+
+class BookmarkSyncManagerTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void initialSync();
+    void remoteChanges();
+    void remoteShrinks();
+    void mergeChanges();
+
+    void syncBenchmark_data();
+    void syncBenchmark();
+
+ private:
+    static GeoDataPlacemark createBookmark( int index );
+    static QVector<GeoDataPlacemark> createBookmarks( int count );
+    static QByteArray createKml( const QVector<GeoDataPlacemark> &bookmarks );
+    static QStringList names( const QByteArray &kml );
+
+    QString cachePath() const;
+    QString localBookmarksPath() const;
+
+    /**
+     * Replaces the last synced and the local bookmark file, an empty @p lastSynced or @p local removes them
+     */
+    void prepare( const QString &timestamp, const QByteArray &lastSynced, const QByteArray &local );
+
+    /**
+     * Runs a complete synchronization and returns true if it finished in time
+     */
+    bool synchronize( BookmarkSyncManager &syncManager );
+
+    QString m_dataPath;
+    CloudStandIn m_server;
+    CloudSyncManager m_cloudSyncManager;
+};
+
+void BookmarkSyncManagerTest::initTestCase()
+{
+    m_dataPath = setTemporaryDataPath( "bookmarksync" );
+    // never touch the bookmarks of the user
+    QVERIFY( MarbleDirs::localPath().startsWith( m_dataPath ) );
+
+    QVERIFY( m_server.listen( QHostAddress::LocalHost ) );
+    m_cloudSyncManager.setOwncloudServer( QString( "127.0.0.1:%1" ).arg( m_server.serverPort() ) );
+    m_cloudSyncManager.setOwncloudUsername( "marble" );
+    m_cloudSyncManager.setOwncloudPassword( "secret" );
+    m_cloudSyncManager.setSyncEnabled( true );
+}
+
+void BookmarkSyncManagerTest::cleanupTestCase()
+{
+    removeDirectory( m_dataPath );
+}
+
+GeoDataPlacemark BookmarkSyncManagerTest::createBookmark( int index )
+{
+    // about a kilometer apart
+    const GeoDataCoordinates coordinates( -170.0 + 0.01 * ( index % 1000 ), -80.0 + 0.01 * ( index / 1000 ),
+                                          0.0, GeoDataCoordinates::Degree );
+
+    GeoDataPlacemark bookmark( QString( "Bookmark %1" ).arg( index ) );
+    bookmark.setCoordinate( coordinates );
+    GeoDataLookAt *lookAt = new GeoDataLookAt;
+    lookAt->setCoordinates( coordinates );
+    lookAt->setRange( 1000.0 );
+    bookmark.setAbstractView( lookAt );
+
+    return bookmark;
+}
+
+QVector<GeoDataPlacemark> BookmarkSyncManagerTest::createBookmarks( int count )
+{
+    QVector<GeoDataPlacemark> bookmarks;
+    for ( int i = 0; i < count; ++i ) {
+        bookmarks << createBookmark( i );
+    }
+
+    return bookmarks;
+}
+
+QByteArray BookmarkSyncManagerTest::createKml( const QVector<GeoDataPlacemark> &bookmarks )
+{
+    GeoDataDocument document;
+    GeoDataFolder *folder = new GeoDataFolder;
+    folder->setName( "Default" );
+    foreach( const GeoDataPlacemark &bookmark, bookmarks ) {
+        folder->append( new GeoDataPlacemark( bookmark ) );
+    }
+    document.append( folder );
+
+    QBuffer buffer;
+    buffer.open( QIODevice::WriteOnly );
+    GeoWriter writer;
+    writer.write( &buffer, &document );
+
+    return buffer.data();
+}
+
+QStringList BookmarkSyncManagerTest::names( const QByteArray &kml )
+{
+    GeoDataDocument *document = parseKml( QString::fromUtf8( kml ) );
+
+    QStringList result;
+    foreach( const GeoDataPlacemark *placemark, document->placemarkList() ) {
+        result << placemark->name();
+    }
+    foreach( const GeoDataFolder *folder, document->folderList() ) {
+        foreach( const GeoDataPlacemark *placemark, folder->placemarkList() ) {
+            result << placemark->name();
+        }
+    }
+    delete document;
+
+    result.sort();
+    return result;
+}
+
+QString BookmarkSyncManagerTest::cachePath() const
+{
+    return MarbleDirs::localPath() + "/cloudsync/cache/bookmarks";
+}
+
+QString BookmarkSyncManagerTest::localBookmarksPath() const
+{
+    return MarbleDirs::localPath() + "/bookmarks/bookmarks.kml";
+}
+
+void BookmarkSyncManagerTest::prepare( const QString &timestamp, const QByteArray &lastSynced, const QByteArray &local )
+{
+    QDir().mkpath( MarbleDirs::localPath() );
+    removeDirectory( cachePath() );
+    if ( !lastSynced.isEmpty() ) {
+        QDir().mkpath( cachePath() );
+        QFile file( QString( "%1/%2.kml" ).arg( cachePath(), timestamp ) );
+        QVERIFY( file.open( QIODevice::WriteOnly ) );
+        file.write( lastSynced );
+    }
+
+    QFile::remove( localBookmarksPath() );
+    if ( !local.isEmpty() ) {
+        QDir().mkpath( QFileInfo( localBookmarksPath() ).path() );
+        QFile file( localBookmarksPath() );
+        QVERIFY( file.open( QIODevice::WriteOnly ) );
+        file.write( local );
+    }
+}
+
+bool BookmarkSyncManagerTest::synchronize( BookmarkSyncManager &syncManager )
+{
+    QSignalSpy spy( &syncManager, SIGNAL(syncComplete()) );
+    QEventLoop loop;
+    connect( &syncManager, SIGNAL(syncComplete()), &loop, SLOT(quit()) );
+    QTimer::singleShot( 120000, &loop, SLOT(quit()) );
+
+    syncManager.setBookmarkSyncEnabled( true );
+    loop.exec();
+    syncManager.setBookmarkSyncEnabled( false );
+
+    return spy.count() == 1;
+}
+
+void BookmarkSyncManagerTest::initialSync()
+{
+    GeoDataTreeModel model;
+    BookmarkManager bookmarkManager( &model );
+    BookmarkSyncManager syncManager( &m_cloudSyncManager );
+    syncManager.setBookmarkManager( &bookmarkManager );
+
+    const QByteArray remote = createKml( createBookmarks( 10 ) );
+    prepare( QString(), QByteArray(), QByteArray() );
+    m_server.setTimestamp( "1000000001" );
+    m_server.setKml( remote );
+    const int uploads = m_server.uploads().size();
+
+    QVERIFY( synchronize( syncManager ) );
+
+    QFile local( localBookmarksPath() );
+    QVERIFY( local.open( QIODevice::ReadOnly ) );
+    QCOMPARE( local.readAll(), remote );
+    QVERIFY( QFile::exists( cachePath() + "/1000000001.kml" ) );
+    QCOMPARE( m_server.uploads().size(), uploads );
+}
+
+void BookmarkSyncManagerTest::remoteChanges()
+{
+    GeoDataTreeModel model;
+    BookmarkManager bookmarkManager( &model );
+    BookmarkSyncManager syncManager( &m_cloudSyncManager );
+    syncManager.setBookmarkManager( &bookmarkManager );
+
+    const QVector<GeoDataPlacemark> bookmarks = createBookmarks( 10 );
+    QVector<GeoDataPlacemark> remoteBookmarks = bookmarks;
+    remoteBookmarks[3].setName( "Renamed remotely" );
+    remoteBookmarks << createBookmark( 10 );
+    const QByteArray remote = createKml( remoteBookmarks );
+
+    prepare( "1000000001", createKml( bookmarks ), createKml( bookmarks ) );
+    m_server.setTimestamp( "1000000002" );
+    m_server.setKml( remote );
+    const int uploads = m_server.uploads().size();
+
+    QVERIFY( synchronize( syncManager ) );
+
+    // without local changes the remote bookmarks are taken over as they are
+    QFile local( localBookmarksPath() );
+    QVERIFY( local.open( QIODevice::ReadOnly ) );
+    QCOMPARE( local.readAll(), remote );
+    QCOMPARE( QDir( cachePath() ).entryList( QStringList() << "*.kml" ), QStringList() << "1000000002.kml" );
+    QCOMPARE( m_server.uploads().size(), uploads );
+}
+
+void BookmarkSyncManagerTest::remoteShrinks()
+{
+    GeoDataTreeModel model;
+    BookmarkManager bookmarkManager( &model );
+    BookmarkSyncManager syncManager( &m_cloudSyncManager );
+    syncManager.setBookmarkManager( &bookmarkManager );
+
+    const QVector<GeoDataPlacemark> bookmarks = createBookmarks( 100 );
+    const QByteArray remote = createKml( bookmarks.mid( 0, 10 ) );
+
+    prepare( "1000000001", createKml( bookmarks ), createKml( bookmarks ) );
+    m_server.setTimestamp( "1000000002" );
+    m_server.setKml( remote );
+
+    QVERIFY( synchronize( syncManager ) );
+
+    // no trailing bytes of the longer local file may survive
+    QFile local( localBookmarksPath() );
+    QVERIFY( local.open( QIODevice::ReadOnly ) );
+    QCOMPARE( local.readAll(), remote );
+    QFile cached( cachePath() + "/1000000002.kml" );
+    QVERIFY( cached.open( QIODevice::ReadOnly ) );
+    QCOMPARE( cached.readAll(), remote );
+}
+
+void BookmarkSyncManagerTest::mergeChanges()
+{
+    GeoDataTreeModel model;
+    BookmarkManager bookmarkManager( &model );
+    BookmarkSyncManager syncManager( &m_cloudSyncManager );
+    syncManager.setBookmarkManager( &bookmarkManager );
+
+    const QVector<GeoDataPlacemark> bookmarks = createBookmarks( 10 );
+
+    QVector<GeoDataPlacemark> localBookmarks = bookmarks;
+    localBookmarks[1].setName( "Renamed locally" );
+    localBookmarks.remove( 2 );
+    localBookmarks << createBookmark( 10 );
+
+    QVector<GeoDataPlacemark> remoteBookmarks = bookmarks;
+    remoteBookmarks[3].setDescription( "Changed remotely" );
+    remoteBookmarks.remove( 4 );
+    remoteBookmarks << createBookmark( 11 );
+
+    prepare( "1000000001", createKml( bookmarks ), createKml( localBookmarks ) );
+    m_server.setTimestamp( "1000000002" );
+    m_server.setKml( createKml( remoteBookmarks ) );
+    const int uploads = m_server.uploads().size();
+
+    QVERIFY( synchronize( syncManager ) );
+
+    QCOMPARE( m_server.uploads().size(), uploads + 1 );
+    const QByteArray uploaded = m_server.uploads().last();
+    QStringList expected;
+    expected << "Bookmark 0" << "Renamed locally" << "Bookmark 3" << "Bookmark 5" << "Bookmark 6"
+             << "Bookmark 7" << "Bookmark 8" << "Bookmark 9" << "Bookmark 10" << "Bookmark 11";
+    expected.sort();
+    QCOMPARE( names( uploaded ), expected );
+    QVERIFY( uploaded.contains( "Changed remotely" ) );
+
+    QFile local( localBookmarksPath() );
+    QVERIFY( local.open( QIODevice::ReadOnly ) );
+    QCOMPARE( names( local.readAll() ), expected );
+    QCOMPARE( QDir( cachePath() ).entryList( QStringList() << "*.kml" ), QStringList() << "1000000003.kml" );
+}
+
+void BookmarkSyncManagerTest::syncBenchmark_data()
+{
+    QTest::addColumn<int>( "count" );
+
+    addRow() << 20000;
+}
+
+void BookmarkSyncManagerTest::syncBenchmark()
+{
+    QFETCH( int, count );
+
+    GeoDataTreeModel model;
+    BookmarkManager bookmarkManager( &model );
+    BookmarkSyncManager syncManager( &m_cloudSyncManager );
+    syncManager.setBookmarkManager( &bookmarkManager );
+
+    const QVector<GeoDataPlacemark> bookmarks = createBookmarks( count );
+
+    // a hundred changes on each side
+    QVector<GeoDataPlacemark> localBookmarks = bookmarks;
+    QVector<GeoDataPlacemark> remoteBookmarks = bookmarks;
+    for ( int i = 0; i < 50; ++i ) {
+        localBookmarks[2 * i].setName( QString( "Renamed %1" ).arg( i ) );
+        remoteBookmarks[2 * i + 1].setDescription( QString( "Changed %1" ).arg( i ) );
+        localBookmarks << createBookmark( count + i );
+        remoteBookmarks << createBookmark( count + 50 + i );
+    }
+
+    const QByteArray lastSynced = createKml( bookmarks );
+    const QByteArray local = createKml( localBookmarks );
+    const QByteArray remote = createKml( remoteBookmarks );
+
+    QBENCHMARK {
+        prepare( "1000000001", lastSynced, local );
+        m_server.setTimestamp( "1000000002" );
+        m_server.setKml( remote );
+        QVERIFY( synchronize( syncManager ) );
+    }
+
+    QCOMPARE( names( m_server.uploads().last() ).size(), count + 100 );
+}
+
+}
+
+QTEST_MAIN( Marble::BookmarkSyncManagerTest )
+
+#include "BookmarkSyncManagerTest.moc"
@@ -0,0 +1,285 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtTest>
+
+#ifdef Q_OS_WIN
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+#include "FileStorageWatcher.h"
+#include "TestUtils.h"
+
+namespace Marble
+{
+
+class FileStorageWatcherTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void buildIndex();
+    void deleteLeastRecentlyUsed();
+    void readIndexHeader();
+    void rebuildInconsistentIndex();
+    void rebuildCorruptIndex();
+
+    void startupBenchmark_data();
+    void startupBenchmark();
+
+ private:
+    /**
+     * Creates the tile with column @p x of @p level with @p size bytes,
+     * last modified @p age seconds ago. Returns its path relative to the data directory.
+     */
+    QString createTile( int level, int x, int size, int age = 1000 ) const;
+
+    /**
+     * Creates ten tiles of 1000 bytes in level 5, the first being the oldest,
+     * and a base tile of 1000 bytes
+     */
+    void createTiles() const;
+
+    QString tilePath( int level, int x ) const;
+
+    QString m_dataPath;
+};
+
+void FileStorageWatcherTest::initTestCase()
+{
+    // Files are only deleted in directories named data
+    m_dataPath = QDir::tempPath() + "/FileStorageWatcherTest/data";
+}
+
+void FileStorageWatcherTest::cleanupTestCase()
+{
+    removeDirectory( QDir::tempPath() + "/FileStorageWatcherTest" );
+}
+
+void FileStorageWatcherTest::init()
+{
+    removeDirectory( m_dataPath );
+    QVERIFY( QDir().mkpath( m_dataPath ) );
+}
+
+QString FileStorageWatcherTest::createTile( int level, int x, int size, int age ) const
+{
+    const QString relativePath = QString( "maps/earth/test/%1/%2/0.png" ).arg( level ).arg( x );
+    const QString path = m_dataPath + '/' + relativePath;
+    QDir().mkpath( QFileInfo( path ).absolutePath() );
+
+    QFile file( path );
+    file.open( QIODevice::WriteOnly );
+    file.write( QByteArray( size, 'x' ) );
+    file.close();
+
+    const uint time = QDateTime::currentDateTime().toTime_t() - age;
+    struct utimbuf times;
+    times.actime = time;
+    times.modtime = time;
+    utime( QFile::encodeName( path ).constData(), &times );
+
+    return relativePath;
+}
+
+void FileStorageWatcherTest::createTiles() const
+{
+    createTile( 2, 0, 1000, 5000 );
+    for ( int i = 0; i < 10; ++i ) {
+        createTile( 5, i, 1000, 1000 - i );
+    }
+}
+
+QString FileStorageWatcherTest::tilePath( int level, int x ) const
+{
+    return QString( "%1/maps/earth/test/%2/%3/0.png" ).arg( m_dataPath ).arg( level ).arg( x );
+}
+
+void FileStorageWatcherTest::buildIndex()
+{
+    createTiles();
+    QFile bookmarks( m_dataPath + "/bookmarks.kml" );
+    bookmarks.open( QIODevice::WriteOnly );
+    bookmarks.write( QByteArray( 500, ' ' ) );
+    bookmarks.close();
+
+    FileStorageWatcherThread watcher( m_dataPath );
+    watcher.getCurrentCacheSize();
+
+    QCOMPARE( watcher.currentCacheSize(), quint64( 11500 ) );
+    QVERIFY( QFile::exists( FileStorageWatcherThread::indexFileName( m_dataPath ) ) );
+}
+
+void FileStorageWatcherTest::deleteLeastRecentlyUsed()
+{
+    createTiles();
+
+    FileStorageWatcherThread watcher( m_dataPath );
+    watcher.getCurrentCacheSize();
+    watcher.updateTheme( "earth/test" );
+
+    // the oldest tile was just displayed
+    watcher.accessFile( "maps/earth/test/5/0/0.png" );
+
+    // the soft limit is 7600 bytes
+    watcher.setCacheLimit( 8000 );
+    QTest::qWait( 100 );
+
+    QCOMPARE( watcher.currentCacheSize(), quint64( 7000 ) );
+    QVERIFY( QFile::exists( tilePath( 2, 0 ) ) );
+    QVERIFY( QFile::exists( tilePath( 5, 0 ) ) );
+    for ( int i = 1; i < 5; ++i ) {
+        QVERIFY( !QFile::exists( tilePath( 5, i ) ) );
+    }
+    for ( int i = 5; i < 10; ++i ) {
+        QVERIFY( QFile::exists( tilePath( 5, i ) ) );
+    }
+}
+
+void FileStorageWatcherTest::readIndexHeader()
+{
+    createTiles();
+
+    {
+        FileStorageWatcherThread watcher( m_dataPath );
+        watcher.getCurrentCacheSize();
+        QCOMPARE( watcher.currentCacheSize(), quint64( 11000 ) );
+
+        // written to the index on shutdown
+        watcher.accessFile( m_dataPath + "/maps/earth/test/5/3/0.png" );
+    }
+
+    // not known to the index, only a scan would find it
+    createTile( 6, 0, 3000 );
+
+    FileStorageWatcherThread watcher( m_dataPath );
+    watcher.getCurrentCacheSize();
+    QCOMPARE( watcher.currentCacheSize(), quint64( 11000 ) );
+
+    // the soft limit is 1900 bytes, but the tile accessed last may not be deleted yet
+    watcher.updateTheme( "earth/test" );
+    watcher.setCacheLimit( 2000 );
+    QTest::qWait( 100 );
+
+    QCOMPARE( watcher.currentCacheSize(), quint64( 2000 ) );
+    QVERIFY( QFile::exists( tilePath( 2, 0 ) ) );
+    QVERIFY( QFile::exists( tilePath( 5, 3 ) ) );
+    QVERIFY( QFile::exists( tilePath( 6, 0 ) ) );
+    for ( int i = 0; i < 10; ++i ) {
+        QCOMPARE( QFile::exists( tilePath( 5, i ) ), i == 3 );
+    }
+}
+
+void FileStorageWatcherTest::rebuildInconsistentIndex()
+{
+    createTiles();
+
+    {
+        FileStorageWatcherThread watcher( m_dataPath );
+        watcher.getCurrentCacheSize();
+    }
+
+    // Like a crash, the index is not marked to be consistent
+    QFile index( FileStorageWatcherThread::indexFileName( m_dataPath ) );
+    QVERIFY( index.open( QIODevice::ReadWrite ) );
+    index.seek( 8 );
+    index.write( QByteArray( 1, '\0' ) );
+    index.close();
+
+    createTile( 6, 0, 3000 );
+
+    FileStorageWatcherThread watcher( m_dataPath );
+    watcher.getCurrentCacheSize();
+    QCOMPARE( watcher.currentCacheSize(), quint64( 14000 ) );
+}
+
+void FileStorageWatcherTest::rebuildCorruptIndex()
+{
+    createTiles();
+
+    {
+        FileStorageWatcherThread watcher( m_dataPath );
+        watcher.getCurrentCacheSize();
+    }
+
+    // The header is intact, but the entries are truncated
+    QFile index( FileStorageWatcherThread::indexFileName( m_dataPath ) );
+    QVERIFY( index.open( QIODevice::ReadWrite ) );
+    index.resize( 30 );
+    index.close();
+
+    FileStorageWatcherThread watcher( m_dataPath );
+    watcher.getCurrentCacheSize();
+    QCOMPARE( watcher.currentCacheSize(), quint64( 11000 ) );
+
+    // Deleting files needs the entries, so the index is rebuilt
+    watcher.updateTheme( "earth/test" );
+    watcher.setCacheLimit( 9000 );
+    QTest::qWait( 100 );
+
+    QCOMPARE( watcher.currentCacheSize(), quint64( 8000 ) );
+    for ( int i = 0; i < 10; ++i ) {
+        QCOMPARE( QFile::exists( tilePath( 5, i ) ), i >= 3 );
+    }
+    QVERIFY( QFileInfo( index.fileName() ).size() > 30 );
+}
+
+void FileStorageWatcherTest::startupBenchmark_data()
+{
+    QTest::addColumn<bool>( "useIndex" );
+
+    QTest::newRow( "scan" ) << false;
+    QTest::newRow( "index" ) << true;
+}
+
+void FileStorageWatcherTest::startupBenchmark()
+{
+    QFETCH( bool, useIndex );
+
+    for ( int x = 0; x < 100; ++x ) {
+        for ( int y = 0; y < 100; ++y ) {
+            const QString path = QString( "%1/maps/earth/test/10/%2/%3.png" ).arg( m_dataPath ).arg( x ).arg( y );
+            QDir().mkpath( QFileInfo( path ).absolutePath() );
+            QFile file( path );
+            file.open( QIODevice::WriteOnly );
+            file.write( QByteArray( 100, 'x' ) );
+        }
+    }
+
+    {
+        FileStorageWatcherThread watcher( m_dataPath );
+        watcher.getCurrentCacheSize();
+        QCOMPARE( watcher.currentCacheSize(), quint64( 1000000 ) );
+    }
+
+    QBENCHMARK {
+        if ( !useIndex ) {
+            QFile::remove( FileStorageWatcherThread::indexFileName( m_dataPath ) );
+        }
+        FileStorageWatcherThread watcher( m_dataPath );
+        watcher.getCurrentCacheSize();
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::FileStorageWatcherTest )
+
+#include "FileStorageWatcherTest.moc"
@@ -0,0 +1,177 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <QtTest>
+
+#include "GeoDataLatLonBox.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPoint.h"
+#include "GeoGraphicsScene.h"
+#include "GeoPointGraphicsItem.h"
+
+namespace Marble
+{
+
+class GeoGraphicsSceneTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void cleanup();
+
+    void itemsSortedByZValue();
+    void itemsAcrossDateLine();
+    void minZoomLevel();
+    void removeItem();
+
+    void queryBenchmark_data();
+    void queryBenchmark();
+
+ private:
+    GeoPointGraphicsItem *createItem( qreal lon, qreal lat, qreal zValue, int minZoomLevel = 0 );
+
+    QList<GeoDataPlacemark*> m_placemarks;
+};
+
+void GeoGraphicsSceneTest::cleanup()
+{
+    qDeleteAll( m_placemarks );
+    m_placemarks.clear();
+}
+
+GeoPointGraphicsItem *GeoGraphicsSceneTest::createItem( qreal lon, qreal lat, qreal zValue, int minZoomLevel )
+{
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    m_placemarks << placemark;
+
+    GeoPointGraphicsItem *item = new GeoPointGraphicsItem( placemark );
+    item->setPoint( GeoDataPoint( lon, lat, 0, GeoDataCoordinates::Degree ) );
+    item->setZValue( zValue );
+    item->setMinZoomLevel( minZoomLevel );
+
+    return item;
+}
+
+void GeoGraphicsSceneTest::itemsSortedByZValue()
+{
+    GeoGraphicsScene scene;
+    for ( int i = 0; i < 200; ++i ) {
+        scene.addItem( createItem( -170.0 + 1.7 * i, -80.0 + 0.8 * i, ( i * 37 ) % 11, i % 10 ) );
+    }
+
+    const GeoDataLatLonBox box( 90, -90, 180, -180, GeoDataCoordinates::Degree );
+    const QList<GeoGraphicsItem*> items = scene.items( box, 10 );
+
+    QCOMPARE( items.size(), 200 );
+    for ( int i = 1; i < items.size(); ++i ) {
+        QVERIFY( items.at( i - 1 )->zValue() <= items.at( i )->zValue() );
+    }
+
+    scene.eraseAll();
+}
+
+void GeoGraphicsSceneTest::itemsAcrossDateLine()
+{
+    GeoGraphicsScene scene;
+    scene.addItem( createItem( 179.0, 10.0, 1.0, 5 ) );
+    scene.addItem( createItem( -179.0, 10.0, 2.0, 5 ) );
+    scene.addItem( createItem( 0.0, 10.0, 3.0, 5 ) );
+
+    // stored in the top level tile, which both halves of the box share
+    scene.addItem( createItem( 178.0, 10.0, 0.0, 0 ) );
+
+    const GeoDataLatLonBox box( 20, 0, -170, 170, GeoDataCoordinates::Degree );
+    const QList<GeoGraphicsItem*> items = scene.items( box, 5 );
+
+    QCOMPARE( items.size(), 3 );
+    QCOMPARE( items.at( 0 )->zValue(), qreal( 0.0 ) );
+    QCOMPARE( items.at( 1 )->zValue(), qreal( 1.0 ) );
+    QCOMPARE( items.at( 2 )->zValue(), qreal( 2.0 ) );
+
+    scene.eraseAll();
+}
+
+void GeoGraphicsSceneTest::minZoomLevel()
+{
+    GeoGraphicsScene scene;
+    scene.addItem( createItem( 10.0, 10.0, 0.0, 3 ) );
+    scene.addItem( createItem( 10.1, 10.1, 0.0, 8 ) );
+
+    const GeoDataLatLonBox box( 20, 0, 20, 0, GeoDataCoordinates::Degree );
+    QCOMPARE( scene.items( box, 2 ).size(), 0 );
+    QCOMPARE( scene.items( box, 5 ).size(), 1 );
+    QCOMPARE( scene.items( box, 8 ).size(), 2 );
+
+    scene.eraseAll();
+}
+
+void GeoGraphicsSceneTest::removeItem()
+{
+    GeoGraphicsScene scene;
+    GeoPointGraphicsItem *first = createItem( 10.0, 10.0, 0.0, 5 );
+    GeoPointGraphicsItem *second = createItem( 10.0, 10.0, 1.0, 5 );
+    scene.addItem( first );
+    scene.addItem( second );
+
+    const GeoDataLatLonBox box( 20, 0, 20, 0, GeoDataCoordinates::Degree );
+    QCOMPARE( scene.items( box, 5 ).size(), 2 );
+
+    scene.removeItem( first->feature() );
+    delete first;
+
+    const QList<GeoGraphicsItem*> items = scene.items( box, 5 );
+    QCOMPARE( items.size(), 1 );
+    QCOMPARE( items.first(), static_cast<GeoGraphicsItem*>( second ) );
+
+    scene.eraseAll();
+}
+
+void GeoGraphicsSceneTest::queryBenchmark_data()
+{
+    QTest::addColumn<int>( "count" );
+    QTest::addColumn<int>( "zoomLevel" );
+    QTest::addColumn<qreal>( "extent" );
+
+    QTest::newRow( "100000 items, overview" ) << 100000 << 5 << qreal( 90.0 );
+    QTest::newRow( "100000 items, street" ) << 100000 << 17 << qreal( 0.02 );
+}
+
+void GeoGraphicsSceneTest::queryBenchmark()
+{
+    QFETCH( int, count );
+    QFETCH( int, zoomLevel );
+    QFETCH( qreal, extent );
+
+    // items are clustered around the box center, like OSM vector data of a city
+    GeoGraphicsScene scene;
+    qsrand( 42 );
+    for ( int i = 0; i < count; ++i ) {
+        const qreal lon = 13.4 + extent * ( qrand() / qreal( RAND_MAX ) - 0.5 ) * 4;
+        const qreal lat = 52.5 + extent * ( qrand() / qreal( RAND_MAX ) - 0.5 ) * 2;
+        scene.addItem( createItem( lon, lat, qrand() % 20, qrand() % 18 ) );
+    }
+
+    const GeoDataLatLonBox box( 52.5 + extent / 2, 52.5 - extent / 2,
+                                13.4 + extent, 13.4 - extent, GeoDataCoordinates::Degree );
+
+    int found = 0;
+    QBENCHMARK {
+        found = scene.items( box, zoomLevel ).size();
+    }
+    QVERIFY( found > 0 );
+
+    scene.eraseAll();
+}
+
+}
+
+QTEST_MAIN( Marble::GeoGraphicsSceneTest )
+
+#include "GeoGraphicsSceneTest.moc"
@@ -0,0 +1,91 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "HttpStandIn.h"
+
+#include <QList>
+#include <QtNetwork/QTcpSocket>
+
+namespace Marble
+{
+
+HttpStandIn::HttpStandIn( QObject *parent ) :
+    QTcpServer( parent ),
+    m_requestCount( 0 )
+{
+    connect( this, SIGNAL(newConnection()), this, SLOT(acceptConnections()) );
+}
+
+int HttpStandIn::requestCount() const
+{
+    return m_requestCount;
+}
+
+void HttpStandIn::acceptConnections()
+{
+    while ( hasPendingConnections() ) {
+        QTcpSocket *socket = nextPendingConnection();
+        m_requests.insert( socket, QByteArray() );
+        connect( socket, SIGNAL(readyRead()), this, SLOT(readRequest()) );
+        connect( socket, SIGNAL(disconnected()), this, SLOT(removeConnection()) );
+    }
+}
+
+void HttpStandIn::readRequest()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>( sender() );
+    if ( !socket || !m_requests.contains( socket ) ) {
+        return;
+    }
+
+    QByteArray &request = m_requests[socket];
+    request += socket->readAll();
+
+    const int headerEnd = request.indexOf( "\r\n\r\n" );
+    if ( headerEnd < 0 ) {
+        return;
+    }
+
+    const QByteArray header = request.left( headerEnd );
+    int contentLength = 0;
+    foreach( const QByteArray &line, header.split( '\n' ) ) {
+        if ( line.toLower().startsWith( "content-length:" ) ) {
+            contentLength = line.mid( 15 ).trimmed().toInt();
+        }
+    }
+
+    if ( request.size() < headerEnd + 4 + contentLength ) {
+        return;
+    }
+
+    ++m_requestCount;
+    const QByteArray path = header.left( header.indexOf( "\r\n" ) ).split( ' ' ).value( 1 );
+    QByteArray status = "200 OK";
+    const QByteArray body = respond( path, request.mid( headerEnd + 4, contentLength ), status );
+    m_requests.remove( socket );
+
+    socket->write( "HTTP/1.1 " + status + "\r\n"
+                   "Content-Length: " + QByteArray::number( body.size() ) + "\r\n"
+                   "Connection: close\r\n\r\n" + body );
+    socket->disconnectFromHost();
+}
+
+void HttpStandIn::removeConnection()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>( sender() );
+    if ( socket ) {
+        m_requests.remove( socket );
+        socket->deleteLater();
+    }
+}
+
+}
+
+#include "HttpStandIn.moc"
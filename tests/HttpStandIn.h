@@ -0,0 +1,61 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef MARBLE_HTTPSTANDIN_H
+#define MARBLE_HTTPSTANDIN_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QtNetwork/QTcpServer>
+
+class QTcpSocket;
+
+namespace Marble
+{
+
+/**
+ * A minimal HTTP server standing in for remote services in tests. Subclasses
+ * answer the requests in respond(). Tests using it link QtNetwork and add
+ * HttpStandIn.cpp to their sources.
+ */
+class HttpStandIn : public QTcpServer
+{
+    Q_OBJECT
+
+ public:
+    explicit HttpStandIn( QObject *parent = 0 );
+
+    /**
+     * Returns the number of requests answered so far
+     */
+    int requestCount() const;
+
+ protected:
+    /**
+     * Returns the body answering a request of @p path with @p content. The status
+     * defaults to "200 OK" and may be changed in @p status.
+     */
+    virtual QByteArray respond( const QByteArray &path, const QByteArray &content, QByteArray &status ) = 0;
+
+ private Q_SLOTS:
+    void acceptConnections();
+
+    void readRequest();
+
+    void removeConnection();
+
+ private:
+    int m_requestCount;
+    QHash<QTcpSocket*, QByteArray> m_requests;
+};
+
+}
+
+#endif
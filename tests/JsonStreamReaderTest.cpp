@@ -0,0 +1,388 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <QTemporaryFile>
+#include <QtTest>
+
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPoint.h"
+#include "GeoDataPolygon.h"
+#include "JsonStreamReader.h"
+#include "MarbleDirs.h"
+#include "ParsingRunnerManager.h"
+#include "PluginManager.h"
+#include "TestUtils.h"
+
+namespace Marble
+{
+
+class JsonStreamReaderTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void tokens();
+    void members();
+    void strings_data();
+    void strings();
+    void numbers_data();
+    void numbers();
+    void invalidDocuments_data();
+    void invalidDocuments();
+    void parse();
+
+    void geoJson();
+
+    void readBenchmark_data();
+    void readBenchmark();
+
+ private:
+    /**
+     * Returns a GeoJSON feature collection with @p count polygons of @p nodes nodes each
+     */
+    static QByteArray createGeoJson( int count, int nodes );
+};
+
+void JsonStreamReaderTest::initTestCase()
+{
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+}
+
+QByteArray JsonStreamReaderTest::createGeoJson( int count, int nodes )
+{
+    QByteArray json( "{ \"type\": \"FeatureCollection\", \"features\": [\n" );
+    for ( int i = 0; i < count; ++i ) {
+        if ( i > 0 ) {
+            json += ",\n";
+        }
+        json += "{ \"type\": \"Feature\", \"properties\": { \"name\": \"Feature ";
+        json += QByteArray::number( i );
+        json += "\", \"population\": ";
+        json += QByteArray::number( i * 1000 );
+        json += " }, \"geometry\": { \"type\": \"Polygon\", \"coordinates\": [ [ ";
+        for ( int j = 0; j < nodes; ++j ) {
+            const qreal lon = -180.0 + 360.0 * ( i * nodes + j ) / ( count * nodes );
+            json += '[';
+            json += QByteArray::number( lon, 'f', 6 );
+            json += ", ";
+            json += QByteArray::number( -45.0 + 1.0 / ( j + 3 ), 'f', 6 );
+            json += "], ";
+        }
+        json.chop( 2 );
+        json += " ] ] } }";
+    }
+    json += "\n] }\n";
+
+    return json;
+}
+
+void JsonStreamReaderTest::tokens()
+{
+    JsonStreamReader reader( " { \"a\": [ 1, \"two\", true, false, null, {} ] } " );
+
+    QCOMPARE( reader.readNext(), JsonStreamReader::StartObject );
+    QCOMPARE( reader.depth(), 0 );
+    QCOMPARE( reader.readNext(), JsonStreamReader::StartArray );
+    QCOMPARE( reader.name(), QString( "a" ) );
+    QCOMPARE( reader.depth(), 1 );
+    QCOMPARE( reader.readNext(), JsonStreamReader::Number );
+    QCOMPARE( reader.depth(), 2 );
+    QCOMPARE( reader.numberValue(), 1.0 );
+    QCOMPARE( reader.readNext(), JsonStreamReader::String );
+    QCOMPARE( reader.stringValue(), QString( "two" ) );
+    QCOMPARE( reader.readNext(), JsonStreamReader::Bool );
+    QCOMPARE( reader.boolValue(), true );
+    QCOMPARE( reader.readNext(), JsonStreamReader::Bool );
+    QCOMPARE( reader.boolValue(), false );
+    QCOMPARE( reader.readNext(), JsonStreamReader::Null );
+    QCOMPARE( reader.readNext(), JsonStreamReader::StartObject );
+    QCOMPARE( reader.readNext(), JsonStreamReader::EndObject );
+    QCOMPARE( reader.readNext(), JsonStreamReader::EndArray );
+    QCOMPARE( reader.readNext(), JsonStreamReader::EndObject );
+    QCOMPARE( reader.depth(), 0 );
+    QCOMPARE( reader.readNext(), JsonStreamReader::EndDocument );
+    QVERIFY( reader.atEnd() );
+    QVERIFY( !reader.hasError() );
+
+    // the end is sticky
+    QCOMPARE( reader.readNext(), JsonStreamReader::EndDocument );
+}
+
+void JsonStreamReaderTest::members()
+{
+    JsonStreamReader reader( "{ \"skipped\": { \"x\": [1, [2, {\"y\": 3}]] }, \"na\\u006De\": \"value\", \"last\": 4 }" );
+
+    QCOMPARE( reader.readNext(), JsonStreamReader::StartObject );
+
+    QVERIFY( reader.readNextChild() );
+    QVERIFY( reader.isName( "skipped" ) );
+    reader.skipValue();
+    QCOMPARE( reader.tokenType(), JsonStreamReader::EndObject );
+
+    QVERIFY( reader.readNextChild() );
+    QCOMPARE( reader.name(), QString( "name" ) );
+    QVERIFY( reader.isName( "name" ) );
+    QCOMPARE( reader.stringValue(), QString( "value" ) );
+
+    QVERIFY( reader.readNextChild() );
+    QVERIFY( !reader.isName( "las" ) );
+    QCOMPARE( reader.readValue(), QVariant( 4.0 ) );
+
+    QVERIFY( !reader.readNextChild() );
+    QCOMPARE( reader.tokenType(), JsonStreamReader::EndObject );
+    QVERIFY( !reader.hasError() );
+}
+
+void JsonStreamReaderTest::strings_data()
+{
+    QTest::addColumn<QByteArray>( "json" );
+    QTest::addColumn<QString>( "expected" );
+
+    addRow() << QByteArray( "\"\"" ) << QString( "" );
+    addRow() << QByteArray( "\"plain\"" ) << QString( "plain" );
+    addRow() << QByteArray( "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"" ) << QString( "\"\\/\b\f\n\r\t" );
+    addRow() << QByteArray( "\"\\u00e9t\\u00C9\"" ) << QString::fromUtf8( "étÉ" );
+    addRow() << QByteArray( "\"M\xc3\xbcnchen\"" ) << QString::fromUtf8( "München" );
+    addRow() << QByteArray( "\"\\ud83c\\udf0d\"" ) << QString::fromUtf8( "\xf0\x9f\x8c\x8d" );
+}
+
+void JsonStreamReaderTest::strings()
+{
+    QFETCH( QByteArray, json );
+    QFETCH( QString, expected );
+
+    JsonStreamReader reader( json );
+    QCOMPARE( reader.readNext(), JsonStreamReader::String );
+    QCOMPARE( reader.stringValue(), expected );
+    QCOMPARE( reader.readNext(), JsonStreamReader::EndDocument );
+}
+
+void JsonStreamReaderTest::numbers_data()
+{
+    QTest::addColumn<QByteArray>( "json" );
+
+    addRow() << QByteArray( "0" );
+    addRow() << QByteArray( "-0" );
+    addRow() << QByteArray( "42" );
+    addRow() << QByteArray( "-74.006393" );
+    addRow() << QByteArray( "40.714172" );
+    addRow() << QByteArray( "0.1" );
+    addRow() << QByteArray( "1e22" );
+    addRow() << QByteArray( "1e23" );
+    addRow() << QByteArray( "2.5E-3" );
+    addRow() << QByteArray( "1.7976931348623157e308" );
+    addRow() << QByteArray( "4.9e-324" );
+    addRow() << QByteArray( "9007199254740993" );
+    addRow() << QByteArray( "123456789012345678901234567890" );
+    addRow() << QByteArray( "0.30000000000000004" );
+
+    // random coordinates with many digits
+    qsrand( 42 );
+    for ( int i = 0; i < 20; ++i ) {
+        const qreal value = 360.0 * qrand() / RAND_MAX - 180.0;
+        addRow() << QByteArray::number( value, 'g', 17 );
+    }
+}
+
+void JsonStreamReaderTest::numbers()
+{
+    QFETCH( QByteArray, json );
+
+    JsonStreamReader reader( json );
+    QCOMPARE( reader.readNext(), JsonStreamReader::Number );
+    // must be exactly the same value, not just a close one
+    QVERIFY( reader.numberValue() == json.toDouble() );
+    QCOMPARE( reader.readNext(), JsonStreamReader::EndDocument );
+}
+
+void JsonStreamReaderTest::invalidDocuments_data()
+{
+    QTest::addColumn<QByteArray>( "json" );
+
+    addRow() << QByteArray( "" );
+    addRow() << QByteArray( "   " );
+    addRow() << QByteArray( "{" );
+    addRow() << QByteArray( "[1, 2" );
+    addRow() << QByteArray( "[1, 2,]" );
+    addRow() << QByteArray( "{\"a\": 1,}" );
+    addRow() << QByteArray( "{\"a\" 1}" );
+    addRow() << QByteArray( "{1: 2}" );
+    addRow() << QByteArray( "[1 2]" );
+    addRow() << QByteArray( "[1}" );
+    addRow() << QByteArray( "{} {}" );
+    addRow() << QByteArray( "\"unterminated" );
+    addRow() << QByteArray( "\"\\x\"" );
+    addRow() << QByteArray( "\"\\u12g4\"" );
+    addRow() << QByteArray( "\"tab\there\"" );
+    addRow() << QByteArray( "01" );
+    addRow() << QByteArray( "1." );
+    addRow() << QByteArray( "-" );
+    addRow() << QByteArray( "1e" );
+    addRow() << QByteArray( "+1" );
+    addRow() << QByteArray( "tru" );
+    addRow() << QByteArray( "nulls" );
+    addRow() << QByteArray( "'single'" );
+    addRow() << QByteArray( "alert(1)" );
+    addRow() << QByteArray( 600, '[' ) + QByteArray( 600, ']' );
+}
+
+void JsonStreamReaderTest::invalidDocuments()
+{
+    QFETCH( QByteArray, json );
+
+    JsonStreamReader reader( json );
+    while ( !reader.atEnd() ) {
+        reader.readNext();
+    }
+    QVERIFY( reader.hasError() );
+    QCOMPARE( reader.tokenType(), JsonStreamReader::Invalid );
+    QVERIFY( !reader.errorString().isEmpty() );
+
+    QString errorString;
+    QVERIFY( !JsonStreamReader::parse( json, &errorString ).isValid() );
+    QCOMPARE( errorString, reader.errorString() );
+}
+
+void JsonStreamReaderTest::parse()
+{
+    const QVariant result = JsonStreamReader::parse( "{ \"earthquakes\": [ { \"eqid\": \"c0001xgp\", \"magnitude\": 8.8,"
+                                                     " \"lng\": 142.369, \"lat\": 38.322, \"tsunami\": true, \"src\": null } ],"
+                                                     " \"count\": 1 }" );
+    QCOMPARE( result.type(), QVariant::Map );
+
+    const QVariantMap data = result.toMap();
+    QCOMPARE( data.size(), 2 );
+    QCOMPARE( data.value( "count" ).toInt(), 1 );
+    QCOMPARE( data.value( "earthquakes" ).type(), QVariant::List );
+
+    const QVariantList earthquakes = data.value( "earthquakes" ).toList();
+    QCOMPARE( earthquakes.size(), 1 );
+    const QVariantMap earthquake = earthquakes.first().toMap();
+    QCOMPARE( earthquake.value( "eqid" ).toString(), QString( "c0001xgp" ) );
+    QCOMPARE( earthquake.value( "magnitude" ).toDouble(), 8.8 );
+    QCOMPARE( earthquake.value( "lng" ).toDouble(), 142.369 );
+    QCOMPARE( earthquake.value( "tsunami" ).toBool(), true );
+    QVERIFY( earthquake.contains( "src" ) );
+    QVERIFY( !earthquake.value( "src" ).isValid() );
+
+    QCOMPARE( JsonStreamReader::parse( "[]" ).toList().size(), 0 );
+    QCOMPARE( JsonStreamReader::parse( "\"text\"" ).toString(), QString( "text" ) );
+}
+
+void JsonStreamReaderTest::geoJson()
+{
+    QTemporaryFile file( QDir::tempPath() + "/marble-json-XXXXXX.json" );
+    QVERIFY( file.open() );
+    file.write( "{ \"type\": \"FeatureCollection\", \"features\": ["
+                " { \"geometry\": { \"coordinates\": [ 13.4, 52.5 ], \"type\": \"Point\" },"
+                "   \"type\": \"Feature\", \"properties\": { \"name\": \"Berlin\" } },"
+                " { \"type\": \"Feature\", \"geometry\": { \"type\": \"LineString\","
+                "   \"coordinates\": [ [ 0, 0 ], [ 1, 1, 100 ], [ 2, 0 ] ] } },"
+                " { \"type\": \"Feature\", \"properties\": { \"name\": \"Square\", \"extra\": { \"nested\": [ 1 ] } },"
+                "   \"geometry\": { \"type\": \"Polygon\", \"coordinates\": ["
+                "   [ [ 0, 0 ], [ 4, 0 ], [ 4, 4 ], [ 0, 4 ], [ 0, 0 ] ],"
+                "   [ [ 1, 1 ], [ 2, 1 ], [ 2, 2 ], [ 1, 1 ] ] ] } },"
+                " { \"type\": \"Feature\", \"properties\": { \"name\": \"Islands\" },"
+                "   \"geometry\": { \"type\": \"MultiPolygon\", \"coordinates\": ["
+                "   [ [ [ 0, 0 ], [ 1, 0 ], [ 1, 1 ], [ 0, 0 ] ] ],"
+                "   [ [ [ 5, 5 ], [ 6, 5 ], [ 6, 6 ], [ 5, 5 ] ] ] ] } }"
+                "] }" );
+    file.close();
+
+    PluginManager pluginManager;
+    ParsingRunnerManager runnerManager( &pluginManager );
+    GeoDataDocument *document = runnerManager.openFile( file.fileName() );
+    QVERIFY( document );
+
+    const QVector<GeoDataPlacemark*> placemarks = document->placemarkList();
+    QCOMPARE( placemarks.size(), 5 );
+
+    QCOMPARE( placemarks.at( 0 )->name(), QString( "Berlin" ) );
+    const GeoDataPoint *point = dynamic_cast<const GeoDataPoint*>( placemarks.at( 0 )->geometry() );
+    QVERIFY( point );
+    QFUZZYCOMPARE( point->coordinates().longitude( GeoDataCoordinates::Degree ), 13.4, 1e-9 );
+    QFUZZYCOMPARE( point->coordinates().latitude( GeoDataCoordinates::Degree ), 52.5, 1e-9 );
+
+    // features without properties are kept
+    const GeoDataLineString *lineString = dynamic_cast<const GeoDataLineString*>( placemarks.at( 1 )->geometry() );
+    QVERIFY( lineString );
+    QCOMPARE( lineString->size(), 3 );
+    QFUZZYCOMPARE( lineString->at( 1 ).longitude( GeoDataCoordinates::Degree ), 1.0, 1e-9 );
+
+    QCOMPARE( placemarks.at( 2 )->name(), QString( "Square" ) );
+    const GeoDataPolygon *polygon = dynamic_cast<const GeoDataPolygon*>( placemarks.at( 2 )->geometry() );
+    QVERIFY( polygon );
+    QCOMPARE( polygon->outerBoundary().size(), 5 );
+    QCOMPARE( polygon->innerBoundaries().size(), 1 );
+    QCOMPARE( polygon->innerBoundaries().first().size(), 4 );
+
+    QCOMPARE( placemarks.at( 3 )->name(), QString( "Islands" ) );
+    QCOMPARE( placemarks.at( 4 )->name(), QString( "Islands" ) );
+    QVERIFY( dynamic_cast<const GeoDataPolygon*>( placemarks.at( 4 )->geometry() ) );
+
+    delete document;
+}
+
+void JsonStreamReaderTest::readBenchmark_data()
+{
+    QTest::addColumn<bool>( "plugin" );
+
+    QTest::newRow( "JsonStreamReader" ) << false;
+    QTest::newRow( "JsonRunner" ) << true;
+}
+
+void JsonStreamReaderTest::readBenchmark()
+{
+    QFETCH( bool, plugin );
+
+    // about 50 MB
+    const int count = 20000;
+    const QByteArray json = createGeoJson( count, 100 );
+
+    if ( plugin ) {
+        QTemporaryFile file( QDir::tempPath() + "/marble-json-XXXXXX.json" );
+        QVERIFY( file.open() );
+        file.write( json );
+        file.close();
+
+        PluginManager pluginManager;
+        ParsingRunnerManager runnerManager( &pluginManager );
+
+        QBENCHMARK {
+            GeoDataDocument *document = runnerManager.openFile( file.fileName() );
+            QVERIFY( document );
+            QCOMPARE( document->placemarkList().size(), count );
+            delete document;
+        }
+    } else {
+        QBENCHMARK {
+            JsonStreamReader reader( json );
+            int numbers = 0;
+            while ( !reader.atEnd() ) {
+                if ( reader.readNext() == JsonStreamReader::Number ) {
+                    reader.numberValue();
+                    ++numbers;
+                }
+            }
+            QVERIFY( !reader.hasError() );
+            QCOMPARE( numbers, count * ( 1 + 2 * 100 ) );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::JsonStreamReaderTest )
+
+#include "JsonStreamReaderTest.moc"
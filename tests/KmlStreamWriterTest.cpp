@@ -0,0 +1,307 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <QBuffer>
+#include <QtTest>
+
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTrack.h"
+#include "GeoWriter.h"
+#include "KmlStreamWriter.h"
+#include "TestUtils.h"
+
+namespace Marble
+{
+
+class KmlStreamWriterTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void appendNumber_data();
+    void appendNumber();
+
+    void compareWithGeoWriter();
+    void bufferSize();
+    void kmzArchive();
+    void invalidDevice();
+
+    void writeBenchmark_data();
+    void writeBenchmark();
+
+ private:
+    /**
+     * Returns a document with a style and @p count placemarks, each
+     * having a line string of @p nodes nodes
+     */
+    static GeoDataDocument *createDocument( int count, int nodes );
+
+    static QByteArray streamDocument( const GeoDataDocument *document, KmlStreamWriter &writer );
+
+    static quint32 readLittleEndian( const QByteArray &data, int position, int bytes );
+};
+
+GeoDataDocument *KmlStreamWriterTest::createDocument( int count, int nodes )
+{
+    GeoDataDocument *document = new GeoDataDocument;
+    document->setName( "Stream" );
+
+    GeoDataStyle style;
+    style.setId( "wide" );
+    style.lineStyle().setWidth( 7 );
+    document->addStyle( style );
+
+    for ( int i = 0; i < count; ++i ) {
+        GeoDataLineString *lineString = new GeoDataLineString;
+        for ( int j = 0; j < nodes; ++j ) {
+            const qreal lon = -180.0 + 360.0 * ( i * nodes + j ) / ( count * nodes );
+            lineString->append( GeoDataCoordinates( lon, 10.0 + 1.0 / ( j + 3 ), 0.0, GeoDataCoordinates::Degree ) );
+        }
+
+        GeoDataPlacemark *placemark = new GeoDataPlacemark( QString::number( i ) );
+        placemark->setStyleUrl( "#wide" );
+        placemark->setGeometry( lineString );
+        document->append( placemark );
+    }
+
+    return document;
+}
+
+QByteArray KmlStreamWriterTest::streamDocument( const GeoDataDocument *document, KmlStreamWriter &writer )
+{
+    QBuffer buffer;
+    buffer.open( QIODevice::WriteOnly );
+
+    if ( !writer.open( &buffer, document->name() ) ) {
+        return QByteArray();
+    }
+    foreach( const GeoDataStyle &style, document->styles() ) {
+        writer.write( &style );
+    }
+    writer.write( document->constBegin(), document->constEnd() );
+    if ( !writer.close() ) {
+        return QByteArray();
+    }
+
+    return buffer.data();
+}
+
+quint32 KmlStreamWriterTest::readLittleEndian( const QByteArray &data, int position, int bytes )
+{
+    quint32 result = 0;
+    for ( int i = bytes - 1; i >= 0; --i ) {
+        result = ( result << 8 ) | uchar( data.at( position + i ) );
+    }
+    return result;
+}
+
+void KmlStreamWriterTest::appendNumber_data()
+{
+    QTest::addColumn<qreal>( "value" );
+    QTest::addColumn<int>( "precision" );
+
+    addRow() << qreal( 0.0 ) << 10;
+    addRow() << qreal( -74.006393 ) << 10;
+    addRow() << qreal( 40.714172 ) << 10;
+    addRow() << qreal( 179.9999999999999 ) << 10;
+    addRow() << qreal( 0.125 ) << 2;
+    addRow() << qreal( 0.375 ) << 2;
+    addRow() << qreal( 2.5 ) << 0;
+    addRow() << qreal( 8848.86 ) << 2;
+    addRow() << qreal( 1e20 ) << 10;
+
+    // random coordinates
+    qsrand( 42 );
+    for ( int i = 0; i < 20; ++i ) {
+        const qreal lon = 360.0 * qrand() / RAND_MAX - 180.0;
+        addRow() << lon << 10;
+    }
+}
+
+void KmlStreamWriterTest::appendNumber()
+{
+    QFETCH( qreal, value );
+    QFETCH( int, precision );
+
+    QByteArray buffer( "x" );
+    GeoWriter::appendNumber( buffer, value, precision );
+    QCOMPARE( QString::fromLatin1( buffer ), QString( "x" ) + QString::number( value, 'f', precision ) );
+}
+
+void KmlStreamWriterTest::compareWithGeoWriter()
+{
+    GeoDataDocument *document = createDocument( 50, 20 );
+
+    QBuffer buffer;
+    buffer.open( QIODevice::WriteOnly );
+    GeoWriter geoWriter;
+    QVERIFY( geoWriter.write( &buffer, document ) );
+
+    KmlStreamWriter writer;
+    const QByteArray streamed = streamDocument( document, writer );
+    QVERIFY( !streamed.isEmpty() );
+    QCOMPARE( writer.bytesWritten(), qint64( streamed.size() ) );
+
+    GeoDataDocument *expected = parseKml( QString::fromUtf8( buffer.data() ) );
+    GeoDataDocument *actual = parseKml( QString::fromUtf8( streamed ) );
+
+    QCOMPARE( actual->name(), expected->name() );
+    QCOMPARE( actual->styles().size(), 1 );
+    QCOMPARE( actual->placemarkList().size(), expected->placemarkList().size() );
+    for ( int i = 0; i < expected->placemarkList().size(); ++i ) {
+        const GeoDataPlacemark *expectedPlacemark = expected->placemarkList().at( i );
+        const GeoDataPlacemark *actualPlacemark = actual->placemarkList().at( i );
+        QCOMPARE( actualPlacemark->name(), expectedPlacemark->name() );
+        QCOMPARE( actualPlacemark->styleUrl(), expectedPlacemark->styleUrl() );
+
+        const GeoDataLineString *expectedLine = static_cast<const GeoDataLineString*>( expectedPlacemark->geometry() );
+        const GeoDataLineString *actualLine = static_cast<const GeoDataLineString*>( actualPlacemark->geometry() );
+        QCOMPARE( actualLine->size(), expectedLine->size() );
+        for ( int j = 0; j < expectedLine->size(); ++j ) {
+            QCOMPARE( actualLine->at( j ), expectedLine->at( j ) );
+        }
+    }
+
+    delete expected;
+    delete actual;
+    delete document;
+}
+
+void KmlStreamWriterTest::bufferSize()
+{
+    GeoDataDocument *document = createDocument( 100, 10 );
+
+    KmlStreamWriter writer;
+    const QByteArray expected = streamDocument( document, writer );
+    QVERIFY( !expected.isEmpty() );
+
+    KmlStreamWriter unbuffered;
+    unbuffered.setBufferSize( 1 );
+    QCOMPARE( streamDocument( document, unbuffered ), expected );
+
+    // the writer can be reused
+    QCOMPARE( streamDocument( document, writer ), expected );
+
+    delete document;
+}
+
+void KmlStreamWriterTest::kmzArchive()
+{
+    GeoDataDocument *document = createDocument( 200, 50 );
+
+    KmlStreamWriter plainWriter;
+    const QByteArray plain = streamDocument( document, plainWriter );
+
+    KmlStreamWriter writer;
+    writer.setCompression( KmlStreamWriter::Kmz );
+    writer.setBufferSize( 4096 );
+    const QByteArray kmz = streamDocument( document, writer );
+    QCOMPARE( writer.bytesWritten(), qint64( kmz.size() ) );
+
+    // local file header
+    QCOMPARE( readLittleEndian( kmz, 0, 4 ), quint32( 0x04034b50 ) );
+    const quint32 method = readLittleEndian( kmz, 8, 2 );
+    const int nameLength = readLittleEndian( kmz, 26, 2 );
+    QCOMPARE( kmz.mid( 30, nameLength ), QByteArray( "doc.kml" ) );
+    const int dataStart = 30 + nameLength;
+
+    // end of central directory record
+    const int endRecord = kmz.size() - 22;
+    QCOMPARE( readLittleEndian( kmz, endRecord, 4 ), quint32( 0x06054b50 ) );
+    QCOMPARE( readLittleEndian( kmz, endRecord + 10, 2 ), quint32( 1 ) );
+    const int directorySize = readLittleEndian( kmz, endRecord + 12, 4 );
+    const int directory = readLittleEndian( kmz, endRecord + 16, 4 );
+    QCOMPARE( directory + directorySize, endRecord );
+
+    // central directory and data descriptor must agree on the entry
+    QCOMPARE( readLittleEndian( kmz, directory, 4 ), quint32( 0x02014b50 ) );
+    const int descriptor = directory - 16;
+    QCOMPARE( readLittleEndian( kmz, descriptor, 4 ), quint32( 0x08074b50 ) );
+    QCOMPARE( kmz.mid( directory + 16, 12 ), kmz.mid( descriptor + 4, 12 ) );
+
+    const int compressedSize = readLittleEndian( kmz, descriptor + 8, 4 );
+    QCOMPARE( int( readLittleEndian( kmz, descriptor + 12, 4 ) ), plain.size() );
+    QCOMPARE( dataStart + compressedSize, descriptor );
+
+    if ( method == 0 ) {
+        QCOMPARE( kmz.mid( dataStart, compressedSize ), plain );
+    } else {
+        QCOMPARE( method, quint32( 8 ) );
+        QVERIFY( compressedSize < plain.size() / 2 );
+    }
+
+    delete document;
+}
+
+void KmlStreamWriterTest::invalidDevice()
+{
+    GeoDataPlacemark placemark( "Unwritten" );
+
+    KmlStreamWriter writer;
+    QVERIFY( !writer.write( &placemark ) );
+    QVERIFY( !writer.errorString().isEmpty() );
+
+    QBuffer buffer;
+    buffer.open( QIODevice::ReadOnly );
+    QVERIFY( !writer.open( &buffer ) );
+    QVERIFY( !writer.close() );
+}
+
+void KmlStreamWriterTest::writeBenchmark_data()
+{
+    QTest::addColumn<bool>( "streaming" );
+    QTest::addColumn<int>( "compression" );
+
+    QTest::newRow( "GeoWriter" ) << false << int( KmlStreamWriter::Uncompressed );
+    QTest::newRow( "KmlStreamWriter" ) << true << int( KmlStreamWriter::Uncompressed );
+    QTest::newRow( "KmlStreamWriter, kmz" ) << true << int( KmlStreamWriter::Kmz );
+}
+
+void KmlStreamWriterTest::writeBenchmark()
+{
+    QFETCH( bool, streaming );
+    QFETCH( int, compression );
+
+    GeoDataDocument *document = createDocument( 200, 1000 );
+
+    GeoDataTrack *track = new GeoDataTrack;
+    const QDateTime start = QDateTime::currentDateTime();
+    for ( int i = 0; i < 100000; ++i ) {
+        track->addPoint( start.addSecs( i ), GeoDataCoordinates( 0.0001 * i, 45.0, 100.0, GeoDataCoordinates::Degree ) );
+    }
+    GeoDataPlacemark *trackPlacemark = new GeoDataPlacemark( "Track" );
+    trackPlacemark->setGeometry( track );
+    document->append( trackPlacemark );
+
+    QBENCHMARK {
+        QBuffer buffer;
+        buffer.open( QIODevice::WriteOnly );
+        if ( streaming ) {
+            KmlStreamWriter writer;
+            writer.setCompression( KmlStreamWriter::Compression( compression ) );
+            QVERIFY( writer.open( &buffer, document->name() ) );
+            QVERIFY( writer.write( document->constBegin(), document->constEnd() ) );
+            QVERIFY( writer.close() );
+        } else {
+            GeoWriter writer;
+            QVERIFY( writer.write( &buffer, document ) );
+        }
+    }
+
+    delete document;
+}
+
+}
+
+QTEST_MAIN( Marble::KmlStreamWriterTest )
+
+#include "KmlStreamWriterTest.moc"
@@ -0,0 +1,158 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <QtTest>
+#include <QSignalSpy>
+#include <QThreadPool>
+
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTreeModel.h"
+#include "GeoPainter.h"
+#include "MarbleDirs.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+
+namespace Marble
+{
+
+/**
+ * Checks that a frame is rendered while a large document added to the tree
+ * model is still indexed in the background, and that the complete frame
+ * equals the one of the same features added in small documents, which are
+ * indexed on the GUI thread.
+ */
+class LargeDocumentTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void firstFrame_data();
+    void firstFrame();
+
+ private:
+    static GeoDataDocument *createDocument( int first, int last, int count );
+    static QImage renderFrame( MarbleMap *map );
+};
+
+void LargeDocumentTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+}
+
+GeoDataDocument *LargeDocumentTest::createDocument( int first, int last, int count )
+{
+    GeoDataDocument *document = new GeoDataDocument;
+    document->setName( "Large document" );
+
+    const int columns = 720;
+    for ( int i = first; i <= last; ++i ) {
+        const qreal lon = -180.0 + 0.5 * ( i % columns );
+        const qreal lat = -85.0 + 170.0 * ( i / columns ) / ( count / columns + 1 );
+
+        GeoDataPlacemark *placemark = new GeoDataPlacemark( QString::number( i ) );
+        if ( i % 10 == 0 ) {
+            GeoDataLineString *lineString = new GeoDataLineString;
+            lineString->append( GeoDataCoordinates( lon, lat, 0, GeoDataCoordinates::Degree ) );
+            lineString->append( GeoDataCoordinates( lon + 0.4, lat + 0.1, 0, GeoDataCoordinates::Degree ) );
+            placemark->setGeometry( lineString );
+        } else {
+            placemark->setCoordinate( lon, lat, 0, GeoDataCoordinates::Degree );
+        }
+        document->append( placemark );
+    }
+
+    return document;
+}
+
+QImage LargeDocumentTest::renderFrame( MarbleMap *map )
+{
+    QImage image( map->size(), QImage::Format_ARGB32_Premultiplied );
+    GeoPainter painter( &image, map->viewport(), map->mapQuality() );
+    map->paint( painter, QRect() );
+
+    return image;
+}
+
+void LargeDocumentTest::firstFrame_data()
+{
+    QTest::addColumn<int>( "count" );
+
+    QTest::newRow( "10000" ) << 10000;
+    QTest::newRow( "100000" ) << 100000;
+    QTest::newRow( "500000" ) << 500000;
+}
+
+void LargeDocumentTest::firstFrame()
+{
+    QFETCH( int, count );
+
+    MarbleModel model;
+    MarbleMap map( &model );
+    map.setMapThemeId( "earth/plain/plain.dgml" );
+    map.setSize( 800, 600 );
+    map.setRadius( 400 );
+
+    QSignalSpy progressSpy( &map, SIGNAL(indexingProgress(int,int)) );
+
+    GeoDataDocument *document = createDocument( 0, count - 1, count );
+    model.treeModel()->addDocument( document );
+    renderFrame( &map );
+
+    // the first frame is rendered before the indexed features are added
+    QVERIFY( !progressSpy.isEmpty() );
+    QVERIFY( progressSpy.last().at( 0 ).toInt() < progressSpy.last().at( 1 ).toInt() );
+
+    QThreadPool::globalInstance()->waitForDone();
+    QCoreApplication::processEvents();
+
+    bool complete = false;
+    foreach( const QList<QVariant> &progress, progressSpy ) {
+        QVERIFY( progress.at( 0 ).toInt() <= progress.at( 1 ).toInt() );
+        QVERIFY( progress.at( 1 ).toInt() <= count );
+        complete = complete || ( progress.at( 0 ).toInt() == count && progress.at( 1 ).toInt() == count );
+    }
+    QVERIFY( complete );
+
+    // all items are indexed, in the order of the features
+    MarbleModel referenceModel;
+    MarbleMap referenceMap( &referenceModel );
+    referenceMap.setMapThemeId( "earth/plain/plain.dgml" );
+    referenceMap.setSize( 800, 600 );
+    referenceMap.setRadius( 400 );
+
+    QList<GeoDataDocument *> referenceDocuments;
+    const int documentSize = 5000;
+    for ( int first = 0; first < count; first += documentSize ) {
+        GeoDataDocument *referenceDocument = createDocument( first, qMin( first + documentSize, count ) - 1, count );
+        referenceModel.treeModel()->addDocument( referenceDocument );
+        referenceDocuments << referenceDocument;
+    }
+
+    QVERIFY( renderFrame( &map ) == renderFrame( &referenceMap ) );
+
+    foreach( GeoDataDocument *referenceDocument, referenceDocuments ) {
+        referenceModel.treeModel()->removeDocument( referenceDocument );
+    }
+    qDeleteAll( referenceDocuments );
+
+    model.treeModel()->removeDocument( document );
+    delete document;
+
+    QThreadPool::globalInstance()->waitForDone();
+}
+
+QTEST_MAIN( Marble::LargeDocumentTest )
+
+#include "LargeDocumentTest.moc"
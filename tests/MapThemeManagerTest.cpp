@@ -0,0 +1,114 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <QtTest>
+#include <QSignalSpy>
+#include <QStandardItemModel>
+
+#include "MapThemeManager.h"
+#include "MarbleDirs.h"
+#include "TestUtils.h"
+
+namespace Marble
+{
+
+class MapThemeManagerTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void mapThemeIds();
+    void cachedCatalogue();
+    void modelFilledInBackground();
+
+ private:
+    QString m_dataPath;
+};
+
+void MapThemeManagerTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+
+    // never touch the map theme catalogue of the user
+    m_dataPath = setTemporaryDataPath( "mapthememanager" );
+    QVERIFY( MarbleDirs::localPath().startsWith( m_dataPath ) );
+}
+
+void MapThemeManagerTest::cleanupTestCase()
+{
+    removeDirectory( m_dataPath );
+}
+
+void MapThemeManagerTest::mapThemeIds()
+{
+    MapThemeManager manager;
+    const QStringList ids = manager.mapThemeIds();
+
+    QVERIFY( ids.contains( "earth/plain/plain.dgml" ) );
+    QCOMPARE( manager.mapThemeModel()->rowCount(), ids.size() );
+
+    QStringList sorted = ids;
+    sorted.sort();
+    QCOMPARE( ids, sorted );
+}
+
+void MapThemeManagerTest::cachedCatalogue()
+{
+    QStringList uncached;
+    {
+        QFile::remove( MarbleDirs::localPath() + "/mapthemes.index" );
+        MapThemeManager manager;
+        uncached = manager.mapThemeIds();
+    }
+
+    // the catalogue is replaced as a whole, no temporary files are left behind
+    const QStringList indexFiles = QDir( MarbleDirs::localPath() ).entryList( QStringList() << "mapthemes.index*", QDir::Files );
+    QCOMPARE( indexFiles, QStringList() << "mapthemes.index" );
+
+    MapThemeManager manager;
+    const QStringList cached = manager.mapThemeIds();
+
+    QCOMPARE( cached, uncached );
+
+    // the catalogue provides names and icons without parsing the themes again
+    QStandardItemModel *model = manager.mapThemeModel();
+    for ( int i = 0; i < model->rowCount(); ++i ) {
+        const QModelIndex index = model->index( i, 0 );
+        QVERIFY( !model->data( index, Qt::DisplayRole ).toString().isEmpty() );
+        QVERIFY( !model->data( index, Qt::DecorationRole ).value<QIcon>().isNull() );
+    }
+}
+
+void MapThemeManagerTest::modelFilledInBackground()
+{
+    QFile::remove( MarbleDirs::localPath() + "/mapthemes.index" );
+
+    MapThemeManager manager;
+    QSignalSpy spy( &manager, SIGNAL(themesChanged()) );
+
+    // the model is returned right away and filled once the themes are parsed
+    QStandardItemModel *model = manager.mapThemeModel();
+    for ( int i = 0; i < 1000 && spy.isEmpty(); ++i ) {
+        QTest::qWait( 10 );
+    }
+    QVERIFY( !spy.isEmpty() );
+
+    QVERIFY( model->rowCount() > 0 );
+    QCOMPARE( model->rowCount(), manager.mapThemeIds().size() );
+}
+
+}
+
+QTEST_MAIN( Marble::MapThemeManagerTest )
+
+#include "MapThemeManagerTest.moc"
@@ -0,0 +1,339 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <qmath.h>
+#include <QtTest>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include "GeoPainter.h"
+#include "MarbleDirs.h"
+#include "MarbleGlobal.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+#include "TestUtils.h"
+#include "TraceRecorder.h"
+
+namespace Marble
+{
+
+/**
+ * Renders scripted camera paths with MarbleMap into an offscreen image, for
+ * each projection, map quality and bundled map theme.
+ *
+ * The local data of the user is not used: the local path points to a
+ * temporary directory, which is seeded with the tiles of the directory named
+ * by the MARBLE_BENCHMARK_TILES environment variable, if any. Downloads are
+ * disabled, so the results only depend on the installed and seeded tiles.
+ * Each path is run once to fill the tile cache and then measured.
+ *
+ * The median frame time is reported as the benchmark result of each row. The
+ * frame time percentiles, the time spent in each layer and the peak memory
+ * usage of each row are written as JSON to the file named by the
+ * MARBLE_BENCHMARK_RESULTS environment variable. Nothing is written if it is
+ * not set.
+ */
+class MarbleMapSpeedTest : public QObject
+{
+    Q_OBJECT
+
+ public:
+    MarbleMapSpeedTest();
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void render_data();
+    void render();
+
+ private:
+    static void setCamera( MarbleMap *map, const QString &path, int frame );
+
+    static qreal percentile( const QVector<qreal> &sortedTimes, qreal fraction );
+
+    static void copyDirectory( const QString &source, const QString &destination );
+
+    /**
+     * Returns the value of @p field in /proc/self/status in KiB, or -1 if unknown
+     */
+    static qint64 memoryStatus( const QByteArray &field );
+
+    /**
+     * Resets the peak memory usage to the current one, returns false if unsupported
+     */
+    static bool resetPeakMemory();
+
+    QString m_dataPath;
+    MarbleModel *m_model;
+    QStringList m_results;
+};
+
+// Frames rendered along each camera path
+static const int frameCount = 30;
+
+MarbleMapSpeedTest::MarbleMapSpeedTest() :
+    m_model( 0 )
+{
+}
+
+void MarbleMapSpeedTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    // the model must not see the tile cache of the user
+    m_dataPath = setTemporaryDataPath( "mapspeedtest" );
+    QVERIFY( MarbleDirs::localPath().startsWith( m_dataPath ) );
+    const QString tiles = QString::fromLocal8Bit( qgetenv( "MARBLE_BENCHMARK_TILES" ) );
+    if ( !tiles.isEmpty() ) {
+        QVERIFY2( QFileInfo( tiles ).isDir(), "MARBLE_BENCHMARK_TILES is not a directory" );
+        copyDirectory( tiles, MarbleDirs::localPath() + "/maps" );
+    }
+
+    m_model = new MarbleModel;
+    m_model->setWorkOffline( true );
+}
+
+void MarbleMapSpeedTest::cleanupTestCase()
+{
+    delete m_model;
+    m_model = 0;
+    removeDirectory( m_dataPath );
+
+    const QString fileName = QString::fromLocal8Bit( qgetenv( "MARBLE_BENCHMARK_RESULTS" ) );
+    if ( fileName.isEmpty() ) {
+        qDebug() << "Set MARBLE_BENCHMARK_RESULTS to the file the results are written to";
+        return;
+    }
+
+    QFile file( fileName );
+    QVERIFY( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+    QTextStream stream( &file );
+    stream << "{\n"
+           << "  \"marbleVersion\": \"" << MARBLE_VERSION_STRING << "\",\n"
+           << "  \"qtVersion\": \"" << qVersion() << "\",\n"
+           << "  \"date\": \"" << QDateTime::currentDateTime().toUTC().toString( Qt::ISODate ) << "\",\n"
+           << "  \"frames\": " << frameCount << ",\n"
+           << "  \"results\": [\n" << m_results.join( ",\n" ) << "\n  ]\n"
+           << "}\n";
+
+    qDebug() << "Benchmark results written to" << QFileInfo( file ).absoluteFilePath();
+}
+
+void MarbleMapSpeedTest::render_data()
+{
+    QTest::addColumn<QString>( "theme" );
+    QTest::addColumn<int>( "projection" );
+    QTest::addColumn<int>( "quality" );
+    QTest::addColumn<QString>( "path" );
+
+    QStringList themes;
+    themes << "earth/plain/plain.dgml" << "earth/srtm/srtm.dgml" << "earth/openstreetmap/openstreetmap.dgml";
+
+    QMap<int, QString> projections;
+    projections[Spherical] = "spherical";
+    projections[Equirectangular] = "equirectangular";
+    projections[Mercator] = "mercator";
+
+    QMap<int, QString> qualities;
+    qualities[OutlineQuality] = "outline";
+    qualities[LowQuality] = "low";
+    qualities[NormalQuality] = "normal";
+    qualities[HighQuality] = "high";
+    qualities[PrintQuality] = "print";
+
+    QStringList paths;
+    paths << "pan" << "zoom" << "flyTo" << "rotation";
+
+    foreach ( const QString &theme, themes ) {
+        const QString themeName = theme.section( '/', 1, 1 );
+        foreach ( int projection, projections.keys() ) {
+            foreach ( int quality, qualities.keys() ) {
+                foreach ( const QString &path, paths ) {
+                    const QString name = QString( "%1 %2 %3 %4" ).arg( themeName ).arg( projections[projection] )
+                            .arg( qualities[quality] ).arg( path );
+                    QTest::newRow( name.toLatin1().constData() ) << theme << projection << quality << path;
+                }
+            }
+        }
+    }
+}
+
+void MarbleMapSpeedTest::setCamera( MarbleMap *map, const QString &path, int frame )
+{
+    const qreal progress = frame / qreal( frameCount - 1 );
+
+    if ( path == "pan" ) {
+        // steps of about 20 pixels at a close distance
+        map->setRadius( 2000 );
+        map->centerOn( 5.0 + 0.5 * frame, 48.0 );
+    } else if ( path == "zoom" ) {
+        // from the whole globe to a city in constant zoom steps
+        map->setRadius( qRound( 250 * qPow( 40.0, progress ) ) );
+        map->centerOn( 8.4, 49.0 );
+    } else if ( path == "flyTo" ) {
+        // zooms out halfway between two cities and back in
+        map->setRadius( qRound( 3000 / ( 1.0 + 9.0 * qSin( M_PI * progress ) ) ) );
+        map->centerOn( -74.0 + progress * ( 2.3 + 74.0 ), 40.7 + progress * ( 48.9 - 40.7 ) );
+    } else if ( path == "rotation" ) {
+        // spins the whole globe once
+        map->setRadius( 280 );
+        map->centerOn( -180.0 + 360.0 * frame / frameCount, 20.0 );
+    }
+}
+
+qreal MarbleMapSpeedTest::percentile( const QVector<qreal> &sortedTimes, qreal fraction )
+{
+    // nearest rank
+    const int rank = qCeil( fraction * sortedTimes.size() );
+    return sortedTimes.at( qBound( 0, rank - 1, sortedTimes.size() - 1 ) );
+}
+
+void MarbleMapSpeedTest::copyDirectory( const QString &source, const QString &destination )
+{
+    QDir().mkpath( destination );
+    foreach ( const QFileInfo &info, QDir( source ).entryInfoList( QDir::AllEntries | QDir::NoDotAndDotDot ) ) {
+        const QString target = destination + '/' + info.fileName();
+        if ( info.isDir() ) {
+            copyDirectory( info.absoluteFilePath(), target );
+        } else {
+            QFile::copy( info.absoluteFilePath(), target );
+        }
+    }
+}
+
+qint64 MarbleMapSpeedTest::memoryStatus( const QByteArray &field )
+{
+#ifdef Q_OS_LINUX
+    QFile status( "/proc/self/status" );
+    if ( status.open( QIODevice::ReadOnly ) ) {
+        foreach ( const QByteArray &line, status.readAll().split( '\n' ) ) {
+            if ( line.startsWith( field ) ) {
+                return line.mid( field.size() ).trimmed().split( ' ' ).first().toLongLong();
+            }
+        }
+    }
+#else
+    Q_UNUSED( field );
+#endif
+
+    return -1;
+}
+
+bool MarbleMapSpeedTest::resetPeakMemory()
+{
+#ifdef Q_OS_LINUX
+    // the peak only rises otherwise, this resets it since Linux 4.0
+    QFile clearRefs( "/proc/self/clear_refs" );
+    return clearRefs.open( QIODevice::WriteOnly ) && clearRefs.write( "5" ) == 1;
+#else
+    return false;
+#endif
+}
+
+void MarbleMapSpeedTest::render()
+{
+    QFETCH( QString, theme );
+    QFETCH( int, projection );
+    QFETCH( int, quality );
+    QFETCH( QString, path );
+
+    // measure the peak of this row only
+    const bool peakReset = resetPeakMemory();
+    const qint64 startMemory = memoryStatus( "VmRSS:" );
+
+    MarbleMap map( m_model );
+    map.setMapThemeId( theme );
+    map.setSize( 800, 600 );
+    map.setProjection( Projection( projection ) );
+    map.setMapQualityForViewContext( MapQuality( quality ), Still );
+    map.setViewContext( Still );
+    QCOMPARE( map.mapThemeId(), theme );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+
+    // fill the tile cache, then measure
+    QVector<qreal> times;
+    for ( int run = 0; run < 2; ++run ) {
+        if ( run == 1 ) {
+            m_model->setTracingEnabled( true );
+            TraceRecorder::clear();
+        }
+
+        for ( int frame = 0; frame < frameCount; ++frame ) {
+            setCamera( &map, path, frame );
+
+            QElapsedTimer timer;
+            timer.start();
+            {
+                GeoPainter painter( &image, map.viewport(), map.mapQuality() );
+                map.paint( painter, QRect() );
+            }
+            if ( run == 1 ) {
+                times << timer.nsecsElapsed() / 1000000.0;
+            }
+
+            // let tiles loaded in the background arrive
+            QCoreApplication::processEvents();
+        }
+
+        QThreadPool::globalInstance()->waitForDone();
+        QCoreApplication::processEvents();
+    }
+    m_model->setTracingEnabled( false );
+
+    QCOMPARE( times.size(), frameCount );
+    QVector<qreal> sortedTimes = times;
+    qSort( sortedTimes );
+
+    qreal total = 0.0;
+    foreach ( qreal time, times ) {
+        total += time;
+    }
+
+    const qreal median = percentile( sortedTimes, 0.5 );
+    QTest::setBenchmarkResult( median, QTest::WalltimeMilliseconds );
+
+    QStringList zones;
+    foreach ( const TraceRecorder::ZoneSummary &zone, TraceRecorder::summaries() ) {
+        zones << QString( "        { \"name\": \"%1\", \"count\": %2, \"total\": %3, \"median\": %4, \"p90\": %5, \"p99\": %6, \"max\": %7 }" )
+                 .arg( QString( zone.name ).replace( '\\', "\\\\" ).replace( '"', "\\\"" ) )
+                 .arg( zone.count ).arg( zone.total, 0, 'f', 3 ).arg( zone.median, 0, 'f', 3 )
+                 .arg( zone.percentile90, 0, 'f', 3 ).arg( zone.percentile99, 0, 'f', 3 ).arg( zone.maximum, 0, 'f', 3 );
+    }
+
+    QString result = "    {\n";
+    result += QString( "      \"row\": \"%1\",\n" ).arg( QTest::currentDataTag() );
+    result += QString( "      \"theme\": \"%1\", \"projection\": %2, \"quality\": %3, \"path\": \"%4\",\n" )
+              .arg( theme ).arg( projection ).arg( quality ).arg( path );
+    result += QString( "      \"frameTimes\": { \"mean\": %1, \"median\": %2, \"p90\": %3, \"p99\": %4, \"max\": %5 },\n" )
+              .arg( total / times.size(), 0, 'f', 3 ).arg( median, 0, 'f', 3 )
+              .arg( percentile( sortedTimes, 0.9 ), 0, 'f', 3 ).arg( percentile( sortedTimes, 0.99 ), 0, 'f', 3 )
+              .arg( sortedTimes.last(), 0, 'f', 3 );
+    // unknown values are -1
+    const qint64 peakMemory = peakReset ? memoryStatus( "VmHWM:" ) : -1;
+    const qint64 peakGrowth = peakMemory >= 0 && startMemory >= 0 ? peakMemory - startMemory : -1;
+    result += QString( "      \"peakMemoryKiB\": %1, \"peakMemoryGrowthKiB\": %2,\n" ).arg( peakMemory ).arg( peakGrowth );
+    result += "      \"zones\": [\n" + zones.join( ",\n" ) + "\n      ]\n";
+    result += "    }";
+    m_results << result;
+}
+
+}
+
+QTEST_MAIN( Marble::MarbleMapSpeedTest )
+
+#include "MarbleMapSpeedTest.moc"
@@ -9,9 +9,11 @@
 //
 
 #include <QtTest>
+#include "GeoDataLineString.h"
 #include "GeoPainter.h"
 #include "MarbleMap.h"
 #include "MarbleModel.h"
+#include "layers/TextureLayer.h"
 #include "TestUtils.h"
 
 namespace Marble
@@ -65,6 +67,8 @@ class MarbleMapTest : public QObject
     void paint_data();
     void paint();
 
+    void prefetchTiles();
+
  private:
     MarbleModel m_model;
 };
@@ -593,6 +597,41 @@ void MarbleMapTest::paint()
     QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
 }
 
+void MarbleMapTest::prefetchTiles()
+{
+    MarbleMap map;
+
+    map.setMapThemeId( "earth/srtm/srtm.dgml" );
+    map.setSize( 200, 200 );
+    map.setRadius( 2000 ); // tile level 3, which is installed locally
+    map.centerOn( 0.0, 0.0 );
+
+    QPixmap paintDevice( map.size() );
+    GeoPainter painter( &paintDevice, map.viewport(), map.mapQuality() );
+    map.paint( painter, QRect() );
+    QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
+
+    // tiles loaded without being queued for prefetching are no misses
+    QCOMPARE( map.textureLayer()->prefetchMisses(), 0 );
+
+    // the tiles along the equator are not shown yet
+    GeoDataLineString path;
+    path << GeoDataCoordinates( 0.0, 0.0, 0.0, GeoDataCoordinates::Degree );
+    path << GeoDataCoordinates( 90.0, 0.0, 0.0, GeoDataCoordinates::Degree );
+    map.prefetchTiles( path, map.radius() );
+    QTest::qWait( 500 ); // the queue is processed in the event loop
+
+    QVERIFY( map.textureLayer()->prefetchedTileCount() > 0 );
+    QCOMPARE( map.textureLayer()->prefetchHits(), 0 );
+
+    map.centerOn( 90.0, 0.0 );
+    map.paint( painter, QRect() );
+
+    QVERIFY( map.textureLayer()->prefetchHits() > 0 );
+
+    QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
+}
+
 }
 
 QTEST_MAIN( Marble::MarbleMapTest )
@@ -0,0 +1,180 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "MipChainHelper.h"
+
+#include "TestUtils.h"
+
+#include <qmath.h>
+#include <QImage>
+#include <QtTest>
+
+Q_DECLARE_METATYPE( QSize )
+
+namespace Marble
+{
+
+class MipChainHelperTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void createMipChain();
+    void createMipChainOfPart();
+
+    void mipLevel_data();
+    void mipLevel();
+
+    void mipLevelWhileZooming();
+
+    void withinTolerance_data();
+    void withinTolerance();
+
+    void reuseWhileZooming();
+
+ private:
+    /**
+     * Returns a tile of 256 x 256 pixels, its top left quarter is red
+     */
+    static QImage createTile();
+};
+
+QImage MipChainHelperTest::createTile()
+{
+    QImage tile( 256, 256, QImage::Format_ARGB32_Premultiplied );
+    tile.fill( qRgb( 0, 0, 255 ) );
+    for ( int y = 0; y < 128; ++y ) {
+        for ( int x = 0; x < 128; ++x ) {
+            tile.setPixel( x, y, qRgb( 255, 0, 0 ) );
+        }
+    }
+
+    return tile;
+}
+
+void MipChainHelperTest::createMipChain()
+{
+    const QImage tile = createTile();
+    const QVector<QImage> chain = MipChainHelper::createMipChain( tile, tile.rect() );
+
+    // halved down to 8 pixels
+    QCOMPARE( chain.size(), 6 );
+    for ( int level = 0; level < chain.size(); ++level ) {
+        QCOMPARE( chain.at( level ).size(), QSize( 256 >> level, 256 >> level ) );
+    }
+    QCOMPARE( chain.first(), tile );
+    QCOMPARE( chain.last().pixel( 1, 1 ), qRgb( 255, 0, 0 ) );
+    QCOMPARE( chain.last().pixel( 6, 6 ), qRgb( 0, 0, 255 ) );
+
+    QVERIFY( MipChainHelper::mipChainCost( chain ) >= 256 * 256 * 4 / 1024 );
+}
+
+void MipChainHelperTest::createMipChainOfPart()
+{
+    // the part of a coarser tile covering a tile is scaled to the full tile size
+    const QVector<QImage> chain = MipChainHelper::createMipChain( createTile(), QRect( 0, 0, 128, 128 ) );
+
+    QCOMPARE( chain.first().size(), QSize( 256, 256 ) );
+    QCOMPARE( chain.first().pixel( 200, 200 ), qRgb( 255, 0, 0 ) );
+}
+
+void MipChainHelperTest::mipLevel_data()
+{
+    QTest::addColumn<QSize>( "size" );
+    QTest::addColumn<int>( "width" );
+
+    addRow() << QSize( 512, 512 ) << 256;
+    addRow() << QSize( 256, 256 ) << 256;
+    addRow() << QSize( 200, 200 ) << 256;
+    addRow() << QSize( 129, 129 ) << 256;
+    addRow() << QSize( 128, 128 ) << 128;
+    addRow() << QSize( 100, 100 ) << 128;
+    addRow() << QSize( 64, 64 ) << 64;
+    addRow() << QSize( 5, 5 ) << 8;
+    // both directions have to fit
+    addRow() << QSize( 100, 20 ) << 128;
+    addRow() << QSize( 20, 100 ) << 128;
+}
+
+void MipChainHelperTest::mipLevel()
+{
+    QFETCH( QSize, size );
+    QFETCH( int, width );
+
+    const QImage tile = createTile();
+    const QVector<QImage> chain = MipChainHelper::createMipChain( tile, tile.rect() );
+
+    QCOMPARE( MipChainHelper::mipLevel( chain, size ).width(), width );
+    QCOMPARE( MipChainHelper::scaledTile( chain, size ).size(), size );
+}
+
+void MipChainHelperTest::mipLevelWhileZooming()
+{
+    const QImage tile = createTile();
+    const QVector<QImage> chain = MipChainHelper::createMipChain( tile, tile.rect() );
+
+    // zooming out in steps of a tenth of a tile level
+    int previousWidth = 256;
+    for ( int step = 0; step <= 50; ++step ) {
+        const int needed = qRound( 256 * qPow( 0.5, step / 10.0 ) );
+        const QImage &level = MipChainHelper::mipLevel( chain, QSize( needed, needed ) );
+
+        // never scaled up, and from the smallest level which is large enough
+        QVERIFY( level.width() >= needed );
+        QVERIFY( level.width() < 2 * needed || level.width() == 8 );
+        QVERIFY( level.width() <= previousWidth );
+        previousWidth = level.width();
+    }
+    QCOMPARE( previousWidth, 8 );
+}
+
+void MipChainHelperTest::withinTolerance_data()
+{
+    QTest::addColumn<QSize>( "size" );
+    QTest::addColumn<QSize>( "needed" );
+    QTest::addColumn<bool>( "reused" );
+
+    addRow() << QSize( 256, 256 ) << QSize( 256, 256 ) << true;
+    addRow() << QSize( 256, 256 ) << QSize( 250, 250 ) << true;
+    addRow() << QSize( 256, 256 ) << QSize( 266, 266 ) << true;
+    addRow() << QSize( 256, 256 ) << QSize( 240, 240 ) << false;
+    addRow() << QSize( 256, 256 ) << QSize( 272, 272 ) << false;
+    addRow() << QSize( 256, 256 ) << QSize( 256, 200 ) << false;
+}
+
+void MipChainHelperTest::withinTolerance()
+{
+    QFETCH( QSize, size );
+    QFETCH( QSize, needed );
+    QFETCH( bool, reused );
+
+    QCOMPARE( MipChainHelper::withinTolerance( size, needed ), reused );
+}
+
+void MipChainHelperTest::reuseWhileZooming()
+{
+    // a tile scaled at one radius is reused for radii up to five percent apart
+    const QSize scaled( 300, 300 );
+    int reusedSteps = 0;
+    for ( int step = 1; step <= 20; ++step ) {
+        const int needed = qRound( 300 * ( 1.0 + step / 100.0 ) );
+        if ( MipChainHelper::withinTolerance( scaled, QSize( needed, needed ) ) ) {
+            ++reusedSteps;
+        }
+    }
+
+    QCOMPARE( reusedSteps, 5 );
+}
+
+}
+
+QTEST_MAIN( Marble::MipChainHelperTest )
+
+#include "MipChainHelperTest.moc"
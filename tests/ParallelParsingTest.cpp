@@ -0,0 +1,268 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <QBuffer>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <QtTest>
+
+#include "GeoDataFolder.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTypes.h"
+#include "GeoParallelParser.h"
+#include "MarbleDirs.h"
+#include "ParsingRunnerManager.h"
+#include "PluginManager.h"
+#include "TestUtils.h"
+
+namespace Marble
+{
+
+class KmlTestParallelParser : public GeoParallelParser
+{
+public:
+    KmlTestParallelParser() : GeoParallelParser( "Placemark" ) {}
+
+protected:
+    virtual GeoParser *createParser() const
+    {
+        return new GeoDataParser( GeoData_KML );
+    }
+};
+
+class ParallelParsingTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void compareWithSequential_data();
+    void compareWithSequential();
+
+    void styleAcrossChunks();
+    void defaultStylesOnWorkerThreads();
+    void invalidInput();
+
+    void parseBenchmark_data();
+    void parseBenchmark();
+
+ private:
+    /**
+     * Returns a KML document with @p count placemarks in nested folders,
+     * using a style defined at the very beginning of the document.
+     */
+    static QByteArray createKml( int count );
+
+    /**
+     * Returns the names of all features of @p container in document order,
+     * with folders enclosing the names of their children in brackets.
+     */
+    static QStringList names( const GeoDataContainer *container );
+
+    static const GeoDataStyle *style( const GeoDataPlacemark &placemark );
+};
+
+void ParallelParsingTest::initTestCase()
+{
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+}
+
+QByteArray ParallelParsingTest::createKml( int count )
+{
+    QByteArray kml;
+    kml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+           "<Document>\n"
+           "<name>Parallel</name>\n"
+           "<Style id=\"wide\"><LineStyle><width>7</width></LineStyle></Style>\n"
+           "<!-- a <Placemark> in a comment -->\n";
+
+    for ( int i = 0; i < count; ++i ) {
+        if ( i % 100 == 0 ) {
+            kml += QString( "<Folder><name>Folder %1</name>\n" ).arg( i / 100 ).toUtf8();
+        }
+        const qreal lon = -180.0 + 360.0 * i / count;
+        kml += QString( "<Placemark><name>%1</name><styleUrl>#wide</styleUrl>"
+                        "<description><![CDATA[</Placemark></Folder>]]></description>"
+                        "<LineString><coordinates>%2,10 %3,11</coordinates></LineString>"
+                        "</Placemark>\n" ).arg( i ).arg( lon ).arg( lon + 0.1 ).toUtf8();
+        if ( i % 100 == 99 || i == count - 1 ) {
+            kml += "</Folder>\n";
+        }
+    }
+
+    kml += "</Document>\n</kml>\n";
+    return kml;
+}
+
+QStringList ParallelParsingTest::names( const GeoDataContainer *container )
+{
+    QStringList result;
+    foreach( const GeoDataFeature *feature, container->featureList() ) {
+        result << feature->name();
+        if ( feature->nodeType() == GeoDataTypes::GeoDataFolderType ) {
+            result << "[" << names( static_cast<const GeoDataFolder*>( feature ) ) << "]";
+        }
+    }
+    return result;
+}
+
+void ParallelParsingTest::compareWithSequential_data()
+{
+    QTest::addColumn<int>( "count" );
+    QTest::addColumn<int>( "chunkSize" );
+    QTest::addColumn<int>( "threadCount" );
+
+    addRow() << 10 << 4 * 1024 * 1024 << 4;
+    addRow() << 250 << 1024 << 1;
+    addRow() << 250 << 1024 << 4;
+    addRow() << 1000 << 200 << 3;
+}
+
+void ParallelParsingTest::compareWithSequential()
+{
+    QFETCH( int, count );
+    QFETCH( int, chunkSize );
+    QFETCH( int, threadCount );
+
+    const QByteArray kml = createKml( count );
+
+    GeoDataDocument *sequential = parseKml( QString::fromUtf8( kml ) );
+    QVERIFY( sequential );
+
+    QBuffer buffer;
+    buffer.setData( kml );
+    buffer.open( QIODevice::ReadOnly );
+
+    KmlTestParallelParser parser;
+    parser.setChunkSize( chunkSize );
+    parser.setThreadCount( threadCount );
+    QVERIFY( parser.read( &buffer ) );
+    GeoDataDocument *parallel = parser.releaseDocument();
+    QVERIFY( parallel );
+
+    if ( kml.size() > 2 * chunkSize ) {
+        QVERIFY( parser.chunkCount() > 1 );
+    } else {
+        QCOMPARE( parser.chunkCount(), 1 );
+    }
+
+    QCOMPARE( parallel->name(), sequential->name() );
+    QCOMPARE( parallel->folderList().size(), sequential->folderList().size() );
+    QCOMPARE( names( parallel ), names( sequential ) );
+
+    delete sequential;
+    delete parallel;
+}
+
+void ParallelParsingTest::styleAcrossChunks()
+{
+    QBuffer buffer;
+    buffer.setData( createKml( 300 ) );
+    buffer.open( QIODevice::ReadOnly );
+
+    KmlTestParallelParser parser;
+    parser.setChunkSize( 512 );
+    parser.setThreadCount( 2 );
+    QVERIFY( parser.read( &buffer ) );
+    QVERIFY( parser.chunkCount() > 2 );
+
+    GeoDataDocument *document = parser.releaseDocument();
+    QVERIFY( document );
+
+    QCOMPARE( document->styles().size(), 1 );
+    foreach( const GeoDataFolder *folder, document->folderList() ) {
+        foreach( const GeoDataPlacemark *placemark, folder->placemarkList() ) {
+            QCOMPARE( placemark->style()->lineStyle().width(), float( 7.0 ) );
+        }
+    }
+
+    delete document;
+}
+
+const GeoDataStyle *ParallelParsingTest::style( const GeoDataPlacemark &placemark )
+{
+    return placemark.style();
+}
+
+void ParallelParsingTest::defaultStylesOnWorkerThreads()
+{
+    QList<GeoDataPlacemark> placemarks;
+    for ( int i = 0; i < 1000; ++i ) {
+        GeoDataPlacemark placemark;
+        placemark.setVisualCategory( GeoDataFeature::GeoDataVisualCategory( i % GeoDataFeature::LastIndex ) );
+        placemarks << placemark;
+    }
+
+    // the default styles are initialized by whichever thread requests them first
+    GeoDataFeature::resetDefaultStyles();
+    const QList<const GeoDataStyle *> styles =
+            QtConcurrent::blockingMapped< QList<const GeoDataStyle *> >( placemarks, &ParallelParsingTest::style );
+
+    QCOMPARE( styles.size(), placemarks.size() );
+    for ( int i = 0; i < placemarks.size(); ++i ) {
+        QVERIFY( styles.at( i ) != 0 );
+        QCOMPARE( styles.at( i ), placemarks.at( i ).style() );
+    }
+}
+
+void ParallelParsingTest::invalidInput()
+{
+    QByteArray kml = createKml( 200 );
+    kml.replace( "<name>150</name>", "<name>150</nam>" );
+
+    QBuffer buffer;
+    buffer.setData( kml );
+    buffer.open( QIODevice::ReadOnly );
+
+    KmlTestParallelParser parser;
+    parser.setChunkSize( 1024 );
+    QVERIFY( !parser.read( &buffer ) );
+    QVERIFY( !parser.errorString().isEmpty() );
+    QVERIFY( parser.releaseDocument() == 0 );
+}
+
+void ParallelParsingTest::parseBenchmark_data()
+{
+    QTest::addColumn<int>( "threadCount" );
+
+    QTest::newRow( "1 thread" ) << 1;
+    QTest::newRow( "ideal thread count" ) << QThread::idealThreadCount();
+}
+
+void ParallelParsingTest::parseBenchmark()
+{
+    QFETCH( int, threadCount );
+
+    QTemporaryFile file( QDir::tempPath() + "/marble-parallel-XXXXXX.kml" );
+    QVERIFY( file.open() );
+    file.write( createKml( 200000 ) );
+    file.close();
+
+    PluginManager pluginManager;
+    ParsingRunnerManager runnerManager( &pluginManager );
+    runnerManager.setThreadCount( threadCount );
+
+    QBENCHMARK {
+        GeoDataDocument *document = runnerManager.openFile( file.fileName() );
+        QVERIFY( document );
+        QCOMPARE( document->folderList().size(), 2000 );
+        delete document;
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::ParallelParsingTest )
+
+#include "ParallelParsingTest.moc"
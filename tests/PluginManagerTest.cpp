@@ -11,7 +11,10 @@
 #include <QtTest>
 
 #include "MarbleDirs.h"
+#include "ParseRunnerPlugin.h"
 #include "PluginManager.h"
+#include "RenderPlugin.h"
+#include "TestUtils.h"
 
 namespace Marble
 {
@@ -20,9 +23,29 @@ class PluginManagerTest : public QObject
 {
     Q_OBJECT
     private slots:
+        void initTestCase();
+        void cleanupTestCase();
+
         void loadPlugins();
+        void loadParsingRunnerPluginsForFile();
+        void loadRenderPluginsOfBackendTypes();
+
+    private:
+        QString m_dataPath;
 };
 
+void PluginManagerTest::initTestCase()
+{
+    // never touch the plugin index of the user
+    m_dataPath = setTemporaryDataPath( "pluginmanager" );
+    QVERIFY( MarbleDirs::localPath().startsWith( m_dataPath ) );
+}
+
+void PluginManagerTest::cleanupTestCase()
+{
+    removeDirectory( m_dataPath );
+}
+
 void PluginManagerTest::loadPlugins()
 {
     MarbleDirs::setMarbleDataPath( DATA_PATH );
@@ -43,6 +66,61 @@ void PluginManagerTest::loadPlugins()
     QCOMPARE( renderPlugins + positionPlugins + runnerPlugins, pluginNumber );
 }
 
+void PluginManagerTest::loadParsingRunnerPluginsForFile()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    PluginManager pm;
+    const QList<const ParseRunnerPlugin *> kmlPlugins = pm.parsingRunnerPlugins( "track.kml" );
+    QVERIFY( !kmlPlugins.isEmpty() );
+
+    foreach( const ParseRunnerPlugin *plugin, kmlPlugins ) {
+        const QStringList extensions = plugin->fileExtensions();
+        QVERIFY( extensions.isEmpty() || extensions.contains( "kml" ) );
+    }
+
+    // requesting all plugins afterwards must not lose any
+    const QList<const ParseRunnerPlugin *> allPlugins = pm.parsingRunnerPlugins();
+    QVERIFY( allPlugins.size() >= kmlPlugins.size() );
+    foreach( const ParseRunnerPlugin *plugin, kmlPlugins ) {
+        QVERIFY( allPlugins.contains( plugin ) );
+    }
+}
+
+void PluginManagerTest::loadRenderPluginsOfBackendTypes()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    QStringList backendTypes;
+    {
+        // loading all plugins once makes sure the index knows about them
+        PluginManager pm;
+        const QList<const RenderPlugin *> renderPlugins = pm.renderPlugins();
+        QVERIFY( !renderPlugins.isEmpty() );
+        backendTypes = renderPlugins.first()->backendTypes();
+    }
+
+    PluginManager pm;
+    pm.setRenderPluginBackendTypes( backendTypes );
+    QCOMPARE( pm.renderPluginBackendTypes(), backendTypes );
+
+    const QList<const RenderPlugin *> renderPlugins = pm.renderPlugins();
+    QVERIFY( !renderPlugins.isEmpty() );
+    foreach( const RenderPlugin *plugin, renderPlugins ) {
+        bool accepted = false;
+        foreach( const QString &backendType, plugin->backendTypes() ) {
+            accepted = accepted || backendTypes.contains( backendType );
+        }
+        QVERIFY( accepted );
+    }
+
+    // the index is replaced as a whole, no temporary files are left behind
+    const QStringList indexFiles = QDir( MarbleDirs::localPath() ).entryList( QStringList() << "plugins.index*", QDir::Files );
+    QCOMPARE( indexFiles, QStringList() << "plugins.index" );
+}
+
 }
 
 QTEST_MAIN( Marble::PluginManagerTest )
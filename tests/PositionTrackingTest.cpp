@@ -10,7 +10,13 @@
 
 #include <QtTest>
 
+#include "GeoDataDocument.h"
+#include "GeoDataMultiTrack.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTrack.h"
 #include "GeoDataTreeModel.h"
+#include "MarbleDirs.h"
+#include "PositionLog.h"
 #include "PositionProviderPlugin.h"
 #include "PositionTracking.h"
 #include "TestUtils.h"
@@ -92,6 +98,9 @@ void FakeProvider::setPosition( const Marble::GeoDataCoordinates &position,
 namespace Marble
 {
 
+// in meters per second
+static const qreal knots = 1852.0 / 3600.0;
+
 class PositionTrackingTest : public QObject
 {
     Q_OBJECT
@@ -100,12 +109,43 @@ class PositionTrackingTest : public QObject
     PositionTrackingTest();
 
  private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
     void statusChanged_data();
     void statusChanged();
 
     void setPositionProviderPlugin();
 
     void clearTrack();
+
+    void decimateTrack();
+
+    void segmentBreak();
+
+    void positionLog();
+
+    void replayNmea_data();
+    void replayNmea();
+
+ private:
+    /**
+     * Returns the track the position tracking in @p treeModel currently adds to
+     */
+    static const GeoDataTrack *currentTrack( GeoDataTreeModel *treeModel );
+
+    /**
+     * Returns the GPRMC sentences of a drive of @p count fixes at 10 Hz
+     * along a gently curving road
+     */
+    static QList<QByteArray> nmeaStream( int count );
+
+    /**
+     * Feeds the GPRMC @p sentence to @p provider
+     */
+    static void replaySentence( const QByteArray &sentence, FakeProvider *provider );
+
+    QString m_dataPath;
 };
 
 PositionTrackingTest::PositionTrackingTest()
@@ -114,6 +154,18 @@ PositionTrackingTest::PositionTrackingTest()
     qRegisterMetaType<PositionProviderStatus>( "PositionProviderStatus" );
 }
 
+void PositionTrackingTest::initTestCase()
+{
+    // never touch the track and position log of the user
+    m_dataPath = setTemporaryDataPath( "positiontracking" );
+    QVERIFY( MarbleDirs::localPath().startsWith( m_dataPath ) );
+}
+
+void PositionTrackingTest::cleanupTestCase()
+{
+    removeDirectory( m_dataPath );
+}
+
 void PositionTrackingTest::statusChanged_data()
 {
     QTest::addColumn<PositionProviderStatus>( "finalStatus" );
@@ -207,6 +259,221 @@ void PositionTrackingTest::clearTrack()
     QVERIFY( tracking.isTrackEmpty() );
 }
 
+const GeoDataTrack *PositionTrackingTest::currentTrack( GeoDataTreeModel *treeModel )
+{
+    const GeoDataDocument *document = dynamic_cast<GeoDataDocument*>( treeModel->rootDocument()->child( 0 ) );
+    Q_ASSERT( document );
+    const GeoDataPlacemark *placemark = dynamic_cast<const GeoDataPlacemark*>( document->child( 1 ) );
+    Q_ASSERT( placemark );
+    const GeoDataMultiTrack *multiTrack = dynamic_cast<const GeoDataMultiTrack*>( placemark->geometry() );
+    Q_ASSERT( multiTrack );
+    return multiTrack->child( multiTrack->size() - 1 );
+}
+
+void PositionTrackingTest::decimateTrack()
+{
+    const GeoDataAccuracy accuracy( GeoDataAccuracy::Detailed, 5.0, 10.0 );
+    const QDateTime start( QDate( 2013, 6, 1 ), QTime( 12, 0 ), Qt::UTC );
+    // about six meters
+    const qreal step = 1e-6;
+
+    GeoDataTreeModel treeModel;
+    PositionTracking tracking( &treeModel );
+
+    FakeProvider provider;
+    tracking.setPositionProviderPlugin( &provider );
+    provider.setStatus( PositionProviderStatusAvailable );
+
+    // east along the equator, then north
+    for ( int i = 0; i < 100; ++i ) {
+        provider.setPosition( GeoDataCoordinates( i * step, 0.0 ), accuracy, 6.0, 90.0, start.addMSecs( 100 * i ) );
+    }
+    for ( int i = 1; i <= 100; ++i ) {
+        provider.setPosition( GeoDataCoordinates( 99 * step, i * step ), accuracy, 6.0, 0.0, start.addMSecs( 100 * ( 99 + i ) ) );
+    }
+
+    const GeoDataTrack *track = currentTrack( &treeModel );
+    QCOMPARE( track->size(), 3 );
+    QCOMPARE( track->lineString()->size(), 3 );
+    QCOMPARE( track->coordinatesAt( 0 ), GeoDataCoordinates( 0.0, 0.0 ) );
+    QCOMPARE( track->coordinatesAt( 1 ), GeoDataCoordinates( 99 * step, 0.0 ) );
+    QCOMPARE( track->coordinatesAt( 2 ), GeoDataCoordinates( 99 * step, 100 * step ) );
+    QCOMPARE( track->lastWhen(), start.addMSecs( 100 * 199 ) );
+
+    // the length is measured in full resolution
+    QFUZZYCOMPARE( tracking.length( 1.0 ), 199 * step, 1e-9 );
+}
+
+void PositionTrackingTest::segmentBreak()
+{
+    const GeoDataAccuracy accuracy( GeoDataAccuracy::Detailed, 5.0, 10.0 );
+    const QDateTime start( QDate( 2013, 6, 1 ), QTime( 12, 0 ), Qt::UTC );
+    const qreal step = 1e-6;
+
+    GeoDataTreeModel treeModel;
+    PositionTracking tracking( &treeModel );
+
+    FakeProvider provider;
+    tracking.setPositionProviderPlugin( &provider );
+    provider.setStatus( PositionProviderStatusAvailable );
+
+    for ( int i = 0; i < 10; ++i ) {
+        provider.setPosition( GeoDataCoordinates( i * step, 0.0 ), accuracy, 6.0, 90.0, start.addMSecs( 100 * i ) );
+    }
+
+    // the signal is lost and found again a kilometer further east
+    provider.setStatus( PositionProviderStatusAcquiring );
+    provider.setStatus( PositionProviderStatusAvailable );
+    for ( int i = 0; i < 10; ++i ) {
+        provider.setPosition( GeoDataCoordinates( ( 1000 + i ) * step, 0.0 ), accuracy, 6.0, 90.0, start.addSecs( 60 ).addMSecs( 100 * i ) );
+    }
+
+    const GeoDataTrack *track = currentTrack( &treeModel );
+    QCOMPARE( track->coordinatesAt( 0 ), GeoDataCoordinates( 1000 * step, 0.0 ) );
+
+    // only the distance within the segments counts
+    QFUZZYCOMPARE( tracking.length( 1.0 ), 18 * step, 1e-9 );
+}
+
+void PositionTrackingTest::positionLog()
+{
+    QVERIFY( QDir().mkpath( m_dataPath ) );
+    const QString fileName = m_dataPath + "/PositionTrackingTest.log";
+    QFile::remove( fileName );
+    const QDateTime start( QDate( 2013, 6, 1 ), QTime( 12, 0 ), Qt::UTC );
+
+    {
+        PositionLog log( fileName, 10 );
+        QCOMPARE( log.size(), 0 );
+        for ( int i = 0; i < 25; ++i ) {
+            PositionLog::Fix fix;
+            fix.timestamp = start.addMSecs( 100 * i );
+            fix.position = GeoDataCoordinates( 0.001 * i, 0.5, 100.0 );
+            fix.accuracy = GeoDataAccuracy( GeoDataAccuracy::Detailed, 5.0, 10.0 );
+            fix.speed = i;
+            fix.direction = 45.0;
+            log.append( fix );
+        }
+        QCOMPARE( log.size(), 10 );
+    }
+
+    // the oldest fixes were overwritten
+    PositionLog log( fileName, 10 );
+    QCOMPARE( log.size(), 10 );
+    QCOMPARE( QFileInfo( fileName ).size(), qint64( 20 + 10 * 64 ) );
+
+    const QList<PositionLog::Fix> fixes = log.fixes();
+    QCOMPARE( fixes.size(), 10 );
+    for ( int i = 0; i < 10; ++i ) {
+        QCOMPARE( fixes.at( i ).timestamp, start.addMSecs( 100 * ( i + 15 ) ) );
+        QCOMPARE( fixes.at( i ).position, GeoDataCoordinates( 0.001 * ( i + 15 ), 0.5, 100.0 ) );
+        QCOMPARE( fixes.at( i ).accuracy.horizontal, 5.0 );
+        QCOMPARE( fixes.at( i ).speed, qreal( i + 15 ) );
+    }
+
+    // a different capacity starts a new log
+    PositionLog other( fileName, 20 );
+    QCOMPARE( other.size(), 0 );
+
+    QFile::remove( fileName );
+}
+
+QList<QByteArray> PositionTrackingTest::nmeaStream( int count )
+{
+    QList<QByteArray> result;
+
+    const QDateTime start( QDate( 2013, 6, 1 ), QTime( 6, 0 ), Qt::UTC );
+    qreal lon = 8.4;
+    qreal lat = 49.0;
+    qreal course = 60.0;
+    const qreal speed = 25.0; // meters per second
+
+    for ( int i = 0; i < count; ++i ) {
+        const QDateTime time = start.addMSecs( 100 * i );
+        // a bend every minute
+        course += 0.2 * sin( i / 600.0 * M_PI );
+        lat += speed * 0.1 * cos( course * DEG2RAD ) / EARTH_RADIUS * RAD2DEG;
+        lon += speed * 0.1 * sin( course * DEG2RAD ) / ( EARTH_RADIUS * cos( lat * DEG2RAD ) ) * RAD2DEG;
+
+        const QString body = QString( "GPRMC,%1,A,%2%3,N,%4%5,E,%6,%7,%8,,,A" )
+                             .arg( time.toString( "hhmmss.zzz" ) )
+                             .arg( int( lat ), 2, 10, QChar( '0' ) )
+                             .arg( ( lat - int( lat ) ) * 60.0, 7, 'f', 4, QChar( '0' ) )
+                             .arg( int( lon ), 3, 10, QChar( '0' ) )
+                             .arg( ( lon - int( lon ) ) * 60.0, 7, 'f', 4, QChar( '0' ) )
+                             .arg( speed / knots, 0, 'f', 1 )
+                             .arg( course, 0, 'f', 1 )
+                             .arg( time.toString( "ddMMyy" ) );
+
+        char checksum = 0;
+        foreach ( char c, body.toLatin1() ) {
+            checksum ^= c;
+        }
+        result << QString( "$%1*%2" ).arg( body ).arg( int( checksum ) & 0xff, 2, 16, QChar( '0' ) ).toUpper().toLatin1();
+    }
+
+    return result;
+}
+
+void PositionTrackingTest::replaySentence( const QByteArray &sentence, FakeProvider *provider )
+{
+    const QList<QByteArray> values = sentence.left( sentence.indexOf( '*' ) ).split( ',' );
+    if ( values.size() < 10 || values.at( 0 ) != "$GPRMC" || values.at( 2 ) != "A" ) {
+        return;
+    }
+
+    const QTime time = QTime::fromString( values.at( 1 ), "hhmmss.zzz" );
+    const QDate date = QDate::fromString( values.at( 9 ), "ddMMyy" ).addYears( 100 );
+
+    qreal lat = values.at( 3 ).left( 2 ).toDouble() + values.at( 3 ).mid( 2 ).toDouble() / 60.0;
+    if ( values.at( 4 ) == "S" ) {
+        lat = -lat;
+    }
+    qreal lon = values.at( 5 ).left( 3 ).toDouble() + values.at( 5 ).mid( 3 ).toDouble() / 60.0;
+    if ( values.at( 6 ) == "W" ) {
+        lon = -lon;
+    }
+
+    provider->setPosition( GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree ),
+                           GeoDataAccuracy( GeoDataAccuracy::Detailed, 5.0, 10.0 ),
+                           values.at( 7 ).toDouble() * knots,
+                           values.at( 8 ).toDouble(),
+                           QDateTime( date, time, Qt::UTC ) );
+}
+
+void PositionTrackingTest::replayNmea_data()
+{
+    QTest::addColumn<int>( "count" );
+
+    addRow() << 600;    // a minute at 10 Hz
+    addRow() << 36000;  // an hour at 10 Hz
+}
+
+void PositionTrackingTest::replayNmea()
+{
+    QFETCH( int, count );
+
+    const QList<QByteArray> stream = nmeaStream( count );
+
+    QBENCHMARK {
+        GeoDataTreeModel treeModel;
+        PositionTracking tracking( &treeModel );
+
+        FakeProvider provider;
+        tracking.setPositionProviderPlugin( &provider );
+        provider.setStatus( PositionProviderStatusAvailable );
+
+        foreach ( const QByteArray &sentence, stream ) {
+            replaySentence( sentence, &provider );
+            // the track is shown after every fix
+            currentTrack( &treeModel )->lineString()->latLonAltBox();
+        }
+
+        // a drive with bends every minute does not need a point for every fix
+        QVERIFY( currentTrack( &treeModel )->size() < count / 10 );
+    }
+}
+
 }
 
 QTEST_MAIN( Marble::PositionTrackingTest )
@@ -15,6 +15,7 @@
 #include "TestUtils.h"
 
 Q_DECLARE_METATYPE( Marble::Quaternion )
+Q_DECLARE_METATYPE( Marble::MathPrecision )
 
 namespace Marble
 {
@@ -29,6 +30,26 @@ class QuaternionTest : public QObject
 
     void testSpherical_data();
     void testSpherical();
+
+    void testSinCos_data();
+    void testSinCos();
+
+    void testAtan2_data();
+    void testAtan2();
+
+    void testBatchedSpherical_data();
+    void testBatchedSpherical();
+
+    void testBatchedRotation();
+
+    void rotateBenchmark_data();
+    void rotateBenchmark();
+
+ private:
+    /**
+     * Fills @p lon and @p lat with @p count points spread over the whole sphere
+     */
+    static void createPoints( QVector<qreal> &lon, QVector<qreal> &lat, int count );
 };
 
 void QuaternionTest::testEuler_data()
@@ -170,6 +191,190 @@ void QuaternionTest::testSpherical()
 
 }
 
+void QuaternionTest::createPoints( QVector<qreal> &lon, QVector<qreal> &lat, int count )
+{
+    lon.resize( count );
+    lat.resize( count );
+    for ( int i = 0; i < count; ++i ) {
+        // a spiral from pole to pole
+        lon[i] = fmod( i * 2.39996, 2 * M_PI ) - M_PI;
+        lat[i] = asin( -1.0 + ( 2.0 * i + 1.0 ) / count );
+    }
+}
+
+void QuaternionTest::testSinCos_data()
+{
+    QTest::addColumn<MathPrecision>( "precision" );
+    QTest::addColumn<qreal>( "tolerance" );
+
+    QTest::newRow( "exact" ) << ExactPrecision << 0.0;
+    QTest::newRow( "high" ) << HighPrecision << 1e-8;
+    QTest::newRow( "low" ) << LowPrecision << 1e-4;
+}
+
+void QuaternionTest::testSinCos()
+{
+    QFETCH( MathPrecision, precision );
+    QFETCH( qreal, tolerance );
+
+    qreal maxError = 0.0;
+    for ( int i = -100000; i <= 100000; ++i ) {
+        const qreal angle = i * 4 * M_PI / 100000;
+        qreal sine, cosine;
+        fastSinCos( angle, sine, cosine, precision );
+        maxError = qMax( maxError, qAbs( sine - sin( angle ) ) );
+        maxError = qMax( maxError, qAbs( cosine - cos( angle ) ) );
+    }
+
+    QVERIFY( maxError <= tolerance );
+}
+
+void QuaternionTest::testAtan2_data()
+{
+    testSinCos_data();
+}
+
+void QuaternionTest::testAtan2()
+{
+    QFETCH( MathPrecision, precision );
+    QFETCH( qreal, tolerance );
+
+    QCOMPARE( fastAtan2( 0.0, 0.0, precision ), 0.0 );
+    QCOMPARE( fastAtan2( 0.0, 1.0, precision ), 0.0 );
+    QFUZZYCOMPARE( fastAtan2( 1.0, 0.0, precision ), M_PI / 2, tolerance + 1e-15 );
+    QFUZZYCOMPARE( fastAtan2( -1.0, 0.0, precision ), -M_PI / 2, tolerance + 1e-15 );
+    QFUZZYCOMPARE( fastAtan2( 0.0, -1.0, precision ), M_PI, tolerance + 1e-15 );
+
+    qreal maxError = 0.0;
+    for ( int i = 0; i < 100000; ++i ) {
+        const qreal angle = -M_PI + i * 2 * M_PI / 100000;
+        const qreal radius = 0.001 + i % 7;
+        const qreal y = radius * sin( angle );
+        const qreal x = radius * cos( angle );
+        maxError = qMax( maxError, qAbs( fastAtan2( y, x, precision ) - atan2( y, x ) ) );
+    }
+
+    QVERIFY( maxError <= tolerance );
+}
+
+void QuaternionTest::testBatchedSpherical_data()
+{
+    testSinCos_data();
+}
+
+void QuaternionTest::testBatchedSpherical()
+{
+    QFETCH( MathPrecision, precision );
+    QFETCH( qreal, tolerance );
+
+    const int count = 10000;
+    QVector<qreal> lon, lat;
+    createPoints( lon, lat, count );
+
+    QVector<qreal> x( count ), y( count ), z( count );
+    Quaternion::fromSpherical( lon.constData(), lat.constData(), x.data(), y.data(), z.data(), count, precision );
+
+    for ( int i = 0; i < count; ++i ) {
+        const Quaternion expected = Quaternion::fromSpherical( lon[i], lat[i] );
+        QFUZZYCOMPARE( x[i], expected.v[Q_X], 2 * tolerance + 1e-15 );
+        QFUZZYCOMPARE( y[i], expected.v[Q_Y], 2 * tolerance + 1e-15 );
+        QFUZZYCOMPARE( z[i], expected.v[Q_Z], 2 * tolerance + 1e-15 );
+    }
+
+    // the batched version doesn't require normalized vectors
+    for ( int i = 0; i < count; ++i ) {
+        x[i] *= 3.0;
+        y[i] *= 3.0;
+        z[i] *= 3.0;
+    }
+
+    QVector<qreal> resultLon( count ), resultLat( count );
+    Quaternion::getSpherical( x.constData(), y.constData(), z.constData(), resultLon.data(), resultLat.data(), count, precision );
+
+    for ( int i = 0; i < count; ++i ) {
+        QFUZZYCOMPARE( resultLat[i], lat[i], 5 * tolerance + 1e-12 );
+
+        // the longitude of points next to the poles is not well-defined
+        if ( qAbs( lat[i] ) < 89 * DEG2RAD ) {
+            qreal lonDiff = resultLon[i] - lon[i];
+            if ( lonDiff > M_PI ) {
+                lonDiff -= 2 * M_PI;
+            } else if ( lonDiff < -M_PI ) {
+                lonDiff += 2 * M_PI;
+            }
+            QFUZZYCOMPARE( lonDiff, 0.0, ( 5 * tolerance + 1e-12 ) / cos( lat[i] ) );
+        }
+    }
+}
+
+void QuaternionTest::testBatchedRotation()
+{
+    const int count = 1000;
+    QVector<qreal> lon, lat;
+    createPoints( lon, lat, count );
+
+    QVector<qreal> x( count ), y( count ), z( count );
+    Quaternion::fromSpherical( lon.constData(), lat.constData(), x.data(), y.data(), z.data(), count );
+
+    matrix m;
+    Quaternion::fromEuler( 10 * DEG2RAD, 20 * DEG2RAD, 30 * DEG2RAD ).inverse().toMatrix( m );
+
+    // rotate in place
+    Quaternion::rotateAroundAxis( m, x.constData(), y.constData(), z.constData(), x.data(), y.data(), z.data(), count );
+
+    for ( int i = 0; i < count; ++i ) {
+        Quaternion expected = Quaternion::fromSpherical( lon[i], lat[i] );
+        expected.rotateAroundAxis( m );
+        QFUZZYCOMPARE( x[i], expected.v[Q_X], 1e-15 );
+        QFUZZYCOMPARE( y[i], expected.v[Q_Y], 1e-15 );
+        QFUZZYCOMPARE( z[i], expected.v[Q_Z], 1e-15 );
+    }
+}
+
+void QuaternionTest::rotateBenchmark_data()
+{
+    QTest::addColumn<bool>( "batched" );
+    QTest::addColumn<MathPrecision>( "precision" );
+
+    QTest::newRow( "scalar" ) << false << ExactPrecision;
+    QTest::newRow( "batched, exact" ) << true << ExactPrecision;
+    QTest::newRow( "batched, high precision" ) << true << HighPrecision;
+    QTest::newRow( "batched, low precision" ) << true << LowPrecision;
+}
+
+void QuaternionTest::rotateBenchmark()
+{
+    QFETCH( bool, batched );
+    QFETCH( MathPrecision, precision );
+
+    const int count = 100000;
+    QVector<qreal> lon, lat;
+    createPoints( lon, lat, count );
+
+    matrix m;
+    Quaternion::fromEuler( 10 * DEG2RAD, 20 * DEG2RAD, 30 * DEG2RAD ).inverse().toMatrix( m );
+
+    QVector<qreal> x( count ), y( count ), z( count );
+    QVector<qreal> resultLon( count ), resultLat( count );
+
+    // spherical coordinates -> rotation -> spherical coordinates, as done when projecting
+    QBENCHMARK {
+        if ( batched ) {
+            Quaternion::fromSpherical( lon.constData(), lat.constData(), x.data(), y.data(), z.data(), count, precision );
+            Quaternion::rotateAroundAxis( m, x.constData(), y.constData(), z.constData(), x.data(), y.data(), z.data(), count );
+            Quaternion::getSpherical( x.constData(), y.constData(), z.constData(), resultLon.data(), resultLat.data(), count, precision );
+        } else {
+            for ( int i = 0; i < count; ++i ) {
+                Quaternion qpos = Quaternion::fromSpherical( lon[i], lat[i] );
+                qpos.rotateAroundAxis( m );
+                qpos.getSpherical( resultLon[i], resultLat[i] );
+            }
+        }
+    }
+}
+
+}
+
 QTEST_MAIN( Marble::QuaternionTest )
 
 #include "QuaternionTest.moc"
@@ -36,6 +36,7 @@ private slots:
     void removeAfterTest();
     void extendedDataParseTest();
     void withoutTimeTest();
+    void addPointTest();
 };
 
 void TestGeoDataTrack::initTestCase()
@@ -319,6 +320,37 @@ void TestGeoDataTrack::withoutTimeTest()
     delete dataDocument;
 }
 
+void TestGeoDataTrack::addPointTest()
+{
+    const QDateTime start( QDate( 2010, 5, 28 ), QTime( 2, 2, 9 ), Qt::UTC );
+
+    GeoDataTrack track;
+    for ( int i = 0; i < 5; ++i ) {
+        track.addPoint( start.addSecs( 2 * i ), GeoDataCoordinates( i, 0.0, 0.0, GeoDataCoordinates::Degree ) );
+        // extended, not rebuilt
+        QCOMPARE( track.lineString()->size(), i + 1 );
+    }
+    QCOMPARE( track.lineString()->last().longitude( GeoDataCoordinates::Degree ), 4.0 );
+
+    // out of order
+    track.addPoint( start.addSecs( 3 ), GeoDataCoordinates( 1.5, 0.0, 0.0, GeoDataCoordinates::Degree ) );
+    QCOMPARE( track.size(), 6 );
+    QCOMPARE( track.whenList().at( 2 ), start.addSecs( 3 ) );
+    QCOMPARE( track.lineString()->size(), 6 );
+    QCOMPARE( track.lineString()->at( 2 ).longitude( GeoDataCoordinates::Degree ), 1.5 );
+
+    track.removeLast();
+    QCOMPARE( track.size(), 5 );
+    QCOMPARE( track.lastWhen(), start.addSecs( 6 ) );
+    QCOMPARE( track.lineString()->size(), 5 );
+    QCOMPARE( track.lineString()->last().longitude( GeoDataCoordinates::Degree ), 3.0 );
+
+    track.removeBefore( start.addSecs( 3 ) );
+    QCOMPARE( track.size(), 3 );
+    QCOMPARE( track.lineString()->size(), 3 );
+    QCOMPARE( track.lineString()->at( 0 ).longitude( GeoDataCoordinates::Degree ), 1.5 );
+}
+
 QTEST_MAIN( TestGeoDataTrack )
 
 #include "TestGeoDataTrack.moc"
@@ -0,0 +1,234 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <QObject>
+#include <QtTest>
+
+#include "TestUtils.h"
+#include <GeoDataDocument.h>
+#include <GeoDataLineString.h>
+#include <GeoDataPlacemark.h>
+#include <GeoDataTrack.h>
+
+using namespace Marble;
+
+class TestKmlCoordinates : public QObject
+{
+    Q_OBJECT
+private slots:
+    void lineString_data();
+    void lineString();
+
+    void point_data();
+    void point();
+
+    void trackCoord_data();
+    void trackCoord();
+
+    void parseBenchmark_data();
+    void parseBenchmark();
+
+private:
+    static QString lineStringDocument( const QString &coordinates );
+
+    /**
+     * Compares @p coordinates with @p expected, a list of "lon lat alt" triples
+     * in degrees separated by semicolons.
+     */
+    static bool compare( const QVector<GeoDataCoordinates> &coordinates, const QString &expected );
+};
+
+QString TestKmlCoordinates::lineStringDocument( const QString &coordinates )
+{
+    return QString( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                    "<kml xmlns=\"http://www.opengis.net/kml/2.2\">"
+                    "<Document><Placemark><LineString>"
+                    "<coordinates>%1</coordinates>"
+                    "</LineString></Placemark></Document></kml>" ).arg( coordinates );
+}
+
+bool TestKmlCoordinates::compare( const QVector<GeoDataCoordinates> &coordinates, const QString &expected )
+{
+    const QStringList tuples = expected.split( ';', QString::SkipEmptyParts );
+    if ( tuples.size() != coordinates.size() ) {
+        qWarning() << "Expected" << tuples.size() << "coordinates, got" << coordinates.size();
+        return false;
+    }
+
+    for ( int i = 0; i < tuples.size(); ++i ) {
+        const QStringList values = tuples.at( i ).split( ' ' );
+        const GeoDataCoordinates &coordinate = coordinates.at( i );
+        if ( qAbs( coordinate.longitude( GeoDataCoordinates::Degree ) - values.at( 0 ).toDouble() ) > 1e-9
+             || qAbs( coordinate.latitude( GeoDataCoordinates::Degree ) - values.at( 1 ).toDouble() ) > 1e-9
+             || qAbs( coordinate.altitude() - values.at( 2 ).toDouble() ) > 1e-9 ) {
+            qWarning() << "Coordinate" << i << "is" << coordinate.toString( GeoDataCoordinates::Decimal, 10 )
+                       << coordinate.altitude() << "instead of" << tuples.at( i );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void TestKmlCoordinates::lineString_data()
+{
+    QTest::addColumn<QString>( "coordinates" );
+    QTest::addColumn<QString>( "expected" );
+
+    addNamedRow( "plain" ) << "1,2,3 4,5,6" << "1 2 3;4 5 6";
+    addNamedRow( "no altitude" ) << "1,2 4,5" << "1 2 0;4 5 0";
+    addNamedRow( "mixed altitude" ) << "1,2 4,5,6" << "1 2 0;4 5 6";
+    addNamedRow( "single tuple" ) << "1,2,3" << "1 2 3";
+    addNamedRow( "empty" ) << "" << "";
+    addNamedRow( "whitespace only" ) << " \n\t " << "";
+    addNamedRow( "surrounding whitespace" ) << "\n   1,2,3\n   4,5,6\n  " << "1 2 3;4 5 6";
+    addNamedRow( "tabs and newlines" ) << "1,2,3\t4,5,6\r\n7,8,9" << "1 2 3;4 5 6;7 8 9";
+    addNamedRow( "repeated whitespace" ) << "1,2,3     4,5,6" << "1 2 3;4 5 6";
+    addNamedRow( "space before comma" ) << "1 ,2 ,3 4 ,5 ,6" << "1 2 3;4 5 6";
+    addNamedRow( "space after comma" ) << "1, 2, 3 4, 5, 6" << "1 2 3;4 5 6";
+    addNamedRow( "space around comma" ) << "1 , 2 , 3 4 , 5 , 6" << "1 2 3;4 5 6";
+    addNamedRow( "newline after comma" ) << "1,\n2,\n3 4,5,6" << "1 2 3;4 5 6";
+    addNamedRow( "too many values" ) << "1,2,3,4 5,6" << "0 0 0;5 6 0";
+    addNamedRow( "single value" ) << "1 5,6" << "0 0 0;5 6 0";
+    addNamedRow( "empty value" ) << ",2,3 5,6" << "0 2 3;5 6 0";
+    addNamedRow( "negative" ) << "-1.5,-2.25,-3" << "-1.5 -2.25 -3";
+    addNamedRow( "explicit plus" ) << "+1.5,+2.25,+3" << "1.5 2.25 3";
+    addNamedRow( "leading decimal point" ) << ".5,-.25" << "0.5 -0.25 0";
+    addNamedRow( "trailing decimal point" ) << "1.,2." << "1 2 0";
+    addNamedRow( "exponent" ) << "1e1,2.5E-1,1e+3" << "10 0.25 1000";
+    addNamedRow( "high precision" ) << "13.405012345678,52.520006612345,34.5"
+                                    << "13.405012345678 52.520006612345 34.5";
+    addNamedRow( "many digits" ) << "13.40501234567890123456789,52.52000661234567890123,0"
+                                 << "13.40501234567890123456789 52.52000661234567890123 0";
+    addNamedRow( "leading zeros" ) << "0001.500,0000.00025" << "1.5 0.00025 0";
+    addNamedRow( "zero" ) << "0,0.0,-0" << "0 0 0";
+    addNamedRow( "invalid number" ) << "abc,2 5,6" << "0 2 0;5 6 0";
+    addNamedRow( "malformed exponent" ) << "1e,2" << "0 2 0";
+}
+
+void TestKmlCoordinates::lineString()
+{
+    QFETCH( QString, coordinates );
+    QFETCH( QString, expected );
+
+    GeoDataDocument *document = parseKml( lineStringDocument( coordinates ) );
+    QCOMPARE( document->placemarkList().size(), 1 );
+
+    const GeoDataLineString *lineString = dynamic_cast<GeoDataLineString*>( document->placemarkList().first()->geometry() );
+    QVERIFY( lineString != 0 );
+
+    QVector<GeoDataCoordinates> result;
+    foreach( const GeoDataCoordinates &coordinate, *lineString ) {
+        result << coordinate;
+    }
+    QVERIFY( compare( result, expected ) );
+
+    delete document;
+}
+
+void TestKmlCoordinates::point_data()
+{
+    QTest::addColumn<QString>( "coordinates" );
+    QTest::addColumn<QString>( "expected" );
+
+    addNamedRow( "plain" ) << "13.4,52.5,34" << "13.4 52.5 34";
+    addNamedRow( "no altitude" ) << "13.4,52.5" << "13.4 52.5 0";
+    addNamedRow( "space around comma" ) << "\n  13.4 , 52.5 , 34\n" << "13.4 52.5 34";
+}
+
+void TestKmlCoordinates::point()
+{
+    QFETCH( QString, coordinates );
+    QFETCH( QString, expected );
+
+    const QString content = QString( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                                     "<kml xmlns=\"http://www.opengis.net/kml/2.2\">"
+                                     "<Document><Placemark><Point>"
+                                     "<coordinates>%1</coordinates>"
+                                     "</Point></Placemark></Document></kml>" ).arg( coordinates );
+
+    GeoDataDocument *document = parseKml( content );
+    QCOMPARE( document->placemarkList().size(), 1 );
+
+    QVector<GeoDataCoordinates> result;
+    result << document->placemarkList().first()->coordinate();
+    QVERIFY( compare( result, expected ) );
+
+    delete document;
+}
+
+void TestKmlCoordinates::trackCoord_data()
+{
+    QTest::addColumn<QString>( "coordinates" );
+    QTest::addColumn<QString>( "expected" );
+
+    addNamedRow( "plain" ) << "13.4 52.5 34" << "13.4 52.5 34";
+    addNamedRow( "no altitude" ) << "13.4 52.5" << "13.4 52.5 0";
+    addNamedRow( "repeated whitespace" ) << "  13.4\t52.5\n 34 " << "13.4 52.5 34";
+    addNamedRow( "too many values" ) << "13.4 52.5 34 1" << "0 0 0";
+}
+
+void TestKmlCoordinates::trackCoord()
+{
+    QFETCH( QString, coordinates );
+    QFETCH( QString, expected );
+
+    const QString content = QString( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                                     "<kml xmlns=\"http://www.opengis.net/kml/2.2\" xmlns:gx=\"http://www.google.com/kml/ext/2.2\">"
+                                     "<Document><Placemark><gx:Track>"
+                                     "<gx:coord>%1</gx:coord>"
+                                     "</gx:Track></Placemark></Document></kml>" ).arg( coordinates );
+
+    GeoDataDocument *document = parseKml( content );
+    QCOMPARE( document->placemarkList().size(), 1 );
+
+    const GeoDataTrack *track = dynamic_cast<GeoDataTrack*>( document->placemarkList().first()->geometry() );
+    QVERIFY( track != 0 );
+    QCOMPARE( track->size(), 1 );
+
+    QVector<GeoDataCoordinates> result;
+    result << track->coordinatesList().first();
+    QVERIFY( compare( result, expected ) );
+
+    delete document;
+}
+
+void TestKmlCoordinates::parseBenchmark_data()
+{
+    QTest::addColumn<int>( "count" );
+
+    QTest::newRow( "10000 vertices" ) << 10000;
+    QTest::newRow( "1000000 vertices" ) << 1000000;
+}
+
+void TestKmlCoordinates::parseBenchmark()
+{
+    QFETCH( int, count );
+
+    QString coordinates;
+    coordinates.reserve( count * 32 );
+    for ( int i = 0; i < count; ++i ) {
+        const qreal lon = -180.0 + 360.0 * i / count;
+        const qreal lat = 60.0 * qSin( i * 0.001 );
+        coordinates += QString::number( lon, 'f', 7 ) + ',' + QString::number( lat, 'f', 7 ) + ",0\n";
+    }
+
+    const QString content = lineStringDocument( coordinates );
+
+    QBENCHMARK {
+        GeoDataDocument *document = parseKml( content );
+        QCOMPARE( document->placemarkList().size(), 1 );
+        delete document;
+    }
+}
+
+QTEST_MAIN( TestKmlCoordinates )
+
+#include "TestKmlCoordinates.moc"
@@ -16,6 +16,10 @@
 #include "GeoDataCoordinates.h"
 #include "GeoDataLatLonAltBox.h"
 
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QtTest>
 
 namespace QTest
@@ -89,6 +93,34 @@ GeoDataDocument *parseKml(const QString &content)
     return static_cast<GeoDataDocument*>( document );
 }
 
+/**
+ * Removes the directory @p path with all its contents
+ */
+void removeDirectory( const QString &path )
+{
+    QDir directory( path );
+    foreach( const QFileInfo &info, directory.entryInfoList( QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden ) ) {
+        if ( info.isDir() ) {
+            removeDirectory( info.absoluteFilePath() );
+        } else {
+            QFile::remove( info.absoluteFilePath() );
+        }
+    }
+    directory.rmdir( path );
+}
+
+/**
+ * Points XDG_DATA_HOME to a temporary directory named after @p name and the process,
+ * so tests never touch the data of the user. Returns the directory, remove it with
+ * removeDirectory() when the test is done.
+ */
+QString setTemporaryDataPath( const QString &name )
+{
+    const QString path = QString( "%1/marble-%2-%3" ).arg( QDir::tempPath() ).arg( name ).arg( QCoreApplication::applicationPid() );
+    qputenv( "XDG_DATA_HOME", QFile::encodeName( path ) );
+    return path;
+}
+
 }
 
 #endif
@@ -0,0 +1,219 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "TraceRecorder.h"
+
+#include "TestUtils.h"
+
+#include <QBuffer>
+#include <QThread>
+#include <QtTest>
+
+namespace Marble
+{
+
+class TracingThread : public QThread
+{
+ public:
+    void run()
+    {
+        TraceZone zone( "TracingThread::run" );
+    }
+};
+
+class TraceRecorderTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void disabled();
+    void nestedZones();
+    void percentiles();
+    void ringBuffer();
+    void threads();
+    void chromeTrace();
+
+ private:
+    static const TraceRecorder::ZoneSummary *find( const QList<TraceRecorder::ZoneSummary> &summaries, const QString &name );
+
+    static const qint64 millisecond = 1000000;
+};
+
+const TraceRecorder::ZoneSummary *TraceRecorderTest::find( const QList<TraceRecorder::ZoneSummary> &summaries, const QString &name )
+{
+    foreach ( const TraceRecorder::ZoneSummary &summary, summaries ) {
+        if ( summary.name == name ) {
+            return &summary;
+        }
+    }
+
+    return 0;
+}
+
+void TraceRecorderTest::init()
+{
+    TraceRecorder::setBufferSize( 65536 );
+    TraceRecorder::clear();
+    TraceRecorder::setEnabled( true );
+}
+
+void TraceRecorderTest::cleanup()
+{
+    TraceRecorder::setEnabled( false );
+}
+
+void TraceRecorderTest::disabled()
+{
+    TraceRecorder::setEnabled( false );
+    QVERIFY( !TraceRecorder::isEnabled() );
+
+    {
+        TraceZone zone( "disabled" );
+    }
+    TraceRecorder::addEvent( "disabled", 0, millisecond );
+
+    QVERIFY( TraceRecorder::summaries().isEmpty() );
+}
+
+void TraceRecorderTest::nestedZones()
+{
+    {
+        TraceZone outer( "outer" );
+        for ( int i = 0; i < 3; ++i ) {
+            TraceZone inner( "inner" );
+            QTest::qSleep( 2 );
+        }
+    }
+
+    const QList<TraceRecorder::ZoneSummary> summaries = TraceRecorder::summaries();
+    QCOMPARE( summaries.size(), 2 );
+
+    // the enclosing zone is the most expensive one
+    QCOMPARE( summaries.at( 0 ).name, QString( "outer" ) );
+    QCOMPARE( summaries.at( 0 ).count, 1 );
+    QCOMPARE( summaries.at( 1 ).name, QString( "inner" ) );
+    QCOMPARE( summaries.at( 1 ).count, 3 );
+    QVERIFY( summaries.at( 1 ).total >= 6.0 );
+    QVERIFY( summaries.at( 0 ).total >= summaries.at( 1 ).total );
+}
+
+void TraceRecorderTest::percentiles()
+{
+    // durations of 1 to 100 milliseconds, recorded out of order
+    for ( int i = 100; i > 0; --i ) {
+        TraceRecorder::addEvent( "zone", 0, i * millisecond );
+    }
+
+    const QList<TraceRecorder::ZoneSummary> summaries = TraceRecorder::summaries();
+    QCOMPARE( summaries.size(), 1 );
+
+    const TraceRecorder::ZoneSummary summary = summaries.first();
+    QCOMPARE( summary.count, 100 );
+    QFUZZYCOMPARE( summary.total, 5050.0, 0.001 );
+    QFUZZYCOMPARE( summary.median, 50.0, 0.001 );
+    QFUZZYCOMPARE( summary.percentile90, 90.0, 0.001 );
+    QFUZZYCOMPARE( summary.percentile99, 99.0, 0.001 );
+    QFUZZYCOMPARE( summary.maximum, 100.0, 0.001 );
+
+    QVERIFY( TraceRecorder::summaryText().contains( "zone" ) );
+}
+
+void TraceRecorderTest::ringBuffer()
+{
+    TraceRecorder::setBufferSize( 10 );
+    TraceRecorder::clear();
+
+    for ( int i = 1; i <= 25; ++i ) {
+        TraceRecorder::addEvent( "zone", 0, i * millisecond );
+    }
+
+    // only the most recent events are kept
+    const QList<TraceRecorder::ZoneSummary> summaries = TraceRecorder::summaries();
+    QCOMPARE( summaries.size(), 1 );
+    QCOMPARE( summaries.first().count, 10 );
+    QFUZZYCOMPARE( summaries.first().median, 20.0, 0.001 );
+    QFUZZYCOMPARE( summaries.first().maximum, 25.0, 0.001 );
+
+    TraceRecorder::clear();
+    QVERIFY( TraceRecorder::summaries().isEmpty() );
+}
+
+void TraceRecorderTest::threads()
+{
+    TracingThread first;
+    first.setObjectName( "First Thread" );
+    first.start();
+    first.wait();
+
+    // the buffer of the finished thread is reused
+    TracingThread second;
+    second.start();
+    second.wait();
+
+    TraceRecorder::addEvent( "download", 0, millisecond, "Downloads" );
+
+    const QList<TraceRecorder::ZoneSummary> summaries = TraceRecorder::summaries();
+    QCOMPARE( summaries.size(), 2 );
+    const TraceRecorder::ZoneSummary *const run = find( summaries, "TracingThread::run" );
+    QVERIFY( run != 0 );
+    QCOMPARE( run->count, 2 );
+    QVERIFY( find( summaries, "download" ) != 0 );
+
+    QBuffer buffer;
+    buffer.open( QIODevice::WriteOnly );
+    QVERIFY( TraceRecorder::writeChromeTrace( &buffer ) );
+    QVERIFY( buffer.data().contains( "\"Downloads\"" ) );
+
+    // the event of the finished thread keeps its name, the reused buffer gets a new one
+    QByteArray firstThread;
+    QList<QByteArray> runThreads;
+    foreach ( const QByteArray &line, buffer.data().split( '\n' ) ) {
+        QByteArray tid = line.mid( line.indexOf( "\"tid\":" ) + 6 );
+        tid = tid.left( tid.indexOf( '}' ) );
+        if ( line.contains( "\"First Thread\"" ) ) {
+            firstThread = tid;
+        } else if ( line.contains( "\"TracingThread::run\"" ) ) {
+            runThreads << tid;
+        }
+    }
+    QVERIFY( !firstThread.isEmpty() );
+    QCOMPARE( runThreads.size(), 2 );
+    QCOMPARE( runThreads.count( firstThread ), 1 );
+}
+
+void TraceRecorderTest::chromeTrace()
+{
+    const char *const name = TraceRecorder::internName( QString( "Plugin \"%1\"" ).arg( "quoted" ) );
+    QVERIFY( TraceRecorder::internName( "Plugin \"quoted\"" ) == name );
+    TraceRecorder::addEvent( name, 1500, 2 * millisecond + 1500 );
+
+    QBuffer buffer;
+    buffer.open( QIODevice::WriteOnly );
+    QVERIFY( TraceRecorder::writeChromeTrace( &buffer ) );
+
+    const QByteArray json = buffer.data();
+    QVERIFY( json.startsWith( "{\"traceEvents\":[" ) );
+    QVERIFY( json.trimmed().endsWith( '}' ) );
+    QVERIFY( json.contains( "\"name\":\"Plugin \\\"quoted\\\"\"" ) );
+    QVERIFY( json.contains( "\"ph\":\"X\"" ) );
+    // microseconds
+    QVERIFY( json.contains( "\"ts\":1.500" ) );
+    QVERIFY( json.contains( "\"dur\":2000.000" ) );
+    QVERIFY( json.contains( "\"thread_name\"" ) );
+}
+
+}
+
+QTEST_MAIN( Marble::TraceRecorderTest )
+
+#include "TraceRecorderTest.moc"
@@ -0,0 +1,235 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include <QFileInfo>
+#include <QImage>
+#include <QtTest>
+
+#include "GeoPainter.h"
+#include "GeoPolygon.h"
+#include "MarbleDirs.h"
+#include "VectorMap.h"
+#include "ViewportParams.h"
+
+Q_DECLARE_METATYPE( Marble::Projection )
+
+namespace Marble
+{
+
+class VectorMapTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void decodeOnDemand();
+
+    void reusePolygons_data();
+    void reusePolygons();
+
+    void createBenchmark_data();
+    void createBenchmark();
+
+ private:
+    /**
+     * Loads the PNT file @p name from the mwdbii data directory
+     */
+    PntMap *load( const QString &name );
+
+    static QImage paint( VectorMap &vectorMap, const PntMap *pntMap, const ViewportParams &viewport );
+
+    /**
+     * Returns the number of nodes of all polygons of @p pntMap, decoding all of them
+     */
+    static int vertexCount( const PntMap *pntMap );
+
+    QMap<QString, PntMap*> m_maps;
+};
+
+void VectorMapTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    // coast lines are used by the texture colorization of the atlas theme,
+    // the plain theme draws all of them
+    QStringList const files = QStringList() << "PCOAST" << "PISLAND" << "PLAKE" << "PGLACIER"
+                                            << "RIVER" << "PDIFFBORDER" << "PUSA48.DIFF";
+    foreach( const QString &file, files ) {
+        m_maps[file] = load( file );
+        QVERIFY( m_maps[file] );
+        QVERIFY( m_maps[file]->size() > 0 );
+    }
+}
+
+void VectorMapTest::cleanupTestCase()
+{
+    qDeleteAll( m_maps );
+    m_maps.clear();
+}
+
+PntMap *VectorMapTest::load( const QString &name )
+{
+    PntMap *pntMap = new PntMap;
+    pntMap->load( MarbleDirs::path( "mwdbii/" + name + ".PNT" ) );
+
+    // the data is loaded in a separate thread
+    for ( int i = 0; i < 500 && !pntMap->isInitialized(); ++i ) {
+        QTest::qWait( 20 );
+    }
+
+    if ( !pntMap->isInitialized() ) {
+        delete pntMap;
+        return 0;
+    }
+
+    return pntMap;
+}
+
+QImage VectorMapTest::paint( VectorMap &vectorMap, const PntMap *pntMap, const ViewportParams &viewport )
+{
+    QImage image( viewport.size(), QImage::Format_ARGB32_Premultiplied );
+    image.fill( Qt::transparent );
+
+    GeoPainter painter( &image, &viewport, NormalQuality );
+    painter.setPen( Qt::NoPen );
+    painter.setBrush( Qt::black );
+
+    vectorMap.setzBoundingBoxLimit( 0.4 );
+    vectorMap.setzPointLimit( 0 );
+    vectorMap.createFromPntMap( pntMap, &viewport );
+    vectorMap.paintMap( &painter );
+
+    return image;
+}
+
+int VectorMapTest::vertexCount( const PntMap *pntMap )
+{
+    int result = 0;
+    foreach( const GeoPolygon *polygon, *pntMap ) {
+        polygon->decode();
+        result += polygon->size();
+    }
+
+    return result;
+}
+
+void VectorMapTest::decodeOnDemand()
+{
+    PntMap *coast = load( "PCOAST" );
+    QVERIFY( coast );
+
+    // the polygons are only indexed when loading
+    foreach( const GeoPolygon *polygon, *coast ) {
+        QCOMPARE( polygon->size(), 0 );
+        QCOMPARE( polygon->getBoundary().size(), 5 );
+    }
+
+    VectorMap vectorMap;
+    const ViewportParams europe( Spherical, 10 * DEG2RAD, 50 * DEG2RAD, 1200, QSize( 400, 300 ) );
+    paint( vectorMap, coast, europe );
+
+    int decodedCount = 0;
+    foreach( const GeoPolygon *polygon, *coast ) {
+        if ( polygon->size() > 0 ) {
+            ++decodedCount;
+        }
+    }
+    QVERIFY( decodedCount > 0 );
+    QVERIFY( decodedCount < coast->size() );
+
+    // each record of six bytes in the file is a node
+    const QFileInfo file( MarbleDirs::path( "mwdbii/PCOAST.PNT" ) );
+    QCOMPARE( qint64( vertexCount( coast ) ), file.size() / 6 );
+
+    delete coast;
+}
+
+void VectorMapTest::reusePolygons_data()
+{
+    QTest::addColumn<Projection>( "projection" );
+
+    QTest::newRow( "spherical" ) << Spherical;
+    QTest::newRow( "equirectangular" ) << Equirectangular;
+    QTest::newRow( "mercator" ) << Mercator;
+}
+
+void VectorMapTest::reusePolygons()
+{
+    QFETCH( Projection, projection );
+
+    const PntMap *coast = m_maps["PCOAST"];
+    const PntMap *islands = m_maps["PISLAND"];
+
+    ViewportParams europe( projection, 10 * DEG2RAD, 50 * DEG2RAD, 300, QSize( 400, 300 ) );
+    ViewportParams pacific( projection, -160 * DEG2RAD, -10 * DEG2RAD, 1200, QSize( 400, 300 ) );
+
+    VectorMap reference;
+    const QImage expected = paint( reference, coast, europe );
+    QImage empty( expected.size(), expected.format() );
+    empty.fill( Qt::transparent );
+    QVERIFY( expected != empty );
+
+    // polygons kept from other frames and maps must not show up
+    VectorMap vectorMap;
+    paint( vectorMap, islands, pacific );
+    paint( vectorMap, coast, pacific );
+    QCOMPARE( paint( vectorMap, coast, europe ), expected );
+    QCOMPARE( paint( vectorMap, coast, europe ), expected );
+}
+
+void VectorMapTest::createBenchmark_data()
+{
+    QTest::addColumn<QString>( "theme" );
+    QTest::addColumn<Projection>( "projection" );
+    QTest::addColumn<int>( "radius" );
+
+    foreach( const QString &theme, QStringList() << "atlas" << "plain" ) {
+        foreach( int radius, QList<int>() << 250 << 10000 ) {
+            QTest::newRow( QString( "%1, spherical, radius %2" ).arg( theme ).arg( radius ).toLatin1() )
+                    << theme << Spherical << radius;
+        }
+        QTest::newRow( QString( "%1, mercator, radius 1000" ).arg( theme ).toLatin1() )
+                << theme << Mercator << 1000;
+    }
+}
+
+void VectorMapTest::createBenchmark()
+{
+    QFETCH( QString, theme );
+    QFETCH( Projection, projection );
+    QFETCH( int, radius );
+
+    QList<const PntMap*> pntMaps;
+    pntMaps << m_maps["PCOAST"] << m_maps["PISLAND"];
+    if ( theme == "plain" ) {
+        pntMaps << m_maps["PLAKE"] << m_maps["PGLACIER"] << m_maps["RIVER"]
+                << m_maps["PDIFFBORDER"] << m_maps["PUSA48.DIFF"];
+    }
+
+    const ViewportParams viewport( projection, 10 * DEG2RAD, 50 * DEG2RAD, radius, QSize( 1024, 768 ) );
+    VectorMap vectorMap;
+    vectorMap.setzBoundingBoxLimit( 0.4 );
+    vectorMap.setzPointLimit( 0 );
+
+    QBENCHMARK {
+        foreach( const PntMap *pntMap, pntMaps ) {
+            vectorMap.createFromPntMap( pntMap, &viewport );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::VectorMapTest )
+
+#include "VectorMapTest.moc"
@@ -0,0 +1,35 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "LineReader.h"
+
+#include <QTextStream>
+
+#include <cstdio>
+
+LineReader::LineReader( QObject *parent ) :
+    QThread( parent )
+{
+    // nothing to do
+}
+
+void LineReader::run()
+{
+    QTextStream input( stdin );
+    QString line = input.readLine();
+    for ( ; !line.isNull(); line = input.readLine() ) {
+        line = line.trimmed();
+        if ( !line.isEmpty() && !line.startsWith( '#' ) ) {
+            emit lineRead( line );
+        }
+    }
+}
+
+#include "LineReader.moc"
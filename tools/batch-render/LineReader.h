@@ -0,0 +1,34 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef LINEREADER_H
+#define LINEREADER_H
+
+#include <QThread>
+
+/**
+  * Reads stdin line by line in a background thread so that the event loop of
+  * the main thread keeps running while waiting for input.
+  */
+class LineReader : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit LineReader( QObject *parent = 0 );
+
+Q_SIGNALS:
+    void lineRead( const QString &line );
+
+protected:
+    virtual void run();
+};
+
+#endif // LINEREADER_H
@@ -0,0 +1,185 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "RenderDispatcher.h"
+
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QThread>
+
+#include <cstdio>
+
+RenderDispatcher::RenderDispatcher( QObject *parent ) :
+    QObject( parent ),
+    m_workerCount( QThread::idealThreadCount() ),
+    m_inputFinished( false ),
+    m_failures( 0 )
+{
+    // nothing to do
+}
+
+void RenderDispatcher::setWorkerCount( int count )
+{
+    m_workerCount = qMax( 1, count );
+}
+
+void RenderDispatcher::setWorkerArguments( const QStringList &arguments )
+{
+    m_workerArguments = arguments;
+}
+
+void RenderDispatcher::start()
+{
+    m_runTime.start();
+    for ( int i = 0; i < m_workerCount; ++i ) {
+        Worker worker;
+        worker.process = new QProcess( this );
+        worker.process->setProcessChannelMode( QProcess::ForwardedErrorChannel );
+        connect( worker.process, SIGNAL(readyReadStandardOutput()), this, SLOT(readResults()) );
+        connect( worker.process, SIGNAL(finished(int,QProcess::ExitStatus)),
+                 this, SLOT(handleWorkerFinished()) );
+        worker.process->start( QCoreApplication::applicationFilePath(),
+                               QStringList() << "--worker" << m_workerArguments );
+        m_workers << worker;
+    }
+}
+
+void RenderDispatcher::addJob( const QString &line )
+{
+    RenderJob const job = RenderJob::fromLine( line );
+    // results are matched to jobs by their id
+    bool const duplicate = m_queuedSince.contains( job.id );
+    if ( !job.isValid() || duplicate ) {
+        RenderResult result;
+        result.id = job.id;
+        result.error = job.isValid() ? QString( "job id %1 is already queued" ).arg( job.id ) : job.errorString();
+        ++m_failures;
+        QTextStream( stdout ) << result.toLine() << endl;
+        return;
+    }
+
+    m_queue.enqueue( job.toLine() );
+    m_queuedSince[job.id].start();
+    dispatch();
+}
+
+void RenderDispatcher::finishInput()
+{
+    m_inputFinished = true;
+    dispatch();
+}
+
+void RenderDispatcher::readResults()
+{
+    for ( int i = 0; i < m_workers.size(); ++i ) {
+        Worker &worker = m_workers[i];
+        while ( worker.process->canReadLine() ) {
+            QString const line = QString::fromUtf8( worker.process->readLine() ).trimmed();
+            finishJob( worker, RenderResult::fromLine( line ) );
+        }
+    }
+
+    dispatch();
+}
+
+void RenderDispatcher::handleWorkerFinished()
+{
+    for ( int i = 0; i < m_workers.size(); ++i ) {
+        Worker &worker = m_workers[i];
+        if ( worker.process->state() == QProcess::NotRunning && !worker.jobId.isEmpty() ) {
+            RenderResult result;
+            result.id = worker.jobId;
+            result.error = "worker terminated";
+            finishJob( worker, result );
+        }
+    }
+
+    dispatch();
+}
+
+void RenderDispatcher::dispatch()
+{
+    bool busy = false;
+    int running = 0;
+    for ( int i = 0; i < m_workers.size(); ++i ) {
+        Worker &worker = m_workers[i];
+        if ( worker.process->state() == QProcess::NotRunning ) {
+            continue;
+        }
+        ++running;
+
+        if ( worker.jobId.isEmpty() && !m_queue.isEmpty() ) {
+            QString const line = m_queue.dequeue();
+            worker.jobId = RenderJob::fromLine( line ).id;
+            worker.started.start();
+            worker.process->write( line.toUtf8() + '\n' );
+        }
+
+        busy = busy || !worker.jobId.isEmpty();
+    }
+
+    if ( running == 0 && !m_workers.isEmpty() ) {
+        // All workers are gone, nobody is going to handle the remaining jobs
+        while ( !m_queue.isEmpty() ) {
+            RenderResult result;
+            result.id = RenderJob::fromLine( m_queue.dequeue() ).id;
+            result.error = "no worker available";
+            m_queuedSince.remove( result.id );
+            ++m_failures;
+            QTextStream( stdout ) << result.toLine() << endl;
+        }
+    }
+
+    if ( m_inputFinished && m_queue.isEmpty() && !busy ) {
+        printStatistics();
+        foreach( const Worker &worker, m_workers ) {
+            worker.process->closeWriteChannel();
+        }
+        QCoreApplication::exit( m_failures > 0 ? 1 : 0 );
+    }
+}
+
+void RenderDispatcher::finishJob( Worker &worker, const RenderResult &result )
+{
+    int const latency = m_queuedSince.take( result.id ).elapsed();
+    if ( result.success ) {
+        m_latencies << latency;
+    } else {
+        ++m_failures;
+    }
+
+    worker.jobId.clear();
+    QTextStream( stdout ) << result.toLine() << " latency=" << latency << endl;
+}
+
+void RenderDispatcher::printStatistics() const
+{
+    QList<int> latencies = m_latencies;
+    qSort( latencies );
+
+    QTextStream error( stderr );
+    error << "Rendered " << latencies.size() << " jobs (" << m_failures << " failed) with "
+          << m_workers.size() << " workers in " << m_runTime.elapsed() << " ms" << endl;
+    if ( latencies.isEmpty() ) {
+        return;
+    }
+
+    qint64 sum = 0;
+    foreach( int latency, latencies ) {
+        sum += latency;
+    }
+
+    error << "Latency (ms): mean " << sum / latencies.size()
+          << ", median " << latencies.at( latencies.size() / 2 )
+          << ", 95% " << latencies.at( qMin( latencies.size() - 1, latencies.size() * 95 / 100 ) )
+          << ", max " << latencies.last() << endl;
+}
+
+#include "RenderDispatcher.moc"
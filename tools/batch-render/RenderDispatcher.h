@@ -0,0 +1,80 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef RENDERDISPATCHER_H
+#define RENDERDISPATCHER_H
+
+#include "RenderJob.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QQueue>
+#include <QTime>
+
+/**
+  * Distributes render jobs read from stdin to a number of worker processes and
+  * writes their results to stdout in the order they finish.
+  *
+  * Each worker is a separate process running a RenderWorker, so that jobs are
+  * rendered on all cores while every worker keeps its own warm map. All workers
+  * share the on-disk tile cache. Rendering MarbleMap concurrently in threads of
+  * one process is not possible since several layers rely on QPixmap.
+  */
+class RenderDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RenderDispatcher( QObject *parent = 0 );
+
+    void setWorkerCount( int count );
+
+    void setWorkerArguments( const QStringList &arguments );
+
+    void start();
+
+public Q_SLOTS:
+    void addJob( const QString &line );
+
+    void finishInput();
+
+private Q_SLOTS:
+    void readResults();
+
+    void handleWorkerFinished();
+
+private:
+    struct Worker
+    {
+        QProcess* process;
+        QString jobId;
+        QTime started;
+    };
+
+    void dispatch();
+
+    void finishJob( Worker &worker, const RenderResult &result );
+
+    void printStatistics() const;
+
+    int m_workerCount;
+    QStringList m_workerArguments;
+    QList<Worker> m_workers;
+    QQueue<QString> m_queue;
+    QHash<QString, QTime> m_queuedSince;
+    bool m_inputFinished;
+    QList<int> m_latencies;
+    int m_failures;
+    QTime m_runTime;
+};
+
+#endif // RENDERDISPATCHER_H
@@ -0,0 +1,229 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "RenderJob.h"
+
+#include <QHash>
+#include <QRegExp>
+
+#include <cmath>
+
+namespace {
+
+/**
+ * Splits @p line into key=value pairs separated by whitespace. Values with whitespace
+ * are enclosed in double quotes, within which a backslash escapes the next character.
+ */
+QHash<QString, QString> parsePairs( const QString &line )
+{
+    QHash<QString, QString> result;
+    int i = 0;
+    while ( i < line.size() ) {
+        if ( line.at( i ).isSpace() ) {
+            ++i;
+            continue;
+        }
+
+        QString token;
+        bool quoted = false;
+        for ( ; i < line.size() && ( quoted || !line.at( i ).isSpace() ); ++i ) {
+            QChar const c = line.at( i );
+            if ( c == '"' ) {
+                quoted = !quoted;
+            } else if ( c == '\\' && quoted && i + 1 < line.size() ) {
+                token += line.at( ++i );
+            } else {
+                token += c;
+            }
+        }
+
+        int const separator = token.indexOf( '=' );
+        if ( separator > 0 ) {
+            result[token.left( separator ).toLower()] = token.mid( separator + 1 );
+        }
+    }
+    return result;
+}
+
+/** Returns the key=value pair, quoting the value if parsePairs() needs it to */
+QString pair( const QString &key, const QString &value )
+{
+    if ( !value.isEmpty() && !value.contains( QRegExp( "[\\s\"]" ) ) ) {
+        return key + '=' + value;
+    }
+
+    QString escaped = value;
+    escaped.replace( '\\', "\\\\" ).replace( '"', "\\\"" );
+    return key + "=\"" + escaped + '"';
+}
+
+QString projectionName( Marble::Projection projection )
+{
+    switch ( projection ) {
+    case Marble::Spherical:       return "spherical";
+    case Marble::Equirectangular: return "equirectangular";
+    case Marble::Mercator:        return "mercator";
+    }
+
+    return "spherical";
+}
+
+}
+
+RenderJob::RenderJob() :
+    projection( Marble::Spherical ),
+    longitude( 0.0 ),
+    latitude( 0.0 ),
+    radius( 0 ),
+    format( "png" ),
+    quality( -1 )
+{
+    // nothing to do
+}
+
+RenderJob RenderJob::fromLine( const QString &line )
+{
+    RenderJob job;
+    QHash<QString, QString> const pairs = parsePairs( line );
+
+    job.id = pairs.value( "id" );
+    job.mapTheme = pairs.value( "theme", "earth/bluemarble/bluemarble.dgml" );
+
+    QString const projection = pairs.value( "projection", "spherical" ).toLower();
+    if ( projection == "spherical" ) {
+        job.projection = Marble::Spherical;
+    } else if ( projection == "equirectangular" ) {
+        job.projection = Marble::Equirectangular;
+    } else if ( projection == "mercator" ) {
+        job.projection = Marble::Mercator;
+    } else {
+        job.m_error = QString( "unknown projection %1" ).arg( projection );
+    }
+
+    job.longitude = pairs.value( "lon", "0" ).toDouble();
+    job.latitude = pairs.value( "lat", "0" ).toDouble();
+    job.size = QSize( pairs.value( "width", "256" ).toInt(), pairs.value( "height", "256" ).toInt() );
+    if ( pairs.contains( "radius" ) ) {
+        job.radius = pairs.value( "radius" ).toInt();
+    } else if ( pairs.contains( "zoom" ) ) {
+        // Inverse of MarbleWidget's zoom = 200 * log( radius )
+        job.radius = qRound( exp( pairs.value( "zoom" ).toDouble() / 200.0 ) );
+    } else {
+        // the whole globe fits into the image
+        job.radius = qMin( job.size.width(), job.size.height() ) / 2;
+    }
+
+    job.output = pairs.value( "output" );
+    job.format = pairs.value( "format", QString() ).toLower();
+    if ( job.format.isEmpty() ) {
+        job.format = job.output.endsWith( ".jpg", Qt::CaseInsensitive )
+                  || job.output.endsWith( ".jpeg", Qt::CaseInsensitive ) ? "jpg" : "png";
+    }
+    job.quality = pairs.value( "quality", "-1" ).toInt();
+
+    if ( pairs.contains( "overlays" ) ) {
+        job.overlays = pairs.value( "overlays" ).split( ',', QString::SkipEmptyParts );
+    }
+    if ( pairs.contains( "plugins" ) ) {
+        job.plugins = pairs.value( "plugins" ).split( ',', QString::SkipEmptyParts );
+    }
+
+    return job;
+}
+
+QString RenderJob::toLine() const
+{
+    QStringList pairs;
+    pairs << pair( "id", id );
+    pairs << pair( "theme", mapTheme );
+    pairs << QString( "projection=%1" ).arg( projectionName( projection ) );
+    pairs << QString( "lon=%1" ).arg( longitude, 0, 'f', 8 );
+    pairs << QString( "lat=%1" ).arg( latitude, 0, 'f', 8 );
+    pairs << QString( "radius=%1" ).arg( radius );
+    pairs << QString( "width=%1" ).arg( size.width() );
+    pairs << QString( "height=%1" ).arg( size.height() );
+    pairs << pair( "output", output );
+    pairs << QString( "format=%1" ).arg( format );
+    pairs << QString( "quality=%1" ).arg( quality );
+    if ( !overlays.isEmpty() ) {
+        pairs << pair( "overlays", overlays.join( "," ) );
+    }
+    if ( !plugins.isEmpty() ) {
+        pairs << pair( "plugins", plugins.join( "," ) );
+    }
+    return pairs.join( " " );
+}
+
+bool RenderJob::isValid() const
+{
+    return errorString().isEmpty();
+}
+
+QString RenderJob::errorString() const
+{
+    if ( !m_error.isEmpty() ) {
+        return m_error;
+    }
+    if ( id.isEmpty() ) {
+        return "missing id";
+    }
+    if ( output.isEmpty() ) {
+        return "missing output";
+    }
+    if ( size.isEmpty() || size.width() > 8192 || size.height() > 8192 ) {
+        return "invalid size";
+    }
+    if ( radius <= 0 ) {
+        return "invalid radius";
+    }
+    if ( format != "png" && format != "jpg" ) {
+        return QString( "unsupported format %1" ).arg( format );
+    }
+    return QString();
+}
+
+RenderResult::RenderResult() :
+    success( false ),
+    renderTime( 0 ),
+    totalTime( 0 ),
+    passes( 0 )
+{
+    // nothing to do
+}
+
+RenderResult RenderResult::fromLine( const QString &line )
+{
+    RenderResult result;
+    QHash<QString, QString> const pairs = parsePairs( line );
+    result.id = pairs.value( "id" );
+    result.success = pairs.value( "status" ) == "ok";
+    result.output = pairs.value( "output" );
+    result.error = pairs.value( "error" );
+    result.renderTime = pairs.value( "render" ).toInt();
+    result.totalTime = pairs.value( "total" ).toInt();
+    result.passes = pairs.value( "passes" ).toInt();
+    return result;
+}
+
+QString RenderResult::toLine() const
+{
+    QStringList pairs;
+    pairs << pair( "id", id );
+    pairs << QString( "status=%1" ).arg( success ? "ok" : "error" );
+    if ( success ) {
+        pairs << pair( "output", output );
+    } else {
+        pairs << pair( "error", error );
+    }
+    pairs << QString( "render=%1" ).arg( renderTime );
+    pairs << QString( "total=%1" ).arg( totalTime );
+    pairs << QString( "passes=%1" ).arg( passes );
+    return pairs.join( " " );
+}
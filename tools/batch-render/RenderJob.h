@@ -0,0 +1,88 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef RENDERJOB_H
+#define RENDERJOB_H
+
+#include <marble/MarbleGlobal.h>
+
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+/**
+  * A single map image to render. Jobs are exchanged as one line of whitespace
+  * separated key=value pairs, e.g.
+  *
+  *   id=42 theme=earth/openstreetmap/openstreetmap.dgml projection=mercator
+  *   lon=8.4 lat=49.0 zoom=2400 width=256 height=256 output=/tmp/42.png
+  *
+  * Recognized keys are id, theme, projection (spherical, equirectangular, mercator),
+  * lon, lat (degree), zoom or radius, width, height, output, format (png, jpg),
+  * quality (0-100), overlays and plugins (both comma separated). Values containing
+  * whitespace are enclosed in double quotes, within which \" and \\ stand for a
+  * quote and a backslash, e.g. output="/tmp/route previews/42.png".
+  *
+  * Keys which are missing get the same defaults for every job: the spherical
+  * projection centered on 0, 0 with the whole globe fitting into the image,
+  * all loaded render plugins enabled and no overlays.
+  */
+class RenderJob
+{
+public:
+    RenderJob();
+
+    static RenderJob fromLine( const QString &line );
+
+    QString toLine() const;
+
+    bool isValid() const;
+
+    QString errorString() const;
+
+    QString id;
+    QString mapTheme;
+    Marble::Projection projection;
+    qreal longitude;
+    qreal latitude;
+    int radius;
+    QSize size;
+    QString output;
+    QString format;
+    int quality;
+    QStringList overlays;
+    QStringList plugins;
+
+private:
+    QString m_error;
+};
+
+/**
+  * Outcome of a RenderJob, reported as one line of key=value pairs
+  */
+class RenderResult
+{
+public:
+    RenderResult();
+
+    static RenderResult fromLine( const QString &line );
+
+    QString toLine() const;
+
+    QString id;
+    bool success;
+    QString output;
+    QString error;
+    int renderTime;
+    int totalTime;
+    int passes;
+};
+
+#endif // RENDERJOB_H
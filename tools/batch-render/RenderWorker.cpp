@@ -0,0 +1,270 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "RenderWorker.h"
+
+#include "FileManager.h"
+#include "HttpDownloadManager.h"
+#include "MarbleDirs.h"
+#include "PluginManager.h"
+
+#include <marble/GeoPainter.h>
+#include <marble/RenderPlugin.h>
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QImage>
+#include <QTextStream>
+#include <QTime>
+#include <QTimer>
+
+#include <cstdio>
+
+using namespace Marble;
+
+RenderWorker::RenderWorker( const QStringList &renderPluginBackendTypes, QObject *parent ) :
+    QObject( parent ),
+    m_map( restrictRenderPlugins( &m_model, renderPluginBackendTypes ) ),
+    m_settleTimeout( 10000 ),
+    m_pendingDownloads( 0 )
+{
+    connect( m_model.downloadManager(), SIGNAL(jobAdded()), this, SLOT(addPendingDownload()) );
+    connect( m_model.downloadManager(), SIGNAL(jobRemoved()), this, SLOT(removePendingDownload()) );
+    connect( m_model.fileManager(), SIGNAL(fileAdded(QString)), this, SLOT(addLoadedFile(QString)) );
+    connect( m_model.fileManager(), SIGNAL(fileError(QString,QString)), this, SLOT(addFailedFile(QString,QString)) );
+
+    m_map.setViewContext( Still );
+}
+
+MarbleModel *RenderWorker::restrictRenderPlugins( MarbleModel *model, const QStringList &backendTypes )
+{
+    model->pluginManager()->setRenderPluginBackendTypes( backendTypes );
+    return model;
+}
+
+void RenderWorker::setSettleTimeout( int msec )
+{
+    m_settleTimeout = msec;
+}
+
+int RenderWorker::settleTimeout() const
+{
+    return m_settleTimeout;
+}
+
+void RenderWorker::setWorkOffline( bool offline )
+{
+    m_model.setWorkOffline( offline );
+}
+
+RenderResult RenderWorker::render( const RenderJob &job )
+{
+    QTime totalTime;
+    totalTime.start();
+
+    RenderResult result;
+    result.id = job.id;
+    result.output = job.output;
+
+    if ( !job.isValid() ) {
+        result.error = job.errorString();
+        return result;
+    }
+
+    if ( m_map.mapThemeId() != job.mapTheme ) {
+        m_map.setMapThemeId( job.mapTheme );
+        if ( m_map.mapThemeId() != job.mapTheme ) {
+            result.error = QString( "cannot load map theme %1" ).arg( job.mapTheme );
+            return result;
+        }
+    }
+
+    updateOverlays( job.overlays );
+    updatePlugins( job.plugins );
+
+    result.error = overlayError();
+    if ( !result.error.isEmpty() ) {
+        return result;
+    }
+
+    m_map.setSize( job.size );
+    m_map.setProjection( job.projection );
+    m_map.centerOn( job.longitude, job.latitude );
+    m_map.setRadius( job.radius );
+
+    QImage image( job.size, QImage::Format_ARGB32_Premultiplied );
+    QColor const background = job.format == "png" ? QColor( Qt::transparent ) : QColor( Qt::black );
+
+    // Render, then re-render as long as tile downloads or overlays were still pending
+    bool settled = false;
+    do {
+        QTime renderTime;
+        renderTime.start();
+        image.fill( background.rgba() );
+        GeoPainter painter( &image, m_map.viewport(), m_map.mapQuality() );
+        m_map.paint( painter, QRect() );
+        painter.end();
+        result.renderTime += renderTime.elapsed();
+        ++result.passes;
+
+        QCoreApplication::processEvents();
+        settled = isSettled();
+    } while ( !settled && waitUntilSettled( m_settleTimeout - totalTime.elapsed() ) && overlayError().isEmpty() );
+
+    result.error = overlayError();
+    if ( !result.error.isEmpty() ) {
+        return result;
+    }
+
+    if ( !image.save( job.output, job.format == "jpg" ? "JPG" : "PNG", job.quality ) ) {
+        result.error = QString( "cannot write %1" ).arg( job.output );
+        return result;
+    }
+
+    result.success = true;
+    result.totalTime = totalTime.elapsed();
+    return result;
+}
+
+void RenderWorker::serve()
+{
+    QTextStream input( stdin );
+    QTextStream output( stdout );
+    QString line = input.readLine();
+    for ( ; !line.isNull(); line = input.readLine() ) {
+        line = line.trimmed();
+        if ( line.isEmpty() || line.startsWith( '#' ) ) {
+            continue;
+        }
+
+        output << render( RenderJob::fromLine( line ) ).toLine() << endl;
+    }
+}
+
+void RenderWorker::addPendingDownload()
+{
+    ++m_pendingDownloads;
+}
+
+void RenderWorker::removePendingDownload()
+{
+    m_pendingDownloads = qMax( 0, m_pendingDownloads - 1 );
+}
+
+void RenderWorker::addLoadedFile( const QString &key )
+{
+    m_loadedFiles << key;
+}
+
+void RenderWorker::addFailedFile( const QString &key, const QString &error )
+{
+    m_failedFiles[key] = error;
+}
+
+void RenderWorker::updateOverlays( const QStringList &overlays )
+{
+    foreach( const QString &overlay, m_overlays ) {
+        if ( !overlays.contains( overlay ) ) {
+            m_model.removeGeoData( overlay );
+            m_loadedFiles.remove( overlay );
+            m_failedFiles.remove( overlay );
+        }
+    }
+
+    foreach( const QString &overlay, overlays ) {
+        // overlays which failed to load before are tried again
+        if ( !m_overlays.contains( overlay ) || m_failedFiles.contains( overlay ) ) {
+            m_failedFiles.remove( overlay );
+            if ( overlayExists( overlay ) ) {
+                m_model.addGeoDataFile( overlay );
+            } else {
+                // the file loader does not report missing files
+                m_failedFiles[overlay] = QString( "cannot find overlay %1" ).arg( overlay );
+            }
+        }
+    }
+
+    m_overlays = overlays;
+}
+
+void RenderWorker::updatePlugins( const QStringList &plugins )
+{
+    // applied for every job, loading a map theme may have changed them
+    foreach( RenderPlugin *plugin, m_map.renderPlugins() ) {
+        plugin->setEnabled( plugins.isEmpty() || plugins.contains( plugin->nameId() ) );
+    }
+}
+
+bool RenderWorker::waitUntilSettled( int msec )
+{
+    if ( msec <= 0 ) {
+        return false;
+    }
+
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot( true );
+    connect( &timeout, SIGNAL(timeout()), &loop, SLOT(quit()) );
+    timeout.start( msec );
+
+    QTimer poll;
+    connect( &poll, SIGNAL(timeout()), &loop, SLOT(quit()) );
+    poll.start( 50 );
+
+    while ( timeout.isActive() && !isSettled() ) {
+        loop.exec();
+    }
+
+    return isSettled();
+}
+
+bool RenderWorker::isSettled() const
+{
+    if ( m_pendingDownloads > 0 ) {
+        return false;
+    }
+
+    foreach( const QString &overlay, m_overlays ) {
+        if ( !m_loadedFiles.contains( overlay ) && !m_failedFiles.contains( overlay ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QString RenderWorker::overlayError() const
+{
+    foreach( const QString &overlay, m_overlays ) {
+        if ( m_failedFiles.contains( overlay ) ) {
+            return QString( "cannot load overlay %1: %2" ).arg( overlay ).arg( m_failedFiles.value( overlay ) );
+        }
+    }
+
+    return QString();
+}
+
+bool RenderWorker::overlayExists( const QString &overlay )
+{
+    // same lookup as the file loader: absolute paths, paths relative to the
+    // data directories, and bare names of the bundled placemark files
+    if ( QFileInfo( overlay ).isAbsolute() ) {
+        return QFileInfo( overlay ).exists();
+    }
+
+    if ( overlay.contains( '/' ) ) {
+        return !MarbleDirs::path( overlay ).isEmpty();
+    }
+
+    return !MarbleDirs::path( "placemarks/" + overlay ).isEmpty();
+}
+
+#include "RenderWorker.moc"
@@ -0,0 +1,93 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef RENDERWORKER_H
+#define RENDERWORKER_H
+
+#include "RenderJob.h"
+
+#include <marble/MarbleMap.h>
+#include <marble/MarbleModel.h>
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+/**
+  * Keeps a warm MarbleModel and MarbleMap and renders jobs one after another. Map
+  * themes, overlays and the tile caches stay loaded between jobs, so subsequent jobs
+  * for the same theme only pay for the actual rendering.
+  *
+  * The worker waits for pending tile downloads (up to the settle timeout) and renders
+  * again once they arrived, so the written images do not show blurry parent tiles.
+  * Jobs with an overlay that cannot be loaded fail as soon as the error is known.
+  */
+class RenderWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+      * Only render plugins of the given backend types are loaded, all of them if
+      * @p renderPluginBackendTypes is empty. Jobs can only enable loaded plugins.
+      */
+    explicit RenderWorker( const QStringList &renderPluginBackendTypes = QStringList(), QObject *parent = 0 );
+
+    /** Maximum time in ms to wait for tile downloads and overlays per job */
+    void setSettleTimeout( int msec );
+
+    int settleTimeout() const;
+
+    /** Only use tiles from the local cache, do not download missing ones */
+    void setWorkOffline( bool offline );
+
+    /** Renders the given job and writes it to the job's output file */
+    RenderResult render( const RenderJob &job );
+
+    /** Reads jobs from stdin and writes results to stdout until stdin is closed */
+    void serve();
+
+private Q_SLOTS:
+    void addPendingDownload();
+
+    void removePendingDownload();
+
+    void addLoadedFile( const QString &key );
+
+    void addFailedFile( const QString &key, const QString &error );
+
+private:
+    void updateOverlays( const QStringList &overlays );
+
+    void updatePlugins( const QStringList &plugins );
+
+    /** Spins the event loop until nothing is pending anymore or @p msec passed */
+    bool waitUntilSettled( int msec );
+
+    bool isSettled() const;
+
+    /** Returns the load error of the first overlay which failed to load, if any */
+    QString overlayError() const;
+
+    static bool overlayExists( const QString &overlay );
+
+    /** Restricts the render plugins of @p model before a map is created for it */
+    static Marble::MarbleModel *restrictRenderPlugins( Marble::MarbleModel *model, const QStringList &backendTypes );
+
+    Marble::MarbleModel m_model;
+    Marble::MarbleMap m_map;
+    int m_settleTimeout;
+    int m_pendingDownloads;
+    QStringList m_overlays;
+    QSet<QString> m_loadedFiles;
+    QHash<QString, QString> m_failedFiles;
+};
+
+#endif // RENDERWORKER_H
@@ -0,0 +1,91 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "LineReader.h"
+#include "RenderDispatcher.h"
+#include "RenderWorker.h"
+
+#include <QApplication>
+#include <QDebug>
+
+void usage( const QString &app )
+{
+    qDebug() << "Usage: " << app << "[options] < jobs.txt > results.txt";
+    qDebug() << "\nReads one render job per line from stdin, e.g.";
+    qDebug() << "  id=1 theme=earth/openstreetmap/openstreetmap.dgml projection=mercator lon=8.4 lat=49.0"
+             << "zoom=2400 width=512 height=512 output=/tmp/1.png overlays=/data/route.kml";
+    qDebug() << "and writes one result line per job to stdout. Values containing spaces are quoted,"
+             << "e.g. output=\"/tmp/route previews/1.png\".";
+    qDebug() << "Without a display, run it with '-platform offscreen' (Qt 5) or inside Xvfb.";
+    qDebug() << "\nOptions:";
+    qDebug() << "\t-h, --help................. Show this help";
+    qDebug() << "\t-j, --jobs <n>............. Number of parallel worker processes (default: number of cores)";
+    qDebug() << "\t-t, --timeout <ms>......... Maximum time to wait for tile downloads per job (default: 10000)";
+    qDebug() << "\t-o, --offline.............. Do not download tiles, only use the local tile cache";
+    qDebug() << "\t-p, --plugins <types>...... Only load render plugins of these comma separated backend types,"
+             << "e.g. compass,mapscale (default: all)";
+}
+
+int main( int argc, char *argv[] )
+{
+    QApplication app( argc, argv );
+
+    bool worker = false;
+    bool offline = false;
+    int jobs = 0;
+    int timeout = 10000;
+    QStringList renderPlugins;
+    QStringList workerArguments;
+    for ( int i = 1; i < argc; ++i ) {
+        QString const arg = argv[i];
+        if ( arg == "-h" || arg == "--help" ) {
+            usage( argv[0] );
+            return 0;
+        } else if ( arg == "--worker" ) {
+            worker = true;
+        } else if ( ( arg == "-j" || arg == "--jobs" ) && i + 1 < argc ) {
+            jobs = QString( argv[++i] ).toInt();
+        } else if ( ( arg == "-t" || arg == "--timeout" ) && i + 1 < argc ) {
+            timeout = QString( argv[++i] ).toInt();
+            workerArguments << "--timeout" << QString::number( timeout );
+        } else if ( arg == "-o" || arg == "--offline" ) {
+            offline = true;
+            workerArguments << "--offline";
+        } else if ( ( arg == "-p" || arg == "--plugins" ) && i + 1 < argc ) {
+            renderPlugins = QString( argv[++i] ).split( ',', QString::SkipEmptyParts );
+            workerArguments << "--plugins" << renderPlugins.join( "," );
+        } else {
+            usage( argv[0] );
+            return 1;
+        }
+    }
+
+    if ( worker ) {
+        RenderWorker renderWorker( renderPlugins );
+        renderWorker.setSettleTimeout( timeout );
+        renderWorker.setWorkOffline( offline );
+        renderWorker.serve();
+        return 0;
+    }
+
+    RenderDispatcher dispatcher;
+    if ( jobs > 0 ) {
+        dispatcher.setWorkerCount( jobs );
+    }
+    dispatcher.setWorkerArguments( workerArguments );
+    dispatcher.start();
+
+    LineReader reader;
+    QObject::connect( &reader, SIGNAL(lineRead(QString)), &dispatcher, SLOT(addJob(QString)) );
+    QObject::connect( &reader, SIGNAL(finished()), &dispatcher, SLOT(finishInput()) );
+    reader.start();
+
+    return app.exec();
+}
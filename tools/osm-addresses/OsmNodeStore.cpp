@@ -0,0 +1,202 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "OsmNodeStore.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QTemporaryFile>
+
+#include <algorithm>
+
+namespace Marble
+{
+
+namespace {
+    /** Number of nodes buffered before they are written to the mapped file */
+    const std::size_t s_bufferSize = 1 << 16;
+}
+
+Coordinate::Coordinate(float lon_, float lat_) : lon(lon_), lat(lat_)
+{
+    // nothing to do
+}
+
+OsmNodeStore::OsmNodeStore( Storage storage ) :
+    m_storage( storage ),
+    m_file( 0 ),
+    m_mapped( 0 ),
+    m_size( 0 ),
+    m_lastId( 0 ),
+    m_sorted( true ),
+    m_finalized( false )
+{
+    // nothing to do
+}
+
+OsmNodeStore::~OsmNodeStore()
+{
+    clear();
+}
+
+void OsmNodeStore::setStorage( Storage storage )
+{
+    Q_ASSERT( isEmpty() );
+    m_storage = storage;
+}
+
+OsmNodeStore::Storage OsmNodeStore::storage() const
+{
+    return m_storage;
+}
+
+void OsmNodeStore::insert( qint64 id, const Coordinate &coordinate )
+{
+    Q_ASSERT( !m_finalized );
+
+    if ( m_size > 0 && id <= m_lastId ) {
+        m_sorted = false;
+    }
+    m_lastId = id;
+
+    Entry entry;
+    entry.id = id;
+    entry.coordinate = coordinate;
+    m_entries.push_back( entry );
+    ++m_size;
+
+    if ( m_storage == MappedFileStorage && m_entries.size() >= s_bufferSize ) {
+        flush();
+    }
+}
+
+void OsmNodeStore::flush()
+{
+    if ( m_entries.empty() ) {
+        return;
+    }
+
+    if ( !m_file ) {
+        m_file = new QTemporaryFile( QDir::tempPath() + "/osm-addresses-nodes-XXXXXX" );
+        if ( !m_file->open() ) {
+            qFatal( "Unable to create a temporary file for the node store" );
+        }
+    }
+
+    const qint64 bytes = m_entries.size() * sizeof( Entry );
+    if ( m_file->write( reinterpret_cast<const char*>( &m_entries[0] ), bytes ) != bytes ) {
+        qFatal( "Unable to write to the node store in %s", qPrintable( m_file->fileName() ) );
+    }
+    m_entries.clear();
+}
+
+bool OsmNodeStore::idLessThan( const Entry &a, const Entry &b )
+{
+    return a.id < b.id;
+}
+
+void OsmNodeStore::finalize()
+{
+    if ( m_finalized ) {
+        return;
+    }
+    m_finalized = true;
+
+    Entry* entries = 0;
+    if ( m_storage == MappedFileStorage ) {
+        flush();
+        if ( m_file && m_size > 0 ) {
+            m_file->flush();
+            m_mapped = reinterpret_cast<Entry*>( m_file->map( 0, m_size * sizeof( Entry ) ) );
+            if ( !m_mapped ) {
+                qFatal( "Unable to map the node store in %s", qPrintable( m_file->fileName() ) );
+            }
+        }
+        entries = m_mapped;
+    } else if ( !m_entries.empty() ) {
+        entries = &m_entries[0];
+    }
+
+    if ( m_sorted || !entries ) {
+        return;
+    }
+
+    // keep the coordinate inserted last for duplicates, like QHash::insert does
+    std::stable_sort( entries, entries + m_size, idLessThan );
+    qint64 last = 0;
+    for ( qint64 i = 1; i < m_size; ++i ) {
+        if ( entries[i].id != entries[last].id ) {
+            ++last;
+        }
+        entries[last] = entries[i];
+    }
+    m_size = last + 1;
+
+    if ( m_storage == MemoryStorage ) {
+        m_entries.resize( m_size );
+    }
+    m_sorted = true;
+}
+
+bool OsmNodeStore::contains( qint64 id ) const
+{
+    return value( id ) != 0;
+}
+
+const Coordinate* OsmNodeStore::value( qint64 id ) const
+{
+    Q_ASSERT( m_finalized );
+
+    const Entry* begin = m_storage == MappedFileStorage ? m_mapped : ( m_entries.empty() ? 0 : &m_entries[0] );
+    if ( !begin ) {
+        return 0;
+    }
+
+    Entry key;
+    key.id = id;
+    const Entry* end = begin + m_size;
+    const Entry* entry = std::lower_bound( begin, end, key, idLessThan );
+    return entry != end && entry->id == id ? &entry->coordinate : 0;
+}
+
+qint64 OsmNodeStore::size() const
+{
+    return m_size;
+}
+
+bool OsmNodeStore::isEmpty() const
+{
+    return m_size == 0;
+}
+
+const Coordinate& OsmNodeStore::at( qint64 index ) const
+{
+    Q_ASSERT( m_finalized );
+    Q_ASSERT( index >= 0 && index < m_size );
+    return m_storage == MappedFileStorage ? m_mapped[index].coordinate : m_entries[index].coordinate;
+}
+
+void OsmNodeStore::clear()
+{
+    if ( m_mapped ) {
+        m_file->unmap( reinterpret_cast<uchar*>( m_mapped ) );
+        m_mapped = 0;
+    }
+    delete m_file;
+    m_file = 0;
+
+    std::vector<Entry>().swap( m_entries );
+    m_size = 0;
+    m_lastId = 0;
+    m_sorted = true;
+    m_finalized = false;
+}
+
+}
@@ -0,0 +1,104 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef MARBLE_OSMNODESTORE_H
+#define MARBLE_OSMNODESTORE_H
+
+#include <QtGlobal>
+
+#include <vector>
+
+class QTemporaryFile;
+
+namespace Marble
+{
+
+struct Coordinate {
+    float lon;
+    float lat;
+
+    Coordinate(float lon=0.0, float lat=0.0);
+};
+
+/**
+  * Coordinates of OSM nodes by their 64 bit node id. Nodes are appended
+  * while parsing and looked up by binary search once finalize() sorted them,
+  * taking 16 bytes per node. Stores too large for the main memory can be
+  * kept in a memory mapped temporary file instead.
+  */
+class OsmNodeStore
+{
+public:
+    enum Storage {
+        MemoryStorage,
+        MappedFileStorage
+    };
+
+    explicit OsmNodeStore( Storage storage = MemoryStorage );
+
+    ~OsmNodeStore();
+
+    /** Changes the storage. Only possible as long as the store is empty */
+    void setStorage( Storage storage );
+
+    Storage storage() const;
+
+    /** Adds a node. A node inserted twice keeps the coordinate inserted last */
+    void insert( qint64 id, const Coordinate &coordinate );
+
+    /** Sorts the nodes by id, unless they were inserted in order. Must be called before lookups */
+    void finalize();
+
+    bool contains( qint64 id ) const;
+
+    /** Returns the coordinate of the given node, or 0 if it is unknown */
+    const Coordinate* value( qint64 id ) const;
+
+    qint64 size() const;
+
+    bool isEmpty() const;
+
+    /** Returns the coordinate of the node at the given position in id order */
+    const Coordinate& at( qint64 index ) const;
+
+    void clear();
+
+private:
+    Q_DISABLE_COPY( OsmNodeStore )
+
+    struct Entry {
+        qint64 id;
+        Coordinate coordinate;
+    };
+
+    static bool idLessThan( const Entry &a, const Entry &b );
+
+    void flush();
+
+    Storage m_storage;
+
+    std::vector<Entry> m_entries;
+
+    QTemporaryFile* m_file;
+
+    Entry* m_mapped;
+
+    qint64 m_size;
+
+    qint64 m_lastId;
+
+    bool m_sorted;
+
+    bool m_finalized;
+};
+
+}
+
+#endif // MARBLE_OSMNODESTORE_H
@@ -27,31 +27,86 @@
 
 #include <QDebug>
 #include <QTime>
+#include <QFuture>
+#include <QtConcurrentMap>
 
 namespace Marble
 {
 
 namespace {
-    struct GrahamScanHelper {
-        Coordinate coordinate;
-        qreal direction;
+    bool lonLatLessThan( const Coordinate &one, const Coordinate &two )
+    {
+        return one.lon < two.lon || ( one.lon == two.lon && one.lat < two.lat );
+    }
+
+    /** Positive if o, a, b make a counter-clockwise turn, negative if clockwise, zero if collinear */
+    double cross( const Coordinate &o, const Coordinate &a, const Coordinate &b )
+    {
+        return   double( a.lon - o.lon ) * double( b.lat - o.lat )
+               - double( a.lat - o.lat ) * double( b.lon - o.lon );
+    }
+
+    /**
+      * Returns the convex hull of the given points in counter-clockwise order, without
+      * repeating the first point (Andrew's monotone chain, see
+      * http://en.wikibooks.org/wiki/Algorithm_Implementation/Geometry/Convex_hull/Monotone_chain)
+      */
+    QVector<Coordinate> convexHullOf( QVector<Coordinate> points )
+    {
+        int const n = points.size();
+        if ( n < 3 ) {
+            return points;
+        }
 
-        GrahamScanHelper( const Coordinate &coordinate_=Coordinate(), qreal direction_=0.0 )
-            : coordinate( coordinate_ ), direction( direction_ )
-        {
-            // nothing to do
+        qSort( points.begin(), points.end(), lonLatLessThan );
+
+        QVector<Coordinate> hull( 2 * n );
+        int k = 0;
+        for ( int i = 0; i < n; ++i ) {
+            while ( k >= 2 && cross( hull[k-2], hull[k-1], points[i] ) <= 0 ) {
+                --k;
+            }
+            hull[k++] = points[i];
         }
 
-        double turnDirection( const GrahamScanHelper &two, const GrahamScanHelper &three )
-        {
-            return    ( two.coordinate.lat - coordinate.lat ) * ( three.coordinate.lon - coordinate.lon )
-                    - ( two.coordinate.lon - coordinate.lon ) * ( three.coordinate.lat - coordinate.lat );
+        for ( int i = n - 2, lower = k + 1; i >= 0; --i ) {
+            while ( k >= lower && cross( hull[k-2], hull[k-1], points[i] ) <= 0 ) {
+                --k;
+            }
+            hull[k++] = points[i];
         }
 
-        static bool directionLessThan( const GrahamScanHelper &one, const GrahamScanHelper &two )
+        hull.resize( k - 1 );
+        return hull;
+    }
+
+    /** A placemark waiting for its region to be looked up */
+    struct RegionLookup {
+        OsmPlacemark placemark;
+        int regionId;
+        bool needsLookup;
+        Way way;
+        Node node;
+
+        RegionLookup() : regionId( 0 ), needsLookup( true ) {}
+    };
+
+    /** Looks up the regions of placemarks on worker threads */
+    class RegionAssigner {
+    public:
+        typedef void result_type;
+
+        explicit RegionAssigner( const OsmRegionIndex &index ) : m_index( &index ) {}
+
+        void operator()( RegionLookup &lookup ) const
         {
-            return one.direction < two.direction;
+            if ( lookup.needsLookup ) {
+                lookup.regionId = m_index->smallestRegionId( lookup.placemark.longitude(), lookup.placemark.latitude() );
+            }
         }
+
+    private:
+        const OsmRegionIndex* m_index;
     };
 }
 
@@ -117,6 +172,12 @@ void OsmParser::addWriter( Writer* writer )
     m_writers.push_back( writer );
 }
 
+void OsmParser::setNodeStorage( OsmNodeStore::Storage storage )
+{
+    m_coordinates.clear();
+    m_coordinates.setStorage( storage );
+}
+
 Node::operator OsmPlacemark() const
 {
     OsmPlacemark placemark;
@@ -145,15 +206,14 @@ Way::operator OsmPlacemark() const
     return placemark;
 }
 
-void Way::setPosition( const QHash<int, Coordinate> &database, OsmPlacemark &placemark ) const
+void Way::setPosition( const OsmNodeStore &database, OsmPlacemark &placemark ) const
 {
     if ( !nodes.isEmpty() ) {
         if ( nodes.first() == nodes.last() && database.contains( nodes.first() ) ) {
             GeoDataLinearRing ring;
-            foreach( int id, nodes ) {
-                if ( database.contains( id ) ) {
-                    const Coordinate &node = database[id];
-                    GeoDataCoordinates coordinates( node.lon, node.lat, 0.0, GeoDataCoordinates::Degree );
+            foreach( qint64 id, nodes ) {
+                if ( const Coordinate* node = database.value( id ) ) {
+                    GeoDataCoordinates coordinates( node->lon, node->lat, 0.0, GeoDataCoordinates::Degree );
                     ring << coordinates;
                 } else {
                     qDebug() << "Missing node " << id << " in database";
@@ -166,17 +226,16 @@ void Way::setPosition( const QHash<int, Coordinate> &database, OsmPlacemark &pla
                 placemark.setLatitude( center.latitude( GeoDataCoordinates::Degree ) );
             }
         } else {
-            int id = nodes.at( nodes.size() / 2 );
-            if ( database.contains( id ) ) {
-                const Coordinate &node = database[id];
-                placemark.setLongitude( node.lon );
-                placemark.setLatitude( node.lat );
+            qint64 id = nodes.at( nodes.size() / 2 );
+            if ( const Coordinate* node = database.value( id ) ) {
+                placemark.setLongitude( node->lon );
+                placemark.setLatitude( node->lat );
             }
         }
     }
 }
 
-void Way::setRegion( const QHash<int, Node> &database,  const OsmRegionTree & tree, QList<OsmOsmRegion> & osmOsmRegions, OsmPlacemark &placemark ) const
+void Way::setRegion( const QHash<qint64, Node> &database, const OsmRegionIndex & index, QList<OsmOsmRegion> & osmOsmRegions, OsmPlacemark &placemark ) const
 {
     if ( !city.isEmpty() ) {
         foreach( const OsmOsmRegion & region, osmOsmRegions ) {
@@ -209,8 +268,7 @@ void Way::setRegion( const QHash<int, Node> &database,  const OsmRegionTree & tr
         return;
     }
 
-    GeoDataCoordinates position( placemark.longitude(), placemark.latitude(), 0.0, GeoDataCoordinates::Degree );
-    placemark.setRegionId( tree.smallestRegionId( position ) );
+    placemark.setRegionId( index.smallestRegionId( placemark.longitude(), placemark.latitude() ) );
 }
 
 void OsmParser::read( const QFileInfo &content, const QString &areaName )
@@ -218,6 +276,7 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
     QTime timer;
     timer.start();
 
+    m_coordinates.clear();
     m_nodes.clear();
     m_ways.clear();
     m_relations.clear();
@@ -233,11 +292,14 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
     }
     while ( needAnotherPass );
 
-    qWarning() << "Step 2: " << m_coordinates.size() << "coordinates."
+    m_coordinates.finalize();
+
+    qWarning() << "Step 2: " << m_coordinates.size() << "coordinates,"
+               << m_nodes.size() << "nodes and" << m_ways.size() << "ways after" << timer.elapsed() / 1000 << "s."
                << "Now extracting regions from" << m_relations.size() << "relations";
 
-    QHash<int, Relation>::iterator itpoint = m_relations.begin();
-    QHash<int, Relation>::iterator const endpoint = m_relations.end();
+    QHash<qint64, Relation>::iterator itpoint = m_relations.begin();
+    QHash<qint64, Relation>::iterator const endpoint = m_relations.end();
     for(; itpoint != endpoint; ++itpoint ) {
         if ( itpoint.value().isAdministrativeBoundary /*&& relation.isMultipolygon*/ ) {
             importMultipolygon( itpoint.value() );
@@ -296,7 +358,8 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
     mainArea.setName( areaName );
     mainArea.setAdminLevel( 1 );
     QPair<float, float> minLon( -180.0, 180.0 ), minLat( -90.0, 90.0 );
-    foreach( const Coordinate & node, m_coordinates ) {
+    for ( qint64 i = 0; i < m_coordinates.size(); ++i ) {
+        const Coordinate & node = m_coordinates.at( i );
         minLon.first  = qMin( node.lon, minLon.first );
         minLon.second = qMax( node.lon, minLon.second );
         minLat.first  = qMin( node.lat, minLat.first );
@@ -319,29 +382,24 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
     int left = 0;
     regionTree.traverse( left );
 
-    qWarning() << "Step 4: Creating placemarks from" << m_nodes.size() << "nodes";
+    const OsmRegionIndex regionIndex( regionTree, mainArea.identifier() );
+
+    qWarning() << "Step 4: Looking up the regions of" << m_nodes.size() << "nodes after" << timer.elapsed() / 1000 << "s";
 
+    QVector<RegionLookup> nodeLookups;
     foreach( const Node & node, m_nodes ) {
         if ( node.save ) {
-            OsmPlacemark placemark = node;
-            GeoDataCoordinates position( node.lon, node.lat, 0.0, GeoDataCoordinates::Degree );
-            placemark.setRegionId( regionTree.smallestRegionId( position ) );
-
-            if ( !node.name.isEmpty() ) {
-                placemark.setHouseNumber( QString() );
-                m_placemarks.push_back( placemark );
-            }
-
-            if ( !node.street.isEmpty() && node.name != node.street ) {
-                placemark.setCategory( OsmPlacemark::Address );
-                placemark.setName( node.street.trimmed() );
-                placemark.setHouseNumber( node.houseNumber.trimmed() );
-                m_placemarks.push_back( placemark );
-            }
+            RegionLookup lookup;
+            lookup.placemark = node;
+            lookup.node = node;
+            nodeLookups << lookup;
         }
     }
 
-    qWarning() << "Step 5: Creating placemarks from" << m_ways.size() << "ways";
+    // The regions of the nodes are looked up while the ways are merged below
+    QFuture<void> nodeRegions = QtConcurrent::map( nodeLookups, RegionAssigner( regionIndex ) );
+
+    qWarning() << "Step 5: Merging" << m_ways.size() << "ways after" << timer.elapsed() / 1000 << "s";
     QMultiMap<QString, Way> waysByName;
     foreach ( const Way & way, m_ways ) {
         if ( way.save ) {
@@ -357,31 +415,73 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
         }
     }
 
+    QVector<RegionLookup> lookups;
     QSet<QString> keys = QSet<QString>::fromList( waysByName.keys() );
     foreach( const QString & key, keys ) {
         QList<QList<Way> > merged = merge( waysByName.values( key ) );
         foreach( const QList<Way> ways, merged ) {
             Q_ASSERT( !ways.isEmpty() );
-            OsmPlacemark placemark = ways.first();
-            ways.first().setPosition( m_coordinates, placemark );
-            ways.first().setRegion( m_nodes, regionTree, m_osmOsmRegions, placemark );
-
-            if ( placemark.category() != OsmPlacemark::Address && !ways.first().name.isEmpty() ) {
-                placemark.setHouseNumber( QString() );
-                m_placemarks.push_back( placemark );
+            RegionLookup lookup;
+            lookup.way = ways.first();
+            lookup.placemark = lookup.way;
+            lookup.way.setPosition( m_coordinates, lookup.placemark );
+            if ( !lookup.way.city.isEmpty() ) {
+                // may create implicit regions, which is not thread-safe
+                lookup.way.setRegion( m_nodes, regionIndex, m_osmOsmRegions, lookup.placemark );
+                lookup.regionId = lookup.placemark.regionId();
+                lookup.needsLookup = false;
             }
+            lookups << lookup;
+        }
+    }
 
-            if ( !ways.first().isBuilding || !ways.first().houseNumber.isEmpty() ) {
-                placemark.setCategory( OsmPlacemark::Address );
-                QString name = ways.first().street.isEmpty() ? ways.first().name : ways.first().street;
-                if ( !name.isEmpty() ) {
-                    placemark.setName( name.trimmed() );
-                    placemark.setHouseNumber( ways.first().houseNumber.trimmed() );
-                    m_placemarks.push_back( placemark );
-                }
+    nodeRegions.waitForFinished();
+
+    // The regions of the ways are looked up while the placemarks of the nodes are created
+    QFuture<void> wayRegions = QtConcurrent::map( lookups, RegionAssigner( regionIndex ) );
+
+    foreach( const RegionLookup & lookup, nodeLookups ) {
+        const Node & node = lookup.node;
+        OsmPlacemark placemark = lookup.placemark;
+        placemark.setRegionId( lookup.regionId );
+
+        if ( !node.name.isEmpty() ) {
+            placemark.setHouseNumber( QString() );
+            m_placemarks.push_back( placemark );
+        }
+
+        if ( !node.street.isEmpty() && node.name != node.street ) {
+            placemark.setCategory( OsmPlacemark::Address );
+            placemark.setName( node.street.trimmed() );
+            placemark.setHouseNumber( node.houseNumber.trimmed() );
+            m_placemarks.push_back( placemark );
+        }
+    }
+    nodeLookups.clear();
+
+    wayRegions.waitForFinished();
+
+    foreach( const RegionLookup & lookup, lookups ) {
+        const Way & way = lookup.way;
+        OsmPlacemark placemark = lookup.placemark;
+        placemark.setRegionId( lookup.regionId );
+
+        if ( placemark.category() != OsmPlacemark::Address && !way.name.isEmpty() ) {
+            placemark.setHouseNumber( QString() );
+            m_placemarks.push_back( placemark );
+        }
+
+        if ( !way.isBuilding || !way.houseNumber.isEmpty() ) {
+            placemark.setCategory( OsmPlacemark::Address );
+            QString name = way.street.isEmpty() ? way.name : way.street;
+            if ( !name.isEmpty() ) {
+                placemark.setName( name.trimmed() );
+                placemark.setHouseNumber( way.houseNumber.trimmed() );
+                m_placemarks.push_back( placemark );
             }
         }
     }
+    lookups.clear();
 
     m_convexHull = convexHull();
     m_coordinates.clear();
@@ -455,7 +555,7 @@ QList< QList<Way> > OsmParser::merge( const QList<Way> &ways ) const
 void OsmParser::importMultipolygon( const Relation &relation )
 {
     /** @todo: import nodes? What are they used for? */
-    typedef QPair<int, RelationRole> RelationPair;
+    typedef QPair<qint64, RelationRole> RelationPair;
     QVector<GeoDataLineString> outer;
     QVector<GeoDataLineString> inner;
     foreach( const RelationPair & pair, relation.ways ) {
@@ -493,7 +593,7 @@ void OsmParser::importMultipolygon( const Relation &relation )
     }
 }
 
-void OsmParser::importWay( QVector<GeoDataLineString> &ways, int id )
+void OsmParser::importWay( QVector<GeoDataLineString> &ways, qint64 id )
 {
     if ( !m_ways.contains( id ) ) {
         qDebug() << "Skipping unknown way " << id << ". Check data.";
@@ -501,12 +601,12 @@ void OsmParser::importWay( QVector<GeoDataLineString> &ways, int id )
     }
 
     GeoDataLineString way;
-    foreach( int node, m_ways[id].nodes ) {
-        if ( !m_coordinates.contains( node ) ) {
+    foreach( qint64 node, m_ways[id].nodes ) {
+        const Coordinate* nd = m_coordinates.value( node );
+        if ( !nd ) {
             qDebug() << "Skipping unknown node " << node << ". Check data.";
         } else {
-            const Coordinate &nd = m_coordinates[node];
-            GeoDataCoordinates coordinates( nd.lon, nd.lat, 0.0, GeoDataCoordinates::Degree );
+            GeoDataCoordinates coordinates( nd->lon, nd->lat, 0.0, GeoDataCoordinates::Degree );
             way << coordinates;
         }
     }
@@ -627,63 +727,31 @@ void OsmParser::setCategory( Element &element, const QString &key, const QString
     }
 }
 
-// From http://en.wikipedia.org/wiki/Graham_scan#Pseudocode
 GeoDataLinearRing* OsmParser::convexHull() const
 {
-    Q_ASSERT(m_coordinates.size()>2);
-    QList<Coordinate> coordinates = m_coordinates.values();
-
-    QVector<GrahamScanHelper> points;
-    points.reserve( coordinates.size()+1 );
-    Coordinate start = coordinates.first();
-    int startPos = 0;
-    for ( int i=0; i<coordinates.size(); ++i ) {
-        if ( coordinates[i].lon < start.lon ) {
-            start = coordinates[i];
-            startPos = i;
+    Q_ASSERT( m_coordinates.size() > 2 );
+
+    // The hull of all nodes equals the hull of the hull of some nodes and the
+    // remaining nodes. Processing the nodes block by block therefore only needs
+    // memory for one block and the hull, even for planet sized inputs.
+    int const blockSize = 1 << 20;
+    QVector<Coordinate> hull;
+    QVector<Coordinate> block;
+    block.reserve( blockSize );
+    for ( qint64 i = 0; i < m_coordinates.size(); ++i ) {
+        block << m_coordinates.at( i );
+        if ( block.size() == blockSize ) {
+            block += hull;
+            hull = convexHullOf( block );
+            block.resize( 0 ); // keeps the capacity, unlike clear()
         }
-        points << coordinates[i];
-    }
-
-    int const n = points.size();
-    Q_ASSERT( n == coordinates.size() );
-    Q_ASSERT( n>2 );
-    qSwap( points[1], points[startPos] );
-
-    Q_ASSERT( start.lat != 360.0 );
-
-    for ( int i=0; i<points.size(); ++i ) {
-        points[i].direction = atan2( start.lon - points[i].coordinate.lon,
-                                   start.lat - points[i].coordinate.lat );
-    }
-
-    qSort( points.begin(), points.end(), GrahamScanHelper::directionLessThan );
-    points << points.first();
-
-    int m = 2;
-    for ( int i=3; i<=n; ++i ) {
-        while ( points[m-1].turnDirection( points[m], points[i] ) <= 0 ) {
-            if ( m == 2 ) {
-                qSwap( points[m], points[i] );
-                ++i;
-            } else {
-                --m;
-            }
-
-            Q_ASSERT( n+1 == points.size() );
-            Q_ASSERT( m > 0 );
-            Q_ASSERT( m <= n );
-            Q_ASSERT( i >= 0 );
-            Q_ASSERT( i <= n );
-        }
-
-        ++m;
-        qSwap( points[m], points[i] );
     }
+    block += hull;
+    hull = convexHullOf( block );
 
     GeoDataLinearRing* ring = new GeoDataLinearRing;
-    for ( int i=1; i<=m; ++i ) {
-        ring->append(GeoDataCoordinates(points[i].coordinate.lon, points[i].coordinate.lat, 0.0, GeoDataCoordinates::Degree));
+    foreach( const Coordinate &coordinate, hull ) {
+        ring->append( GeoDataCoordinates( coordinate.lon, coordinate.lat, 0.0, GeoDataCoordinates::Degree ) );
     }
 
     return ring;
@@ -756,9 +824,4 @@ void OsmParser::writeKml( const QString &area, const QString &version, const QSt
     file.close();
 }
 
-Coordinate::Coordinate(float lon_, float lat_) : lon(lon_), lat(lat_)
-{
-    // nothing to do
-}
-
 }
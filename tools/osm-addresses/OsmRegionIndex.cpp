@@ -0,0 +1,230 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#include "OsmRegionIndex.h"
+
+#include <QVarLengthArray>
+#include <QtCore/qmath.h>
+
+namespace Marble
+{
+
+namespace {
+    /** Maximum number of children of an R-tree node */
+    const int s_nodeCapacity = 16;
+}
+
+OsmRegionIndex::PreparedRing::PreparedRing()
+{
+    // nothing to do
+}
+
+OsmRegionIndex::PreparedRing::PreparedRing( const GeoDataLinearRing &ring )
+{
+    points.reserve( ring.size() );
+    qreal west = 180.0, east = -180.0, south = 90.0, north = -90.0;
+    for ( int i = 0; i < ring.size(); ++i ) {
+        const QPointF point( ring[i].longitude( GeoDataCoordinates::Degree ),
+                             ring[i].latitude( GeoDataCoordinates::Degree ) );
+        west = qMin( west, point.x() );
+        east = qMax( east, point.x() );
+        south = qMin( south, point.y() );
+        north = qMax( north, point.y() );
+        points << point;
+    }
+
+    if ( !points.isEmpty() ) {
+        bounds = QRectF( QPointF( west, south ), QPointF( east, north ) );
+    }
+}
+
+bool OsmRegionIndex::PreparedRing::contains( const QPointF &point ) const
+{
+    if ( points.size() < 3 || !OsmRegionIndex::contains( bounds, point ) ) {
+        return false;
+    }
+
+    // even-odd rule, counting crossings of a ray heading east
+    bool inside = false;
+    const QPointF* const data = points.constData();
+    const int size = points.size();
+    for ( int i = 0, j = size - 1; i < size; j = i++ ) {
+        const QPointF &a = data[i];
+        const QPointF &b = data[j];
+        if ( ( a.y() > point.y() ) != ( b.y() > point.y() )
+             && point.x() < ( b.x() - a.x() ) * ( point.y() - a.y() ) / ( b.y() - a.y() ) + a.x() ) {
+            inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+bool OsmRegionIndex::PreparedRegion::contains( const QPointF &point ) const
+{
+    if ( !outer.contains( point ) ) {
+        return false;
+    }
+
+    foreach( const PreparedRing &hole, inner ) {
+        if ( hole.contains( point ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+OsmRegionIndex::OsmRegionIndex( const QList<OsmRegion> &regions, int rootIdentifier ) :
+    m_rootIdentifier( rootIdentifier )
+{
+    int order = 0;
+    foreach( const OsmRegion &region, regions ) {
+        ++order;
+        if ( region.geometry().outerBoundary().size() < 3 ) {
+            // implicit regions and the root have no geometry
+            continue;
+        }
+
+        PreparedRegion prepared;
+        prepared.identifier = region.identifier();
+        prepared.adminLevel = region.adminLevel();
+        prepared.order = order;
+        prepared.outer = PreparedRing( region.geometry().outerBoundary() );
+        foreach( const GeoDataLinearRing &ring, region.geometry().innerBoundaries() ) {
+            prepared.inner << PreparedRing( ring );
+        }
+        m_regions << prepared;
+    }
+
+    build();
+}
+
+bool OsmRegionIndex::contains( const QRectF &bounds, const QPointF &point )
+{
+    return point.x() >= bounds.left() && point.x() <= bounds.right()
+        && point.y() >= bounds.top() && point.y() <= bounds.bottom();
+}
+
+const QRectF &OsmRegionIndex::bounds( const PreparedRegion &region )
+{
+    return region.outer.bounds;
+}
+
+const QRectF &OsmRegionIndex::bounds( const TreeNode &node )
+{
+    return node.bounds;
+}
+
+template<class T>
+bool OsmRegionIndex::centerXLessThan( const T &a, const T &b )
+{
+    return bounds( a ).center().x() < bounds( b ).center().x();
+}
+
+template<class T>
+bool OsmRegionIndex::centerYLessThan( const T &a, const T &b )
+{
+    return bounds( a ).center().y() < bounds( b ).center().y();
+}
+
+template<class T>
+void OsmRegionIndex::sortTileRecursive( typename QVector<T>::iterator begin, typename QVector<T>::iterator end )
+{
+    const int count = end - begin;
+    const int nodes = ( count + s_nodeCapacity - 1 ) / s_nodeCapacity;
+    const int sliceSize = s_nodeCapacity * qCeil( qSqrt( nodes ) );
+
+    qSort( begin, end, centerXLessThan<T> );
+    for ( typename QVector<T>::iterator slice = begin; slice < end; slice += qMin<int>( sliceSize, end - slice ) ) {
+        qSort( slice, slice + qMin<int>( sliceSize, end - slice ), centerYLessThan<T> );
+    }
+}
+
+void OsmRegionIndex::build()
+{
+    m_nodes.clear();
+    if ( m_regions.isEmpty() ) {
+        return;
+    }
+
+    // leaves, each referring to consecutive regions
+    sortTileRecursive<PreparedRegion>( m_regions.begin(), m_regions.end() );
+    for ( int i = 0; i < m_regions.size(); i += s_nodeCapacity ) {
+        TreeNode node;
+        node.first = i;
+        node.count = qMin( s_nodeCapacity, m_regions.size() - i );
+        node.isLeaf = true;
+        for ( int k = node.first; k < node.first + node.count; ++k ) {
+            node.bounds |= m_regions[k].outer.bounds;
+        }
+        m_nodes << node;
+    }
+
+    // inner nodes, level by level, until a single root is left
+    int levelBegin = 0;
+    while ( m_nodes.size() - levelBegin > 1 ) {
+        const int levelEnd = m_nodes.size();
+        sortTileRecursive<TreeNode>( m_nodes.begin() + levelBegin, m_nodes.begin() + levelEnd );
+        for ( int i = levelBegin; i < levelEnd; i += s_nodeCapacity ) {
+            TreeNode node;
+            node.first = i;
+            node.count = qMin( s_nodeCapacity, levelEnd - i );
+            node.isLeaf = false;
+            for ( int k = node.first; k < node.first + node.count; ++k ) {
+                node.bounds |= m_nodes[k].bounds;
+            }
+            m_nodes << node;
+        }
+        levelBegin = levelEnd;
+    }
+}
+
+int OsmRegionIndex::smallestRegionId( qreal longitude, qreal latitude ) const
+{
+    if ( m_nodes.isEmpty() ) {
+        return m_rootIdentifier;
+    }
+
+    const QPointF point( longitude, latitude );
+    const PreparedRegion* result = 0;
+
+    QVarLengthArray<int, 64> stack;
+    stack.append( m_nodes.size() - 1 );
+    while ( !stack.isEmpty() ) {
+        const TreeNode &node = m_nodes[stack[stack.size() - 1]];
+        stack.resize( stack.size() - 1 );
+        if ( !contains( node.bounds, point ) ) {
+            continue;
+        }
+
+        for ( int i = node.first; i < node.first + node.count; ++i ) {
+            if ( !node.isLeaf ) {
+                stack.append( i );
+                continue;
+            }
+
+            const PreparedRegion &region = m_regions[i];
+            if ( result && ( region.adminLevel < result->adminLevel
+                             || ( region.adminLevel == result->adminLevel && region.order < result->order ) ) ) {
+                // cannot replace the current result, skip the expensive test
+                continue;
+            }
+
+            if ( region.contains( point ) ) {
+                result = &region;
+            }
+        }
+    }
+
+    return result ? result->identifier : m_rootIdentifier;
+}
+
+}
@@ -0,0 +1,103 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026      agent <agent@local>
+//
+
+#ifndef MARBLE_OSMREGIONINDEX_H
+#define MARBLE_OSMREGIONINDEX_H
+
+#include "OsmRegion.h"
+
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+namespace Marble
+{
+
+/**
+  * Finds the most detailed administrative region containing a point. Candidate
+  * regions are looked up by their bounding box in a bulk loaded R-tree and
+  * tested against polygons prepared for fast point in polygon tests. Lookups
+  * are thread-safe.
+  */
+class OsmRegionIndex
+{
+public:
+    /**
+      * Indexes the geometries of the given regions. Points not contained in
+      * any of them belong to the region with the root identifier.
+      */
+    explicit OsmRegionIndex( const QList<OsmRegion> &regions, int rootIdentifier = 0 );
+
+    /**
+      * Returns the identifier of the region with the highest admin level
+      * containing the given point, in degree.
+      */
+    int smallestRegionId( qreal longitude, qreal latitude ) const;
+
+private:
+    /** A ring converted to degree, with its bounding box */
+    struct PreparedRing {
+        QVector<QPointF> points;
+        QRectF bounds;
+
+        PreparedRing();
+
+        explicit PreparedRing( const GeoDataLinearRing &ring );
+
+        bool contains( const QPointF &point ) const;
+    };
+
+    struct PreparedRegion {
+        int identifier;
+        int adminLevel;
+        int order;
+        PreparedRing outer;
+        QVector<PreparedRing> inner;
+
+        bool contains( const QPointF &point ) const;
+    };
+
+    /** Node of the R-tree. Children of a node are stored consecutively. */
+    struct TreeNode {
+        QRectF bounds;
+        int first;
+        int count;
+        bool isLeaf;
+    };
+
+    static bool contains( const QRectF &bounds, const QPointF &point );
+
+    static const QRectF &bounds( const PreparedRegion &region );
+
+    static const QRectF &bounds( const TreeNode &node );
+
+    /** Sorts the given items into slices by x and each slice by y (sort tile recursive) */
+    template<class T>
+    static void sortTileRecursive( typename QVector<T>::iterator begin, typename QVector<T>::iterator end );
+
+    template<class T>
+    static bool centerXLessThan( const T &a, const T &b );
+
+    template<class T>
+    static bool centerYLessThan( const T &a, const T &b );
+
+    void build();
+
+    QVector<PreparedRegion> m_regions;
+
+    QVector<TreeNode> m_nodes;
+
+    int m_rootIdentifier;
+};
+
+}
+
+#endif // MARBLE_OSMREGIONINDEX_H
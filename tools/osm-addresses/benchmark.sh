@@ -0,0 +1,42 @@
+#!/bin/sh
+#
+# Runs osm-addresses on a national extract (e.g. germany-latest.osm.pbf from
+# http://download.geofabrik.de/) with different settings and prints the wall
+# clock time and the peak memory of each run. The time of the individual steps
+# is in the log files next to the outputs.
+
+if [ "$#" -lt 1 ]; then
+	echo "Usage: $0 input.osm.pbf [osm-addresses binary] [output directory]"
+	exit 1
+fi
+
+INPUT="$1"
+BINARY="${2:-./osm-addresses}"
+OUTPUT="${3:-$(mktemp -d)}"
+CORES="$(getconf _NPROCESSORS_ONLN)"
+
+if [ ! -x /usr/bin/time ]; then
+	echo "GNU time is needed to measure the peak memory, please install it."
+	exit 1
+fi
+
+mkdir -p "${OUTPUT}"
+printf "%-28s %12s %16s\n" "Settings" "Time (s)" "Peak memory (MB)"
+
+run()
+{
+	NAME="$1"
+	shift
+	rm -f "${OUTPUT}/${NAME}.sqlite"
+	/usr/bin/time -f "%e %M" -o "${OUTPUT}/${NAME}.time" \
+		"${BINARY}" "$@" "${INPUT}" "${OUTPUT}/${NAME}.sqlite" "${OUTPUT}/${NAME}.kml" \
+		> "${OUTPUT}/${NAME}.log" 2>&1 || echo "${NAME} failed, see ${OUTPUT}/${NAME}.log"
+	read ELAPSED KILOBYTES < "${OUTPUT}/${NAME}.time"
+	printf "%-28s %12s %16s\n" "${NAME}" "${ELAPSED}" "$((KILOBYTES / 1024))"
+}
+
+run "1-thread" --threads 1
+run "${CORES}-threads" --threads "${CORES}"
+run "${CORES}-threads-mapped-nodes" --threads "${CORES}" --mapped-nodes
+
+echo "Outputs and logs are in ${OUTPUT}"
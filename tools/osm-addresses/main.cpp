@@ -15,6 +15,7 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QFileInfo>
+#include <QThreadPool>
 #include <QTime>
 
 using namespace Marble;
@@ -59,6 +60,8 @@ void usage()
     qDebug() << "\tOptions affect verbosity and store additional metadata in output.kml:";
     qDebug() << "\t-q quiet";
     qDebug() << "\t-v debug output";
+    qDebug() << "\t--mapped-nodes keep node coordinates in a memory mapped file (for very large input files)";
+    qDebug() << "\t--threads aNumber assign regions using aNumber threads";
     qDebug() << "\t--version aVersion";
     qDebug() << "\t--name aName";
     qDebug() << "\t--date aDate";
@@ -82,6 +85,7 @@ int main( int argc, char *argv[] )
     QString date;
     QString transport;
     QString payload;
+    bool mappedNodes = false;
     for ( int i=1; i<argc-3; ++i ) {
         QString arg( argv[i] );
         if ( arg == "-v" ) {
@@ -98,6 +102,10 @@ int main( int argc, char *argv[] )
             transport = argv[++i];
         } else if ( arg == "--payload" ) {
             payload = argv[++i];
+        } else if ( arg == "--mapped-nodes" ) {
+            mappedNodes = true;
+        } else if ( arg == "--threads" ) {
+            QThreadPool::globalInstance()->setMaxThreadCount( qMax( 1, QString( argv[++i] ).toInt() ) );
         } else {
             usage();
             return 1;
@@ -124,6 +132,9 @@ int main( int argc, char *argv[] )
     Q_ASSERT( parser );
     SqlWriter sql( outputSqlite );
     parser->addWriter( &sql );
+    if ( mappedNodes ) {
+        parser->setNodeStorage( OsmNodeStore::MappedFileStorage );
+    }
     parser->read( file, name );
     parser->writeKml( name, version, date, transport, payload, outputKml );
 }
@@ -33,7 +33,9 @@ SOURCES += main.cpp \
     OsmParser.cpp \
     Writer.cpp \
     SqlWriter.cpp \
+    OsmNodeStore.cpp \
     OsmRegion.cpp \
+    OsmRegionIndex.cpp \
     OsmRegionTree.cpp \
     pbf/fileformat.pb.cc \
     pbf/osmformat.pb.cc \
@@ -44,7 +46,9 @@ HEADERS += \
     OsmParser.h \
     Writer.h \
     SqlWriter.h \
+    OsmNodeStore.h \
     OsmRegion.h \
+    OsmRegionIndex.h \
     OsmRegionTree.h \
     pbf/osmformat.pb.h \
     pbf/fileformat.pb.h \
@@ -15,6 +15,7 @@
 #include "PbfParser.h"
 
 #include <QDebug>
+#include <QtConcurrentRun>
 
 #include <zlib.h>
 
@@ -66,10 +67,14 @@ bool PbfParser::parse( const QFileInfo &fileInfo, int pass, bool &needAnotherPas
 
     m_loadBlock = true;
 
+    // Reading and decompressing the next block runs on another thread while
+    // the entities of the current block are processed
+    m_nextBlockRead = QtConcurrent::run( this, &PbfParser::readNext );
+
     while ( true ) {
 
         if ( m_loadBlock ) {
-            if ( !readNext() ) {
+            if ( !m_nextBlockRead.result() ) {
                 if ( pass == 1 ) {
                     m_referencedWays.clear();
                 } else if ( pass == 2 ) {
@@ -78,6 +83,8 @@ bool PbfParser::parse( const QFileInfo &fileInfo, int pass, bool &needAnotherPas
 
                 return true;
             }
+            m_primitiveBlock.Swap( &m_nextBlock );
+            m_nextBlockRead = QtConcurrent::run( this, &PbfParser::readNext );
             loadBlock();
             loadGroup();
         }
@@ -221,7 +228,7 @@ bool PbfParser::readNext()
     if ( !parseBlob() )
         return false;
 
-    if ( !m_primitiveBlock.ParseFromArray( m_buffer.data(), m_buffer.size() ) ) {
+    if ( !m_nextBlock.ParseFromArray( m_buffer.data(), m_buffer.size() ) ) {
         qCritical() << "failed to parse PrimitiveBlock";
         return false;
     }
@@ -292,7 +299,7 @@ void PbfParser::parseNode()
         }
 
         if ( m_referencedNodes.contains( inputNode.id() ) ) {
-            m_coordinates[inputNode.id()] = node;
+            m_coordinates.insert( inputNode.id(), node );
         }
     }
 
@@ -351,13 +358,13 @@ void PbfParser::parseWay()
 
         if ( relation.isAdministrativeBoundary && !way.name.isEmpty() ) {
             relation.name = way.name;
-            relation.ways << QPair<int, Marble::RelationRole>( inputWay.id(), Marble::Outer );
+            relation.ways << QPair<qint64, Marble::RelationRole>( inputWay.id(), Marble::Outer );
             m_relations[inputWay.id()] = relation;
         }
 
         if ( way.save || m_referencedWays.contains( inputWay.id() ) ) {
             if ( !way.isBuilding && way.nodes.size() > 1 && !m_referencedWays.contains( inputWay.id() ) ) {
-                QList<int> nodes = way.nodes;
+                QList<qint64> nodes = way.nodes;
                 way.nodes.clear();
                 way.nodes << nodes.first();
                 if ( nodes.size() > 2 ) {
@@ -366,7 +373,7 @@ void PbfParser::parseWay()
                 way.nodes << nodes.last();
             }
 
-            foreach( int node, way.nodes ) {
+            foreach( qint64 node, way.nodes ) {
                 m_referencedNodes << node;
             }
 
@@ -421,7 +428,7 @@ void PbfParser::parseRelation()
                     if ( role == "outer" ) relationRole = Marble::Outer;
                     if ( role == "inner" ) relationRole = Marble::Inner;
                     m_referencedWays << lastRef;
-                    relation.ways.push_back( QPair<int, Marble::RelationRole>( lastRef, relationRole ) );
+                    relation.ways.push_back( QPair<qint64, Marble::RelationRole>( lastRef, relationRole ) );
                 }
                 break;
                 case OSMPBF::Relation::RELATION:
@@ -495,7 +502,7 @@ void PbfParser::parseDense()
         }
 
         if ( m_referencedNodes.contains( m_lastDenseID ) ) {
-            m_coordinates[m_lastDenseID] = node;
+            m_coordinates.insert( m_lastDenseID, node );
         }
     }
 
@@ -24,6 +24,7 @@
 #include <QSet>
 #include <QFile>
 #include <QDataStream>
+#include <QFuture>
 
 class PbfParser : public Marble::OsmParser
 {
@@ -72,6 +73,11 @@ private:
 
     OSMPBF::PrimitiveBlock m_primitiveBlock;
 
+    /** The block read by readNext() ahead of time */
+    OSMPBF::PrimitiveBlock m_nextBlock;
+
+    QFuture<bool> m_nextBlockRead;
+
     Mode m_mode;
 
     int m_currentGroup;
@@ -86,8 +92,8 @@ private:
     int m_lastDenseTag;
     int m_pass;
 
-    QSet<int> m_referencedWays;
-    QSet<int> m_referencedNodes;
+    QSet<qint64> m_referencedWays;
+    QSet<qint64> m_referencedNodes;
 };
 
 #endif // PBFPARSER_H
@@ -0,0 +1,161 @@
+#!/bin/bash
+
+#
+# This file is part of the Marble Virtual Globe.
+#
+# This program is free software licensed under the GNU LGPL. You can
+# find a copy of this license in LICENSE.txt in the top directory of
+# the source code.
+#
+# Copyright 2026      agent <agent@local>
+#
+
+#
+# Runs osm-sisyphus against stub tools and checks its stage graph:
+# - the stages of each job run after the stages they depend on
+# - no more stages use a resource at the same time than its limit allows
+# - a second run with unchanged input skips all stages but the download
+#
+# Usage: check-stages.bash path/to/osm-sisyphus
+#
+
+SISYPHUS="$(readlink -f "${1:-./osm-sisyphus}")"
+if [[ ! -x "${SISYPHUS}" ]]
+then
+  echo "Usage: ${0} path/to/osm-sisyphus"
+  exit 1
+fi
+
+WORK="$(mktemp -d)"
+STUBS="${WORK}/stubs"
+EVENTS="${WORK}/events.log"
+mkdir -p "${STUBS}" "${WORK}/tmp"
+touch "${EVENTS}"
+
+PID=""
+function cleanup()
+{
+  [[ -n "${PID}" ]] && kill ${PID} 2>/dev/null
+  rm -rf "${WORK}"
+}
+trap cleanup EXIT
+
+# Creates a stub for the tool ${1} which uses the resource ${2}. It logs when it
+# starts and ends, naming the region found in its arguments, and runs ${3} in between.
+function stub()
+{
+  cat > "${STUBS}/${1}" <<EOF
+#!/bin/bash
+region="\$(echo "\$@ \${PWD}" | grep -o -e alpha -e beta | head -n 1)"
+echo "\$(date +%s%N) start ${2} ${1} \${region}" >> "${EVENTS}"
+sleep 1
+${3}
+echo "\$(date +%s%N) end ${2} ${1} \${region}" >> "${EVENTS}"
+EOF
+  chmod +x "${STUBS}/${1}"
+}
+
+stub wget network 'echo "osm data of ${region}" > "${2}"'
+stub monav-preprocessor cpu 'for arg in "$@"; do [[ "${arg}" == -o=* ]] && mkdir -p "${arg#-o=}/routing_motorcar" && touch "${arg#-o=}/routing_motorcar/ch.idx"; done'
+stub osm-addresses cpu 'head -c 8192 /dev/zero > "${@: -2:1}"; touch "${@: -1}"'
+stub tar disk 'touch "${2}"'
+
+cat > "${WORK}/regions.xml" <<EOF
+<?xml version="1.0" encoding="UTF-8"?>
+<regions>
+  <region><id>alpha</id><continent>Europe</continent><name>Alpha</name><path>europe/alpha</path><pbf>europe/alpha.osm.pbf</pbf><transport>Motorcar</transport></region>
+  <region><id>beta</id><continent>Europe</continent><name>Beta</name><path>europe/beta</path><pbf>europe/beta.osm.pbf</pbf><transport>Motorcar</transport></region>
+</regions>
+EOF
+
+# Starts osm-sisyphus, which never exits by itself, and stops it once ${1} reports true
+function run()
+{
+  TMPDIR="${WORK}/tmp" "${SISYPHUS}" --no-uploads --jobs 2 --network 1 --cpu 1 --disk 1 \
+    --tool wget="${STUBS}/wget" --tool monav-preprocessor="${STUBS}/monav-preprocessor" \
+    --tool osm-addresses="${STUBS}/osm-addresses" --tool tar="${STUBS}/tar" \
+    "${WORK}/regions.xml" "${WORK}/log.sqlite" 2>> "${WORK}/output.log" &
+  PID=$!
+
+  for i in $(seq 120)
+  do
+    ${1} && break
+    sleep 0.5
+  done
+  kill ${PID} 2>/dev/null
+  wait ${PID} 2>/dev/null
+  PID=""
+  ${1}
+}
+
+function uploaded()
+{
+  [[ $(grep -l "^\[upload\]" "${WORK}"/tmp/osm-sisyphus/state/*.ini 2>/dev/null | wc -l) -eq 2 ]]
+}
+
+function skipped()
+{
+  [[ $(grep -c "Skipping" "${WORK}/output.log") -eq 8 ]]
+}
+
+failures=0
+function check()
+{
+  if ${2}
+  then
+    echo "PASS: ${1}"
+  else
+    echo "FAIL: ${1}"
+    failures=$((failures+1))
+  fi
+}
+
+# Returns the time the tool ${2} started or ended (${1}) for the region ${3}
+function at()
+{
+  grep " ${1} [a-z]* ${2} ${3}\$" "${EVENTS}" | cut -d ' ' -f 1
+}
+
+function ordered()
+{
+  for region in alpha beta
+  do
+    [[ -n "$(at end tar ${region})" ]] || return 1
+    [[ $(at end wget ${region}) -le $(at start monav-preprocessor ${region}) ]] || return 1
+    [[ $(at end wget ${region}) -le $(at start osm-addresses ${region}) ]] || return 1
+    [[ $(at end monav-preprocessor ${region}) -le $(at start tar ${region}) ]] || return 1
+    [[ $(at end osm-addresses ${region}) -le $(at start tar ${region}) ]] || return 1
+  done
+}
+
+function limited()
+{
+  sort -n "${EVENTS}" | awk '
+    $2 == "start" { if ( ++used[$3] > 1 ) exceeded = 1 }
+    $2 == "end" { --used[$3] }
+    END { exit exceeded }'
+}
+
+run uploaded
+check "all stages of both jobs finished" uploaded
+check "stages ran after their dependencies" ordered
+check "resource limits were respected" limited
+
+# The download is removed after a successful run, so it runs again. The other
+# stages find that the downloaded data did not change.
+count=$(wc -l < "${EVENTS}")
+function downloadedOnly()
+{
+  [[ $(tail -n +$((count+1)) "${EVENTS}" | grep -v -c " wget ") -eq 0 ]]
+}
+
+run skipped
+check "stages with unchanged input were skipped" skipped
+check "only the download ran for unchanged input" downloadedOnly
+
+if [[ ${failures} -gt 0 ]]
+then
+  echo "Output of osm-sisyphus:"
+  cat "${WORK}/output.log"
+  exit 1
+fi
@@ -12,23 +12,32 @@
 #include "logger.h"
 #include "upload.h"
 
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDateTime>
 #include <QProcess>
+#include <QTime>
 
 Job::Job(const Region &region, const JobParameters &parameters, QObject *parent) :
-    QObject(parent), m_status(Waiting), m_region(region), m_parameters(parameters)
+    QObject(parent), m_status(Waiting), m_region(region), m_parameters(parameters), m_state(0)
 {
     // nothing to do
 }
 
+Job::~Job()
+{
+    delete m_state;
+}
+
 Job::Status Job::status() const
 {
+    QMutexLocker locker(&m_mutex);
     return m_status;
 }
 
 QString Job::statusMessage() const
 {
+    QMutexLocker locker(&m_mutex);
     return m_statusMessage;
 }
 
@@ -62,14 +71,199 @@ bool Job::operator ==(const Job &other) const
     return m_transport == other.m_transport && m_region == other.m_region;
 }
 
-void Job::run()
+QList<Job::Stage> Job::stages()
+{
+    return QList<Stage>() << DownloadStage << RoutingStage << SearchStage << PackageStage << UploadStage;
+}
+
+QList<Job::Stage> Job::dependencies(Job::Stage stage)
+{
+    switch (stage) {
+    case DownloadStage: return QList<Stage>();
+    case RoutingStage: return QList<Stage>() << DownloadStage;
+    case SearchStage: return QList<Stage>() << DownloadStage;
+    case PackageStage: return QList<Stage>() << RoutingStage << SearchStage;
+    case UploadStage: return QList<Stage>() << PackageStage;
+    }
+
+    return QList<Stage>();
+}
+
+Job::Resource Job::resource(Job::Stage stage)
+{
+    switch (stage) {
+    case DownloadStage: return NetworkResource;
+    case RoutingStage: return CpuResource;
+    case SearchStage: return CpuResource;
+    case PackageStage: return DiskResource;
+    case UploadStage: return NetworkResource;
+    }
+
+    return CpuResource;
+}
+
+QString Job::stageName(Job::Stage stage)
+{
+    switch (stage) {
+    case DownloadStage: return "download";
+    case RoutingStage: return "routing";
+    case SearchStage: return "search";
+    case PackageStage: return "package";
+    case UploadStage: return "upload";
+    }
+
+    return QString();
+}
+
+void Job::runStage(Job::Stage stage)
 {
-    if (download() && monav() && search() && package() && upload()) {
-        // Nothing to do.
+    QTime timer;
+    timer.start();
+
+    bool success = true;
+    bool const skip = isUpToDate(stage);
+    if (skip) {
+        qDebug() << "Skipping" << stageName(stage) << "of" << m_region.id() << m_transport << ", input did not change.";
+    } else {
+        success = runStageAction(stage);
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_timings[stage] = timer.elapsed();
+        if (skip) {
+            m_skippedStages << stage;
+        }
+    }
+
+    if (success && !skip) {
+        // Remember which input the stage processed to skip it when running again
+        QString const hash = inputHash();
+        if (!hash.isEmpty()) {
+            QMutexLocker locker(&m_mutex);
+            m_state->setValue(stateKey(stage), hash);
+            m_state->sync();
+        }
+    }
+
+    Logger::instance().setStageTiming(m_region.id() + '_' + m_transport, stageName(stage), timer.elapsed() / 1000, skip, success);
+    emit stageFinished(this, stage, success);
+}
+
+bool Job::runStageAction(Job::Stage stage)
+{
+    switch (stage) {
+    case DownloadStage: return download();
+    case RoutingStage: return monav();
+    case SearchStage: return search();
+    case PackageStage: return package();
+    case UploadStage: return upload();
+    }
+
+    return false;
+}
+
+bool Job::isUpToDate(Job::Stage stage)
+{
+    if (stage == DownloadStage) {
+        // download() checks by itself whether a previous download can be reused
+        return false;
+    }
+
+    QString const hash = inputHash();
+    if (hash.isEmpty()) {
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_state->value(stateKey(UploadStage)).toString() == hash) {
+            // The package of this input was delivered already, nothing left to do
+            return true;
+        }
+
+        if (m_state->value(stateKey(stage)).toString() != hash) {
+            return false;
+        }
+    }
+
+    // The stage finished for this input before, e.g. prior to a crash. Check its results.
+    switch (stage) {
+    case DownloadStage:
+        return false;
+    case RoutingStage:
+        return QFileInfo(monavDir().absoluteFilePath() + "/plugins.ini").exists();
+    case SearchStage:
+        return searchFile().exists() && QFileInfo(monavDir().absoluteFilePath() + "/marble.kml").exists();
+    case PackageStage:
+        return targetFile().exists();
+    case UploadStage:
+        return false;
+    }
+
+    return false;
+}
+
+QString Job::inputHash()
+{
+    QFileInfo const file = osmFile();
+    if (!file.exists()) {
+        return QString();
+    }
+
+    // Hashing large files takes a while, so the hash is cached per file version
+    QString const version = QString("%1-%2").arg(file.size()).arg(file.lastModified().toTime_t());
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_state) {
+            m_parameters.base().mkdir("state");
+            m_state = new QSettings(m_parameters.base().absoluteFilePath("state/" + m_region.id() + '_' + m_transport.toLower() + ".ini"), QSettings::IniFormat);
+        }
+
+        if (m_state->value("input/version").toString() == version) {
+            return m_state->value("input/hash").toString();
+        }
+    }
+
+    // The file is hashed without holding the lock, so status() and the queue are not blocked meanwhile
+    QFile input(file.absoluteFilePath());
+    if (!input.open(QFile::ReadOnly)) {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    while (!input.atEnd()) {
+        hash.addData(input.read(1 << 20));
+    }
+
+    QString const result = hash.result().toHex();
+    QMutexLocker locker(&m_mutex);
+    m_state->setValue("input/version", version);
+    m_state->setValue("input/hash", result);
+    m_state->sync();
+    return result;
+}
+
+QString Job::stateKey(Job::Stage stage) const
+{
+    return stageName(stage) + "/input";
+}
+
+QString Job::timingReport() const
+{
+    QMutexLocker locker(&m_mutex);
+    QStringList result;
+    foreach(Stage stage, stages()) {
+        if (m_timings.contains(stage)) {
+            QString timing = QString("%1 %2s").arg(stageName(stage)).arg(m_timings[stage] / 1000.0, 0, 'f', 1);
+            if (m_skippedStages.contains(stage)) {
+                timing += " (skipped)";
+            }
+            result << timing;
+        }
     }
 
-    cleanup();
-    emit finished(this);
+    return m_region.id() + " (" + m_transport + "): " + result.join(", ");
 }
 
 void Job::changeStatus(Job::Status status, const QString &message)
@@ -88,6 +282,7 @@ void Job::changeStatus(Job::Status status, const QString &message)
 
     Logger::instance().setStatus(m_region.id() + '_' + m_transport,
                                  m_region.name() + QLatin1String( " (" ) + m_transport + ')', statusType, message);
+    QMutexLocker locker(&m_mutex);
     m_statusMessage = message;
     m_status = status;
 }
@@ -112,7 +307,7 @@ bool Job::download()
     QString url = m_region.pbfFile();
     arguments << "-O" << osmFile().absoluteFilePath() << url;
     qDebug() << "Downloading " << url;
-    wget.start("wget", arguments);
+    wget.start(m_parameters.tool("wget"), arguments);
     wget.waitForFinished(1000 * 60 * 60 * 12); // wait up to 12 hours for download to complete
     if (wget.exitStatus() == QProcess::NormalExit && wget.exitCode() == 0) {
         return true;
@@ -162,7 +357,7 @@ bool Job::monav()
     arguments << "--profile=" + m_profile;
     arguments << "-dd" /*<< "-dc"*/;
     QProcess monav;
-    monav.start("monav-preprocessor", arguments);
+    monav.start(m_parameters.tool("monav-preprocessor"), arguments);
     monav.waitForFinished(1000 * 60 * 60 * 6); // wait up to 6 hours for monav to convert the data
     if (monav.exitStatus() == QProcess::NormalExit && monav.exitCode() == 0) {
         qDebug() << "Processed osm file for monav";
@@ -211,7 +406,7 @@ bool Job::search()
     QFileInfo kmlFile(monavDir().absoluteFilePath() + "/marble.kml");
     arguments << kmlFile.absoluteFilePath();
     QProcess osmAddresses;
-    osmAddresses.start("osm-addresses", arguments);
+    osmAddresses.start(m_parameters.tool("osm-addresses"), arguments);
     osmAddresses.waitForFinished(1000 * 60 * 60 * 18); // wait up to 18 hours for osm-addresses to convert the data
     if (osmAddresses.exitStatus() == QProcess::NormalExit && osmAddresses.exitCode() == 0) {
         searchFile().refresh();
@@ -247,7 +442,7 @@ bool Job::package()
     arguments << "czf" << targetFile().absoluteFilePath() << "earth/monav/" << "earth/placemarks";
     QProcess tar;
     tar.setWorkingDirectory(m_parameters.base().absolutePath() + "/data/" + m_region.id());
-    tar.start("tar", arguments);
+    tar.start(m_parameters.tool("tar"), arguments);
     tar.waitForFinished(1000 * 60 * 60); // wait up to 1 hour for tar to package things
     if (tar.exitStatus() == QProcess::NormalExit && tar.exitCode() == 0) {
         qDebug() << "Packaged tar file";
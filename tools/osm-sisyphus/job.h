@@ -15,10 +15,23 @@
 #include "region.h"
 
 #include <QObject>
-#include <QRunnable>
 #include <QFileInfo>
-
-class Job : public QObject, public QRunnable
+#include <QList>
+#include <QMap>
+#include <QMetaType>
+#include <QMutex>
+#include <QSettings>
+
+/**
+ * Conversion of the OSM data of a region into an offline package. The conversion
+ * is split into stages which form a directed acyclic graph: Routing and search
+ * data are created independently of each other from the download, the package
+ * needs both. Stages are run by the JobQueue. The state of a job is saved after
+ * each stage, so that stages already done for the same input are skipped after
+ * a restart, and all stages following the download are skipped if the input
+ * did not change since it was uploaded the last time.
+ */
+class Job : public QObject
 {
     Q_OBJECT
 public:
@@ -33,8 +46,25 @@ public:
         Error
     };
 
+    enum Stage {
+        DownloadStage,
+        RoutingStage,
+        SearchStage,
+        PackageStage,
+        UploadStage
+    };
+
+    /** The resource a stage mostly depends on. Each has its own limit of concurrent stages */
+    enum Resource {
+        NetworkResource,
+        CpuResource,
+        DiskResource
+    };
+
     explicit Job(const Region &region, const JobParameters &parameters, QObject *parent = 0);
 
+    ~Job();
+
     Status status() const;
 
     QString statusMessage() const;
@@ -51,14 +81,44 @@ public:
 
     bool operator==(const Job &other) const;
 
-    virtual void run();
+    /** All stages in an order compatible with their dependencies */
+    static QList<Stage> stages();
+
+    /** The stages that need to be finished before the given one can start */
+    static QList<Stage> dependencies(Stage stage);
+
+    static Resource resource(Stage stage);
+
+    static QString stageName(Stage stage);
+
+    /**
+     * Runs the given stage, unless it is up to date already, and emits
+     * stageFinished() afterwards. Called from worker threads.
+     */
+    void runStage(Stage stage);
+
+    /** Removes temporary files once no further stage is going to run */
+    bool cleanup();
+
+    /** Returns a summary of the time spent in each stage */
+    QString timingReport() const;
 
 Q_SIGNALS:
-    void finished(Job* job);
+    void stageFinished(Job* job, Job::Stage stage, bool success);
     
 private:
     void changeStatus(Status status, const QString &message);
 
+    bool runStageAction(Stage stage);
+
+    /** True if the stage ran successfully for the current input and its results still exist */
+    bool isUpToDate(Stage stage);
+
+    /** A content hash of the downloaded data, which all stages following the download depend on */
+    QString inputHash();
+
+    QString stateKey(Stage stage) const;
+
     bool download();
 
     bool monav();
@@ -69,8 +129,6 @@ private:
 
     bool upload();
 
-    bool cleanup();
-
     QFileInfo osmFile();
 
     QFileInfo monavDir();
@@ -92,6 +150,16 @@ private:
     QString m_profile;
 
     QString m_monavSettings;
+
+    QSettings* m_state;
+
+    QMap<Stage, int> m_timings;
+
+    QList<Stage> m_skippedStages;
+
+    mutable QMutex m_mutex;
 };
 
+Q_DECLARE_METATYPE(Job::Stage)
+
 #endif // JOB_H
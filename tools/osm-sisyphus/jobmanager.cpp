@@ -110,6 +110,16 @@ void JobManager::setJobParameters(const JobParameters &parameters)
     m_jobParameters = parameters;
 }
 
+void JobManager::setMaxConcurrentJobs(int size)
+{
+    m_queue.setMaxConcurrentJobs(size);
+}
+
+void JobManager::setResourceLimit(Job::Resource resource, int limit)
+{
+    m_queue.setResourceLimit(resource, limit);
+}
+
 void JobManager::update()
 {
     bool resume = m_resumeId.isEmpty();
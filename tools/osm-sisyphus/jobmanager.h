@@ -38,6 +38,10 @@ public:
 
     void setJobParameters(const JobParameters &parameters);
 
+    void setMaxConcurrentJobs(int size);
+
+    void setResourceLimit(Job::Resource resource, int limit);
+
 private Q_SLOTS:
     void update();
 
@@ -34,3 +34,13 @@ void JobParameters::setCacheData(bool cache)
 {
     m_cacheData = cache;
 }
+
+QString JobParameters::tool(const QString &name) const
+{
+    return m_tools.value(name, name);
+}
+
+void JobParameters::setTool(const QString &name, const QString &executable)
+{
+    m_tools[name] = executable;
+}
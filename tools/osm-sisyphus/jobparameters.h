@@ -12,6 +12,7 @@
 #define JOBPARAMETERS_H
 
 #include <QDir>
+#include <QMap>
 
 class JobParameters
 {
@@ -26,10 +27,18 @@ public:
 
     void setCacheData(bool cache);
 
+    /** The executable to run for the given tool, e.g. wget. Defaults to the tool name itself */
+    QString tool(const QString &name) const;
+
+    /** Replaces a tool by another executable, e.g. a local stub for testing */
+    void setTool(const QString &name, const QString &executable);
+
 private:
     QDir m_base;
 
     bool m_cacheData;
+
+    QMap<QString, QString> m_tools;
 };
 
 #endif // JOBPARAMETERS_H
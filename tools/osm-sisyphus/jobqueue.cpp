@@ -12,14 +12,48 @@
 #include "logger.h"
 
 #include <QDebug>
-#include <QThreadPool>
+#include <QRunnable>
 
-JobQueue::JobQueue(QObject *parent) :
-    QObject(parent), m_maxConcurrentJobs(1)
+class StageTask : public QRunnable
+{
+public:
+    StageTask(Job* job, Job::Stage stage) : m_job(job), m_stage(stage)
+    {
+        // nothing to do
+    }
+
+    virtual void run()
+    {
+        m_job->runStage(m_stage);
+    }
+
+private:
+    Job* m_job;
+
+    Job::Stage m_stage;
+};
+
+JobQueue::JobState::JobState() : m_failed(false)
 {
     // nothing to do
 }
 
+JobQueue::JobQueue(QObject *parent) :
+    QObject(parent), m_maxConcurrentJobs(4)
+{
+    qRegisterMetaType<Job*>("Job*");
+    qRegisterMetaType<Job::Stage>("Job::Stage");
+
+    m_resourceLimits[Job::NetworkResource] = 2;
+    m_resourceLimits[Job::CpuResource] = 1;
+    m_resourceLimits[Job::DiskResource] = 1;
+}
+
+JobQueue::~JobQueue()
+{
+    m_threadPool.waitForDone();
+}
+
 void JobQueue::addJob(Job *newJob)
 {
     QList<Job*> const allJobs = m_jobs + m_runningJobs;
@@ -30,34 +64,117 @@ void JobQueue::addJob(Job *newJob)
         }
     }
 
-    connect(newJob, SIGNAL(finished(Job*)), this, SLOT(removeJob(Job*)));
+    connect(newJob, SIGNAL(stageFinished(Job*,Job::Stage,bool)),
+            this, SLOT(finishStage(Job*,Job::Stage,bool)), Qt::QueuedConnection);
 
-    if (m_runningJobs.size()<m_maxConcurrentJobs) {
-        startJob(newJob);
-    } else {
-        Logger::instance().setStatus(newJob->region().id() + '_' + newJob->transport(), newJob->region().name() + QLatin1String( " (" ) + newJob->transport() + ')', "waiting", "Queued.");
-        m_jobs << newJob;
-    }
+    Logger::instance().setStatus(newJob->region().id() + '_' + newJob->transport(), newJob->region().name() + QLatin1String( " (" ) + newJob->transport() + ')', "waiting", "Queued.");
+    m_jobs << newJob;
+    schedule();
 }
 
 void JobQueue::setMaxConcurrentJobs(int size)
 {
     m_maxConcurrentJobs = size;
+    schedule();
 }
 
-void JobQueue::removeJob(Job *job)
+void JobQueue::setResourceLimit(Job::Resource resource, int limit)
 {
-    m_runningJobs.removeAll(job);
+    m_resourceLimits[resource] = limit;
+    schedule();
+}
 
-    while (m_runningJobs.size()<m_maxConcurrentJobs && !m_jobs.isEmpty()) {
-        Job* newJob = m_jobs.first();
-        m_jobs.removeFirst();
-        startJob(newJob);
+void JobQueue::finishStage(Job *job, Job::Stage stage, bool success)
+{
+    Q_ASSERT(m_states.contains(job));
+    JobState &state = m_states[job];
+    state.m_runningStages.removeAll(stage);
+    --m_resourceUsage[Job::resource(stage)];
+    if (success) {
+        state.m_finishedStages << stage;
+    } else {
+        // Stages running already are not interrupted, the job is removed once they are done
+        state.m_failed = true;
+    }
+
+    bool const done = state.m_finishedStages.size() == Job::stages().size();
+    if (done || (state.m_failed && state.m_runningStages.isEmpty())) {
+        removeJob(job);
     }
+
+    schedule();
 }
 
-void JobQueue::startJob(Job *job)
+void JobQueue::schedule()
 {
-    m_runningJobs << job;
-    QThreadPool::globalInstance()->start(job);
+    activateJobs();
+
+    int threads = 0;
+    foreach(int limit, m_resourceLimits) {
+        threads += limit;
+    }
+    m_threadPool.setMaxThreadCount(qMax(1, threads));
+
+    // Earlier jobs take precedence, so that each job is finished as soon as possible
+    foreach(Job* job, m_runningJobs) {
+        foreach(Job::Stage stage, Job::stages()) {
+            if (isRunnable(job, stage)) {
+                startStage(job, stage);
+            }
+        }
+    }
+}
+
+void JobQueue::activateJobs()
+{
+    for (int i=0; i<m_jobs.size() && m_runningJobs.size()<m_maxConcurrentJobs; ) {
+        Job* job = m_jobs.at(i);
+
+        // Jobs of the same region share their download and search database
+        bool sharesRegion = false;
+        foreach(Job* runningJob, m_runningJobs) {
+            sharesRegion = sharesRegion || runningJob->region().id() == job->region().id();
+        }
+
+        if (sharesRegion) {
+            ++i;
+        } else {
+            m_jobs.removeAt(i);
+            m_runningJobs << job;
+            m_states[job] = JobState();
+        }
+    }
+}
+
+bool JobQueue::isRunnable(Job *job, Job::Stage stage) const
+{
+    JobState const state = m_states.value(job);
+    if (state.m_failed || state.m_finishedStages.contains(stage) || state.m_runningStages.contains(stage)) {
+        return false;
+    }
+
+    foreach(Job::Stage dependency, Job::dependencies(stage)) {
+        if (!state.m_finishedStages.contains(dependency)) {
+            return false;
+        }
+    }
+
+    Job::Resource const resource = Job::resource(stage);
+    return m_resourceUsage.value(resource) < m_resourceLimits.value(resource);
+}
+
+void JobQueue::startStage(Job *job, Job::Stage stage)
+{
+    m_states[job].m_runningStages << stage;
+    ++m_resourceUsage[Job::resource(stage)];
+    m_threadPool.start(new StageTask(job, stage));
+}
+
+void JobQueue::removeJob(Job *job)
+{
+    m_runningJobs.removeAll(job);
+    m_states.remove(job);
+    job->cleanup();
+    qDebug() << "Timing" << job->timingReport();
+    job->deleteLater();
 }
@@ -15,28 +15,65 @@
 
 #include <QObject>
 #include <QList>
+#include <QMap>
+#include <QThreadPool>
 
+/**
+ * Runs the stages of several jobs concurrently. A stage is started once all
+ * stages it depends on are finished and the resource it needs is available,
+ * i.e. fewer stages than the resource limit use it at the moment.
+ */
 class JobQueue : public QObject
 {
     Q_OBJECT
 public:
     explicit JobQueue(QObject *parent = 0);
 
+    ~JobQueue();
+
     void addJob(Job* job);
 
+    /** The number of jobs whose stages are scheduled at the same time */
     void setMaxConcurrentJobs(int size);
 
+    /** The number of stages using the given resource that may run at the same time */
+    void setResourceLimit(Job::Resource resource, int limit);
+
 private Q_SLOTS:
-    void removeJob(Job* job);
+    void finishStage(Job* job, Job::Stage stage, bool success);
 
 private:
-    void startJob(Job *job);
+    struct JobState {
+        QList<Job::Stage> m_finishedStages;
+        QList<Job::Stage> m_runningStages;
+        bool m_failed;
+
+        JobState();
+    };
+
+    void schedule();
+
+    void activateJobs();
+
+    bool isRunnable(Job* job, Job::Stage stage) const;
+
+    void startStage(Job* job, Job::Stage stage);
+
+    void removeJob(Job* job);
 
     QList<Job*> m_jobs;
 
     QList<Job*> m_runningJobs;
 
+    QMap<Job*, JobState> m_states;
+
+    QMap<Job::Resource, int> m_resourceLimits;
+
+    QMap<Job::Resource, int> m_resourceUsage;
+
     int m_maxConcurrentJobs;
+
+    QThreadPool m_threadPool;
 };
 
 #endif // JOBQUEUE_H
@@ -11,6 +11,7 @@
 #include "logger.h"
 
 #include <QDebug>
+#include <QMutex>
 #include <QVariant>
 #include <QSqlDatabase>
 #include <QSqlQuery>
@@ -21,6 +22,8 @@ class LoggerPrivate
 public:
     QSqlDatabase m_database;
 
+    QMutex m_mutex;
+
     LoggerPrivate();
 
     void initializeDatabase();
@@ -38,6 +41,12 @@ void LoggerPrivate::initializeDatabase()
         qDebug() << "Error when executing query" << createJobsTable.lastQuery();
         qDebug() << "Sql reports" << createJobsTable.lastError();
     }
+
+    QSqlQuery createStagesTable( "CREATE TABLE IF NOT EXISTS stages (id VARCHAR(255), stage VARCHAR(32), seconds INTEGER, skipped BOOLEAN, success BOOLEAN, timestamp DATETIME DEFAULT CURRENT_TIMESTAMP, PRIMARY KEY (id, stage));" );
+    if ( createStagesTable.lastError().isValid() ) {
+        qDebug() << "Error when executing query" << createStagesTable.lastQuery();
+        qDebug() << "Sql reports" << createStagesTable.lastError();
+    }
 }
 
 Logger::Logger(QObject *parent) :
@@ -68,6 +77,7 @@ void Logger::setFilename(const QString &filename)
 
 void Logger::setStatus(const QString &id, const QString &name, const QString &status, const QString &message)
 {
+    QMutexLocker locker(&d->m_mutex);
     QSqlQuery deleteJob( QString("DELETE FROM jobs WHERE id='%1';").arg(id) );
     if ( deleteJob.lastError().isValid() ) {
         qDebug() << "Error when executing query" << deleteJob.lastQuery();
@@ -85,3 +95,19 @@ void Logger::setStatus(const QString &id, const QString &name, const QString &st
         }
     }
 }
+
+void Logger::setStageTiming(const QString &id, const QString &stage, int seconds, bool skipped, bool success)
+{
+    QMutexLocker locker(&d->m_mutex);
+    QSqlQuery timing;
+    timing.prepare("INSERT OR REPLACE INTO stages (id, stage, seconds, skipped, success) VALUES (:job, :stage, :seconds, :skipped, :success);");
+    timing.bindValue(":job", id);
+    timing.bindValue(":stage", stage);
+    timing.bindValue(":seconds", seconds);
+    timing.bindValue(":skipped", skipped);
+    timing.bindValue(":success", success);
+    if ( !timing.exec() ) {
+        qDebug() << "Error when executing query" << timing.lastQuery();
+        qDebug() << "Sql reports" << timing.lastError();
+    }
+}
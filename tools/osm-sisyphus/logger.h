@@ -24,6 +24,8 @@ public:
     void setFilename(const QString &filename);
 
     void setStatus(const QString &id, const QString &name, const QString &status, const QString &message);
+
+    void setStageTiming(const QString &id, const QString &stage, int seconds, bool skipped, bool success);
     
 private:
     explicit Logger(QObject *parent = 0);
@@ -22,6 +22,11 @@ void usage(const QString &app)
     qDebug() << "\t-h, --help................. Show this help";
     qDebug() << "\t-cd, --cache-data.......... Do not delete downloaded .osm.pbf and converted .tar.gz files after a successful conversion and upload";
     qDebug() << "\t-nu, --no-uploads.......... Do not upload converted files to files.kde.org";
+    qDebug() << "\t-j, --jobs N............... Process up to N regions at the same time (default: 4)";
+    qDebug() << "\t--network N................ Run up to N downloads and uploads at the same time (default: 2)";
+    qDebug() << "\t--cpu N.................... Run up to N routing and search conversions at the same time (default: 1)";
+    qDebug() << "\t--disk N................... Create up to N packages at the same time (default: 1)";
+    qDebug() << "\t--tool name=path........... Run the executable path instead of the tool name, e.g. --tool wget=/tmp/wget-stub";
 }
 
 int main(int argc, char *argv[])
@@ -31,6 +36,9 @@ int main(int argc, char *argv[])
     QStringList arguments;
     bool cacheData(false);
     bool uploadFiles(true);
+    int maxConcurrentJobs(-1);
+    QMap<Job::Resource, int> resourceLimits;
+    QMap<QString, QString> tools;
     for (int i=1; i<argc; ++i) {
         QString const arg = argv[i];
         if (arg == "-h" || arg == "--help") {
@@ -40,6 +48,22 @@ int main(int argc, char *argv[])
             cacheData = true;
         } else if (arg == "-nu" || arg == "--no-uploads") {
             uploadFiles = false;
+        } else if ((arg == "-j" || arg == "--jobs") && i+1<argc) {
+            maxConcurrentJobs = QString(argv[++i]).toInt();
+        } else if (arg == "--network" && i+1<argc) {
+            resourceLimits[Job::NetworkResource] = QString(argv[++i]).toInt();
+        } else if (arg == "--cpu" && i+1<argc) {
+            resourceLimits[Job::CpuResource] = QString(argv[++i]).toInt();
+        } else if (arg == "--disk" && i+1<argc) {
+            resourceLimits[Job::DiskResource] = QString(argv[++i]).toInt();
+        } else if (arg == "--tool" && i+1<argc) {
+            QString const tool = argv[++i];
+            int const separator = tool.indexOf('=');
+            if (separator <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            tools[tool.left(separator)] = tool.mid(separator+1);
         } else {
             arguments << arg;
         }
@@ -56,6 +80,9 @@ int main(int argc, char *argv[])
     JobParameters parameters;
     parameters.setBase(QDir(tempDir.absoluteFilePath()));
     parameters.setCacheData(cacheData);
+    foreach(const QString &tool, tools.keys()) {
+        parameters.setTool(tool, tools[tool]);
+    }
 
     Upload::instance().setJobParameters(parameters);
     Upload::instance().setUploadFiles(uploadFiles);
@@ -63,6 +90,12 @@ int main(int argc, char *argv[])
     JobManager manager;
     manager.setRegionsFile(arguments.at(0));
     manager.setJobParameters(parameters);
+    if (maxConcurrentJobs > 0) {
+        manager.setMaxConcurrentJobs(maxConcurrentJobs);
+    }
+    foreach(Job::Resource resource, resourceLimits.keys()) {
+        manager.setResourceLimit(resource, qMax(1, resourceLimits[resource]));
+    }
     if (arguments.size() == 3) {
         manager.setResumeId(arguments.at(2));
     }
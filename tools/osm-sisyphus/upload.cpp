@@ -61,7 +61,7 @@ bool Upload::upload(const Package &package)
     arguments << "mkdir" << "-p";
     QString remoteDir = QString("/home/marble/web/monav/") + targetDir();
     arguments << remoteDir;
-    ssh.start("ssh", arguments);
+    ssh.start(m_jobParameters.tool("ssh"), arguments);
     ssh.waitForFinished(1000 * 60 * 10); // wait up to 10 minutes for mkdir to complete
     if (ssh.exitStatus() != QProcess::NormalExit || ssh.exitCode() != 0) {
         qDebug() << "Failed to create remote directory " << remoteDir;
@@ -74,7 +74,7 @@ bool Upload::upload(const Package &package)
     arguments << package.file.absoluteFilePath();
     QString target = remoteDir + '/' + package.file.fileName();
     arguments << auth + ':' + target;
-    scp.start("scp", arguments);
+    scp.start(m_jobParameters.tool("scp"), arguments);
     scp.waitForFinished(1000 * 60 * 60 * 12); // wait up to 12 hours for upload to complete
     if (scp.exitStatus() != QProcess::NormalExit || scp.exitCode() != 0) {
         qDebug() << "Failed to upload " << target;
@@ -102,7 +102,7 @@ bool Upload::adjustNewstuffFile(const Package &package)
         tempFile.close();
         QProcess wget;
         QStringList const arguments = QStringList() << "http://filesmaster.kde.org/marble/newstuff/maps-monav.xml" << "-O" << monavFilename;
-        wget.start("wget", arguments);
+        wget.start(m_jobParameters.tool("wget"), arguments);
         wget.waitForFinished(1000 * 60 * 60 * 12); // wait up to 12 hours for download to complete
         if (wget.exitStatus() != QProcess::NormalExit || wget.exitCode() != 0) {
             qDebug() << "Failed to download newstuff file from filesmaster.kde.org";
@@ -218,7 +218,7 @@ bool Upload::uploadNewstuff()
     QStringList arguments;
     arguments << outFile.fileName();
     arguments << "marble@filesmaster.kde.org:/home/marble/web/newstuff/maps-monav.xml";
-    scp.start("scp", arguments);
+    scp.start(m_jobParameters.tool("scp"), arguments);
     scp.waitForFinished(1000 * 60 * 60 * 12); // wait up to 12 hours for upload to complete
     if (scp.exitStatus() != QProcess::NormalExit || scp.exitCode() != 0) {
         qDebug() << "Failed to upload " << outFile.fileName() << ": " << scp.readAllStandardError();
@@ -241,7 +241,7 @@ bool Upload::deleteRemoteFile(const QString &filename)
     QProcess ssh;
     QStringList arguments;
     arguments << "marble@filesmaster.kde.org" << "rm" << filename;
-    ssh.start("ssh", arguments);
+    ssh.start(m_jobParameters.tool("ssh"), arguments);
     ssh.waitForFinished(1000 * 60 * 10); // wait up to 10 minutes for rm to complete
     if (ssh.exitStatus() != QProcess::NormalExit || ssh.exitCode() != 0) {
         qDebug() << "Failed to delete remote file " << filename;
@@ -258,6 +258,8 @@ void Upload::uploadAndDelete(const Region &region, const QFileInfo &file, const
     package.file = file;
     package.transport = transport;
 
+    // Jobs upload from several threads, but the newstuff file must be adjusted by one at a time
+    QMutexLocker locker(&m_mutex);
     m_queue.removeAll(package);
     m_queue << package;
     processQueue();
@@ -18,6 +18,7 @@
 #include <QList>
 #include <QFileInfo>
 #include <QDomDocument>
+#include <QMutex>
 
 class Upload : public QObject
 {
@@ -69,6 +70,7 @@ private:
     bool m_uploadFiles;
     QDomDocument m_xml;
     JobParameters m_jobParameters;
+    QMutex m_mutex;
 };
 
 #endif // UPLOAD_H